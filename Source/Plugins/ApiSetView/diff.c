@@ -0,0 +1,307 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       DIFF.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  ApiSet schema diff engine.
+*
+*  Contracts are keyed by name without last version number, so version bump
+*  of the same contract is reported as change, not as remove and add pair.
+*  Key arrays of both schemas are merged in one pass; schemas keep entries
+*  ordered by name, so sorting is only done for unordered input.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#include "global.h"
+
+/*
+* AsDiffpCompareNames
+*
+* Purpose:
+*
+* Case insensitive compare of schema strings, lengths are in chars.
+*
+*/
+INT AsDiffpCompareNames(
+    _In_opt_ PCWSTR Name1,
+    _In_ ULONG Length1,
+    _In_opt_ PCWSTR Name2,
+    _In_ ULONG Length2
+)
+{
+    ULONG i, Length = (Length1 < Length2) ? Length1 : Length2;
+    WCHAR c1, c2;
+
+    for (i = 0; i < Length; i++) {
+
+        c1 = Name1[i];
+        c2 = Name2[i];
+
+        if ((c1 >= L'A') && (c1 <= L'Z')) c1 += (L'a' - L'A');
+        if ((c2 >= L'A') && (c2 <= L'Z')) c2 += (L'a' - L'A');
+
+        if (c1 != c2)
+            return (c1 < c2) ? -1 : 1;
+    }
+
+    if (Length1 == Length2)
+        return 0;
+
+    return (Length1 < Length2) ? -1 : 1;
+}
+
+/*
+* AsDiffpCompareKeys
+*
+* Purpose:
+*
+* qsort comparer for contract key array.
+*
+*/
+INT __cdecl AsDiffpCompareKeys(
+    _In_ const void* First,
+    _In_ const void* Second
+)
+{
+    PAS_DIFF_KEY Key1 = (PAS_DIFF_KEY)First;
+    PAS_DIFF_KEY Key2 = (PAS_DIFF_KEY)Second;
+
+    return AsDiffpCompareNames(Key1->Name, Key1->KeyLength, Key2->Name, Key2->KeyLength);
+}
+
+/*
+* AsDiffpBuildKeys
+*
+* Purpose:
+*
+* Collect contract keys of schema ordered by key.
+*
+*/
+PAS_DIFF_KEY AsDiffpBuildKeys(
+    _In_ HANDLE HeapHandle,
+    _In_ PAS_SCHEMA Schema,
+    _Out_ PULONG KeyCount
+)
+{
+    ULONG i, cch, Count = 0;
+    BOOL bSorted = TRUE;
+    PAS_DIFF_KEY Keys;
+    AS_NAMESPACE_ENTRY Entry;
+
+    *KeyCount = 0;
+
+    Keys = (PAS_DIFF_KEY)HeapAlloc(HeapHandle, 0,
+        (SIZE_T)(Schema->NamespaceCount ? Schema->NamespaceCount : 1) * sizeof(AS_DIFF_KEY));
+
+    if (Keys == NULL)
+        return NULL;
+
+    for (i = 0; i < Schema->NamespaceCount; i++) {
+
+        if (!AsSchemaQueryNamespace(Schema, i, &Entry))
+            continue;
+
+        //
+        // Drop last version number, same as loader hash name.
+        //
+        cch = Entry.NameLength / sizeof(WCHAR);
+        while (cch && Entry.Name[cch - 1] != L'-')
+            cch--;
+
+        if (cch > 1)
+            cch--;
+        else
+            cch = Entry.NameLength / sizeof(WCHAR);
+
+        Keys[Count].Name = Entry.Name;
+        Keys[Count].KeyLength = cch;
+        Keys[Count].NamespaceIndex = i;
+
+        if (Count && AsDiffpCompareKeys(&Keys[Count - 1], &Keys[Count]) > 0)
+            bSorted = FALSE;
+
+        Count += 1;
+    }
+
+    if (!bSorted)
+        qsort(Keys, Count, sizeof(AS_DIFF_KEY), AsDiffpCompareKeys);
+
+    *KeyCount = Count;
+    return Keys;
+}
+
+/*
+* AsDiffpFindAlias
+*
+* Purpose:
+*
+* Find value of namespace with the same alias as given one.
+*
+*/
+BOOL AsDiffpFindAlias(
+    _In_ PAS_SCHEMA Schema,
+    _In_ PAS_NAMESPACE_ENTRY Entry,
+    _In_ PAS_VALUE_ENTRY Match,
+    _Out_ PAS_VALUE_ENTRY Value
+)
+{
+    ULONG i;
+
+    for (i = 0; i < Entry->ValueCount; i++) {
+
+        if (!AsSchemaQueryValue(Schema, Entry, i, Value) || Value->Empty)
+            continue;
+
+        if (AsDiffpCompareNames(Value->Alias, Value->AliasLength / sizeof(WCHAR),
+            Match->Alias, Match->AliasLength / sizeof(WCHAR)) == 0)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+* AsDiffValues
+*
+* Purpose:
+*
+* Compare values of contract present in both schemas, matched by alias.
+*
+* Returns number of differences, callback is optional.
+*
+*/
+ULONG AsDiffValues(
+    _In_ PAS_SCHEMA OldSchema,
+    _In_ PAS_NAMESPACE_ENTRY OldEntry,
+    _In_ PAS_SCHEMA NewSchema,
+    _In_ PAS_NAMESPACE_ENTRY NewEntry,
+    _In_opt_ PAS_DIFF_VALUE_CALLBACK Callback,
+    _In_opt_ PVOID Context
+)
+{
+    ULONG i, Differences = 0;
+    AS_VALUE_ENTRY OldValue, NewValue;
+
+    for (i = 0; i < OldEntry->ValueCount; i++) {
+
+        if (!AsSchemaQueryValue(OldSchema, OldEntry, i, &OldValue) || OldValue.Empty)
+            continue;
+
+        if (!AsDiffpFindAlias(NewSchema, NewEntry, &OldValue, &NewValue)) {
+            Differences += 1;
+            if (Callback) Callback(AsDiffRemoved, &OldValue, NULL, Context);
+        }
+        else if (AsDiffpCompareNames(OldValue.Value, OldValue.ValueLength / sizeof(WCHAR),
+            NewValue.Value, NewValue.ValueLength / sizeof(WCHAR)) != 0)
+        {
+            Differences += 1;
+            if (Callback) Callback(AsDiffRetargeted, &OldValue, &NewValue, Context);
+        }
+    }
+
+    for (i = 0; i < NewEntry->ValueCount; i++) {
+
+        if (!AsSchemaQueryValue(NewSchema, NewEntry, i, &NewValue) || NewValue.Empty)
+            continue;
+
+        if (!AsDiffpFindAlias(OldSchema, OldEntry, &NewValue, &OldValue)) {
+            Differences += 1;
+            if (Callback) Callback(AsDiffAdded, NULL, &NewValue, Context);
+        }
+    }
+
+    return Differences;
+}
+
+/*
+* AsDiffSchemas
+*
+* Purpose:
+*
+* Merge contract keys of both schemas and report added, removed and changed
+* contracts through callback, Counts receives number of each kind.
+*
+*/
+BOOL AsDiffSchemas(
+    _In_ HANDLE HeapHandle,
+    _In_ PAS_SCHEMA OldSchema,
+    _In_ PAS_SCHEMA NewSchema,
+    _In_ PAS_DIFF_NAMESPACE_CALLBACK Callback,
+    _In_opt_ PVOID Context,
+    _Out_writes_(AsDiffMax) PULONG Counts
+)
+{
+    INT Result;
+    ULONG i = 0, j = 0, OldCount = 0, NewCount = 0;
+    PAS_DIFF_KEY OldKeys, NewKeys;
+    AS_NAMESPACE_ENTRY OldEntry, NewEntry;
+
+    RtlSecureZeroMemory(Counts, AsDiffMax * sizeof(ULONG));
+
+    OldKeys = AsDiffpBuildKeys(HeapHandle, OldSchema, &OldCount);
+    NewKeys = AsDiffpBuildKeys(HeapHandle, NewSchema, &NewCount);
+
+    if (OldKeys == NULL || NewKeys == NULL) {
+        if (OldKeys) HeapFree(HeapHandle, 0, OldKeys);
+        if (NewKeys) HeapFree(HeapHandle, 0, NewKeys);
+        return FALSE;
+    }
+
+    while (i < OldCount || j < NewCount) {
+
+        if (i == OldCount)
+            Result = 1;
+        else if (j == NewCount)
+            Result = -1;
+        else
+            Result = AsDiffpCompareKeys(&OldKeys[i], &NewKeys[j]);
+
+        if (Result < 0) {
+            if (AsSchemaQueryNamespace(OldSchema, OldKeys[i].NamespaceIndex, &OldEntry)) {
+                Counts[AsDiffRemoved] += 1;
+                Callback(AsDiffRemoved, &OldEntry, NULL, Context);
+            }
+            i++;
+            continue;
+        }
+
+        if (Result > 0) {
+            if (AsSchemaQueryNamespace(NewSchema, NewKeys[j].NamespaceIndex, &NewEntry)) {
+                Counts[AsDiffAdded] += 1;
+                Callback(AsDiffAdded, NULL, &NewEntry, Context);
+            }
+            j++;
+            continue;
+        }
+
+        if (AsSchemaQueryNamespace(OldSchema, OldKeys[i].NamespaceIndex, &OldEntry) &&
+            AsSchemaQueryNamespace(NewSchema, NewKeys[j].NamespaceIndex, &NewEntry))
+        {
+            if (AsDiffpCompareNames(OldEntry.Name, OldEntry.NameLength / sizeof(WCHAR),
+                NewEntry.Name, NewEntry.NameLength / sizeof(WCHAR)) != 0 ||
+                AsDiffValues(OldSchema, &OldEntry, NewSchema, &NewEntry, NULL, NULL) != 0)
+            {
+                Counts[AsDiffChanged] += 1;
+                Callback(AsDiffChanged, &OldEntry, &NewEntry, Context);
+            }
+        }
+        i++;
+        j++;
+    }
+
+    HeapFree(HeapHandle, 0, OldKeys);
+    HeapFree(HeapHandle, 0, NewKeys);
+    return TRUE;
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       DIFF.H
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the ApiSet schema diff engine.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#pragma once
+
+typedef enum _AS_DIFF_KIND {
+    AsDiffAdded = 0,
+    AsDiffRemoved,
+    AsDiffChanged,      //contract in both schemas, version or values differ
+    AsDiffRetargeted,   //value alias in both schemas, host differs
+    AsDiffMax
+} AS_DIFF_KIND;
+
+typedef struct _AS_DIFF_KEY {
+    PCWSTR Name;
+    ULONG KeyLength;    //chars, contract name without last version number
+    ULONG NamespaceIndex;
+} AS_DIFF_KEY, *PAS_DIFF_KEY;
+
+//
+// OldEntry is NULL for added contract, NewEntry is NULL for removed one.
+//
+typedef VOID(CALLBACK *PAS_DIFF_NAMESPACE_CALLBACK)(
+    _In_ AS_DIFF_KIND Kind,
+    _In_opt_ PAS_NAMESPACE_ENTRY OldEntry,
+    _In_opt_ PAS_NAMESPACE_ENTRY NewEntry,
+    _In_opt_ PVOID Context);
+
+//
+// OldValue is NULL for added alias, NewValue is NULL for removed one.
+//
+typedef VOID(CALLBACK *PAS_DIFF_VALUE_CALLBACK)(
+    _In_ AS_DIFF_KIND Kind,
+    _In_opt_ PAS_VALUE_ENTRY OldValue,
+    _In_opt_ PAS_VALUE_ENTRY NewValue,
+    _In_opt_ PVOID Context);
+
+BOOL AsDiffSchemas(
+    _In_ HANDLE HeapHandle,
+    _In_ PAS_SCHEMA OldSchema,
+    _In_ PAS_SCHEMA NewSchema,
+    _In_ PAS_DIFF_NAMESPACE_CALLBACK Callback,
+    _In_opt_ PVOID Context,
+    _Out_writes_(AsDiffMax) PULONG Counts);
+
+ULONG AsDiffValues(
+    _In_ PAS_SCHEMA OldSchema,
+    _In_ PAS_NAMESPACE_ENTRY OldEntry,
+    _In_ PAS_SCHEMA NewSchema,
+    _In_ PAS_NAMESPACE_ENTRY NewEntry,
+    _In_opt_ PAS_DIFF_VALUE_CALLBACK Callback,
+    _In_opt_ PVOID Context);
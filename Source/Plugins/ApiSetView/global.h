@@ -27,6 +27,7 @@
 
 #define OEMRESOURCE
 #include <Windows.h>
+#include <stdlib.h>
 #include <strsafe.h>
 #include <commctrl.h>
 #include <commdlg.h>
@@ -48,6 +49,9 @@
 #include "minirtl/minirtl.h"
 #include "plugin_def.h"
 #include "resource.h"
+#include "schema.h"
+#include "search.h"
+#include "diff.h"
 #include "ui.h"
 #include "query.h"
 
@@ -58,78 +58,58 @@ BOOL OpenDialogExecute(
     return GetOpenFileName(&tag1);
 }
 
-/*
-* TreeView_FindLabel
-*
-* Purpose:
-*
-* Find treelist entry by label.
-*
-*/
-HTREEITEM TreeView_FindLabel(
-    _In_ HWND hwnd,
-    _In_ HTREEITEM hItemParent,
-    _In_ LPCWSTR pszLabel)
-{
-    TVITEMEX tvi;
-    HTREEITEM hChildSearch;
-    WCHAR wchLabel[MAX_PATH];
-
-    for (tvi.hItem = TreeView_GetChild(hwnd, hItemParent);
-        tvi.hItem;
-        tvi.hItem = TreeView_GetNextSibling(hwnd, tvi.hItem))
-    {
-        tvi.mask = TVIF_TEXT | TVIF_CHILDREN;
-        tvi.pszText = wchLabel;
-        tvi.cchTextMax = MAX_PATH;
-        if (TreeList_GetTreeItem(hwnd, &tvi, NULL)) {
-            if (_strcmpi(tvi.pszText, pszLabel) == 0)
-                return tvi.hItem;
-
-            if (tvi.cChildren) {
-                hChildSearch = TreeView_FindLabel(hwnd, tvi.hItem, pszLabel);
-                if (hChildSearch)
-                    return hChildSearch;
-            }
-        }
-    }
-    return 0;
-}
-
 /*
 * HandleSearchSchema
 *
 * Purpose:
 *
-* Search in treelist.
+* Run new search or step through hits of last one.
 *
 */
 VOID HandleSearchSchema(
-    _In_ HWND hwndDlg)
+    _In_ HWND hwndDlg,
+    _In_ UINT ControlId)
 {
     HTREEITEM hItem;
+    PAS_SEARCH_NAME Name;
     WCHAR szSchemaName[MAX_PATH * 2];
+    WCHAR szBuffer[100];
+
+    if (ControlId == IDC_SEARCH_BUTTON) {
+
+        RtlSecureZeroMemory(szSchemaName, sizeof(szSchemaName));
+
+        SendDlgItemMessage(
+            hwndDlg,
+            IDC_SEARCH_EDIT,
+            WM_GETTEXT,
+            (WPARAM)MAX_PATH,
+            (LPARAM)&szSchemaName);
+
+        AsSearchQuery(&g_ctx.SearchIndex, szSchemaName);
+    }
 
-    RtlSecureZeroMemory(szSchemaName, sizeof(szSchemaName));
+    Name = AsSearchMove(&g_ctx.SearchIndex, (ControlId == IDC_SEARCH_PREV));
+    if (Name == NULL) {
+        SetDlgItemText(hwndDlg, IDC_SEARCH_GROUP, TEXT("Search By Name (not found)"));
+        return;
+    }
 
-    SendDlgItemMessage(
-        hwndDlg,
-        IDC_SEARCH_EDIT,
-        WM_GETTEXT,
-        (WPARAM)MAX_PATH,
-        (LPARAM)&szSchemaName);
+    StringCchPrintf(szBuffer, RTL_NUMBER_OF(szBuffer),
+        TEXT("Search By Name (%lu of %lu)"),
+        g_ctx.SearchIndex.Current + 1,
+        g_ctx.SearchIndex.HitCount);
 
-#pragma warning(push)
-#pragma warning(disable: 6054)
-    hItem = TreeView_FindLabel(
-        g_ctx.TreeList,
-        TreeView_GetRoot(g_ctx.TreeList),
-        szSchemaName);
-#pragma warning(pop)
+    SetDlgItemText(hwndDlg, IDC_SEARCH_GROUP, szBuffer);
 
+    //
+    // Only namespace of the hit gets its values listed.
+    //
+    hItem = ListApiSetFindItem(Name->NamespaceIndex, Name->ValueOrdinal);
     if (hItem) {
         TreeList_EnsureVisible(g_ctx.TreeList, hItem);
-        TreeList_Expand(g_ctx.TreeList, hItem, TVE_EXPAND);
+        if (Name->ValueOrdinal == AS_SEARCH_NAMESPACE)
+            TreeList_Expand(g_ctx.TreeList, hItem, TVE_EXPAND);
         SetFocus(g_ctx.TreeList);
     }
 }
@@ -150,6 +130,7 @@ VOID HandleWMNotify(
 {
     TL_SUBITEMS_FIXED *subitems;
     LPNMHDR hdr = (LPNMHDR)lParam;
+    LPNMTREEVIEW pnmtv;
 
     UNREFERENCED_PARAMETER(wParam);
 
@@ -160,6 +141,12 @@ VOID HandleWMNotify(
 
     if (hdr->hwndFrom == TreeList) {
         switch (hdr->code) {
+        case TVN_ITEMEXPANDING:
+            pnmtv = (LPNMTREEVIEW)lParam;
+            if ((pnmtv->action & TVE_ACTIONMASK) == TVE_EXPAND)
+                ListApiSetNamespaceValues(pnmtv->itemNew.hItem);
+            break;
+
         case TVN_ITEMEXPANDED:
         case TVN_SELCHANGED:
             RtlSecureZeroMemory(&tvi, sizeof(tvi));
@@ -283,6 +270,42 @@ BOOL InitTreeList(
     return TRUE;
 }
 
+/*
+* HandleContextMenu
+*
+* Purpose:
+*
+* Treelist popup construction, export is available only with host support.
+*
+*/
+VOID HandleContextMenu(
+    _In_ HWND hwndDlg,
+    _In_ HWND hwndControl
+)
+{
+    POINT pt1;
+    HMENU hMenu;
+
+    if (!WINOBJEX_PARAM_BLOCK_HAS_FIELD(&g_ctx.ParamBlock, uiExportView) ||
+        g_ctx.ParamBlock.uiExportView == NULL)
+    {
+        return;
+    }
+
+    if (hwndControl != TreeList_GetTreeControlWindow(g_ctx.TreeList))
+        return;
+
+    if (GetCursorPos(&pt1) == FALSE)
+        return;
+
+    hMenu = CreatePopupMenu();
+    if (hMenu) {
+        InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_MENU_EXPORT_VIEW, TEXT("Export List..."));
+        TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, pt1.x, pt1.y, 0, hwndDlg, NULL);
+        DestroyMenu(hMenu);
+    }
+}
+
 /*
 * AsWindowDialogProc
 *
@@ -350,11 +373,22 @@ INT_PTR CALLBACK AsWindowDialogProc(
             lParam);
         break;
 
+    case WM_CONTEXTMENU:
+        HandleContextMenu(hwndDlg, (HWND)wParam);
+        break;
+
     case WM_COMMAND:
 
         switch (LOWORD(wParam)) {
+        case ID_MENU_EXPORT_VIEW:
+            ListApiSetAllValues();
+            g_ctx.ParamBlock.uiExportView(hwndDlg, g_ctx.TreeList, ExportViewTreeList, TEXT("ApiSetSchema"));
+            break;
+
         case IDC_SEARCH_BUTTON:
-            HandleSearchSchema(hwndDlg);
+        case IDC_SEARCH_PREV:
+        case IDC_SEARCH_NEXT:
+            HandleSearchSchema(hwndDlg, LOWORD(wParam));
             break;
 
         case IDC_BROWSE_BUTTON:
@@ -367,6 +401,16 @@ INT_PTR CALLBACK AsWindowDialogProc(
             }
             break;
 
+        case IDC_COMPARE_BUTTON:
+            RtlSecureZeroMemory(szOpenFileName, sizeof(szOpenFileName));
+            if (OpenDialogExecute(hwndDlg,
+                szOpenFileName,
+                TEXT("All files\0*.*\0\0")))
+            {
+                ListApiSetDiffFromFile(szOpenFileName);
+            }
+            break;
+
         case IDOK:
         case IDCANCEL:
             g_PluginQuit = TRUE;
@@ -393,6 +437,9 @@ INT_PTR CALLBACK AsWindowDialogProc(
 */
 VOID PluginFreeGlobalResources()
 {
+    AsSearchDestroy(&g_ctx.SearchIndex);
+    AsSchemaClose(&g_ctx.Schema);
+
     if (g_ctx.PluginHeap) {
         HeapDestroy(g_ctx.PluginHeap);
         g_ctx.PluginHeap = NULL;
@@ -463,6 +510,9 @@ NTSTATUS CALLBACK StartPlugin(
     NTSTATUS Status;
     WINOBJEX_PLUGIN_STATE State = PluginInitialization;
 
+    if (ParamBlock->cbSize < WINOBJEX_PARAM_BLOCK_MIN_SIZE)
+        return STATUS_NOT_SUPPORTED;
+
     RtlSecureZeroMemory(&g_ctx, sizeof(g_ctx));
 
     g_ctx.PluginHeap = HeapCreate(0, 0, 0);
@@ -471,7 +521,10 @@ NTSTATUS CALLBACK StartPlugin(
 
     HeapSetInformation(g_ctx.PluginHeap, HeapEnableTerminationOnCorruption, NULL, 0);
 
-    RtlCopyMemory(&g_ctx.ParamBlock, ParamBlock, sizeof(WINOBJEX_PARAM_BLOCK));
+    //
+    // Host may be older than plugin, members not provided by it stay zeroed.
+    //
+    RtlCopyMemory(&g_ctx.ParamBlock, ParamBlock, WINOBJEX_PARAM_BLOCK_COPY_SIZE(ParamBlock));
 
     g_ctx.WorkerThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)PluginThread, (PVOID)NULL, 0, &ThreadId);
     if (g_ctx.WorkerThread) {
@@ -36,6 +36,7 @@ HTREEITEM TreeListAddItem(
     _In_ UINT mask,
     _In_ UINT state,
     _In_ UINT stateMask,
+    _In_ INT cChildren,
     _In_opt_ LPWSTR pszText,
     _In_opt_ PVOID subitems
 )
@@ -48,11 +49,40 @@ HTREEITEM TreeListAddItem(
     tvitem.item.mask = mask;
     tvitem.item.state = state;
     tvitem.item.stateMask = stateMask;
+    tvitem.item.cChildren = cChildren;
     tvitem.item.pszText = pszText;
     tvitem.hInsertAfter = TVI_LAST;
     return TreeList_InsertTreeItem(TreeList, &tvitem, si);
 }
 
+/*
+* CopySchemaString
+*
+* Purpose:
+*
+* Copy schema string to zero terminated buffer, truncate if it does not fit.
+*
+*/
+LPWSTR CopySchemaString(
+    _In_opt_ PCWSTR String,
+    _In_ ULONG Length,
+    _Out_writes_(cchBuffer) LPWSTR Buffer,
+    _In_ ULONG cchBuffer
+)
+{
+    ULONG cch = Length / sizeof(WCHAR);
+
+    if (String == NULL)
+        cch = 0;
+
+    if (cch >= cchBuffer)
+        cch = cchBuffer - 1;
+
+    if (cch) RtlCopyMemory(Buffer, String, cch * sizeof(WCHAR));
+    Buffer[cch] = 0;
+    return Buffer;
+}
+
 /*
 * OutNamespaceEntryEx
 *
@@ -60,47 +90,28 @@ HTREEITEM TreeListAddItem(
 *
 * Namespace entry formatted output routine.
 *
+* Values are not inserted here, item only gets expand button and
+* namespace index (plus one) in subitems user param.
+*
 */
 HTREEITEM OutNamespaceEntryEx(
-    HTREEITEM RootItem,
-    PBYTE Namespace,
-    ULONG NameOffset,
-    ULONG NameLength,
-    ULONG Flags,
-    BOOL FlagsValid
+    _In_ HTREEITEM RootItem,
+    _In_ PAS_NAMESPACE_ENTRY Entry,
+    _In_ ULONG Index
 )
 {
     TL_SUBITEMS_FIXED  subitems;
-    PWSTR Name, NameCopy, sptr;
-    HTREEITEM hSubItem;
+    PWSTR sptr;
     WCHAR szBuffer[20];
-
-    if (NameOffset == 0)
-        return 0;
-
-    Name = (PWSTR)RtlOffsetToPointer(Namespace, NameOffset);
-
-    NameCopy = HeapAlloc(g_ctx.PluginHeap, HEAP_ZERO_MEMORY, NameLength + sizeof(WCHAR));
-    if (NameCopy == NULL)
-        return 0;
-
-    sptr = NameCopy;
-
-    RtlCopyMemory(
-        sptr,
-        Name,
-        NameLength);
-
-    sptr += (NameLength / sizeof(WCHAR));
-    *sptr = 0;
+    WCHAR szName[MAX_PATH + 1];
 
     RtlSecureZeroMemory(&subitems, sizeof(subitems));
 
     subitems.Text[0] = L"";
 
-    if (FlagsValid && Flags) {
+    if (Entry->FlagsValid && Entry->Flags) {
         szBuffer[0] = 0;
-        ultostr(Flags, szBuffer);
+        ultostr(Entry->Flags, szBuffer);
         sptr = szBuffer;
     }
     else {
@@ -109,18 +120,17 @@ HTREEITEM OutNamespaceEntryEx(
     subitems.Text[1] = sptr;
 
     subitems.Count = 2;
+    subitems.UserParam = (PVOID)((ULONG_PTR)Index + 1);
 
-    hSubItem = TreeListAddItem(
+    return TreeListAddItem(
         g_ctx.TreeList,
         RootItem,
-        TVIF_TEXT | TVIF_STATE,
+        TVIF_TEXT | TVIF_STATE | TVIF_CHILDREN,
         (UINT)0,
         (UINT)0,
-        NameCopy,
+        (Entry->ValueCount) ? 1 : 0,
+        CopySchemaString(Entry->Name, Entry->NameLength, szName, RTL_NUMBER_OF(szName)),
         &subitems);
-
-    HeapFree(g_ctx.PluginHeap, 0, NameCopy);
-    return hSubItem;
 }
 
 /*
@@ -131,73 +141,26 @@ HTREEITEM OutNamespaceEntryEx(
 * Namespace value formatted output routine.
 *
 */
-void OutNamespaceValueEx(
-    HTREEITEM RootItem,
-    PBYTE Namespace,
-    ULONG ValueOffset,
-    ULONG ValueLength,
-    ULONG NameOffset,
-    ULONG NameLength,
-    ULONG Flags,
-    BOOL FlagsValid
+VOID OutNamespaceValueEx(
+    _In_ HTREEITEM RootItem,
+    _In_ PAS_VALUE_ENTRY Value
 )
 {
     TL_SUBITEMS_FIXED  subitems;
-    PWSTR NamePtr, ValueName = NULL, AliasName = NULL, sptr = NULL;
+    PWSTR sptr;
     WCHAR szBuffer[20];
+    WCHAR szValue[MAX_PATH + 1], szAlias[MAX_PATH + 1];
 
     RtlSecureZeroMemory(&subitems, sizeof(subitems));
 
-    // print value name
-
-    if (ValueLength) {
-
-        NamePtr = (PWSTR)RtlOffsetToPointer(Namespace, ValueOffset);
-
-        ValueName = HeapAlloc(g_ctx.PluginHeap, HEAP_ZERO_MEMORY, ValueLength + sizeof(WCHAR));
-        if (ValueName) {
-            sptr = ValueName;
-
-            RtlCopyMemory(
-                sptr,
-                NamePtr,
-                ValueLength);
-
-            sptr += (ValueLength / sizeof(WCHAR));
-            *sptr = 0;
-
-        }
-    }
-
-    // print value alias
-    if (NameLength) {
-
-        NamePtr = (PWSTR)RtlOffsetToPointer(Namespace, NameOffset);
-
-        AliasName = HeapAlloc(g_ctx.PluginHeap, HEAP_ZERO_MEMORY, NameLength + sizeof(WCHAR));
-        if (AliasName) {
-            sptr = AliasName;
-
-            RtlCopyMemory(
-                sptr,
-                NamePtr,
-                NameLength);
-
-            sptr += (NameLength / sizeof(WCHAR));
-            *sptr = 0;
-
-            sptr = AliasName;
-
-        }
-    }
-    else {
-        sptr = L"";
-    }
-    subitems.Text[0] = sptr;
+    subitems.Text[0] = CopySchemaString(Value->Alias,
+        Value->AliasLength,
+        szAlias,
+        RTL_NUMBER_OF(szAlias));
 
-    if (FlagsValid && Flags) {
+    if (Value->FlagsValid && Value->Flags) {
         szBuffer[0] = 0;
-        ultostr(Flags, szBuffer);
+        ultostr(Value->Flags, szBuffer);
         sptr = szBuffer;
     }
     else {
@@ -212,178 +175,158 @@ void OutNamespaceValueEx(
         TVIF_TEXT | TVIF_STATE,
         (UINT)0,
         (UINT)0,
-        ValueName,
+        0,
+        CopySchemaString(Value->Value, Value->ValueLength, szValue, RTL_NUMBER_OF(szValue)),
         &subitems);
-
-    if (ValueName) HeapFree(g_ctx.PluginHeap, 0, ValueName);
-    if (AliasName) HeapFree(g_ctx.PluginHeap, 0, AliasName);
 }
 
 /*
-* ListApiSetV2
+* ListApiSetNamespaces
 *
 * Purpose:
 *
-* Parse and output ApiSet Version 2 (Windows 7).
+* Output namespace entries of mapped schema, any version.
 *
 */
-void ListApiSetV2(
-    _In_ PVOID ApiSetMap,
+VOID ListApiSetNamespaces(
+    _In_ PAS_SCHEMA Schema,
     _In_ HTREEITEM RootItem
 )
 {
-    API_SET_NAMESPACE_ARRAY_V2 *Namespace = (API_SET_NAMESPACE_ARRAY_V2*)ApiSetMap;
-
-    ULONG i, j;
-
-    API_SET_NAMESPACE_ENTRY_V2 *NsEntry;
-    API_SET_VALUE_ARRAY_V2 *ValuesArray;
-    API_SET_VALUE_ENTRY_V2 *ValueEntry;
-
-    HTREEITEM hSubItem;
-
-    for (i = 0; i < Namespace->Count; i++) {
-
-        NsEntry = &Namespace->Array[i];
-
-        hSubItem = OutNamespaceEntryEx(
-            RootItem,
-            (PBYTE)Namespace,
-            NsEntry->NameOffset,
-            NsEntry->NameLength,
-            0,
-            FALSE);
-
-        ValuesArray = (API_SET_VALUE_ARRAY_V2*)RtlOffsetToPointer(Namespace, NsEntry->DataOffset);
-
-        for (j = 0; j < ValuesArray->Count; j++) {
-
-            ValueEntry = &ValuesArray->Array[j];
-
-            if (!API_SET_EMPTY_NAMESPACE_VALUE(ValueEntry)) {
-                OutNamespaceValueEx(
-                    hSubItem,
-                    (PBYTE)Namespace,
-                    ValueEntry->ValueOffset,
-                    ValueEntry->ValueLength,
-                    ValueEntry->NameOffset,
-                    ValueEntry->NameLength,
-                    0,
-                    FALSE);
-            }
+    ULONG i;
+    HTREEITEM hItem;
+    AS_NAMESPACE_ENTRY Entry;
+
+    for (i = 0; i < Schema->NamespaceCount; i++) {
+        if (AsSchemaQueryNamespace(Schema, i, &Entry)) {
+            hItem = OutNamespaceEntryEx(RootItem, &Entry, i);
+            if (g_ctx.NamespaceItems)
+                g_ctx.NamespaceItems[i] = hItem;
         }
     }
 }
 
 /*
-* ListApiSetV4
+* ListApiSetNamespaceValues
 *
 * Purpose:
 *
-* Parse and output ApiSet Version 4 (Windows 8.x).
+* Output values of namespace item on first expansion.
 *
 */
-void ListApiSetV4(
-    _In_ PVOID ApiSetMap,
-    _In_ HTREEITEM RootItem
-)
+VOID ListApiSetNamespaceValues(
+    _In_ HTREEITEM NamespaceItem)
 {
-    API_SET_NAMESPACE_ARRAY_V4 *Namespace = (API_SET_NAMESPACE_ARRAY_V4*)ApiSetMap;
-
-    ULONG i, j;
+    ULONG Index, i, Count = 0;
+    TVITEMEX tvi;
+    PTL_SUBITEMS subitems = NULL;
+    AS_NAMESPACE_ENTRY Entry;
+    AS_VALUE_ENTRY Value;
+    WCHAR szBuffer[MAX_PATH];
 
-    API_SET_NAMESPACE_ENTRY_V4 *NsEntry;
-    API_SET_VALUE_ARRAY_V4 *ValuesArray;
-    API_SET_VALUE_ENTRY_V4 *ValueEntry;
+    if (g_ctx.Schema.Data == NULL)
+        return;
 
-    HTREEITEM hSubItem;
+    //
+    // Values are already listed.
+    //
+    if (TreeList_GetChild(g_ctx.TreeList, NamespaceItem))
+        return;
 
-    for (i = 0; i < Namespace->Count; i++) {
+    RtlSecureZeroMemory(&tvi, sizeof(tvi));
+    tvi.hItem = NamespaceItem;
+    if (!TreeList_GetTreeItem(g_ctx.TreeList, &tvi, &subitems))
+        return;
 
-        NsEntry = &Namespace->Array[i];
+    if (subitems == NULL || subitems->UserParam == NULL)
+        return;
 
-        hSubItem = OutNamespaceEntryEx(
-            RootItem,
-            (PBYTE)Namespace,
-            NsEntry->NameOffset,
-            NsEntry->NameLength,
-            NsEntry->Flags,
-            TRUE);
+    Index = (ULONG)((ULONG_PTR)subitems->UserParam - 1);
 
-        ValuesArray = (API_SET_VALUE_ARRAY_V4*)RtlOffsetToPointer(Namespace, NsEntry->DataOffset);
+    __try {
+        if (AsSchemaQueryNamespace(&g_ctx.Schema, Index, &Entry)) {
+            for (i = 0; i < Entry.ValueCount; i++) {
+                if (AsSchemaQueryValue(&g_ctx.Schema, &Entry, i, &Value) && !Value.Empty) {
+                    OutNamespaceValueEx(NamespaceItem, &Value);
+                    Count += 1;
+                }
+            }
+        }
+    }
+    __except (EXCEPTION_EXECUTE_HANDLER) {
 
-        for (j = 0; j < ValuesArray->Count; j++) {
+        StringCchPrintf(
+            szBuffer,
+            MAX_PATH,
+            TEXT("ApiSetView: Exception %lu thrown while processing apiset, schema version %lu"),
+            GetExceptionCode(),
+            g_ctx.Schema.Version);
 
-            ValueEntry = &ValuesArray->Array[j];
+        ApiSetViewShowError(szBuffer);
+    }
 
-            if (!API_SET_EMPTY_NAMESPACE_VALUE(ValueEntry)) {
-                OutNamespaceValueEx(
-                    hSubItem,
-                    (PBYTE)Namespace,
-                    ValueEntry->ValueOffset,
-                    ValueEntry->ValueLength,
-                    ValueEntry->NameOffset,
-                    ValueEntry->NameLength,
-                    ValueEntry->Flags,
-                    TRUE);
-            }
-        }
+    //
+    // Nothing to show, drop expand button.
+    //
+    if (Count == 0) {
+        RtlSecureZeroMemory(&tvi, sizeof(tvi));
+        tvi.mask = TVIF_CHILDREN;
+        tvi.hItem = NamespaceItem;
+        tvi.cChildren = 0;
+        TreeList_SetTreeItem(g_ctx.TreeList, &tvi, NULL);
     }
 }
 
 /*
-* ListApiSetV6
+* ListApiSetAllValues
 *
 * Purpose:
 *
-* Parse and output ApiSet Version 6 (Windows 10).
+* Output values of every namespace, used when whole tree is required.
 *
 */
-void ListApiSetV6(
-    _In_ PVOID ApiSetMap,
-    _In_ HTREEITEM RootItem
-)
+VOID ListApiSetAllValues(
+    VOID)
 {
-    API_SET_NAMESPACE_ARRAY_V6 *Namespace = (API_SET_NAMESPACE_ARRAY_V6*)ApiSetMap;
-
-    ULONG i, j;
-
-    API_SET_NAMESPACE_ENTRY_V6 *NsEntry;
-    API_SET_VALUE_ENTRY_V6 *ValueEntry;
+    HTREEITEM hItem;
 
-    HTREEITEM hSubItem;
-
-    NsEntry = (API_SET_NAMESPACE_ENTRY_V6*)RtlOffsetToPointer(Namespace, Namespace->NamespaceEntryOffset);
+    hItem = TreeList_GetChild(g_ctx.TreeList, TreeList_GetRoot(g_ctx.TreeList));
+    while (hItem) {
+        ListApiSetNamespaceValues(hItem);
+        hItem = TreeList_GetNextSibling(g_ctx.TreeList, hItem);
+    }
+}
 
-    for (i = 0; i < Namespace->Count; i++) {
+/*
+* ListApiSetFindItem
+*
+* Purpose:
+*
+* Return tree item of namespace or its value, listing values if required.
+*
+*/
+HTREEITEM ListApiSetFindItem(
+    _In_ ULONG NamespaceIndex,
+    _In_ ULONG ValueOrdinal)
+{
+    HTREEITEM hItem;
 
-        hSubItem = OutNamespaceEntryEx(
-            RootItem,
-            (PBYTE)Namespace,
-            NsEntry->NameOffset,
-            NsEntry->NameLength,
-            NsEntry->Flags,
-            TRUE);
+    if (g_ctx.NamespaceItems == NULL || NamespaceIndex >= g_ctx.Schema.NamespaceCount)
+        return NULL;
 
-        ValueEntry = (API_SET_VALUE_ENTRY_V6*)RtlOffsetToPointer(Namespace, NsEntry->DataOffset);
+    hItem = g_ctx.NamespaceItems[NamespaceIndex];
+    if (hItem == NULL || ValueOrdinal == AS_SEARCH_NAMESPACE)
+        return hItem;
 
-        for (j = 0; j < NsEntry->Count; j++) {
+    ListApiSetNamespaceValues(hItem);
 
-            if (!API_SET_EMPTY_NAMESPACE_VALUE(ValueEntry)) {
-                OutNamespaceValueEx(
-                    hSubItem,
-                    (PBYTE)Namespace,
-                    ValueEntry->ValueOffset,
-                    ValueEntry->ValueLength,
-                    ValueEntry->NameOffset,
-                    ValueEntry->NameLength,
-                    ValueEntry->Flags,
-                    TRUE);
-            }
-            ValueEntry = (API_SET_VALUE_ENTRY_V6*)RtlOffsetToPointer(ValueEntry, sizeof(API_SET_VALUE_ENTRY_V6));
-        }
-        NsEntry = (API_SET_NAMESPACE_ENTRY_V6*)RtlOffsetToPointer(NsEntry, sizeof(API_SET_NAMESPACE_ENTRY_V6));
+    hItem = TreeList_GetChild(g_ctx.TreeList, hItem);
+    while (hItem && ValueOrdinal) {
+        hItem = TreeList_GetNextSibling(g_ctx.TreeList, hItem);
+        ValueOrdinal -= 1;
     }
+
+    return hItem;
 }
 
 /*
@@ -404,6 +347,89 @@ VOID ApiSetViewShowError(
 #endif
 }
 
+/*
+* ApiSetViewShowOpenError
+*
+* Purpose:
+*
+* Explain AsSchemaOpen failure.
+*
+*/
+VOID ApiSetViewShowOpenError(
+    _In_ ULONG Result,
+    _In_ ULONG SchemaVersion)
+{
+    WCHAR szBuffer[MAX_PATH];
+
+    switch (Result) {
+
+    //
+    // Warn user if apiset section was not found.
+    //
+    case ERROR_INVALID_DATA:
+        ApiSetViewShowError(TEXT("ApiSetView: could not locate \".apiset\" section in target dll"));
+        break;
+
+    //
+    // Unsupported schema version.
+    //
+    case ERROR_INVALID_DATATYPE:
+        StringCchPrintf(szBuffer, MAX_PATH,
+            TEXT("ApiSetView: Unknown schema version %lu"), SchemaVersion);
+
+        ApiSetViewShowError(szBuffer);
+        break;
+
+    case ERROR_FILE_CORRUPT:
+        ApiSetViewShowError(TEXT("ApiSetView: apiset section is corrupted"));
+        break;
+
+    default:
+        ApiSetViewShowError(TEXT("ApiSetView: could not load apiset library"));
+        break;
+    }
+}
+
+/*
+* ApiSetViewEnableControls
+*
+* Purpose:
+*
+* Disable controls while worker thread runs and enable them back.
+*
+*/
+VOID ApiSetViewEnableControls(
+    _In_ BOOL Enable)
+{
+    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_BROWSE_BUTTON), Enable);
+    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_COMPARE_BUTTON), Enable);
+    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_SEARCH_BUTTON), Enable);
+    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_SEARCH_PREV), Enable);
+    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_SEARCH_NEXT), Enable);
+}
+
+/*
+* ApiSetViewResetTree
+*
+* Purpose:
+*
+* Remove tree items and everything that refers to them.
+*
+*/
+VOID ApiSetViewResetTree(
+    VOID)
+{
+    TreeList_ClearTree(g_ctx.TreeList);
+    SetDlgItemText(g_ctx.MainWindow, IDC_SEARCH_GROUP, TEXT("Search By Name"));
+
+    AsSearchDestroy(&g_ctx.SearchIndex);
+
+    if (g_ctx.NamespaceItems) {
+        HeapFree(g_ctx.PluginHeap, 0, g_ctx.NamespaceItems);
+        g_ctx.NamespaceItems = NULL;
+    }
+}
+
 /*
 * ListApiSetFromFileWorker
 *
@@ -416,27 +442,14 @@ VOID ListApiSetFromFileWorker(
     _In_opt_ LPWSTR lpFileName)
 {
     ULONG Result = ERROR_SUCCESS;
-    UINT i;
 
-    HMODULE MappedApiSetImage;
     LPWSTR FileName;
 
-    PBYTE BaseAddress;
-    PIMAGE_NT_HEADERS NtHeaders;
-    IMAGE_SECTION_HEADER* SectionTableEntry;
-    ULONG DataSize = 0;
-    PBYTE DataPtr = NULL;
-    ULONG SchemaVersion;
-
     WCHAR szSystemDirectory[MAX_PATH + 1], szBuffer[MAX_PATH * 2];
 
     HTREEITEM h_tviRootItem;
 
-    //
-    // Disable controls.
-    //
-    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_BROWSE_BUTTON), FALSE);
-    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_SEARCH_BUTTON), FALSE);
+    ApiSetViewEnableControls(FALSE);
 
     do {
 
@@ -456,119 +469,59 @@ VOID ListApiSetFromFileWorker(
         }
 
         //
-        // Reset output controls.
+        // Reset output controls, tree items must be gone before schema is unmapped.
         //
 
-        TreeList_ClearTree(g_ctx.TreeList);
+        ApiSetViewResetTree();
         SetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_VERSION, TEXT(""));
         SetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_FILE, TEXT(""));
 
+        AsSchemaClose(&g_ctx.Schema);
+
         //
-        // Load library and locate apiset section.
+        // Map file and locate apiset section.
         //
 
-        MappedApiSetImage = LoadLibraryEx(FileName, NULL, LOAD_LIBRARY_AS_DATAFILE);
+        Result = AsSchemaOpen(FileName, &g_ctx.Schema);
 
-        if (MappedApiSetImage == NULL) {
-            ApiSetViewShowError(TEXT("ApiSetView: could not load apiset library"));
-            Result = GetLastError();
+        if (Result != ERROR_SUCCESS) {
+            ApiSetViewShowOpenError(Result, g_ctx.Schema.Version);
             break;
         }
 
         SetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_FILE, FileName);
 
-        BaseAddress = (PBYTE)(((ULONG_PTR)MappedApiSetImage) & ~3);
-
-        NtHeaders = RtlImageNtHeader(BaseAddress);
-
-        SectionTableEntry = IMAGE_FIRST_SECTION(NtHeaders);
-
-        i = NtHeaders->FileHeader.NumberOfSections;
-        while (i > 0) {
-            if (_strncmpi_a((CHAR*)&SectionTableEntry->Name,
-                API_SET_SECTION_NAME,
-                sizeof(API_SET_SECTION_NAME)) == 0)
-            {
-                DataSize = SectionTableEntry->SizeOfRawData;
-                DataPtr = (PBYTE)BaseAddress + SectionTableEntry->PointerToRawData;
-                break;
-            }
-            i -= 1;
-            SectionTableEntry += 1;
-        }
-
-        //
-        // Warn user if apiset section was not found.
-        //
-        if ((DataPtr == NULL) || (DataSize == 0)) {
-            ApiSetViewShowError(TEXT("ApiSetView: could not locate \".apiset\" section in target dll"));
-            Result = ERROR_INVALID_DATA;
-            break;
-        }
-
-        //
-        // Check supported schema version.
-        //
-        SchemaVersion = *(ULONG*)DataPtr;
-        if (SchemaVersion != 2 && 
-            SchemaVersion != 4 
-            && SchemaVersion != 6) 
-        {
-            StringCchPrintf(szBuffer, MAX_PATH,
-                TEXT("ApiSetView: Unknown schema version %lu"), SchemaVersion);
-
-            ApiSetViewShowError(szBuffer);
-            Result = ERROR_INVALID_DATATYPE;
-            break;
-        }
-
         RtlSecureZeroMemory(szBuffer, sizeof(szBuffer));
-        ultostr(SchemaVersion, szBuffer);
+        ultostr(g_ctx.Schema.Version, szBuffer);
         SetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_VERSION, szBuffer);
 
         //
-        // Parse and output apiset.
+        // Output namespaces, values are listed on expansion.
         //
 
+        if (g_ctx.Schema.NamespaceCount) {
+            g_ctx.NamespaceItems = (HTREEITEM*)HeapAlloc(g_ctx.PluginHeap,
+                HEAP_ZERO_MEMORY,
+                (SIZE_T)g_ctx.Schema.NamespaceCount * sizeof(HTREEITEM));
+        }
+
         h_tviRootItem = TreeListAddItem(
             g_ctx.TreeList,
             (HTREEITEM)NULL,
             TVIF_TEXT | TVIF_STATE,
             TVIS_EXPANDED,
             TVIS_EXPANDED,
+            0,
             TEXT("ApiSetSchema"),
             (PVOID)NULL);
 
         if (h_tviRootItem) {
             __try {
-                switch (SchemaVersion) {
-                case API_SET_SCHEMA_VERSION_V2:
-
-                    ListApiSetV2(
-                        DataPtr,
-                        h_tviRootItem);
-
-                    break;
 
-                case API_SET_SCHEMA_VERSION_V4:
+                ListApiSetNamespaces(&g_ctx.Schema, h_tviRootItem);
 
-                    ListApiSetV4(
-                        DataPtr,
-                        h_tviRootItem);
+                AsSearchCreate(g_ctx.PluginHeap, &g_ctx.Schema, &g_ctx.SearchIndex);
 
-                    break;
-
-                case API_SET_SCHEMA_VERSION_V6:
-
-                    ListApiSetV6(
-                        DataPtr,
-                        h_tviRootItem);
-
-                    break;
-
-                default:
-                    break;
-                }
             }
             __except (EXCEPTION_EXECUTE_HANDLER) {
 
@@ -579,7 +532,7 @@ VOID ListApiSetFromFileWorker(
                     MAX_PATH,
                     TEXT("ApiSetView: Exception %lu thrown while processing apiset, schema version %lu"),
                     GetExceptionCode(),
-                    SchemaVersion);
+                    g_ctx.Schema.Version);
 
                 ApiSetViewShowError(szBuffer);
 
@@ -588,13 +541,7 @@ VOID ListApiSetFromFileWorker(
 
     } while (FALSE);
 
-    if (MappedApiSetImage) FreeLibrary(MappedApiSetImage);
-
-    //
-    // Reenable controls.
-    //
-    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_BROWSE_BUTTON), TRUE);
-    EnableWindow(GetDlgItem(g_ctx.MainWindow, IDC_SEARCH_BUTTON), TRUE);
+    ApiSetViewEnableControls(TRUE);
 
     ExitThread(Result);
 }
@@ -623,3 +570,339 @@ VOID ListApiSetFromFile(
 
     if (hThread) CloseHandle(hThread);
 }
+
+/*
+* OutDiffItem
+*
+* Purpose:
+*
+* Diff view item output routine, items carry no namespace index.
+*
+*/
+HTREEITEM OutDiffItem(
+    _In_ HTREEITEM RootItem,
+    _In_ LPWSTR Text,
+    _In_opt_ LPWSTR Alias
+)
+{
+    TL_SUBITEMS_FIXED  subitems;
+
+    RtlSecureZeroMemory(&subitems, sizeof(subitems));
+    subitems.Text[0] = (Alias) ? Alias : L"";
+    subitems.Text[1] = L"";
+    subitems.Count = 2;
+
+    return TreeListAddItem(
+        g_ctx.TreeList,
+        RootItem,
+        TVIF_TEXT | TVIF_STATE,
+        (UINT)0,
+        (UINT)0,
+        0,
+        Text,
+        &subitems);
+}
+
+/*
+* DiffValueCallback
+*
+* Purpose:
+*
+* Output value difference of changed contract.
+*
+*/
+VOID CALLBACK DiffValueCallback(
+    _In_ AS_DIFF_KIND Kind,
+    _In_opt_ PAS_VALUE_ENTRY OldValue,
+    _In_opt_ PAS_VALUE_ENTRY NewValue,
+    _In_opt_ PVOID Context
+)
+{
+    PDIFF_VIEW_CONTEXT DiffContext = (PDIFF_VIEW_CONTEXT)Context;
+    PAS_VALUE_ENTRY Value = (NewValue) ? NewValue : OldValue;
+    WCHAR szOld[MAX_PATH + 1], szNew[MAX_PATH + 1], szAlias[MAX_PATH + 1];
+    WCHAR szText[MAX_PATH * 2 + 20];
+
+    if (DiffContext == NULL || Value == NULL)
+        return;
+
+    CopySchemaString(Value->Alias, Value->AliasLength, szAlias, RTL_NUMBER_OF(szAlias));
+
+    switch (Kind) {
+
+    case AsDiffAdded:
+    case AsDiffRemoved:
+        StringCchPrintf(szText, RTL_NUMBER_OF(szText),
+            (Kind == AsDiffAdded) ? TEXT("%s (added)") : TEXT("%s (removed)"),
+            CopySchemaString(Value->Value, Value->ValueLength, szNew, RTL_NUMBER_OF(szNew)));
+        break;
+
+    case AsDiffRetargeted:
+        if (OldValue == NULL || NewValue == NULL)
+            return;
+
+        StringCchPrintf(szText, RTL_NUMBER_OF(szText), TEXT("%s -> %s"),
+            CopySchemaString(OldValue->Value, OldValue->ValueLength, szOld, RTL_NUMBER_OF(szOld)),
+            CopySchemaString(NewValue->Value, NewValue->ValueLength, szNew, RTL_NUMBER_OF(szNew)));
+        break;
+
+    default:
+        return;
+    }
+
+    OutDiffItem(DiffContext->Current, szText, szAlias);
+}
+
+/*
+* DiffNamespaceCallback
+*
+* Purpose:
+*
+* Output contract difference under its group item.
+*
+*/
+VOID CALLBACK DiffNamespaceCallback(
+    _In_ AS_DIFF_KIND Kind,
+    _In_opt_ PAS_NAMESPACE_ENTRY OldEntry,
+    _In_opt_ PAS_NAMESPACE_ENTRY NewEntry,
+    _In_opt_ PVOID Context
+)
+{
+    ULONG i;
+    PDIFF_VIEW_CONTEXT DiffContext = (PDIFF_VIEW_CONTEXT)Context;
+    PAS_SCHEMA Schema;
+    PAS_NAMESPACE_ENTRY Entry;
+    HTREEITEM hItem;
+    AS_VALUE_ENTRY Value;
+    WCHAR szOld[MAX_PATH + 1], szNew[MAX_PATH + 1];
+    WCHAR szText[MAX_PATH * 2 + 10];
+
+    if (DiffContext == NULL || Kind > AsDiffChanged)
+        return;
+
+    if (Kind == AsDiffChanged) {
+
+        if (OldEntry == NULL || NewEntry == NULL)
+            return;
+
+        CopySchemaString(OldEntry->Name, OldEntry->NameLength, szOld, RTL_NUMBER_OF(szOld));
+        CopySchemaString(NewEntry->Name, NewEntry->NameLength, szNew, RTL_NUMBER_OF(szNew));
+
+        if (_strcmpi(szOld, szNew) != 0)
+            StringCchPrintf(szText, RTL_NUMBER_OF(szText), TEXT("%s -> %s"), szOld, szNew);
+        else
+            StringCchCopy(szText, RTL_NUMBER_OF(szText), szNew);
+
+        DiffContext->Current = OutDiffItem(DiffContext->Group[Kind], szText, NULL);
+        if (DiffContext->Current) {
+            AsDiffValues(DiffContext->OldSchema, OldEntry,
+                DiffContext->NewSchema, NewEntry,
+                DiffValueCallback, DiffContext);
+        }
+        return;
+    }
+
+    //
+    // Whole contract added or removed, list all its values.
+    //
+    if (Kind == AsDiffAdded) {
+        Schema = DiffContext->NewSchema;
+        Entry = NewEntry;
+    }
+    else {
+        Schema = DiffContext->OldSchema;
+        Entry = OldEntry;
+    }
+
+    if (Entry == NULL)
+        return;
+
+    hItem = OutDiffItem(DiffContext->Group[Kind],
+        CopySchemaString(Entry->Name, Entry->NameLength, szText, RTL_NUMBER_OF(szText)),
+        NULL);
+
+    if (hItem) {
+        for (i = 0; i < Entry->ValueCount; i++) {
+            if (AsSchemaQueryValue(Schema, Entry, i, &Value) && !Value.Empty)
+                OutNamespaceValueEx(hItem, &Value);
+        }
+    }
+}
+
+/*
+* ListApiSetDiffWorker
+*
+* Purpose:
+*
+* Worker thread, compare loaded schema with given file.
+*
+*/
+VOID ListApiSetDiffWorker(
+    _In_ LPWSTR lpFileName)
+{
+    ULONG Result = ERROR_SUCCESS, i;
+    AS_SCHEMA NewSchema;
+    DIFF_VIEW_CONTEXT DiffContext;
+    HTREEITEM h_tviRootItem;
+    TVITEMEX tvi;
+    ULONG Counts[AsDiffMax];
+    WCHAR szBuffer[MAX_PATH * 2 + 10];
+    WCHAR szOldFile[MAX_PATH + 1];
+
+    LPWSTR GroupNames[] = {
+        TEXT("Added"),
+        TEXT("Removed"),
+        TEXT("Changed")
+    };
+
+    ApiSetViewEnableControls(FALSE);
+
+    RtlSecureZeroMemory(&NewSchema, sizeof(NewSchema));
+
+    do {
+
+        if (g_ctx.Schema.Data == NULL) {
+            ApiSetViewShowError(TEXT("ApiSetView: load schema to compare with first"));
+            Result = ERROR_INVALID_FUNCTION;
+            break;
+        }
+
+        Result = AsSchemaOpen(lpFileName, &NewSchema);
+        if (Result != ERROR_SUCCESS) {
+            ApiSetViewShowOpenError(Result, NewSchema.Version);
+            break;
+        }
+
+        //
+        // Namespace items and search hits refer to the old tree, drop them.
+        // Loaded schema is kept, it is the left side of comparison.
+        //
+
+        ApiSetViewResetTree();
+
+        h_tviRootItem = TreeListAddItem(
+            g_ctx.TreeList,
+            (HTREEITEM)NULL,
+            TVIF_TEXT | TVIF_STATE,
+            TVIS_EXPANDED,
+            TVIS_EXPANDED,
+            0,
+            TEXT("ApiSetSchema diff"),
+            (PVOID)NULL);
+
+        if (h_tviRootItem == NULL)
+            break;
+
+        RtlSecureZeroMemory(&DiffContext, sizeof(DiffContext));
+        DiffContext.OldSchema = &g_ctx.Schema;
+        DiffContext.NewSchema = &NewSchema;
+
+        for (i = 0; i < RTL_NUMBER_OF(GroupNames); i++) {
+            DiffContext.Group[i] = TreeListAddItem(
+                g_ctx.TreeList,
+                h_tviRootItem,
+                TVIF_TEXT | TVIF_STATE,
+                TVIS_EXPANDED,
+                TVIS_EXPANDED,
+                0,
+                GroupNames[i],
+                (PVOID)NULL);
+        }
+
+        RtlSecureZeroMemory(Counts, sizeof(Counts));
+
+        __try {
+
+            AsDiffSchemas(g_ctx.PluginHeap,
+                &g_ctx.Schema,
+                &NewSchema,
+                DiffNamespaceCallback,
+                &DiffContext,
+                Counts);
+
+        }
+        __except (EXCEPTION_EXECUTE_HANDLER) {
+
+            StringCchPrintf(
+                szBuffer,
+                MAX_PATH,
+                TEXT("ApiSetView: Exception %lu thrown while comparing apiset, schema version %lu"),
+                GetExceptionCode(),
+                NewSchema.Version);
+
+            ApiSetViewShowError(szBuffer);
+        }
+
+        //
+        // Show number of entries in each group.
+        //
+        for (i = 0; i < RTL_NUMBER_OF(GroupNames); i++) {
+            if (DiffContext.Group[i] == NULL)
+                continue;
+
+            StringCchPrintf(szBuffer, RTL_NUMBER_OF(szBuffer),
+                TEXT("%s (%lu)"), GroupNames[i], Counts[i]);
+
+            RtlSecureZeroMemory(&tvi, sizeof(tvi));
+            tvi.mask = TVIF_TEXT;
+            tvi.hItem = DiffContext.Group[i];
+            tvi.pszText = szBuffer;
+            TreeList_SetTreeItem(g_ctx.TreeList, &tvi, NULL);
+        }
+
+        RtlSecureZeroMemory(szOldFile, sizeof(szOldFile));
+        GetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_FILE, szOldFile, MAX_PATH);
+        StringCchPrintf(szBuffer, RTL_NUMBER_OF(szBuffer), TEXT("%s -> %s"), szOldFile, lpFileName);
+        SetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_FILE, szBuffer);
+
+        StringCchPrintf(szBuffer, RTL_NUMBER_OF(szBuffer), TEXT("%lu -> %lu"),
+            g_ctx.Schema.Version, NewSchema.Version);
+        SetDlgItemText(g_ctx.MainWindow, IDC_SCHEMA_VERSION, szBuffer);
+
+    } while (FALSE);
+
+    //
+    // Tree shows copies of new schema strings, mapping is no longer needed.
+    //
+    AsSchemaClose(&NewSchema);
+    HeapFree(g_ctx.PluginHeap, 0, lpFileName);
+
+    ApiSetViewEnableControls(TRUE);
+
+    ExitThread(Result);
+}
+
+/*
+* ListApiSetDiffFromFile
+*
+* Purpose:
+*
+* Compare loaded schema with given file and output differences.
+*
+*/
+VOID ListApiSetDiffFromFile(
+    _In_ LPCWSTR lpFileName)
+{
+    HANDLE hThread;
+    DWORD dwThreadId;
+    LPWSTR FileName;
+
+    FileName = (LPWSTR)HeapAlloc(g_ctx.PluginHeap, 0, (MAX_PATH + 1) * sizeof(WCHAR));
+    if (FileName == NULL)
+        return;
+
+    StringCchCopy(FileName, MAX_PATH + 1, lpFileName);
+
+    hThread = CreateThread(
+        NULL,
+        0,
+        (LPTHREAD_START_ROUTINE)ListApiSetDiffWorker,
+        FileName,
+        0,
+        &dwThreadId);
+
+    if (hThread)
+        CloseHandle(hThread);
+    else
+        HeapFree(g_ctx.PluginHeap, 0, FileName);
+}
@@ -19,3 +19,16 @@
 
 VOID ListApiSetFromFile(
     _In_opt_ LPWSTR lpFileName);
+
+VOID ListApiSetNamespaceValues(
+    _In_ HTREEITEM NamespaceItem);
+
+VOID ListApiSetAllValues(
+    VOID);
+
+VOID ListApiSetDiffFromFile(
+    _In_ LPCWSTR lpFileName);
+
+HTREEITEM ListApiSetFindItem(
+    _In_ ULONG NamespaceIndex,
+    _In_ ULONG ValueOrdinal);
@@ -10,6 +10,10 @@
 #define IDC_SCHEMAFILE_EDIT             1005
 #define IDC_SCHEMA_FILE                 1005
 #define IDC_BROWSE_BUTTON               1006
+#define IDC_SEARCH_PREV                 1007
+#define IDC_SEARCH_NEXT                 1008
+#define IDC_SEARCH_GROUP                1009
+#define IDC_COMPARE_BUTTON              1010
 
 // Next default values for new objects
 // 
@@ -17,7 +21,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        103
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         1005
+#define _APS_NEXT_CONTROL_VALUE         1011
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
@@ -0,0 +1,529 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       SCHEMA.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Mapped ApiSet schema parser.
+*
+*  Schema dll is mapped as plain file, .apiset section is located from the
+*  section table and V2/V4/V6 entries are read in place by index. Nothing
+*  is copied, every offset is checked against section bounds on access.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#include "global.h"
+
+/*
+* AsSchemapRangeValid
+*
+* Purpose:
+*
+* Check that Count elements of given size at Offset are inside Limit.
+*
+*/
+__forceinline BOOL AsSchemapRangeValid(
+    _In_ ULONG64 Offset,
+    _In_ ULONG64 Count,
+    _In_ ULONG64 ElementSize,
+    _In_ ULONG64 Limit
+)
+{
+    return (Offset <= Limit) && (Count * ElementSize <= Limit - Offset);
+}
+
+/*
+* AsSchemapQueryString
+*
+* Purpose:
+*
+* Return pointer to schema string if it is inside section.
+*
+*/
+BOOL AsSchemapQueryString(
+    _In_ PAS_SCHEMA Schema,
+    _In_ ULONG Offset,
+    _In_ ULONG Length,
+    _Out_ PCWSTR *String
+)
+{
+    *String = NULL;
+
+    if (Length == 0)
+        return TRUE;
+
+    if ((Length & 1) || !AsSchemapRangeValid(Offset, 1, Length, Schema->DataSize))
+        return FALSE;
+
+    *String = (PCWSTR)RtlOffsetToPointer(Schema->Data, Offset);
+    return TRUE;
+}
+
+/*
+* AsSchemapUnmap
+*
+* Purpose:
+*
+* Release file view and mapping, schema version is left for diagnostics.
+*
+*/
+VOID AsSchemapUnmap(
+    _Inout_ PAS_SCHEMA Schema
+)
+{
+    if (Schema->ViewBase) {
+        UnmapViewOfFile(Schema->ViewBase);
+        Schema->ViewBase = NULL;
+    }
+    if (Schema->MappingHandle) {
+        CloseHandle(Schema->MappingHandle);
+        Schema->MappingHandle = NULL;
+    }
+    Schema->ViewSize = 0;
+    Schema->Data = NULL;
+    Schema->DataSize = 0;
+    Schema->NamespaceCount = 0;
+}
+
+/*
+* AsSchemapLocateSection
+*
+* Purpose:
+*
+* Find .apiset section in file view using raw section table.
+*
+*/
+ULONG AsSchemapLocateSection(
+    _Inout_ PAS_SCHEMA Schema
+)
+{
+    ULONG i, SectionSize;
+    ULONG64 SectionTableOffset, FileSize = Schema->ViewSize;
+    PIMAGE_DOS_HEADER DosHeader = (PIMAGE_DOS_HEADER)Schema->ViewBase;
+    PIMAGE_NT_HEADERS NtHeaders;
+    PIMAGE_SECTION_HEADER Section;
+
+    if (FileSize < sizeof(IMAGE_DOS_HEADER) || DosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+        return ERROR_BAD_EXE_FORMAT;
+
+    //
+    // Only signature and file header are common for PE32 and PE32+.
+    //
+    if (DosHeader->e_lfanew < 0 ||
+        !AsSchemapRangeValid((ULONG64)DosHeader->e_lfanew, 1,
+            FIELD_OFFSET(IMAGE_NT_HEADERS, OptionalHeader), FileSize))
+    {
+        return ERROR_BAD_EXE_FORMAT;
+    }
+
+    NtHeaders = (PIMAGE_NT_HEADERS)RtlOffsetToPointer(Schema->ViewBase, DosHeader->e_lfanew);
+    if (NtHeaders->Signature != IMAGE_NT_SIGNATURE)
+        return ERROR_BAD_EXE_FORMAT;
+
+    SectionTableOffset = (ULONG64)DosHeader->e_lfanew +
+        FIELD_OFFSET(IMAGE_NT_HEADERS, OptionalHeader) +
+        NtHeaders->FileHeader.SizeOfOptionalHeader;
+
+    if (!AsSchemapRangeValid(SectionTableOffset,
+        NtHeaders->FileHeader.NumberOfSections,
+        sizeof(IMAGE_SECTION_HEADER),
+        FileSize))
+    {
+        return ERROR_BAD_EXE_FORMAT;
+    }
+
+    Section = (PIMAGE_SECTION_HEADER)RtlOffsetToPointer(Schema->ViewBase, SectionTableOffset);
+
+    for (i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++, Section++) {
+
+        if (_strncmpi_a((CHAR*)&Section->Name,
+            API_SET_SECTION_NAME,
+            sizeof(API_SET_SECTION_NAME)) != 0)
+        {
+            continue;
+        }
+
+        if (Section->PointerToRawData >= FileSize)
+            break;
+
+        SectionSize = Section->SizeOfRawData;
+        if (SectionSize > FileSize - Section->PointerToRawData)
+            SectionSize = (ULONG)(FileSize - Section->PointerToRawData);
+
+        Schema->Data = (PBYTE)RtlOffsetToPointer(Schema->ViewBase, Section->PointerToRawData);
+        Schema->DataSize = SectionSize;
+        break;
+    }
+
+    if (Schema->Data == NULL || Schema->DataSize < sizeof(ULONG))
+        return ERROR_INVALID_DATA;
+
+    return ERROR_SUCCESS;
+}
+
+/*
+* AsSchemapValidateHeader
+*
+* Purpose:
+*
+* Read schema header and check namespace entry array bounds.
+*
+*/
+ULONG AsSchemapValidateHeader(
+    _Inout_ PAS_SCHEMA Schema
+)
+{
+    API_SET_NAMESPACE_ARRAY_V2 *NamespaceV2;
+    API_SET_NAMESPACE_ARRAY_V4 *NamespaceV4;
+    API_SET_NAMESPACE_ARRAY_V6 *NamespaceV6;
+
+    Schema->Version = *(ULONG*)Schema->Data;
+
+    switch (Schema->Version) {
+
+    case API_SET_SCHEMA_VERSION_V2:
+
+        if (Schema->DataSize < FIELD_OFFSET(API_SET_NAMESPACE_ARRAY_V2, Array))
+            return ERROR_FILE_CORRUPT;
+
+        NamespaceV2 = (API_SET_NAMESPACE_ARRAY_V2*)Schema->Data;
+        Schema->NamespaceCount = NamespaceV2->Count;
+        Schema->NamespaceOffset = FIELD_OFFSET(API_SET_NAMESPACE_ARRAY_V2, Array);
+        Schema->NamespaceEntrySize = sizeof(API_SET_NAMESPACE_ENTRY_V2);
+        Schema->ValueEntrySize = sizeof(API_SET_VALUE_ENTRY_V2);
+        break;
+
+    case API_SET_SCHEMA_VERSION_V4:
+
+        if (Schema->DataSize < FIELD_OFFSET(API_SET_NAMESPACE_ARRAY_V4, Array))
+            return ERROR_FILE_CORRUPT;
+
+        NamespaceV4 = (API_SET_NAMESPACE_ARRAY_V4*)Schema->Data;
+        Schema->Flags = NamespaceV4->Flags;
+        Schema->FlagsValid = TRUE;
+        Schema->NamespaceCount = NamespaceV4->Count;
+        Schema->NamespaceOffset = FIELD_OFFSET(API_SET_NAMESPACE_ARRAY_V4, Array);
+        Schema->NamespaceEntrySize = sizeof(API_SET_NAMESPACE_ENTRY_V4);
+        Schema->ValueEntrySize = sizeof(API_SET_VALUE_ENTRY_V4);
+        break;
+
+    case API_SET_SCHEMA_VERSION_V6:
+
+        if (Schema->DataSize < sizeof(API_SET_NAMESPACE_ARRAY_V6))
+            return ERROR_FILE_CORRUPT;
+
+        NamespaceV6 = (API_SET_NAMESPACE_ARRAY_V6*)Schema->Data;
+        Schema->Flags = NamespaceV6->Flags;
+        Schema->FlagsValid = TRUE;
+        Schema->NamespaceCount = NamespaceV6->Count;
+        Schema->NamespaceOffset = NamespaceV6->NamespaceEntryOffset;
+        Schema->NamespaceEntrySize = sizeof(API_SET_NAMESPACE_ENTRY_V6);
+        Schema->ValueEntrySize = sizeof(API_SET_VALUE_ENTRY_V6);
+        break;
+
+    default:
+        return ERROR_INVALID_DATATYPE;
+    }
+
+    if (!AsSchemapRangeValid(Schema->NamespaceOffset,
+        Schema->NamespaceCount,
+        Schema->NamespaceEntrySize,
+        Schema->DataSize))
+    {
+        return ERROR_FILE_CORRUPT;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/*
+* AsSchemaOpen
+*
+* Purpose:
+*
+* Map schema dll and prepare its .apiset section for reading.
+*
+* On failure returns Win32 error, Schema->Version is set if header was read.
+*
+*/
+ULONG AsSchemaOpen(
+    _In_ LPCWSTR FileName,
+    _Out_ PAS_SCHEMA Schema
+)
+{
+    ULONG Result;
+    HANDLE FileHandle;
+    LARGE_INTEGER FileSize;
+
+    RtlSecureZeroMemory(Schema, sizeof(AS_SCHEMA));
+
+    FileHandle = CreateFile(FileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (FileHandle == INVALID_HANDLE_VALUE)
+        return GetLastError();
+
+    do {
+
+        if (!GetFileSizeEx(FileHandle, &FileSize)) {
+            Result = GetLastError();
+            break;
+        }
+
+        if (FileSize.QuadPart == 0 || FileSize.QuadPart > AS_SCHEMA_MAX_FILE_SIZE) {
+            Result = ERROR_BAD_EXE_FORMAT;
+            break;
+        }
+
+        Schema->MappingHandle = CreateFileMapping(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (Schema->MappingHandle == NULL) {
+            Result = GetLastError();
+            break;
+        }
+
+        Schema->ViewBase = (PBYTE)MapViewOfFile(Schema->MappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (Schema->ViewBase == NULL) {
+            Result = GetLastError();
+            break;
+        }
+
+        Schema->ViewSize = (SIZE_T)FileSize.QuadPart;
+
+        __try {
+            Result = AsSchemapLocateSection(Schema);
+            if (Result == ERROR_SUCCESS)
+                Result = AsSchemapValidateHeader(Schema);
+        }
+        __except (EXCEPTION_EXECUTE_HANDLER) {
+            Result = ERROR_READ_FAULT;
+        }
+
+    } while (FALSE);
+
+    //
+    // View keeps its own reference to the file.
+    //
+    CloseHandle(FileHandle);
+
+    if (Result != ERROR_SUCCESS)
+        AsSchemapUnmap(Schema);
+
+    return Result;
+}
+
+/*
+* AsSchemaClose
+*
+* Purpose:
+*
+* Unmap schema, entries queried from it become invalid.
+*
+*/
+VOID AsSchemaClose(
+    _Inout_ PAS_SCHEMA Schema
+)
+{
+    AsSchemapUnmap(Schema);
+    RtlSecureZeroMemory(Schema, sizeof(AS_SCHEMA));
+}
+
+/*
+* AsSchemaQueryNamespace
+*
+* Purpose:
+*
+* Read namespace entry by index.
+*
+* Returns FALSE if index is out of range or entry points outside section.
+*
+*/
+BOOL AsSchemaQueryNamespace(
+    _In_ PAS_SCHEMA Schema,
+    _In_ ULONG Index,
+    _Out_ PAS_NAMESPACE_ENTRY Entry
+)
+{
+    ULONG NameOffset, NameLength;
+    PVOID EntryPtr;
+
+    API_SET_NAMESPACE_ENTRY_V2 *NsEntryV2;
+    API_SET_NAMESPACE_ENTRY_V4 *NsEntryV4;
+    API_SET_NAMESPACE_ENTRY_V6 *NsEntryV6;
+    API_SET_VALUE_ARRAY_V2 *ValuesArrayV2;
+    API_SET_VALUE_ARRAY_V4 *ValuesArrayV4;
+
+    RtlSecureZeroMemory(Entry, sizeof(AS_NAMESPACE_ENTRY));
+
+    if (Index >= Schema->NamespaceCount)
+        return FALSE;
+
+    EntryPtr = RtlOffsetToPointer(Schema->Data,
+        Schema->NamespaceOffset + Index * Schema->NamespaceEntrySize);
+
+    switch (Schema->Version) {
+
+    case API_SET_SCHEMA_VERSION_V2:
+
+        NsEntryV2 = (API_SET_NAMESPACE_ENTRY_V2*)EntryPtr;
+        NameOffset = NsEntryV2->NameOffset;
+        NameLength = NsEntryV2->NameLength;
+
+        if (!AsSchemapRangeValid(NsEntryV2->DataOffset, 1,
+            FIELD_OFFSET(API_SET_VALUE_ARRAY_V2, Array), Schema->DataSize))
+        {
+            return FALSE;
+        }
+
+        ValuesArrayV2 = (API_SET_VALUE_ARRAY_V2*)RtlOffsetToPointer(Schema->Data, NsEntryV2->DataOffset);
+        Entry->ValueCount = ValuesArrayV2->Count;
+        Entry->ValueOffset = NsEntryV2->DataOffset + FIELD_OFFSET(API_SET_VALUE_ARRAY_V2, Array);
+        break;
+
+    case API_SET_SCHEMA_VERSION_V4:
+
+        NsEntryV4 = (API_SET_NAMESPACE_ENTRY_V4*)EntryPtr;
+        NameOffset = NsEntryV4->NameOffset;
+        NameLength = NsEntryV4->NameLength;
+        Entry->Flags = NsEntryV4->Flags;
+        Entry->FlagsValid = TRUE;
+
+        if (!AsSchemapRangeValid(NsEntryV4->DataOffset, 1,
+            FIELD_OFFSET(API_SET_VALUE_ARRAY_V4, Array), Schema->DataSize))
+        {
+            return FALSE;
+        }
+
+        ValuesArrayV4 = (API_SET_VALUE_ARRAY_V4*)RtlOffsetToPointer(Schema->Data, NsEntryV4->DataOffset);
+        Entry->ValueCount = ValuesArrayV4->Count;
+        Entry->ValueOffset = NsEntryV4->DataOffset + FIELD_OFFSET(API_SET_VALUE_ARRAY_V4, Array);
+        break;
+
+    case API_SET_SCHEMA_VERSION_V6:
+
+        NsEntryV6 = (API_SET_NAMESPACE_ENTRY_V6*)EntryPtr;
+        NameOffset = NsEntryV6->NameOffset;
+        NameLength = NsEntryV6->NameLength;
+        Entry->Flags = NsEntryV6->Flags;
+        Entry->FlagsValid = TRUE;
+        Entry->ValueCount = NsEntryV6->Count;
+        Entry->ValueOffset = NsEntryV6->DataOffset;
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    if (!AsSchemapRangeValid(Entry->ValueOffset,
+        Entry->ValueCount,
+        Schema->ValueEntrySize,
+        Schema->DataSize))
+    {
+        return FALSE;
+    }
+
+    if (NameOffset == 0 || NameLength == 0)
+        return FALSE;
+
+    Entry->NameLength = NameLength;
+    return AsSchemapQueryString(Schema, NameOffset, NameLength, &Entry->Name);
+}
+
+/*
+* AsSchemaQueryValue
+*
+* Purpose:
+*
+* Read value entry of given namespace by index.
+*
+* Empty values are returned with Empty flag set, caller decides to skip them.
+*
+*/
+BOOL AsSchemaQueryValue(
+    _In_ PAS_SCHEMA Schema,
+    _In_ PAS_NAMESPACE_ENTRY Entry,
+    _In_ ULONG Index,
+    _Out_ PAS_VALUE_ENTRY Value
+)
+{
+    ULONG ValueOffset, ValueLength, NameOffset, NameLength;
+    PVOID EntryPtr;
+
+    API_SET_VALUE_ENTRY_V2 *ValueEntryV2;
+    API_SET_VALUE_ENTRY_V4 *ValueEntryV4;
+    API_SET_VALUE_ENTRY_V6 *ValueEntryV6;
+
+    RtlSecureZeroMemory(Value, sizeof(AS_VALUE_ENTRY));
+
+    if (Index >= Entry->ValueCount)
+        return FALSE;
+
+    EntryPtr = RtlOffsetToPointer(Schema->Data,
+        Entry->ValueOffset + Index * Schema->ValueEntrySize);
+
+    switch (Schema->Version) {
+
+    case API_SET_SCHEMA_VERSION_V2:
+
+        ValueEntryV2 = (API_SET_VALUE_ENTRY_V2*)EntryPtr;
+        Value->Empty = API_SET_EMPTY_NAMESPACE_VALUE(ValueEntryV2);
+        ValueOffset = ValueEntryV2->ValueOffset;
+        ValueLength = ValueEntryV2->ValueLength;
+        NameOffset = ValueEntryV2->NameOffset;
+        NameLength = ValueEntryV2->NameLength;
+        break;
+
+    case API_SET_SCHEMA_VERSION_V4:
+
+        ValueEntryV4 = (API_SET_VALUE_ENTRY_V4*)EntryPtr;
+        Value->Empty = API_SET_EMPTY_NAMESPACE_VALUE(ValueEntryV4);
+        Value->Flags = ValueEntryV4->Flags;
+        Value->FlagsValid = TRUE;
+        ValueOffset = ValueEntryV4->ValueOffset;
+        ValueLength = ValueEntryV4->ValueLength;
+        NameOffset = ValueEntryV4->NameOffset;
+        NameLength = ValueEntryV4->NameLength;
+        break;
+
+    case API_SET_SCHEMA_VERSION_V6:
+
+        ValueEntryV6 = (API_SET_VALUE_ENTRY_V6*)EntryPtr;
+        Value->Empty = API_SET_EMPTY_NAMESPACE_VALUE(ValueEntryV6);
+        Value->Flags = ValueEntryV6->Flags;
+        Value->FlagsValid = TRUE;
+        ValueOffset = ValueEntryV6->ValueOffset;
+        ValueLength = ValueEntryV6->ValueLength;
+        NameOffset = ValueEntryV6->NameOffset;
+        NameLength = ValueEntryV6->NameLength;
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    if (Value->Empty)
+        return TRUE;
+
+    if (!AsSchemapQueryString(Schema, ValueOffset, ValueLength, &Value->Value) ||
+        !AsSchemapQueryString(Schema, NameOffset, NameLength, &Value->Alias))
+    {
+        return FALSE;
+    }
+
+    Value->ValueLength = ValueLength;
+    Value->AliasLength = NameLength;
+    return TRUE;
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       SCHEMA.H
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the mapped ApiSet schema parser.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#pragma once
+
+//
+// Upper limit for schema dll accepted by parser.
+//
+#define AS_SCHEMA_MAX_FILE_SIZE     0x4000000
+
+typedef struct _AS_SCHEMA {
+    HANDLE MappingHandle;
+    PBYTE ViewBase;
+    SIZE_T ViewSize;
+
+    //
+    // .apiset section inside view.
+    //
+    PBYTE Data;
+    ULONG DataSize;
+
+    ULONG Version;
+    ULONG Flags;
+    BOOL FlagsValid;
+
+    //
+    // Namespace entry array location, entry layout depends on version.
+    //
+    ULONG NamespaceCount;
+    ULONG NamespaceOffset;
+    ULONG NamespaceEntrySize;
+    ULONG ValueEntrySize;
+} AS_SCHEMA, *PAS_SCHEMA;
+
+//
+// Version independent views of schema entries, strings point to mapped
+// section and are not zero terminated, lengths are in bytes.
+//
+typedef struct _AS_NAMESPACE_ENTRY {
+    PCWSTR Name;
+    ULONG NameLength;
+    ULONG Flags;
+    BOOL FlagsValid;
+    ULONG ValueCount;
+    ULONG ValueOffset;
+} AS_NAMESPACE_ENTRY, *PAS_NAMESPACE_ENTRY;
+
+typedef struct _AS_VALUE_ENTRY {
+    PCWSTR Value;
+    ULONG ValueLength;
+    PCWSTR Alias;
+    ULONG AliasLength;
+    ULONG Flags;
+    BOOL FlagsValid;
+    BOOL Empty;
+} AS_VALUE_ENTRY, *PAS_VALUE_ENTRY;
+
+ULONG AsSchemaOpen(
+    _In_ LPCWSTR FileName,
+    _Out_ PAS_SCHEMA Schema);
+
+VOID AsSchemaClose(
+    _Inout_ PAS_SCHEMA Schema);
+
+BOOL AsSchemaQueryNamespace(
+    _In_ PAS_SCHEMA Schema,
+    _In_ ULONG Index,
+    _Out_ PAS_NAMESPACE_ENTRY Entry);
+
+BOOL AsSchemaQueryValue(
+    _In_ PAS_SCHEMA Schema,
+    _In_ PAS_NAMESPACE_ENTRY Entry,
+    _In_ ULONG Index,
+    _Out_ PAS_VALUE_ENTRY Value);
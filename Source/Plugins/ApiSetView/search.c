@@ -0,0 +1,450 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       SEARCH.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  ApiSet schema name search index.
+*
+*  Namespace, value and alias names are case folded into one text block and
+*  every trigram of a name is posted to a hash bucket. Query takes the
+*  smallest bucket of pattern trigrams as candidate list and verifies each
+*  candidate, so only names sharing rare trigram with pattern are touched.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#include "global.h"
+
+/*
+* AsSearchpFoldChar
+*
+* Purpose:
+*
+* Lower case ASCII letter, schema names are ASCII.
+*
+*/
+__forceinline WCHAR AsSearchpFoldChar(
+    _In_ WCHAR c
+)
+{
+    return ((c >= L'A') && (c <= L'Z')) ? (WCHAR)(c + (L'a' - L'A')) : c;
+}
+
+/*
+* AsSearchpTrigram
+*
+* Purpose:
+*
+* Return bucket of trigram at given folded text position.
+*
+*/
+__forceinline ULONG AsSearchpTrigram(
+    _In_ PWCHAR Text
+)
+{
+    return ((ULONG)Text[0] * 961 + (ULONG)Text[1] * 31 + (ULONG)Text[2]) & (AS_SEARCH_BUCKETS - 1);
+}
+
+/*
+* AsSearchpAddName
+*
+* Purpose:
+*
+* Append folded name to index text, or only count its size if text is not allocated.
+*
+*/
+VOID AsSearchpAddName(
+    _Inout_ PAS_SEARCH_INDEX Index,
+    _In_ PCWSTR Name,
+    _In_ ULONG NameLength,
+    _In_ ULONG NamespaceIndex,
+    _In_ ULONG ValueOrdinal
+)
+{
+    ULONG i, cch = NameLength / sizeof(WCHAR);
+    PAS_SEARCH_NAME Entry;
+
+    if (cch == 0)
+        return;
+
+    if (Index->Text) {
+
+        Entry = &Index->Names[Index->NameCount];
+        Entry->TextOffset = Index->TextLength;
+        Entry->Length = cch;
+        Entry->NamespaceIndex = NamespaceIndex;
+        Entry->ValueOrdinal = ValueOrdinal;
+
+        for (i = 0; i < cch; i++)
+            Index->Text[Index->TextLength + i] = AsSearchpFoldChar(Name[i]);
+
+        Index->Text[Index->TextLength + cch] = 0;
+    }
+
+    Index->NameCount += 1;
+    Index->TextLength += cch + 1;
+}
+
+/*
+* AsSearchpCollectNames
+*
+* Purpose:
+*
+* Walk schema in tree order and add every name that is shown in tree.
+*
+*/
+VOID AsSearchpCollectNames(
+    _Inout_ PAS_SEARCH_INDEX Index,
+    _In_ PAS_SCHEMA Schema
+)
+{
+    ULONG i, j, Ordinal;
+    AS_NAMESPACE_ENTRY Entry;
+    AS_VALUE_ENTRY Value;
+
+    Index->NameCount = 0;
+    Index->TextLength = 0;
+
+    for (i = 0; i < Schema->NamespaceCount; i++) {
+
+        if (!AsSchemaQueryNamespace(Schema, i, &Entry))
+            continue;
+
+        AsSearchpAddName(Index, Entry.Name, Entry.NameLength, i, AS_SEARCH_NAMESPACE);
+
+        //
+        // Ordinal must follow ListApiSetNamespaceValues rules.
+        //
+        Ordinal = 0;
+        for (j = 0; j < Entry.ValueCount; j++) {
+            if (AsSchemaQueryValue(Schema, &Entry, j, &Value) && !Value.Empty) {
+                AsSearchpAddName(Index, Value.Value, Value.ValueLength, i, Ordinal);
+                AsSearchpAddName(Index, Value.Alias, Value.AliasLength, i, Ordinal);
+                Ordinal += 1;
+            }
+        }
+    }
+}
+
+/*
+* AsSearchpBuildPostings
+*
+* Purpose:
+*
+* Counting sort of name trigrams into hash buckets.
+*
+*/
+BOOL AsSearchpBuildPostings(
+    _Inout_ PAS_SEARCH_INDEX Index
+)
+{
+    ULONG i, p, Bucket, Total;
+    PULONG Temp;
+    PWCHAR Text;
+
+    Index->BucketStart = (PULONG)HeapAlloc(Index->HeapHandle,
+        HEAP_ZERO_MEMORY, (AS_SEARCH_BUCKETS + 1) * sizeof(ULONG));
+
+    Temp = (PULONG)HeapAlloc(Index->HeapHandle, 0, AS_SEARCH_BUCKETS * sizeof(ULONG));
+
+    if (Index->BucketStart == NULL || Temp == NULL) {
+        if (Temp) HeapFree(Index->HeapHandle, 0, Temp);
+        return FALSE;
+    }
+
+    //
+    // Count names per bucket, Temp holds last name posted to bucket.
+    //
+    for (i = 0; i < AS_SEARCH_BUCKETS; i++)
+        Temp[i] = MAXULONG;
+
+    for (i = 0; i < Index->NameCount; i++) {
+        Text = &Index->Text[Index->Names[i].TextOffset];
+        for (p = 0; p + 3 <= Index->Names[i].Length; p++) {
+            Bucket = AsSearchpTrigram(&Text[p]);
+            if (Temp[Bucket] != i) {
+                Temp[Bucket] = i;
+                Index->BucketStart[Bucket + 1] += 1;
+            }
+        }
+    }
+
+    for (i = 0; i < AS_SEARCH_BUCKETS; i++)
+        Index->BucketStart[i + 1] += Index->BucketStart[i];
+
+    Total = Index->BucketStart[AS_SEARCH_BUCKETS];
+
+    Index->Postings = (PULONG)HeapAlloc(Index->HeapHandle, 0, (SIZE_T)(Total ? Total : 1) * sizeof(ULONG));
+    if (Index->Postings == NULL) {
+        HeapFree(Index->HeapHandle, 0, Temp);
+        return FALSE;
+    }
+
+    //
+    // Fill buckets, Temp is now write cursor.
+    //
+    RtlCopyMemory(Temp, Index->BucketStart, AS_SEARCH_BUCKETS * sizeof(ULONG));
+
+    for (i = 0; i < Index->NameCount; i++) {
+        Text = &Index->Text[Index->Names[i].TextOffset];
+        for (p = 0; p + 3 <= Index->Names[i].Length; p++) {
+            Bucket = AsSearchpTrigram(&Text[p]);
+            if (Temp[Bucket] == Index->BucketStart[Bucket] ||
+                Index->Postings[Temp[Bucket] - 1] != i)
+            {
+                Index->Postings[Temp[Bucket]++] = i;
+            }
+        }
+    }
+
+    HeapFree(Index->HeapHandle, 0, Temp);
+    return TRUE;
+}
+
+/*
+* AsSearchCreate
+*
+* Purpose:
+*
+* Build search index for mapped schema.
+*
+*/
+BOOL AsSearchCreate(
+    _In_ HANDLE HeapHandle,
+    _In_ PAS_SCHEMA Schema,
+    _Out_ PAS_SEARCH_INDEX Index
+)
+{
+    ULONG NameCount;
+
+    RtlSecureZeroMemory(Index, sizeof(AS_SEARCH_INDEX));
+    Index->HeapHandle = HeapHandle;
+
+    //
+    // First pass only sizes text and name table.
+    //
+    AsSearchpCollectNames(Index, Schema);
+    if (Index->NameCount == 0)
+        return FALSE;
+
+    NameCount = Index->NameCount;
+
+    Index->Text = (PWCHAR)HeapAlloc(HeapHandle, 0, (SIZE_T)Index->TextLength * sizeof(WCHAR));
+    Index->Names = (PAS_SEARCH_NAME)HeapAlloc(HeapHandle, 0, (SIZE_T)NameCount * sizeof(AS_SEARCH_NAME));
+
+    Index->Hits = (PULONG)HeapAlloc(HeapHandle, 0, (SIZE_T)NameCount * 2 * sizeof(ULONG));
+    Index->Ranks = (PUCHAR)HeapAlloc(HeapHandle, 0, NameCount);
+
+    if (Index->Text == NULL ||
+        Index->Names == NULL ||
+        Index->Hits == NULL ||
+        Index->Ranks == NULL)
+    {
+        AsSearchDestroy(Index);
+        return FALSE;
+    }
+
+    AsSearchpCollectNames(Index, Schema);
+
+    //
+    // Both passes must see same names.
+    //
+    if (Index->NameCount != NameCount || !AsSearchpBuildPostings(Index)) {
+        AsSearchDestroy(Index);
+        return FALSE;
+    }
+
+    Index->Current = MAXULONG;
+    return TRUE;
+}
+
+/*
+* AsSearchDestroy
+*
+* Purpose:
+*
+* Release search index.
+*
+*/
+VOID AsSearchDestroy(
+    _Inout_ PAS_SEARCH_INDEX Index
+)
+{
+    if (Index->HeapHandle) {
+        if (Index->Text) HeapFree(Index->HeapHandle, 0, Index->Text);
+        if (Index->Names) HeapFree(Index->HeapHandle, 0, Index->Names);
+        if (Index->BucketStart) HeapFree(Index->HeapHandle, 0, Index->BucketStart);
+        if (Index->Postings) HeapFree(Index->HeapHandle, 0, Index->Postings);
+        if (Index->Hits) HeapFree(Index->HeapHandle, 0, Index->Hits);
+        if (Index->Ranks) HeapFree(Index->HeapHandle, 0, Index->Ranks);
+    }
+    RtlSecureZeroMemory(Index, sizeof(AS_SEARCH_INDEX));
+}
+
+/*
+* AsSearchpMatch
+*
+* Purpose:
+*
+* Check folded pattern against name and return match rank.
+*
+*/
+AS_SEARCH_RANK AsSearchpMatch(
+    _In_ PAS_SEARCH_INDEX Index,
+    _In_ ULONG NameIndex,
+    _In_ PWCHAR Pattern,
+    _In_ ULONG PatternLength
+)
+{
+    ULONG i, k, Length = Index->Names[NameIndex].Length;
+    PWCHAR Text = &Index->Text[Index->Names[NameIndex].TextOffset];
+
+    for (i = 0; i + PatternLength <= Length; i++) {
+
+        for (k = 0; k < PatternLength; k++) {
+            if (Text[i + k] != Pattern[k])
+                break;
+        }
+
+        if (k == PatternLength) {
+            if (i != 0)
+                return AsSearchRankSubstring;
+            return (PatternLength == Length) ? AsSearchRankExact : AsSearchRankPrefix;
+        }
+    }
+
+    return AsSearchRankMax;
+}
+
+/*
+* AsSearchQuery
+*
+* Purpose:
+*
+* Find all names containing pattern, case insensitive.
+*
+* Hits are ordered exact matches first, then prefix and substring matches,
+* each group in tree order. Value and alias of one entry give one hit.
+*
+*/
+ULONG AsSearchQuery(
+    _Inout_ PAS_SEARCH_INDEX Index,
+    _In_ LPCWSTR Pattern
+)
+{
+    ULONG i, n, Bucket, Rank;
+    ULONG PatternLength, CandidateCount, ScratchCount;
+    ULONG First, Last;
+    PULONG Candidates, Scratch;
+    PAS_SEARCH_NAME Name, Prev;
+    WCHAR szPattern[MAX_PATH + 1];
+
+    Index->HitCount = 0;
+    Index->Current = MAXULONG;
+
+    if (Index->Names == NULL)
+        return 0;
+
+    for (PatternLength = 0; PatternLength < MAX_PATH && Pattern[PatternLength]; PatternLength++)
+        szPattern[PatternLength] = AsSearchpFoldChar(Pattern[PatternLength]);
+
+    szPattern[PatternLength] = 0;
+
+    if (PatternLength == 0)
+        return 0;
+
+    //
+    // Short pattern has no trigram, check all names.
+    //
+    Candidates = NULL;
+    CandidateCount = Index->NameCount;
+
+    for (i = 0; i + 3 <= PatternLength; i++) {
+        Bucket = AsSearchpTrigram(&szPattern[i]);
+        First = Index->BucketStart[Bucket];
+        Last = Index->BucketStart[Bucket + 1];
+        if (Candidates == NULL || Last - First < CandidateCount) {
+            Candidates = &Index->Postings[First];
+            CandidateCount = Last - First;
+        }
+    }
+
+    Scratch = &Index->Hits[Index->NameCount];
+    ScratchCount = 0;
+    Prev = NULL;
+
+    for (i = 0; i < CandidateCount; i++) {
+
+        n = (Candidates) ? Candidates[i] : i;
+
+        Rank = AsSearchpMatch(Index, n, szPattern, PatternLength);
+        if (Rank == AsSearchRankMax)
+            continue;
+
+        Name = &Index->Names[n];
+
+        //
+        // Value and alias of same entry are adjacent names.
+        //
+        if (Prev &&
+            Prev->NamespaceIndex == Name->NamespaceIndex &&
+            Prev->ValueOrdinal == Name->ValueOrdinal)
+        {
+            if (Rank < Index->Ranks[ScratchCount - 1])
+                Index->Ranks[ScratchCount - 1] = (UCHAR)Rank;
+            continue;
+        }
+
+        Scratch[ScratchCount] = n;
+        Index->Ranks[ScratchCount] = (UCHAR)Rank;
+        ScratchCount += 1;
+        Prev = Name;
+    }
+
+    //
+    // Stable distribution by rank.
+    //
+    for (Rank = 0; Rank < AsSearchRankMax; Rank++) {
+        for (i = 0; i < ScratchCount; i++) {
+            if (Index->Ranks[i] == Rank)
+                Index->Hits[Index->HitCount++] = Scratch[i];
+        }
+    }
+
+    return Index->HitCount;
+}
+
+/*
+* AsSearchMove
+*
+* Purpose:
+*
+* Step to next or previous hit of last query, wraps around.
+*
+*/
+PAS_SEARCH_NAME AsSearchMove(
+    _Inout_ PAS_SEARCH_INDEX Index,
+    _In_ BOOL Backward
+)
+{
+    if (Index->HitCount == 0)
+        return NULL;
+
+    if (Index->Current >= Index->HitCount)
+        Index->Current = (Backward) ? Index->HitCount - 1 : 0;
+    else if (Backward)
+        Index->Current = (Index->Current + Index->HitCount - 1) % Index->HitCount;
+    else
+        Index->Current = (Index->Current + 1) % Index->HitCount;
+
+    return &Index->Names[Index->Hits[Index->Current]];
+}
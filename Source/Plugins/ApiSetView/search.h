@@ -0,0 +1,88 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       SEARCH.H
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the ApiSet schema name search index.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#pragma once
+
+//
+// Trigram hash table size, must be power of two.
+//
+#define AS_SEARCH_BUCKETS           16384
+
+//
+// ValueOrdinal of namespace name.
+//
+#define AS_SEARCH_NAMESPACE         MAXULONG
+
+typedef enum _AS_SEARCH_RANK {
+    AsSearchRankExact = 0,
+    AsSearchRankPrefix,
+    AsSearchRankSubstring,
+    AsSearchRankMax
+} AS_SEARCH_RANK;
+
+typedef struct _AS_SEARCH_NAME {
+    ULONG TextOffset;           //in folded text, chars
+    ULONG Length;               //chars
+    ULONG NamespaceIndex;
+    ULONG ValueOrdinal;         //position among listed values or AS_SEARCH_NAMESPACE
+} AS_SEARCH_NAME, *PAS_SEARCH_NAME;
+
+typedef struct _AS_SEARCH_INDEX {
+    HANDLE HeapHandle;
+
+    //
+    // Case folded names, each zero terminated.
+    //
+    PWCHAR Text;
+    ULONG TextLength;
+
+    PAS_SEARCH_NAME Names;
+    ULONG NameCount;
+
+    //
+    // Trigram postings, name indices in ascending order per bucket.
+    //
+    PULONG BucketStart;         //AS_SEARCH_BUCKETS + 1 entries
+    PULONG Postings;
+
+    //
+    // Last query result, name indices ordered by rank. Second half of
+    // Hits and Ranks are scratch for unordered matches.
+    //
+    PULONG Hits;
+    PUCHAR Ranks;
+    ULONG HitCount;
+    ULONG Current;
+} AS_SEARCH_INDEX, *PAS_SEARCH_INDEX;
+
+BOOL AsSearchCreate(
+    _In_ HANDLE HeapHandle,
+    _In_ PAS_SCHEMA Schema,
+    _Out_ PAS_SEARCH_INDEX Index);
+
+VOID AsSearchDestroy(
+    _Inout_ PAS_SEARCH_INDEX Index);
+
+ULONG AsSearchQuery(
+    _Inout_ PAS_SEARCH_INDEX Index,
+    _In_ LPCWSTR Pattern);
+
+PAS_SEARCH_NAME AsSearchMove(
+    _Inout_ PAS_SEARCH_INDEX Index,
+    _In_ BOOL Backward);
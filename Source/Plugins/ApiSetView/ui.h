@@ -25,18 +25,34 @@
 #define DefaultSystemDpi            96
 #define WINOBJEX64_ICON_MAIN        174
 
+#define ID_MENU_EXPORT_VIEW         41010
+
 typedef struct _GUI_CONTEXT {
     HWND MainWindow;
     HWND TreeList;
     HANDLE PluginHeap;
     HANDLE WorkerThread;
 
+    //
+    // Mapped schema, kept while tree shows its entries.
+    //
+    AS_SCHEMA Schema;
+    HTREEITEM *NamespaceItems;  //tree item per namespace index
+    AS_SEARCH_INDEX SearchIndex;
+
     //
     // WinObjEx64 data and pointers.
     //
     WINOBJEX_PARAM_BLOCK ParamBlock;
 } GUI_CONTEXT, *PGUI_CONTEXT;
 
+typedef struct _DIFF_VIEW_CONTEXT {
+    PAS_SCHEMA OldSchema;
+    PAS_SCHEMA NewSchema;
+    HTREEITEM Group[AsDiffChanged + 1];    //Added, Removed, Changed
+    HTREEITEM Current;                      //changed contract being listed
+} DIFF_VIEW_CONTEXT, *PDIFF_VIEW_CONTEXT;
+
 typedef struct _TL_SUBITEMS_FIXED {
     ULONG       ColorFlags;
     COLORREF    BgColor;
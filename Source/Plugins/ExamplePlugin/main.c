@@ -73,7 +73,11 @@ NTSTATUS CALLBACK StartPlugin(
 
     DbgPrint("StartPlugin called from thread 0x%lx\r\n", GetCurrentThreadId());
 
-    RtlCopyMemory(&g_ParamBlock, ParamBlock, sizeof(WINOBJEX_PARAM_BLOCK));
+    if (ParamBlock->cbSize < WINOBJEX_PARAM_BLOCK_MIN_SIZE)
+        return STATUS_NOT_SUPPORTED;
+
+    RtlSecureZeroMemory(&g_ParamBlock, sizeof(g_ParamBlock));
+    RtlCopyMemory(&g_ParamBlock, ParamBlock, WINOBJEX_PARAM_BLOCK_COPY_SIZE(ParamBlock));
     g_StopPlugin = FALSE;
     g_hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)PluginThread, (PVOID)NULL, 0, &ThreadId);
     if (g_hThread) {
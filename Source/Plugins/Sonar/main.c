@@ -115,6 +115,46 @@ HTREEITEM TreeListAddItem(
     return TreeList_InsertTreeItem(TreeList, &tvitem, si);
 }
 
+/*
+* ListOpenQueueCallback
+*
+* Purpose:
+*
+* WalkList callback, output NDIS_OPEN_BLOCK to the treelist.
+*
+*/
+BOOL CALLBACK ListOpenQueueCallback(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context
+)
+{
+    WCHAR szBuffer[32];
+    TL_SUBITEMS_FIXED subitems;
+
+    UNREFERENCED_PARAMETER(Record);
+    UNREFERENCED_PARAMETER(TailData);
+
+    RtlSecureZeroMemory(&subitems, sizeof(subitems));
+    subitems.UserParam = IntToPtr(NdisObjectTypeOpenBlock);
+    StringCchPrintf(szBuffer, 32, TEXT("0x%llX"), RecordAddress);
+    subitems.Count = 2;
+    subitems.Text[0] = szBuffer;
+    subitems.Text[1] = TEXT("");
+
+    TreeListAddItem(
+        g_ctx.TreeList,
+        (HTREEITEM)Context,
+        TVIF_TEXT | TVIF_STATE,
+        TVIS_EXPANDED,
+        TVIS_EXPANDED,
+        TEXT("OpenQueue"),
+        &subitems);
+
+    return TRUE;
+}
+
 /*
 * ListOpenQueue
 *
@@ -128,40 +168,36 @@ BOOL ListOpenQueue(
     _In_ ULONG_PTR OpenQueueAddress
 )
 {
-    ULONG_PTR ProtocolNextOpen = OpenQueueAddress;
-
-    NDIS_OPEN_BLOCK_COMPATIBLE OpenBlock;
+    ULONG ObjectVersion;
+    KDWALK_STATUS WalkStatus = KdWalkInvalidParameter;
+    KDWALK_PARAMS Params;
 
     WCHAR szBuffer[200];
-    TL_SUBITEMS_FIXED subitems;
 
-    do {
-        RtlSecureZeroMemory(&OpenBlock, sizeof(OpenBlock));
-        if (!ReadAndConvertOpenBlock(ProtocolNextOpen, &OpenBlock, NULL)) {
-            StringCchPrintf(szBuffer, 200, TEXT("Could not read NDIS_OPEN_BLOCK 0x%llX"), ProtocolNextOpen);
-            SHOW_ERROR(szBuffer);
-            return FALSE;
-        }
-
-        RtlSecureZeroMemory(&subitems, sizeof(subitems));
-        subitems.UserParam = IntToPtr(NdisObjectTypeOpenBlock);
-        StringCchPrintf(szBuffer, 32, TEXT("0x%llX"), ProtocolNextOpen);
-        subitems.Count = 2;
-        subitems.Text[0] = szBuffer;
-        subitems.Text[1] = TEXT("");
-
-        TreeListAddItem(
-            g_ctx.TreeList,
-            hTreeRootItem,
-            TVIF_TEXT | TVIF_STATE,
-            TVIS_EXPANDED,
-            TVIS_EXPANDED,
-            TEXT("OpenQueue"),
-            &subitems);
-
-        ProtocolNextOpen = (ULONG_PTR)OpenBlock.ProtocolNextOpen;
+    if (!WINOBJEX_PARAM_BLOCK_HAS_FIELD(&g_ctx.ParamBlock, WalkList) ||
+        g_ctx.ParamBlock.WalkList == NULL)
+    {
+        return FALSE;
+    }
 
-    } while (ProtocolNextOpen != 0);
+    //
+    // OpenQueue points to the first open block, ProtocolNextOpen links next one.
+    //
+    RtlSecureZeroMemory(&Params, sizeof(Params));
+    Params.ListHead = OpenQueueAddress;
+    Params.LinkOffset = GetNextOpenOffset(g_ctx.ParamBlock.osver.dwBuildNumber);
+    Params.RecordSize = GetOpenBlockSize(g_ctx.ParamBlock.osver.dwBuildNumber, &ObjectVersion);
+    Params.Flags = KDWALK_FLAG_NULL_TERMINATED | KDWALK_FLAG_HEAD_IS_RECORD;
+    Params.Callback = ListOpenQueueCallback;
+    Params.Context = (PVOID)hTreeRootItem;
+
+    g_ctx.ParamBlock.WalkList(&Params, &WalkStatus);
+
+    if (WalkStatus != KdWalkComplete) {
+        StringCchPrintf(szBuffer, 200, TEXT("Could not read NDIS_OPEN_BLOCK queue 0x%llX (%lu)"), OpenQueueAddress, WalkStatus);
+        SHOW_ERROR(szBuffer);
+        return FALSE;
+    }
 
     return TRUE;
 }
@@ -242,6 +278,35 @@ VOID AddProtocolToTreeList(
 
 }
 
+/*
+* ListProtocolsCallback
+*
+* Purpose:
+*
+* WalkList callback, convert NDIS_PROTOCOL_BLOCK and output it.
+*
+*/
+BOOL CALLBACK ListProtocolsCallback(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context
+)
+{
+    NDIS_PROTOCOL_BLOCK_COMPATIBLE ProtoBlock;
+    PROTOCOL_BLOCK_VERSIONS ProtocolRef;
+
+    UNREFERENCED_PARAMETER(TailData);
+
+    RtlSecureZeroMemory(&ProtoBlock, sizeof(ProtoBlock));
+    ProtocolRef.u1.Ref = Record;
+
+    if (CreateCompatibleProtocolBlock(PtrToUlong(Context), &ProtocolRef, &ProtoBlock))
+        AddProtocolToTreeList(&ProtoBlock, RecordAddress);
+
+    return TRUE;
+}
+
 /*
 * ListProtocols
 *
@@ -254,9 +319,9 @@ VOID ListProtocols(
     _In_ BOOL bRefresh
 )
 {
-    NDIS_PROTOCOL_BLOCK_COMPATIBLE ProtoBlock;
-
-    ULONG_PTR ProtocolBlockAddress = 0;
+    ULONG ObjectVersion = 0;
+    KDWALK_STATUS WalkStatus = KdWalkInvalidParameter;
+    KDWALK_PARAMS Params;
 
     WCHAR szBuffer[200];
 
@@ -273,38 +338,34 @@ VOID ListProtocols(
         return;
     }
 
-    //
-    // Read head and skip it.
-    //
-    if (g_ctx.ndisNextProtocolOffset == 0)
-        g_ctx.ndisNextProtocolOffset = GetNextProtocolOffset(g_ctx.ParamBlock.osver.dwBuildNumber);
-
-    ProtocolBlockAddress = (ULONG_PTR)g_ctx.ndisProtocolList - g_ctx.ndisNextProtocolOffset;
-    RtlSecureZeroMemory(&ProtoBlock, sizeof(ProtoBlock));
-    if (!ReadAndConvertProtocolBlock(ProtocolBlockAddress, &ProtoBlock, NULL)) {
-        StringCchPrintf(szBuffer, 200, TEXT("Could not read NDIS_PROTOCOL_BLOCK 0x%llX, aborting enumeration."), ProtocolBlockAddress);
-        SHOW_ERROR(szBuffer);
+    if (!WINOBJEX_PARAM_BLOCK_HAS_FIELD(&g_ctx.ParamBlock, WalkList) ||
+        g_ctx.ParamBlock.WalkList == NULL)
+    {
+        SHOW_ERROR(TEXT("List walker is not supported by this WinObjEx64 version, abort."));
         return;
     }
 
-    ProtocolBlockAddress = (ULONG_PTR)ProtoBlock.NextProtocol;
+    if (g_ctx.ndisNextProtocolOffset == 0)
+        g_ctx.ndisNextProtocolOffset = GetNextProtocolOffset(g_ctx.ParamBlock.osver.dwBuildNumber);
 
     //
-    // Walk protocol list.
+    // Walk protocol list, ndisProtocolList holds the first block, NextProtocol links next one.
     //
-    do {
-        RtlSecureZeroMemory(&ProtoBlock, sizeof(ProtoBlock));
-        if (!ReadAndConvertProtocolBlock(ProtocolBlockAddress, &ProtoBlock, NULL)) {
-            StringCchPrintf(szBuffer, 200, TEXT("Could not read NDIS_PROTOCOL_BLOCK 0x%llX, aborting enumeration."), ProtocolBlockAddress);
-            SHOW_ERROR(szBuffer);
-            return;
-        }
-
-        AddProtocolToTreeList(&ProtoBlock, ProtocolBlockAddress);
-
-        ProtocolBlockAddress = (ULONG_PTR)ProtoBlock.NextProtocol;
-
-    } while (ProtocolBlockAddress != 0);
+    RtlSecureZeroMemory(&Params, sizeof(Params));
+    Params.ListHead = (ULONG_PTR)g_ctx.ndisProtocolList;
+    Params.LinkOffset = g_ctx.ndisNextProtocolOffset;
+    Params.RecordSize = GetProtocolBlockSize(g_ctx.ParamBlock.osver.dwBuildNumber, &ObjectVersion);
+    Params.Flags = KDWALK_FLAG_NULL_TERMINATED;
+    Params.Callback = ListProtocolsCallback;
+    Params.Context = UlongToPtr(ObjectVersion);
+
+    g_ctx.ParamBlock.WalkList(&Params, &WalkStatus);
+
+    if (WalkStatus != KdWalkComplete) {
+        StringCchPrintf(szBuffer, 200, TEXT("Could not walk NDIS_PROTOCOL_BLOCK list 0x%llX (%lu), enumeration incomplete."),
+            (ULONG_PTR)g_ctx.ndisProtocolList, WalkStatus);
+        SHOW_ERROR(szBuffer);
+    }
 
     TreeView_SelectItem(g_ctx.TreeList, TreeView_GetRoot(g_ctx.TreeList));
     SetFocus(g_ctx.TreeList);
@@ -717,6 +778,7 @@ VOID OnContextMenu(
     _In_ HWND hwnd,
     _In_ UINT idItem,
     _In_ LPWSTR menuText,
+    _In_ UINT idExport,
     _In_ LPPOINT point
 )
 {
@@ -725,6 +787,12 @@ VOID OnContextMenu(
     hMenu = CreatePopupMenu();
     if (hMenu) {
         InsertMenu(hMenu, 0, MF_BYCOMMAND, idItem, menuText);
+        if (WINOBJEX_PARAM_BLOCK_HAS_FIELD(&g_ctx.ParamBlock, uiExportView) &&
+            g_ctx.ParamBlock.uiExportView)
+        {
+            InsertMenu(hMenu, 1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
+            InsertMenu(hMenu, 2, MF_BYCOMMAND, idExport, TEXT("Export List..."));
+        }
         TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, point->x, point->y, 0, hwnd, NULL);
         DestroyMenu(hMenu);
     }
@@ -912,7 +980,17 @@ VOID OnNotify(
             g_ctx.bInverseSort = !g_ctx.bInverseSort;
             SortColumn = ((NMLISTVIEW *)lParam)->iSubItem;
 
-            ListView_SortItemsEx(g_ctx.ListView, &ListViewCompareFunc, SortColumn);
+            if (WINOBJEX_PARAM_BLOCK_HAS_FIELD(&g_ctx.ParamBlock, uiListViewSort) &&
+                g_ctx.ParamBlock.uiListViewSort)
+            {
+                g_ctx.ParamBlock.uiListViewSort(g_ctx.ListView,
+                    SortColumn,
+                    (SortColumn == 0) ? LvSortKeyText : LvSortKeyHex,
+                    g_ctx.bInverseSort);
+            }
+            else {
+                ListView_SortItemsEx(g_ctx.ListView, &ListViewCompareFunc, SortColumn);
+            }
 
             ImageIndex = ImageList_GetImageCount(g_ctx.ImageList);
             if (g_ctx.bInverseSort)
@@ -972,7 +1050,7 @@ LRESULT CALLBACK MainWindowProc(
 
         if ((HWND)wParam == TreeListControl) {
             GetCursorPos((LPPOINT)&crc);
-            OnContextMenu(hwnd, ID_MENU_COPY_VALUE, TEXT("Copy Object Field"), (LPPOINT)&crc);
+            OnContextMenu(hwnd, ID_MENU_COPY_VALUE, TEXT("Copy Object Field"), ID_MENU_EXPORT_VIEW, (LPPOINT)&crc);
         }
 
         if ((HWND)wParam == g_ctx.ListView) {
@@ -987,7 +1065,7 @@ LRESULT CALLBACK MainWindowProc(
             else
                 GetCursorPos((LPPOINT)&crc);
 
-            OnContextMenu(hwnd, ID_MENU_COPY_VALUE + 1, TEXT("Copy Value Field"), (LPPOINT)&crc);
+            OnContextMenu(hwnd, ID_MENU_COPY_VALUE + 1, TEXT("Copy Value Field"), ID_MENU_EXPORT_VIEW + 1, (LPPOINT)&crc);
         }
         break;
 
@@ -1004,6 +1082,14 @@ LRESULT CALLBACK MainWindowProc(
             CopyValueHandler(LOWORD(wParam));
             break;
 
+        case ID_MENU_EXPORT_VIEW:
+            g_ctx.ParamBlock.uiExportView(hwnd, g_ctx.TreeList, ExportViewTreeList, TEXT("SonarProtocols"));
+            break;
+
+        case ID_MENU_EXPORT_VIEW + 1:
+            g_ctx.ParamBlock.uiExportView(hwnd, g_ctx.ListView, ExportViewListView, TEXT("SonarFields"));
+            break;
+
         case WINOBJEX64_ACC_F5:
             RefreshViewsHandler(GetFocus());
             break;
@@ -1330,6 +1416,9 @@ NTSTATUS CALLBACK StartPlugin(
     NTSTATUS Status;
     WINOBJEX_PLUGIN_STATE State = PluginInitialization;
 
+    if (ParamBlock->cbSize < WINOBJEX_PARAM_BLOCK_MIN_SIZE)
+        return STATUS_NOT_SUPPORTED;
+
     RtlSecureZeroMemory(&g_ctx, sizeof(g_ctx));
 
     g_ctx.PluginHeap = HeapCreate(0, 0, 0);
@@ -1338,7 +1427,10 @@ NTSTATUS CALLBACK StartPlugin(
 
     HeapSetInformation(g_ctx.PluginHeap, HeapEnableTerminationOnCorruption, NULL, 0);
 
-    RtlCopyMemory(&g_ctx.ParamBlock, ParamBlock, sizeof(WINOBJEX_PARAM_BLOCK));
+    //
+    // Host may be older than plugin, members not provided by it stay zeroed.
+    //
+    RtlCopyMemory(&g_ctx.ParamBlock, ParamBlock, WINOBJEX_PARAM_BLOCK_COPY_SIZE(ParamBlock));
 
     g_ctx.WorkerThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)PluginThread, (PVOID)&g_ctx.ParamBlock, 0, &ThreadId);
     if (g_ctx.WorkerThread) {
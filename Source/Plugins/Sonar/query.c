@@ -233,37 +233,29 @@ PVOID DumpObjectWithSpecifiedSize(
 }
 
 /*
-* DumpProtocolBlockVersionAware
+* GetProtocolBlockSize
 *
 * Purpose:
 *
-* Return dumped NDIS_PROTOCOL_BLOCK version aware.
-*
-* Use HeapMemoryFree to free returned buffer.
+* Return size and version of NDIS_PROTOCOL_BLOCK (structure version specific).
 *
 */
-PVOID DumpProtocolBlockVersionAware(
-    _In_ ULONG_PTR ObjectAddress,
-    _Out_ PULONG Size,
-    _Out_ PULONG Version)
+ULONG GetProtocolBlockSize(
+    _In_ ULONG WindowsVersion,
+    _Out_ PULONG ObjectVersion)
 {
-    ULONG ObjectSize = 0;
-    ULONG ObjectVersion = 0;
-
-    //assume failure
-    if (Size) *Size = 0;
-    if (Version) *Version = 0;
+    ULONG ObjectSize;
 
-    switch (g_ctx.ParamBlock.osver.dwBuildNumber) {
+    switch (WindowsVersion) {
     case NT_WIN7_RTM:
     case NT_WIN7_SP1:
         ObjectSize = sizeof(NDIS_PROTOCOL_BLOCK_7601);
-        ObjectVersion = 1;
+        *ObjectVersion = 1;
         break;
 
     case NT_WIN8_RTM:
         ObjectSize = sizeof(NDIS_PROTOCOL_BLOCK_9200);
-        ObjectVersion = 2;
+        *ObjectVersion = 2;
         break;
 
     case NT_WIN8_BLUE:
@@ -274,82 +266,128 @@ PVOID DumpProtocolBlockVersionAware(
     case NT_WIN10_REDSTONE3:
     case NT_WIN10_REDSTONE4:
         ObjectSize = sizeof(NDIS_PROTOCOL_BLOCK_9600_17134);
-        ObjectVersion = 3;
+        *ObjectVersion = 3;
         break;
     case NT_WIN10_REDSTONE5:
         ObjectSize = sizeof(NDIS_PROTOCOL_BLOCK_17763);
-        ObjectVersion = 4;
+        *ObjectVersion = 4;
         break;
     case NT_WIN10_19H1:
     case NT_WIN10_19H2:
     default:
         ObjectSize = sizeof(NDIS_PROTOCOL_BLOCK_18362_19569);
-        ObjectVersion = 5;
+        *ObjectVersion = 5;
         break;
 
     }
 
-    return DumpObjectWithSpecifiedSize(ObjectAddress,
-        ObjectSize,
-        ObjectVersion,
-        Size,
-        Version);
+    return ObjectSize;
 }
 
 /*
-* DumpOpenBlockVersionAware
+* GetOpenBlockSize
 *
 * Purpose:
 *
-* Return dumped NDIS_OPEN_BLOCK version aware.
-*
-* Use HeapMemoryFree to free returned buffer.
+* Return size and version of NDIS_OPEN_BLOCK (structure version specific).
 *
 */
-PVOID DumpOpenBlockVersionAware(
-    _In_ ULONG_PTR ObjectAddress,
-    _Out_ PULONG Size,
-    _Out_ PULONG Version)
+ULONG GetOpenBlockSize(
+    _In_ ULONG WindowsVersion,
+    _Out_ PULONG ObjectVersion)
 {
-    ULONG ObjectSize = 0;
-    ULONG ObjectVersion = 0;
-
-    //assume failure
-    if (Size) *Size = 0;
-    if (Version) *Version = 0;
+    ULONG ObjectSize;
 
-    switch (g_ctx.ParamBlock.osver.dwBuildNumber) {
+    switch (WindowsVersion) {
     case NT_WIN7_RTM:
     case NT_WIN7_SP1:
         ObjectSize = sizeof(NDIS_OPEN_BLOCK_7601);
-        ObjectVersion = 1;
+        *ObjectVersion = 1;
         break;
     case NT_WIN8_RTM:
         ObjectSize = sizeof(NDIS_OPEN_BLOCK_9200);
-        ObjectVersion = 2;
+        *ObjectVersion = 2;
         break;
     case NT_WIN8_BLUE:
     case NT_WIN10_THRESHOLD1:
     case NT_WIN10_THRESHOLD2:
         ObjectSize = sizeof(NDIS_OPEN_BLOCK_9600_10586);
-        ObjectVersion = 3;
+        *ObjectVersion = 3;
         break;
     case NT_WIN10_REDSTONE1:
     case NT_WIN10_REDSTONE2:
     case NT_WIN10_REDSTONE3:
     case NT_WIN10_REDSTONE4:
         ObjectSize = sizeof(NDIS_OPEN_BLOCK_14393_17134);
-        ObjectVersion = 4;
+        *ObjectVersion = 4;
         break;
     case NT_WIN10_REDSTONE5:
     case NT_WIN10_19H1:
     case NT_WIN10_19H2:
     default:
         ObjectSize = sizeof(NDIS_OPEN_BLOCK_17763_19569);
-        ObjectVersion = 5;
+        *ObjectVersion = 5;
         break;
     }
 
+    return ObjectSize;
+}
+
+/*
+* DumpProtocolBlockVersionAware
+*
+* Purpose:
+*
+* Return dumped NDIS_PROTOCOL_BLOCK version aware.
+*
+* Use HeapMemoryFree to free returned buffer.
+*
+*/
+PVOID DumpProtocolBlockVersionAware(
+    _In_ ULONG_PTR ObjectAddress,
+    _Out_ PULONG Size,
+    _Out_ PULONG Version)
+{
+    ULONG ObjectSize = 0;
+    ULONG ObjectVersion = 0;
+
+    //assume failure
+    if (Size) *Size = 0;
+    if (Version) *Version = 0;
+
+    ObjectSize = GetProtocolBlockSize(g_ctx.ParamBlock.osver.dwBuildNumber, &ObjectVersion);
+
+    return DumpObjectWithSpecifiedSize(ObjectAddress,
+        ObjectSize,
+        ObjectVersion,
+        Size,
+        Version);
+}
+
+/*
+* DumpOpenBlockVersionAware
+*
+* Purpose:
+*
+* Return dumped NDIS_OPEN_BLOCK version aware.
+*
+* Use HeapMemoryFree to free returned buffer.
+*
+*/
+PVOID DumpOpenBlockVersionAware(
+    _In_ ULONG_PTR ObjectAddress,
+    _Out_ PULONG Size,
+    _Out_ PULONG Version)
+{
+    ULONG ObjectSize = 0;
+    ULONG ObjectVersion = 0;
+
+    //assume failure
+    if (Size) *Size = 0;
+    if (Version) *Version = 0;
+
+    ObjectSize = GetOpenBlockSize(g_ctx.ParamBlock.osver.dwBuildNumber, &ObjectVersion);
+
     return DumpObjectWithSpecifiedSize(ObjectAddress,
         ObjectSize,
         ObjectVersion,
@@ -470,6 +508,52 @@ ULONG GetNextProtocolOffset(
     return Offset;
 }
 
+/*
+* GetNextOpenOffset
+*
+* Purpose:
+*
+* Return offset of ProtocolNextOpen structure field (structure version specific).
+*
+*/
+ULONG GetNextOpenOffset(
+    _In_ ULONG WindowsVersion
+)
+{
+    ULONG Offset = 0;
+
+    switch (WindowsVersion) {
+
+    case NT_WIN7_RTM:
+    case NT_WIN7_SP1:
+        Offset = FIELD_OFFSET(NDIS_OPEN_BLOCK_7601, ProtocolNextOpen);
+        break;
+    case NT_WIN8_RTM:
+        Offset = FIELD_OFFSET(NDIS_OPEN_BLOCK_9200, ProtocolNextOpen);
+        break;
+    case NT_WIN8_BLUE:
+    case NT_WIN10_THRESHOLD1:
+    case NT_WIN10_THRESHOLD2:
+        Offset = FIELD_OFFSET(NDIS_COMMON_OPEN_BLOCK_9600_10586, ProtocolNextOpen);
+        break;
+    case NT_WIN10_REDSTONE1:
+    case NT_WIN10_REDSTONE2:
+    case NT_WIN10_REDSTONE3:
+    case NT_WIN10_REDSTONE4:
+        Offset = FIELD_OFFSET(NDIS_COMMON_OPEN_BLOCK_14393_17134, ProtocolNextOpen);
+        break;
+    case NT_WIN10_REDSTONE5:
+    case NT_WIN10_19H1:
+    case NT_WIN10_19H2:
+    default:
+        Offset = FIELD_OFFSET(NDIS_COMMON_OPEN_BLOCK_17763_19569, ProtocolNextOpen);
+        break;
+
+    }
+
+    return Offset;
+}
+
 /*
 * CreateCompatibleProtocolBlock
 *
@@ -398,6 +398,29 @@ PVOID DumpUnicodeString(
 ULONG GetNextProtocolOffset(
     _In_ ULONG WindowsVersion);
 
+ULONG GetNextOpenOffset(
+    _In_ ULONG WindowsVersion);
+
+ULONG GetProtocolBlockSize(
+    _In_ ULONG WindowsVersion,
+    _Out_ PULONG ObjectVersion);
+
+ULONG GetOpenBlockSize(
+    _In_ ULONG WindowsVersion,
+    _Out_ PULONG ObjectVersion);
+
+_Success_(return == TRUE)
+BOOL CreateCompatibleProtocolBlock(
+    _In_ ULONG ObjectVersion,
+    _In_ PROTOCOL_BLOCK_VERSIONS *ProtocolRef,
+    _Out_ NDIS_PROTOCOL_BLOCK_COMPATIBLE *ProtoBlock);
+
+_Success_(return == TRUE)
+BOOL CreateCompatibleOpenBlock(
+    _In_ ULONG ObjectVersion,
+    _In_ OPEN_BLOCK_VERSIONS *BlockRef,
+    _Out_ NDIS_OPEN_BLOCK_COMPATIBLE *OpenBlock);
+
 _Success_(return == TRUE)
 BOOL ReadAndConvertProtocolBlock(
     _In_ ULONG_PTR ObjectAddress,
@@ -33,6 +33,7 @@
 #define WINOBJEX64_OBJECT_PROP      40004
 
 #define ID_MENU_COPY_VALUE 41008
+#define ID_MENU_EXPORT_VIEW 41010
 
 #define Y_SPLITTER_SIZE 4
 #define Y_SPLITTER_MIN  100
@@ -89,7 +89,86 @@ typedef VOID(*pfnuiShowFileProperties)(
 typedef UINT(*pfnuiGetDPIValue)(
     _In_opt_ HWND hWnd);
 
+//
+// Key cached listview sort, keep in sync with lvsort.h.
+//
+typedef enum _LVSORT_KEY_TYPE {
+    LvSortKeyText = 0,
+    LvSortKeyULong,
+    LvSortKeyLong,
+    LvSortKeyHex,
+    LvSortKeyMax
+} LVSORT_KEY_TYPE;
+
+typedef BOOL(*pfnuiListViewSort)(
+    _In_ HWND ListView,
+    _In_ INT Column,
+    _In_ LVSORT_KEY_TYPE KeyType,
+    _In_ BOOL Inverse);
+
+//
+// List and tree view export, keep in sync with export.h.
+//
+typedef enum _EXPORT_VIEW_TYPE {
+    ExportViewListView = 0,
+    ExportViewTreeList,
+    ExportViewMax
+} EXPORT_VIEW_TYPE;
+
+typedef BOOL(*pfnuiExportView)(
+    _In_ HWND OwnerWindow,
+    _In_ HWND ViewWindow,
+    _In_ EXPORT_VIEW_TYPE ViewType,
+    _In_opt_ LPCWSTR lpDefaultName);
+
+//
+// Kernel list walker, see kdlist.h.
+//
+#define KDWALK_FLAG_NULL_TERMINATED     0x00000001
+#define KDWALK_FLAG_HEAD_IS_RECORD      0x00000002
+
+typedef enum _KDWALK_STATUS {
+    KdWalkComplete = 0,
+    KdWalkStopped,
+    KdWalkReadError,
+    KdWalkCycle,
+    KdWalkCountLimit,
+    KdWalkTimeLimit,
+    KdWalkInvalidParameter,
+    KdWalkNoMemory
+} KDWALK_STATUS;
+
+typedef BOOL(CALLBACK *PKDWALK_CALLBACK)(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context);
+
+typedef struct _KDWALK_PARAMS {
+    ULONG_PTR ListHead;
+    ULONG LinkOffset;
+    ULONG RecordSize;
+    ULONG Flags;
+    ULONG MaxCount;
+    ULONG Timeout;
+    ULONG TailPointerOffset;
+    LONG TailPointerBias;
+    ULONG TailSize;
+    PKDWALK_CALLBACK Callback;
+    PVOID Context;
+} KDWALK_PARAMS, *PKDWALK_PARAMS;
+
+typedef ULONG(CALLBACK *pfnWalkList)(
+    _In_ PKDWALK_PARAMS Params,
+    _Out_opt_ KDWALK_STATUS *Status);
+
+//
+// cbSize is set by host to sizeof(WINOBJEX_PARAM_BLOCK) it was built with.
+// Plugin must check it with WINOBJEX_PARAM_BLOCK_HAS_FIELD before using any
+// member appended after uiGetDPIValue.
+//
 typedef struct _WINOBJEX_PARAM_BLOCK {
+    ULONG cbSize;
     HWND ParentWindow;
     HINSTANCE hInstance;
     ULONG_PTR SystemRangeStart;
@@ -112,8 +191,27 @@ typedef struct _WINOBJEX_PARAM_BLOCK {
     pfnuiShowFileProperties uiShowFileProperties;
     pfnuiGetDPIValue uiGetDPIValue;
 
+    //sys, appended to keep layout for older plugins
+    pfnWalkList WalkList;
+
+    //ui, appended to keep layout for older plugins
+    pfnuiListViewSort uiListViewSort;
+    pfnuiExportView uiExportView;
+
 } WINOBJEX_PARAM_BLOCK, *PWINOBJEX_PARAM_BLOCK;
 
+#define WINOBJEX_PARAM_BLOCK_MIN_SIZE \
+    RTL_SIZEOF_THROUGH_FIELD(WINOBJEX_PARAM_BLOCK, uiGetDPIValue)
+
+#define WINOBJEX_PARAM_BLOCK_HAS_FIELD(Block, Field) \
+    ((Block)->cbSize >= RTL_SIZEOF_THROUGH_FIELD(WINOBJEX_PARAM_BLOCK, Field))
+
+//
+// Size of host block that can be copied into plugin own block.
+//
+#define WINOBJEX_PARAM_BLOCK_COPY_SIZE(Block) \
+    (((Block)->cbSize < sizeof(WINOBJEX_PARAM_BLOCK)) ? (Block)->cbSize : sizeof(WINOBJEX_PARAM_BLOCK))
+
 typedef NTSTATUS(CALLBACK *pfnStartPlugin)(
     _In_ PWINOBJEX_PARAM_BLOCK ParamBlock
     );
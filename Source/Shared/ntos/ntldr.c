@@ -13,6 +13,9 @@
 *  Depends on:    ntos.h
 *                 apisetx.h
 *
+*  Define NTLDR_RAW_ONLY to build without routines depending on Windows loader,
+*  raw PE helpers and apiset resolve cache are portable.
+*
 * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
 * ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
 * TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
@@ -136,6 +139,24 @@ NTSTATUS NtRawGetProcAddress(
     return STATUS_SUCCESS;
 }
 
+/*
+* NtRawpRangeValid
+*
+* Purpose:
+*
+* Check that Count elements of given size at Offset are inside image of Limit bytes.
+*
+*/
+__forceinline BOOLEAN NtRawpRangeValid(
+    _In_ ULONG64 Offset,
+    _In_ ULONG64 Count,
+    _In_ ULONG64 ElementSize,
+    _In_ ULONG64 Limit
+)
+{
+    return (Offset <= Limit) && (Count * ElementSize <= Limit - Offset);
+}
+
 /*
 * NtRawEnumW32kExports
 *
@@ -155,29 +176,70 @@ ULONG NtRawEnumW32kExports(
     PIMAGE_EXPORT_DIRECTORY		exp;
     PDWORD						FnPtrTable, NameTable;
     PWORD						NameOrdTable;
+    PULONG                      NameIndex;
     ULONG_PTR					fnptr, exprva, expsize;
-    ULONG						c, n, result;
+    ULONG						c, n, result, imagesize, cchName;
     PWIN32_SHADOWTABLE			NewEntry;
 
     NtHeaders = RtlImageNtHeader(Module);
+    if (NtHeaders == NULL)
+        return 0;
+
     if (NtHeaders->OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_EXPORT)
         return 0;
 
-    exprva = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress;
-    if (exprva == 0)
+    imagesize = NtHeaders->OptionalHeader.SizeOfImage;
+    if (imagesize < 2 * sizeof(DWORD))
         return 0;
 
+    exprva = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress;
     expsize = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].Size;
+    if (exprva == 0 || expsize < sizeof(IMAGE_EXPORT_DIRECTORY))
+        return 0;
+
+    //
+    // Image may come from arbitrary file, keep every table inside of it.
+    //
+    if (!NtRawpRangeValid(exprva, 1, expsize, imagesize))
+        return 0;
 
     exp = (PIMAGE_EXPORT_DIRECTORY)((ULONG_PTR)Module + exprva);
+
+    if (exp->NumberOfFunctions == 0 ||
+        exp->NumberOfFunctions >= MAXULONG / sizeof(ULONG) ||
+        !NtRawpRangeValid(exp->AddressOfFunctions, exp->NumberOfFunctions, sizeof(DWORD), imagesize) ||
+        !NtRawpRangeValid(exp->AddressOfNames, exp->NumberOfNames, sizeof(DWORD), imagesize) ||
+        !NtRawpRangeValid(exp->AddressOfNameOrdinals, exp->NumberOfNames, sizeof(WORD), imagesize))
+    {
+        return 0;
+    }
+
     FnPtrTable = (PDWORD)((ULONG_PTR)Module + exp->AddressOfFunctions);
     NameTable = (PDWORD)((ULONG_PTR)Module + exp->AddressOfNames);
     NameOrdTable = (PWORD)((ULONG_PTR)Module + exp->AddressOfNameOrdinals);
 
+    //
+    // Map function index to its first name once instead of scanning names for every stub.
+    //
+    NameIndex = (PULONG)RtlAllocateHeap(HeapHandle, 0, ((SIZE_T)exp->NumberOfFunctions + 1) * sizeof(ULONG));
+    if (NameIndex == NULL)
+        return 0;
+
+    for (c = 0; c < exp->NumberOfFunctions; ++c)
+        NameIndex[c] = MAXULONG;
+
+    for (n = exp->NumberOfNames; n != 0; --n) {
+        if (NameOrdTable[n - 1] < exp->NumberOfFunctions)
+            NameIndex[NameOrdTable[n - 1]] = n - 1;
+    }
+
     result = 0;
 
     for (c = 0; c < exp->NumberOfFunctions; ++c)
     {
+        if (FnPtrTable[c] > imagesize - 2 * sizeof(DWORD))
+            continue;
+
         fnptr = (ULONG_PTR)Module + FnPtrTable[c];
         if (*(PDWORD)fnptr != 0xb8d18b4c) //mov r10, rcx; mov eax
             continue;
@@ -190,17 +252,19 @@ ULONG NtRawEnumW32kExports(
 
         NewEntry->Index = *(PDWORD)(fnptr + 4);
 
-        for (n = 0; n < exp->NumberOfNames; ++n)
-        {
-            if (NameOrdTable[n] == c)
-            {
-                _strncpy_a(&NewEntry->Name[0],
-                    sizeof(NewEntry->Name),
-                    (LPCSTR)((ULONG_PTR)Module + NameTable[n]),
-                    sizeof(NewEntry->Name));
-
-                break;
-            }
+        n = NameIndex[c];
+        //
+        // Name may be unterminated at the image end, do not read past it.
+        //
+        if (n != MAXULONG && NameTable[n] < imagesize) {
+            cchName = imagesize - NameTable[n];
+            if (cchName > sizeof(NewEntry->Name))
+                cchName = sizeof(NewEntry->Name);
+
+            _strncpy_a(&NewEntry->Name[0],
+                sizeof(NewEntry->Name),
+                (LPCSTR)((ULONG_PTR)Module + NameTable[n]),
+                cchName);
         }
 
         ++result;
@@ -209,6 +273,8 @@ ULONG NtRawEnumW32kExports(
         Table = &NewEntry->NextService;
     }
 
+    RtlFreeHeap(HeapHandle, 0, NameIndex);
+
     return result;
 }
 
@@ -273,6 +339,68 @@ LPCSTR NtRawIATEntryToImport(
     return NULL;
 }
 
+//
+// ApiSet resolve cache, open addressing table keyed on folded apiset name
+// without version suffix and parent name.
+//
+#define NTLDR_APISET_CACHE_MIN_SIZE 256
+#define NTLDR_APISET_CACHE_MAX_KEY  512
+
+typedef struct _NTLDR_APISET_CACHE_ENTRY {
+    PWCHAR Key;                 //folded name, separator and folded parent name, NULL for empty slot
+    ULONG KeyLength;            //in chars
+    ULONG Hash;
+    NTSTATUS Status;
+    PAPI_SET_VALUE_ENTRY_V6 HostLibraryEntry;
+} NTLDR_APISET_CACHE_ENTRY, *PNTLDR_APISET_CACHE_ENTRY;
+
+typedef struct _NTLDR_APISET_CACHE {
+    HANDLE HeapHandle;
+    PAPI_SET_NAMESPACE_ARRAY_V6 Namespace;
+    ULONG Count;
+    ULONG Size;                 //power of two
+    PNTLDR_APISET_CACHE_ENTRY Entries;
+} NTLDR_APISET_CACHE;
+
+/*
+* ApiSetpCompareNames
+*
+* Purpose:
+*
+* Case insensitive compare of apiset names.
+*
+* Apiset names are ASCII, so simple upcase keeps schema sort order
+* and makes this code independent of ntdll.
+*
+*/
+LONG ApiSetpCompareNames(
+    _In_ PWCHAR Name1,
+    _In_ ULONG Name1Length,
+    _In_ PWCHAR Name2,
+    _In_ ULONG Name2Length)
+{
+    ULONG i, Length;
+    WCHAR c1, c2;
+
+    Length = (Name1Length < Name2Length) ? Name1Length : Name2Length;
+
+    for (i = 0; i < Length; i++) {
+
+        c1 = Name1[i];
+        c2 = Name2[i];
+
+        if ((c1 >= L'a') && (c1 <= L'z'))
+            c1 -= 0x20;
+        if ((c2 >= L'a') && (c2 <= L'z'))
+            c2 -= 0x20;
+
+        if (c1 != c2)
+            return (LONG)c1 - (LONG)c2;
+    }
+
+    return (LONG)Name1Length - (LONG)Name2Length;
+}
+
 /*
 * ApiSetpSearchForApiSetHost
 *
@@ -306,11 +434,10 @@ PAPI_SET_VALUE_ENTRY_V6 ApiSetpSearchForApiSetHost(
             AliasValueEntry = API_SET_TO_VALUE_ENTRY(Namespace, Entry, AliasIndex);
             AliasName = API_SET_TO_VALUE_NAME(Namespace, AliasValueEntry);
 
-            CompareResult = RtlCompareUnicodeStrings(ApiSetToResolve,
+            CompareResult = ApiSetpCompareNames(ApiSetToResolve,
                 ApiSetToResolveLength,
                 AliasName,
-                AliasValueEntry->NameLength >> 1,
-                TRUE);
+                AliasValueEntry->NameLength >> 1);
 
             if (CompareResult < 0) {
                 AliasCount = AliasIndex - 1;
@@ -382,6 +509,8 @@ PAPI_SET_NAMESPACE_ENTRY_V6 ApiSetpSearchForApiSet(
         EntryHash = LookupHashEntry->Hash;
 
         if (LookupHash < EntryHash) {
+            if (HashIndex == 0)
+                return NULL;
             EntryCount = HashIndex - 1;
             if (c > EntryCount)
                 return NULL;
@@ -411,11 +540,10 @@ PAPI_SET_NAMESPACE_ENTRY_V6 ApiSetpSearchForApiSet(
     //
     NamespaceEntryName = API_SET_TO_NAMESPACE_ENTRY_NAME(ApiSetNamespace, NamespaceEntry);
 
-    if (RtlCompareUnicodeStrings(ResolveName,
+    if (ApiSetpCompareNames(ResolveName,
         ResolveNameEffectiveLength,
         NamespaceEntryName,
-        (NamespaceEntry->HashNameLength >> 1),
-        TRUE) == 0)
+        (NamespaceEntry->HashNameLength >> 1)) == 0)
     {
         return NamespaceEntry;
     }
@@ -424,126 +552,675 @@ PAPI_SET_NAMESPACE_ENTRY_V6 ApiSetpSearchForApiSet(
 }
 
 /*
-* NtLdrApiSetResolveLibrary
+* ApiSetpQueryEffectiveName
 *
 * Purpose:
 *
-* Resolve apiset library name.
+* Check apiset name prefix and calculate name length in chars
+* without everything after last hyphen including dll suffix.
 *
 */
-_Success_(return == STATUS_SUCCESS)
-NTSTATUS NtLdrApiSetResolveLibrary(
-    _In_ PVOID Namespace,
+NTSTATUS ApiSetpQueryEffectiveName(
     _In_ PUNICODE_STRING ApiSetToResolve,
-    _In_opt_ PUNICODE_STRING ApiSetParentName,
-    _Out_ PBOOL Resolved,
-    _Out_ PUNICODE_STRING ResolvedHostLibraryName
-)
+    _Out_ PUSHORT EffectiveLength)
 {
-    BOOL IsResolved = FALSE;
-    NTSTATUS Status = STATUS_UNSUCCESSFUL;
     PWCHAR BufferPtr;
     USHORT Length;
     ULONG64 SchemaPrefix;
+
+    *EffectiveLength = 0;
+
+    if (ApiSetToResolve->Length < 8)
+        return STATUS_INVALID_PARAMETER_2;
+
+    //
+    // Check prefix.
+    //
+    SchemaPrefix = APISET_TO_UPPER_PREFIX(((ULONG64*)ApiSetToResolve->Buffer)[0]);
+    if ((SchemaPrefix != API_SET_PREFIX_API) && (SchemaPrefix != API_SET_PREFIX_EXT)) //API- or EXT- only
+        return STATUS_INVALID_PARAMETER;
+
+    BufferPtr = (PWCHAR)RtlOffsetToPointer(ApiSetToResolve->Buffer, ApiSetToResolve->Length);
+
+    Length = ApiSetToResolve->Length;
+
+    do {
+        if (Length <= 1)
+            break;
+
+        Length -= sizeof(WCHAR);
+        --BufferPtr;
+
+    } while (*BufferPtr != L'-');
+
+    *EffectiveLength = (USHORT)Length >> 1;
+    return STATUS_SUCCESS;
+}
+
+/*
+* ApiSetpResolveHost
+*
+* Purpose:
+*
+* Find host library value entry for apiset name.
+*
+* Returns STATUS_INVALID_PARAMETER if apiset not found and
+* STATUS_UNSUCCESSFUL if apiset has no host library.
+*
+*/
+NTSTATUS ApiSetpResolveHost(
+    _In_ PVOID Namespace,
+    _In_ PWCHAR ApiSetName,
+    _In_ USHORT ApiSetNameEffectiveLength,
+    _In_opt_ PWCHAR ApiSetParentName,
+    _In_ USHORT ApiSetParentNameLength,
+    _Out_ PAPI_SET_VALUE_ENTRY_V6* HostLibraryEntry)
+{
     API_SET_NAMESPACE_ENTRY_V6* ResolvedEntry;
-    API_SET_VALUE_ENTRY_V6* HostLibraryEntry = NULL;
-    PAPI_SET_NAMESPACE_ARRAY_V6 ApiSetNamespace = (PAPI_SET_NAMESPACE_ARRAY_V6)Namespace;
+    API_SET_VALUE_ENTRY_V6* HostEntry = NULL;
 
-    __try {
+    *HostLibraryEntry = NULL;
 
-        *Resolved = FALSE;
+    //
+    // Resolve apiset entry.
+    //
+    ResolvedEntry = ApiSetpSearchForApiSet(
+        Namespace,
+        ApiSetName,
+        ApiSetNameEffectiveLength);
 
-        //
-        // Only Win10+ version supported.
-        //
-        if (ApiSetNamespace->Version != 6)
-            return STATUS_UNKNOWN_REVISION;
+    if (ResolvedEntry == NULL)
+        return STATUS_INVALID_PARAMETER;
+
+    //
+    // If parent name specified and resolved entry has more than 1 value entry check it out.
+    //
+    if (ApiSetParentName && ResolvedEntry->Count > 1) {
+
+        HostEntry = ApiSetpSearchForApiSetHost(ResolvedEntry,
+            ApiSetParentName,
+            ApiSetParentNameLength,
+            Namespace);
 
-        if (ApiSetToResolve->Length < 8)
-            return STATUS_INVALID_PARAMETER_2;
+    }
+    else {
 
         //
-        // Check prefix.
+        // If resolved apiset entry has value check it out.
         //
-        SchemaPrefix = APISET_TO_UPPER_PREFIX(((ULONG64*)ApiSetToResolve->Buffer)[0]);
-        if ((SchemaPrefix != API_SET_PREFIX_API) && (SchemaPrefix != API_SET_PREFIX_EXT)) //API- or EXT- only
-            return STATUS_INVALID_PARAMETER;
+        if (ResolvedEntry->Count > 0) {
+            HostEntry = API_SET_TO_VALUE_ENTRY(Namespace, ResolvedEntry, 0);
+        }
+    }
+
+    if (HostEntry == NULL || API_SET_EMPTY_NAMESPACE_VALUE(HostEntry))
+        return STATUS_UNSUCCESSFUL;
+
+    *HostLibraryEntry = HostEntry;
+    return STATUS_SUCCESS;
+}
+
+/*
+* ApiSetpRangeValid
+*
+* Purpose:
+*
+* Check that Size bytes at Offset are inside schema.
+*
+*/
+__forceinline BOOL ApiSetpRangeValid(
+    _In_ ULONG64 Offset,
+    _In_ ULONG64 Size,
+    _In_ ULONG64 Limit)
+{
+    return (Offset <= Limit) && (Size <= Limit - Offset);
+}
+
+/*
+* ApiSetpValidateSchema
+*
+* Purpose:
+*
+* Verify every offset used by resolve routines, so schema may come from file.
+*
+*/
+BOOL ApiSetpValidateSchema(
+    _In_ PAPI_SET_NAMESPACE_ARRAY_V6 Namespace,
+    _In_ ULONG NamespaceSize)
+{
+    ULONG i, j, Limit;
+    PAPI_SET_HASH_ENTRY_V6 HashEntry;
+    PAPI_SET_NAMESPACE_ENTRY_V6 Entry;
+    PAPI_SET_VALUE_ENTRY_V6 ValueEntry;
+
+    if (NamespaceSize && NamespaceSize < sizeof(API_SET_NAMESPACE_ARRAY_V6))
+        return FALSE;
+
+    if (Namespace->Version != API_SET_SCHEMA_VERSION_V6)
+        return FALSE;
+
+    Limit = Namespace->Size;
+    if (Limit < sizeof(API_SET_NAMESPACE_ARRAY_V6) || (NamespaceSize && Limit > NamespaceSize))
+        return FALSE;
+
+    if (!ApiSetpRangeValid(Namespace->NamespaceEntryOffset,
+        (ULONG64)Namespace->Count * sizeof(API_SET_NAMESPACE_ENTRY_V6), Limit))
+    {
+        return FALSE;
+    }
+
+    if (!ApiSetpRangeValid(Namespace->NamespaceHashesOffset,
+        (ULONG64)Namespace->Count * sizeof(ULONG_PTR), Limit))
+    {
+        return FALSE;
+    }
+
+    for (i = 0; i < Namespace->Count; i++) {
+
+        HashEntry = API_SET_TO_HASH_ENTRY(Namespace, i);
+        if (HashEntry->NamespaceIndex >= Namespace->Count)
+            return FALSE;
+
+        Entry = (PAPI_SET_NAMESPACE_ENTRY_V6)RtlOffsetToPointer(Namespace,
+            Namespace->NamespaceEntryOffset + i * sizeof(API_SET_NAMESPACE_ENTRY_V6));
+
+        if (Entry->NameLength > MAXUSHORT ||
+            Entry->HashNameLength > Entry->NameLength ||
+            !ApiSetpRangeValid(Entry->NameOffset, Entry->NameLength, Limit) ||
+            !ApiSetpRangeValid(Entry->DataOffset, (ULONG64)Entry->Count * sizeof(API_SET_VALUE_ENTRY_V6), Limit))
+        {
+            return FALSE;
+        }
+
+        for (j = 0; j < Entry->Count; j++) {
+
+            ValueEntry = API_SET_TO_VALUE_ENTRY(Namespace, Entry, j);
+
+            if (ValueEntry->NameLength > MAXUSHORT ||
+                ValueEntry->ValueLength > MAXUSHORT ||
+                !ApiSetpRangeValid(ValueEntry->NameOffset, ValueEntry->NameLength, Limit) ||
+                !ApiSetpRangeValid(ValueEntry->ValueOffset, ValueEntry->ValueLength, Limit))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+* ApiSetpCacheBuildKey
+*
+* Purpose:
+*
+* Build folded cache key from apiset name and parent name, calculate its hash.
+*
+*/
+BOOL ApiSetpCacheBuildKey(
+    _In_ PWCHAR Name,
+    _In_ USHORT NameLength,
+    _In_opt_ PWCHAR ParentName,
+    _In_ USHORT ParentNameLength,
+    _Out_ PWCHAR Key,
+    _Out_ PULONG KeyLength,
+    _Out_ PULONG Hash)
+{
+    ULONG i, k = 0, h = 0;
+    WCHAR ch;
+
+    *KeyLength = 0;
+    *Hash = 0;
+
+    if ((ULONG)NameLength + ParentNameLength + 1 > NTLDR_APISET_CACHE_MAX_KEY)
+        return FALSE;
+
+    for (i = 0; i < NameLength; i++) {
+        ch = locase_w(Name[i]);
+        Key[k++] = ch;
+        h = (h * 65599) + ch;
+    }
+
+    Key[k++] = L'|';
+    h = (h * 65599) + L'|';
+
+    for (i = 0; i < ParentNameLength; i++) {
+        ch = locase_w(ParentName[i]);
+        Key[k++] = ch;
+        h = (h * 65599) + ch;
+    }
+
+    *KeyLength = k;
+    *Hash = h;
+    return TRUE;
+}
+
+/*
+* ApiSetpCacheLookup
+*
+* Purpose:
+*
+* Find cache entry or empty slot for the key.
+*
+*/
+PNTLDR_APISET_CACHE_ENTRY ApiSetpCacheLookup(
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PWCHAR Key,
+    _In_ ULONG KeyLength,
+    _In_ ULONG Hash)
+{
+    ULONG i;
+    PNTLDR_APISET_CACHE_ENTRY Entry;
+
+    for (i = Hash & (Cache->Size - 1); ; i = (i + 1) & (Cache->Size - 1)) {
+
+        Entry = &Cache->Entries[i];
+
+        if (Entry->Key == NULL)
+            return Entry;
+
+        if (Entry->Hash == Hash &&
+            Entry->KeyLength == KeyLength &&
+            RtlEqualMemory(Entry->Key, Key, KeyLength * sizeof(WCHAR)))
+        {
+            return Entry;
+        }
+    }
+}
+
+/*
+* ApiSetpCacheGrow
+*
+* Purpose:
+*
+* Double cache table and reinsert entries.
+*
+*/
+BOOL ApiSetpCacheGrow(
+    _In_ PNTLDR_APISET_CACHE Cache)
+{
+    ULONG i, j, NewSize = Cache->Size * 2;
+    PNTLDR_APISET_CACHE_ENTRY NewEntries;
+
+    NewEntries = (PNTLDR_APISET_CACHE_ENTRY)RtlAllocateHeap(Cache->HeapHandle,
+        HEAP_ZERO_MEMORY,
+        NewSize * sizeof(NTLDR_APISET_CACHE_ENTRY));
+
+    if (NewEntries == NULL)
+        return FALSE;
+
+    for (i = 0; i < Cache->Size; i++) {
+        if (Cache->Entries[i].Key) {
+            j = Cache->Entries[i].Hash & (NewSize - 1);
+            while (NewEntries[j].Key)
+                j = (j + 1) & (NewSize - 1);
+            NewEntries[j] = Cache->Entries[i];
+        }
+    }
+
+    RtlFreeHeap(Cache->HeapHandle, 0, Cache->Entries);
+    Cache->Entries = NewEntries;
+    Cache->Size = NewSize;
+    return TRUE;
+}
+
+/*
+* ApiSetpCacheInsert
+*
+* Purpose:
+*
+* Remember resolve result for the key.
+*
+*/
+BOOL ApiSetpCacheInsert(
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PWCHAR Key,
+    _In_ ULONG KeyLength,
+    _In_ ULONG Hash,
+    _In_ NTSTATUS Status,
+    _In_opt_ PAPI_SET_VALUE_ENTRY_V6 HostLibraryEntry)
+{
+    PWCHAR KeyCopy;
+    PNTLDR_APISET_CACHE_ENTRY Entry;
+
+    //
+    // Keep load factor at most one half.
+    //
+    if ((Cache->Count + 1) * 2 > Cache->Size) {
+        if (!ApiSetpCacheGrow(Cache))
+            return FALSE;
+    }
+
+    Entry = ApiSetpCacheLookup(Cache, Key, KeyLength, Hash);
+    if (Entry->Key)
+        return TRUE;
+
+    KeyCopy = (PWCHAR)RtlAllocateHeap(Cache->HeapHandle, 0, KeyLength * sizeof(WCHAR));
+    if (KeyCopy == NULL)
+        return FALSE;
+
+    RtlCopyMemory(KeyCopy, Key, KeyLength * sizeof(WCHAR));
+
+    Entry->Key = KeyCopy;
+    Entry->KeyLength = KeyLength;
+    Entry->Hash = Hash;
+    Entry->Status = Status;
+    Entry->HostLibraryEntry = HostLibraryEntry;
+
+    Cache->Count += 1;
+    return TRUE;
+}
+
+/*
+* ApiSetpCacheFlatten
+*
+* Purpose:
+*
+* Resolve every apiset and every alias of schema in advance.
+*
+*/
+BOOL ApiSetpCacheFlatten(
+    _In_ PNTLDR_APISET_CACHE Cache)
+{
+    ULONG i, j, KeyLength, Hash;
+    USHORT NameLength, AliasLength;
+    NTSTATUS Status;
+    PWCHAR Name, AliasName;
+    PAPI_SET_NAMESPACE_ARRAY_V6 Namespace = Cache->Namespace;
+    PAPI_SET_NAMESPACE_ENTRY_V6 Entry;
+    PAPI_SET_VALUE_ENTRY_V6 ValueEntry, HostEntry;
+    WCHAR Key[NTLDR_APISET_CACHE_MAX_KEY];
+
+    for (i = 0; i < Namespace->Count; i++) {
+
+        Entry = (PAPI_SET_NAMESPACE_ENTRY_V6)RtlOffsetToPointer(Namespace,
+            Namespace->NamespaceEntryOffset + i * sizeof(API_SET_NAMESPACE_ENTRY_V6));
+
+        Name = API_SET_TO_NAMESPACE_ENTRY_NAME(Namespace, Entry);
+        NameLength = (USHORT)(Entry->HashNameLength >> 1);
 
         //
-        // Calculate length without everything after last hyphen including dll suffix.
+        // Resolve through schema search, so flattened result is exactly
+        // what lazy resolve would return for this name.
         //
-        BufferPtr = (PWCHAR)RtlOffsetToPointer(ApiSetToResolve->Buffer, ApiSetToResolve->Length);
+        if (ApiSetpCacheBuildKey(Name, NameLength, NULL, 0, Key, &KeyLength, &Hash)) {
 
-        Length = ApiSetToResolve->Length;
+            Status = ApiSetpResolveHost(Namespace, Name, NameLength, NULL, 0, &HostEntry);
+            if (!ApiSetpCacheInsert(Cache, Key, KeyLength, Hash, Status, HostEntry))
+                return FALSE;
 
-        do {
-            if (Length <= 1)
-                break;
+        }
+
+        for (j = 1; j < Entry->Count; j++) {
+
+            ValueEntry = API_SET_TO_VALUE_ENTRY(Namespace, Entry, j);
+            AliasName = API_SET_TO_VALUE_NAME(Namespace, ValueEntry);
+            AliasLength = (USHORT)(ValueEntry->NameLength >> 1);
+
+            if (!ApiSetpCacheBuildKey(Name, NameLength, AliasName, AliasLength, Key, &KeyLength, &Hash))
+                continue;
+
+            Status = ApiSetpResolveHost(Namespace, Name, NameLength, AliasName, AliasLength, &HostEntry);
+            if (!ApiSetpCacheInsert(Cache, Key, KeyLength, Hash, Status, HostEntry))
+                return FALSE;
+        }
+    }
 
-            Length -= sizeof(WCHAR);
-            --BufferPtr;
+    return TRUE;
+}
 
-        } while (*BufferPtr != L'-');
+/*
+* NtLdrApiSetCacheCreate
+*
+* Purpose:
+*
+* Create apiset resolve cache for V6 schema.
+*
+* Schema can be loader map from PEB or blob read from file, NamespaceSize
+* is blob size or zero to trust schema header. Memory allocated from HeapHandle.
+* If Flatten is set whole schema is resolved at once, otherwise cache is
+* filled on demand.
+*
+*/
+_Success_(return != NULL)
+PNTLDR_APISET_CACHE NtLdrApiSetCacheCreate(
+    _In_ HANDLE HeapHandle,
+    _In_ PVOID Namespace,
+    _In_ ULONG NamespaceSize,
+    _In_ BOOL Flatten)
+{
+    ULONG i, Size, Count;
+    PNTLDR_APISET_CACHE Cache;
+    PAPI_SET_NAMESPACE_ARRAY_V6 ApiSetNamespace = (PAPI_SET_NAMESPACE_ARRAY_V6)Namespace;
+    PAPI_SET_NAMESPACE_ENTRY_V6 Entry;
+
+    if (!ApiSetpValidateSchema(ApiSetNamespace, NamespaceSize))
+        return NULL;
 
-        Length = (USHORT)Length >> 1;
+    Size = NTLDR_APISET_CACHE_MIN_SIZE;
+
+    if (Flatten) {
+
+        Count = ApiSetNamespace->Count;
+
+        for (i = 0; i < ApiSetNamespace->Count; i++) {
+            Entry = (PAPI_SET_NAMESPACE_ENTRY_V6)RtlOffsetToPointer(ApiSetNamespace,
+                ApiSetNamespace->NamespaceEntryOffset + i * sizeof(API_SET_NAMESPACE_ENTRY_V6));
+            if (Entry->Count > 1)
+                Count += Entry->Count - 1;
+        }
+
+        while (Size < Count * 2 && Size < 0x40000000)
+            Size *= 2;
+    }
+
+    Cache = (PNTLDR_APISET_CACHE)RtlAllocateHeap(HeapHandle,
+        HEAP_ZERO_MEMORY,
+        sizeof(NTLDR_APISET_CACHE));
+
+    if (Cache == NULL)
+        return NULL;
+
+    Cache->HeapHandle = HeapHandle;
+    Cache->Namespace = ApiSetNamespace;
+    Cache->Size = Size;
+    Cache->Entries = (PNTLDR_APISET_CACHE_ENTRY)RtlAllocateHeap(HeapHandle,
+        HEAP_ZERO_MEMORY,
+        Size * sizeof(NTLDR_APISET_CACHE_ENTRY));
+
+    if (Cache->Entries == NULL) {
+        RtlFreeHeap(HeapHandle, 0, Cache);
+        return NULL;
+    }
+
+    if (Flatten && !ApiSetpCacheFlatten(Cache)) {
+        NtLdrApiSetCacheDestroy(Cache);
+        return NULL;
+    }
+
+    return Cache;
+}
+
+/*
+* NtLdrApiSetCacheDestroy
+*
+* Purpose:
+*
+* Release apiset resolve cache.
+*
+*/
+VOID NtLdrApiSetCacheDestroy(
+    _In_ PNTLDR_APISET_CACHE Cache)
+{
+    ULONG i;
+
+    for (i = 0; i < Cache->Size; i++) {
+        if (Cache->Entries[i].Key)
+            RtlFreeHeap(Cache->HeapHandle, 0, Cache->Entries[i].Key);
+    }
+
+    RtlFreeHeap(Cache->HeapHandle, 0, Cache->Entries);
+    RtlFreeHeap(Cache->HeapHandle, 0, Cache);
+}
+
+/*
+* NtLdrApiSetCacheResolve
+*
+* Purpose:
+*
+* Resolve apiset library name through cache.
+*
+* Same results as NtLdrApiSetResolveLibrary, but ResolvedHostLibraryName
+* points to schema and must not be freed.
+*
+*/
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS NtLdrApiSetCacheResolve(
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PUNICODE_STRING ApiSetToResolve,
+    _In_opt_ PUNICODE_STRING ApiSetParentName,
+    _Out_ PBOOL Resolved,
+    _Out_ PUNICODE_STRING ResolvedHostLibraryName)
+{
+    BOOL KeyValid;
+    ULONG KeyLength, Hash;
+    USHORT Length, ParentLength = 0;
+    PWCHAR ParentName = NULL;
+    NTSTATUS Status;
+    PNTLDR_APISET_CACHE_ENTRY Entry = NULL;
+    PAPI_SET_VALUE_ENTRY_V6 HostLibraryEntry;
+    WCHAR Key[NTLDR_APISET_CACHE_MAX_KEY];
+
+    *Resolved = FALSE;
+
+    Status = ApiSetpQueryEffectiveName(ApiSetToResolve, &Length);
+    if (!NT_SUCCESS(Status))
+        return Status;
+
+    if (ApiSetParentName) {
+        ParentName = ApiSetParentName->Buffer;
+        ParentLength = (USHORT)(ApiSetParentName->Length >> 1);
+    }
+
+    //
+    // Names too long for key buffer are resolved without cache.
+    //
+    KeyValid = ApiSetpCacheBuildKey(ApiSetToResolve->Buffer,
+        Length,
+        ParentName,
+        ParentLength,
+        Key,
+        &KeyLength,
+        &Hash);
+
+    if (KeyValid)
+        Entry = ApiSetpCacheLookup(Cache, Key, KeyLength, Hash);
+
+    if (Entry && Entry->Key) {
+        Status = Entry->Status;
+        HostLibraryEntry = Entry->HostLibraryEntry;
+    }
+    else {
+
+        Status = ApiSetpResolveHost(Cache->Namespace,
+            ApiSetToResolve->Buffer,
+            Length,
+            ParentName,
+            ParentLength,
+            &HostLibraryEntry);
 
         //
-        // Resolve apiset entry.
+        // Result is still valid if it cannot be remembered.
         //
-        ResolvedEntry = ApiSetpSearchForApiSet(
-            Namespace,
-            ApiSetToResolve->Buffer,
-            Length);
+        if (KeyValid)
+            ApiSetpCacheInsert(Cache, Key, KeyLength, Hash, Status, HostLibraryEntry);
+    }
+
+    if (!NT_SUCCESS(Status))
+        return Status;
+
+    ResolvedHostLibraryName->Length = (USHORT)HostLibraryEntry->ValueLength;
+    ResolvedHostLibraryName->MaximumLength = (USHORT)HostLibraryEntry->ValueLength;
+    ResolvedHostLibraryName->Buffer = (PWSTR)RtlOffsetToPointer(Cache->Namespace, HostLibraryEntry->ValueOffset);
+
+    *Resolved = TRUE;
+    return STATUS_SUCCESS;
+}
+
+#ifndef NTLDR_RAW_ONLY
+
+/*
+* NtLdrApiSetResolveLibrary
+*
+* Purpose:
+*
+* Resolve apiset library name.
+*
+*/
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS NtLdrApiSetResolveLibrary(
+    _In_ PVOID Namespace,
+    _In_ PUNICODE_STRING ApiSetToResolve,
+    _In_opt_ PUNICODE_STRING ApiSetParentName,
+    _Out_ PBOOL Resolved,
+    _Out_ PUNICODE_STRING ResolvedHostLibraryName
+)
+{
+    BOOL IsResolved = FALSE;
+    NTSTATUS Status;
+    PWCHAR BufferPtr;
+    USHORT Length;
+    API_SET_VALUE_ENTRY_V6* HostLibraryEntry = NULL;
+    PAPI_SET_NAMESPACE_ARRAY_V6 ApiSetNamespace = (PAPI_SET_NAMESPACE_ARRAY_V6)Namespace;
+
+    __try {
 
-        if (ResolvedEntry == NULL)
-            return STATUS_INVALID_PARAMETER;
+        *Resolved = FALSE;
 
         //
-        // If parent name specified and resolved entry has more than 1 value entry check it out.
+        // Only Win10+ version supported.
         //
-        if (ApiSetParentName && ResolvedEntry->Count > 1) {
+        if (ApiSetNamespace->Version != 6)
+            return STATUS_UNKNOWN_REVISION;
 
-            HostLibraryEntry = ApiSetpSearchForApiSetHost(ResolvedEntry,
-                ApiSetParentName->Buffer,
-                ApiSetParentName->Length >> 1,
-                Namespace);
+        Status = ApiSetpQueryEffectiveName(ApiSetToResolve, &Length);
+        if (!NT_SUCCESS(Status))
+            return Status;
 
-        }
-        else {
+        Status = ApiSetpResolveHost(Namespace,
+            ApiSetToResolve->Buffer,
+            Length,
+            (ApiSetParentName) ? ApiSetParentName->Buffer : NULL,
+            (ApiSetParentName) ? (USHORT)(ApiSetParentName->Length >> 1) : 0,
+            &HostLibraryEntry);
 
-            //
-            // If resolved apiset entry has value check it out.
-            //
-            if (ResolvedEntry->Count > 0) {
-                HostLibraryEntry = API_SET_TO_VALUE_ENTRY(Namespace, ResolvedEntry, 0);
-            }
-        }
+        if (Status == STATUS_INVALID_PARAMETER)
+            return Status;
 
         //
         // Set output parameter if host library resolved.
         //
-        if (HostLibraryEntry) {
-            if (!API_SET_EMPTY_NAMESPACE_VALUE(HostLibraryEntry)) {
+        if (NT_SUCCESS(Status)) {
 
-                IsResolved = TRUE;
+            IsResolved = TRUE;
+            Status = STATUS_UNSUCCESSFUL;
 
-                //
-                // Host library name is not null terminated, handle that.
-                //
-                BufferPtr = (PWSTR)RtlAllocateHeap(NtCurrentPeb()->ProcessHeap, HEAP_ZERO_MEMORY,
-                    HostLibraryEntry->ValueLength + sizeof(WCHAR));
+            //
+            // Host library name is not null terminated, handle that.
+            //
+            BufferPtr = (PWSTR)RtlAllocateHeap(NtCurrentPeb()->ProcessHeap, HEAP_ZERO_MEMORY,
+                HostLibraryEntry->ValueLength + sizeof(WCHAR));
 
-                if (BufferPtr) {
+            if (BufferPtr) {
 
-                    RtlCopyMemory(BufferPtr,
-                        (PWSTR)RtlOffsetToPointer(Namespace, HostLibraryEntry->ValueOffset),
-                        (SIZE_T)HostLibraryEntry->ValueLength);
+                RtlCopyMemory(BufferPtr,
+                    (PWSTR)RtlOffsetToPointer(Namespace, HostLibraryEntry->ValueOffset),
+                    (SIZE_T)HostLibraryEntry->ValueLength);
 
-                    ResolvedHostLibraryName->Length = (USHORT)HostLibraryEntry->ValueLength;
-                    ResolvedHostLibraryName->MaximumLength = (USHORT)HostLibraryEntry->ValueLength;
-                    ResolvedHostLibraryName->Buffer = BufferPtr;
-                    Status = STATUS_SUCCESS;
-                }
+                ResolvedHostLibraryName->Length = (USHORT)HostLibraryEntry->ValueLength;
+                ResolvedHostLibraryName->MaximumLength = (USHORT)HostLibraryEntry->ValueLength;
+                ResolvedHostLibraryName->Buffer = BufferPtr;
+                Status = STATUS_SUCCESS;
             }
         }
     }
@@ -584,3 +1261,4 @@ BOOLEAN NtLdrApiSetLoadFromPeb(
     return TRUE;
 }
 
+#endif /* NTLDR_RAW_ONLY */
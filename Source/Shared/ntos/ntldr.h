@@ -75,6 +75,28 @@ NTSTATUS NtRawGetProcAddress(
     _In_ LPCSTR ProcName,
     _In_ PRESOLVE_INFO Pointer);
 
+typedef struct _NTLDR_APISET_CACHE *PNTLDR_APISET_CACHE;
+
+_Success_(return != NULL)
+PNTLDR_APISET_CACHE NtLdrApiSetCacheCreate(
+    _In_ HANDLE HeapHandle,
+    _In_ PVOID Namespace,
+    _In_ ULONG NamespaceSize,
+    _In_ BOOL Flatten);
+
+VOID NtLdrApiSetCacheDestroy(
+    _In_ PNTLDR_APISET_CACHE Cache);
+
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS NtLdrApiSetCacheResolve(
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PUNICODE_STRING ApiSetToResolve,
+    _In_opt_ PUNICODE_STRING ApiSetParentName,
+    _Out_ PBOOL Resolved,
+    _Out_ PUNICODE_STRING ResolvedHostLibraryName);
+
+#ifndef NTLDR_RAW_ONLY
+
 BOOLEAN NtLdrApiSetLoadFromPeb(
     _Out_ PULONG SchemaVersion,
     _Out_ PVOID* DataPointer);
@@ -86,3 +108,5 @@ NTSTATUS NtLdrApiSetResolveLibrary(
     _In_opt_ PUNICODE_STRING ApiSetParentName,
     _Out_ PBOOL Resolved,
     _Out_ PUNICODE_STRING ResolvedHostLibraryName);
+
+#endif /* NTLDR_RAW_ONLY */
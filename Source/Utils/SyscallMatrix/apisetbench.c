@@ -0,0 +1,860 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       APISETBENCH.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Offline test and benchmark for Shared\ntos\ntldr.c apiset resolve cache.
+*
+*  apisetbench [-n iterations] [schema]
+*
+*  Schema is either raw V6 apiset namespace or apisetschema.dll image. When
+*  omitted synthetic schema with several thousands entries is generated.
+*
+*  Every namespace entry is resolved with cache in lazy and flattened mode,
+*  twice each so the second pass is served from cache, results are compared
+*  with uncached ApiSetpResolveHost. Then lookups are timed for both paths.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include "ntos/apisetx.h"
+#include <time.h>
+#include <unistd.h>
+
+//
+// Shared\ntos\ntldr.c internals, uncached reference resolver.
+//
+NTSTATUS ApiSetpQueryEffectiveName(
+    _In_ PUNICODE_STRING ApiSetToResolve,
+    _Out_ PUSHORT EffectiveLength);
+
+NTSTATUS ApiSetpResolveHost(
+    _In_ PVOID Namespace,
+    _In_ PWCHAR ApiSetName,
+    _In_ USHORT ApiSetNameLength,
+    _In_opt_ PWCHAR ParentName,
+    _In_ USHORT ParentNameLength,
+    _Out_ PAPI_SET_VALUE_ENTRY_V6* HostLibraryEntry);
+
+#define ASB_SYNTHETIC_COUNT     3000
+#define ASB_HASH_MULTIPLIER     0x1F
+#define ASB_DEFAULT_ITERATIONS  2000000
+#define ASB_MAX_NAME            260
+
+typedef struct _ASB_BUILDER {
+    PBYTE Buffer;
+    ULONG Size;
+    ULONG Capacity;
+} ASB_BUILDER, *PASB_BUILDER;
+
+typedef struct _ASB_QUERY {
+    UNICODE_STRING Name;
+    UNICODE_STRING Parent;      //Buffer is NULL if no parent
+    WCHAR NameBuffer[ASB_MAX_NAME];
+    WCHAR ParentBuffer[ASB_MAX_NAME];
+} ASB_QUERY, *PASB_QUERY;
+
+typedef struct _ASB_STATS {
+    ULONG Total;
+    ULONG Mismatches;
+} ASB_STATS, *PASB_STATS;
+
+/*
+* asbpSecondsNow
+*
+* Purpose:
+*
+* Return monotonic clock value in seconds.
+*
+*/
+double asbpSecondsNow(
+    VOID
+)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/*
+* asbpAppend
+*
+* Purpose:
+*
+* Append data to schema being built, returns offset of data or MAXULONG.
+*
+*/
+ULONG asbpAppend(
+    _In_ PASB_BUILDER Builder,
+    _In_opt_ const VOID* Data,
+    _In_ ULONG Size
+)
+{
+    ULONG Offset, NewCapacity;
+    PBYTE NewBuffer;
+
+    Offset = (Builder->Size + 3) & ~3UL;
+
+    if (Offset + Size > Builder->Capacity) {
+
+        NewCapacity = (Builder->Capacity) ? Builder->Capacity * 2 : 0x10000;
+        while (NewCapacity < Offset + Size)
+            NewCapacity *= 2;
+
+        NewBuffer = (PBYTE)realloc(Builder->Buffer, NewCapacity);
+        if (NewBuffer == NULL)
+            return MAXULONG;
+
+        memset(NewBuffer + Builder->Capacity, 0, NewCapacity - Builder->Capacity);
+        Builder->Buffer = NewBuffer;
+        Builder->Capacity = NewCapacity;
+    }
+
+    if (Data)
+        memcpy(Builder->Buffer + Offset, Data, Size);
+
+    Builder->Size = Offset + Size;
+    return Offset;
+}
+
+/*
+* asbpAppendName
+*
+* Purpose:
+*
+* Append ANSI name as UTF-16 without terminator, returns offset or MAXULONG.
+*
+*/
+ULONG asbpAppendName(
+    _In_ PASB_BUILDER Builder,
+    _In_ LPCSTR Name,
+    _Out_ PULONG Length
+)
+{
+    WCHAR Buffer[ASB_MAX_NAME];
+    ULONG i, n = (ULONG)strlen(Name);
+
+    for (i = 0; i < n; i++)
+        Buffer[i] = (WCHAR)Name[i];
+
+    *Length = n * sizeof(WCHAR);
+    return asbpAppend(Builder, Buffer, *Length);
+}
+
+/*
+* asbpHashName
+*
+* Purpose:
+*
+* Calculate apiset name hash the same way loader does.
+*
+*/
+ULONG asbpHashName(
+    _In_ LPCSTR Name,
+    _In_ ULONG Length,
+    _In_ ULONG Multiplier
+)
+{
+    ULONG i, Hash = 0;
+
+    for (i = 0; i < Length; i++)
+        Hash = Hash * Multiplier + (ULONG)locase_a(Name[i]);
+
+    return Hash;
+}
+
+/*
+* asbpCompareHashEntries
+*
+* Purpose:
+*
+* qsort callback, order hash entries by hash.
+*
+*/
+INT asbpCompareHashEntries(
+    _In_ const VOID* First,
+    _In_ const VOID* Second
+)
+{
+    const API_SET_HASH_ENTRY_V6* a = (const API_SET_HASH_ENTRY_V6*)First;
+    const API_SET_HASH_ENTRY_V6* b = (const API_SET_HASH_ENTRY_V6*)Second;
+
+    if (a->Hash < b->Hash)
+        return -1;
+    return (a->Hash > b->Hash) ? 1 : 0;
+}
+
+/*
+* asbpBuildSchema
+*
+* Purpose:
+*
+* Generate V6 schema with Count single host entries, one entry without
+* hosts and one entry with parent specific hosts.
+*
+*/
+PVOID asbpBuildSchema(
+    _In_ ULONG Count,
+    _Out_ PULONG SchemaSize
+)
+{
+    static const LPCSTR MultiHosts[][2] = {
+        { "", "kernelbase.dll" },
+        { "kernel32.dll", "kernel32.dll" },
+        { "mod_x.dll", "modx.dll" },
+        { "ole32.dll", "combase.dll" }
+    };
+
+    ASB_BUILDER Builder;
+    API_SET_NAMESPACE_ARRAY_V6 Header;
+    PAPI_SET_NAMESPACE_ARRAY_V6 Namespace;
+    PAPI_SET_NAMESPACE_ENTRY_V6 Entry;
+    PAPI_SET_HASH_ENTRY_V6 HashEntry;
+    API_SET_VALUE_ENTRY_V6 Values[RTL_NUMBER_OF(MultiHosts)];
+    CHAR Name[ASB_MAX_NAME], Host[ASB_MAX_NAME];
+    ULONG i, j, Total, ValueCount, NameOffset, NameLength, Offset, Seed = 5;
+    LPSTR p;
+
+    *SchemaSize = 0;
+    memset(&Builder, 0, sizeof(Builder));
+
+    Total = Count + 2;
+
+    memset(&Header, 0, sizeof(Header));
+    Header.Version = API_SET_SCHEMA_VERSION_V6;
+    Header.Count = Total;
+    Header.HashMultiplier = ASB_HASH_MULTIPLIER;
+
+    if (asbpAppend(&Builder, &Header, sizeof(Header)) == MAXULONG)
+        return NULL;
+
+    Header.NamespaceEntryOffset = asbpAppend(&Builder, NULL, Total * sizeof(API_SET_NAMESPACE_ENTRY_V6));
+    Header.NamespaceHashesOffset = asbpAppend(&Builder, NULL, Total * sizeof(API_SET_HASH_ENTRY_V6));
+    if (Header.NamespaceEntryOffset == MAXULONG || Header.NamespaceHashesOffset == MAXULONG) {
+        free(Builder.Buffer);
+        return NULL;
+    }
+
+    for (i = 0; i < Total; i++) {
+
+        ValueCount = 1;
+
+        if (i < Count) {
+            Seed = Seed * 1103515245 + 12345;
+            snprintf(Name, sizeof(Name), "api-ms-win-core-bench%u-l1-%u-%u",
+                i, 1 + (Seed >> 16) % 3, (Seed >> 8) % 3);
+            snprintf(Host, sizeof(Host), "benchhost%u.dll", i % 97);
+        }
+        else if (i == Count) {
+            strcpy(Name, "ext-ms-win-bench-empty-l1-1-0");
+            ValueCount = 0;
+        }
+        else {
+            strcpy(Name, "api-ms-win-bench-multi-l1-1-0");
+            ValueCount = RTL_NUMBER_OF(MultiHosts);
+        }
+
+        NameOffset = asbpAppendName(&Builder, Name, &NameLength);
+        if (NameOffset == MAXULONG)
+            break;
+
+        memset(Values, 0, sizeof(Values));
+
+        for (j = 0; j < ValueCount; j++) {
+
+            Offset = asbpAppendName(&Builder, (i < Count) ? Host : MultiHosts[j][1], &Values[j].ValueLength);
+            if (Offset == MAXULONG)
+                break;
+            Values[j].ValueOffset = Offset;
+
+            if (i >= Count && MultiHosts[j][0][0]) {
+                Offset = asbpAppendName(&Builder, MultiHosts[j][0], &Values[j].NameLength);
+                if (Offset == MAXULONG)
+                    break;
+                Values[j].NameOffset = Offset;
+            }
+        }
+
+        if (j < ValueCount)
+            break;
+
+        Offset = asbpAppend(&Builder, Values, ValueCount * sizeof(API_SET_VALUE_ENTRY_V6));
+        if (Offset == MAXULONG)
+            break;
+
+        Entry = (PAPI_SET_NAMESPACE_ENTRY_V6)(Builder.Buffer + Header.NamespaceEntryOffset) + i;
+        Entry->Flags = API_SET_SCHEMA_ENTRY_FLAGS_SEALED;
+        Entry->NameOffset = NameOffset;
+        Entry->NameLength = NameLength;
+        Entry->DataOffset = Offset;
+        Entry->Count = ValueCount;
+
+        //
+        // Hashed part is everything before last hyphen.
+        //
+        p = strrchr(Name, '-');
+        Entry->HashNameLength = (ULONG)(p - Name) * sizeof(WCHAR);
+
+        HashEntry = (PAPI_SET_HASH_ENTRY_V6)(Builder.Buffer + Header.NamespaceHashesOffset) + i;
+        HashEntry->Hash = asbpHashName(Name, (ULONG)(p - Name), ASB_HASH_MULTIPLIER);
+        HashEntry->NamespaceIndex = i;
+    }
+
+    if (i < Total) {
+        free(Builder.Buffer);
+        return NULL;
+    }
+
+    qsort(Builder.Buffer + Header.NamespaceHashesOffset, Total,
+        sizeof(API_SET_HASH_ENTRY_V6), asbpCompareHashEntries);
+
+    Header.Size = Builder.Size;
+
+    Namespace = (PAPI_SET_NAMESPACE_ARRAY_V6)Builder.Buffer;
+    *Namespace = Header;
+
+    *SchemaSize = Builder.Size;
+    return Builder.Buffer;
+}
+
+/*
+* asbpLoadSchema
+*
+* Purpose:
+*
+* Read schema file, for PE image return copy of its .apiset section.
+*
+*/
+PVOID asbpLoadSchema(
+    _In_ LPCSTR FileName,
+    _Out_ PULONG SchemaSize
+)
+{
+    FILE* File;
+    long FileSize;
+    PBYTE Buffer, Schema = NULL;
+    ULONG Size = 0, i, Offset;
+    PIMAGE_DOS_HEADER DosHeader;
+    PIMAGE_NT_HEADERS NtHeaders;
+    PIMAGE_SECTION_HEADER Section;
+
+    *SchemaSize = 0;
+
+    File = fopen(FileName, "rb");
+    if (File == NULL)
+        return NULL;
+
+    fseek(File, 0, SEEK_END);
+    FileSize = ftell(File);
+    fseek(File, 0, SEEK_SET);
+
+    if (FileSize <= 0 || FileSize > 0x10000000) {
+        fclose(File);
+        return NULL;
+    }
+
+    Buffer = (PBYTE)malloc((SIZE_T)FileSize);
+    if (Buffer == NULL || fread(Buffer, 1, (SIZE_T)FileSize, File) != (SIZE_T)FileSize) {
+        fclose(File);
+        free(Buffer);
+        return NULL;
+    }
+
+    fclose(File);
+
+    DosHeader = (PIMAGE_DOS_HEADER)Buffer;
+
+    if ((ULONG)FileSize < sizeof(IMAGE_DOS_HEADER) || DosHeader->e_magic != IMAGE_DOS_SIGNATURE) {
+        *SchemaSize = (ULONG)FileSize;
+        return Buffer;
+    }
+
+    //
+    // Image file, locate apiset section by raw offsets.
+    //
+    do {
+
+        if (DosHeader->e_lfanew <= 0 ||
+            (ULONG)DosHeader->e_lfanew > (ULONG)FileSize - sizeof(IMAGE_NT_HEADERS))
+        {
+            break;
+        }
+
+        NtHeaders = (PIMAGE_NT_HEADERS)(Buffer + DosHeader->e_lfanew);
+        if (NtHeaders->Signature != IMAGE_NT_SIGNATURE)
+            break;
+
+        Offset = (ULONG)((PBYTE)IMAGE_FIRST_SECTION(NtHeaders) - Buffer);
+
+        for (i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++) {
+
+            if (Offset > (ULONG)FileSize - sizeof(IMAGE_SECTION_HEADER))
+                break;
+
+            Section = (PIMAGE_SECTION_HEADER)(Buffer + Offset);
+            Offset += sizeof(IMAGE_SECTION_HEADER);
+
+            if (memcmp(Section->Name, API_SET_SECTION_NAME, sizeof(API_SET_SECTION_NAME)) != 0)
+                continue;
+
+            Size = Section->SizeOfRawData;
+            if (Section->Misc.VirtualSize && Section->Misc.VirtualSize < Size)
+                Size = Section->Misc.VirtualSize;
+
+            if (Section->PointerToRawData > (ULONG)FileSize ||
+                Size > (ULONG)FileSize - Section->PointerToRawData)
+            {
+                break;
+            }
+
+            Schema = (PBYTE)malloc(Size);
+            if (Schema)
+                memcpy(Schema, Buffer + Section->PointerToRawData, Size);
+            break;
+        }
+
+    } while (FALSE);
+
+    free(Buffer);
+
+    if (Schema)
+        *SchemaSize = Size;
+
+    return Schema;
+}
+
+/*
+* asbpSetName
+*
+* Purpose:
+*
+* Convert ANSI name to counted UTF-16 string stored in Buffer.
+*
+*/
+VOID asbpSetName(
+    _In_ LPCSTR Name,
+    _In_ PWCHAR Buffer,
+    _Out_ PUNICODE_STRING String
+)
+{
+    ULONG i, n = (ULONG)strlen(Name);
+
+    if (n >= ASB_MAX_NAME)
+        n = ASB_MAX_NAME - 1;
+
+    for (i = 0; i < n; i++)
+        Buffer[i] = (WCHAR)Name[i];
+    Buffer[n] = 0;
+
+    String->Buffer = Buffer;
+    String->Length = (USHORT)(n * sizeof(WCHAR));
+    String->MaximumLength = String->Length;
+}
+
+/*
+* asbpSetSchemaName
+*
+* Purpose:
+*
+* Build query string from schema name with optional suffix.
+*
+*/
+VOID asbpSetSchemaName(
+    _In_ PVOID Namespace,
+    _In_ ULONG NameOffset,
+    _In_ ULONG NameLength,
+    _In_opt_ LPCSTR Suffix,
+    _In_ BOOL UpperCase,
+    _In_ PWCHAR Buffer,
+    _Out_ PUNICODE_STRING String
+)
+{
+    PWCHAR Name = (PWCHAR)RtlOffsetToPointer(Namespace, NameOffset);
+    ULONG i, n = NameLength / sizeof(WCHAR);
+
+    if (n >= ASB_MAX_NAME - 8)
+        n = ASB_MAX_NAME - 8;
+
+    for (i = 0; i < n; i++) {
+        Buffer[i] = Name[i];
+        if (UpperCase && Buffer[i] >= 'a' && Buffer[i] <= 'z')
+            Buffer[i] -= 0x20;
+    }
+
+    if (Suffix) {
+        while (*Suffix)
+            Buffer[n++] = (WCHAR)*Suffix++;
+    }
+
+    Buffer[n] = 0;
+
+    String->Buffer = Buffer;
+    String->Length = (USHORT)(n * sizeof(WCHAR));
+    String->MaximumLength = String->Length;
+}
+
+/*
+* asbpReferenceResolve
+*
+* Purpose:
+*
+* Resolve apiset without cache, mirrors NtLdrApiSetResolveLibrary.
+*
+*/
+NTSTATUS asbpReferenceResolve(
+    _In_ PVOID Namespace,
+    _In_ PASB_QUERY Query,
+    _Out_ PAPI_SET_VALUE_ENTRY_V6* HostEntry
+)
+{
+    NTSTATUS Status;
+    USHORT Length = 0;
+
+    *HostEntry = NULL;
+
+    Status = ApiSetpQueryEffectiveName(&Query->Name, &Length);
+    if (!NT_SUCCESS(Status))
+        return Status;
+
+    return ApiSetpResolveHost(Namespace,
+        Query->Name.Buffer,
+        Length,
+        Query->Parent.Buffer,
+        Query->Parent.Length / sizeof(WCHAR),
+        HostEntry);
+}
+
+/*
+* asbpCheckQuery
+*
+* Purpose:
+*
+* Compare cached resolve result with reference one.
+*
+*/
+VOID asbpCheckQuery(
+    _In_ PVOID Namespace,
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PASB_QUERY Query,
+    _In_ LPCSTR Mode,
+    _Inout_ PASB_STATS Stats
+)
+{
+    NTSTATUS Status, RefStatus;
+    PAPI_SET_VALUE_ENTRY_V6 RefHost;
+    UNICODE_STRING Host;
+    BOOL Resolved = FALSE, Match;
+    ULONG i;
+
+    memset(&Host, 0, sizeof(Host));
+
+    RefStatus = asbpReferenceResolve(Namespace, Query, &RefHost);
+
+    Status = NtLdrApiSetCacheResolve(Cache,
+        &Query->Name,
+        Query->Parent.Buffer ? &Query->Parent : NULL,
+        &Resolved,
+        &Host);
+
+    if (NT_SUCCESS(RefStatus)) {
+        Match = (Status == STATUS_SUCCESS) &&
+            Resolved &&
+            Host.Buffer == (PWSTR)RtlOffsetToPointer(Namespace, RefHost->ValueOffset) &&
+            Host.Length == RefHost->ValueLength;
+    }
+    else {
+        Match = !NT_SUCCESS(Status) && !Resolved;
+    }
+
+    Stats->Total += 1;
+
+    if (!Match) {
+        Stats->Mismatches += 1;
+        printf("%s mismatch: ", Mode);
+        for (i = 0; i < Query->Name.Length / sizeof(WCHAR); i++)
+            putchar((INT)Query->Name.Buffer[i]);
+        printf(" status 0x%08X, expected 0x%08X\n", (ULONG)Status, (ULONG)RefStatus);
+    }
+}
+
+/*
+* asbpCheckSchema
+*
+* Purpose:
+*
+* Resolve every schema entry with its aliases and few invalid names.
+*
+*/
+VOID asbpCheckSchema(
+    _In_ PVOID Namespace,
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PASB_QUERY Query,
+    _In_ LPCSTR Mode,
+    _Inout_ PASB_STATS Stats
+)
+{
+    static const LPCSTR InvalidNames[] = {
+        "api-ms-win-core-missing-l1-1-0.dll",
+        "ext-ms-win-core-missing-l1-1-0.dll",
+        "abc-ms-win-core-file-l1-1-0.dll",
+        "api",
+        "api-"
+    };
+
+    PAPI_SET_NAMESPACE_ARRAY_V6 Schema = (PAPI_SET_NAMESPACE_ARRAY_V6)Namespace;
+    PAPI_SET_NAMESPACE_ENTRY_V6 Entry;
+    PAPI_SET_VALUE_ENTRY_V6 Value;
+    ULONG i, j;
+
+    for (i = 0; i < Schema->Count; i++) {
+
+        Entry = (PAPI_SET_NAMESPACE_ENTRY_V6)RtlOffsetToPointer(Namespace,
+            Schema->NamespaceEntryOffset + i * sizeof(API_SET_NAMESPACE_ENTRY_V6));
+
+        memset(&Query->Parent, 0, sizeof(UNICODE_STRING));
+
+        asbpSetSchemaName(Namespace, Entry->NameOffset, Entry->NameLength,
+            ".dll", FALSE, Query->NameBuffer, &Query->Name);
+        asbpCheckQuery(Namespace, Cache, Query, Mode, Stats);
+
+        asbpSetSchemaName(Namespace, Entry->NameOffset, Entry->NameLength,
+            NULL, TRUE, Query->NameBuffer, &Query->Name);
+        asbpCheckQuery(Namespace, Cache, Query, Mode, Stats);
+
+        asbpSetSchemaName(Namespace, Entry->NameOffset, Entry->NameLength,
+            ".dll", FALSE, Query->NameBuffer, &Query->Name);
+
+        for (j = 0; j < Entry->Count; j++) {
+
+            Value = API_SET_TO_VALUE_ENTRY(Namespace, Entry, j);
+            if (Value->NameLength == 0)
+                continue;
+
+            asbpSetSchemaName(Namespace, Value->NameOffset, Value->NameLength,
+                NULL, (j & 1), Query->ParentBuffer, &Query->Parent);
+            asbpCheckQuery(Namespace, Cache, Query, Mode, Stats);
+        }
+
+        if (Entry->Count > 1) {
+            asbpSetName("unknown.dll", Query->ParentBuffer, &Query->Parent);
+            asbpCheckQuery(Namespace, Cache, Query, Mode, Stats);
+        }
+    }
+
+    memset(&Query->Parent, 0, sizeof(UNICODE_STRING));
+
+    for (i = 0; i < RTL_NUMBER_OF(InvalidNames); i++) {
+        asbpSetName(InvalidNames[i], Query->NameBuffer, &Query->Name);
+        asbpCheckQuery(Namespace, Cache, Query, Mode, Stats);
+    }
+}
+
+/*
+* asbpBenchmark
+*
+* Purpose:
+*
+* Time uncached and cached resolve of the same names.
+*
+*/
+VOID asbpBenchmark(
+    _In_ PVOID Namespace,
+    _In_ PNTLDR_APISET_CACHE Cache,
+    _In_ PASB_QUERY Queries,
+    _In_ ULONG QueryCount,
+    _In_ ULONG Iterations
+)
+{
+    ULONG i;
+    double Start, Uncached, Cached;
+    PASB_QUERY Query;
+    PAPI_SET_VALUE_ENTRY_V6 HostEntry;
+    UNICODE_STRING Host;
+    BOOL Resolved;
+    volatile ULONG Sink = 0;
+
+    Start = asbpSecondsNow();
+    for (i = 0; i < Iterations; i++) {
+        Query = &Queries[i % QueryCount];
+        if (NT_SUCCESS(asbpReferenceResolve(Namespace, Query, &HostEntry)))
+            Sink += HostEntry->ValueLength;
+    }
+    Uncached = asbpSecondsNow() - Start;
+
+    Start = asbpSecondsNow();
+    for (i = 0; i < Iterations; i++) {
+        Query = &Queries[i % QueryCount];
+        if (NT_SUCCESS(NtLdrApiSetCacheResolve(Cache, &Query->Name, NULL, &Resolved, &Host)))
+            Sink += Host.Length;
+    }
+    Cached = asbpSecondsNow() - Start;
+
+    printf("%u lookups over %u names: uncached %.3fs (%.1f ns), cached %.3fs (%.1f ns)\n",
+        Iterations,
+        QueryCount,
+        Uncached, Uncached * 1e9 / Iterations,
+        Cached, Cached * 1e9 / Iterations);
+}
+
+/*
+* asbpUsage
+*
+* Purpose:
+*
+* Print command line help.
+*
+*/
+VOID asbpUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: apisetbench [-n iterations] [schema]\n"
+        "  -n  number of timed lookups, default is %u\n"
+        "  schema is raw apiset namespace or apisetschema.dll, synthetic if omitted\n",
+        ASB_DEFAULT_ITERATIONS);
+}
+
+INT main(
+    INT argc,
+    CHAR** argv
+)
+{
+    INT opt, ExitCode = 1;
+    ULONG SchemaSize = 0, Iterations = ASB_DEFAULT_ITERATIONS, i, QueryCount;
+    PVOID Schema = NULL;
+    PSCM_HEAP Heap = NULL;
+    PNTLDR_APISET_CACHE Cache;
+    PAPI_SET_NAMESPACE_ARRAY_V6 Namespace;
+    PAPI_SET_NAMESPACE_ENTRY_V6 Entry;
+    PASB_QUERY Queries = NULL;
+    ASB_QUERY Query;
+    ASB_STATS Stats;
+    BOOL Flatten;
+    ULONG Pass;
+    LPCSTR Mode;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            Iterations = (ULONG)atoi(optarg);
+            break;
+        default:
+            asbpUsage();
+            return 1;
+        }
+    }
+
+    if (Iterations == 0)
+        Iterations = 1;
+
+    do {
+
+        if (optind < argc) {
+            Schema = asbpLoadSchema(argv[optind], &SchemaSize);
+            if (Schema == NULL) {
+                fprintf(stderr, "apisetbench: cannot read schema from %s\n", argv[optind]);
+                break;
+            }
+        }
+        else {
+            Schema = asbpBuildSchema(ASB_SYNTHETIC_COUNT, &SchemaSize);
+            if (Schema == NULL) {
+                fprintf(stderr, "apisetbench: not enough memory\n");
+                break;
+            }
+        }
+
+        Heap = scmHeapCreate();
+        if (Heap == NULL) {
+            fprintf(stderr, "apisetbench: not enough memory\n");
+            break;
+        }
+
+        memset(&Stats, 0, sizeof(Stats));
+
+        for (Flatten = FALSE; Flatten <= TRUE; Flatten++) {
+
+            Cache = NtLdrApiSetCacheCreate(Heap, Schema, SchemaSize, Flatten);
+            if (Cache == NULL) {
+                Stats.Mismatches += 1;
+                break;
+            }
+
+            for (Pass = 0; Pass < 2; Pass++) {
+                Mode = (Flatten) ? "flattened" : (Pass) ? "lazy cached" : "lazy";
+                asbpCheckSchema(Schema, Cache, &Query, Mode, &Stats);
+            }
+
+            NtLdrApiSetCacheDestroy(Cache);
+        }
+
+        if (Flatten <= TRUE) {
+            fprintf(stderr, "apisetbench: schema rejected\n");
+            break;
+        }
+
+        Namespace = (PAPI_SET_NAMESPACE_ARRAY_V6)Schema;
+        printf("%u apiset entries, %u bytes, %u queries, %u mismatches\n",
+            Namespace->Count, SchemaSize, Stats.Total, Stats.Mismatches);
+
+        //
+        // Schema claiming more than available must be refused.
+        //
+        Namespace->Size = SchemaSize + sizeof(API_SET_NAMESPACE_ARRAY_V6);
+        Cache = NtLdrApiSetCacheCreate(Heap, Schema, SchemaSize, TRUE);
+        Namespace->Size = SchemaSize;
+
+        if (Cache) {
+            fprintf(stderr, "apisetbench: oversize schema accepted\n");
+            break;
+        }
+
+        if (Stats.Mismatches)
+            break;
+
+        //
+        // Benchmark lookups of all entry names without parent.
+        //
+        QueryCount = Namespace->Count;
+        Queries = (PASB_QUERY)calloc(QueryCount, sizeof(ASB_QUERY));
+        if (Queries == NULL) {
+            fprintf(stderr, "apisetbench: not enough memory\n");
+            break;
+        }
+
+        for (i = 0; i < QueryCount; i++) {
+            Entry = (PAPI_SET_NAMESPACE_ENTRY_V6)RtlOffsetToPointer(Schema,
+                Namespace->NamespaceEntryOffset + i * sizeof(API_SET_NAMESPACE_ENTRY_V6));
+            asbpSetSchemaName(Schema, Entry->NameOffset, Entry->NameLength,
+                ".dll", FALSE, Queries[i].NameBuffer, &Queries[i].Name);
+        }
+
+        Cache = NtLdrApiSetCacheCreate(Heap, Schema, SchemaSize, FALSE);
+        if (Cache == NULL)
+            break;
+
+        asbpBenchmark(Schema, Cache, Queries, QueryCount, Iterations);
+        NtLdrApiSetCacheDestroy(Cache);
+
+        ExitCode = 0;
+
+    } while (FALSE);
+
+    free(Queries);
+    if (Heap)
+        scmHeapDestroy(Heap);
+    free(Schema);
+
+    return ExitCode;
+}
@@ -0,0 +1,321 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       IMAGE.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Image file loader.
+*
+*  Files are mapped read only and their sections are copied to image layout,
+*  so raw PE helpers can work with RVAs the same way as with loaded module.
+*  Everything raw helpers touch is validated here against image bounds.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+* scmpRangeValid
+*
+* Purpose:
+*
+* Check that Count elements of given size at Offset are inside Limit.
+*
+*/
+__forceinline BOOL scmpRangeValid(
+    _In_ ULONG64 Offset,
+    _In_ ULONG64 Count,
+    _In_ ULONG64 ElementSize,
+    _In_ ULONG64 Limit
+)
+{
+    return (Offset <= Limit) && (Count * ElementSize <= Limit - Offset);
+}
+
+/*
+* scmpMapSections
+*
+* Purpose:
+*
+* Copy headers and sections from file view to image layout.
+*
+*/
+LPCSTR scmpMapSections(
+    _In_ PBYTE FileView,
+    _In_ SIZE_T FileSize,
+    _Out_ PSCM_IMAGE Image
+)
+{
+    ULONG i, SizeOfImage, SizeOfHeaders;
+    ULONG64 CopySize, HeadersSize;
+    PIMAGE_DOS_HEADER DosHeader = (PIMAGE_DOS_HEADER)FileView;
+    PIMAGE_NT_HEADERS NtHeaders;
+    PIMAGE_SECTION_HEADER Section;
+
+    if (FileSize < sizeof(IMAGE_DOS_HEADER) || DosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+        return "not a PE image";
+
+    if (DosHeader->e_lfanew < 0 ||
+        !scmpRangeValid((ULONG64)DosHeader->e_lfanew, 1, sizeof(IMAGE_NT_HEADERS), FileSize))
+    {
+        return "invalid NT headers offset";
+    }
+
+    NtHeaders = (PIMAGE_NT_HEADERS)(FileView + DosHeader->e_lfanew);
+    if (NtHeaders->Signature != IMAGE_NT_SIGNATURE)
+        return "not a PE image";
+
+    if (NtHeaders->FileHeader.Machine != IMAGE_FILE_MACHINE_AMD64 ||
+        NtHeaders->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+    {
+        return "not an x64 image";
+    }
+
+    SizeOfImage = NtHeaders->OptionalHeader.SizeOfImage;
+    SizeOfHeaders = NtHeaders->OptionalHeader.SizeOfHeaders;
+
+    if (SizeOfImage == 0 || SizeOfImage > SCM_MAX_IMAGE_SIZE)
+        return "invalid image size";
+
+    if (SizeOfHeaders > SizeOfImage)
+        return "invalid headers size";
+
+    HeadersSize = (SizeOfHeaders < FileSize) ? SizeOfHeaders : FileSize;
+
+    if (!scmpRangeValid((ULONG64)DosHeader->e_lfanew, 1, sizeof(IMAGE_NT_HEADERS), HeadersSize))
+        return "invalid NT headers offset";
+
+    Section = IMAGE_FIRST_SECTION(NtHeaders);
+
+    if (!scmpRangeValid((ULONG64)((PBYTE)Section - FileView),
+        NtHeaders->FileHeader.NumberOfSections,
+        sizeof(IMAGE_SECTION_HEADER),
+        HeadersSize))
+    {
+        return "invalid section table";
+    }
+
+    //
+    // Extra zero byte terminates any string running up to image end.
+    //
+    Image->Base = (PBYTE)calloc(1, (SIZE_T)SizeOfImage + 1);
+    if (Image->Base == NULL)
+        return "not enough memory";
+
+    Image->SizeOfImage = SizeOfImage;
+
+    RtlCopyMemory(Image->Base, FileView, (SIZE_T)HeadersSize);
+
+    for (i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++, Section++) {
+
+        CopySize = Section->SizeOfRawData;
+        if (Section->Misc.VirtualSize && Section->Misc.VirtualSize < CopySize)
+            CopySize = Section->Misc.VirtualSize;
+
+        if (Section->PointerToRawData >= FileSize || Section->VirtualAddress >= SizeOfImage)
+            continue;
+
+        if (CopySize > FileSize - Section->PointerToRawData)
+            CopySize = FileSize - Section->PointerToRawData;
+
+        if (CopySize > SizeOfImage - Section->VirtualAddress)
+            CopySize = SizeOfImage - Section->VirtualAddress;
+
+        RtlCopyMemory(Image->Base + Section->VirtualAddress,
+            FileView + Section->PointerToRawData,
+            (SIZE_T)CopySize);
+    }
+
+    return NULL;
+}
+
+/*
+* scmpValidateExports
+*
+* Purpose:
+*
+* Check export directory and its tables, detect service table type.
+*
+*/
+LPCSTR scmpValidateExports(
+    _In_ PSCM_IMAGE Image
+)
+{
+    ULONG i;
+    PDWORD NameTable;
+    PIMAGE_NT_HEADERS NtHeaders = RtlImageNtHeader(Image->Base);
+    PIMAGE_DATA_DIRECTORY Directory;
+    PIMAGE_EXPORT_DIRECTORY ExportDirectory;
+    LPCSTR ModuleName;
+
+    if (NtHeaders->OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_EXPORT)
+        return "no export directory";
+
+    Directory = &NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+
+    if (Directory->VirtualAddress == 0 ||
+        !scmpRangeValid(Directory->VirtualAddress, 1, sizeof(IMAGE_EXPORT_DIRECTORY), Image->SizeOfImage))
+    {
+        return "no export directory";
+    }
+
+    ExportDirectory = (PIMAGE_EXPORT_DIRECTORY)(Image->Base + Directory->VirtualAddress);
+
+    if (ExportDirectory->NumberOfFunctions > SCM_MAX_EXPORTS ||
+        ExportDirectory->NumberOfNames > ExportDirectory->NumberOfFunctions ||
+        ExportDirectory->Name >= Image->SizeOfImage ||
+        !scmpRangeValid(ExportDirectory->AddressOfFunctions, ExportDirectory->NumberOfFunctions, sizeof(DWORD), Image->SizeOfImage) ||
+        !scmpRangeValid(ExportDirectory->AddressOfNames, ExportDirectory->NumberOfNames, sizeof(DWORD), Image->SizeOfImage) ||
+        !scmpRangeValid(ExportDirectory->AddressOfNameOrdinals, ExportDirectory->NumberOfNames, sizeof(WORD), Image->SizeOfImage))
+    {
+        return "invalid export directory";
+    }
+
+    NameTable = (PDWORD)(Image->Base + ExportDirectory->AddressOfNames);
+    for (i = 0; i < ExportDirectory->NumberOfNames; i++) {
+        if (NameTable[i] >= Image->SizeOfImage)
+            return "invalid export name";
+    }
+
+    ModuleName = (LPCSTR)(Image->Base + ExportDirectory->Name);
+
+    if (_strcmpi_a(ModuleName, "ntdll.dll") == 0)
+        Image->TableType = ScmTableNt;
+    else if (_strcmpi_a(ModuleName, "win32u.dll") == 0)
+        Image->TableType = ScmTableWin32k;
+    else
+        return "not ntdll or win32u";
+
+    return NULL;
+}
+
+/*
+* scmpQueryVersion
+*
+* Purpose:
+*
+* Find VS_FIXEDFILEINFO in resource directory and remember file version.
+*
+*/
+VOID scmpQueryVersion(
+    _In_ PSCM_IMAGE Image
+)
+{
+    ULONG Offset, Limit;
+    PDWORD Data;
+    PIMAGE_NT_HEADERS NtHeaders = RtlImageNtHeader(Image->Base);
+    PIMAGE_DATA_DIRECTORY Directory;
+
+    if (NtHeaders->OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_RESOURCE)
+        return;
+
+    Directory = &NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE];
+    if (Directory->VirtualAddress == 0 || Directory->VirtualAddress >= Image->SizeOfImage)
+        return;
+
+    Limit = Image->SizeOfImage - Directory->VirtualAddress;
+    if (Directory->Size < Limit)
+        Limit = Directory->Size;
+
+    //
+    // Signature is DWORD aligned, followed by structure version and file version.
+    //
+    for (Offset = 0; Offset + 4 * sizeof(DWORD) <= Limit; Offset += sizeof(DWORD)) {
+
+        Data = (PDWORD)(Image->Base + Directory->VirtualAddress + Offset);
+        if (Data[0] == SCM_VERSION_SIGNATURE) {
+            Image->FileVersionMS = Data[2];
+            Image->FileVersionLS = Data[3];
+            Image->HasVersion = TRUE;
+            break;
+        }
+    }
+}
+
+/*
+* scmImageLoad
+*
+* Purpose:
+*
+* Load ntdll or win32u image file to memory in image layout.
+*
+*/
+BOOL scmImageLoad(
+    _In_ LPCSTR FileName,
+    _Out_ PSCM_IMAGE Image,
+    _Out_ LPCSTR* ErrorText
+)
+{
+    INT fd;
+    PVOID FileView;
+    struct stat st;
+    LPCSTR Error;
+
+    memset(Image, 0, sizeof(SCM_IMAGE));
+
+    fd = open(FileName, O_RDONLY);
+    if (fd < 0) {
+        *ErrorText = "cannot open file";
+        return FALSE;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        *ErrorText = "cannot query file size";
+        return FALSE;
+    }
+
+    FileView = mmap(NULL, (SIZE_T)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (FileView == MAP_FAILED) {
+        *ErrorText = "cannot map file";
+        return FALSE;
+    }
+
+    Error = scmpMapSections((PBYTE)FileView, (SIZE_T)st.st_size, Image);
+
+    munmap(FileView, (SIZE_T)st.st_size);
+
+    if (Error == NULL)
+        Error = scmpValidateExports(Image);
+
+    if (Error) {
+        scmImageFree(Image);
+        *ErrorText = Error;
+        return FALSE;
+    }
+
+    scmpQueryVersion(Image);
+
+    *ErrorText = NULL;
+    return TRUE;
+}
+
+/*
+* scmImageFree
+*
+* Purpose:
+*
+* Release loaded image.
+*
+*/
+VOID scmImageFree(
+    _In_ PSCM_IMAGE Image
+)
+{
+    free(Image->Base);
+    Image->Base = NULL;
+}
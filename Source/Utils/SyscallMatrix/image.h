@@ -0,0 +1,54 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       IMAGE.H
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the image file loader.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Upper limits for images accepted by loader.
+//
+#define SCM_MAX_IMAGE_SIZE      0x10000000
+#define SCM_MAX_EXPORTS         0x10000
+
+//
+// VS_FIXEDFILEINFO signature.
+//
+#define SCM_VERSION_SIGNATURE   0xFEEF04BD
+
+typedef enum _SCM_TABLE_TYPE {
+    ScmTableUnknown = 0,
+    ScmTableNt,         //ntdll.dll, KiServiceTable
+    ScmTableWin32k,     //win32u.dll, W32pServiceTable
+    ScmTableMax
+} SCM_TABLE_TYPE;
+
+typedef struct _SCM_IMAGE {
+    PBYTE Base;             //image layout, SizeOfImage plus zero terminator
+    ULONG SizeOfImage;
+    SCM_TABLE_TYPE TableType;
+    BOOL HasVersion;
+    ULONG FileVersionMS;
+    ULONG FileVersionLS;
+} SCM_IMAGE, *PSCM_IMAGE;
+
+BOOL scmImageLoad(
+    _In_ LPCSTR FileName,
+    _Out_ PSCM_IMAGE Image,
+    _Out_ LPCSTR* ErrorText);
+
+VOID scmImageFree(
+    _In_ PSCM_IMAGE Image);
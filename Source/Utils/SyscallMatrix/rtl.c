@@ -0,0 +1,147 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       RTL.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Rtl replacement routines used by shared raw PE helpers.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+/*
+* scmHeapCreate
+*
+* Purpose:
+*
+* Create empty chunk heap.
+*
+*/
+PSCM_HEAP scmHeapCreate(
+    VOID
+)
+{
+    return (PSCM_HEAP)calloc(1, sizeof(SCM_HEAP));
+}
+
+/*
+* scmHeapDestroy
+*
+* Purpose:
+*
+* Release heap with all allocations.
+*
+*/
+VOID scmHeapDestroy(
+    _In_ PSCM_HEAP Heap
+)
+{
+    PSCM_HEAP_CHUNK Chunk, Next;
+
+    for (Chunk = Heap->Head; Chunk != NULL; Chunk = Next) {
+        Next = Chunk->Next;
+        free(Chunk);
+    }
+
+    free(Heap);
+}
+
+/*
+* RtlAllocateHeap
+*
+* Purpose:
+*
+* Allocate memory from chunk heap, memory is always zeroed.
+*
+*/
+PVOID RtlAllocateHeap(
+    _In_ PVOID HeapHandle,
+    _In_ ULONG Flags,
+    _In_ SIZE_T Size
+)
+{
+    PSCM_HEAP Heap = (PSCM_HEAP)HeapHandle;
+    PSCM_HEAP_CHUNK Chunk = Heap->Head;
+    SIZE_T ChunkSize;
+    PBYTE Buffer;
+
+    (void)Flags;
+
+    Size = (Size + 15) & ~(SIZE_T)15;
+
+    if (Chunk == NULL || Chunk->Size - Chunk->Used < Size) {
+
+        ChunkSize = sizeof(SCM_HEAP_CHUNK) + Size;
+        if (ChunkSize < SCM_HEAP_CHUNK_SIZE)
+            ChunkSize = SCM_HEAP_CHUNK_SIZE;
+
+        Chunk = (PSCM_HEAP_CHUNK)malloc(ChunkSize);
+        if (Chunk == NULL)
+            return NULL;
+
+        Chunk->Size = ChunkSize - sizeof(SCM_HEAP_CHUNK);
+        Chunk->Used = 0;
+        Chunk->Next = Heap->Head;
+        Heap->Head = Chunk;
+    }
+
+    Buffer = (PBYTE)(Chunk + 1) + Chunk->Used;
+    Chunk->Used += Size;
+
+    memset(Buffer, 0, Size);
+    return Buffer;
+}
+
+/*
+* RtlFreeHeap
+*
+* Purpose:
+*
+* Memory is released with heap, nothing to do here.
+*
+*/
+BOOLEAN RtlFreeHeap(
+    _In_ PVOID HeapHandle,
+    _In_ ULONG Flags,
+    _In_ PVOID BaseAddress
+)
+{
+    (void)HeapHandle;
+    (void)Flags;
+    (void)BaseAddress;
+    return TRUE;
+}
+
+/*
+* RtlImageNtHeader
+*
+* Purpose:
+*
+* Return NT headers of mapped image, image headers are validated on load.
+*
+*/
+PIMAGE_NT_HEADERS RtlImageNtHeader(
+    _In_ PVOID Base
+)
+{
+    PIMAGE_DOS_HEADER DosHeader = (PIMAGE_DOS_HEADER)Base;
+    PIMAGE_NT_HEADERS NtHeaders;
+
+    if (DosHeader == NULL || DosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+        return NULL;
+
+    NtHeaders = (PIMAGE_NT_HEADERS)RtlOffsetToPointer(Base, DosHeader->e_lfanew);
+    if (NtHeaders->Signature != IMAGE_NT_SIGNATURE)
+        return NULL;
+
+    return NtHeaders;
+}
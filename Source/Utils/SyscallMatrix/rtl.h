@@ -0,0 +1,41 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       RTL.H
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the Rtl replacement routines.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Heap handle used with RtlAllocateHeap is a chunk arena, memory is released
+// only when heap destroyed.
+//
+#define SCM_HEAP_CHUNK_SIZE     0x40000
+
+typedef struct _SCM_HEAP_CHUNK {
+    struct _SCM_HEAP_CHUNK* Next;
+    SIZE_T Size;
+    SIZE_T Used;
+} SCM_HEAP_CHUNK, *PSCM_HEAP_CHUNK;
+
+typedef struct _SCM_HEAP {
+    PSCM_HEAP_CHUNK Head;
+} SCM_HEAP, *PSCM_HEAP;
+
+PSCM_HEAP scmHeapCreate(
+    VOID);
+
+VOID scmHeapDestroy(
+    _In_ PSCM_HEAP Heap);
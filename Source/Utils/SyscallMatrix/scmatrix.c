@@ -0,0 +1,853 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       SCMATRIX.C
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Offline syscall table extractor.
+*
+*  Walks directories for ntdll.dll and win32u.dll images of any x64 build,
+*  decodes their syscall stubs with shared raw PE helpers on all cores and
+*  writes merged build by syscall matrix as CSV.
+*
+*  scmatrix [-j threads] [-r] [-v] [-o file.csv] directory [directory...]
+*
+*  Columns are keyed by file version major.minor.build, with -r revision is
+*  included too. Files without version resource use their file name.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+LPCSTR g_ScmTableNames[ScmTableMax] = {
+    "Unknown",
+    "KiServiceTable",
+    "W32pServiceTable"
+};
+
+/*
+* scmpBaseName
+*
+* Purpose:
+*
+* Return file name part of path.
+*
+*/
+LPCSTR scmpBaseName(
+    _In_ LPCSTR Path
+)
+{
+    LPCSTR p = strrchr(Path, '/');
+    return (p) ? p + 1 : Path;
+}
+
+/*
+* scmpAddFile
+*
+* Purpose:
+*
+* Append file to input list.
+*
+*/
+BOOL scmpAddFile(
+    _In_ PSCM_CONTEXT Context,
+    _In_ LPCSTR FileName
+)
+{
+    ULONG NewCapacity;
+    PSCM_FILE Files;
+
+    if (Context->FileCount == Context->FileCapacity) {
+
+        NewCapacity = (Context->FileCapacity) ? Context->FileCapacity * 2 : 256;
+
+        Files = (PSCM_FILE)realloc(Context->Files, NewCapacity * sizeof(SCM_FILE));
+        if (Files == NULL)
+            return FALSE;
+
+        Context->Files = Files;
+        Context->FileCapacity = NewCapacity;
+    }
+
+    Files = &Context->Files[Context->FileCount];
+    memset(Files, 0, sizeof(SCM_FILE));
+
+    Files->FileName = strdup(FileName);
+    if (Files->FileName == NULL)
+        return FALSE;
+
+    Context->FileCount += 1;
+    return TRUE;
+}
+
+/*
+* scmpScanDirectory
+*
+* Purpose:
+*
+* Collect regular files from directory tree, directory links are not followed.
+*
+*/
+BOOL scmpScanDirectory(
+    _In_ PSCM_CONTEXT Context,
+    _In_ LPCSTR Path
+)
+{
+    BOOL bResult = TRUE;
+    DIR* Directory;
+    struct dirent* Entry;
+    struct stat st;
+    SIZE_T Length;
+    LPSTR lpPath;
+
+    Directory = opendir(Path);
+    if (Directory == NULL) {
+        fprintf(stderr, "scmatrix: cannot open directory %s\n", Path);
+        return TRUE;
+    }
+
+    while (bResult && (Entry = readdir(Directory)) != NULL) {
+
+        if (strcmp(Entry->d_name, ".") == 0 || strcmp(Entry->d_name, "..") == 0)
+            continue;
+
+        Length = strlen(Path) + strlen(Entry->d_name) + 2;
+        lpPath = (LPSTR)malloc(Length);
+        if (lpPath == NULL) {
+            bResult = FALSE;
+            break;
+        }
+
+        snprintf(lpPath, Length, "%s/%s", Path, Entry->d_name);
+
+        if (lstat(lpPath, &st) == 0) {
+
+            if (S_ISDIR(st.st_mode))
+                bResult = scmpScanDirectory(Context, lpPath);
+            else if (S_ISREG(st.st_mode) ||
+                (S_ISLNK(st.st_mode) && stat(lpPath, &st) == 0 && S_ISREG(st.st_mode)))
+            {
+                bResult = scmpAddFile(Context, lpPath);
+            }
+        }
+
+        free(lpPath);
+    }
+
+    closedir(Directory);
+    return bResult;
+}
+
+/*
+* scmpProcessFile
+*
+* Purpose:
+*
+* Load image, decode syscall stubs and keep named services.
+*
+* ntdll Zw aliases are stored with Nt prefix, they are merged with Nt exports.
+*
+*/
+VOID scmpProcessFile(
+    _In_ PSCM_FILE File
+)
+{
+    ULONG Count, i;
+    SIZE_T PoolSize, Length;
+    LPSTR NamePool;
+    PSCM_HEAP Heap;
+    PWIN32_SHADOWTABLE Table = NULL, Entry;
+    SCM_IMAGE Image;
+
+    if (!scmImageLoad(File->FileName, &Image, &File->Error))
+        return;
+
+    File->TableType = Image.TableType;
+    File->HasVersion = Image.HasVersion;
+    File->FileVersionMS = Image.FileVersionMS;
+    File->FileVersionLS = Image.FileVersionLS;
+
+    Heap = scmHeapCreate();
+    if (Heap == NULL) {
+        File->Error = "not enough memory";
+        scmImageFree(&Image);
+        return;
+    }
+
+    Count = NtRawEnumW32kExports(Heap, Image.Base, &Table);
+    if (Count == 0) {
+        File->Error = "no syscall stubs found";
+    }
+    else {
+
+        PoolSize = 0;
+        for (Entry = Table, i = 0; Entry != NULL && i < Count; Entry = Entry->NextService, i++)
+            PoolSize += strlen(Entry->Name) + 1;
+
+        File->Services = (PSCM_SERVICE)malloc(Count * sizeof(SCM_SERVICE));
+        File->NamePool = (LPSTR)malloc(PoolSize);
+
+        if (File->Services == NULL || File->NamePool == NULL) {
+            File->Error = "not enough memory";
+        }
+        else {
+
+            NamePool = File->NamePool;
+
+            for (Entry = Table, i = 0; Entry != NULL && i < Count; Entry = Entry->NextService, i++) {
+
+                Length = strlen(Entry->Name);
+                if (Length == 0)
+                    continue;
+
+                RtlCopyMemory(NamePool, Entry->Name, Length + 1);
+
+                if (File->TableType == ScmTableNt && NamePool[0] == 'Z' && NamePool[1] == 'w') {
+                    NamePool[0] = 'N';
+                    NamePool[1] = 't';
+                }
+
+                File->Services[File->ServiceCount].Name = NamePool;
+                File->Services[File->ServiceCount].Index = Entry->Index;
+                File->ServiceCount += 1;
+
+                NamePool += Length + 1;
+            }
+        }
+    }
+
+    scmHeapDestroy(Heap);
+    scmImageFree(&Image);
+}
+
+/*
+* scmpWorker
+*
+* Purpose:
+*
+* Worker thread, takes next unprocessed file until list is exhausted.
+*
+*/
+PVOID scmpWorker(
+    _In_ PVOID Parameter
+)
+{
+    PSCM_CONTEXT Context = (PSCM_CONTEXT)Parameter;
+    ULONG i;
+
+    for (;;) {
+
+        i = __atomic_fetch_add(&Context->NextFile, 1, __ATOMIC_RELAXED);
+        if (i >= Context->FileCount)
+            break;
+
+        scmpProcessFile(&Context->Files[i]);
+    }
+
+    return NULL;
+}
+
+/*
+* scmpRunWorkers
+*
+* Purpose:
+*
+* Process all input files on given number of threads.
+*
+*/
+VOID scmpRunWorkers(
+    _In_ PSCM_CONTEXT Context,
+    _In_ ULONG ThreadCount
+)
+{
+    ULONG i, Started = 0;
+    pthread_t Threads[SCM_MAX_THREADS];
+
+    if (ThreadCount > Context->FileCount)
+        ThreadCount = Context->FileCount;
+
+    for (i = 1; i < ThreadCount; i++) {
+        if (pthread_create(&Threads[Started], NULL, scmpWorker, Context) != 0)
+            break;
+        Started += 1;
+    }
+
+    //
+    // Calling thread works too, list is finished even if no thread was started.
+    //
+    scmpWorker(Context);
+
+    for (i = 0; i < Started; i++)
+        pthread_join(Threads[i], NULL);
+}
+
+/*
+* scmpCompareFiles
+*
+* Purpose:
+*
+* Order files by version, files without version go last ordered by name.
+*
+*/
+INT scmpCompareFiles(
+    _In_ const void* First,
+    _In_ const void* Second
+)
+{
+    PSCM_FILE File1 = (PSCM_FILE)First, File2 = (PSCM_FILE)Second;
+    INT Result;
+
+    if (File1->HasVersion != File2->HasVersion)
+        return (File1->HasVersion) ? -1 : 1;
+
+    if (File1->HasVersion) {
+        if (File1->FileVersionMS != File2->FileVersionMS)
+            return (File1->FileVersionMS < File2->FileVersionMS) ? -1 : 1;
+        if (File1->FileVersionLS != File2->FileVersionLS)
+            return (File1->FileVersionLS < File2->FileVersionLS) ? -1 : 1;
+    }
+    else {
+        Result = strcmp(scmpBaseName(File1->FileName), scmpBaseName(File2->FileName));
+        if (Result)
+            return Result;
+    }
+
+    return strcmp(File1->FileName, File2->FileName);
+}
+
+/*
+* scmpSameColumn
+*
+* Purpose:
+*
+* Check whatever two sorted files belong to the same build column.
+*
+*/
+BOOL scmpSameColumn(
+    _In_ PSCM_CONTEXT Context,
+    _In_ PSCM_FILE File1,
+    _In_ PSCM_FILE File2
+)
+{
+    ULONG Mask = (Context->KeyByRevision) ? 0xFFFFFFFF : 0xFFFF0000;
+
+    if (File1->HasVersion != File2->HasVersion)
+        return FALSE;
+
+    if (File1->HasVersion)
+        return (File1->FileVersionMS == File2->FileVersionMS) &&
+        ((File1->FileVersionLS & Mask) == (File2->FileVersionLS & Mask));
+
+    return strcmp(scmpBaseName(File1->FileName), scmpBaseName(File2->FileName)) == 0;
+}
+
+/*
+* scmpAssignColumns
+*
+* Purpose:
+*
+* Give every parsed file its build column, files must be sorted.
+*
+*/
+BOOL scmpAssignColumns(
+    _In_ PSCM_CONTEXT Context
+)
+{
+    ULONG i;
+    CHAR szLabel[64];
+    PSCM_FILE File, Previous = NULL;
+
+    Context->Columns = (LPSTR*)calloc(Context->FileCount + 1, sizeof(LPSTR));
+    if (Context->Columns == NULL)
+        return FALSE;
+
+    for (i = 0; i < Context->FileCount; i++) {
+
+        File = &Context->Files[i];
+        if (File->Error)
+            continue;
+
+        if (Previous && scmpSameColumn(Context, Previous, File)) {
+            File->Column = Previous->Column;
+            continue;
+        }
+
+        if (File->HasVersion) {
+            if (Context->KeyByRevision) {
+                snprintf(szLabel, sizeof(szLabel), "%u.%u.%u.%u",
+                    File->FileVersionMS >> 16, File->FileVersionMS & 0xFFFF,
+                    File->FileVersionLS >> 16, File->FileVersionLS & 0xFFFF);
+            }
+            else {
+                snprintf(szLabel, sizeof(szLabel), "%u.%u.%u",
+                    File->FileVersionMS >> 16, File->FileVersionMS & 0xFFFF,
+                    File->FileVersionLS >> 16);
+            }
+            Context->Columns[Context->ColumnCount] = strdup(szLabel);
+        }
+        else {
+            Context->Columns[Context->ColumnCount] = strdup(scmpBaseName(File->FileName));
+        }
+
+        if (Context->Columns[Context->ColumnCount] == NULL)
+            return FALSE;
+
+        File->Column = Context->ColumnCount++;
+        Previous = File;
+    }
+
+    return TRUE;
+}
+
+/*
+* scmpHashName
+*
+* Purpose:
+*
+* Create sdbm hash for service name within table.
+*
+*/
+ULONG scmpHashName(
+    _In_ SCM_TABLE_TYPE TableType,
+    _In_ LPCSTR Name
+)
+{
+    ULONG hashValue = (ULONG)TableType;
+
+    while (*Name)
+        hashValue = (hashValue * 65599) + (UCHAR)*Name++;
+
+    return hashValue;
+}
+
+/*
+* scmpGrowRowHash
+*
+* Purpose:
+*
+* Double row lookup table and reinsert rows.
+*
+*/
+BOOL scmpGrowRowHash(
+    _In_ PSCM_CONTEXT Context
+)
+{
+    ULONG i, j, NewSize;
+    PULONG NewHash;
+
+    NewSize = (Context->RowHashSize) ? Context->RowHashSize * 2 : SCM_ROW_HASH_SIZE;
+
+    NewHash = (PULONG)calloc(NewSize, sizeof(ULONG));
+    if (NewHash == NULL)
+        return FALSE;
+
+    for (i = 0; i < Context->RowCount; i++) {
+        j = Context->Rows[i].Hash & (NewSize - 1);
+        while (NewHash[j])
+            j = (j + 1) & (NewSize - 1);
+        NewHash[j] = i + 1;
+    }
+
+    free(Context->RowHash);
+    Context->RowHash = NewHash;
+    Context->RowHashSize = NewSize;
+    return TRUE;
+}
+
+/*
+* scmpQueryRow
+*
+* Purpose:
+*
+* Find or create matrix row for service.
+*
+*/
+PSCM_ROW scmpQueryRow(
+    _In_ PSCM_CONTEXT Context,
+    _In_ SCM_TABLE_TYPE TableType,
+    _In_ LPCSTR Name
+)
+{
+    ULONG Hash, i, NewCapacity;
+    PSCM_ROW Row, Rows;
+
+    //
+    // Keep load factor at most one half.
+    //
+    if ((Context->RowCount + 1) * 2 > Context->RowHashSize) {
+        if (!scmpGrowRowHash(Context))
+            return NULL;
+    }
+
+    Hash = scmpHashName(TableType, Name);
+
+    for (i = Hash & (Context->RowHashSize - 1);
+        Context->RowHash[i] != 0;
+        i = (i + 1) & (Context->RowHashSize - 1))
+    {
+        Row = &Context->Rows[Context->RowHash[i] - 1];
+        if (Row->Hash == Hash && Row->TableType == TableType && strcmp(Row->Name, Name) == 0)
+            return Row;
+    }
+
+    if (Context->RowCount == Context->RowCapacity) {
+
+        NewCapacity = (Context->RowCapacity) ? Context->RowCapacity * 2 : 1024;
+
+        Rows = (PSCM_ROW)realloc(Context->Rows, NewCapacity * sizeof(SCM_ROW));
+        if (Rows == NULL)
+            return NULL;
+
+        Context->Rows = Rows;
+        Context->RowCapacity = NewCapacity;
+    }
+
+    Row = &Context->Rows[Context->RowCount];
+    Row->TableType = TableType;
+    Row->Name = Name;
+    Row->Hash = Hash;
+    Row->Values = (PULONG)malloc(Context->ColumnCount * sizeof(ULONG));
+    if (Row->Values == NULL)
+        return NULL;
+
+    memset(Row->Values, 0xFF, Context->ColumnCount * sizeof(ULONG));
+
+    Context->RowHash[i] = ++Context->RowCount;
+    return Row;
+}
+
+/*
+* scmpMerge
+*
+* Purpose:
+*
+* Merge parsed files into matrix, later revision of the same build wins.
+*
+*/
+BOOL scmpMerge(
+    _In_ PSCM_CONTEXT Context
+)
+{
+    ULONG i, j;
+    PSCM_FILE File;
+    PSCM_ROW Row;
+    PULONG Value;
+
+    for (i = 0; i < Context->FileCount; i++) {
+
+        File = &Context->Files[i];
+        if (File->Error)
+            continue;
+
+        for (j = 0; j < File->ServiceCount; j++) {
+
+            Row = scmpQueryRow(Context, File->TableType, File->Services[j].Name);
+            if (Row == NULL)
+                return FALSE;
+
+            Value = &Row->Values[File->Column];
+
+            if (*Value != SCM_NO_SERVICE && *Value != File->Services[j].Index) {
+                Context->Conflicts += 1;
+                if (Context->Verbose) {
+                    fprintf(stderr, "scmatrix: %s %s conflicts %lu vs %lu in %s\n",
+                        Context->Columns[File->Column],
+                        File->Services[j].Name,
+                        (unsigned long)*Value,
+                        (unsigned long)File->Services[j].Index,
+                        File->FileName);
+                }
+            }
+
+            *Value = File->Services[j].Index;
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+* scmpCompareRows
+*
+* Purpose:
+*
+* Order rows by table and service name.
+*
+*/
+INT scmpCompareRows(
+    _In_ const void* First,
+    _In_ const void* Second
+)
+{
+    PSCM_ROW Row1 = (PSCM_ROW)First, Row2 = (PSCM_ROW)Second;
+
+    if (Row1->TableType != Row2->TableType)
+        return (Row1->TableType < Row2->TableType) ? -1 : 1;
+
+    return strcmp(Row1->Name, Row2->Name);
+}
+
+/*
+* scmpWriteField
+*
+* Purpose:
+*
+* Write CSV field, quoted if it contains separator, quote or line break.
+*
+*/
+VOID scmpWriteField(
+    _In_ FILE* Stream,
+    _In_ LPCSTR Text
+)
+{
+    LPCSTR p;
+
+    if (strpbrk(Text, ",\"\r\n") == NULL) {
+        fputs(Text, Stream);
+        return;
+    }
+
+    fputc('"', Stream);
+    for (p = Text; *p; p++) {
+        if (*p == '"')
+            fputc('"', Stream);
+        fputc(*p, Stream);
+    }
+    fputc('"', Stream);
+}
+
+/*
+* scmpWriteCsv
+*
+* Purpose:
+*
+* Output matrix, empty cell means service is missing in build.
+*
+*/
+BOOL scmpWriteCsv(
+    _In_ PSCM_CONTEXT Context,
+    _In_ FILE* Stream
+)
+{
+    ULONG i, j;
+    PSCM_ROW Row;
+
+    fputs("table,name", Stream);
+    for (j = 0; j < Context->ColumnCount; j++) {
+        fputc(',', Stream);
+        scmpWriteField(Stream, Context->Columns[j]);
+    }
+    fputc('\n', Stream);
+
+    for (i = 0; i < Context->RowCount; i++) {
+
+        Row = &Context->Rows[i];
+
+        fputs(g_ScmTableNames[Row->TableType], Stream);
+        fputc(',', Stream);
+        scmpWriteField(Stream, Row->Name);
+
+        for (j = 0; j < Context->ColumnCount; j++) {
+            if (Row->Values[j] == SCM_NO_SERVICE)
+                fputc(',', Stream);
+            else
+                fprintf(Stream, ",%lu", (unsigned long)Row->Values[j]);
+        }
+        fputc('\n', Stream);
+    }
+
+    return (fflush(Stream) == 0 && !ferror(Stream));
+}
+
+/*
+* scmpFreeContext
+*
+* Purpose:
+*
+* Release everything allocated for matrix.
+*
+*/
+VOID scmpFreeContext(
+    _In_ PSCM_CONTEXT Context
+)
+{
+    ULONG i;
+
+    for (i = 0; i < Context->RowCount; i++)
+        free(Context->Rows[i].Values);
+
+    if (Context->Columns) {
+        for (i = 0; i < Context->ColumnCount; i++)
+            free(Context->Columns[i]);
+    }
+
+    for (i = 0; i < Context->FileCount; i++) {
+        free(Context->Files[i].FileName);
+        free(Context->Files[i].Services);
+        free(Context->Files[i].NamePool);
+    }
+
+    free(Context->Columns);
+    free(Context->Rows);
+    free(Context->RowHash);
+    free(Context->Files);
+}
+
+/*
+* scmpUsage
+*
+* Purpose:
+*
+* Print command line help.
+*
+*/
+VOID scmpUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: scmatrix [-j threads] [-r] [-v] [-o file.csv] directory [directory...]\n"
+        "  -j  number of worker threads, default is number of online processors\n"
+        "  -r  key build columns by full file version including revision\n"
+        "  -v  report skipped files and conflicting service ids\n"
+        "  -o  output file, default is stdout\n");
+}
+
+INT main(
+    INT argc,
+    CHAR** argv
+)
+{
+    INT opt, ExitCode = 1;
+    ULONG ThreadCount, Images = 0, i;
+    LONG ProcessorCount;
+    LPCSTR lpOutput = NULL;
+    FILE* Stream = stdout;
+    struct stat st;
+    SCM_CONTEXT Context;
+
+    memset(&Context, 0, sizeof(Context));
+
+    ProcessorCount = (LONG)sysconf(_SC_NPROCESSORS_ONLN);
+    ThreadCount = (ProcessorCount > 0) ? (ULONG)ProcessorCount : 1;
+
+    while ((opt = getopt(argc, argv, "j:o:rvh")) != -1) {
+        switch (opt) {
+        case 'j':
+            ThreadCount = (ULONG)atoi(optarg);
+            break;
+        case 'o':
+            lpOutput = optarg;
+            break;
+        case 'r':
+            Context.KeyByRevision = TRUE;
+            break;
+        case 'v':
+            Context.Verbose = TRUE;
+            break;
+        default:
+            scmpUsage();
+            return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        scmpUsage();
+        return 1;
+    }
+
+    if (ThreadCount == 0)
+        ThreadCount = 1;
+    if (ThreadCount > SCM_MAX_THREADS)
+        ThreadCount = SCM_MAX_THREADS;
+
+    do {
+
+        for (; optind < argc; optind++) {
+
+            if (stat(argv[optind], &st) != 0) {
+                fprintf(stderr, "scmatrix: cannot access %s\n", argv[optind]);
+                continue;
+            }
+
+            if (S_ISDIR(st.st_mode)) {
+                if (!scmpScanDirectory(&Context, argv[optind]))
+                    break;
+            }
+            else {
+                if (!scmpAddFile(&Context, argv[optind]))
+                    break;
+            }
+        }
+
+        if (optind < argc) {
+            fprintf(stderr, "scmatrix: not enough memory\n");
+            break;
+        }
+
+        scmpRunWorkers(&Context, ThreadCount);
+
+        for (i = 0; i < Context.FileCount; i++) {
+            if (Context.Files[i].Error == NULL)
+                Images += 1;
+            else if (Context.Verbose)
+                fprintf(stderr, "scmatrix: skipped %s, %s\n", Context.Files[i].FileName, Context.Files[i].Error);
+        }
+
+        if (Images == 0) {
+            fprintf(stderr, "scmatrix: no ntdll or win32u x64 images found\n");
+            break;
+        }
+
+        qsort(Context.Files, Context.FileCount, sizeof(SCM_FILE), scmpCompareFiles);
+
+        if (!scmpAssignColumns(&Context) || !scmpMerge(&Context)) {
+            fprintf(stderr, "scmatrix: not enough memory\n");
+            break;
+        }
+
+        qsort(Context.Rows, Context.RowCount, sizeof(SCM_ROW), scmpCompareRows);
+
+        if (lpOutput) {
+            Stream = fopen(lpOutput, "w");
+            if (Stream == NULL) {
+                fprintf(stderr, "scmatrix: cannot create %s\n", lpOutput);
+                break;
+            }
+        }
+
+        if (!scmpWriteCsv(&Context, Stream)) {
+            fprintf(stderr, "scmatrix: write error\n");
+        }
+        else {
+            ExitCode = 0;
+        }
+
+        if (lpOutput)
+            fclose(Stream);
+
+        fprintf(stderr, "scmatrix: %lu files, %lu images, %lu builds, %lu services, %lu conflicting ids\n",
+            (unsigned long)Context.FileCount,
+            (unsigned long)Images,
+            (unsigned long)Context.ColumnCount,
+            (unsigned long)Context.RowCount,
+            (unsigned long)Context.Conflicts);
+
+    } while (FALSE);
+
+    scmpFreeContext(&Context);
+
+    return ExitCode;
+}
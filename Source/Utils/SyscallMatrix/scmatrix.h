@@ -0,0 +1,84 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       SCMATRIX.H
+*
+*  VERSION:     1.00
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the offline syscall table extractor.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+#define SCM_MAX_THREADS         256
+
+//
+// Matrix cell value for service missing in build.
+//
+#define SCM_NO_SERVICE          MAXULONG
+
+//
+// Initial row lookup table size, must be power of two.
+//
+#define SCM_ROW_HASH_SIZE       4096
+
+typedef struct _SCM_SERVICE {
+    LPCSTR Name;
+    ULONG Index;
+} SCM_SERVICE, *PSCM_SERVICE;
+
+typedef struct _SCM_FILE {
+    LPSTR FileName;
+    LPCSTR Error;               //NULL if image parsed
+    SCM_TABLE_TYPE TableType;
+    BOOL HasVersion;
+    ULONG FileVersionMS;
+    ULONG FileVersionLS;
+    ULONG Column;
+    ULONG ServiceCount;
+    PSCM_SERVICE Services;
+    LPSTR NamePool;
+} SCM_FILE, *PSCM_FILE;
+
+typedef struct _SCM_ROW {
+    SCM_TABLE_TYPE TableType;
+    LPCSTR Name;                //points to file name pool
+    ULONG Hash;
+    PULONG Values;              //service index per column
+} SCM_ROW, *PSCM_ROW;
+
+typedef struct _SCM_CONTEXT {
+    //
+    // Input files, parsed by workers.
+    //
+    PSCM_FILE Files;
+    ULONG FileCount;
+    ULONG FileCapacity;
+    ULONG NextFile;
+
+    //
+    // Options.
+    //
+    BOOL KeyByRevision;
+    BOOL Verbose;
+
+    //
+    // Merged matrix.
+    //
+    LPSTR* Columns;
+    ULONG ColumnCount;
+    PSCM_ROW Rows;
+    ULONG RowCount;
+    ULONG RowCapacity;
+    PULONG RowHash;             //row index plus one, zero for empty slot
+    ULONG RowHashSize;
+    ULONG Conflicts;            //files of one build column that disagree on service id
+} SCM_CONTEXT, *PSCM_CONTEXT;
@@ -0,0 +1,351 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       ARENA.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Arena allocator.
+*
+*  Bump pointer allocation from chunks of virtual memory. Memory is released
+*  all at once by reset, chunks are kept for reuse until arena is destroyed.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+#define ARENA_ALIGN_UP(Value, Alignment) (((Value) + (Alignment) - 1) & ~((SIZE_T)(Alignment) - 1))
+
+#define ARENA_CHUNK_DATA(Chunk) ((PBYTE)(Chunk) + sizeof(ARENA_CHUNK))
+
+static DWORD g_ArenaFlsIndex = FLS_OUT_OF_INDEXES;
+
+/*
+* arenapCreateChunk
+*
+* Purpose:
+*
+* Allocate chunk with at least Size usable bytes.
+*
+*/
+PARENA_CHUNK arenapCreateChunk(
+    _In_ SIZE_T ChunkSize,
+    _In_ SIZE_T Size
+)
+{
+    SIZE_T AllocationSize;
+    PARENA_CHUNK Chunk;
+
+    if (Size > MAXSIZE_T - sizeof(ARENA_CHUNK) - ChunkSize)
+        return NULL;
+
+    AllocationSize = ARENA_ALIGN_UP(sizeof(ARENA_CHUNK) + Size, ChunkSize);
+
+    Chunk = (PARENA_CHUNK)supVirtualAlloc(AllocationSize);
+    if (Chunk) {
+        Chunk->Next = NULL;
+        Chunk->Size = AllocationSize - sizeof(ARENA_CHUNK);
+        Chunk->Offset = 0;
+        Chunk->Dirty = 0;
+    }
+
+    return Chunk;
+}
+
+/*
+* arenapNextChunk
+*
+* Purpose:
+*
+* Make chunk with at least Size free bytes current.
+*
+* Chunks retained after reset are reused in order, new chunk is linked
+* in front of retained one when it is too small.
+*
+*/
+PARENA_CHUNK arenapNextChunk(
+    _In_ PARENA Arena,
+    _In_ SIZE_T Size
+)
+{
+    PARENA_CHUNK Chunk, Next;
+
+    Next = Arena->Current->Next;
+
+    if (Next && Next->Size >= Size) {
+        Next->Offset = 0;
+        Arena->Current = Next;
+        return Next;
+    }
+
+    Chunk = arenapCreateChunk(Arena->ChunkSize, Size);
+    if (Chunk) {
+        Chunk->Next = Next;
+        Arena->Current->Next = Chunk;
+        Arena->Current = Chunk;
+    }
+
+    return Chunk;
+}
+
+/*
+* arenapAllocate
+*
+* Purpose:
+*
+* Bump allocate block, zero it if requested.
+*
+* Memory above chunk dirty mark was never handed out and is zero already.
+*
+*/
+PVOID arenapAllocate(
+    _In_ PARENA Arena,
+    _In_ SIZE_T Size,
+    _In_ BOOL fZero
+)
+{
+    PBYTE Block;
+    PARENA_CHUNK Chunk;
+
+    if (Size > MAXSIZE_T - ARENA_ALIGNMENT)
+        return NULL;
+
+    Size = (Size) ? ARENA_ALIGN_UP(Size, ARENA_ALIGNMENT) : ARENA_ALIGNMENT;
+
+    Chunk = Arena->Current;
+    if (Chunk->Size - Chunk->Offset < Size) {
+        Chunk = arenapNextChunk(Arena, Size);
+        if (Chunk == NULL)
+            return NULL;
+    }
+
+    Block = ARENA_CHUNK_DATA(Chunk) + Chunk->Offset;
+
+    if (fZero && Chunk->Offset < Chunk->Dirty)
+        RtlSecureZeroMemory(Block, min(Size, Chunk->Dirty - Chunk->Offset));
+
+    Chunk->Offset += Size;
+    if (Chunk->Offset > Chunk->Dirty)
+        Chunk->Dirty = Chunk->Offset;
+
+    return Block;
+}
+
+/*
+* arenaCreate
+*
+* Purpose:
+*
+* Create arena, ChunkSize is rounded to default chunk size.
+*
+*/
+PARENA arenaCreate(
+    _In_opt_ SIZE_T ChunkSize
+)
+{
+    PARENA Arena;
+    PARENA_CHUNK Chunk;
+
+    ChunkSize = ARENA_ALIGN_UP(max(ChunkSize, ARENA_DEFAULT_CHUNK_SIZE), ARENA_DEFAULT_CHUNK_SIZE);
+
+    Chunk = arenapCreateChunk(ChunkSize, sizeof(ARENA));
+    if (Chunk == NULL)
+        return NULL;
+
+    Arena = (PARENA)ARENA_CHUNK_DATA(Chunk);
+    Arena->First = Chunk;
+    Arena->Current = Chunk;
+    Arena->ChunkSize = ChunkSize;
+    Arena->BaseOffset = ARENA_ALIGN_UP(sizeof(ARENA), ARENA_ALIGNMENT);
+
+    Chunk->Offset = Arena->BaseOffset;
+    Chunk->Dirty = Arena->BaseOffset;
+
+    return Arena;
+}
+
+/*
+* arenaDestroy
+*
+* Purpose:
+*
+* Release all arena memory including arena itself.
+*
+*/
+VOID arenaDestroy(
+    _In_opt_ PARENA Arena
+)
+{
+    PARENA_CHUNK Chunk, Next;
+
+    if (Arena == NULL)
+        return;
+
+    //
+    // First chunk holds arena descriptor, release it last.
+    //
+    Chunk = Arena->First->Next;
+    while (Chunk) {
+        Next = Chunk->Next;
+        supVirtualFree(Chunk);
+        Chunk = Next;
+    }
+
+    supVirtualFree(Arena->First);
+}
+
+/*
+* arenaAlloc
+*
+* Purpose:
+*
+* Allocate zeroed block from arena.
+*
+*/
+PVOID arenaAlloc(
+    _In_ PARENA Arena,
+    _In_ SIZE_T Size
+)
+{
+    return arenapAllocate(Arena, Size, TRUE);
+}
+
+/*
+* arenaAllocNoZero
+*
+* Purpose:
+*
+* Allocate block from arena, contents are undefined.
+*
+*/
+PVOID arenaAllocNoZero(
+    _In_ PARENA Arena,
+    _In_ SIZE_T Size
+)
+{
+    return arenapAllocate(Arena, Size, FALSE);
+}
+
+/*
+* arenaMark
+*
+* Purpose:
+*
+* Remember current arena position.
+*
+*/
+VOID arenaMark(
+    _In_ PARENA Arena,
+    _Out_ PARENA_MARK Mark
+)
+{
+    Mark->Chunk = Arena->Current;
+    Mark->Offset = Arena->Current->Offset;
+}
+
+/*
+* arenaResetToMark
+*
+* Purpose:
+*
+* Release everything allocated after mark was taken.
+*
+*/
+VOID arenaResetToMark(
+    _In_ PARENA Arena,
+    _In_ PARENA_MARK Mark
+)
+{
+    Arena->Current = Mark->Chunk;
+    Arena->Current->Offset = Mark->Offset;
+}
+
+/*
+* arenaReset
+*
+* Purpose:
+*
+* Release everything allocated from arena, chunks are kept for reuse.
+*
+*/
+VOID arenaReset(
+    _In_ PARENA Arena
+)
+{
+    Arena->Current = Arena->First;
+    Arena->First->Offset = Arena->BaseOffset;
+}
+
+/*
+* arenapThreadExit
+*
+* Purpose:
+*
+* Fls callback, destroy arena of exiting thread.
+*
+*/
+VOID NTAPI arenapThreadExit(
+    _In_ PVOID FlsData
+)
+{
+    arenaDestroy((PARENA)FlsData);
+}
+
+/*
+* arenaInitialize
+*
+* Purpose:
+*
+* Allocate per-thread arena slot.
+*
+*/
+VOID arenaInitialize(
+    VOID
+)
+{
+    if (g_ArenaFlsIndex == FLS_OUT_OF_INDEXES)
+        g_ArenaFlsIndex = FlsAlloc((PFLS_CALLBACK_FUNCTION)arenapThreadExit);
+}
+
+/*
+* arenaGetThreadArena
+*
+* Purpose:
+*
+* Return scratch arena of current thread, create it on first use.
+*
+* Callers take a mark on entry and reset to it on exit, so nested
+* users share the arena safely.
+*
+*/
+PARENA arenaGetThreadArena(
+    VOID
+)
+{
+    PARENA Arena;
+
+    if (g_ArenaFlsIndex == FLS_OUT_OF_INDEXES)
+        return NULL;
+
+    Arena = (PARENA)FlsGetValue(g_ArenaFlsIndex);
+    if (Arena)
+        return Arena;
+
+    Arena = arenaCreate(0);
+    if (Arena == NULL)
+        return NULL;
+
+    if (!FlsSetValue(g_ArenaFlsIndex, Arena)) {
+        arenaDestroy(Arena);
+        return NULL;
+    }
+
+    return Arena;
+}
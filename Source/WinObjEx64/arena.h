@@ -0,0 +1,80 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       ARENA.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the arena allocator.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Chunks are allocated in multiples of this size, allocation larger
+// than chunk gets dedicated chunk.
+//
+#define ARENA_DEFAULT_CHUNK_SIZE    0x10000
+#define ARENA_ALIGNMENT             MEMORY_ALLOCATION_ALIGNMENT
+
+typedef struct _ARENA_CHUNK {
+    struct _ARENA_CHUNK* Next;
+    SIZE_T Size;    //usable bytes following header
+    SIZE_T Offset;  //next free byte
+    SIZE_T Dirty;   //bytes ever handed out, memory above is still zero
+} ARENA_CHUNK, *PARENA_CHUNK;
+
+//
+// Arena is not synchronized, use from single thread or under caller lock.
+// Arena descriptor lives in its first chunk.
+//
+typedef struct _ARENA {
+    PARENA_CHUNK First;
+    PARENA_CHUNK Current;
+    SIZE_T ChunkSize;
+    SIZE_T BaseOffset;
+} ARENA, *PARENA;
+
+typedef struct _ARENA_MARK {
+    PARENA_CHUNK Chunk;
+    SIZE_T Offset;
+} ARENA_MARK, *PARENA_MARK;
+
+PARENA arenaCreate(
+    _In_opt_ SIZE_T ChunkSize);
+
+VOID arenaDestroy(
+    _In_opt_ PARENA Arena);
+
+PVOID arenaAlloc(
+    _In_ PARENA Arena,
+    _In_ SIZE_T Size);
+
+PVOID arenaAllocNoZero(
+    _In_ PARENA Arena,
+    _In_ SIZE_T Size);
+
+VOID arenaMark(
+    _In_ PARENA Arena,
+    _Out_ PARENA_MARK Mark);
+
+VOID arenaResetToMark(
+    _In_ PARENA Arena,
+    _In_ PARENA_MARK Mark);
+
+VOID arenaReset(
+    _In_ PARENA Arena);
+
+VOID arenaInitialize(
+    VOID);
+
+PARENA arenaGetThreadArena(
+    VOID);
@@ -440,30 +440,24 @@ NTSTATUS WINAPI WinIoReadKernelVirtualMemory(
 }
 
 /*
-* WinIoReadSystemMemoryEx
+* WinIoReadSystemMemoryQuiet
 *
 * Purpose:
 *
-* Read kernel virtual memory.
+* Read kernel virtual memory, failure is only returned to the caller.
 *
 */
-BOOL WinIoReadSystemMemoryEx(
+NTSTATUS WinIoReadSystemMemoryQuiet(
     _In_ ULONG_PTR Address,
     _Inout_ PVOID Buffer,
-    _In_ ULONG BufferSize,
-    _Out_opt_ PULONG NumberOfBytesRead
+    _In_ ULONG BufferSize
 )
 {
-    BOOL bResult = FALSE;
-    IO_STATUS_BLOCK iost;
-    NTSTATUS ntStatus;
+    NTSTATUS ntStatus = STATUS_NO_MEMORY;
     PVOID lockedBuffer = NULL;
 
-    if (NumberOfBytesRead)
-        *NumberOfBytesRead = 0;
-
     if (Address < g_kdctx.SystemRangeStart)
-        return FALSE;
+        return STATUS_INVALID_PARAMETER_1;
 
     lockedBuffer = supVirtualAlloc(BufferSize);
     if (lockedBuffer) {
@@ -475,27 +469,64 @@ BOOL WinIoReadSystemMemoryEx(
                 lockedBuffer,
                 BufferSize);
 
-            if (!NT_SUCCESS(ntStatus)) {
-
-                iost.Status = ntStatus;
-                iost.Information = 0;
-
-                kdReportReadError(__FUNCTIONW__, Address, BufferSize, ntStatus, &iost);
-            }
-            else {
-                if (NumberOfBytesRead)
-                    *NumberOfBytesRead = BufferSize;
-
+            if (NT_SUCCESS(ntStatus))
                 RtlCopyMemory(Buffer, lockedBuffer, BufferSize);
 
-                bResult = TRUE;
-            }
-
             VirtualUnlock(lockedBuffer, BufferSize);
         }
 
         supVirtualFree(lockedBuffer);
     }
 
-    return bResult;
+    return ntStatus;
+}
+
+/*
+* WinIoReadSystemMemoryEx
+*
+* Purpose:
+*
+* Read kernel virtual memory.
+*
+*/
+BOOL WinIoReadSystemMemoryEx(
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize,
+    _Out_opt_ PULONG NumberOfBytesRead,
+    _In_opt_ PVOID CallerAddress
+)
+{
+    IO_STATUS_BLOCK iost;
+    NTSTATUS ntStatus;
+
+    if (NumberOfBytesRead)
+        *NumberOfBytesRead = 0;
+
+    if (Address < g_kdctx.SystemRangeStart)
+        return FALSE;
+
+    if (kdReadFailFast(Address, BufferSize, CallerAddress))
+        return FALSE;
+
+    ntStatus = WinIoReadSystemMemoryQuiet(Address, Buffer, BufferSize);
+
+    if (!NT_SUCCESS(ntStatus)) {
+
+        //
+        // Allocation failures say nothing about kernel memory.
+        //
+        if (ntStatus != STATUS_NO_MEMORY) {
+            iost.Status = ntStatus;
+            iost.Information = 0;
+
+            kdReportReadError(__FUNCTIONW__, Address, BufferSize, ntStatus, &iost, CallerAddress);
+        }
+        return FALSE;
+    }
+
+    if (NumberOfBytesRead)
+        *NumberOfBytesRead = BufferSize;
+
+    return TRUE;
 }
@@ -57,8 +57,14 @@ typedef NTSTATUS(WINAPI* provQueryPML4)(
     _In_ HANDLE DeviceHandle,
     _Out_ ULONG_PTR* Value);
 
+NTSTATUS WinIoReadSystemMemoryQuiet(
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize);
+
 BOOL WinIoReadSystemMemoryEx(
     _In_ ULONG_PTR Address,
     _Inout_ PVOID Buffer,
     _In_ ULONG BufferSize,
-    _Out_opt_ PULONG NumberOfBytesRead);
+    _Out_opt_ PULONG NumberOfBytesRead,
+    _In_opt_ PVOID CallerAddress);
@@ -0,0 +1,727 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       EXPORT.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  List and tree view export.
+*
+*  Rows are formatted directly into large buffer as UTF-8 and written
+*  through single file handle, text is never copied into temporary strings.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include "treelist\treelist.h"
+
+//
+// File extension per EXPORT_FORMAT.
+//
+static LPCWSTR g_ExportExtensions[ExportFormatMax] = {
+    L".tsv",
+    L".csv",
+    L".jsonl"
+};
+
+/*
+* exportpFlush
+*
+* Purpose:
+*
+* Write buffered output to the file.
+*
+*/
+VOID exportpFlush(
+    _In_ PEXPORT_WRITER Writer
+)
+{
+    DWORD dwWritten = 0;
+
+    if (Writer->Length == 0)
+        return;
+
+    if (!WriteFile(Writer->FileHandle, Writer->Buffer, Writer->Length, &dwWritten, NULL) ||
+        dwWritten != Writer->Length)
+    {
+        Writer->WriteError = TRUE;
+    }
+
+    Writer->Length = 0;
+}
+
+/*
+* exportpPutChar
+*
+* Purpose:
+*
+* Append single byte to the output buffer.
+*
+*/
+__forceinline VOID exportpPutChar(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ CHAR Char
+)
+{
+    if (Writer->Length == EXPORT_BUFFER_SIZE)
+        exportpFlush(Writer);
+
+    Writer->Buffer[Writer->Length++] = Char;
+}
+
+/*
+* exportpPutString
+*
+* Purpose:
+*
+* Append ANSI string to the output buffer.
+*
+*/
+VOID exportpPutString(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ LPCSTR String
+)
+{
+    while (*String)
+        exportpPutChar(Writer, *String++);
+}
+
+/*
+* exportpPutText
+*
+* Purpose:
+*
+* Append text converted to UTF-8 and escaped for writer format.
+*
+* CSV quotes are doubled, JSON specials are escaped, TSV separators
+* are replaced by space. Unpaired surrogates become U+FFFD.
+*
+*/
+VOID exportpPutText(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ LPCWSTR Text
+)
+{
+    ULONG c;
+    CHAR szEscape[8];
+
+    while ((c = *Text++) != 0) {
+
+        if ((c >= 0xD800) && (c <= 0xDBFF) && (*Text >= 0xDC00) && (*Text <= 0xDFFF)) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (*Text++ - 0xDC00);
+        }
+        else if ((c >= 0xD800) && (c <= 0xDFFF)) {
+            c = 0xFFFD;
+        }
+
+        if (c < 0x80) {
+
+            switch (Writer->Format) {
+
+            case ExportFormatTsv:
+                if ((c == L'\t') || (c == L'\r') || (c == L'\n'))
+                    c = L' ';
+                break;
+
+            case ExportFormatCsv:
+                if (c == L'\"')
+                    exportpPutChar(Writer, '\"');
+                break;
+
+            case ExportFormatJsonLines:
+                if ((c == L'\"') || (c == L'\\')) {
+                    exportpPutChar(Writer, '\\');
+                }
+                else if (c < 0x20) {
+                    _strcpy_a(szEscape, "\\u00");
+                    szEscape[4] = "0123456789abcdef"[c >> 4];
+                    szEscape[5] = "0123456789abcdef"[c & 0xF];
+                    szEscape[6] = 0;
+                    exportpPutString(Writer, szEscape);
+                    continue;
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            exportpPutChar(Writer, (CHAR)c);
+        }
+        else if (c < 0x800) {
+            exportpPutChar(Writer, (CHAR)(0xC0 | (c >> 6)));
+            exportpPutChar(Writer, (CHAR)(0x80 | (c & 0x3F)));
+        }
+        else if (c < 0x10000) {
+            exportpPutChar(Writer, (CHAR)(0xE0 | (c >> 12)));
+            exportpPutChar(Writer, (CHAR)(0x80 | ((c >> 6) & 0x3F)));
+            exportpPutChar(Writer, (CHAR)(0x80 | (c & 0x3F)));
+        }
+        else {
+            exportpPutChar(Writer, (CHAR)(0xF0 | (c >> 18)));
+            exportpPutChar(Writer, (CHAR)(0x80 | ((c >> 12) & 0x3F)));
+            exportpPutChar(Writer, (CHAR)(0x80 | ((c >> 6) & 0x3F)));
+            exportpPutChar(Writer, (CHAR)(0x80 | (c & 0x3F)));
+        }
+    }
+}
+
+/*
+* exportpBeginField
+*
+* Purpose:
+*
+* Write field separator, row start and JSON Lines key.
+*
+*/
+VOID exportpBeginField(
+    _In_ PEXPORT_WRITER Writer
+)
+{
+    CHAR szIndex[MAX_TEXT_CONVERSION_ULONG64];
+
+    if (Writer->Format == ExportFormatJsonLines) {
+
+        exportpPutChar(Writer, (Writer->FieldIndex) ? ',' : '{');
+        exportpPutChar(Writer, '\"');
+
+        if (Writer->FieldIndex < Writer->ColumnCount) {
+            exportpPutText(Writer, Writer->ColumnNames[Writer->FieldIndex]);
+        }
+        else {
+            szIndex[0] = 0;
+            u64tostr_a(Writer->FieldIndex, szIndex);
+            exportpPutString(Writer, "column");
+            exportpPutString(Writer, szIndex);
+        }
+
+        exportpPutString(Writer, "\":");
+    }
+    else if (Writer->FieldIndex) {
+        exportpPutChar(Writer, (Writer->Format == ExportFormatCsv) ? ',' : '\t');
+    }
+
+    Writer->FieldIndex++;
+}
+
+/*
+* exportWriteField
+*
+* Purpose:
+*
+* Write text field to the current row.
+*
+*/
+VOID exportWriteField(
+    _In_ PEXPORT_WRITER Writer,
+    _In_opt_ LPCWSTR Text
+)
+{
+    LPCWSTR p;
+    BOOL bQuote;
+
+    exportpBeginField(Writer);
+
+    if (Text == NULL)
+        Text = L"";
+
+    switch (Writer->Format) {
+
+    case ExportFormatCsv:
+        bQuote = FALSE;
+        for (p = Text; *p; p++) {
+            if ((*p == L',') || (*p == L'\"') || (*p == L'\r') || (*p == L'\n')) {
+                bQuote = TRUE;
+                break;
+            }
+        }
+        if (bQuote) exportpPutChar(Writer, '\"');
+        exportpPutText(Writer, Text);
+        if (bQuote) exportpPutChar(Writer, '\"');
+        break;
+
+    case ExportFormatJsonLines:
+        exportpPutChar(Writer, '\"');
+        exportpPutText(Writer, Text);
+        exportpPutChar(Writer, '\"');
+        break;
+
+    default:
+        exportpPutText(Writer, Text);
+        break;
+    }
+}
+
+/*
+* exportWriteNumber
+*
+* Purpose:
+*
+* Write unsigned decimal field to the current row, unquoted in every format.
+*
+*/
+VOID exportWriteNumber(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ ULONG64 Value
+)
+{
+    CHAR szNumber[MAX_TEXT_CONVERSION_ULONG64];
+
+    exportpBeginField(Writer);
+
+    szNumber[0] = 0;
+    u64tostr_a(Value, szNumber);
+    exportpPutString(Writer, szNumber);
+}
+
+/*
+* exportEndRow
+*
+* Purpose:
+*
+* Terminate current row.
+*
+*/
+VOID exportEndRow(
+    _In_ PEXPORT_WRITER Writer
+)
+{
+    if (Writer->Format == ExportFormatJsonLines) {
+        if (Writer->FieldIndex == 0)
+            exportpPutChar(Writer, '{');
+        exportpPutString(Writer, "}\n");
+    }
+    else {
+        exportpPutString(Writer, "\r\n");
+    }
+
+    Writer->FieldIndex = 0;
+}
+
+/*
+* exportSetColumns
+*
+* Purpose:
+*
+* Set column names, written as header row for TSV/CSV and as keys for JSON Lines.
+*
+*/
+VOID exportSetColumns(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ ULONG ColumnCount,
+    _In_reads_(ColumnCount) LPCWSTR* ColumnNames
+)
+{
+    ULONG i;
+
+    Writer->ColumnCount = min(ColumnCount, EXPORT_MAX_COLUMNS);
+
+    for (i = 0; i < Writer->ColumnCount; i++) {
+
+        if (ColumnNames[i] && ColumnNames[i][0]) {
+            _strncpy(Writer->ColumnNames[i], EXPORT_MAX_COLUMN_NAME,
+                ColumnNames[i], EXPORT_MAX_COLUMN_NAME - 1);
+        }
+        else {
+            _strcpy(Writer->ColumnNames[i], TEXT("column"));
+            ultostr(i, _strend(Writer->ColumnNames[i]));
+        }
+    }
+
+    if (Writer->Format != ExportFormatJsonLines) {
+        for (i = 0; i < Writer->ColumnCount; i++)
+            exportWriteField(Writer, Writer->ColumnNames[i]);
+        exportEndRow(Writer);
+    }
+}
+
+/*
+* exportCreate
+*
+* Purpose:
+*
+* Create output file and writer.
+*
+*/
+PEXPORT_WRITER exportCreate(
+    _In_ LPCWSTR lpFileName,
+    _In_ EXPORT_FORMAT Format
+)
+{
+    PEXPORT_WRITER Writer;
+
+    if (Format >= ExportFormatMax)
+        return NULL;
+
+    Writer = (PEXPORT_WRITER)supVirtualAlloc(sizeof(EXPORT_WRITER));
+    if (Writer == NULL)
+        return NULL;
+
+    Writer->Format = Format;
+    Writer->FileHandle = CreateFile(lpFileName,
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+
+    if (Writer->FileHandle == INVALID_HANDLE_VALUE) {
+        supVirtualFree(Writer);
+        return NULL;
+    }
+
+    Writer->OwnsHandle = TRUE;
+
+    return Writer;
+}
+
+/*
+* exportAttach
+*
+* Purpose:
+*
+* Create writer over already opened handle, e.g. standard output.
+*
+* Handle is not closed by exportClose.
+*
+*/
+PEXPORT_WRITER exportAttach(
+    _In_ HANDLE FileHandle,
+    _In_ EXPORT_FORMAT Format
+)
+{
+    PEXPORT_WRITER Writer;
+
+    if ((Format >= ExportFormatMax) ||
+        (FileHandle == NULL) ||
+        (FileHandle == INVALID_HANDLE_VALUE))
+    {
+        return NULL;
+    }
+
+    Writer = (PEXPORT_WRITER)supVirtualAlloc(sizeof(EXPORT_WRITER));
+    if (Writer == NULL)
+        return NULL;
+
+    Writer->Format = Format;
+    Writer->FileHandle = FileHandle;
+    Writer->OwnsHandle = FALSE;
+
+    return Writer;
+}
+
+/*
+* exportFlush
+*
+* Purpose:
+*
+* Write pending output, returns FALSE if any write failed so far.
+*
+*/
+BOOL exportFlush(
+    _In_ PEXPORT_WRITER Writer
+)
+{
+    exportpFlush(Writer);
+    return (Writer->WriteError == FALSE);
+}
+
+/*
+* exportClose
+*
+* Purpose:
+*
+* Flush output, close owned file handle and release writer.
+*
+* Returns FALSE if any write failed.
+*
+*/
+BOOL exportClose(
+    _In_ PEXPORT_WRITER Writer
+)
+{
+    BOOL bResult;
+
+    exportpFlush(Writer);
+    if (Writer->OwnsHandle)
+        CloseHandle(Writer->FileHandle);
+
+    bResult = (Writer->WriteError == FALSE);
+    supVirtualFree(Writer);
+
+    return bResult;
+}
+
+/*
+* exportListView
+*
+* Purpose:
+*
+* Write all listview columns and rows.
+*
+* Cell text is read into single reused buffer from the thread arena.
+*
+*/
+BOOL exportListView(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ HWND ListView
+)
+{
+    INT i, j, ItemCount, ColumnCount;
+    UINT cchBuffer;
+    LPWSTR lpBuffer, lpText;
+    PARENA Arena;
+    ARENA_MARK Mark;
+    LVCOLUMN col;
+    LPCWSTR ColumnNames[EXPORT_MAX_COLUMNS];
+    WCHAR szNames[EXPORT_MAX_COLUMNS][EXPORT_MAX_COLUMN_NAME];
+
+    Arena = arenaGetThreadArena();
+    if (Arena == NULL)
+        return FALSE;
+
+    ColumnCount = Header_GetItemCount(ListView_GetHeader(ListView));
+    if (ColumnCount <= 0)
+        return FALSE;
+
+    ColumnCount = min(ColumnCount, EXPORT_MAX_COLUMNS);
+
+    for (i = 0; i < ColumnCount; i++) {
+        RtlSecureZeroMemory(&col, sizeof(col));
+        szNames[i][0] = 0;
+        col.mask = LVCF_TEXT;
+        col.pszText = szNames[i];
+        col.cchTextMax = EXPORT_MAX_COLUMN_NAME;
+        ListView_GetColumn(ListView, i, &col);
+        ColumnNames[i] = szNames[i];
+    }
+
+    exportSetColumns(Writer, (ULONG)ColumnCount, ColumnNames);
+
+    arenaMark(Arena, &Mark);
+
+    cchBuffer = LVSORT_TEXT_LENGTH;
+    lpBuffer = (LPWSTR)arenaAllocNoZero(Arena, cchBuffer * sizeof(WCHAR));
+    if (lpBuffer) {
+
+        ItemCount = ListView_GetItemCount(ListView);
+
+        for (i = 0; i < ItemCount; i++) {
+
+            for (j = 0; j < ColumnCount; j++) {
+                lpText = lvGetItemText(ListView, i, j, Arena, &lpBuffer, &cchBuffer);
+                exportWriteField(Writer, lpText);
+            }
+
+            exportEndRow(Writer);
+        }
+    }
+
+    arenaResetToMark(Arena, &Mark);
+
+    return (lpBuffer != NULL);
+}
+
+/*
+* exportTreeList
+*
+* Purpose:
+*
+* Write all treelist items in tree order including collapsed ones.
+*
+* Subitem text is taken directly from item data, no copies are made.
+*
+*/
+BOOL exportTreeList(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ HWND TreeList
+)
+{
+    INT i, ColumnCount;
+    ULONG Level;
+    HWND Header;
+    HTREEITEM hItem, hNext;
+    PTL_SUBITEMS Subitems;
+    TVITEMEX itemex;
+    HDITEM hdi;
+    LPCWSTR ColumnNames[EXPORT_MAX_COLUMNS];
+    WCHAR szNames[EXPORT_MAX_COLUMNS][EXPORT_MAX_COLUMN_NAME];
+    WCHAR szText[MAX_PATH + 1];
+
+    Header = (HWND)GetWindowLongPtr(TreeList, TL_HEADERCONTROL_SLOT);
+    if (Header == NULL)
+        return FALSE;
+
+    ColumnCount = Header_GetItemCount(Header);
+    if (ColumnCount <= 0)
+        return FALSE;
+
+    ColumnCount = min(ColumnCount, EXPORT_MAX_COLUMNS - 1);
+
+    ColumnNames[0] = EXPORT_LEVEL_COLUMN_NAME;
+
+    for (i = 0; i < ColumnCount; i++) {
+        RtlSecureZeroMemory(&hdi, sizeof(hdi));
+        szNames[i][0] = 0;
+        hdi.mask = HDI_TEXT;
+        hdi.pszText = szNames[i];
+        hdi.cchTextMax = EXPORT_MAX_COLUMN_NAME;
+        Header_GetItem(Header, i, &hdi);
+        ColumnNames[i + 1] = szNames[i];
+    }
+
+    exportSetColumns(Writer, (ULONG)ColumnCount + 1, ColumnNames);
+
+    Level = 0;
+    hItem = TreeList_GetRoot(TreeList);
+
+    while (hItem) {
+
+        RtlSecureZeroMemory(&itemex, sizeof(itemex));
+        szText[0] = 0;
+        itemex.mask = TVIF_TEXT;
+        itemex.hItem = hItem;
+        itemex.pszText = szText;
+        itemex.cchTextMax = MAX_PATH;
+
+        Subitems = NULL;
+        TreeList_GetTreeItem(TreeList, &itemex, &Subitems);
+
+        exportWriteNumber(Writer, Level);
+        exportWriteField(Writer, szText);
+
+        //
+        // Header column N shows subitem N - 1.
+        //
+        for (i = 1; i < ColumnCount; i++) {
+            if (Subitems && ((ULONG)i - 1 < Subitems->Count))
+                exportWriteField(Writer, Subitems->Text[i - 1]);
+            else
+                exportWriteField(Writer, NULL);
+        }
+
+        exportEndRow(Writer);
+
+        //
+        // Pre-order walk: child, else next sibling of item or its nearest parent.
+        //
+        hNext = TreeList_GetChild(TreeList, hItem);
+        if (hNext) {
+            Level++;
+            hItem = hNext;
+            continue;
+        }
+
+        while (hItem) {
+            hNext = TreeList_GetNextSibling(TreeList, hItem);
+            if (hNext) {
+                hItem = hNext;
+                break;
+            }
+            hItem = TreeList_GetNextItem(TreeList, hItem, TVGN_PARENT);
+            if (Level) Level--;
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+* exportViewToFile
+*
+* Purpose:
+*
+* Ask for file name and format, then export given view.
+*
+*/
+BOOL exportViewToFile(
+    _In_ HWND OwnerWindow,
+    _In_ HWND ViewWindow,
+    _In_ EXPORT_VIEW_TYPE ViewType,
+    _In_opt_ LPCWSTR lpDefaultName
+)
+{
+    BOOL bResult = FALSE;
+    EXPORT_FORMAT Format;
+    PEXPORT_WRITER Writer;
+    OPENFILENAME ofn;
+    TRACE_SPAN Span;
+    WCHAR szFileName[MAX_PATH + 1];
+
+    if (ViewType >= ExportViewMax)
+        return FALSE;
+
+    RtlSecureZeroMemory(szFileName, sizeof(szFileName));
+    _strncpy(szFileName, MAX_PATH, (lpDefaultName) ? lpDefaultName : TEXT("List"), MAX_PATH);
+
+    RtlSecureZeroMemory(&ofn, sizeof(ofn));
+    ofn.lStructSize = sizeof(OPENFILENAME);
+    ofn.hwndOwner = OwnerWindow;
+    ofn.lpstrFilter = EXPORT_DIALOG_FILTER;
+    ofn.nFilterIndex = 1;
+    ofn.lpstrFile = szFileName;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_EXPLORER | OFN_PATHMUSTEXIST | OFN_OVERWRITEPROMPT;
+
+    if (!GetSaveFileName(&ofn))
+        return FALSE;
+
+    //
+    // Filter order matches EXPORT_FORMAT.
+    //
+    Format = (EXPORT_FORMAT)(ofn.nFilterIndex - 1);
+    if (Format >= ExportFormatMax)
+        Format = ExportFormatTsv;
+
+    //
+    // Dialog default extension cannot follow selected filter, append it here.
+    //
+    if (ofn.nFileExtension == 0) {
+
+        if (_strlen(szFileName) + _strlen(g_ExportExtensions[Format]) > MAX_PATH)
+            return FALSE;
+
+        _strcat(szFileName, g_ExportExtensions[Format]);
+
+        if (GetFileAttributes(szFileName) != INVALID_FILE_ATTRIBUTES &&
+            MessageBox(OwnerWindow,
+                TEXT("File already exists. Do you want to replace it?"),
+                szFileName,
+                MB_ICONWARNING | MB_YESNO) != IDYES)
+        {
+            return FALSE;
+        }
+    }
+
+    Writer = exportCreate(szFileName, Format);
+    if (Writer) {
+
+        TRACE_BEGIN(Span, "Export");
+        supSetWaitCursor(TRUE);
+
+        if (ViewType == ExportViewTreeList)
+            bResult = exportTreeList(Writer, ViewWindow);
+        else
+            bResult = exportListView(Writer, ViewWindow);
+
+        if (!exportClose(Writer))
+            bResult = FALSE;
+
+        supSetWaitCursor(FALSE);
+        TRACE_END_DETAIL(Span, szFileName);
+    }
+
+    if (!bResult) {
+        MessageBox(OwnerWindow, TEXT("Could not export list to the selected file."), NULL, MB_ICONERROR);
+    }
+
+    return bResult;
+}
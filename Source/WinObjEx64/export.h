@@ -0,0 +1,107 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       EXPORT.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the list and tree view export.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Output formats, all are written in UTF-8.
+//
+typedef enum _EXPORT_FORMAT {
+    ExportFormatTsv = 0,
+    ExportFormatCsv,
+    ExportFormatJsonLines,
+    ExportFormatMax
+} EXPORT_FORMAT;
+
+//
+// View types, keep in sync with plugin_def.h.
+//
+typedef enum _EXPORT_VIEW_TYPE {
+    ExportViewListView = 0,
+    ExportViewTreeList,
+    ExportViewMax
+} EXPORT_VIEW_TYPE;
+
+#define EXPORT_BUFFER_SIZE          0x100000
+#define EXPORT_MAX_COLUMNS          64
+#define EXPORT_MAX_COLUMN_NAME      64
+
+//
+// Tree exports get leading column with item depth.
+//
+#define EXPORT_LEVEL_COLUMN_NAME    L"Level"
+
+#define EXPORT_DIALOG_FILTER        L"Tab separated values (*.tsv)\0*.tsv\0" \
+                                    L"Comma separated values (*.csv)\0*.csv\0" \
+                                    L"JSON Lines (*.jsonl)\0*.jsonl\0\0"
+
+typedef struct _EXPORT_WRITER {
+    HANDLE FileHandle;
+    EXPORT_FORMAT Format;
+    BOOL WriteError;
+    BOOL OwnsHandle;    //FileHandle is closed by exportClose
+    ULONG ColumnCount;
+    ULONG FieldIndex;   //field index in current row
+    ULONG Length;       //bytes pending in Buffer
+    WCHAR ColumnNames[EXPORT_MAX_COLUMNS][EXPORT_MAX_COLUMN_NAME]; //JSON Lines keys
+    CHAR Buffer[EXPORT_BUFFER_SIZE];
+} EXPORT_WRITER, *PEXPORT_WRITER;
+
+PEXPORT_WRITER exportCreate(
+    _In_ LPCWSTR lpFileName,
+    _In_ EXPORT_FORMAT Format);
+
+PEXPORT_WRITER exportAttach(
+    _In_ HANDLE FileHandle,
+    _In_ EXPORT_FORMAT Format);
+
+BOOL exportFlush(
+    _In_ PEXPORT_WRITER Writer);
+
+BOOL exportClose(
+    _In_ PEXPORT_WRITER Writer);
+
+VOID exportSetColumns(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ ULONG ColumnCount,
+    _In_reads_(ColumnCount) LPCWSTR* ColumnNames);
+
+VOID exportWriteField(
+    _In_ PEXPORT_WRITER Writer,
+    _In_opt_ LPCWSTR Text);
+
+VOID exportWriteNumber(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ ULONG64 Value);
+
+VOID exportEndRow(
+    _In_ PEXPORT_WRITER Writer);
+
+BOOL exportListView(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ HWND ListView);
+
+BOOL exportTreeList(
+    _In_ PEXPORT_WRITER Writer,
+    _In_ HWND TreeList);
+
+BOOL exportViewToFile(
+    _In_ HWND OwnerWindow,
+    _In_ HWND ViewWindow,
+    _In_ EXPORT_VIEW_TYPE ViewType,
+    _In_opt_ LPCWSTR lpDefaultName);
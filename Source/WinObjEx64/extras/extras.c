@@ -23,6 +23,7 @@
 #include "extrasIPC.h"
 #include "extrasPSList.h"
 #include "extrasCallbacks.h"
+#include "extrasReadStats.h"
 #include "extrasSL.h"
 
 /*
@@ -67,7 +68,7 @@ VOID extrasSimpleListResize(
 BOOL extrasDlgHandleNotify(
     _In_ LPNMLISTVIEW nhdr,
     _In_ EXTRASCONTEXT* Context,
-    _In_ DlgCompareFunction CompareFunc,
+    _In_ DlgSortKeyFunction SortKeyFunc,
     _In_opt_ CustomNotifyFunction CustomHandler,
     _In_opt_ PVOID CustomParameter
 )
@@ -75,7 +76,7 @@ BOOL extrasDlgHandleNotify(
     BOOL bResult = FALSE;
     INT nImageIndex;
 
-    if ((nhdr == NULL) || (Context == NULL) || (CompareFunc == NULL))
+    if ((nhdr == NULL) || (Context == NULL) || (SortKeyFunc == NULL))
         return bResult;
 
     if (nhdr->hdr.idFrom != ID_EXTRASLIST)
@@ -87,7 +88,10 @@ BOOL extrasDlgHandleNotify(
 
         Context->bInverseSort = !Context->bInverseSort;        
         Context->lvColumnToSort = nhdr->iSubItem;
-        ListView_SortItemsEx(Context->ListView, CompareFunc, Context->lvColumnToSort);
+        lvSortItems(Context->ListView,
+            Context->lvColumnToSort,
+            SortKeyFunc(Context->lvColumnToSort),
+            Context->bInverseSort);
 
         nImageIndex = ImageList_GetImageCount(g_ListViewImages);
         if (Context->bInverseSort)
@@ -221,6 +225,10 @@ VOID extrasShowDialogById(
         extrasCreateSLCacheDialog(ParentWindow);
         break;
 
+    case ID_EXTRAS_READSTATS:
+        extrasCreateReadStatsDialog(ParentWindow);
+        break;
+
 
     default:
         break;
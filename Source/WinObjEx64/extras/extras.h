@@ -39,10 +39,8 @@ typedef struct _EXTRASCALLBACK {
     ULONG_PTR Value;
 } EXTRASCALLBACK, *PEXTRASCALLBACK;
 
-typedef INT(CALLBACK *DlgCompareFunction)(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
+typedef LVSORT_KEY_TYPE(CALLBACK *DlgSortKeyFunction)(
+    _In_ LONG Column
     );
 
 typedef BOOL(CALLBACK *CustomNotifyFunction)(
@@ -54,7 +52,7 @@ typedef BOOL(CALLBACK *CustomNotifyFunction)(
 BOOL extrasDlgHandleNotify(
     _In_ LPNMLISTVIEW nhdr,
     _In_ EXTRASCONTEXT *Context,
-    _In_ DlgCompareFunction CompareFunc,
+    _In_ DlgSortKeyFunction SortKeyFunc,
     _In_opt_ CustomNotifyFunction CustomHandler,
     _In_opt_ PVOID CustomParameter);
 
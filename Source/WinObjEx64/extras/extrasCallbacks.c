@@ -22,14 +22,52 @@
 #include "hde/hde64.h"
 
 ULONG g_CallbacksCount;
+HWND g_CallbacksBanner;
+
+//
+// Posted to the callbacks dialog when asynchronous query filled the cache.
+//
+#define WM_CALLBACKS_QUERY_COMPLETE (WM_APP + 1)
+
+//
+// Sanity limit for kernel list walks.
+//
+#define CALLBACKS_MAX_LIST_RECORDS 0x4000
 
 typedef struct _OBEX_CALLBACK_DISPATCH_ENTRY OBEX_CALLBACK_DISPATCH_ENTRY;
 
+typedef enum _OBEX_CALLBACK_RECORD_TYPE {
+    CallbackRecordRoot = 0,
+    CallbackRecordEntry,
+    CallbackRecordZero
+} OBEX_CALLBACK_RECORD_TYPE;
+
+//
+// Plain output record produced by display routines, strings are stored inline after record.
+//
+typedef struct _OBEX_CALLBACK_RECORD {
+    struct _OBEX_CALLBACK_RECORD *Next;
+    OBEX_CALLBACK_RECORD_TYPE Type;
+    ULONG_PTR Address;
+    LPWSTR Text;                //callback type for root, module name for entry
+    LPWSTR AdditionalInfo;
+} OBEX_CALLBACK_RECORD, *POBEX_CALLBACK_RECORD;
+
+//
+// Records of single dispatch table entry.
+//
+typedef struct _OBEX_CALLBACK_OUTPUT {
+    PARENA Arena;
+    POBEX_CALLBACK_RECORD Head;
+    POBEX_CALLBACK_RECORD Tail;
+    NTSTATUS QueryStatus;
+} OBEX_CALLBACK_OUTPUT, *POBEX_CALLBACK_OUTPUT;
+
 typedef ULONG_PTR(CALLBACK *POBEX_FINDCALLBACK_ROUTINE)(
     _In_opt_ ULONG_PTR QueryFlags);
 
 typedef VOID(CALLBACK *POBEX_DISPLAYCALLBACK_ROUTINE)(
-    _In_ HWND TreeList,
+    _In_ POBEX_CALLBACK_OUTPUT Output,
     _In_ LPWSTR CallbackType,
     _In_ ULONG_PTR KernelVariableAddress,
     _In_ PRTL_PROCESS_MODULES Modules);
@@ -39,7 +77,7 @@ typedef NTSTATUS(CALLBACK *POBEX_QUERYCALLBACK_ROUTINE)(
     _In_ POBEX_DISPLAYCALLBACK_ROUTINE DisplayRoutine,
     _In_opt_ POBEX_FINDCALLBACK_ROUTINE FindRoutine,
     _In_opt_ LPWSTR CallbackType,
-    _In_ HWND TreeList,
+    _In_ POBEX_CALLBACK_OUTPUT Output,
     _In_ PRTL_PROCESS_MODULES Modules,
     _Inout_opt_ PULONG_PTR SystemCallbacksRef);
 
@@ -51,12 +89,12 @@ typedef NTSTATUS(CALLBACK *POBEX_QUERYCALLBACK_ROUTINE)(
     _In_ POBEX_DISPLAYCALLBACK_ROUTINE DisplayRoutine,        \
     _In_opt_ POBEX_FINDCALLBACK_ROUTINE FindRoutine,         \
     _In_opt_ LPWSTR CallbackType,                             \
-    _In_ HWND TreeList,                                       \
+    _In_ POBEX_CALLBACK_OUTPUT Output,                        \
     _In_ PRTL_PROCESS_MODULES Modules,                        \
     _Inout_opt_ PULONG_PTR SystemCallbacksRef)
 
 #define OBEX_DISPLAYCALLBACK_ROUTINE(n) VOID CALLBACK n(     \
-    _In_ HWND TreeList,                               \
+    _In_ POBEX_CALLBACK_OUTPUT Output,                \
     _In_ LPWSTR CallbackType,                         \
     _In_ ULONG_PTR KernelVariableAddress,             \
     _In_ PRTL_PROCESS_MODULES Modules)
@@ -213,6 +251,25 @@ OBEX_CALLBACK_DISPATCH_ENTRY g_CallbacksDispatchTable[] = {
     }
 };
 
+//
+// Query results of all dispatch table entries, kept until explicit refresh.
+// Each worker allocates records from its own arena, at most one worker per entry.
+// Last finished worker completes the query and notifies NotifyWindow if set.
+//
+typedef struct _OBEX_CALLBACKS_CACHE {
+    BOOL Valid;
+    volatile LONG NextEntry;
+    volatile LONG NextArena;
+    volatile LONG ActiveWorkers;
+    volatile LONG QueryPending;
+    HWND NotifyWindow;
+    PRTL_PROCESS_MODULES Modules;
+    PARENA Arenas[RTL_NUMBER_OF(g_CallbacksDispatchTable) + 1];
+    OBEX_CALLBACK_OUTPUT Output[RTL_NUMBER_OF(g_CallbacksDispatchTable)];
+} OBEX_CALLBACKS_CACHE, *POBEX_CALLBACKS_CACHE;
+
+OBEX_CALLBACKS_CACHE g_CallbacksCache;
+
 //
 // All available names for CiCallbacks. Unknown is expected to be XBOX callback.
 //
@@ -1996,25 +2053,76 @@ OBEX_FINDCALLBACK_ROUTINE(FindExHostCallbacks)
     return Result;
 }
 
+/*
+* AddRecordToOutput
+*
+* Purpose:
+*
+* Allocate output record with inline copies of given strings and append it to the output.
+*
+*/
+BOOL AddRecordToOutput(
+    _In_ POBEX_CALLBACK_OUTPUT Output,
+    _In_ OBEX_CALLBACK_RECORD_TYPE Type,
+    _In_ ULONG_PTR Address,
+    _In_opt_ LPWSTR lpText,
+    _In_opt_ LPWSTR lpAdditionalInfo
+)
+{
+    SIZE_T cchText = 0, cchInfo = 0;
+    POBEX_CALLBACK_RECORD Record;
+
+    if (lpText) cchText = _strlen(lpText) + 1;
+    if (lpAdditionalInfo) cchInfo = _strlen(lpAdditionalInfo) + 1;
+
+    if (Output->Arena == NULL)
+        return FALSE;
+
+    Record = (POBEX_CALLBACK_RECORD)arenaAlloc(Output->Arena,
+        sizeof(OBEX_CALLBACK_RECORD) + (cchText + cchInfo) * sizeof(WCHAR));
+
+    if (Record == NULL)
+        return FALSE;
+
+    Record->Type = Type;
+    Record->Address = Address;
+
+    if (lpText) {
+        Record->Text = (LPWSTR)(Record + 1);
+        _strcpy(Record->Text, lpText);
+    }
+
+    if (lpAdditionalInfo) {
+        Record->AdditionalInfo = (LPWSTR)(Record + 1) + cchText;
+        _strcpy(Record->AdditionalInfo, lpAdditionalInfo);
+    }
+
+    if (Output->Tail)
+        Output->Tail->Next = Record;
+    else
+        Output->Head = Record;
+
+    Output->Tail = Record;
+
+    return TRUE;
+}
+
 /*
 * AddRootEntryToList
 *
 * Purpose:
 *
-* Adds callback root entry to the treelist.
+* Adds callback root entry to the output.
 *
 */
-HTREEITEM AddRootEntryToList(
-    _In_ HWND TreeList,
+BOOL AddRootEntryToList(
+    _In_ POBEX_CALLBACK_OUTPUT Output,
     _In_ LPWSTR lpCallbackType
 )
 {
-    return supTreeListAddItem(
-        TreeList,
-        NULL,
-        TVIF_TEXT | TVIF_STATE,
-        (UINT)0,
-        (UINT)0,
+    return AddRecordToOutput(Output,
+        CallbackRecordRoot,
+        0,
         lpCallbackType,
         NULL);
 }
@@ -2024,31 +2132,19 @@ HTREEITEM AddRootEntryToList(
 *
 * Purpose:
 *
-* Adds callback entry to the treelist.
+* Adds callback entry to the output.
 *
 */
 VOID AddEntryToList(
-    _In_ HWND TreeList,
-    _In_ HTREEITEM RootItem,
+    _In_ POBEX_CALLBACK_OUTPUT Output,
     _In_ ULONG_PTR Function,
     _In_opt_ LPWSTR lpAdditionalInfo,
     _In_ PRTL_PROCESS_MODULES Modules
 )
 {
     INT ModuleIndex;
-    TL_SUBITEMS_FIXED TreeListSubItems;
-    WCHAR szAddress[32];
     WCHAR szBuffer[MAX_PATH + 1];
 
-    RtlSecureZeroMemory(&TreeListSubItems, sizeof(TreeListSubItems));
-    TreeListSubItems.Count = 2;
-
-    szAddress[0] = L'0';
-    szAddress[1] = L'x';
-    szAddress[2] = 0;
-    u64tohex(Function, &szAddress[2]);
-    TreeListSubItems.Text[0] = szAddress;
-
     RtlSecureZeroMemory(szBuffer, sizeof(szBuffer));
 
     ModuleIndex = supFindModuleEntryByAddress(Modules, (PVOID)Function);
@@ -2066,19 +2162,11 @@ VOID AddEntryToList(
             MAX_PATH);
     }
 
-    TreeListSubItems.Text[0] = szBuffer;
-    TreeListSubItems.Text[1] = lpAdditionalInfo;
-
-    supTreeListAddItem(
-        TreeList,
-        RootItem,
-        TVIF_TEXT | TVIF_STATE,
-        (UINT)0,
-        (UINT)0,
-        szAddress,
-        &TreeListSubItems);
-
-    g_CallbacksCount += 1;
+    AddRecordToOutput(Output,
+        CallbackRecordEntry,
+        Function,
+        szBuffer,
+        lpAdditionalInfo);
 }
 
 /*
@@ -2086,48 +2174,144 @@ VOID AddEntryToList(
 *
 * Purpose:
 *
-* Adds emptry callback entry to the treelist.
+* Adds emptry callback entry to the output.
 *
 */
 VOID AddZeroEntryToList(
-    _In_ HWND TreeList,
-    _In_ HTREEITEM RootItem,
+    _In_ POBEX_CALLBACK_OUTPUT Output,
     _In_ ULONG_PTR Function,
     _In_opt_ LPWSTR lpAdditionalInfo
 )
 {
+    AddRecordToOutput(Output,
+        CallbackRecordZero,
+        Function,
+        TEXT("Nothing"),
+        (Function == 0) ? T_CannotQuery : lpAdditionalInfo);
+}
+
+/*
+* InsertOutputToList
+*
+* Purpose:
+*
+* Insert output records to the treelist, must be called from GUI thread.
+*
+*/
+VOID InsertOutputToList(
+    _In_ HWND TreeList,
+    _In_ POBEX_CALLBACK_OUTPUT Output
+)
+{
+    HTREEITEM RootItem = NULL;
+    POBEX_CALLBACK_RECORD Record;
     TL_SUBITEMS_FIXED TreeListSubItems;
     WCHAR szAddress[32];
-    WCHAR szBuffer[MAX_PATH + 1];
 
-    RtlSecureZeroMemory(&TreeListSubItems, sizeof(TreeListSubItems));
-    TreeListSubItems.Count = 2;
+    for (Record = Output->Head; Record; Record = Record->Next) {
+
+        if (Record->Type == CallbackRecordRoot) {
 
-    szAddress[0] = TEXT('0');
-    szAddress[1] = TEXT('x');
-    szAddress[2] = 0;
-    u64tohex(Function, &szAddress[2]);
-    TreeListSubItems.Text[0] = szAddress;
+            RootItem = supTreeListAddItem(
+                TreeList,
+                NULL,
+                TVIF_TEXT | TVIF_STATE,
+                (UINT)0,
+                (UINT)0,
+                Record->Text,
+                NULL);
+
+            continue;
+        }
 
-    _strcpy(szBuffer, TEXT("Nothing"));
+        if (RootItem == NULL)
+            continue;
 
-    TreeListSubItems.Text[0] = szBuffer;
+        RtlSecureZeroMemory(&TreeListSubItems, sizeof(TreeListSubItems));
+        TreeListSubItems.Count = 2;
+        TreeListSubItems.Text[0] = Record->Text;
+        TreeListSubItems.Text[1] = Record->AdditionalInfo;
 
-    if (Function == 0) {
-        TreeListSubItems.Text[1] = T_CannotQuery;
-    }
-    else {
-        TreeListSubItems.Text[1] = lpAdditionalInfo;
+        szAddress[0] = L'0';
+        szAddress[1] = L'x';
+        szAddress[2] = 0;
+        u64tohex(Record->Address, &szAddress[2]);
+
+        supTreeListAddItem(
+            TreeList,
+            RootItem,
+            TVIF_TEXT | TVIF_STATE,
+            (UINT)0,
+            (UINT)0,
+            szAddress,
+            &TreeListSubItems);
+
+        if (Record->Type == CallbackRecordEntry)
+            g_CallbacksCount += 1;
     }
+}
+
+typedef struct _CALLBACKS_WALK_CONTEXT {
+    POBEX_CALLBACK_OUTPUT Output;
+    PRTL_PROCESS_MODULES Modules;
+} CALLBACKS_WALK_CONTEXT, *PCALLBACKS_WALK_CONTEXT;
+
+/*
+* ReadListRecords
+*
+* Purpose:
+*
+* Walk kernel list with kdWalkListRecords and return copy of every record.
+* Records read before the walk stopped are returned together with the walk status.
+* Returned buffer must be released with supHeapFree.
+*
+*/
+PVOID ReadListRecords(
+    _In_ ULONG_PTR ListHead,
+    _In_ ULONG LinkOffset,
+    _In_ ULONG RecordSize,
+    _In_ ULONG Flags,
+    _Out_ PULONG NumberOfRecords,
+    _Out_ KDWALK_STATUS *WalkStatus
+)
+{
+    KDWALK_PARAMS Params;
+
+    RtlSecureZeroMemory(&Params, sizeof(Params));
+    Params.ListHead = ListHead;
+    Params.LinkOffset = LinkOffset;
+    Params.RecordSize = RecordSize;
+    Params.Flags = Flags;
+    Params.MaxCount = CALLBACKS_MAX_LIST_RECORDS;
+
+    return kdWalkListRecords(&Params, NumberOfRecords, WalkStatus);
+}
+
+/*
+* ReportListWalkStatus
+*
+* Purpose:
+*
+* Log incomplete callback list enumeration.
+*
+*/
+VOID ReportListWalkStatus(
+    _In_ LPWSTR CallbackType,
+    _In_ KDWALK_STATUS WalkStatus
+)
+{
+    WCHAR szBuffer[200];
+
+    if (WalkStatus == KdWalkComplete)
+        return;
 
-    supTreeListAddItem(
-        TreeList,
-        RootItem,
-        TVIF_TEXT | TVIF_STATE,
-        (UINT)0,
-        (UINT)0,
-        szAddress,
-        &TreeListSubItems);
+    RtlStringCchPrintfSecure(szBuffer,
+        RTL_NUMBER_OF(szBuffer),
+        TEXT("%ws list enumeration incomplete, walk status %lu"),
+        CallbackType,
+        (ULONG)WalkStatus);
+
+    logAdd(WOBJ_LOG_ENTRY_WARNING, szBuffer);
 }
 
 /*
@@ -2141,34 +2325,34 @@ VOID AddZeroEntryToList(
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpPsCallbacks)
 {
     ULONG c;
-    ULONG_PTR Address, Function;
+    ULONG_PTR Function;
     EX_FAST_REF Callbacks[PspNotifyRoutinesLimit];
-
-    HTREEITEM RootItem;
+    PVOID Routines[PspNotifyRoutinesLimit];
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
     RtlSecureZeroMemory(Callbacks, sizeof(Callbacks));
     if (kdReadSystemMemory(KernelVariableAddress,
         &Callbacks, sizeof(Callbacks)))
     {
+        //
+        // Read all callback blocks at once.
+        //
+        ObGetCallbackBlockRoutines(Callbacks, PspNotifyRoutinesLimit, Routines);
 
         for (c = 0; c < PspNotifyRoutinesLimit; c++) {
 
             if (Callbacks[c].Value) {
 
-                Address = (ULONG_PTR)ObGetObjectFastReference(Callbacks[c]);
-                Function = (ULONG_PTR)ObGetCallbackBlockRoutine((PVOID)Address);
+                Function = (ULONG_PTR)Routines[c];
                 if (Function < g_kdctx.SystemRangeStart)
                     continue;
 
-                AddEntryToList(TreeList,
-                    RootItem,
+                AddEntryToList(Output,
                     Function,
                     NULL,
                     Modules);
@@ -2189,34 +2373,34 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPsCallbacks)
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpDbgkLCallbacks)
 {
     ULONG c;
-    ULONG_PTR Address, Function;
+    ULONG_PTR Function;
     EX_FAST_REF Callbacks[DbgkLmdCount];
-
-    HTREEITEM RootItem;
+    PVOID Routines[DbgkLmdCount];
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
     RtlSecureZeroMemory(Callbacks, sizeof(Callbacks));
     if (kdReadSystemMemory(KernelVariableAddress,
         &Callbacks, sizeof(Callbacks)))
     {
+        //
+        // Read all callback blocks at once.
+        //
+        ObGetCallbackBlockRoutines(Callbacks, DbgkLmdCount, Routines);
 
         for (c = 0; c < DbgkLmdCount; c++) {
 
             if (Callbacks[c].Value) {
 
-                Address = (ULONG_PTR)ObGetObjectFastReference(Callbacks[c]);
-                Function = (ULONG_PTR)ObGetCallbackBlockRoutine((PVOID)Address);
+                Function = (ULONG_PTR)Routines[c];
                 if (Function < g_kdctx.SystemRangeStart)
                     continue;
 
-                AddEntryToList(TreeList,
-                    RootItem,
+                AddEntryToList(Output,
                     Function,
                     NULL,
                     Modules);
@@ -2239,13 +2423,10 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPsAltSystemCallHandlers)
     ULONG i;
     ULONG_PTR AltSystemCallHandlers[MAX_ALT_SYSTEM_CALL_HANDLERS];
 
-    HTREEITEM RootItem;
-
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
     RtlSecureZeroMemory(AltSystemCallHandlers, sizeof(AltSystemCallHandlers));
@@ -2260,8 +2441,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPsAltSystemCallHandlers)
                 if (AltSystemCallHandlers[i] < g_kdctx.SystemRangeStart)
                     continue;
 
-                AddEntryToList(TreeList,
-                    RootItem,
+                AddEntryToList(Output,
                     AltSystemCallHandlers[i],
                     NULL,
                     Modules);
@@ -2281,58 +2461,39 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPsAltSystemCallHandlers)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpKeBugCheckCallbacks)
 {
-    ULONG_PTR ListHead = KernelVariableAddress;
-    LIST_ENTRY ListEntry;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    KBUGCHECK_CALLBACK_RECORD CallbackRecord;
-
-    HTREEITEM RootItem;
+    PKBUGCHECK_CALLBACK_RECORD CallbackRecords;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
-
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
-    }
+    CallbackRecords = (PKBUGCHECK_CALLBACK_RECORD)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(KBUGCHECK_CALLBACK_RECORD, Entry),
+        sizeof(KBUGCHECK_CALLBACK_RECORD),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-        RtlSecureZeroMemory(&CallbackRecord, sizeof(CallbackRecord));
+    if (CallbackRecords == NULL)
+        return;
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &CallbackRecord,
-            sizeof(CallbackRecord),
-            NULL))
-        {
-            break;
-        }
+    for (i = 0; i < Count; i++) {
 
-        AddEntryToList(TreeList,
-            RootItem,
-            (ULONG_PTR)CallbackRecord.CallbackRoutine,
+        AddEntryToList(Output,
+            (ULONG_PTR)CallbackRecords[i].CallbackRoutine,
             NULL,
             Modules);
 
-        ListEntry.Flink = CallbackRecord.Entry.Flink;
     }
 
+    supHeapFree(CallbackRecords);
 }
 
 /*
@@ -2384,59 +2545,39 @@ LPWSTR KeBugCheckReasonToString(
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpKeBugCheckReasonCallbacks)
 {
-    ULONG_PTR ListHead = KernelVariableAddress;
-
-    LIST_ENTRY ListEntry;
-
-    KBUGCHECK_REASON_CALLBACK_RECORD CallbackRecord;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    HTREEITEM RootItem;
+    PKBUGCHECK_REASON_CALLBACK_RECORD CallbackRecords;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
-
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
-    }
+    CallbackRecords = (PKBUGCHECK_REASON_CALLBACK_RECORD)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(KBUGCHECK_REASON_CALLBACK_RECORD, Entry),
+        sizeof(KBUGCHECK_REASON_CALLBACK_RECORD),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-        RtlSecureZeroMemory(&CallbackRecord, sizeof(CallbackRecord));
+    if (CallbackRecords == NULL)
+        return;
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &CallbackRecord,
-            sizeof(CallbackRecord),
-            NULL))
-        {
-            break;
-        }
+    for (i = 0; i < Count; i++) {
 
-        AddEntryToList(TreeList,
-            RootItem,
-            (ULONG_PTR)CallbackRecord.CallbackRoutine,
-            KeBugCheckReasonToString(CallbackRecord.Reason),
+        AddEntryToList(Output,
+            (ULONG_PTR)CallbackRecords[i].CallbackRoutine,
+            KeBugCheckReasonToString(CallbackRecords[i].Reason),
             Modules);
 
-        ListEntry.Flink = CallbackRecord.Entry.Flink;
     }
 
+    supHeapFree(CallbackRecords);
 }
 
 /*
@@ -2449,59 +2590,39 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpKeBugCheckReasonCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpCmCallbacks)
 {
-    ULONG_PTR ListHead = KernelVariableAddress;
-
-    LIST_ENTRY ListEntry;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    CM_CALLBACK_CONTEXT_BLOCK CallbackRecord;
-
-    HTREEITEM RootItem;
+    PCM_CALLBACK_CONTEXT_BLOCK CallbackRecords;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
-
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
-    }
+    CallbackRecords = (PCM_CALLBACK_CONTEXT_BLOCK)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(CM_CALLBACK_CONTEXT_BLOCK, CallbackListEntry),
+        sizeof(CM_CALLBACK_CONTEXT_BLOCK),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-        RtlSecureZeroMemory(&CallbackRecord, sizeof(CallbackRecord));
+    if (CallbackRecords == NULL)
+        return;
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &CallbackRecord,
-            sizeof(CallbackRecord),
-            NULL))
-        {
-            break;
-        }
+    for (i = 0; i < Count; i++) {
 
-        AddEntryToList(TreeList,
-            RootItem,
-            (ULONG_PTR)CallbackRecord.Function,
+        AddEntryToList(Output,
+            (ULONG_PTR)CallbackRecords[i].Function,
             NULL,
             Modules);
 
-        ListEntry.Flink = CallbackRecord.CallbackListEntry.Flink;
     }
 
+    supHeapFree(CallbackRecords);
 }
 
 /*
@@ -2514,100 +2635,95 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCmCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpIoCallbacks)
 {
-    ULONG_PTR ListHead = KernelVariableAddress;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    LIST_ENTRY ListEntry;
+    PSHUTDOWN_PACKET EntryPackets;
 
-    SHUTDOWN_PACKET EntryPacket;
+    PDEVICE_OBJECT DeviceObjects;
 
-    DEVICE_OBJECT DeviceObject;
+    PDRIVER_OBJECT DriverObjects;
 
-    DRIVER_OBJECT DriverObject;
+    PKDREAD_REQUEST Requests;
 
     PVOID Routine;
     LPWSTR lpDescription;
 
-    HTREEITEM RootItem;
-
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
+    EntryPackets = (PSHUTDOWN_PACKET)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(SHUTDOWN_PACKET, ListEntry),
+        sizeof(SHUTDOWN_PACKET),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
+    ReportListWalkStatus(CallbackType, WalkStatus);
+
+    if (EntryPackets == NULL)
+        return;
+
+    if (Count == 0) {
+        supHeapFree(EntryPackets);
+        return;
+    }
+
+    Requests = (PKDREAD_REQUEST)supHeapAlloc(Count *
+        (sizeof(KDREAD_REQUEST) + sizeof(DEVICE_OBJECT) + sizeof(DRIVER_OBJECT)));
+
+    if (Requests == NULL) {
+        supHeapFree(EntryPackets);
         return;
     }
 
+    DeviceObjects = (PDEVICE_OBJECT)&Requests[Count];
+    DriverObjects = (PDRIVER_OBJECT)&DeviceObjects[Count];
+
     //
-    // Walk list entries.
+    // Attempt to query owner of the device objects, read all DEVICE_OBJECT at once.
     //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
-
-        RtlSecureZeroMemory(&EntryPacket, sizeof(EntryPacket));
+    for (i = 0; i < Count; i++) {
+        if ((ULONG_PTR)EntryPackets[i].DeviceObject > g_kdctx.SystemRangeStart)
+            Requests[i].Address = (ULONG_PTR)EntryPackets[i].DeviceObject;
+        Requests[i].Buffer = &DeviceObjects[i];
+        Requests[i].Size = sizeof(DEVICE_OBJECT);
+    }
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &EntryPacket,
-            sizeof(EntryPacket),
-            NULL))
-        {
-            break;
-        }
+    kdReadSystemMemoryBatch(Requests, Count);
 
-        Routine = EntryPacket.DeviceObject;
-        lpDescription = TEXT("PDEVICE_OBJECT");
+    //
+    // Read all DRIVER_OBJECT at once.
+    //
+    for (i = 0; i < Count; i++) {
+        Requests[i].Address = (Requests[i].Result) ? (ULONG_PTR)DeviceObjects[i].DriverObject : 0;
+        Requests[i].Buffer = &DriverObjects[i];
+        Requests[i].Size = sizeof(DRIVER_OBJECT);
+    }
 
-        //
-        // Attempt to query owner of the device object.
-        //
-        if ((ULONG_PTR)EntryPacket.DeviceObject > g_kdctx.SystemRangeStart) {
+    kdReadSystemMemoryBatch(Requests, Count);
 
-            //
-            // Read DEVICE_OBJECT.
-            //
-            RtlSecureZeroMemory(&DeviceObject, sizeof(DeviceObject));
+    for (i = 0; i < Count; i++) {
 
-            if (kdReadSystemMemoryEx((ULONG_PTR)EntryPacket.DeviceObject,
-                (PVOID)&DeviceObject,
-                sizeof(DeviceObject),
-                NULL))
-            {
-                //
-                // Read DRIVER_OBJECT.
-                //
-                RtlSecureZeroMemory(&DriverObject, sizeof(DriverObject));
-                if (kdReadSystemMemoryEx((ULONG_PTR)DeviceObject.DriverObject,
-                    (PVOID)&DriverObject,
-                    sizeof(DriverObject),
-                    NULL))
-                {
-                    Routine = DriverObject.MajorFunction[IRP_MJ_SHUTDOWN];
-                    lpDescription = TEXT("IRP_MJ_SHUTDOWN");
-                }
-            }
+        Routine = EntryPackets[i].DeviceObject;
+        lpDescription = TEXT("PDEVICE_OBJECT");
 
+        if (Requests[i].Result) {
+            Routine = DriverObjects[i].MajorFunction[IRP_MJ_SHUTDOWN];
+            lpDescription = TEXT("IRP_MJ_SHUTDOWN");
         }
 
-        AddEntryToList(TreeList,
-            RootItem,
+        AddEntryToList(Output,
             (ULONG_PTR)Routine,
             lpDescription,
             Modules);
-
-        ListEntry.Flink = EntryPacket.ListEntry.Flink;
     }
 
+    supHeapFree(Requests);
+    supHeapFree(EntryPackets);
 }
 
 /*
@@ -2622,82 +2738,102 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpObCallbacks)
 {
     BOOL bAltitudeRead, bNeedFree;
 
-    ULONG_PTR ListHead = KernelVariableAddress;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    LPWSTR lpInfoBuffer = NULL, lpType;
+    LPWSTR lpInfoBuffer, lpType;
 
-    SIZE_T Size, AltitudeSize = 0;
+    SIZE_T Size, AltitudeSize;
 
-    LIST_ENTRY ListEntry;
+    POB_CALLBACK_CONTEXT_BLOCK CallbackRecords, CallbackRecord;
 
-    OB_CALLBACK_CONTEXT_BLOCK CallbackRecord;
+    POB_CALLBACK_REGISTRATION Registrations;
 
-    OB_CALLBACK_REGISTRATION Registration;
+    LPWSTR *Altitudes;
 
-    HTREEITEM RootItem;
+    PKDREAD_REQUEST Requests;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
+        return;
+
+    CallbackRecords = (POB_CALLBACK_CONTEXT_BLOCK)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(OB_CALLBACK_CONTEXT_BLOCK, CallbackListEntry),
+        sizeof(OB_CALLBACK_CONTEXT_BLOCK),
+        0,
+        &Count,
+        &WalkStatus);
+
+    ReportListWalkStatus(CallbackType, WalkStatus);
+
+    if (CallbackRecords == NULL)
+        return;
+
+    if (Count == 0) {
+        supHeapFree(CallbackRecords);
+        return;
+    }
+
+    Requests = (PKDREAD_REQUEST)supHeapAlloc(Count *
+        (sizeof(KDREAD_REQUEST) + sizeof(OB_CALLBACK_REGISTRATION) + sizeof(LPWSTR)));
+
+    if (Requests == NULL) {
+        supHeapFree(CallbackRecords);
         return;
+    }
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
+    Registrations = (POB_CALLBACK_REGISTRATION)&Requests[Count];
+    Altitudes = (LPWSTR*)&Registrations[Count];
 
     //
-    // Read head.
+    // Read all registrations at once.
     //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
+    for (i = 0; i < Count; i++) {
+        Requests[i].Address = (ULONG_PTR)CallbackRecords[i].Registration;
+        Requests[i].Buffer = &Registrations[i];
+        Requests[i].Size = sizeof(OB_CALLBACK_REGISTRATION);
     }
 
+    kdReadSystemMemoryBatch(Requests, Count);
+
     //
-    // Walk list entries.
+    // Read all altitudes at once.
     //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    for (i = 0; i < Count; i++) {
 
-        RtlSecureZeroMemory(&CallbackRecord, sizeof(CallbackRecord));
+        Altitudes[i] = NULL;
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &CallbackRecord,
-            sizeof(CallbackRecord),
-            NULL))
-        {
-            break;
+        if (Requests[i].Result) {
+            AltitudeSize = 8 + (SIZE_T)Registrations[i].Altitude.Length;
+            Altitudes[i] = (LPWSTR)supHeapAlloc(AltitudeSize);
         }
 
-        //
-        // Read Altitude.
-        //
-        bAltitudeRead = FALSE;
-
-        RtlSecureZeroMemory(&Registration, sizeof(Registration));
-        if (kdReadSystemMemoryEx((ULONG_PTR)CallbackRecord.Registration,
-            (PVOID)&Registration,
-            sizeof(Registration),
-            NULL))
-        {
-            AltitudeSize = 8 + (SIZE_T)Registration.Altitude.Length;
-            lpInfoBuffer = (LPWSTR)supHeapAlloc(AltitudeSize);
-            if (lpInfoBuffer) {
-
-                bAltitudeRead = kdReadSystemMemoryEx((ULONG_PTR)Registration.Altitude.Buffer,
-                    (PVOID)lpInfoBuffer,
-                    Registration.Altitude.Length,
-                    NULL);
-            }
+        if (Altitudes[i]) {
+            Requests[i].Address = (ULONG_PTR)Registrations[i].Altitude.Buffer;
+            Requests[i].Size = Registrations[i].Altitude.Length;
         }
+        else {
+            Requests[i].Address = 0;
+            Requests[i].Size = 0;
+        }
+        Requests[i].Buffer = Altitudes[i];
+    }
+
+    kdReadSystemMemoryBatch(Requests, Count);
+
+    for (i = 0; i < Count; i++) {
+
+        CallbackRecord = &CallbackRecords[i];
+        lpInfoBuffer = Altitudes[i];
+        bAltitudeRead = Requests[i].Result;
+        AltitudeSize = 8 + (SIZE_T)Registrations[i].Altitude.Length;
 
         //
         // Output PreCallback.
         //
-        if ((ULONG_PTR)CallbackRecord.PreCallback > g_kdctx.SystemRangeStart) {
+        if ((ULONG_PTR)CallbackRecord->PreCallback > g_kdctx.SystemRangeStart) {
 
             bNeedFree = FALSE;
 
@@ -2713,9 +2849,8 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpObCallbacks)
             else
                 lpType = TEXT("PreCallback");
 
-            AddEntryToList(TreeList,
-                RootItem,
-                (ULONG_PTR)CallbackRecord.PreCallback,
+            AddEntryToList(Output,
+                (ULONG_PTR)CallbackRecord->PreCallback,
                 lpType,
                 Modules);
 
@@ -2725,7 +2860,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpObCallbacks)
         //
         // Output PostCallback.
         //
-        if ((ULONG_PTR)CallbackRecord.PostCallback > g_kdctx.SystemRangeStart) {
+        if ((ULONG_PTR)CallbackRecord->PostCallback > g_kdctx.SystemRangeStart) {
 
             bNeedFree = FALSE;
 
@@ -2741,19 +2876,19 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpObCallbacks)
             else
                 lpType = TEXT("PostCallback");
 
-            AddEntryToList(TreeList,
-                RootItem,
-                (ULONG_PTR)CallbackRecord.PostCallback,
+            AddEntryToList(Output,
+                (ULONG_PTR)CallbackRecord->PostCallback,
                 lpType,
                 Modules);
 
             if (bNeedFree) supHeapFree(lpType);
         }
-        ListEntry.Flink = CallbackRecord.CallbackListEntry.Flink;
 
         if (lpInfoBuffer) supHeapFree(lpInfoBuffer);
     }
 
+    supHeapFree(Requests);
+    supHeapFree(CallbackRecords);
 }
 
 /*
@@ -2766,59 +2901,44 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpObCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpSeFileSystemCallbacks)
 {
-    ULONG_PTR Next;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    SEP_LOGON_SESSION_TERMINATED_NOTIFICATION SeEntry; // This structure is different for Ex variant but 
-                                                       // key callback function field is on the same offset.
-
-    HTREEITEM RootItem;
+    PSEP_LOGON_SESSION_TERMINATED_NOTIFICATION SeEntries; // This structure is different for Ex variant but 
+                                                          // key callback function field is on the same offset.
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
     //
-    // Read head.
+    // Walk each entry in single linked list, head is the Next field of kernel variable.
     //
-    RtlSecureZeroMemory(&SeEntry, sizeof(SeEntry));
-
-    if (!kdReadSystemMemoryEx(KernelVariableAddress,
-        (PVOID)&SeEntry,
-        sizeof(SeEntry),
-        NULL))
-    {
-        return;
-    }
+    SeEntries = (PSEP_LOGON_SESSION_TERMINATED_NOTIFICATION)ReadListRecords(
+        KernelVariableAddress + FIELD_OFFSET(SEP_LOGON_SESSION_TERMINATED_NOTIFICATION, Next),
+        FIELD_OFFSET(SEP_LOGON_SESSION_TERMINATED_NOTIFICATION, Next),
+        sizeof(SEP_LOGON_SESSION_TERMINATED_NOTIFICATION),
+        KDWALK_FLAG_NULL_TERMINATED,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Walk each entry in single linked list.
-    //
-    Next = (ULONG_PTR)SeEntry.Next;
-    while (Next) {
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-        RtlSecureZeroMemory(&SeEntry, sizeof(SeEntry));
+    if (SeEntries == NULL)
+        return;
 
-        if (!kdReadSystemMemoryEx(Next,
-            (PVOID)&SeEntry,
-            sizeof(SeEntry),
-            NULL))
-        {
-            break;
-        }
+    for (i = 0; i < Count; i++) {
 
-        AddEntryToList(TreeList,
-            RootItem,
-            (ULONG_PTR)SeEntry.CallbackRoutine,
+        AddEntryToList(Output,
+            (ULONG_PTR)SeEntries[i].CallbackRoutine,
             NULL,
             Modules);
 
-        Next = (ULONG_PTR)SeEntry.Next;
-
     }
 
+    supHeapFree(SeEntries);
 }
 
 /*
@@ -2831,8 +2951,6 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpSeFileSystemCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
 {
-    LIST_ENTRY ListEntry;
-
     union {
         union {
             POP_POWER_SETTING_REGISTRATION_V1 *v1;
@@ -2841,27 +2959,21 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
         PBYTE Ref;
     } CallbackData;
 
-    ULONG ReadSize;
-    ULONG_PTR ListHead = KernelVariableAddress;
-    SIZE_T BufferSize;
+    ULONG ReadSize, i, Count = 0;
+    KDWALK_STATUS WalkStatus;
     LPWSTR GuidString;
-    PVOID Buffer = NULL;
+    PBYTE Records = NULL;
     PVOID CallbackRoutine = NULL;
 
     GUID EntryGuid;
     UNICODE_STRING ConvertedGuid;
 
-    HTREEITEM RootItem;
-
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
-
     //
     // Determinate size of structure to read.
     //
@@ -2872,42 +2984,23 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
     __try {
 
         //
-        // Allocate read buffer with enough size.
-        // 
-
-        BufferSize = sizeof(POP_POWER_SETTING_REGISTRATION_V1) + sizeof(POP_POWER_SETTING_REGISTRATION_V2);
-        Buffer = supHeapAlloc(BufferSize);
-        if (Buffer == NULL)
-            __leave;
+        // Read all list entries, ListEntry offset version independent.
+        //
+        Records = (PBYTE)ReadListRecords(KernelVariableAddress,
+            FIELD_OFFSET(POP_POWER_SETTING_REGISTRATION_V1, Link),
+            ReadSize,
+            0,
+            &Count,
+            &WalkStatus);
 
-        CallbackData.Ref = (PBYTE)Buffer;
+        ReportListWalkStatus(CallbackType, WalkStatus);
 
-        //
-        // Read head.
-        //
-        if (!kdReadSystemMemoryEx(
-            ListHead,
-            &ListEntry,
-            sizeof(LIST_ENTRY),
-            NULL))
-        {
+        if (Records == NULL)
             __leave;
-        }
-
-        //
-        // Walk list entries.
-        //
-        while ((ULONG_PTR)ListEntry.Flink != ListHead) {
 
-            RtlSecureZeroMemory(Buffer, BufferSize);
+        for (i = 0; i < Count; i++) {
 
-            if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-                Buffer,
-                ReadSize,
-                NULL))
-            {
-                break;
-            }
+            CallbackData.Ref = &Records[(SIZE_T)i * ReadSize];
 
             //
             // Is valid registration entry?
@@ -2931,8 +3024,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
                 else
                     GuidString = NULL;
 
-                AddEntryToList(TreeList,
-                    RootItem,
+                AddEntryToList(Output,
                     (ULONG_PTR)CallbackRoutine,
                     GuidString,
                     Modules);
@@ -2942,10 +3034,6 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
 
             }
 
-            //
-            // Next item address, ListEntry offset version independent.
-            //
-            ListEntry.Flink = CallbackData.Versions.v1->Link.Flink;
         }
 
     }
@@ -2954,7 +3042,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
         if (AbnormalTermination())
             supReportAbnormalTermination(__FUNCTIONW__);
 
-        if (Buffer) supHeapFree(Buffer);
+        if (Records) supHeapFree(Records);
     }
 }
 
@@ -2968,65 +3056,42 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpPoCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpDbgPrintCallbacks)
 {
-    ULONG_PTR ListHead = KernelVariableAddress;
-    ULONG_PTR RecordAddress;
-
-    LIST_ENTRY ListEntry;
-
-    RTL_CALLBACK_REGISTER CallbackRecord;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    HTREEITEM RootItem;
+    PRTL_CALLBACK_REGISTER CallbackRecords;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
+    CallbackRecords = (PRTL_CALLBACK_REGISTER)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(RTL_CALLBACK_REGISTER, ListEntry),
+        sizeof(RTL_CALLBACK_REGISTER),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(ListEntry),
-        NULL))
-    {
-        return;
-    }
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    if (CallbackRecords == NULL)
+        return;
 
-        RtlSecureZeroMemory(&CallbackRecord, sizeof(CallbackRecord));
+    for (i = 0; i < Count; i++) {
 
-        RecordAddress = (ULONG_PTR)ListEntry.Flink - FIELD_OFFSET(RTL_CALLBACK_REGISTER, ListEntry);
+        if (CallbackRecords[i].DebugPrintCallback) {
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)RecordAddress,
-            &CallbackRecord,
-            sizeof(CallbackRecord),
-            NULL))
-        {
-            break;
-        }
-
-        if (CallbackRecord.DebugPrintCallback) {
-
-            AddEntryToList(TreeList,
-                RootItem,
-                (ULONG_PTR)CallbackRecord.DebugPrintCallback,
+            AddEntryToList(Output,
+                (ULONG_PTR)CallbackRecords[i].DebugPrintCallback,
                 NULL,
                 Modules);
 
         }
-        ListEntry.Flink = CallbackRecord.ListEntry.Flink;
     }
 
+    supHeapFree(CallbackRecords);
 }
 
 /*
@@ -3039,210 +3104,154 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpDbgPrintCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpIoFsRegistrationCallbacks)
 {
-    LIST_ENTRY ListEntry;
-
-    NOTIFICATION_PACKET CallbackRecord;
+    ULONG i, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
-    ULONG_PTR ListHead = KernelVariableAddress;
-
-    HTREEITEM RootItem;
+    PNOTIFICATION_PACKET CallbackRecords;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
+    CallbackRecords = (PNOTIFICATION_PACKET)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(NOTIFICATION_PACKET, ListEntry),
+        sizeof(NOTIFICATION_PACKET),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
-    }
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
-
-        RtlSecureZeroMemory(&CallbackRecord, sizeof(CallbackRecord));
+    if (CallbackRecords == NULL)
+        return;
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &CallbackRecord,
-            sizeof(CallbackRecord),
-            NULL))
-        {
-            break;
-        }
+    for (i = 0; i < Count; i++) {
 
-        if (CallbackRecord.NotificationRoutine) {
+        if (CallbackRecords[i].NotificationRoutine) {
 
-            AddEntryToList(TreeList,
-                RootItem,
-                (ULONG_PTR)CallbackRecord.NotificationRoutine,
+            AddEntryToList(Output,
+                (ULONG_PTR)CallbackRecords[i].NotificationRoutine,
                 NULL,
                 Modules);
 
         }
-
-        ListEntry.Flink = CallbackRecord.ListEntry.Flink;
     }
 
+    supHeapFree(CallbackRecords);
 }
 
 /*
-* DumpIoFileSystemCallbacks
+* IoFileSystemWalkCallback
 *
 * Purpose:
 *
-* Read Io File System related callback data from kernel and send it to output window.
+* kdWalkList callback for Io File System queues.
+*
+* Record is DEVICE_OBJECT, TailData is DRIVER_OBJECT of this device.
 *
 */
-OBEX_DISPLAYCALLBACK_ROUTINE(DumpIoFileSystemCallbacks)
+BOOL CALLBACK IoFileSystemWalkCallback(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context
+)
 {
-    BOOL bNeedFree;
-
-    LIST_ENTRY ListEntry, NextEntry;
-
-    ULONG_PTR ListHead = KernelVariableAddress;
-
-    ULONG_PTR DeviceObjectAddress = 0, BaseAddress = 0;
-
-    DEVICE_OBJECT DeviceObject;
-
-    DRIVER_OBJECT DriverObject;
-
-    LPWSTR lpType;
-
-    HTREEITEM RootItem;
-
-    //
-    // Add callback root entry to the treelist.
-    //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
-        return;
-
-    ListEntry.Flink = ListEntry.Blink = NULL;
-
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
-    }
+    BOOL bNeedFree = FALSE;
+    ULONG_PTR BaseAddress = RecordAddress;
+    LPWSTR lpType = TEXT("PDEVICE_OBJECT"); //additional info column default text
+    PDRIVER_OBJECT DriverObject = (PDRIVER_OBJECT)TailData;
+    PCALLBACKS_WALK_CONTEXT WalkContext = (PCALLBACKS_WALK_CONTEXT)Context;
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    UNREFERENCED_PARAMETER(Record);
 
-        RtlSecureZeroMemory(&DeviceObject, sizeof(DeviceObject));
+    if (WalkContext == NULL)
+        return FALSE;
 
-        DeviceObjectAddress = (ULONG_PTR)ListEntry.Flink - FIELD_OFFSET(DEVICE_OBJECT, Queue);
+    if (DriverObject) {
 
         //
-        // Read DEVICE_OBJECT.
+        // Determinate address to display.
         //
-        if (!kdReadSystemMemoryEx(DeviceObjectAddress,
-            &DeviceObject,
-            sizeof(DeviceObject),
-            NULL))
-        {
-            break;
+        BaseAddress = (ULONG_PTR)DriverObject->DriverInit;
+        if (BaseAddress == 0) {
+            BaseAddress = (ULONG_PTR)DriverObject->DriverStart;
         }
 
-        //
-        // Additional info column default text.
-        //
-        lpType = TEXT("PDEVICE_OBJECT");
-        BaseAddress = DeviceObjectAddress;
-        bNeedFree = FALSE;
+        lpType = NULL;
 
         //
-        // Read DRIVER_OBJECT.
+        // Read DRIVER_OBJECT name.
         //
-        RtlSecureZeroMemory(&DriverObject, sizeof(DriverObject));
-        if (kdReadSystemMemoryEx((ULONG_PTR)DeviceObject.DriverObject,
-            &DriverObject,
-            sizeof(DriverObject),
-            NULL))
+        if (DriverObject->DriverName.Length &&
+            DriverObject->DriverName.MaximumLength &&
+            DriverObject->DriverName.Buffer)
         {
-            //
-            // Determinate address to display.
-            //
-            BaseAddress = (ULONG_PTR)DriverObject.DriverInit;
-            if (BaseAddress == 0) {
-                BaseAddress = (ULONG_PTR)DriverObject.DriverStart;
-            }
-
-            lpType = NULL;
-
-            //
-            // Read DRIVER_OBJECT name.
-            //
-            if (DriverObject.DriverName.Length &&
-                DriverObject.DriverName.MaximumLength &&
-                DriverObject.DriverName.Buffer)
-            {
-                lpType = (LPWSTR)supHeapAlloc((SIZE_T)DriverObject.DriverName.Length + sizeof(UNICODE_NULL));
-                if (lpType) {
-                    bNeedFree = TRUE;
-                    if (!kdReadSystemMemoryEx((ULONG_PTR)DriverObject.DriverName.Buffer,
-                        lpType,
-                        (ULONG)DriverObject.DriverName.Length,
-                        NULL))
-                    {
-                        supHeapFree(lpType);
-                        lpType = NULL;
-                        bNeedFree = FALSE;
-                    }
+            lpType = (LPWSTR)supHeapAlloc((SIZE_T)DriverObject->DriverName.Length + sizeof(UNICODE_NULL));
+            if (lpType) {
+                bNeedFree = TRUE;
+                if (!kdReadSystemMemoryEx((ULONG_PTR)DriverObject->DriverName.Buffer,
+                    lpType,
+                    (ULONG)DriverObject->DriverName.Length,
+                    NULL))
+                {
+                    supHeapFree(lpType);
+                    lpType = NULL;
+                    bNeedFree = FALSE;
                 }
             }
         }
+    }
 
-        AddEntryToList(TreeList,
-            RootItem,
-            BaseAddress,
-            lpType, //PDEVICE_OBJECT or DRIVER_OBJECT.DriverName
-            Modules);
+    AddEntryToList(WalkContext->Output,
+        BaseAddress,
+        lpType, //PDEVICE_OBJECT or DRIVER_OBJECT.DriverName
+        WalkContext->Modules);
 
-        if (bNeedFree)
-            supHeapFree(lpType);
+    if (bNeedFree)
+        supHeapFree(lpType);
 
-        //
-        // Next ListEntry.
-        //
-        NextEntry.Blink = NextEntry.Flink = NULL;
+    return TRUE;
+}
 
-        if (!kdReadSystemMemoryEx(
-            (ULONG_PTR)ListEntry.Flink,
-            &NextEntry,
-            sizeof(LIST_ENTRY),
-            NULL))
-        {
-            break;
-        }
+/*
+* DumpIoFileSystemCallbacks
+*
+* Purpose:
+*
+* Read Io File System related callback data from kernel and send it to output window.
+*
+*/
+OBEX_DISPLAYCALLBACK_ROUTINE(DumpIoFileSystemCallbacks)
+{
+    KDWALK_PARAMS Params;
+    CALLBACKS_WALK_CONTEXT WalkContext;
 
-        if (NextEntry.Flink == NULL)
-            break;
+    //
+    // Add callback root entry to the output.
+    //
+    if (!AddRootEntryToList(Output, CallbackType))
+        return;
 
-        ListEntry.Flink = NextEntry.Flink;
-    }
+    WalkContext.Output = Output;
+    WalkContext.Modules = Modules;
 
+    //
+    // Walk DEVICE_OBJECT queue, owner DRIVER_OBJECT of every device is read as tail.
+    //
+    RtlSecureZeroMemory(&Params, sizeof(Params));
+    Params.ListHead = KernelVariableAddress;
+    Params.LinkOffset = FIELD_OFFSET(DEVICE_OBJECT, Queue);
+    Params.RecordSize = sizeof(DEVICE_OBJECT);
+    Params.MaxCount = CALLBACKS_MAX_LIST_RECORDS;
+    Params.TailPointerOffset = FIELD_OFFSET(DEVICE_OBJECT, DriverObject);
+    Params.TailSize = sizeof(DRIVER_OBJECT);
+    Params.Callback = IoFileSystemWalkCallback;
+    Params.Context = &WalkContext;
+
+    kdWalkList(&Params, NULL);
 }
 
 /*
@@ -3255,8 +3264,6 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpIoFileSystemCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
 {
-    HTREEITEM RootItem;
-
     ULONG_PTR *CallbacksData;
 
     LPWSTR CallbackName;
@@ -3268,10 +3275,9 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
     BOOL bRevisionMarker;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
     if (g_NtBuildNumber <= NT_WIN7_SP1) {
@@ -3292,8 +3298,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
 
                     if (CallbacksData[i]) {
 
-                        AddEntryToList(TreeList,
-                            RootItem,
+                        AddEntryToList(Output,
                             CallbacksData[i],
                             CallbackName,
                             Modules);
@@ -3301,8 +3306,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
                     }
                     else {
 
-                        AddZeroEntryToList(TreeList,
-                            RootItem,
+                        AddZeroEntryToList(Output,
                             CallbacksData[i],
                             CallbackName);
 
@@ -3351,8 +3355,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
 
                     if (CallbacksData[i]) {
 
-                        AddEntryToList(TreeList,
-                            RootItem,
+                        AddEntryToList(Output,
                             CallbacksData[i],
                             CallbackName,
                             Modules);
@@ -3360,8 +3363,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
                     }
                     else {
 
-                        AddZeroEntryToList(TreeList,
-                            RootItem,
+                        AddZeroEntryToList(Output,
                             CallbacksData[i],
                             CallbackName);
 
@@ -3385,63 +3387,44 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpCiCallbacks)
 */
 OBEX_DISPLAYCALLBACK_ROUTINE(DumpExHostCallbacks)
 {
-    LIST_ENTRY ListEntry;
-
-    EX_HOST_ENTRY HostEntry;
+    PEX_HOST_ENTRY HostEntries, HostEntry;
 
-    ULONG_PTR ListHead = KernelVariableAddress;
     ULONG_PTR* HostTableDump;
-    ULONG NumberOfCallbacks, i;
-
-    HTREEITEM RootItem;
+    ULONG NumberOfCallbacks, i, j, Count = 0;
+    KDWALK_STATUS WalkStatus;
 
     //
-    // Add callback root entry to the treelist.
+    // Add callback root entry to the output.
     //
-    RootItem = AddRootEntryToList(TreeList, CallbackType);
-    if (RootItem == 0)
+    if (!AddRootEntryToList(Output, CallbackType))
         return;
 
-    ListEntry.Flink = ListEntry.Blink = NULL;
+    HostEntries = (PEX_HOST_ENTRY)ReadListRecords(KernelVariableAddress,
+        FIELD_OFFSET(EX_HOST_ENTRY, ListEntry),
+        sizeof(EX_HOST_ENTRY),
+        0,
+        &Count,
+        &WalkStatus);
 
-    //
-    // Read head.
-    //
-    if (!kdReadSystemMemoryEx(
-        ListHead,
-        &ListEntry,
-        sizeof(LIST_ENTRY),
-        NULL))
-    {
-        return;
-    }
+    ReportListWalkStatus(CallbackType, WalkStatus);
 
-    //
-    // Walk list entries.
-    //
-    while ((ULONG_PTR)ListEntry.Flink != ListHead) {
+    if (HostEntries == NULL)
+        return;
 
-        RtlSecureZeroMemory(&HostEntry, sizeof(HostEntry));
+    for (j = 0; j < Count; j++) {
 
-        if (!kdReadSystemMemoryEx((ULONG_PTR)ListEntry.Flink,
-            &HostEntry,
-            sizeof(HostEntry),
-            NULL))
-        {
-            break;
-        }
+        HostEntry = &HostEntries[j];
 
         //
         // Find not an empty host table.
         //
-        NumberOfCallbacks = HostEntry.HostParameters.HostInformation.FunctionCount;
+        NumberOfCallbacks = HostEntry->HostParameters.HostInformation.FunctionCount;
 
         if (NumberOfCallbacks) {
 
-            if (HostEntry.HostParameters.NotificationRoutine) {
-                AddEntryToList(TreeList,
-                    RootItem,
-                    (ULONG_PTR)HostEntry.HostParameters.NotificationRoutine,
+            if (HostEntry->HostParameters.NotificationRoutine) {
+                AddEntryToList(Output,
+                    (ULONG_PTR)HostEntry->HostParameters.NotificationRoutine,
                     L"NotificationRoutine",
                     Modules);
 
@@ -3454,7 +3437,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpExHostCallbacks)
             if (HostTableDump) {
 
                 if (kdReadSystemMemoryEx(
-                    (ULONG_PTR)HostEntry.FunctionTable,
+                    (ULONG_PTR)HostEntry->FunctionTable,
                     HostTableDump,
                     NumberOfCallbacks * sizeof(PVOID),
                     NULL))
@@ -3462,8 +3445,7 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpExHostCallbacks)
 
                     for (i = 0; i < NumberOfCallbacks; i++) {
                         if (HostTableDump[i]) {
-                            AddEntryToList(TreeList,
-                                RootItem,
+                            AddEntryToList(Output,
                                 (ULONG_PTR)HostTableDump[i],
                                 L"Callback",
                                 Modules);
@@ -3475,9 +3457,41 @@ OBEX_DISPLAYCALLBACK_ROUTINE(DumpExHostCallbacks)
                 supHeapFree(HostTableDump);
             }
         }
+    }
+
+    supHeapFree(HostEntries);
+}
+
+/*
+* QueryIopFsListHeadsFromCache
+*
+* Purpose:
+*
+* Restore all Io Fs list heads from resolver cache.
+*
+*/
+BOOL QueryIopFsListHeadsFromCache(
+    VOID
+)
+{
+    ULONG i;
+    ULONG_PTR ListHeads[4];
+    PULONG_PTR ListHeadRefs[4];
 
-        ListEntry.Flink = HostEntry.ListEntry.Flink;
+    ListHeadRefs[0] = &g_SystemCallbacks.IopCdRomFileSystemQueueHead;
+    ListHeadRefs[1] = &g_SystemCallbacks.IopDiskFileSystemQueueHead;
+    ListHeadRefs[2] = &g_SystemCallbacks.IopTapeFileSystemQueueHead;
+    ListHeadRefs[3] = &g_SystemCallbacks.IopNetworkFileSystemQueueHead;
+
+    for (i = 0; i < RTL_NUMBER_OF(ListHeadRefs); i++) {
+        if (!kdCacheLookupNtOsAddress(KdCacheIdFromCallbackRef(ListHeadRefs[i]), &ListHeads[i]))
+            return FALSE;
     }
+
+    for (i = 0; i < RTL_NUMBER_OF(ListHeadRefs); i++)
+        *ListHeadRefs[i] = ListHeads[i];
+
+    return TRUE;
 }
 
 /*
@@ -3502,13 +3516,25 @@ OBEX_QUERYCALLBACK_ROUTINE(QueryIopFsListsCallbacks)
             (g_SystemCallbacks.IopTapeFileSystemQueueHead == 0) ||
             (g_SystemCallbacks.IopNetworkFileSystemQueueHead == 0))
         {
-            if (!FindIopFileSystemQueueHeads(&g_SystemCallbacks.IopCdRomFileSystemQueueHead,
-                &g_SystemCallbacks.IopDiskFileSystemQueueHead,
-                &g_SystemCallbacks.IopTapeFileSystemQueueHead,
-                &g_SystemCallbacks.IopNetworkFileSystemQueueHead))
-            {
-                kdDebugPrint("Could not locate all Iop listheads\r\n");
-                return STATUS_NOT_FOUND;
+            if (!QueryIopFsListHeadsFromCache()) {
+
+                if (!FindIopFileSystemQueueHeads(&g_SystemCallbacks.IopCdRomFileSystemQueueHead,
+                    &g_SystemCallbacks.IopDiskFileSystemQueueHead,
+                    &g_SystemCallbacks.IopTapeFileSystemQueueHead,
+                    &g_SystemCallbacks.IopNetworkFileSystemQueueHead))
+                {
+                    kdDebugPrint("Could not locate all Iop listheads\r\n");
+                    return STATUS_NOT_FOUND;
+                }
+
+                kdCacheStoreNtOsAddress(KdCacheIdFromCallbackRef(&g_SystemCallbacks.IopCdRomFileSystemQueueHead),
+                    g_SystemCallbacks.IopCdRomFileSystemQueueHead);
+                kdCacheStoreNtOsAddress(KdCacheIdFromCallbackRef(&g_SystemCallbacks.IopDiskFileSystemQueueHead),
+                    g_SystemCallbacks.IopDiskFileSystemQueueHead);
+                kdCacheStoreNtOsAddress(KdCacheIdFromCallbackRef(&g_SystemCallbacks.IopTapeFileSystemQueueHead),
+                    g_SystemCallbacks.IopTapeFileSystemQueueHead);
+                kdCacheStoreNtOsAddress(KdCacheIdFromCallbackRef(&g_SystemCallbacks.IopNetworkFileSystemQueueHead),
+                    g_SystemCallbacks.IopNetworkFileSystemQueueHead);
             }
         }
 
@@ -3521,28 +3547,28 @@ OBEX_QUERYCALLBACK_ROUTINE(QueryIopFsListsCallbacks)
 
         if (g_SystemCallbacks.IopDiskFileSystemQueueHead) {
 
-            DisplayRoutine(TreeList,
+            DisplayRoutine(Output,
                 TEXT("IoDiskFs"),
                 g_SystemCallbacks.IopDiskFileSystemQueueHead,
                 Modules);
         }
         if (g_SystemCallbacks.IopCdRomFileSystemQueueHead) {
 
-            DisplayRoutine(TreeList,
+            DisplayRoutine(Output,
                 TEXT("IoCdRomFs"),
                 g_SystemCallbacks.IopCdRomFileSystemQueueHead,
                 Modules);
         }
         if (g_SystemCallbacks.IopNetworkFileSystemQueueHead) {
 
-            DisplayRoutine(TreeList,
+            DisplayRoutine(Output,
                 TEXT("IoNetworkFs"),
                 g_SystemCallbacks.IopNetworkFileSystemQueueHead,
                 Modules);
         }
         if (g_SystemCallbacks.IopTapeFileSystemQueueHead) {
 
-            DisplayRoutine(TreeList,
+            DisplayRoutine(Output,
                 TEXT("IoTapeFs"),
                 g_SystemCallbacks.IopTapeFileSystemQueueHead,
                 Modules);
@@ -3583,8 +3609,19 @@ OBEX_QUERYCALLBACK_ROUTINE(QueryCallbackGeneric)
 
         QueryAddress = *SystemCallbacksRef;
 
-        if (QueryAddress == 0)
-            QueryAddress = FindRoutine(QueryFlags);
+        if (QueryAddress == 0) {
+
+            if (!kdCacheLookupNtOsAddress(KdCacheIdFromCallbackRef(SystemCallbacksRef),
+                &QueryAddress))
+            {
+                QueryAddress = FindRoutine(QueryFlags);
+                if (QueryAddress) {
+                    kdCacheStoreNtOsAddress(KdCacheIdFromCallbackRef(SystemCallbacksRef),
+                        QueryAddress);
+                }
+            }
+
+        }
 
         *SystemCallbacksRef = QueryAddress;
 
@@ -3597,7 +3634,7 @@ OBEX_QUERYCALLBACK_ROUTINE(QueryCallbackGeneric)
     __try {
         if (QueryAddress) {
             DisplayRoutine(
-                TreeList,
+                Output,
                 CallbackType,
                 QueryAddress,
                 Modules);
@@ -3612,12 +3649,254 @@ OBEX_QUERYCALLBACK_ROUTINE(QueryCallbackGeneric)
     return STATUS_SUCCESS;
 }
 
+/*
+* CallbacksCacheFree
+*
+* Purpose:
+*
+* Release cached query results.
+*
+*/
+VOID CallbacksCacheFree(
+    VOID
+)
+{
+    ULONG i;
+
+    for (i = 0; i < RTL_NUMBER_OF(g_CallbacksCache.Arenas); i++)
+        arenaDestroy(g_CallbacksCache.Arenas[i]);
+
+    RtlSecureZeroMemory(&g_CallbacksCache, sizeof(g_CallbacksCache));
+}
+
+/*
+* CallbacksQueryComplete
+*
+* Purpose:
+*
+* Called by the last finished worker, mark cache valid and notify window if requested.
+*
+*/
+VOID CallbacksQueryComplete(
+    _In_ POBEX_CALLBACKS_CACHE Cache
+)
+{
+    HWND NotifyWindow;
+
+    if (Cache->Modules) {
+        supHeapFree(Cache->Modules);
+        Cache->Modules = NULL;
+    }
+
+    Cache->Valid = TRUE;
+    InterlockedExchange(&Cache->QueryPending, FALSE);
+
+    NotifyWindow = (HWND)InterlockedCompareExchangePointer((PVOID*)&Cache->NotifyWindow, NULL, NULL);
+    if (NotifyWindow)
+        PostMessage(NotifyWindow, WM_CALLBACKS_QUERY_COMPLETE, 0, 0);
+}
+
+/*
+* CallbacksQueryWorker
+*
+* Purpose:
+*
+* Thread pool work routine, takes next dispatch table entry until none left.
+*
+*/
+VOID CALLBACK CallbacksQueryWorker(
+    _Inout_opt_ PTP_CALLBACK_INSTANCE Instance,
+    _Inout_opt_ PVOID Context,
+    _Inout_opt_ PTP_WORK Work
+)
+{
+    ULONG i;
+    PARENA Arena = NULL;
+    POBEX_CALLBACKS_CACHE Cache = (POBEX_CALLBACKS_CACHE)Context;
+    POBEX_CALLBACK_OUTPUT Output;
+
+    UNREFERENCED_PARAMETER(Instance);
+    UNREFERENCED_PARAMETER(Work);
+
+    if (Cache == NULL)
+        return;
+
+    i = (ULONG)InterlockedIncrement(&Cache->NextArena) - 1;
+    if (i < RTL_NUMBER_OF(Cache->Arenas)) {
+        Arena = arenaCreate(0);
+        Cache->Arenas[i] = Arena;
+    }
+
+    for (;;) {
+
+        i = (ULONG)InterlockedIncrement(&Cache->NextEntry) - 1;
+        if (i >= RTL_NUMBER_OF(g_CallbacksDispatchTable))
+            break;
+
+        Output = &Cache->Output[i];
+        Output->Arena = Arena;
+
+        __try {
+            Output->QueryStatus = g_CallbacksDispatchTable[i].QueryRoutine(
+                g_CallbacksDispatchTable[i].QueryFlags,
+                g_CallbacksDispatchTable[i].DisplayRoutine,
+                g_CallbacksDispatchTable[i].FindRoutine,
+                g_CallbacksDispatchTable[i].CallbackType,
+                Output,
+                Cache->Modules,
+                g_CallbacksDispatchTable[i].SystemCallbacksRef);
+        }
+        __except (WOBJ_EXCEPTION_FILTER_LOG) {
+            Output->QueryStatus = GetExceptionCode();
+        }
+    }
+
+    if (InterlockedDecrement(&Cache->ActiveWorkers) == 0)
+        CallbacksQueryComplete(Cache);
+}
+
+/*
+* CallbacksQueryAll
+*
+* Purpose:
+*
+* Find and read all callback types using thread pool, results are saved to the cache.
+*
+* With NotifyWindow set routine does not wait, it returns STATUS_PENDING and
+* WM_CALLBACKS_QUERY_COMPLETE is posted to the window once cache is filled.
+*
+*/
+NTSTATUS CallbacksQueryAll(
+    _In_opt_ HWND NotifyWindow
+)
+{
+    ULONG i, cWorkers;
+    PTP_WORK Work;
+    SYSTEM_INFO SystemInfo;
+
+    //
+    // Query is already running, redirect its notification.
+    //
+    if (g_CallbacksCache.QueryPending) {
+
+        if (NotifyWindow == NULL)
+            return STATUS_DEVICE_BUSY;
+
+        InterlockedExchangePointer((PVOID*)&g_CallbacksCache.NotifyWindow, NotifyWindow);
+
+        //
+        // Query may have completed before window was set.
+        //
+        return (g_CallbacksCache.QueryPending) ? STATUS_PENDING : STATUS_SUCCESS;
+    }
+
+    CallbacksCacheFree();
+
+    g_CallbacksCache.Modules = (PRTL_PROCESS_MODULES)supGetSystemInfo(SystemModuleInformation, NULL);
+    if (g_CallbacksCache.Modules == NULL)
+        return STATUS_NO_MEMORY;
+
+    for (i = 0; i < RTL_NUMBER_OF(g_CallbacksDispatchTable); i++) {
+        g_CallbacksCache.Output[i].QueryStatus = STATUS_NOT_FOUND;
+    }
+
+    //
+    // Open driver device before workers start using it.
+    //
+    kdConnectDriver();
+
+    g_CallbacksCache.NotifyWindow = NotifyWindow;
+    g_CallbacksCache.QueryPending = TRUE;
+
+    Work = CreateThreadpoolWork(CallbacksQueryWorker, &g_CallbacksCache, NULL);
+    if (Work == NULL) {
+        //
+        // No thread pool, run everything in the current thread.
+        //
+        g_CallbacksCache.ActiveWorkers = 1;
+        CallbacksQueryWorker(NULL, &g_CallbacksCache, NULL);
+        return (NotifyWindow) ? STATUS_PENDING : STATUS_SUCCESS;
+    }
+
+    GetSystemInfo(&SystemInfo);
+    cWorkers = SystemInfo.dwNumberOfProcessors;
+    if (cWorkers > RTL_NUMBER_OF(g_CallbacksDispatchTable))
+        cWorkers = RTL_NUMBER_OF(g_CallbacksDispatchTable);
+    if (cWorkers == 0)
+        cWorkers = 1;
+
+    g_CallbacksCache.ActiveWorkers = (LONG)cWorkers;
+
+    for (i = 0; i < cWorkers; i++)
+        SubmitThreadpoolWork(Work);
+
+    //
+    // Asynchronous query, work object is released after outstanding callbacks complete.
+    //
+    if (NotifyWindow) {
+        CloseThreadpoolWork(Work);
+        return STATUS_PENDING;
+    }
+
+    WaitForThreadpoolWorkCallbacks(Work, FALSE);
+    CloseThreadpoolWork(Work);
+
+    return STATUS_SUCCESS;
+}
+
+/*
+* CallbacksEnumerate
+*
+* Purpose:
+*
+* Enumerate found callbacks without any output, query is done if there is no cached results.
+*
+*/
+BOOL CallbacksEnumerate(
+    _In_ PENUMERATE_CALLBACKS_CALLBACK Callback,
+    _In_opt_ PVOID Context
+)
+{
+    ULONG i;
+    LPCWSTR CallbackType;
+    POBEX_CALLBACK_RECORD Record;
+
+    if (g_kdctx.NtOsImageMap == NULL)
+        return FALSE;
+
+    if (g_CallbacksCache.Valid == FALSE) {
+        if (!NT_SUCCESS(CallbacksQueryAll(NULL)))
+            return FALSE;
+    }
+
+    for (i = 0; i < RTL_NUMBER_OF(g_CallbacksDispatchTable); i++) {
+
+        CallbackType = NULL;
+
+        for (Record = g_CallbacksCache.Output[i].Head; Record; Record = Record->Next) {
+
+            if (Record->Type == CallbackRecordRoot) {
+                CallbackType = Record->Text;
+                continue;
+            }
+
+            if ((CallbackType == NULL) || (Record->Type != CallbackRecordEntry))
+                continue;
+
+            if (Callback(CallbackType, Record->Address, Record->Text, Record->AdditionalInfo, Context))
+                return TRUE;
+        }
+    }
+
+    return TRUE;
+}
+
 /*
 * DisplayCallbacksList
 *
 * Purpose:
 *
-* Find callbacks pointers and list them to output window.
+* List cached callbacks to output window.
 *
 */
 VOID DisplayCallbacksList(
@@ -3626,36 +3905,20 @@ VOID DisplayCallbacksList(
 {
     NTSTATUS QueryStatus;
     ULONG i;
-    PRTL_PROCESS_MODULES Modules = NULL;
 
     WCHAR szText[200];
 
     __try {
 
-        Modules = (PRTL_PROCESS_MODULES)supGetSystemInfo(SystemModuleInformation, NULL);
-        if (Modules == NULL) {
-            MessageBox(hwndDlg, TEXT("Could not allocate memory for modules list."), NULL, MB_ICONERROR);
-            __leave;
-        }
-
-        if (g_kdctx.NtOsImageMap == NULL) {
-            MessageBox(hwndDlg, TEXT("Error, ntoskrnl image is not mapped."), NULL, MB_ICONERROR);
-            __leave;
-        }
-
         //
         // List callbacks.
         //
 
         for (i = 0; i < RTL_NUMBER_OF(g_CallbacksDispatchTable); i++) {
-            QueryStatus = g_CallbacksDispatchTable[i].QueryRoutine(
-                g_CallbacksDispatchTable[i].QueryFlags,
-                g_CallbacksDispatchTable[i].DisplayRoutine,
-                g_CallbacksDispatchTable[i].FindRoutine,
-                g_CallbacksDispatchTable[i].CallbackType,
-                TreeList,
-                Modules,
-                g_CallbacksDispatchTable[i].SystemCallbacksRef);
+
+            InsertOutputToList(TreeList, &g_CallbacksCache.Output[i]);
+
+            QueryStatus = g_CallbacksCache.Output[i].QueryStatus;
 
             if (!NT_SUCCESS(QueryStatus)) {
 
@@ -3691,8 +3954,6 @@ VOID DisplayCallbacksList(
 
         if (AbnormalTermination())
             supReportAbnormalTermination(__FUNCTIONW__);
-
-        if (Modules) supHeapFree(Modules);
     }
 
     SetFocus(TreeList);
@@ -3720,7 +3981,8 @@ VOID CallbacksDialogHandlePopupMenu(
     if (hMenu) {
         InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_OBJECT_COPY, T_COPYADDRESS);
         InsertMenu(hMenu, 1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
-        InsertMenu(hMenu, 2, MF_BYCOMMAND, ID_VIEW_REFRESH, T_VIEW_REFRESH);
+        InsertMenu(hMenu, 2, MF_BYCOMMAND, ID_VIEW_EXPORT, T_EXPORTLIST);
+        InsertMenu(hMenu, 3, MF_BYCOMMAND, ID_VIEW_REFRESH, T_VIEW_REFRESH);
 
         TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, pt1.x, pt1.y, 0, hwndDlg, NULL);
         DestroyMenu(hMenu);
@@ -3786,6 +4048,54 @@ VOID CallbacksDialogCopyAddress(
     }
 }
 
+/*
+* CallbacksDialogCloseBanner
+*
+* Purpose:
+*
+* Close load banner if shown.
+*
+*/
+VOID CallbacksDialogCloseBanner(
+    VOID
+)
+{
+    if (g_CallbacksBanner) {
+        SendMessage(g_CallbacksBanner, WM_CLOSE, 0, 0);
+        g_CallbacksBanner = NULL;
+    }
+}
+
+/*
+* CallbacksDialogQueryComplete
+*
+* Purpose:
+*
+* WM_CALLBACKS_QUERY_COMPLETE handler, output cached results.
+*
+*/
+VOID CallbacksDialogQueryComplete(
+    _In_ HWND hwndDlg,
+    _In_ EXTRASCONTEXT *pDlgContext
+)
+{
+    TRACE_SPAN Span;
+
+    CallbacksDialogCloseBanner();
+
+    if (g_CallbacksCache.Valid == FALSE)
+        return;
+
+    TRACE_BEGIN(Span, "CallbacksDialogQueryComplete");
+
+    TreeList_ClearTree(pDlgContext->TreeList);
+    g_CallbacksCount = 0;
+
+    DisplayCallbacksList(hwndDlg, pDlgContext->TreeList);
+
+    TRACE_END(Span);
+}
+
 /*
 * CallbackDialogContentRefresh
 *
@@ -3793,6 +4103,8 @@ VOID CallbacksDialogCopyAddress(
 *
 * Refresh callback list handler.
 *
+* Query runs in thread pool, list is filled on WM_CALLBACKS_QUERY_COMPLETE.
+*
 */
 VOID CallbackDialogContentRefresh(
     _In_  HWND hwndDlg,
@@ -3800,27 +4112,43 @@ VOID CallbackDialogContentRefresh(
     _In_ BOOL fResetContent
 )
 {
-#ifndef _DEBUG
-    HWND hwndBanner = supDisplayLoadBanner(hwndDlg,
-        TEXT("Processing callbacks list, please wait"));
-#endif
+    NTSTATUS Status;
 
-    __try {
+    if (g_kdctx.NtOsImageMap == NULL) {
+        MessageBox(hwndDlg, TEXT("Error, ntoskrnl image is not mapped."), NULL, MB_ICONERROR);
+        return;
+    }
 
-        SetCapture(hwndDlg);
+    //
+    // Explicit refresh, drop cached results unless query is still running.
+    //
+    if (fResetContent && g_CallbacksCache.QueryPending == FALSE) {
+        TreeList_ClearTree(pDlgContext->TreeList);
+        CallbacksCacheFree();
+    }
 
-        if (fResetContent) TreeList_ClearTree(pDlgContext->TreeList);
+    if (g_CallbacksCache.Valid) {
+        CallbacksDialogQueryComplete(hwndDlg, pDlgContext);
+        return;
+    }
 
-        g_CallbacksCount = 0;
+#ifndef _DEBUG
+    if (g_CallbacksBanner == NULL) {
+        g_CallbacksBanner = supDisplayLoadBanner(hwndDlg,
+            TEXT("Processing callbacks list, please wait"));
+    }
+#endif
 
-        DisplayCallbacksList(hwndDlg, pDlgContext->TreeList);
+    Status = CallbacksQueryAll(hwndDlg);
+    if (Status == STATUS_PENDING)
+        return;
 
+    if (NT_SUCCESS(Status)) {
+        CallbacksDialogQueryComplete(hwndDlg, pDlgContext);
     }
-    __finally {
-        ReleaseCapture();
-#ifndef _DEBUG
-        SendMessage(hwndBanner, WM_CLOSE, 0, 0);
-#endif
+    else {
+        CallbacksDialogCloseBanner();
+        supShowNtStatus(hwndDlg, TEXT("Could not query system callbacks, code 0x"), Status);
     }
 }
 
@@ -3862,12 +4190,24 @@ INT_PTR CALLBACK CallbacksDialogProc(
         }
         break;
 
+    case WM_CALLBACKS_QUERY_COMPLETE:
+        pDlgContext = (EXTRASCONTEXT*)GetProp(hwndDlg, T_DLGCONTEXT);
+        if (pDlgContext) {
+            CallbacksDialogQueryComplete(hwndDlg, pDlgContext);
+        }
+        break;
+
     case WM_CLOSE:
         pDlgContext = (EXTRASCONTEXT*)GetProp(hwndDlg, T_DLGCONTEXT);
         if (pDlgContext) {
             g_WinObj.AuxDialogs[wobjCallbacksDlgId] = NULL;
             supHeapFree(pDlgContext);
         }
+        //
+        // Query may still run, it must not notify destroyed window.
+        //
+        InterlockedCompareExchangePointer((PVOID*)&g_CallbacksCache.NotifyWindow, NULL, hwndDlg);
+        CallbacksDialogCloseBanner();
         return DestroyWindow(hwndDlg);
 
     case WM_COMMAND:
@@ -3882,6 +4222,12 @@ INT_PTR CALLBACK CallbacksDialogProc(
                 CallbacksDialogCopyAddress(pDlgContext->TreeList);
             }
             break;
+        case ID_VIEW_EXPORT:
+            pDlgContext = (EXTRASCONTEXT*)GetProp(hwndDlg, T_DLGCONTEXT);
+            if (pDlgContext) {
+                exportViewToFile(hwndDlg, pDlgContext->TreeList, ExportViewTreeList, TEXT("Callbacks"));
+            }
+            break;
         case ID_VIEW_REFRESH:
             pDlgContext = (EXTRASCONTEXT*)GetProp(hwndDlg, T_DLGCONTEXT);
             if (pDlgContext) {
@@ -19,5 +19,17 @@
 
 #pragma once
 
+// return true to stop enumeration
+typedef BOOL(CALLBACK *PENUMERATE_CALLBACKS_CALLBACK)(
+    _In_ LPCWSTR CallbackType,
+    _In_ ULONG_PTR Address,
+    _In_ LPCWSTR Module,
+    _In_opt_ LPCWSTR AdditionalInfo,
+    _In_opt_ PVOID Context);
+
+BOOL CallbacksEnumerate(
+    _In_ PENUMERATE_CALLBACKS_CALLBACK Callback,
+    _In_opt_ PVOID Context);
+
 VOID extrasCreateCallbacksDialog(
     _In_ HWND hwndParent);
@@ -34,13 +34,14 @@ VOID DrvHandlePopupMenu(
     POINT pt1;
     HMENU hMenu;
 
-    if (!kdConnectDriver())
-        return;
-
     if (GetCursorPos(&pt1)) {
         hMenu = CreatePopupMenu();
         if (hMenu) {
-            InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_OBJECT_COPY, T_DUMPDRIVER);
+            if (kdConnectDriver()) {
+                InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_OBJECT_COPY, T_DUMPDRIVER);
+                InsertMenu(hMenu, 1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
+            }
+            InsertMenu(hMenu, (UINT)-1, MF_BYPOSITION, ID_VIEW_EXPORT, T_EXPORTLIST);
             TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, pt1.x, pt1.y, 0, hwndDlg, NULL);
             DestroyMenu(hMenu);
         }
@@ -163,50 +164,30 @@ VOID DrvDumpDriver(
 
 
 /*
-* DrvDlgCompareFunc
+* DrvDlgGetSortKey
 *
 * Purpose:
 *
-* Drivers Dialog listview comparer function.
+* Drivers Dialog listview sort key type for column.
 *
 */
-INT CALLBACK DrvDlgCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
+LVSORT_KEY_TYPE CALLBACK DrvDlgGetSortKey(
+    _In_ LONG Column
 )
 {
-    INT nResult = 0;
-
-    switch (lParamSort) {
+    switch (Column) {
     case 0: //Load Order
     case 3: //Size
-        return supGetMaxOfTwoULongFromString(
-            DrvDlgContext.ListView,
-            lParam1,
-            lParam2,
-            lParamSort,
-            DrvDlgContext.bInverseSort);
+        return LvSortKeyULong;
 
     case 2: //Address
-        return supGetMaxOfTwoU64FromHex(
-            DrvDlgContext.ListView,
-            lParam1,
-            lParam2,
-            lParamSort,
-            DrvDlgContext.bInverseSort);
+        return LvSortKeyHex;
 
     case 1: //Name
     case 4: //Module
-        return supGetMaxCompareTwoFixedStrings(
-            DrvDlgContext.ListView,
-            lParam1,
-            lParam2,
-            lParamSort,
-            DrvDlgContext.bInverseSort);
+    default:
+        return LvSortKeyText;
     }
-
-    return nResult;
 }
 
 /*
@@ -229,6 +210,10 @@ VOID DrvListDrivers(
     RTL_PROCESS_MODULES* pModulesList = NULL;
     PRTL_PROCESS_MODULE_INFORMATION pModule;
 
+    TRACE_SPAN Span;
+
+    TRACE_BEGIN(Span, "DrvListDrivers");
+
     if (bRefresh)
         ListView_DeleteAllItems(DrvDlgContext.ListView);
 
@@ -314,7 +299,12 @@ VOID DrvListDrivers(
 
     if (pModulesList) supHeapFree(pModulesList);
 
-    ListView_SortItemsEx(DrvDlgContext.ListView, &DrvDlgCompareFunc, DrvDlgContext.lvColumnToSort);
+    lvSortItems(DrvDlgContext.ListView,
+        DrvDlgContext.lvColumnToSort,
+        DrvDlgGetSortKey(DrvDlgContext.lvColumnToSort),
+        DrvDlgContext.bInverseSort);
+
+    TRACE_END(Span);
 }
 
 /*
@@ -399,7 +389,7 @@ INT_PTR CALLBACK DriversDialogProc(
 
         return (INT_PTR)extrasDlgHandleNotify(nhdr,
             &DrvDlgContext,
-            &DrvDlgCompareFunc,
+            &DrvDlgGetSortKey,
             DriversHandleNotify,
             NULL);
 
@@ -421,6 +411,9 @@ INT_PTR CALLBACK DriversDialogProc(
         case ID_OBJECT_COPY:
             DrvDumpDriver();
             break;
+        case ID_VIEW_EXPORT:
+            exportViewToFile(hwndDlg, DrvDlgContext.ListView, ExportViewListView, TEXT("Drivers"));
+            break;
         case ID_VIEW_REFRESH:
             DrvListDrivers(TRUE);
             break;
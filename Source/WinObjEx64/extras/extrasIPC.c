@@ -542,35 +542,6 @@ VOID IpcDlgShowProperties(
     propContextDestroy(Context);
 }
 
-/*
-* IpcDlgCompareFunc
-*
-* Purpose:
-*
-* Ipc Dialog listview comparer function.
-*
-*/
-INT CALLBACK IpcDlgCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort //pointer to EXTRASCALLBACK
-)
-{
-    EXTRASCONTEXT* pDlgContext;
-    EXTRASCALLBACK* CallbackParam = (EXTRASCALLBACK*)lParamSort;
-
-    if (CallbackParam == NULL)
-        return 0;
-
-    pDlgContext = &IpcDlgContext[CallbackParam->Value];
-
-    return supListViewBaseComparer(pDlgContext->ListView,
-        pDlgContext->bInverseSort,
-        lParam1,
-        lParam2,
-        (LPARAM)CallbackParam->lParam);
-}
-
 /*
 * IpcDlgQueryInfo
 *
@@ -594,6 +565,9 @@ VOID IpcDlgQueryInfo(
     IO_STATUS_BLOCK             iost;
     LVITEM                      lvitem;
     INT                         c;
+    TRACE_SPAN                  Span;
+
+    TRACE_BEGIN(Span, "IpcDlgQueryInfo");
 
     __try {
 
@@ -660,6 +634,8 @@ VOID IpcDlgQueryInfo(
         if (hObject) {
             NtClose(hObject);
         }
+
+        TRACE_END_DETAIL(Span, lpObjectRoot);
     }
 }
 
@@ -681,7 +657,6 @@ BOOL IpcDlgHandleNotify(
     INT      item;
 
     EXTRASCONTEXT* pDlgContext;
-    EXTRASCALLBACK CallbackParam;
 
     if (nhdr == NULL)
         return FALSE;
@@ -698,9 +673,7 @@ BOOL IpcDlgHandleNotify(
     case LVN_COLUMNCLICK:
         pDlgContext->bInverseSort = !pDlgContext->bInverseSort;
 
-        CallbackParam.lParam = 0;
-        CallbackParam.Value = pDlgContext->DialogMode;
-        ListView_SortItemsEx(pDlgContext->ListView, &IpcDlgCompareFunc, (LPARAM)&CallbackParam);
+        lvSortItems(pDlgContext->ListView, 0, LvSortKeyText, pDlgContext->bInverseSort);
 
         RtlSecureZeroMemory(&col, sizeof(col));
         col.mask = LVCF_IMAGE;
@@ -816,8 +789,6 @@ VOID extrasCreateIpcDialog(
 
     EXTRASCONTEXT* pDlgContext;
 
-    EXTRASCALLBACK CallbackParam;
-
     switch (Mode) {
     case IpcModeMailSlots:
         dlgIndex = wobjIpcMailSlotsDlgId;
@@ -919,8 +890,6 @@ VOID extrasCreateIpcDialog(
 
         IpcDlgQueryInfo(lpObjectsRoot, pDlgContext->ListView);
 
-        CallbackParam.lParam = 0;
-        CallbackParam.Value = Mode;
-        ListView_SortItemsEx(pDlgContext->ListView, &IpcDlgCompareFunc, (LPARAM)&CallbackParam);
+        lvSortItems(pDlgContext->ListView, 0, LvSortKeyText, pDlgContext->bInverseSort);
     }
 }
@@ -66,8 +66,9 @@ VOID PNDlgShowObjectProperties(
 )
 {
     LPWSTR              lpType, lpName;
-    POBJREF             objRef = NULL;
+    LPARAM              entryIndex = 0;
 
+    OBJREF              objRef;
     OBJREFPNS           pnsInfo;
     PROP_NAMESPACE_INFO propNamespace;
     PROP_DIALOG_CREATE_SETTINGS propSettings;
@@ -82,13 +83,16 @@ VOID PNDlgShowObjectProperties(
         //
         //  Get ref to object, failure here is critical.
         //
-        if (!supGetListViewItemParam(PnDlgContext.ListView, iItem, (PVOID*)&objRef))
+        if (!supGetListViewItemParam(PnDlgContext.ListView, iItem, (PVOID*)&entryIndex))
             return;
 
-        RtlCopyMemory(&pnsInfo, &objRef->PrivateNamespace, sizeof(OBJREFPNS));
+        if (!ObCollectionGetEntry(&PNSCollection, (ULONG)entryIndex, &objRef))
+            return;
+
+        RtlCopyMemory(&pnsInfo, &objRef.PrivateNamespace, sizeof(OBJREFPNS));
         RtlSecureZeroMemory(&propNamespace, sizeof(propNamespace));
 
-        propNamespace.ObjectAddress = objRef->ObjectAddress;
+        propNamespace.ObjectAddress = objRef.ObjectAddress;
 
         //
         // Dump boundary descriptor, failure here is critical.
@@ -129,35 +133,21 @@ VOID PNDlgShowObjectProperties(
 }
 
 /*
-* PNListCompareFunc
+* PNListGetSortKey
 *
 * Purpose:
 *
-* Main window listview comparer function.
+* Private namespace listview sort key type for column.
 *
 */
-INT CALLBACK PNListCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
+LVSORT_KEY_TYPE PNListGetSortKey(
+    _In_ LONG Column
 )
 {
     //
     // Sort addresses.
     //
-    if (lParamSort == 2) {
-        return supGetMaxOfTwoU64FromHex(PnDlgContext.ListView,
-            lParam1,
-            lParam2,
-            lParamSort,
-            PnDlgContext.bInverseSort);
-    }
-
-    return supListViewBaseComparer(PnDlgContext.ListView,
-        PnDlgContext.bInverseSort,
-        lParam1,
-        lParam2,
-        lParamSort);
+    return (Column == 2) ? LvSortKeyHex : LvSortKeyText;
 }
 
 /*
@@ -191,7 +181,7 @@ BOOL CALLBACK PNDlgEnumerateCallback(
     lvItem.iItem = MAXINT;
     lvItem.iImage = ObManagerGetImageIndexByTypeIndex(ConvertedTypeIndex);
     lvItem.pszText = Entry->ObjectName;
-    lvItem.lParam = (LPARAM)Entry;
+    lvItem.lParam = (LPARAM)Entry->Index;
     lvItemIndex = ListView_InsertItem(PnDlgContext.ListView, &lvItem);
 
     //Type
@@ -232,6 +222,7 @@ BOOL PNDlgQueryInfo(
     HWND hwndBanner;
 #endif
     BOOL bResult = FALSE;
+    TRACE_SPAN Span;
 
     PNSNumberOfObjects = 0;
 
@@ -243,9 +234,11 @@ BOOL PNDlgQueryInfo(
     UNREFERENCED_PARAMETER(hwndDlg);
 #endif
 
+    TRACE_BEGIN(Span, "PNDlgQueryInfo");
+
     __try {
 
-        bResult = ObCollectionCreate(&PNSCollection, TRUE, FALSE);
+        bResult = ObCollectionCreate(&PNSCollection, TRUE);
         if (bResult) {
 
             bResult = ObCollectionEnumerate(
@@ -259,6 +252,7 @@ BOOL PNDlgQueryInfo(
 #ifndef _DEBUG
         SendMessage(hwndBanner, WM_CLOSE, 0, 0);
 #endif
+        TRACE_END(Span);
     }
 
     return bResult;
@@ -496,7 +490,8 @@ VOID PNDlgShowNamespaceInfo(
     NTSTATUS    ntStatus;
     LPARAM      nSid;
     ULONG_PTR   BoundaryDescriptorAddress = 0;
-    POBJREF     objRef = NULL;
+    LPARAM      entryIndex = 0;
+    OBJREF      objRef;
     OBJREFPNS   pnsInfo;
 
     POBJECT_BOUNDARY_DESCRIPTOR BoundaryDescriptor = NULL;
@@ -510,10 +505,13 @@ VOID PNDlgShowNamespaceInfo(
 
     __try {
 
-        if (!supGetListViewItemParam(PnDlgContext.ListView, iItem, (PVOID*)&objRef))
+        if (!supGetListViewItemParam(PnDlgContext.ListView, iItem, (PVOID*)&entryIndex))
+            return;
+
+        if (!ObCollectionGetEntry(&PNSCollection, (ULONG)entryIndex, &objRef))
             return;
 
-        RtlCopyMemory(&pnsInfo, &objRef->PrivateNamespace, sizeof(OBJREFPNS));
+        RtlCopyMemory(&pnsInfo, &objRef.PrivateNamespace, sizeof(OBJREFPNS));
 
         //
         // Boundary Descriptor Entries.
@@ -636,7 +634,10 @@ BOOL PNDlgHandleNotify(
 
             PnDlgContext.bInverseSort = !PnDlgContext.bInverseSort;
             PnDlgContext.lvColumnToSort = pListView->iSubItem;
-            ListView_SortItemsEx(PnDlgContext.ListView, &PNListCompareFunc, PnDlgContext.lvColumnToSort);
+            lvSortItems(PnDlgContext.ListView,
+                PnDlgContext.lvColumnToSort,
+                PNListGetSortKey(PnDlgContext.lvColumnToSort),
+                PnDlgContext.bInverseSort);
 
             nImageIndex = ImageList_GetImageCount(g_ListViewImages);
             if (PnDlgContext.bInverseSort)
@@ -723,7 +724,7 @@ VOID PNDialogShowInfo(
     }
 
     if (PNDlgQueryInfo(PnDlgContext.hwndDlg)) {
-        ListView_SortItemsEx(PnDlgContext.ListView, &PNListCompareFunc, 0);
+        lvSortItems(PnDlgContext.ListView, 0, LvSortKeyText, PnDlgContext.bInverseSort);
     }
     else {
         if (GetWindowRect(PnDlgContext.hwndDlg, &ChildWndData.Rect)) {
@@ -33,7 +33,12 @@ static int      y_splitter_pos = 300, y_capture_pos = 0, y_splitter_max = 0;
 
 HANDLE g_PsListWait = NULL;
 ULONG g_DialogQuit = 0, g_DialogRefresh = 0;
-HANDLE g_PsListHeap = NULL;
+PARENA g_PsListArena = NULL;
+
+//
+// Arena position after process entries, thread entries are allocated above it.
+//
+ARENA_MARK g_PsListThreadMark;
 
 LIST_ENTRY g_PsListHead;
 
@@ -58,8 +63,8 @@ PROP_UNNAMED_OBJECT_INFO* PsxAllocateUnnamedObjectEntry(
     if (Data == NULL)
         return NULL;
 
-    objectEntry = (PROP_UNNAMED_OBJECT_INFO*)RtlAllocateHeap(g_PsListHeap,
-        HEAP_ZERO_MEMORY, sizeof(PROP_UNNAMED_OBJECT_INFO));
+    objectEntry = (PROP_UNNAMED_OBJECT_INFO*)arenaAlloc(g_PsListArena,
+        sizeof(PROP_UNNAMED_OBJECT_INFO));
 
     if (objectEntry == NULL)
         return NULL;
@@ -71,8 +76,7 @@ PROP_UNNAMED_OBJECT_INFO* PsxAllocateUnnamedObjectEntry(
         objectEntry->ClientId.UniqueThread = NULL;
 
         objectEntry->ImageName.MaximumLength = processEntry->ImageName.MaximumLength;
-        objectEntry->ImageName.Buffer = (PWSTR)RtlAllocateHeap(g_PsListHeap,
-            HEAP_ZERO_MEMORY,
+        objectEntry->ImageName.Buffer = (PWSTR)arenaAlloc(g_PsListArena,
             objectEntry->ImageName.MaximumLength);
         if (objectEntry->ImageName.Buffer) {
             RtlCopyUnicodeString(&objectEntry->ImageName, &processEntry->ImageName);
@@ -167,6 +171,7 @@ VOID PsListHandlePopupMenu(
     _In_ HWND hwndDlg,
     _In_ LPPOINT point,
     _In_ UINT itemCopy,
+    _In_ UINT itemExport,
     _In_ UINT itemRefresh
 )
 {
@@ -176,7 +181,8 @@ VOID PsListHandlePopupMenu(
     if (hMenu) {
         InsertMenu(hMenu, 0, MF_BYCOMMAND, itemCopy, T_COPYOBJECT);
         InsertMenu(hMenu, 1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
-        InsertMenu(hMenu, 2, MF_BYCOMMAND, itemRefresh, T_VIEW_REFRESH);
+        InsertMenu(hMenu, 2, MF_BYCOMMAND, itemExport, T_EXPORTLIST);
+        InsertMenu(hMenu, 3, MF_BYCOMMAND, itemRefresh, T_VIEW_REFRESH);
         TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, point->x, point->y, 0, hwndDlg, NULL);
         DestroyMenu(hMenu);
     }
@@ -184,47 +190,47 @@ VOID PsListHandlePopupMenu(
 }
 
 /*
-* PsListCompareFunc
+* PsListGetSortKey
 *
 * Purpose:
 *
-* Dialog listview comparer function.
+* Thread listview sort key type for column.
 *
 */
-INT CALLBACK PsListCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
+LVSORT_KEY_TYPE PsListGetSortKey(
+    _In_ LONG Column
 )
 {
-    switch (lParamSort) {
+    switch (Column) {
     case 0: //TID
     case 1: //BasePriority
-        return supGetMaxOfTwoULongFromString(
-            PsDlgContext.ListView,
-            lParam1,
-            lParam2,
-            PsDlgContext.lvColumnToSort,
-            PsDlgContext.bInverseSort);
-    case 2: //string (fixed size)
-    case 5: //string (fixed size)
-        return supGetMaxCompareTwoFixedStrings(
-            PsDlgContext.ListView,
-            lParam1,
-            lParam2,
-            PsDlgContext.lvColumnToSort,
-            PsDlgContext.bInverseSort);
+        return LvSortKeyULong;
     case 3: //ethread (hex)
     case 4: //address (hex)
-        return supGetMaxOfTwoU64FromHex(
-            PsDlgContext.ListView,
-            lParam1,
-            lParam2,
-            PsDlgContext.lvColumnToSort,
-            PsDlgContext.bInverseSort);
+        return LvSortKeyHex;
+    case 2: //string (fixed size)
+    case 5: //string (fixed size)
+    default:
+        return LvSortKeyText;
     }
+}
 
-    return 0;
+/*
+* PsListSortThreads
+*
+* Purpose:
+*
+* Sort thread listview by selected column.
+*
+*/
+VOID PsListSortThreads(
+    VOID
+)
+{
+    lvSortItems(PsDlgContext.ListView,
+        PsDlgContext.lvColumnToSort,
+        PsListGetSortKey(PsDlgContext.lvColumnToSort),
+        PsDlgContext.bInverseSort);
 }
 
 /*
@@ -750,6 +756,10 @@ DWORD WINAPI CreateThreadListProc(
 
     DWORD dwWaitResult;
 
+    TRACE_SPAN Span;
+
+    TRACE_BEGIN(Span, "CreateThreadListProc");
+
     __try {
 
         dwWaitResult = WaitForSingleObject(g_PsListWait, INFINITE);
@@ -758,6 +768,7 @@ DWORD WINAPI CreateThreadListProc(
             supSetWaitCursor(TRUE);
 
             ListView_DeleteAllItems(PsDlgContext.ListView);
+            arenaResetToMark(g_PsListArena, &g_PsListThreadMark);
 
             UniqueProcessId = ObjectEntry->ClientId.UniqueProcess;
 
@@ -936,10 +947,7 @@ DWORD WINAPI CreateThreadListProc(
             }
             SendMessage(PsDlgContext.StatusBar, SB_SETTEXT, 2, (LPARAM)&szBuffer);
 
-            ListView_SortItemsEx(
-                PsDlgContext.ListView,
-                PsListCompareFunc,
-                PsDlgContext.lvColumnToSort);
+            PsListSortThreads();
 
         }
     }
@@ -958,6 +966,8 @@ DWORD WINAPI CreateThreadListProc(
         supSetWaitCursor(FALSE);
 
         ReleaseMutex(g_PsListWait);
+
+        TRACE_END(Span);
     }
 
     return 0;
@@ -997,9 +1007,13 @@ DWORD WINAPI CreateProcessListProc(
         PBYTE ListRef;
     } List;
 
+    TRACE_SPAN Span;
+
     ServicesList.Entries = NULL;
     ServicesList.NumberOfEntries = 0;
 
+    TRACE_BEGIN(Span, "CreateProcessListProc");
+
     __try {
         dwWaitResult = WaitForSingleObject(g_PsListWait, INFINITE);
         if (dwWaitResult == WAIT_OBJECT_0) {
@@ -1011,18 +1025,11 @@ DWORD WINAPI CreateProcessListProc(
             TreeList_ClearTree(PsDlgContext.TreeList);
             ListView_DeleteAllItems(PsDlgContext.ListView);
 
+            //
+            // Entries of previous snapshot are no longer referenced by views.
+            //
             if (bRefresh) {
-                RtlDestroyHeap(g_PsListHeap);
-                g_PsListHeap = RtlCreateHeap(HEAP_GROWABLE, NULL, 0, 0, NULL, NULL);
-                if (g_PsListHeap == NULL) {
-
-                    MessageBox(PsDlgContext.hwndDlg,
-                        TEXT("Could not allocate heap for process enumeration"),
-                        NULL,
-                        MB_ICONERROR);
-
-                    __leave;
-                }
+                arenaReset(g_PsListArena);
             }
 
             ServiceEnumType = SERVICE_WIN32 | SERVICE_INTERACTIVE_PROCESS;
@@ -1144,11 +1151,15 @@ DWORD WINAPI CreateProcessListProc(
         supHandlesFreeList(SortedHandleList);
         supPHLFree(&g_PsListHead, FALSE);
 
+        arenaMark(g_PsListArena, &g_PsListThreadMark);
+
         InterlockedDecrement((PLONG)&g_DialogRefresh);
 
         supSetWaitCursor(FALSE);
 
         ReleaseMutex(g_PsListWait);
+
+        TRACE_END(Span);
     }
     return 0;
 }
@@ -1237,7 +1248,7 @@ INT_PTR PsListHandleNotify(
             PsDlgContext.bInverseSort = !PsDlgContext.bInverseSort;
             PsDlgContext.lvColumnToSort = ((NMLISTVIEW*)lParam)->iSubItem;
 
-            ListView_SortItemsEx(PsDlgContext.ListView, &PsListCompareFunc, (LPARAM)PsDlgContext.lvColumnToSort);
+            PsListSortThreads();
 
             nImageIndex = ImageList_GetImageCount(g_ListViewImages);
             if (PsDlgContext.bInverseSort)
@@ -1349,7 +1360,7 @@ INT_PTR CALLBACK PsListDialogProc(
 
         if ((HWND)wParam == TreeListControl) {
             GetCursorPos((LPPOINT)&crc);
-            PsListHandlePopupMenu(hwndDlg, (LPPOINT)&crc, ID_OBJECT_COPY, ID_VIEW_REFRESH);
+            PsListHandlePopupMenu(hwndDlg, (LPPOINT)&crc, ID_OBJECT_COPY, ID_VIEW_EXPORT, ID_VIEW_REFRESH);
         }
 
         if ((HWND)wParam == PsDlgContext.ListView) {
@@ -1364,7 +1375,7 @@ INT_PTR CALLBACK PsListDialogProc(
             else
                 GetCursorPos((LPPOINT)&crc);
 
-            PsListHandlePopupMenu(hwndDlg, (LPPOINT)&crc, ID_OBJECT_COPY + 1, ID_VIEW_REFRESH + 1);
+            PsListHandlePopupMenu(hwndDlg, (LPPOINT)&crc, ID_OBJECT_COPY + 1, ID_VIEW_EXPORT + 1, ID_VIEW_REFRESH + 1);
         }
 
         break;
@@ -1388,6 +1399,12 @@ INT_PTR CALLBACK PsListDialogProc(
                 supCopyListViewSubItemValue(PsDlgContext.ListView, 3);
             }
             break;
+        case ID_VIEW_EXPORT:
+            exportViewToFile(hwndDlg, PsDlgContext.TreeList, ExportViewTreeList, TEXT("Processes"));
+            break;
+        case ID_VIEW_EXPORT + 1:
+            exportViewToFile(hwndDlg, PsDlgContext.ListView, ExportViewListView, TEXT("Threads"));
+            break;
         case ID_VIEW_REFRESH:
         case ID_VIEW_REFRESH + 1:
 
@@ -1464,9 +1481,9 @@ INT_PTR CALLBACK PsListDialogProc(
         DestroyWindow(PsDlgContext.TreeList);
         DestroyWindow(hwndDlg);
         g_WinObj.AuxDialogs[wobjPsListDlgId] = NULL;
-        if (g_PsListHeap) {
-            RtlDestroyHeap(g_PsListHeap);
-            g_PsListHeap = NULL;
+        if (g_PsListArena) {
+            arenaDestroy(g_PsListArena);
+            g_PsListArena = NULL;
         }
         return TRUE;
     }
@@ -1601,8 +1618,9 @@ VOID extrasCreatePsListDialog(
     g_DialogQuit = 0;
     g_DialogRefresh = 0;
     g_PsListWait = CreateMutex(NULL, FALSE, NULL);
-    g_PsListHeap = RtlCreateHeap(HEAP_GROWABLE, NULL, 0, 0, NULL, NULL);
-    if (g_PsListHeap) {
+    g_PsListArena = arenaCreate(0);
+    if (g_PsListArena) {
+        arenaMark(g_PsListArena, &g_PsListThreadMark);
         CreateObjectList(FALSE, NULL);
     }
 }
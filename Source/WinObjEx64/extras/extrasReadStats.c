@@ -0,0 +1,465 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       EXTRASREADSTATS.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include "extras.h"
+
+EXTRASCONTEXT RsDlgContext;
+
+//
+// Sites shown in the list, kept for export.
+//
+PKDSTATS_SITE RsSnapshot = NULL;
+ULONG RsSnapshotCount = 0;
+
+//
+// Export columns before latency histogram.
+//
+#define RS_FIXED_COLUMNS 8
+
+/*
+* RsHandlePopupMenu
+*
+* Purpose:
+*
+* Statistics list popup construction.
+*
+*/
+VOID RsHandlePopupMenu(
+    _In_ HWND hwndDlg
+)
+{
+    POINT pt1;
+    HMENU hMenu;
+
+    if (GetCursorPos(&pt1) == FALSE)
+        return;
+
+    hMenu = CreatePopupMenu();
+    if (hMenu) {
+        InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_OBJECT_COPY, T_SAVETOFILE);
+        InsertMenu(hMenu, 1, MF_BYCOMMAND, ID_VIEW_REFRESH, T_VIEW_REFRESH);
+        InsertMenu(hMenu, 2, MF_BYCOMMAND, ID_READSTATS_RESET, T_RESETSTATS);
+        TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, pt1.x, pt1.y, 0, hwndDlg, NULL);
+        DestroyMenu(hMenu);
+    }
+}
+
+/*
+* RsQuerySiteName
+*
+* Purpose:
+*
+* Build display name of the site, plugin sites are named by plugin module.
+*
+*/
+VOID RsQuerySiteName(
+    _In_ PKDSTATS_SITE Site,
+    _Out_writes_(cchBuffer) LPWSTR Buffer,
+    _In_ ULONG cchBuffer
+)
+{
+    ULONG cch;
+    WCHAR szModule[MAX_PATH + 1];
+
+    Buffer[0] = 0;
+
+    cch = MultiByteToWideChar(CP_ACP, 0, Site->Site, -1, Buffer, cchBuffer);
+    if (cch == 0)
+        return;
+
+    if (Site->Module == NULL)
+        return;
+
+    szModule[0] = 0;
+    if (GetModuleFileName((HMODULE)Site->Module, szModule, MAX_PATH) == 0)
+        return;
+
+    if (cch + 1 + _strlen(PathFindFileName(szModule)) < cchBuffer) {
+        _strcat(Buffer, TEXT(" "));
+        _strcat(Buffer, PathFindFileName(szModule));
+    }
+}
+
+/*
+* RsSaveListToFile
+*
+* Purpose:
+*
+* Export statistics including latency histograms as CSV file in UTF-8.
+*
+*/
+VOID RsSaveListToFile(
+    _In_ HWND hwndDlg
+)
+{
+    ULONG i, j;
+    PKDSTATS_SITE Site;
+    PEXPORT_WRITER Writer;
+    WCHAR szFileName[MAX_PATH + 1];
+    WCHAR szSite[MAX_PATH * 2];
+    WCHAR szBuckets[KDSTATS_HISTOGRAM_BUCKETS][32];
+    LPCWSTR ColumnNames[RS_FIXED_COLUMNS + KDSTATS_HISTOGRAM_BUCKETS] = {
+        TEXT("Site"), TEXT("Calls"), TEXT("Bytes"), TEXT("Failures"),
+        TEXT("TotalUs"), TEXT("AvgUs"), TEXT("P50Us"), TEXT("P99Us") };
+
+    if ((RsSnapshot == NULL) || (RsSnapshotCount == 0))
+        return;
+
+    RtlSecureZeroMemory(szFileName, sizeof(szFileName));
+    _strcpy(szFileName, TEXT("ReadStats.csv"));
+
+    if (!supSaveDialogExecute(hwndDlg, (LPWSTR)&szFileName, TEXT("CSV files\0*.csv\0\0")))
+        return;
+
+    Writer = exportCreate(szFileName, ExportFormatCsv);
+    if (Writer == NULL)
+        return;
+
+    supSetWaitCursor(TRUE);
+
+    for (j = 0; j < KDSTATS_HISTOGRAM_BUCKETS; j++) {
+        _strcpy(szBuckets[j], (j < KDSTATS_HISTOGRAM_BUCKETS - 1) ? TEXT("lt") : TEXT("ge"));
+        u64tostr(1ULL << ((j < KDSTATS_HISTOGRAM_BUCKETS - 1) ? j : j - 1), _strend(szBuckets[j]));
+        _strcat(szBuckets[j], TEXT("us"));
+        ColumnNames[RS_FIXED_COLUMNS + j] = szBuckets[j];
+    }
+
+    exportSetColumns(Writer, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+
+    for (i = 0; i < RsSnapshotCount; i++) {
+
+        Site = &RsSnapshot[i];
+
+        RsQuerySiteName(Site, szSite, RTL_NUMBER_OF(szSite));
+
+        exportWriteField(Writer, szSite);
+        exportWriteNumber(Writer, Site->Calls);
+        exportWriteNumber(Writer, Site->Bytes);
+        exportWriteNumber(Writer, Site->Failures);
+        exportWriteNumber(Writer, Site->TotalTime);
+        exportWriteNumber(Writer, Site->TotalTime / Site->Calls);
+        exportWriteNumber(Writer, kdStatsPercentile(Site, 50));
+        exportWriteNumber(Writer, kdStatsPercentile(Site, 99));
+
+        for (j = 0; j < KDSTATS_HISTOGRAM_BUCKETS; j++)
+            exportWriteNumber(Writer, Site->Histogram[j]);
+
+        exportEndRow(Writer);
+    }
+
+    exportClose(Writer);
+    supSetWaitCursor(FALSE);
+}
+
+/*
+* RsDlgGetSortKey
+*
+* Purpose:
+*
+* Statistics Dialog listview sort key type for column.
+*
+*/
+LVSORT_KEY_TYPE CALLBACK RsDlgGetSortKey(
+    _In_ LONG Column
+)
+{
+    return (Column == 0) ? LvSortKeyText : LvSortKeyLong;
+}
+
+/*
+* RsListStats
+*
+* Purpose:
+*
+* Query statistics and fill the list.
+*
+*/
+VOID RsListStats(
+    VOID
+)
+{
+    INT    lvItemIndex;
+    ULONG  i;
+    ULONG64 TotalCalls = 0, TotalBytes = 0;
+    LVITEM lvitem;
+    PKDSTATS_SITE Site;
+    WCHAR  szBuffer[MAX_PATH * 2];
+
+    ListView_DeleteAllItems(RsDlgContext.ListView);
+
+    if (RsSnapshot == NULL) {
+        RsSnapshot = (PKDSTATS_SITE)supHeapAlloc(KDSTATS_MAX_MERGED * sizeof(KDSTATS_SITE));
+        if (RsSnapshot == NULL)
+            return;
+    }
+
+    RsSnapshotCount = kdStatsQuery(RsSnapshot, KDSTATS_MAX_MERGED);
+
+    for (i = 0; i < RsSnapshotCount; i++) {
+
+        Site = &RsSnapshot[i];
+
+        TotalCalls += Site->Calls;
+        TotalBytes += Site->Bytes;
+
+        RtlSecureZeroMemory(&lvitem, sizeof(lvitem));
+
+        //Site
+        RsQuerySiteName(Site, szBuffer, RTL_NUMBER_OF(szBuffer));
+
+        lvitem.mask = LVIF_TEXT | LVIF_IMAGE;
+        lvitem.iItem = MAXINT;
+        lvitem.iImage = I_IMAGENONE;
+        lvitem.pszText = szBuffer;
+        lvItemIndex = ListView_InsertItem(RsDlgContext.ListView, &lvitem);
+
+        lvitem.mask = LVIF_TEXT;
+        lvitem.iItem = lvItemIndex;
+
+        //Calls
+        szBuffer[0] = 0;
+        u64tostr(Site->Calls, szBuffer);
+        lvitem.iSubItem = 1;
+        ListView_SetItem(RsDlgContext.ListView, &lvitem);
+
+        //Bytes
+        szBuffer[0] = 0;
+        u64tostr(Site->Bytes, szBuffer);
+        lvitem.iSubItem = 2;
+        ListView_SetItem(RsDlgContext.ListView, &lvitem);
+
+        //Failures
+        szBuffer[0] = 0;
+        u64tostr(Site->Failures, szBuffer);
+        lvitem.iSubItem = 3;
+        ListView_SetItem(RsDlgContext.ListView, &lvitem);
+
+        //Avg
+        szBuffer[0] = 0;
+        u64tostr(Site->TotalTime / Site->Calls, szBuffer);
+        lvitem.iSubItem = 4;
+        ListView_SetItem(RsDlgContext.ListView, &lvitem);
+
+        //P50
+        szBuffer[0] = 0;
+        u64tostr(kdStatsPercentile(Site, 50), szBuffer);
+        lvitem.iSubItem = 5;
+        ListView_SetItem(RsDlgContext.ListView, &lvitem);
+
+        //P99
+        szBuffer[0] = 0;
+        u64tostr(kdStatsPercentile(Site, 99), szBuffer);
+        lvitem.iSubItem = 6;
+        ListView_SetItem(RsDlgContext.ListView, &lvitem);
+    }
+
+    //
+    // Update status bar.
+    //
+    _strcpy(szBuffer, TEXT("Sites: "));
+    ultostr(RsSnapshotCount, _strend(szBuffer));
+    _strcat(szBuffer, TEXT(", Calls: "));
+    u64tostr(TotalCalls, _strend(szBuffer));
+    _strcat(szBuffer, TEXT(", Bytes: "));
+    u64tostr(TotalBytes, _strend(szBuffer));
+    SetWindowText(RsDlgContext.StatusBar, szBuffer);
+
+    lvSortItems(RsDlgContext.ListView,
+        RsDlgContext.lvColumnToSort,
+        RsDlgGetSortKey(RsDlgContext.lvColumnToSort),
+        RsDlgContext.bInverseSort);
+}
+
+/*
+* ReadStatsDialogProc
+*
+* Purpose:
+*
+* Kernel Read Statistics Dialog window procedure.
+*
+*/
+INT_PTR CALLBACK ReadStatsDialogProc(
+    _In_  HWND hwndDlg,
+    _In_  UINT uMsg,
+    _In_  WPARAM wParam,
+    _In_  LPARAM lParam
+)
+{
+    LPNMLISTVIEW nhdr = (LPNMLISTVIEW)lParam;
+
+    switch (uMsg) {
+
+    case WM_INITDIALOG:
+        supCenterWindow(hwndDlg);
+        break;
+
+    case WM_GETMINMAXINFO:
+        if (lParam) {
+            ((PMINMAXINFO)lParam)->ptMinTrackSize.x = 640;
+            ((PMINMAXINFO)lParam)->ptMinTrackSize.y = 480;
+        }
+        break;
+
+    case WM_NOTIFY:
+
+        return (INT_PTR)extrasDlgHandleNotify(nhdr,
+            &RsDlgContext,
+            &RsDlgGetSortKey,
+            NULL,
+            NULL);
+
+    case WM_SIZE:
+        extrasSimpleListResize(hwndDlg);
+        break;
+
+    case WM_CLOSE:
+        DestroyWindow(hwndDlg);
+        g_WinObj.AuxDialogs[wobjReadStatsDlgId] = NULL;
+        if (RsSnapshot) {
+            supHeapFree(RsSnapshot);
+            RsSnapshot = NULL;
+            RsSnapshotCount = 0;
+        }
+        break;
+
+    case WM_COMMAND:
+
+        switch (LOWORD(wParam)) {
+        case IDCANCEL:
+            SendMessage(hwndDlg, WM_CLOSE, 0, 0);
+            break;
+        case ID_OBJECT_COPY:
+            RsSaveListToFile(hwndDlg);
+            break;
+        case ID_READSTATS_RESET:
+            kdStatsReset();
+            RsListStats();
+            break;
+        case ID_VIEW_REFRESH:
+            RsListStats();
+            break;
+        default:
+            break;
+        }
+        break;
+
+    case WM_CONTEXTMENU:
+        RsHandlePopupMenu(hwndDlg);
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+* extrasCreateReadStatsDialog
+*
+* Purpose:
+*
+* Create and initialize Kernel Read Statistics Dialog.
+*
+*/
+VOID extrasCreateReadStatsDialog(
+    _In_ HWND hwndParent
+)
+{
+    //
+    // Allow only one dialog.
+    //
+    ENSURE_DIALOG_UNIQUE_WITH_RESTORE(g_WinObj.AuxDialogs[wobjReadStatsDlgId]);
+
+    RtlSecureZeroMemory(&RsDlgContext, sizeof(RsDlgContext));
+    RsDlgContext.hwndDlg = CreateDialogParam(g_WinObj.hInstance, MAKEINTRESOURCE(IDD_DIALOG_EXTRASLIST),
+        hwndParent, &ReadStatsDialogProc, 0);
+
+    if (RsDlgContext.hwndDlg == NULL)
+        return;
+
+    g_WinObj.AuxDialogs[wobjReadStatsDlgId] = RsDlgContext.hwndDlg;
+
+    SetWindowText(RsDlgContext.hwndDlg, TEXT("Kernel Read Statistics"));
+
+    RsDlgContext.StatusBar = GetDlgItem(RsDlgContext.hwndDlg, ID_EXTRASLIST_STATUSBAR);
+
+    extrasSetDlgIcon(RsDlgContext.hwndDlg);
+
+    RsDlgContext.ListView = GetDlgItem(RsDlgContext.hwndDlg, ID_EXTRASLIST);
+    if (RsDlgContext.ListView) {
+
+        //
+        // Set listview imagelist, style flags and theme.
+        //
+        ListView_SetImageList(RsDlgContext.ListView, g_ListViewImages, LVSIL_SMALL);
+        ListView_SetExtendedListViewStyle(RsDlgContext.ListView,
+            LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER | LVS_EX_GRIDLINES | LVS_EX_LABELTIP);
+
+        SetWindowTheme(RsDlgContext.ListView, TEXT("Explorer"), NULL);
+
+        //
+        // Add listview columns.
+        //
+
+        supAddListViewColumn(RsDlgContext.ListView, 0, 0, 0,
+            ImageList_GetImageCount(g_ListViewImages) - 1,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("Site"), 240);
+
+        supAddListViewColumn(RsDlgContext.ListView, 1, 1, 1,
+            I_IMAGENONE,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("Calls"), 80);
+
+        supAddListViewColumn(RsDlgContext.ListView, 2, 2, 2,
+            I_IMAGENONE,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("Bytes"), 100);
+
+        supAddListViewColumn(RsDlgContext.ListView, 3, 3, 3,
+            I_IMAGENONE,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("Failures"), 70);
+
+        supAddListViewColumn(RsDlgContext.ListView, 4, 4, 4,
+            I_IMAGENONE,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("Avg (us)"), 70);
+
+        supAddListViewColumn(RsDlgContext.ListView, 5, 5, 5,
+            I_IMAGENONE,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("P50 (us)"), 70);
+
+        supAddListViewColumn(RsDlgContext.ListView, 6, 6, 6,
+            I_IMAGENONE,
+            LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
+            TEXT("P99 (us)"), 70);
+
+        //
+        // Remember columns count.
+        //
+        RsDlgContext.lvColumnCount = READSTATS_COLUMN_COUNT;
+        RsDlgContext.lvColumnToSort = 1;
+        RsDlgContext.bInverseSort = TRUE;
+
+        RsListStats();
+        SendMessage(RsDlgContext.hwndDlg, WM_SIZE, 0, 0);
+        SetFocus(RsDlgContext.ListView);
+    }
+}
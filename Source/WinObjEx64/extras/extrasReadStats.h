@@ -0,0 +1,22 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       EXTRASREADSTATS.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Common header file for Kernel Read Statistics dialog.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+VOID extrasCreateReadStatsDialog(
+    _In_ HWND hwndParent);
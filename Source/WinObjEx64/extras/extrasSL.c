@@ -19,29 +19,6 @@
 
 UINT g_SLCacheImageIndex;
 
-/*
-* SLCacheListCompareFunc
-*
-* Purpose:
-*
-* Listview comparer function.
-*
-*/
-INT CALLBACK SLCacheListCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
-)
-{
-    EXTRASCONTEXT* pDlgContext = (EXTRASCONTEXT*)lParamSort;
-
-    return supListViewBaseComparer(pDlgContext->ListView,
-        pDlgContext->bInverseSort,
-        lParam1,
-        lParam2,
-        pDlgContext->lvColumnToSort);
-}
-
 /*
 * xxxSLCacheGetSelectedDescriptor
 *
@@ -296,7 +273,10 @@ BOOL SLCacheDialogHandleNotify(
 
                 pDlgContext->bInverseSort = !pDlgContext->bInverseSort;
                 pDlgContext->lvColumnToSort = pListView->iSubItem;
-                ListView_SortItemsEx(pDlgContext->ListView, &SLCacheListCompareFunc, pDlgContext);
+                lvSortItems(pDlgContext->ListView,
+                    pDlgContext->lvColumnToSort,
+                    LvSortKeyText,
+                    pDlgContext->bInverseSort);
 
                 nImageIndex = ImageList_GetImageCount(g_ListViewImages);
                 if (pDlgContext->bInverseSort)
@@ -480,6 +460,8 @@ VOID extrasCreateSLCacheDialog(
     ENUMCHILDWNDDATA ChildWndData;
     WCHAR szBuffer[100];
 
+    TRACE_SPAN Span;
+
     //
     // Allow only one dialog, if it already open - activate it.
     //
@@ -508,7 +490,9 @@ VOID extrasCreateSLCacheDialog(
     //
     // Read and enumerate cache.
     //
+    TRACE_BEGIN(Span, "supSLCacheRead");
     SLCacheData = supSLCacheRead();
+    TRACE_END(Span);
     if (SLCacheData) {
 
         //
@@ -552,7 +536,9 @@ VOID extrasCreateSLCacheDialog(
             g_SLCacheImageIndex = ObManagerGetImageIndexByTypeIndex(ObjectTypeToken);
 
             pDlgContext->Reserved = (ULONG_PTR)SLCacheData;
+            TRACE_BEGIN(Span, "supSLCacheEnumerate");
             supSLCacheEnumerate(SLCacheData, SLCacheEnumerateCallback, pDlgContext);
+            TRACE_END(Span);
 
             nCount = ListView_GetItemCount(pDlgContext->ListView);
             _strcpy(szBuffer, TEXT("SLCache, number of descriptors = "));
@@ -18,5 +18,8 @@
 *******************************************************************************/
 #pragma once
 
+LPWSTR xxxSLCacheGetDescriptorDataType(
+    _In_ SL_KMEM_CACHE_VALUE_DESCRIPTOR* CacheDescriptor);
+
 VOID extrasCreateSLCacheDialog(
     _In_ HWND hwndParent);
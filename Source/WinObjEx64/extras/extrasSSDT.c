@@ -31,55 +31,27 @@ VOID SdtListCreate(
     _In_ EXTRASCONTEXT* pDlgContext);
 
 /*
-* SdtDlgCompareFunc
+* SdtDlgGetSortKey
 *
 * Purpose:
 *
-* KiServiceTable/W32pServiceTable Dialog listview comparer function.
+* KiServiceTable/W32pServiceTable Dialog listview sort key type for column.
 *
 */
-INT CALLBACK SdtDlgCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort //pointer to EXTRASCALLBACK
+LVSORT_KEY_TYPE SdtDlgGetSortKey(
+    _In_ LONG Column
 )
 {
-    INT nResult = 0;
-
-    EXTRASCONTEXT* pDlgContext;
-    EXTRASCALLBACK* CallbackParam = (EXTRASCALLBACK*)lParamSort;
-
-    if (CallbackParam == NULL)
-        return 0;
-
-    pDlgContext = &SSTDlgContext[CallbackParam->Value];
-
-    switch (pDlgContext->lvColumnToSort) {
+    switch (Column) {
     case 0: //index
-        return supGetMaxOfTwoULongFromString(
-            pDlgContext->ListView,
-            lParam1,
-            lParam2,
-            pDlgContext->lvColumnToSort,
-            pDlgContext->bInverseSort);
+        return LvSortKeyULong;
     case 2: //address (hex)
-        return supGetMaxOfTwoU64FromHex(
-            pDlgContext->ListView,
-            lParam1,
-            lParam2,
-            pDlgContext->lvColumnToSort,
-            pDlgContext->bInverseSort);
+        return LvSortKeyHex;
     case 1: //string (fixed size)
     case 3: //string (fixed size)
-        return supGetMaxCompareTwoFixedStrings(
-            pDlgContext->ListView,
-            lParam1,
-            lParam2,
-            pDlgContext->lvColumnToSort,
-            pDlgContext->bInverseSort);
+    default:
+        return LvSortKeyText;
     }
-
-    return nResult;
 }
 
 /*
@@ -102,7 +74,7 @@ VOID SdtHandlePopupMenu(
 
     hMenu = CreatePopupMenu();
     if (hMenu) {
-        InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_OBJECT_COPY, T_SAVETOFILE);
+        InsertMenu(hMenu, 0, MF_BYCOMMAND, ID_VIEW_EXPORT, T_EXPORTLIST);
         InsertMenu(hMenu, 1, MF_BYCOMMAND, ID_VIEW_REFRESH, T_RESCAN);
         TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, pt1.x, pt1.y, 0, hwndDlg, NULL);
         DestroyMenu(hMenu);
@@ -129,74 +101,6 @@ VOID SdtFreeGlobals()
     }
 }
 
-/*
-* SdtSaveListToFile
-*
-* Purpose:
-*
-* Dump table to the selected file.
-*
-*/
-VOID SdtSaveListToFile(
-    _In_ HWND hwndDlg,
-    _In_ EXTRASCONTEXT* pDlgContext
-)
-{
-    WCHAR   ch;
-    INT	    row, subitem, numitems;
-    SIZE_T  sz, k, BufferSize = 0;
-    LPWSTR  pItem = NULL, pText = NULL;
-    HCURSOR hSaveCursor, hHourGlass;
-    WCHAR   szTempBuffer[MAX_PATH + 1];
-
-    RtlSecureZeroMemory(szTempBuffer, sizeof(szTempBuffer));
-
-    _strcpy(szTempBuffer, TEXT("List.txt"));
-    if (supSaveDialogExecute(hwndDlg, (LPWSTR)&szTempBuffer, TEXT("Text files\0*.txt\0\0"))) {
-
-        pText = (LPWSTR)supHeapAlloc(0x2000);
-        if (pText == NULL) return;
-
-        hHourGlass = LoadCursor(NULL, IDC_WAIT);
-
-        ch = (WCHAR)0xFEFF;
-        supWriteBufferToFile(szTempBuffer, &ch, sizeof(WCHAR), FALSE, FALSE);
-
-        SetCapture(hwndDlg);
-        hSaveCursor = SetCursor(hHourGlass);
-
-        numitems = ListView_GetItemCount(pDlgContext->ListView);
-        for (row = 0; row < numitems; row++) {
-
-            pText[0] = 0;
-            for (subitem = 0; subitem < pDlgContext->lvColumnCount; subitem++) {
-
-                sz = 0;
-                pItem = supGetItemText(pDlgContext->ListView, row, subitem, &sz);
-                if (pItem) {
-                    _strcat(pText, pItem);
-                    supHeapFree(pItem);
-                }
-                if (subitem == 1) {
-                    for (k = 100; k > sz / sizeof(WCHAR); k--) {
-                        _strcat(pText, TEXT(" "));
-                    }
-                }
-                else {
-                    _strcat(pText, TEXT("\t"));
-                }
-            }
-            _strcat(pText, L"\r\n");
-            BufferSize = _strlen(pText) * sizeof(WCHAR);
-            supWriteBufferToFile(szTempBuffer, pText, BufferSize, FALSE, TRUE);
-        }
-
-        SetCursor(hSaveCursor);
-        ReleaseCapture();
-        supHeapFree(pText);
-    }
-}
-
 /*
 * SdtDlgHandleNotify
 *
@@ -217,7 +121,6 @@ BOOL SdtDlgHandleNotify(
 
     EXTRASCONTEXT* pDlgContext;
 
-    EXTRASCALLBACK CallbackParam;
     WCHAR szBuffer[MAX_PATH + 1];
 
     if (pListView == NULL)
@@ -237,9 +140,10 @@ BOOL SdtDlgHandleNotify(
 
             pDlgContext->bInverseSort = !pDlgContext->bInverseSort;
             pDlgContext->lvColumnToSort = pListView->iSubItem;
-            CallbackParam.lParam = (LPARAM)pDlgContext->lvColumnToSort;
-            CallbackParam.Value = pDlgContext->DialogMode;
-            ListView_SortItemsEx(hwndListView, &SdtDlgCompareFunc, (LPARAM)&CallbackParam);
+            lvSortItems(pDlgContext->ListView,
+                pDlgContext->lvColumnToSort,
+                SdtDlgGetSortKey(pDlgContext->lvColumnToSort),
+                pDlgContext->bInverseSort);
 
             nImageIndex = ImageList_GetImageCount(g_ListViewImages);
             if (pDlgContext->bInverseSort)
@@ -346,10 +250,13 @@ INT_PTR CALLBACK SdtDialogProc(
             SendMessage(hwndDlg, WM_CLOSE, 0, 0);
             return TRUE;
 
-        case ID_OBJECT_COPY:
+        case ID_VIEW_EXPORT:
             pDlgContext = (EXTRASCONTEXT*)GetProp(hwndDlg, T_DLGCONTEXT);
             if (pDlgContext) {
-                SdtSaveListToFile(hwndDlg, pDlgContext);
+                exportViewToFile(hwndDlg,
+                    pDlgContext->ListView,
+                    ExportViewListView,
+                    (pDlgContext->DialogMode == SST_Win32k) ? TEXT("W32pServiceTable") : TEXT("KiServiceTable"));
             }
             return TRUE;
 
@@ -398,6 +305,7 @@ VOID SdtListOutputTable(
 
     LVITEM lvItem;
     WCHAR szBuffer[MAX_PATH + 1];
+    WCHAR szName[MAX_PATH + 1];
 
     LPWSTR lpBaseName, lpBaseLimit;
 
@@ -441,10 +349,14 @@ VOID SdtListOutputTable(
         lvItem.pszText = szBuffer;
         lvIndex = ListView_InsertItem(Context->ListView, &lvItem);
 
-        //Name
+        //Name, converted from table pool on output
+        szName[0] = 0;
+        MultiByteToWideChar(CP_ACP, 0, SdtTableEntry->Table[i].Name, -1, szName, MAX_PATH);
+        szName[MAX_PATH] = 0;
+
         lvItem.mask = LVIF_TEXT;
         lvItem.iSubItem = 1;
-        lvItem.pszText = (LPWSTR)SdtTableEntry->Table[i].Name;
+        lvItem.pszText = szName;
         lvItem.iItem = lvIndex;
         ListView_SetItem(Context->ListView, &lvItem);
 
@@ -489,6 +401,8 @@ VOID SdtListOutputTable(
 *
 * KiServiceTable dump routine.
 *
+* Service names are kept in narrow string pool placed right after table entries.
+*
 */
 BOOL SdtListCreateTable(
     VOID
@@ -496,18 +410,20 @@ BOOL SdtListCreateTable(
 {
     BOOL                    bResult = FALSE;
     ULONG                   EntrySize = 0;
-    SIZE_T                  memIO;
+    SIZE_T                  memIO, NamePoolSize, NameLength;
     PUTable                 TableDump = NULL;
+    PULONG                  ClaimedIds = NULL;
     PBYTE                   Module = NULL;
     PIMAGE_EXPORT_DIRECTORY ExportDirectory = NULL;
     PDWORD                  ExportNames, ExportFunctions;
     PWORD                   NameOrdinals;
+    LPSTR                   NamePool;
 
     PSERVICETABLEENTRY      ServiceEntry;
 
     CHAR* ServiceName;
     CHAR* FunctionAddress;
-    ULONG ServiceId, i, j;
+    ULONG ServiceId, ServiceLimit, NameCount, i, j;
 
     __try {
 
@@ -547,7 +463,20 @@ BOOL SdtListCreateTable(
             ExportFunctions = (PDWORD)((PBYTE)Module + ExportDirectory->AddressOfFunctions);
             NameOrdinals = (PWORD)((PBYTE)Module + ExportDirectory->AddressOfNameOrdinals);
 
-            memIO = sizeof(SERVICETABLEENTRY) * ExportDirectory->NumberOfNames;
+            //
+            // Count Zw stubs and size name pool.
+            //
+            NameCount = 0;
+            NamePoolSize = 0;
+            for (i = 0; i < ExportDirectory->NumberOfNames; i++) {
+                ServiceName = ((CHAR*)Module + ExportNames[i]);
+                if (*(USHORT*)ServiceName == 'wZ') {
+                    NamePoolSize += _strlen_a(ServiceName) + 1;
+                    NameCount += 1;
+                }
+            }
+
+            memIO = sizeof(SERVICETABLEENTRY) * NameCount + NamePoolSize;
 
             KiServiceTable.Table = (PSERVICETABLEENTRY)supHeapAlloc(memIO);
             if (KiServiceTable.Table == NULL)
@@ -555,10 +484,17 @@ BOOL SdtListCreateTable(
 
             KiServiceTable.Allocated = TRUE;
 
-            if (!supDumpSyscallTableConverted(
-                g_kdctx.KeServiceDescriptorTable.Base,
-                g_kdctx.KeServiceDescriptorTable.Limit,
-                &TableDump))
+            NamePool = (LPSTR)&KiServiceTable.Table[NameCount];
+
+            ServiceLimit = g_kdctx.KeServiceDescriptorTable.Limit;
+
+            ClaimedIds = (PULONG)supHeapAlloc(SDT_BITMAP_SIZE(ServiceLimit));
+
+            if ((ClaimedIds == NULL) ||
+                !supDumpSyscallTableConverted(
+                    g_kdctx.KeServiceDescriptorTable.Base,
+                    ServiceLimit,
+                    &TableDump))
             {
                 supHeapFree(KiServiceTable.Table);
                 KiServiceTable.Allocated = FALSE;
@@ -581,27 +517,26 @@ BOOL SdtListCreateTable(
 
                 if (*(USHORT*)ServiceName == 'wZ') {
 
-                    MultiByteToWideChar(
-                        CP_ACP,
-                        0,
-                        ServiceName,
-                        (INT)_strlen_a(ServiceName),
-                        KiServiceTable.Table[KiServiceTable.Limit].Name,
-                        MAX_PATH);
+                    ServiceEntry = &KiServiceTable.Table[KiServiceTable.Limit];
 
-                    //dirty hack
-                    KiServiceTable.Table[KiServiceTable.Limit].Name[0] = L'N';
-                    KiServiceTable.Table[KiServiceTable.Limit].Name[1] = L't';
+                    //
+                    // Remember name in pool, Zw prefix replaced with Nt.
+                    //
+                    NameLength = _strlen_a(ServiceName);
+                    RtlCopyMemory(NamePool, ServiceName, NameLength + 1);
+                    NamePool[0] = 'N';
+                    NamePool[1] = 't';
+                    ServiceEntry->Name = NamePool;
+                    NamePool += NameLength + 1;
 
                     FunctionAddress = (CHAR*)((CHAR*)Module + ExportFunctions[NameOrdinals[i]]);
-                    ServiceEntry = &KiServiceTable.Table[KiServiceTable.Limit];
 
                     if (*(UCHAR*)((UCHAR*)FunctionAddress + 3) == 0xB8) {
                         ServiceId = *(ULONG*)((UCHAR*)FunctionAddress + 4);
-                        if (ServiceId < g_kdctx.KeServiceDescriptorTable.Limit) {
+                        if (ServiceId < ServiceLimit) {
                             ServiceEntry->ServiceId = ServiceId;
                             ServiceEntry->Address = TableDump[ServiceId];
-                            TableDump[ServiceId] = 0;
+                            SDT_BITMAP_SET(ClaimedIds, ServiceId);
                         }
                         else {
                             kdDebugPrint(">>1 %s %lu\r\n", ServiceName, KiServiceTable.Limit);
@@ -618,22 +553,27 @@ BOOL SdtListCreateTable(
                 }//wZ
             }//for
 
+            //
+            // Give unclaimed service ids to undecoded stubs in order, single pass.
+            //
+            j = 0;
             for (i = 0; i < KiServiceTable.Limit; i++) {
+
                 ServiceEntry = &KiServiceTable.Table[i];
-                if (ServiceEntry->ServiceId == INVALID_SERVICE_ENTRY_ID) {
-                    for (j = 0; j < g_kdctx.KeServiceDescriptorTable.Limit; j++) {
-                        if (TableDump[j] != 0) {
-                            ServiceEntry->ServiceId = j;
-                            ServiceEntry->Address = TableDump[j];
-                            TableDump[j] = 0;
-                            break;
-                        }
-                    }
-                }
+                if (ServiceEntry->ServiceId != INVALID_SERVICE_ENTRY_ID)
+                    continue;
+
+                while ((j < ServiceLimit) && SDT_BITMAP_TEST(ClaimedIds, j))
+                    j++;
+
+                if (j >= ServiceLimit)
+                    break;
+
+                ServiceEntry->ServiceId = j;
+                ServiceEntry->Address = TableDump[j];
+                SDT_BITMAP_SET(ClaimedIds, j);
             }
 
-            supHeapFree(TableDump);
-            TableDump = NULL;
         }
 
         bResult = TRUE;
@@ -647,6 +587,10 @@ BOOL SdtListCreateTable(
         if (TableDump) {
             supHeapFree(TableDump);
         }
+
+        if (ClaimedIds) {
+            supHeapFree(ClaimedIds);
+        }
     }
 
     return bResult;
@@ -799,42 +743,220 @@ BOOLEAN ApiSetResolveWin32kTableEntry(
     return bResult;
 }
 
+//
+// Shadow table build cache.
+//
+// Modules, export lookups and apiset resolutions are remembered for the time
+// of single table build. Cache memory is taken from the enumeration heap,
+// name pointers refer to mapped images and stay valid until cache released.
+//
+#define SDT_CACHE_IMAGE_BUCKETS     64
+#define SDT_CACHE_EXPORT_BUCKETS    64
+#define SDT_CACHE_IAT_BUCKETS       1024
+
+typedef struct _SDT_CACHE_EXPORT {
+    struct _SDT_CACHE_EXPORT *Next;
+    ULONG Hash;
+    NTSTATUS Status;
+    LPCSTR Name;
+    RESOLVE_INFO Info;
+} SDT_CACHE_EXPORT, *PSDT_CACHE_EXPORT;
+
+typedef struct _SDT_CACHE_IMAGE {
+    struct _SDT_CACHE_IMAGE *Next;
+    ULONG Hash;
+    BOOLEAN LoadAttempted;
+    HMODULE DllModule;
+    PRTL_PROCESS_MODULE_INFORMATION KernelModule;
+    PSDT_CACHE_EXPORT Exports[SDT_CACHE_EXPORT_BUCKETS];
+    CHAR Name[ANYSIZE_ARRAY];
+} SDT_CACHE_IMAGE, *PSDT_CACHE_IMAGE;
+
+typedef struct _SDT_CACHE_IMPORT {
+    LPCSTR ModuleName;
+    BOOLEAN Resolved;
+    NTSTATUS Status;
+    PSDT_CACHE_IMAGE Image;
+} SDT_CACHE_IMPORT, *PSDT_CACHE_IMPORT;
+
+typedef struct _SDT_CACHE_IAT_SLOT {
+    struct _SDT_CACHE_IAT_SLOT *Next;
+    PVOID Slot;
+    LPCSTR FunctionName;
+    PSDT_CACHE_IMPORT Import;
+} SDT_CACHE_IAT_SLOT, *PSDT_CACHE_IAT_SLOT;
+
+typedef struct _SDT_SHADOW_CACHE {
+    HANDLE HeapHandle;
+    PRTL_PROCESS_MODULES Modules;
+    PNTLDR_APISET_CACHE ApiSetCache;
+    PSDT_CACHE_IMAGE Images[SDT_CACHE_IMAGE_BUCKETS];
+    PSDT_CACHE_IAT_SLOT IatSlots[SDT_CACHE_IAT_BUCKETS];
+} SDT_SHADOW_CACHE, *PSDT_SHADOW_CACHE;
+
 /*
-* ApiSetLoadResolvedModule
+* SdtpCacheHashA
 *
 * Purpose:
 *
-* Final apiset resolving and loading actual file.
+* Create sdbm hash for given ANSI string, optionally case insensitive.
+*
+*/
+ULONG SdtpCacheHashA(
+    _In_ LPCSTR String,
+    _In_ BOOLEAN IgnoreCase
+)
+{
+    ULONG hashValue = 0;
+
+    while (*String) {
+        hashValue = (hashValue * 65599) + (UCHAR)((IgnoreCase) ? locase_a(*String) : *String);
+        String++;
+    }
+
+    return hashValue;
+}
+
+/*
+* SdtpCacheQueryImage
+*
+* Purpose:
 *
-* Function return NTSTATUS value and sets ResolvedEntry parameter.
+* Find or create module cache entry, kernel module is looked up once on creation.
 *
 */
-_Success_(return == STATUS_SUCCESS)
-NTSTATUS ApiSetLoadResolvedModule(
-    _In_ PVOID ApiSetMap,
-    _In_ PUNICODE_STRING ApiSetToResolve,
-    _Inout_ PANSI_STRING ConvertedModuleName,
-    _Out_ HMODULE * DllModule
+PSDT_CACHE_IMAGE SdtpCacheQueryImage(
+    _In_ PSDT_SHADOW_CACHE Cache,
+    _In_ LPCSTR ModuleName
 )
 {
-    BOOL            ResolvedResult;
-    NTSTATUS        Status;
-    UNICODE_STRING  usResolvedModule;
+    ULONG Hash, Bucket;
+    SIZE_T Length;
+    PSDT_CACHE_IMAGE Image;
+
+    Hash = SdtpCacheHashA(ModuleName, TRUE);
+    Bucket = Hash & (SDT_CACHE_IMAGE_BUCKETS - 1);
 
-    if (DllModule == NULL)
-        return STATUS_INVALID_PARAMETER_2;
-    if (ConvertedModuleName == NULL)
-        return STATUS_INVALID_PARAMETER_3;
+    for (Image = Cache->Images[Bucket]; Image != NULL; Image = Image->Next) {
+        if (Image->Hash == Hash && _strcmpi_a(Image->Name, ModuleName) == 0)
+            return Image;
+    }
 
-    *DllModule = NULL;
+    Length = _strlen_a(ModuleName);
+
+    Image = (PSDT_CACHE_IMAGE)RtlAllocateHeap(Cache->HeapHandle,
+        HEAP_ZERO_MEMORY,
+        FIELD_OFFSET(SDT_CACHE_IMAGE, Name) + Length + 1);
+
+    if (Image == NULL)
+        return NULL;
+
+    _strncpy_a(Image->Name, Length + 1, ModuleName, Length);
+    Image->Hash = Hash;
+    Image->KernelModule = (PRTL_PROCESS_MODULE_INFORMATION)supFindModuleEntryByName(Cache->Modules,
+        ModuleName);
+
+    Image->Next = Cache->Images[Bucket];
+    Cache->Images[Bucket] = Image;
+
+    return Image;
+}
+
+/*
+* SdtpCacheLoadImage
+*
+* Purpose:
+*
+* Load module image on first use, failed load is not retried.
+*
+*/
+HMODULE SdtpCacheLoadImage(
+    _In_ PSDT_CACHE_IMAGE Image
+)
+{
+    if (Image->LoadAttempted == FALSE) {
+        Image->LoadAttempted = TRUE;
+        Image->DllModule = LoadLibraryExA(Image->Name, NULL, DONT_RESOLVE_DLL_REFERENCES);
+    }
+
+    return Image->DllModule;
+}
+
+/*
+* SdtpCacheGetProcAddress
+*
+* Purpose:
+*
+* Memoized NtRawGetProcAddress for loaded cache image.
+*
+*/
+NTSTATUS SdtpCacheGetProcAddress(
+    _In_ PSDT_SHADOW_CACHE Cache,
+    _In_ PSDT_CACHE_IMAGE Image,
+    _In_ LPCSTR ProcName,
+    _Out_ PRESOLVE_INFO Info
+)
+{
+    ULONG Hash, Bucket;
+    NTSTATUS Status;
+    PSDT_CACHE_EXPORT Export;
+
+    Hash = SdtpCacheHashA(ProcName, FALSE);
+    Bucket = Hash & (SDT_CACHE_EXPORT_BUCKETS - 1);
+
+    for (Export = Image->Exports[Bucket]; Export != NULL; Export = Export->Next) {
+        if (Export->Hash == Hash && _strcmp_a(Export->Name, ProcName) == 0) {
+            *Info = Export->Info;
+            return Export->Status;
+        }
+    }
+
+    RtlSecureZeroMemory(Info, sizeof(RESOLVE_INFO));
+    Status = NtRawGetProcAddress(Image->DllModule, ProcName, Info);
+
+    Export = (PSDT_CACHE_EXPORT)RtlAllocateHeap(Cache->HeapHandle,
+        HEAP_ZERO_MEMORY,
+        sizeof(SDT_CACHE_EXPORT));
+
+    if (Export) {
+        Export->Hash = Hash;
+        Export->Status = Status;
+        Export->Name = ProcName;
+        Export->Info = *Info;
+        Export->Next = Image->Exports[Bucket];
+        Image->Exports[Bucket] = Export;
+    }
+
+    return Status;
+}
+
+/*
+* SdtpCacheResolveApiSet
+*
+* Purpose:
+*
+* Resolve apiset through loader apiset cache, result is set to module cache entry.
+*
+*/
+NTSTATUS SdtpCacheResolveApiSet(
+    _In_ PSDT_SHADOW_CACHE Cache,
+    _In_ PUNICODE_STRING ApiSetToResolve,
+    _Out_ PSDT_CACHE_IMAGE* Image
+)
+{
+    BOOL ResolvedResult = FALSE;
+    NTSTATUS Status;
+    PSDT_CACHE_IMAGE ResolvedImage = NULL;
+    UNICODE_STRING usResolvedModule;
+    ANSI_STRING asResolvedModule;
+    CHAR szModuleName[MAX_PATH + 1];
 
-    ResolvedResult = FALSE;
     RtlInitEmptyUnicodeString(&usResolvedModule, NULL, 0);
 
     //
-    // Resolve ApiSet.
+    // Resolved name points to apiset schema and is not freed.
     //
-    Status = NtLdrApiSetResolveLibrary(ApiSetMap,
+    Status = NtLdrApiSetCacheResolve(Cache->ApiSetCache,
         ApiSetToResolve,
         NULL,
         &ResolvedResult,
@@ -843,20 +965,18 @@ NTSTATUS ApiSetLoadResolvedModule(
     if (NT_SUCCESS(Status)) {
 
         if (ResolvedResult) {
-            //
-            // ApiSet resolved, load result library.
-            //
-            *DllModule = LoadLibraryEx(usResolvedModule.Buffer, NULL, DONT_RESOLVE_DLL_REFERENCES);
 
             //
-            // Convert resolved name back to ANSI for module query.
+            // Convert resolved name to ANSI for module query.
             //
-            RtlUnicodeStringToAnsiString(ConvertedModuleName,
-                &usResolvedModule,
-                TRUE);
-
-            RtlFreeUnicodeString(&usResolvedModule);
-            Status = STATUS_SUCCESS;
+            RtlInitEmptyAnsiString(&asResolvedModule, szModuleName, MAX_PATH);
+            Status = RtlUnicodeStringToAnsiString(&asResolvedModule, &usResolvedModule, FALSE);
+            if (NT_SUCCESS(Status)) {
+                szModuleName[asResolvedModule.Length] = 0;
+                ResolvedImage = SdtpCacheQueryImage(Cache, szModuleName);
+                if (ResolvedImage == NULL)
+                    Status = STATUS_NO_MEMORY;
+            }
         }
     }
     else {
@@ -867,9 +987,188 @@ NTSTATUS ApiSetLoadResolvedModule(
             Status = STATUS_APISET_NOT_PRESENT;
     }
 
+    *Image = ResolvedImage;
     return Status;
 }
 
+/*
+* SdtpCacheResolveImport
+*
+* Purpose:
+*
+* Find module for win32k import descriptor, resolved once per descriptor.
+*
+*/
+NTSTATUS SdtpCacheResolveImport(
+    _In_ PSDT_SHADOW_CACHE Cache,
+    _In_ PSDT_CACHE_IMPORT Import,
+    _Out_ PSDT_CACHE_IMAGE* Image
+)
+{
+    BOOLEAN NeedApiSetResolve = (g_NtBuildNumber > 18885);
+    UNICODE_STRING usModuleName;
+
+    if (Import->Resolved == FALSE) {
+
+        Import->Resolved = TRUE;
+
+        if (NeedApiSetResolve) {
+
+            if (Cache->ApiSetCache == NULL) {
+                Import->Status = STATUS_INVALID_PARAMETER_3;
+            }
+            else if (RtlCreateUnicodeStringFromAsciiz(&usModuleName, (PSTR)Import->ModuleName)) {
+                Import->Status = SdtpCacheResolveApiSet(Cache, &usModuleName, &Import->Image);
+                RtlFreeUnicodeString(&usModuleName);
+            }
+            else {
+                Import->Status = STATUS_NO_MEMORY;
+            }
+
+        }
+        else {
+            //
+            // No ApiSet resolve required, load as usual.
+            //
+            Import->Image = SdtpCacheQueryImage(Cache, Import->ModuleName);
+            Import->Status = (Import->Image) ? STATUS_SUCCESS : STATUS_NO_MEMORY;
+        }
+    }
+
+    *Image = Import->Image;
+    return Import->Status;
+}
+
+/*
+* SdtpCacheBuildIatMap
+*
+* Purpose:
+*
+* Walk win32k import descriptors once and remember every IAT slot imported by name.
+*
+*/
+BOOL SdtpCacheBuildIatMap(
+    _In_ PSDT_SHADOW_CACHE Cache,
+    _In_ HMODULE MappedWin32k
+)
+{
+    ULONG Size = 0, Bucket;
+    ULONG_PTR* rname;
+    LPVOID* raddr;
+    PIMAGE_IMPORT_DESCRIPTOR impd;
+    PSDT_CACHE_IMPORT Import;
+    PSDT_CACHE_IAT_SLOT IatSlot;
+
+    impd = (PIMAGE_IMPORT_DESCRIPTOR)RtlImageDirectoryEntryToData(MappedWin32k,
+        TRUE,
+        IMAGE_DIRECTORY_ENTRY_IMPORT,
+        &Size);
+
+    //
+    // No imports, every lookup will fail.
+    //
+    if (impd == NULL)
+        return TRUE;
+
+    while (impd->Name != 0) {
+
+        Import = (PSDT_CACHE_IMPORT)RtlAllocateHeap(Cache->HeapHandle,
+            HEAP_ZERO_MEMORY,
+            sizeof(SDT_CACHE_IMPORT));
+
+        if (Import == NULL)
+            return FALSE;
+
+        Import->ModuleName = (LPCSTR)RtlOffsetToPointer(MappedWin32k, impd->Name);
+
+        raddr = (LPVOID*)RtlOffsetToPointer(MappedWin32k, impd->FirstThunk);
+        if (impd->OriginalFirstThunk == 0)
+            rname = (ULONG_PTR*)raddr;
+        else
+            rname = (ULONG_PTR*)RtlOffsetToPointer(MappedWin32k, impd->OriginalFirstThunk);
+
+        while (*rname != 0) {
+
+            if (((*rname) & IMAGE_ORDINAL_FLAG) == 0) {
+
+                IatSlot = (PSDT_CACHE_IAT_SLOT)RtlAllocateHeap(Cache->HeapHandle,
+                    HEAP_ZERO_MEMORY,
+                    sizeof(SDT_CACHE_IAT_SLOT));
+
+                if (IatSlot == NULL)
+                    return FALSE;
+
+                IatSlot->Slot = raddr;
+                IatSlot->FunctionName = (LPCSTR)&((PIMAGE_IMPORT_BY_NAME)RtlOffsetToPointer(MappedWin32k, *rname))->Name;
+                IatSlot->Import = Import;
+
+                Bucket = (ULONG)((ULONG_PTR)raddr / sizeof(LPVOID)) & (SDT_CACHE_IAT_BUCKETS - 1);
+                IatSlot->Next = Cache->IatSlots[Bucket];
+                Cache->IatSlots[Bucket] = IatSlot;
+            }
+
+            ++rname;
+            ++raddr;
+        }
+
+        ++impd;
+    }
+
+    return TRUE;
+}
+
+/*
+* SdtpCacheLookupIatSlot
+*
+* Purpose:
+*
+* Find import for given win32k IAT slot.
+*
+*/
+PSDT_CACHE_IAT_SLOT SdtpCacheLookupIatSlot(
+    _In_ PSDT_SHADOW_CACHE Cache,
+    _In_ PVOID Slot
+)
+{
+    ULONG Bucket;
+    PSDT_CACHE_IAT_SLOT IatSlot;
+
+    Bucket = (ULONG)((ULONG_PTR)Slot / sizeof(LPVOID)) & (SDT_CACHE_IAT_BUCKETS - 1);
+
+    for (IatSlot = Cache->IatSlots[Bucket]; IatSlot != NULL; IatSlot = IatSlot->Next) {
+        if (IatSlot->Slot == Slot)
+            return IatSlot;
+    }
+
+    return NULL;
+}
+
+/*
+* SdtpCacheRelease
+*
+* Purpose:
+*
+* Unload cached modules, cache memory is released with enumeration heap.
+*
+*/
+VOID SdtpCacheRelease(
+    _In_ PSDT_SHADOW_CACHE Cache
+)
+{
+    ULONG i;
+    PSDT_CACHE_IMAGE Image;
+
+    if (Cache->ApiSetCache)
+        NtLdrApiSetCacheDestroy(Cache->ApiSetCache);
+
+    for (i = 0; i < SDT_CACHE_IMAGE_BUCKETS; i++) {
+        for (Image = Cache->Images[i]; Image != NULL; Image = Image->Next) {
+            if (Image->DllModule)
+                FreeLibrary(Image->DllModule);
+        }
+    }
+}
+
 /*
 * SdtResolveServiceEntryModule
 *
@@ -877,40 +1176,38 @@ NTSTATUS ApiSetLoadResolvedModule(
 *
 * Find a module for shadow table entry by parsing apisets(if present) and/or forwarders (if present).
 *
-* Function return NTSTATUS value and sets ResolvedModule, ResolvedModuleName, FunctionName parameters.
+* Function return NTSTATUS value and sets ResolvedImage, FunctionName parameters.
+* ResolvedImage may be set on STATUS_DLL_NOT_FOUND for error reporting.
 *
 */
 _Success_(return == STATUS_SUCCESS)
 NTSTATUS SdtResolveServiceEntryModule(
+    _In_ PSDT_SHADOW_CACHE Cache,
     _In_ PBYTE FunctionPtr,
-    _In_ HMODULE MappedWin32k,
-    _In_opt_ PVOID ApiSetMap,
     _In_ ULONG_PTR Win32kApiSetTable,
     _In_ PWIN32_SHADOWTABLE ShadowTableEntry,
-    _Out_ HMODULE * ResolvedModule,
-    _Inout_ PANSI_STRING ResolvedModuleName,
+    _Out_ PSDT_CACHE_IMAGE * ResolvedImage,
     _Out_ LPCSTR * FunctionName
 )
 {
-    BOOLEAN         NeedApiSetResolve = (g_NtBuildNumber > 18885);
     BOOLEAN         Win32kApiSetTableExpected = (g_NtBuildNumber > 18935);
 
-    NTSTATUS        resultStatus = STATUS_UNSUCCESSFUL, resolveStatus;
-
-    HMODULE         DllModule = NULL;
+    NTSTATUS        resolveStatus;
 
     LONG32          JmpAddress;
     ULONG_PTR       ApiSetReference;
 
-    LPCSTR	        ModuleName;
-    UNICODE_STRING  usApiSetEntry, usModuleName;
+    UNICODE_STRING  usApiSetEntry;
 
     hde64s hs;
 
+    PSDT_CACHE_IMAGE          Image = NULL;
+    PSDT_CACHE_IAT_SLOT       IatSlot;
     PW32K_API_SET_TABLE_ENTRY Win32kApiSetEntry;
 
 
-    *ResolvedModule = NULL;
+    *ResolvedImage = NULL;
+    *FunctionName = NULL;
 
     hde64_disasm((void*)FunctionPtr, &hs);
     if (hs.flags & F_ERROR) {
@@ -922,7 +1219,7 @@ NTSTATUS SdtResolveServiceEntryModule(
         //
         // See if this is new Win32kApiSetTable adapter.
         //
-        if (Win32kApiSetTableExpected && ApiSetMap) {
+        if (Win32kApiSetTableExpected && Cache->ApiSetCache) {
 
             ApiSetReference = ApiSetExtractReferenceFromAdapter(FunctionPtr);
             if (ApiSetReference) {
@@ -937,86 +1234,36 @@ NTSTATUS SdtResolveServiceEntryModule(
 
                 RtlInitUnicodeString(&usApiSetEntry, Win32kApiSetEntry->Host->HostName);
 
-                resolveStatus = ApiSetLoadResolvedModule(
-                    ApiSetMap,
-                    &usApiSetEntry,
-                    ResolvedModuleName,
-                    &DllModule);
-
-                if (NT_SUCCESS(resolveStatus)) {
-                    if (DllModule) {
-                        *ResolvedModule = DllModule;
-                        *FunctionName = ShadowTableEntry->Name;
-                        return STATUS_SUCCESS;
-                    }
-                    else {
-                        return STATUS_DLL_NOT_FOUND;
-                    }
-                }
-                else {
+                resolveStatus = SdtpCacheResolveApiSet(Cache, &usApiSetEntry, &Image);
+                if (!NT_SUCCESS(resolveStatus))
                     return resolveStatus;
-                }
 
-            }
-            else {
-                resultStatus = STATUS_APISET_NOT_HOSTED;
+                *FunctionName = ShadowTableEntry->Name;
+                break;
             }
         }
 
         JmpAddress = *(PLONG32)(FunctionPtr + (hs.len - 4)); // retrieve the offset
         FunctionPtr = FunctionPtr + hs.len + JmpAddress; // hs.len -> length of jmp instruction
 
-        *FunctionName = NtRawIATEntryToImport(MappedWin32k, FunctionPtr, &ModuleName);
-        if (*FunctionName == NULL) {
-            resultStatus = STATUS_PROCEDURE_NOT_FOUND;
-            break;
-        }
-
-        //
-        // Convert module name to UNICODE.
-        //
-        if (RtlCreateUnicodeStringFromAsciiz(&usModuleName, (PSTR)ModuleName)) {
-
-            //
-            // Check whatever ApiSet resolving required.
-            //
-            if (NeedApiSetResolve) {
-
-                if (ApiSetMap) {
-                    resolveStatus = ApiSetLoadResolvedModule(
-                        ApiSetMap,
-                        &usModuleName,
-                        ResolvedModuleName,
-                        &DllModule);
-                }
-                else {
-                    resolveStatus = STATUS_INVALID_PARAMETER_3;
-                }
-
-                if (!NT_SUCCESS(resolveStatus)) {
-                    RtlFreeUnicodeString(&usModuleName);
-                    return resolveStatus;
-                }
+        IatSlot = SdtpCacheLookupIatSlot(Cache, FunctionPtr);
+        if (IatSlot == NULL)
+            return STATUS_PROCEDURE_NOT_FOUND;
 
-            }
-            else {
-                //
-                // No ApiSet resolve required, load as usual.
-                //
-                DllModule = LoadLibraryEx(usModuleName.Buffer, NULL, DONT_RESOLVE_DLL_REFERENCES);
-                RtlUnicodeStringToAnsiString(ResolvedModuleName, &usModuleName, TRUE);
-            }
+        *FunctionName = IatSlot->FunctionName;
 
-            RtlFreeUnicodeString(&usModuleName);
+        resolveStatus = SdtpCacheResolveImport(Cache, IatSlot->Import, &Image);
+        if (!NT_SUCCESS(resolveStatus))
+            return resolveStatus;
 
-            *ResolvedModule = DllModule;
-            resultStatus = (DllModule != NULL) ? STATUS_SUCCESS : STATUS_DLL_NOT_FOUND;
-        }
+    } while (FALSE);
 
+    if (Image == NULL)
+        return STATUS_DLL_NOT_FOUND;
 
-    } while (FALSE);
+    *ResolvedImage = Image;
 
-    return resultStatus;
+    return (SdtpCacheLoadImage(Image) != NULL) ? STATUS_SUCCESS : STATUS_DLL_NOT_FOUND;
 }
 
 VOID SdtListReportEvent(
@@ -1058,36 +1305,33 @@ BOOL SdtListCreateTableShadow(
     NTSTATUS    ntStatus;
     BOOL        bResult = FALSE;
     ULONG       w32u_limit, w32k_limit, c;
-    HMODULE     w32u = NULL, w32k = NULL, DllModule, forwdll;
+    HMODULE     w32u = NULL, w32k = NULL;
     PBYTE       fptr;
     PULONG      pServiceLimit, pServiceTable;
-    LPCSTR	    ModuleName, FunctionName, ForwarderDot, ForwarderFunctionName;
+    LPCSTR	    FunctionName, ForwarderDot, ForwarderFunctionName;
     HANDLE      EnumerationHeap = NULL;
     ULONG_PTR   Win32kBase = 0, kernelWin32kBase = 0;
 
     PSERVICETABLEENTRY  ServiceEntry;
     PWIN32_SHADOWTABLE  table, itable;
     RESOLVE_INFO        rfn;
+    SIZE_T              NamePoolSize, NameLength;
+    LPSTR               NamePool;
 
     ULONG_PTR                       Win32kApiSetTable = 0;
 
     PVOID                           ApiSetMap = NULL;
     ULONG                           ApiSetSchemaVersion = 0;
 
-    PRTL_PROCESS_MODULE_INFORMATION Module, ForwardModule;
-
-    LOAD_MODULE_ENTRY               LoadedModulesHead;
-    PLOAD_MODULE_ENTRY              ModuleEntry = NULL, PreviousEntry = NULL;
+    PRTL_PROCESS_MODULE_INFORMATION Module;
 
-    ANSI_STRING                     ResolvedModuleName;
+    PSDT_SHADOW_CACHE               Cache = NULL;
+    PSDT_CACHE_IMAGE                Image, ForwardImage;
 
     WCHAR szBuffer[MAX_PATH * 2];
     WCHAR szErrorBuffer[512];
     CHAR szForwarderModuleName[MAX_PATH];
 
-    LoadedModulesHead.Next = NULL;
-    LoadedModulesHead.hModule = NULL;
-
     *Status = STATUS_SUCCESS;
 
     __try {
@@ -1199,6 +1443,34 @@ BOOL SdtListCreateTableShadow(
                 }
             }
 
+            //
+            // Prepare module cache and win32k import map, imports are parsed once for all services.
+            //
+            Cache = (PSDT_SHADOW_CACHE)RtlAllocateHeap(EnumerationHeap,
+                HEAP_ZERO_MEMORY,
+                sizeof(SDT_SHADOW_CACHE));
+
+            if (Cache == NULL) {
+                *Status = ErrShadowMemAllocFail;
+                __leave;
+            }
+
+            Cache->HeapHandle = EnumerationHeap;
+            Cache->Modules = pModules;
+
+            if (ApiSetMap) {
+                Cache->ApiSetCache = NtLdrApiSetCacheCreate(EnumerationHeap, ApiSetMap, 0, FALSE);
+                if (Cache->ApiSetCache == NULL) {
+                    *Status = ErrShadowMemAllocFail;
+                    __leave;
+                }
+            }
+
+            if (!SdtpCacheBuildIatMap(Cache, w32k)) {
+                *Status = ErrShadowMemAllocFail;
+                __leave;
+            }
+
             //
             // Set global variables.
             //
@@ -1216,208 +1488,175 @@ BOOL SdtListCreateTableShadow(
             //
             pServiceTable = (PULONG)rfn.Function;
 
-            for (c = 0; c < w32k_limit; ++c) {
-
-                itable = table;
-                while (itable != 0) {
-
-                    if (itable->Index == c + 0x1000) {
-
-                        itable->KernelStubAddress = pServiceTable[c];
-                        fptr = (PBYTE)w32k + itable->KernelStubAddress;
-                        itable->KernelStubAddress += Win32kBase;
-
-                        DllModule = NULL;
-                        RtlSecureZeroMemory(&ResolvedModuleName, sizeof(ResolvedModuleName));
-
-                        ntStatus = SdtResolveServiceEntryModule(fptr,
-                            w32k,
-                            ApiSetMap,
-                            Win32kApiSetTable,
-                            itable,
-                            &DllModule,
-                            &ResolvedModuleName,
-                            &FunctionName);
-
-                        if (!NT_SUCCESS(ntStatus)) {
-
-                            RtlSecureZeroMemory(szErrorBuffer, sizeof(szErrorBuffer));
-
-                            //
-                            // Most of this errors are not critical and ok.
-                            //
-
-                            switch (ntStatus) {
+            //
+            // Each service index is unique, visit table entries once.
+            //
+            for (itable = table; itable != NULL; itable = itable->NextService) {
 
-                            case STATUS_INTERNAL_ERROR:
-                                SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, TEXT("HDE Error"));
-                                break;
+                c = itable->Index - 0x1000;
+                if ((itable->Index < 0x1000) || (c >= w32k_limit))
+                    continue;
 
-                            case STATUS_APISET_NOT_HOSTED:
-                                //
-                                // Corresponding apiset not found.
-                                //
-                                _strcpy(szErrorBuffer, TEXT("not an apiset adapter for "));
-                                MultiByteToWideChar(CP_ACP, 0, itable->Name, -1, _strend(szErrorBuffer), MAX_PATH);
-                                SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, szErrorBuffer);
-                                break;
+                itable->KernelStubAddress = pServiceTable[c];
+                fptr = (PBYTE)w32k + itable->KernelStubAddress;
+                itable->KernelStubAddress += Win32kBase;
 
-                            case STATUS_APISET_NOT_PRESENT:
-                                //
-                                // ApiSet extension present but empty.
-                                // 
-                                _strcpy(szErrorBuffer, TEXT("extension contains a host for a non-existent apiset "));
-                                MultiByteToWideChar(CP_ACP, 0, itable->Name, -1, _strend(szErrorBuffer), MAX_PATH);
-                                SdtListReportEvent(WOBJ_LOG_ENTRY_INFORMATION, __FUNCTIONW__, szErrorBuffer);
-                                break;
-
-                            case STATUS_PROCEDURE_NOT_FOUND:
-                                //
-                                // Not a critical issue. This mean we cannot pass this service next to forwarder lookup code.
-                                //
-                                _strcpy(szErrorBuffer, TEXT("could not resolve function name in module for service id "));
-                                ultostr(itable->Index, _strend(szErrorBuffer));
-                                _strcat(szErrorBuffer, TEXT(", service name "));
-                                MultiByteToWideChar(CP_ACP, 0, itable->Name, -1, _strend(szErrorBuffer), MAX_PATH);
-                                SdtListReportEvent(WOBJ_LOG_ENTRY_INFORMATION, __FUNCTIONW__, szErrorBuffer);
-                                break;
+                Image = NULL;
 
-                            case STATUS_DLL_NOT_FOUND:
+                ntStatus = SdtResolveServiceEntryModule(Cache,
+                    fptr,
+                    Win32kApiSetTable,
+                    itable,
+                    &Image,
+                    &FunctionName);
 
-                                _strcpy(szErrorBuffer, TEXT("could not load import dll "));
+                if (!NT_SUCCESS(ntStatus)) {
 
-                                MultiByteToWideChar(CP_ACP,
-                                    0,
-                                    ResolvedModuleName.Buffer,
-                                    ResolvedModuleName.Length,
-                                    _strend(szErrorBuffer),
-                                    MAX_PATH);
+                    RtlSecureZeroMemory(szErrorBuffer, sizeof(szErrorBuffer));
 
-                                SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, szErrorBuffer);
-                                break;
+                    //
+                    // Most of this errors are not critical and ok.
+                    //
 
-                            default:
-                                break;
-                            }
+                    switch (ntStatus) {
 
-                            break;
-                        }
+                    case STATUS_INTERNAL_ERROR:
+                        SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, TEXT("HDE Error"));
+                        break;
 
-                        if (DllModule == NULL) {
-                            break;
-                        }
+                    case STATUS_APISET_NOT_HOSTED:
+                        //
+                        // Corresponding apiset not found.
+                        //
+                        _strcpy(szErrorBuffer, TEXT("not an apiset adapter for "));
+                        MultiByteToWideChar(CP_ACP, 0, itable->Name, -1, _strend(szErrorBuffer), MAX_PATH);
+                        SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, szErrorBuffer);
+                        break;
 
-                        ModuleName = ResolvedModuleName.Buffer;
+                    case STATUS_APISET_NOT_PRESENT:
+                        //
+                        // ApiSet extension present but empty.
+                        // 
+                        _strcpy(szErrorBuffer, TEXT("extension contains a host for a non-existent apiset "));
+                        MultiByteToWideChar(CP_ACP, 0, itable->Name, -1, _strend(szErrorBuffer), MAX_PATH);
+                        SdtListReportEvent(WOBJ_LOG_ENTRY_INFORMATION, __FUNCTIONW__, szErrorBuffer);
+                        break;
 
+                    case STATUS_PROCEDURE_NOT_FOUND:
                         //
-                        // Rememeber loaded module to the internal list.
+                        // Not a critical issue. This mean we cannot pass this service next to forwarder lookup code.
                         //
-                        ModuleEntry = (PLOAD_MODULE_ENTRY)RtlAllocateHeap(EnumerationHeap,
-                            HEAP_ZERO_MEMORY,
-                            sizeof(LOAD_MODULE_ENTRY));
-
-                        if (ModuleEntry) {
-                            ModuleEntry->Next = LoadedModulesHead.Next;
-                            ModuleEntry->hModule = DllModule;
-                            LoadedModulesHead.Next = ModuleEntry;
-                        }
+                        _strcpy(szErrorBuffer, TEXT("could not resolve function name in module for service id "));
+                        ultostr(itable->Index, _strend(szErrorBuffer));
+                        _strcat(szErrorBuffer, TEXT(", service name "));
+                        MultiByteToWideChar(CP_ACP, 0, itable->Name, -1, _strend(szErrorBuffer), MAX_PATH);
+                        SdtListReportEvent(WOBJ_LOG_ENTRY_INFORMATION, __FUNCTIONW__, szErrorBuffer);
+                        break;
 
-                        if (!NT_SUCCESS(NtRawGetProcAddress(DllModule, FunctionName, &rfn))) {
-                            //
-                            // Log error.
-                            //
-                            _strcpy(szErrorBuffer, TEXT("could not resolve function "));
-                            MultiByteToWideChar(CP_ACP, 0, FunctionName, -1, _strend(szErrorBuffer), MAX_PATH);
-                            _strcat(szErrorBuffer, TEXT(" address"));
-                            SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, szErrorBuffer);
-                            break;
-                        }
+                    case STATUS_DLL_NOT_FOUND:
 
-                        if (rfn.ResultType == ForwarderString) {
+                        _strcpy(szErrorBuffer, TEXT("could not load import dll "));
 
-                            ForwarderDot = _strchr_a(rfn.ForwarderName, '.');
-                            ForwarderFunctionName = ForwarderDot + 1;
+                        if (Image) {
+                            MultiByteToWideChar(CP_ACP,
+                                0,
+                                Image->Name,
+                                -1,
+                                _strend(szErrorBuffer),
+                                MAX_PATH);
+                        }
 
-                            //
-                            // Build forwarder module name.
-                            //
-                            RtlSecureZeroMemory(szForwarderModuleName, sizeof(szForwarderModuleName));
-                            _strncpy_a(szForwarderModuleName, sizeof(szForwarderModuleName),
-                                rfn.ForwarderName, ForwarderDot - &rfn.ForwarderName[0]);
+                        SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, szErrorBuffer);
+                        break;
 
-                            _strcat_a(szForwarderModuleName, ".SYS");
+                    default:
+                        break;
+                    }
 
-                            ForwardModule = (PRTL_PROCESS_MODULE_INFORMATION)supFindModuleEntryByName(pModules,
-                                szForwarderModuleName);
+                    continue;
+                }
 
-                            if (ForwardModule) {
+                if (!NT_SUCCESS(SdtpCacheGetProcAddress(Cache, Image, FunctionName, &rfn))) {
+                    //
+                    // Log error.
+                    //
+                    _strcpy(szErrorBuffer, TEXT("could not resolve function "));
+                    MultiByteToWideChar(CP_ACP, 0, FunctionName, -1, _strend(szErrorBuffer), MAX_PATH);
+                    _strcat(szErrorBuffer, TEXT(" address"));
+                    SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, szErrorBuffer);
+                    continue;
+                }
 
-                                if (ForwarderFunctionName) {
+                if (rfn.ResultType == ForwarderString) {
 
-                                    forwdll = LoadLibraryExA(szForwarderModuleName, NULL, DONT_RESOLVE_DLL_REFERENCES);
-                                    if (forwdll) {
+                    ForwarderDot = _strchr_a(rfn.ForwarderName, '.');
+                    if (ForwarderDot == NULL)
+                        continue;
 
-                                        //
-                                        // Remember loaded module to the internal list.
-                                        //
-                                        ModuleEntry = (PLOAD_MODULE_ENTRY)RtlAllocateHeap(EnumerationHeap,
-                                            HEAP_ZERO_MEMORY,
-                                            sizeof(LOAD_MODULE_ENTRY));
+                    ForwarderFunctionName = ForwarderDot + 1;
 
-                                        if (ModuleEntry) {
-                                            ModuleEntry->Next = LoadedModulesHead.Next;
-                                            ModuleEntry->hModule = forwdll;
-                                            LoadedModulesHead.Next = ModuleEntry;
-                                        }
+                    //
+                    // Build forwarder module name.
+                    //
+                    RtlSecureZeroMemory(szForwarderModuleName, sizeof(szForwarderModuleName));
+                    _strncpy_a(szForwarderModuleName, sizeof(szForwarderModuleName),
+                        rfn.ForwarderName, ForwarderDot - &rfn.ForwarderName[0]);
 
-                                        if (NT_SUCCESS(NtRawGetProcAddress(forwdll, ForwarderFunctionName, &rfn))) {
+                    _strcat_a(szForwarderModuleName, ".SYS");
 
-                                            //
-                                            // Calculate routine kernel mode address.
-                                            //
-                                            itable->KernelStubTargetAddress =
-                                                (ULONG_PTR)ForwardModule->ImageBase + ((ULONG_PTR)rfn.Function - (ULONG_PTR)forwdll);
-                                        }
+                    //
+                    // Forwarded module is loaded only if it is present in kernel.
+                    //
+                    ForwardImage = SdtpCacheQueryImage(Cache, szForwarderModuleName);
+                    if (ForwardImage && ForwardImage->KernelModule) {
 
-                                    }
-                                    else {
-                                        //
-                                        // Log error.
-                                        //
-                                        SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, TEXT("could not load forwarded module"));
-                                    }
+                        if (SdtpCacheLoadImage(ForwardImage)) {
 
-                                } // if (ForwarderFunctionName)
+                            if (NT_SUCCESS(SdtpCacheGetProcAddress(Cache, ForwardImage, ForwarderFunctionName, &rfn))) {
 
-                            }//if (ForwardModule)
+                                //
+                                // Calculate routine kernel mode address.
+                                //
+                                itable->KernelStubTargetAddress =
+                                    (ULONG_PTR)ForwardImage->KernelModule->ImageBase +
+                                    ((ULONG_PTR)rfn.Function - (ULONG_PTR)ForwardImage->DllModule);
+                            }
 
                         }
                         else {
                             //
-                            // Calculate routine kernel mode address.
+                            // Log error.
                             //
-                            Module = (PRTL_PROCESS_MODULE_INFORMATION)supFindModuleEntryByName(pModules, ModuleName);
-                            if (Module) {
-                                itable->KernelStubTargetAddress =
-                                    (ULONG_PTR)Module->ImageBase + ((ULONG_PTR)rfn.Function - (ULONG_PTR)DllModule);
-                            }
+                            SdtListReportEvent(WOBJ_LOG_ENTRY_ERROR, __FUNCTIONW__, TEXT("could not load forwarded module"));
+                        }
 
-                            RtlFreeAnsiString(&ResolvedModuleName);
+                    }
 
-                        }
-                        //break;
-                    //}
+                }
+                else {
+                    //
+                    // Calculate routine kernel mode address.
+                    //
+                    if (Image->KernelModule) {
+                        itable->KernelStubTargetAddress =
+                            (ULONG_PTR)Image->KernelModule->ImageBase + ((ULONG_PTR)rfn.Function - (ULONG_PTR)Image->DllModule);
                     }
-                    itable = itable->NextService;
                 }
+
             }
 
             //
-            // Output table.
+            // Output table, service names are kept in narrow string pool placed after entries.
             //
-            W32pServiceTable.Table = (PSERVICETABLEENTRY)supHeapAlloc(sizeof(SERVICETABLEENTRY) * w32k_limit);
+            NamePoolSize = 0;
+            for (itable = table; itable != NULL; itable = itable->NextService)
+                NamePoolSize += _strlen_a(itable->Name) + 1;
+
+            W32pServiceTable.Table = (PSERVICETABLEENTRY)supHeapAlloc(sizeof(SERVICETABLEENTRY) * w32k_limit + NamePoolSize);
             if (W32pServiceTable.Table) {
 
+                NamePool = (LPSTR)&W32pServiceTable.Table[w32k_limit];
+
                 W32pServiceTable.Allocated = TRUE;
                 W32pServiceTable.Base = kernelWin32kBase;
 
@@ -1456,13 +1695,10 @@ BOOL SdtListCreateTableShadow(
                     //
                     // Remember service name.
                     //
-                    MultiByteToWideChar(
-                        CP_ACP,
-                        0,
-                        itable->Name,
-                        (INT)_strlen_a(itable->Name),
-                        ServiceEntry->Name,
-                        MAX_PATH);
+                    NameLength = _strlen_a(itable->Name);
+                    RtlCopyMemory(NamePool, itable->Name, NameLength + 1);
+                    ServiceEntry->Name = NamePool;
+                    NamePool += NameLength + 1;
 
                     W32pServiceTable.Limit += 1;
 
@@ -1489,12 +1725,7 @@ BOOL SdtListCreateTableShadow(
         //
         // Unload all loaded modules.
         //
-        for (PreviousEntry = &LoadedModulesHead, ModuleEntry = LoadedModulesHead.Next;
-            ModuleEntry != NULL;
-            PreviousEntry = ModuleEntry, ModuleEntry = ModuleEntry->Next)
-        {
-            FreeLibrary(ModuleEntry->hModule);
-        }
+        if (Cache) SdtpCacheRelease(Cache);
         if (EnumerationHeap) RtlDestroyHeap(EnumerationHeap);
         if (w32u) FreeLibrary(w32u);
         if (w32k) FreeLibrary(w32k);
@@ -1504,6 +1735,41 @@ BOOL SdtListCreateTableShadow(
     return bResult;
 }
 
+/*
+* SdtQueryTable
+*
+* Purpose:
+*
+* Build service table without any output, tables are cached until SdtFreeGlobals.
+*
+*/
+PSDT_TABLE SdtQueryTable(
+    _In_ SSDT_DLG_MODE Mode,
+    _In_ PRTL_PROCESS_MODULES Modules,
+    _Out_ PULONG Status
+)
+{
+    *Status = STATUS_SUCCESS;
+
+    switch (Mode) {
+
+    case SST_Ntos:
+        if (SdtListCreateTable())
+            return &KiServiceTable;
+        break;
+
+    case SST_Win32k:
+        if (SdtListCreateTableShadow(Modules, Status))
+            return &W32pServiceTable;
+        break;
+
+    default:
+        break;
+    }
+
+    return NULL;
+}
+
 /*
 * SdtListCreate
 *
@@ -1520,9 +1786,9 @@ VOID SdtListCreate(
 {
     BOOL bSuccess = FALSE;
     ULONG returnStatus;
-    EXTRASCALLBACK CallbackParam;
     PRTL_PROCESS_MODULES pModules = NULL;
     LPWSTR lpErrorMsg = TEXT("Unknown error");
+    TRACE_SPAN Span;
 
 #ifndef _DEBUG
     HWND hwndBanner;
@@ -1549,7 +1815,9 @@ VOID SdtListCreate(
                 }
             }
 
+            TRACE_BEGIN(Span, "SdtListCreateTable");
             bSuccess = SdtListCreateTable();
+            TRACE_END(Span);
             if (bSuccess) {
                 SdtListOutputTable(hwndDlg, pModules, &KiServiceTable);
             }
@@ -1565,7 +1833,9 @@ VOID SdtListCreate(
                 }
             }
 
+            TRACE_BEGIN(Span, "SdtListCreateTableShadow");
             bSuccess = SdtListCreateTableShadow(pModules, &returnStatus);
+            TRACE_END(Span);
             if (bSuccess) {
 
                 if (returnStatus == ErrShadowApiSetNotFound)
@@ -1641,9 +1911,10 @@ VOID SdtListCreate(
     }
 
     if (bSuccess) {
-        CallbackParam.lParam = 0;
-        CallbackParam.Value = pDlgContext->DialogMode;
-        ListView_SortItemsEx(pDlgContext->ListView, &SdtDlgCompareFunc, (LPARAM)&CallbackParam);
+        lvSortItems(pDlgContext->ListView,
+            pDlgContext->lvColumnToSort,
+            SdtDlgGetSortKey(pDlgContext->lvColumnToSort),
+            pDlgContext->bInverseSort);
         SetFocus(pDlgContext->ListView);
     }
 }
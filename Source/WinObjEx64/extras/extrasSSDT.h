@@ -20,10 +20,17 @@
 
 #define INVALID_SERVICE_ENTRY_ID 0xFFFFFFFF
 
+//
+// Bitmap of claimed service ids.
+//
+#define SDT_BITMAP_SIZE(Bits)           ((((Bits) + 31) / 32) * sizeof(ULONG))
+#define SDT_BITMAP_TEST(Bitmap, Bit)    ((Bitmap)[(Bit) / 32] & (1UL << ((Bit) % 32)))
+#define SDT_BITMAP_SET(Bitmap, Bit)     ((Bitmap)[(Bit) / 32] |= (1UL << ((Bit) % 32)))
+
 typedef struct _SERVICETABLEENTRY {
     ULONG ServiceId;
     ULONG_PTR Address;
-    WCHAR Name[MAX_PATH + 1];
+    LPCSTR Name;        //points to table name pool, freed with table
 } SERVICETABLEENTRY, *PSERVICETABLEENTRY;
 
 typedef struct _SDT_TABLE {
@@ -53,6 +60,11 @@ typedef struct _W32K_API_SET_TABLE_ENTRY {
 
 VOID SdtFreeGlobals();
 
+PSDT_TABLE SdtQueryTable(
+    _In_ SSDT_DLG_MODE Mode,
+    _In_ PRTL_PROCESS_MODULES Modules,
+    _Out_ PULONG Status);
+
 VOID extrasCreateSSDTDialog(
     _In_ HWND hwndParent,
     _In_ SSDT_DLG_MODE Mode);
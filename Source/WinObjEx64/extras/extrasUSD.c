@@ -48,6 +48,9 @@ VOID UsdDumpSharedRegion(
 
     PKUSER_SHARED_DATA  pUserSharedData;
 
+    TRACE_SPAN          Span;
+
+    TRACE_BEGIN(Span, "UsdDumpSharedRegion");
 
     do {
 
@@ -472,6 +475,8 @@ VOID UsdDumpSharedRegion(
         }
 
     } while (FALSE);
+
+    TRACE_END(Span);
 }
 
 /*
@@ -29,28 +29,6 @@ BOOL bFindDlgSortInverse = FALSE;
 // local FindDlg variable to hold selected column
 LONG FindDlgSortColumn = 0;
 
-
-/*
-* FindDlgCompareFunc
-*
-* Purpose:
-*
-* FindDlg listview comparer function.
-*
-*/
-INT CALLBACK FindDlgCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
-)
-{
-    return supListViewBaseComparer(FindDlgList,
-        bFindDlgSortInverse,
-        lParam1,
-        lParam2,
-        lParamSort);
-}
-
 /*
 * FindDlgAddListItem
 *
@@ -226,7 +204,7 @@ BOOL FindDlgHandleNotify(
     case LVN_COLUMNCLICK:
         bFindDlgSortInverse = !bFindDlgSortInverse;
         FindDlgSortColumn = ((NMLISTVIEW*)nhdr)->iSubItem;
-        ListView_SortItemsEx(FindDlgList, &FindDlgCompareFunc, FindDlgSortColumn);
+        lvSortItems(FindDlgList, FindDlgSortColumn, LvSortKeyText, bFindDlgSortInverse);
 
         nImageIndex = ImageList_GetImageCount(g_ListViewImages);
         if (bFindDlgSortInverse)
@@ -346,7 +324,7 @@ INT_PTR CALLBACK FindDlgProc(
             _strcat(searchString, TEXT(" matching object(s)."));
             SetDlgItemText(hwndDlg, ID_SEARCH_STATUSBAR, searchString);
 
-            ListView_SortItemsEx(FindDlgList, &FindDlgCompareFunc, FindDlgSortColumn);
+            lvSortItems(FindDlgList, FindDlgSortColumn, LvSortKeyText, bFindDlgSortInverse);
 
             supSetWaitCursor(FALSE);
             EnableWindow(GetDlgItem(hwndDlg, ID_SEARCH_FIND), TRUE);
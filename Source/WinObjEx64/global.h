@@ -93,7 +93,16 @@
 
 #include "ksymbols.h"
 #include "objects.h"
+#include "refindex.h"
+#include "arena.h"
+#include "lvsort.h"
+#include "export.h"
+#include "headless.h"
 #include "kldbg.h"
+#include "kdcache.h"
+#include "kdlist.h"
+#include "kdfail.h"
+#include "kdstats.h"
 #include "drvhelper.h"
 #include "ui.h"
 #include "sup.h"
@@ -104,6 +113,8 @@
 #include "extapi.h"
 #include "plugmngr.h"
 #include "log\log.h"
+#include "log\logfile.h"
+#include "trace.h"
 #include "tests\testunit.h"
 
 #if defined(__cplusplus)
@@ -134,6 +145,7 @@ extern ULONG g_CurrentDPI;
 typedef struct _WINOBJ_GLOBALS {
     BOOLEAN IsWine;
     BOOLEAN EnableFullMitigations;
+    BOOLEAN IsHeadless; //no windows, messages go to log and stderr
     HINSTANCE hInstance;
     HANDLE Heap;
     HANDLE RichEditHandle;
@@ -0,0 +1,385 @@
+﻿/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       HDE64LEN.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Length-only x64 instruction decoder.
+*
+*  Follows hde64_disasm step by step, including its quirks, so both
+*  decoders always agree, see TestDisasmLength in tests\testunit.c.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#include "hde64len.h"
+#include "table64len.h"
+
+#define C_MODRM   0x01
+#define C_IMM8    0x02
+#define C_IMM16   0x04
+#define C_IMM_P66 0x10
+#define C_REL8    0x20
+#define C_REL32   0x40
+
+#define PRE_NONE 0x01
+#define PRE_F2   0x02
+#define PRE_F3   0x04
+#define PRE_66   0x08
+#define PRE_67   0x10
+#define PRE_LOCK 0x20
+
+/*
+* hde64_length_full
+*
+* Purpose:
+*
+* Full length decode, used for prefixed and rare instructions.
+*
+*/
+static unsigned int hde64_length_full(const void *code, uint32_t *flags)
+{
+    uint8_t x, c = 0, *p = (uint8_t *)code, cflags, opcode, pref = 0, px;
+    uint8_t m_mod, m_reg, m_rm, disp_size = 0, map = 0, op2 = 0, op64 = 0;
+    uint16_t lock;
+    uint32_t f;
+    unsigned int len;
+
+    for (x = 16; x; x--) {
+        px = hde64_len_prefix[c = *p++];
+        if (px == 0)
+            break;
+        pref |= px;
+    }
+
+    f = (uint32_t)pref << 23;
+
+    if (!pref)
+        pref |= PRE_NONE;
+
+    if ((c & 0xf0) == 0x40) {
+        f |= F_PREFIX_REX;
+        if ((c & 0x8) && (*p & 0xf8) == 0xb8)
+            op64++;
+        if (((c = *p++) & 0xf0) == 0x40) {
+            f |= F_ERROR | F_ERROR_OPCODE;
+            cflags = 0;
+            goto modrm_done;
+        }
+    }
+
+    if (c == 0x0f) {
+        c = *p++;
+        op2 = (c != 0); //hde64 tests opcode2 value
+        map = 1;
+    } else if (c >= 0xa0 && c <= 0xa3) {
+        op64++;
+        if (pref & PRE_67)
+            pref |= PRE_66;
+        else
+            pref &= ~PRE_66;
+    }
+
+    opcode = c;
+    cflags = hde64_len_cflags[map][opcode];
+    x = hde64_len_group[map][opcode];
+
+    if (cflags & C_LEN_ERROR) {
+        f |= F_ERROR | F_ERROR_OPCODE;
+        cflags &= ~C_LEN_ERROR;
+    }
+
+    if (op2 && (hde64_len_prefix_error[opcode] & pref))
+        f |= F_ERROR | F_ERROR_OPCODE;
+
+    if (cflags & C_MODRM) {
+        f |= F_MODRM;
+        c = *p++;
+        m_mod = c >> 6;
+        m_rm = c & 7;
+        m_reg = (c & 0x3f) >> 3;
+
+        if (x && ((x << m_reg) & 0x80))
+            f |= F_ERROR | F_ERROR_OPCODE;
+
+        if (!op2 && opcode >= 0xd9 && opcode <= 0xdf) {
+            uint8_t t = opcode - 0xd9;
+            if (m_mod == 3)
+                t = hde64_len_fpu_modrm[t * 8 + m_reg] << m_rm;
+            else
+                t = hde64_len_fpu_reg[t] << m_reg;
+            if (t & 0x80)
+                f |= F_ERROR | F_ERROR_OPCODE;
+        }
+
+        if (pref & PRE_LOCK) {
+            if (m_mod == 3) {
+                f |= F_ERROR | F_ERROR_LOCK;
+            } else {
+                lock = hde64_len_lock[op2][opcode];
+                if (!(lock & LEN_LOCK_PRESENT) || (((lock & 0xff) << m_reg) & 0x80))
+                    f |= F_ERROR | F_ERROR_LOCK;
+            }
+        }
+
+        if (op2) {
+            switch (opcode) {
+                case 0x20: case 0x22:
+                    m_mod = 3;
+                    if (m_reg > 4 || m_reg == 1)
+                        goto error_operand;
+                    else
+                        goto no_error_operand;
+                case 0x21: case 0x23:
+                    m_mod = 3;
+                    if (m_reg == 4 || m_reg == 5)
+                        goto error_operand;
+                    else
+                        goto no_error_operand;
+            }
+        } else {
+            switch (opcode) {
+                case 0x8c:
+                    if (m_reg > 5)
+                        goto error_operand;
+                    else
+                        goto no_error_operand;
+                case 0x8e:
+                    if (m_reg == 1 || m_reg > 5)
+                        goto error_operand;
+                    else
+                        goto no_error_operand;
+            }
+        }
+
+        if (m_mod == 3) {
+            if ((hde64_len_only_mem_pref[op2][opcode] & pref) &&
+                !((hde64_len_only_mem_reg[op2][opcode] << m_reg) & 0x80))
+            {
+                goto error_operand;
+            }
+            goto no_error_operand;
+        } else if (op2) {
+            switch (opcode) {
+                case 0x50: case 0xd7: case 0xf7:
+                    if (pref & (PRE_NONE | PRE_66))
+                        goto error_operand;
+                    break;
+                case 0xd6:
+                    if (pref & (PRE_F2 | PRE_F3))
+                        goto error_operand;
+                    break;
+                case 0xc5:
+                    goto error_operand;
+            }
+            goto no_error_operand;
+        } else
+            goto no_error_operand;
+
+      error_operand:
+        f |= F_ERROR | F_ERROR_OPERAND;
+      no_error_operand:
+
+        c = *p++;
+        if (m_reg <= 1) {
+            if (opcode == 0xf6)
+                cflags |= C_IMM8;
+            else if (opcode == 0xf7)
+                cflags |= C_IMM_P66;
+        }
+
+        switch (m_mod) {
+            case 0:
+                if (pref & PRE_67) {
+                    if (m_rm == 6)
+                        disp_size = 2;
+                } else
+                    if (m_rm == 5)
+                        disp_size = 4;
+                break;
+            case 1:
+                disp_size = 1;
+                break;
+            case 2:
+                disp_size = 2;
+                if (!(pref & PRE_67))
+                    disp_size <<= 1;
+        }
+
+        if (m_mod != 3 && m_rm == 4) {
+            f |= F_SIB;
+            p++;
+            if ((c & 7) == 5 && !(m_mod & 1))
+                disp_size = 4;
+        }
+
+        p--;
+        switch (disp_size) {
+            case 1:
+                f |= F_DISP8;
+                break;
+            case 2:
+                f |= F_DISP16;
+                break;
+            case 4:
+                f |= F_DISP32;
+        }
+        p += disp_size;
+    } else {
+      modrm_done:
+        if (pref & PRE_LOCK)
+            f |= F_ERROR | F_ERROR_LOCK;
+    }
+
+    if (cflags & C_IMM_P66) {
+        if (cflags & C_REL32) {
+            if (pref & PRE_66) {
+                f |= F_IMM16 | F_RELATIVE;
+                p += 2;
+                goto disasm_done;
+            }
+            goto rel32_ok;
+        }
+        if (op64) {
+            f |= F_IMM64;
+            p += 8;
+        } else if (!(pref & PRE_66)) {
+            f |= F_IMM32;
+            p += 4;
+        } else
+            goto imm16_ok;
+    }
+
+    if (cflags & C_IMM16) {
+      imm16_ok:
+        f |= F_IMM16;
+        p += 2;
+    }
+    if (cflags & C_IMM8) {
+        f |= F_IMM8;
+        p++;
+    }
+
+    if (cflags & C_REL32) {
+      rel32_ok:
+        f |= F_IMM32 | F_RELATIVE;
+        p += 4;
+    } else if (cflags & C_REL8) {
+        f |= F_IMM8 | F_RELATIVE;
+        p++;
+    }
+
+  disasm_done:
+
+    if ((len = (unsigned int)(p - (uint8_t *)code)) > 15) {
+        f |= F_ERROR | F_ERROR_LENGTH;
+        len = 15;
+    }
+
+    if (flags)
+        *flags = f;
+
+    return len;
+}
+
+/*
+* hde64_length
+*
+* Purpose:
+*
+* Return instruction length and hde64 flags (optional).
+*
+* Instructions without legacy prefixes are decoded with a couple of table
+* lookups, everything else goes to hde64_length_full.
+*
+*/
+unsigned int hde64_length(const void *code, uint32_t *flags)
+{
+    uint8_t *p = (uint8_t *)code, c, d, m, e, x, map, rex;
+    uint32_t f;
+
+    rex = ((*p & 0xf0) == 0x40);
+    f = (uint32_t)rex << 30; //F_PREFIX_REX
+    p += rex;
+
+    map = (*p == 0x0f);
+    p += map;
+
+    c = *p++;
+    d = hde64_len_fast[map][c];
+    if (d == 0)
+        return hde64_length_full(code, flags);
+
+    if (rex && (((uint8_t *)code)[0] & 0x8) && map == 0 && (c & 0xf8) == 0xb8)
+        return hde64_length_full(code, flags);
+
+    if (d & LEN_FAST_MODRM) {
+
+        m = *p++;
+        x = hde64_len_group[map][c];
+        if (x && ((x << ((m & 0x3f) >> 3)) & 0x80))
+            return hde64_length_full(code, flags);
+
+        if ((m >> 6) == 3 && (d & LEN_FAST_ONLY_MEM))
+            return hde64_length_full(code, flags);
+
+        e = hde64_len_modrm[m];
+        f |= hde64_len_modrm_flags[m];
+
+        if (e & LEN_MODRM_SIB) {
+            if ((*p & 7) == 5 && (m >> 6) == 0) {
+                e += 4;
+                f |= F_DISP32;
+            }
+            p++;
+        }
+
+        p += e & LEN_MODRM_DISP_MASK;
+    }
+
+    p += d & LEN_FAST_IMM_MASK;
+    f |= hde64_len_fast_flags[map][c];
+
+    if (flags)
+        *flags = f;
+
+    return (unsigned int)(p - (uint8_t *)code);
+}
+
+/*
+* hde64_length_batch
+*
+* Purpose:
+*
+* Decode consecutive instructions from code block into lengths array.
+*
+* Stops at first invalid instruction, at instruction crossing block end
+* or when lengths array is full. Returns number of decoded instructions.
+*
+*/
+unsigned int hde64_length_batch(const void *code,
+    unsigned int size,
+    uint8_t *lengths,
+    unsigned int count)
+{
+    unsigned int offset = 0, n = 0, len;
+    uint32_t f;
+
+    while (n < count && offset < size) {
+        len = hde64_length((const uint8_t *)code + offset, &f);
+        if ((f & F_ERROR) || (len > size - offset))
+            break;
+        lengths[n++] = (uint8_t)len;
+        offset += len;
+    }
+
+    return n;
+}
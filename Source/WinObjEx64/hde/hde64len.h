@@ -0,0 +1,45 @@
+﻿/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       HDE64LEN.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Length-only x64 instruction decoder built on hde64 tables.
+*
+*  Returned length and flags are identical to hde64_disasm results,
+*  but no operand fields are extracted.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+
+#ifndef _HDE64LEN_H_
+#define _HDE64LEN_H_
+
+#include "hde64.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* __cdecl */
+unsigned int hde64_length(const void *code, uint32_t *flags);
+
+/* __cdecl */
+unsigned int hde64_length_batch(const void *code,
+    unsigned int size,
+    uint8_t *lengths,
+    unsigned int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HDE64LEN_H_ */
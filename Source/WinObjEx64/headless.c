@@ -0,0 +1,1066 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       HEADLESS.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Headless collection mode.
+*
+*  Selected collectors are run without creating any window and results are
+*  streamed as JSON Lines through single buffered writer. Every record has
+*  "collector" field, each collector ends with summary record.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include "extras\extrasSSDT.h"
+#include "extras\extrasCallbacks.h"
+#include "extras\extrasSL.h"
+
+//mailslot root
+#define HEADLESS_DEVICE_MAILSLOT    L"\\Device\\Mailslot\\"
+
+//named pipes root
+#define HEADLESS_DEVICE_NAMED_PIPE  L"\\Device\\NamedPipe\\"
+
+HEADLESS_STATUS headlesspCollectNamespace(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectDrivers(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectServiceTable(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectShadowServiceTable(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectCallbacks(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectPrivateNamespaces(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectNamedPipes(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectMailslots(_In_ PHEADLESS_CONTEXT Context);
+HEADLESS_STATUS headlesspCollectSLCache(_In_ PHEADLESS_CONTEXT Context);
+
+HEADLESS_COLLECTOR g_HeadlessCollectors[] = {
+    { L"namespace", headlesspCollectNamespace, FALSE },
+    { L"drivers", headlesspCollectDrivers, FALSE },
+    { L"ssdt", headlesspCollectServiceTable, TRUE },
+    { L"shadowssdt", headlesspCollectShadowServiceTable, TRUE },
+    { L"callbacks", headlesspCollectCallbacks, TRUE },
+    { L"privatenamespaces", headlesspCollectPrivateNamespaces, TRUE },
+    { L"pipes", headlesspCollectNamedPipes, FALSE },
+    { L"mailslots", headlesspCollectMailslots, FALSE },
+    { L"slcache", headlesspCollectSLCache, FALSE }
+};
+
+LPCWSTR g_HeadlessStatusNames[] = {
+    L"success",
+    L"failed",
+    L"unsupported",
+    L"nodriver"
+};
+
+/*
+* headlesspBeginRecord
+*
+* Purpose:
+*
+* Set record columns and write collector name as first field.
+*
+*/
+VOID headlesspBeginRecord(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ ULONG ColumnCount,
+    _In_reads_(ColumnCount) LPCWSTR* ColumnNames
+)
+{
+    exportSetColumns(Context->Writer, ColumnCount, ColumnNames);
+    exportWriteField(Context->Writer, Context->CollectorName);
+}
+
+/*
+* headlesspEndRecord
+*
+* Purpose:
+*
+* Terminate record and count it.
+*
+*/
+VOID headlesspEndRecord(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    exportEndRow(Context->Writer);
+    Context->RecordCount++;
+}
+
+/*
+* headlesspWriteAddress
+*
+* Purpose:
+*
+* Write address as hex string field.
+*
+*/
+VOID headlesspWriteAddress(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ ULONG_PTR Address
+)
+{
+    WCHAR szAddress[32];
+
+    szAddress[0] = L'0';
+    szAddress[1] = L'x';
+    szAddress[2] = 0;
+    u64tohex(Address, &szAddress[2]);
+
+    exportWriteField(Context->Writer, szAddress);
+}
+
+/*
+* headlesspWriteModuleName
+*
+* Purpose:
+*
+* Write full path of kernel module containing given address.
+*
+*/
+VOID headlesspWriteModuleName(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ ULONG_PTR Address
+)
+{
+    ULONG ModuleIndex;
+    WCHAR szModule[MAX_PATH + 1];
+
+    szModule[0] = 0;
+
+    if (Context->Modules) {
+
+        ModuleIndex = supFindModuleEntryByAddress(Context->Modules, (PVOID)Address);
+        if (ModuleIndex != (ULONG)-1) {
+            MultiByteToWideChar(CP_ACP,
+                0,
+                (LPCSTR)&Context->Modules->Modules[ModuleIndex].FullPathName,
+                -1,
+                szModule,
+                MAX_PATH);
+            szModule[MAX_PATH] = 0;
+        }
+    }
+
+    exportWriteField(Context->Writer, szModule);
+}
+
+/*
+* headlesspWalkDirectory
+*
+* Purpose:
+*
+* Write all objects of directory and recurse into subdirectories.
+*
+* Entries are queried in batches, query buffer of each level is taken from the arena
+* and released before return so memory is bounded by directory depth.
+*
+*/
+VOID headlesspWalkDirectory(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_opt_ HANDLE RootHandle,
+    _In_ LPWSTR DirectoryName,
+    _In_ ULONG PathLength
+)
+{
+    BOOL bSingleEntry = g_WinObj.IsWine;
+    NTSTATUS ntStatus;
+    ULONG queryContext = 0, rLength, NameLength, NameOffset, i;
+    HANDLE directoryHandle;
+    ARENA_MARK Mark;
+    POBJECT_DIRECTORY_INFORMATION Buffer, Entry;
+
+    LPCWSTR ColumnNames[] = { L"collector", L"path", L"type" };
+
+    directoryHandle = supOpenDirectory(RootHandle, DirectoryName, DIRECTORY_QUERY);
+    if (directoryHandle == NULL)
+        return;
+
+    //
+    // Root path is single separator, names below it are appended without another one.
+    //
+    NameOffset = (PathLength > 1) ? PathLength + 1 : PathLength;
+
+    arenaMark(Context->Arena, &Mark);
+
+    do {
+
+        Buffer = (POBJECT_DIRECTORY_INFORMATION)arenaAllocNoZero(Context->Arena,
+            HEADLESS_QUERY_BUFFER_SIZE);
+
+        if (Buffer == NULL)
+            break;
+
+        do {
+
+            //
+            // Wine implementation of NtQueryDirectoryObject interface does not return multiple entries.
+            //
+            ntStatus = NtQueryDirectoryObject(directoryHandle,
+                Buffer,
+                HEADLESS_QUERY_BUFFER_SIZE,
+                (BOOLEAN)bSingleEntry,
+                FALSE,
+                &queryContext,
+                &rLength);
+
+            if (!NT_SUCCESS(ntStatus) || ntStatus == STATUS_NO_MORE_ENTRIES)
+                break;
+
+            for (i = 0, Entry = Buffer; Entry->Name.Buffer; Entry++, i++) {
+
+                if (bSingleEntry && i)
+                    break;
+
+                //
+                // Append leaf name to the current path.
+                //
+                NameLength = Entry->Name.Length / sizeof(WCHAR);
+                if (NameOffset + NameLength + 1 > HEADLESS_MAX_PATH)
+                    continue;
+
+                Context->PathBuffer[PathLength] = L'\\';
+                RtlCopyMemory(&Context->PathBuffer[NameOffset], Entry->Name.Buffer, Entry->Name.Length);
+                Context->PathBuffer[NameOffset + NameLength] = 0;
+
+                headlesspBeginRecord(Context, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+                exportWriteField(Context->Writer, Context->PathBuffer);
+                exportWriteField(Context->Writer, Entry->TypeName.Buffer);
+                headlesspEndRecord(Context);
+
+                if (0 == _strncmpi(Entry->TypeName.Buffer,
+                    OBTYPE_NAME_DIRECTORY,
+                    Entry->TypeName.Length / sizeof(WCHAR)))
+                {
+                    headlesspWalkDirectory(Context,
+                        directoryHandle,
+                        Entry->Name.Buffer,
+                        NameOffset + NameLength);
+                }
+            }
+
+            Context->PathBuffer[PathLength] = 0;
+
+        } while (ntStatus == STATUS_MORE_ENTRIES || bSingleEntry);
+
+    } while (FALSE);
+
+    arenaResetToMark(Context->Arena, &Mark);
+
+    NtClose(directoryHandle);
+}
+
+/*
+* headlesspCollectNamespace
+*
+* Purpose:
+*
+* Object manager namespace walk.
+*
+*/
+HEADLESS_STATUS headlesspCollectNamespace(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    Context->PathBuffer = (LPWSTR)arenaAllocNoZero(Context->Arena,
+        HEADLESS_MAX_PATH * sizeof(WCHAR));
+
+    if (Context->PathBuffer == NULL)
+        return HeadlessStatusFailed;
+
+    Context->PathBuffer[0] = L'\\';
+    Context->PathBuffer[1] = 0;
+
+    headlesspWalkDirectory(Context, NULL, KM_OBJECTS_ROOT_DIRECTORY, 1);
+
+    Context->PathBuffer = NULL;
+
+    return (Context->RecordCount) ? HeadlessStatusSuccess : HeadlessStatusFailed;
+}
+
+/*
+* headlesspCollectDrivers
+*
+* Purpose:
+*
+* Loaded kernel modules.
+*
+*/
+HEADLESS_STATUS headlesspCollectDrivers(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    ULONG i;
+    PRTL_PROCESS_MODULE_INFORMATION Module;
+    WCHAR szBuffer[MAX_PATH + 1];
+
+    LPCWSTR ColumnNames[] = { L"collector", L"loadOrder", L"name", L"address", L"size", L"path" };
+
+    if (g_WinObj.IsWine)
+        return HeadlessStatusUnsupported;
+
+    if (Context->Modules == NULL)
+        return HeadlessStatusFailed;
+
+    for (i = 0; i < Context->Modules->NumberOfModules; i++) {
+
+        Module = &Context->Modules->Modules[i];
+
+        if ((ULONG_PTR)Module->ImageBase < g_kdctx.SystemRangeStart)
+            continue;
+
+        headlesspBeginRecord(Context, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+        exportWriteNumber(Context->Writer, Module->LoadOrderIndex);
+
+        szBuffer[0] = 0;
+        MultiByteToWideChar(CP_ACP, 0,
+            (LPCSTR)&Module->FullPathName[Module->OffsetToFileName],
+            -1,
+            szBuffer,
+            MAX_PATH);
+        szBuffer[MAX_PATH] = 0;
+        exportWriteField(Context->Writer, szBuffer);
+
+        headlesspWriteAddress(Context, (ULONG_PTR)Module->ImageBase);
+        exportWriteNumber(Context->Writer, Module->ImageSize);
+
+        szBuffer[0] = 0;
+        MultiByteToWideChar(CP_ACP, 0,
+            (LPCSTR)&Module->FullPathName,
+            -1,
+            szBuffer,
+            MAX_PATH);
+        szBuffer[MAX_PATH] = 0;
+        exportWriteField(Context->Writer, szBuffer);
+
+        headlesspEndRecord(Context);
+    }
+
+    return HeadlessStatusSuccess;
+}
+
+/*
+* headlesspWriteServiceTable
+*
+* Purpose:
+*
+* Output dumped and converted syscall table.
+*
+*/
+HEADLESS_STATUS headlesspWriteServiceTable(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ SSDT_DLG_MODE Mode
+)
+{
+    ULONG i, Status;
+    PSDT_TABLE Table;
+    WCHAR szName[MAX_PATH + 1];
+
+    LPCWSTR ColumnNames[] = { L"collector", L"id", L"name", L"address", L"module" };
+
+    if (g_WinObj.IsWine)
+        return HeadlessStatusUnsupported;
+
+    if (Context->Modules == NULL)
+        return HeadlessStatusFailed;
+
+    Table = SdtQueryTable(Mode, Context->Modules, &Status);
+    if (Table == NULL)
+        return HeadlessStatusFailed;
+
+    for (i = 0; i < Table->Limit; i++) {
+        headlesspBeginRecord(Context, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+        exportWriteNumber(Context->Writer, Table->Table[i].ServiceId);
+        szName[0] = 0;
+        MultiByteToWideChar(CP_ACP, 0, Table->Table[i].Name, -1, szName, MAX_PATH);
+        szName[MAX_PATH] = 0;
+        exportWriteField(Context->Writer, szName);
+        headlesspWriteAddress(Context, Table->Table[i].Address);
+        headlesspWriteModuleName(Context, Table->Table[i].Address);
+        headlesspEndRecord(Context);
+    }
+
+    return HeadlessStatusSuccess;
+}
+
+/*
+* headlesspCollectServiceTable
+*
+* Purpose:
+*
+* KiServiceTable.
+*
+*/
+HEADLESS_STATUS headlesspCollectServiceTable(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    return headlesspWriteServiceTable(Context, SST_Ntos);
+}
+
+/*
+* headlesspCollectShadowServiceTable
+*
+* Purpose:
+*
+* W32pServiceTable, Windows 10 RS1+ only.
+*
+*/
+HEADLESS_STATUS headlesspCollectShadowServiceTable(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    if (g_NtBuildNumber < NT_WIN10_REDSTONE1)
+        return HeadlessStatusUnsupported;
+
+    return headlesspWriteServiceTable(Context, SST_Win32k);
+}
+
+/*
+* headlesspCallbacksCallback
+*
+* Purpose:
+*
+* CallbacksEnumerate callback.
+*
+*/
+BOOL CALLBACK headlesspCallbacksCallback(
+    _In_ LPCWSTR CallbackType,
+    _In_ ULONG_PTR Address,
+    _In_ LPCWSTR Module,
+    _In_opt_ LPCWSTR AdditionalInfo,
+    _In_opt_ PVOID Context
+)
+{
+    PHEADLESS_CONTEXT HeadlessContext = (PHEADLESS_CONTEXT)Context;
+
+    LPCWSTR ColumnNames[] = { L"collector", L"type", L"address", L"module", L"info" };
+
+    if (HeadlessContext == NULL)
+        return TRUE;
+
+    headlesspBeginRecord(HeadlessContext, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+    exportWriteField(HeadlessContext->Writer, CallbackType);
+    headlesspWriteAddress(HeadlessContext, Address);
+    exportWriteField(HeadlessContext->Writer, Module);
+    exportWriteField(HeadlessContext->Writer, AdditionalInfo);
+    headlesspEndRecord(HeadlessContext);
+
+    return FALSE;
+}
+
+/*
+* headlesspCollectCallbacks
+*
+* Purpose:
+*
+* System callbacks.
+*
+*/
+HEADLESS_STATUS headlesspCollectCallbacks(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    if (g_WinObj.IsWine)
+        return HeadlessStatusUnsupported;
+
+    return CallbacksEnumerate(headlesspCallbacksCallback, Context) ?
+        HeadlessStatusSuccess : HeadlessStatusFailed;
+}
+
+/*
+* headlesspPrivateNamespaceCallback
+*
+* Purpose:
+*
+* ObCollectionEnumerate callback.
+*
+*/
+BOOL CALLBACK headlesspPrivateNamespaceCallback(
+    _In_ POBJREF Entry,
+    _In_opt_ PVOID Context
+)
+{
+    UINT ConvertedTypeIndex;
+    PHEADLESS_CONTEXT HeadlessContext = (PHEADLESS_CONTEXT)Context;
+
+    LPCWSTR ColumnNames[] = { L"collector", L"name", L"type", L"address", L"rootDirectory" };
+
+    if (HeadlessContext == NULL)
+        return TRUE;
+
+    ConvertedTypeIndex = supGetObjectNameIndexByTypeIndex((PVOID)Entry->ObjectAddress, Entry->TypeIndex);
+
+    headlesspBeginRecord(HeadlessContext, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+    exportWriteField(HeadlessContext->Writer, Entry->ObjectName);
+    exportWriteField(HeadlessContext->Writer, ObManagerGetNameByIndex(ConvertedTypeIndex));
+    headlesspWriteAddress(HeadlessContext, Entry->ObjectAddress);
+    headlesspWriteAddress(HeadlessContext, Entry->PrivateNamespace.NamespaceDirectoryAddress);
+    headlesspEndRecord(HeadlessContext);
+
+    return FALSE;
+}
+
+/*
+* headlesspCollectPrivateNamespaces
+*
+* Purpose:
+*
+* Private namespaces objects.
+*
+*/
+HEADLESS_STATUS headlesspCollectPrivateNamespaces(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    BOOL bResult;
+    OBJECT_COLLECTION Collection;
+
+    if (g_NtBuildNumber == NT_WIN10_THRESHOLD2)
+        return HeadlessStatusUnsupported;
+
+    RtlSecureZeroMemory(&Collection, sizeof(Collection));
+
+    bResult = ObCollectionCreate(&Collection, TRUE);
+    if (bResult) {
+        bResult = ObCollectionEnumerate(&Collection,
+            headlesspPrivateNamespaceCallback,
+            Context);
+    }
+
+    ObCollectionDestroy(&Collection);
+
+    return (bResult) ? HeadlessStatusSuccess : HeadlessStatusFailed;
+}
+
+/*
+* headlesspWriteDeviceDirectory
+*
+* Purpose:
+*
+* Write all names from device directory, entries are queried in batches.
+*
+*/
+HEADLESS_STATUS headlesspWriteDeviceDirectory(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ LPWSTR lpDeviceRoot
+)
+{
+    HEADLESS_STATUS Result = HeadlessStatusFailed;
+    BOOLEAN bRestartScan = TRUE;
+    ULONG NameLength;
+    HANDLE hObject = NULL;
+    NTSTATUS ntStatus;
+    PFILE_DIRECTORY_INFORMATION Buffer, Entry;
+    OBJECT_ATTRIBUTES obja;
+    UNICODE_STRING usName;
+    IO_STATUS_BLOCK iost;
+    ARENA_MARK Mark;
+    WCHAR szName[MAX_PATH + 1];
+
+    LPCWSTR ColumnNames[] = { L"collector", L"name" };
+
+    RtlInitUnicodeString(&usName, lpDeviceRoot);
+    InitializeObjectAttributes(&obja, &usName, OBJ_CASE_INSENSITIVE, NULL, NULL);
+
+    ntStatus = NtOpenFile(&hObject, FILE_LIST_DIRECTORY, &obja, &iost,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0);
+
+    if (!NT_SUCCESS(ntStatus) || (hObject == NULL))
+        return HeadlessStatusFailed;
+
+    arenaMark(Context->Arena, &Mark);
+
+    do {
+
+        Buffer = (PFILE_DIRECTORY_INFORMATION)arenaAllocNoZero(Context->Arena,
+            HEADLESS_QUERY_BUFFER_SIZE);
+
+        if (Buffer == NULL)
+            break;
+
+        for (;;) {
+
+            ntStatus = NtQueryDirectoryFile(hObject, NULL, NULL, NULL, &iost,
+                Buffer,
+                HEADLESS_QUERY_BUFFER_SIZE,
+                FileDirectoryInformation,
+                FALSE,
+                NULL,
+                bRestartScan);
+
+            if (ntStatus == STATUS_NO_MORE_FILES) {
+                Result = HeadlessStatusSuccess;
+                break;
+            }
+
+            if (!NT_SUCCESS(ntStatus) || (iost.Information == 0))
+                break;
+
+            bRestartScan = FALSE;
+
+            for (Entry = Buffer; ; Entry = (PFILE_DIRECTORY_INFORMATION)RtlOffsetToPointer(Entry, Entry->NextEntryOffset)) {
+
+                NameLength = min(Entry->FileNameLength / sizeof(WCHAR), MAX_PATH);
+                RtlCopyMemory(szName, Entry->FileName, NameLength * sizeof(WCHAR));
+                szName[NameLength] = 0;
+
+                headlesspBeginRecord(Context, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+                exportWriteField(Context->Writer, szName);
+                headlesspEndRecord(Context);
+
+                if (Entry->NextEntryOffset == 0)
+                    break;
+            }
+        }
+
+    } while (FALSE);
+
+    arenaResetToMark(Context->Arena, &Mark);
+
+    NtClose(hObject);
+
+    return Result;
+}
+
+/*
+* headlesspCollectNamedPipes
+*
+* Purpose:
+*
+* Named pipes.
+*
+*/
+HEADLESS_STATUS headlesspCollectNamedPipes(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    return headlesspWriteDeviceDirectory(Context, HEADLESS_DEVICE_NAMED_PIPE);
+}
+
+/*
+* headlesspCollectMailslots
+*
+* Purpose:
+*
+* Mailslots.
+*
+*/
+HEADLESS_STATUS headlesspCollectMailslots(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    return headlesspWriteDeviceDirectory(Context, HEADLESS_DEVICE_MAILSLOT);
+}
+
+/*
+* headlesspSLCacheCallback
+*
+* Purpose:
+*
+* supSLCacheEnumerate callback.
+*
+*/
+BOOL CALLBACK headlesspSLCacheCallback(
+    _In_ SL_KMEM_CACHE_VALUE_DESCRIPTOR* CacheDescriptor,
+    _In_opt_ PVOID Context
+)
+{
+    ULONG NameLength;
+    LPWSTR lpType;
+    PHEADLESS_CONTEXT HeadlessContext = (PHEADLESS_CONTEXT)Context;
+    WCHAR szName[MAX_PATH + 1];
+    WCHAR szType[32];
+
+    LPCWSTR ColumnNames[] = { L"collector", L"name", L"type", L"dataLength" };
+
+    if (HeadlessContext == NULL)
+        return TRUE;
+
+    NameLength = min(CacheDescriptor->NameLength / sizeof(WCHAR), MAX_PATH);
+    RtlCopyMemory(szName, CacheDescriptor->Name, NameLength * sizeof(WCHAR));
+    szName[NameLength] = 0;
+
+    lpType = xxxSLCacheGetDescriptorDataType(CacheDescriptor);
+    if (lpType == NULL) {
+        szType[0] = 0;
+        ultostr(CacheDescriptor->Type, szType);
+        lpType = szType;
+    }
+
+    headlesspBeginRecord(HeadlessContext, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+    exportWriteField(HeadlessContext->Writer, szName);
+    exportWriteField(HeadlessContext->Writer, lpType);
+    exportWriteNumber(HeadlessContext->Writer, CacheDescriptor->DataLength);
+    headlesspEndRecord(HeadlessContext);
+
+    return FALSE;
+}
+
+/*
+* headlesspCollectSLCache
+*
+* Purpose:
+*
+* Software licensing cache descriptors.
+*
+*/
+HEADLESS_STATUS headlesspCollectSLCache(
+    _In_ PHEADLESS_CONTEXT Context
+)
+{
+    BOOLEAN bResult;
+    PVOID CacheData;
+
+    if (g_WinObj.IsWine)
+        return HeadlessStatusUnsupported;
+
+    CacheData = supSLCacheRead();
+    if (CacheData == NULL)
+        return HeadlessStatusFailed;
+
+    bResult = supSLCacheEnumerate(CacheData, headlesspSLCacheCallback, Context);
+
+    supHeapFree(CacheData);
+
+    return (bResult) ? HeadlessStatusSuccess : HeadlessStatusFailed;
+}
+
+/*
+* headlesspSelectCollectors
+*
+* Purpose:
+*
+* Convert comma separated collector names to selection mask.
+*
+*/
+BOOL headlesspSelectCollectors(
+    _In_ LPCWSTR lpNames,
+    _Out_ PULONG SelectedMask
+)
+{
+    ULONG i, cchName;
+    LPCWSTR p = lpNames, pEnd;
+
+    *SelectedMask = 0;
+
+    while (*p) {
+
+        for (pEnd = p; *pEnd && *pEnd != L','; pEnd++);
+
+        cchName = (ULONG)(pEnd - p);
+
+        for (i = 0; i < RTL_NUMBER_OF(g_HeadlessCollectors); i++) {
+            if ((_strlen(g_HeadlessCollectors[i].Name) == cchName) &&
+                (_strncmpi(g_HeadlessCollectors[i].Name, p, cchName) == 0))
+            {
+                *SelectedMask |= (1 << i);
+                break;
+            }
+        }
+
+        if (i == RTL_NUMBER_OF(g_HeadlessCollectors))
+            return FALSE;
+
+        p = (*pEnd) ? pEnd + 1 : pEnd;
+    }
+
+    return (*SelectedMask != 0);
+}
+
+/*
+* headlesspWriteSummary
+*
+* Purpose:
+*
+* Write collector summary record.
+*
+*/
+VOID headlesspWriteSummary(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ HEADLESS_STATUS Status
+)
+{
+    LPCWSTR ColumnNames[] = { L"collector", L"status", L"records" };
+
+    exportSetColumns(Context->Writer, RTL_NUMBER_OF(ColumnNames), ColumnNames);
+    exportWriteField(Context->Writer, Context->CollectorName);
+    exportWriteField(Context->Writer, g_HeadlessStatusNames[Status]);
+    exportWriteNumber(Context->Writer, Context->RecordCount);
+    exportEndRow(Context->Writer);
+}
+
+/*
+* headlesspRunCollectors
+*
+* Purpose:
+*
+* Run selected collectors, returns FALSE if any of them failed.
+*
+*/
+BOOL headlesspRunCollectors(
+    _In_ PHEADLESS_CONTEXT Context,
+    _In_ ULONG SelectedMask
+)
+{
+    BOOL bResult = TRUE;
+    ULONG i;
+    HEADLESS_STATUS Status;
+    ARENA_MARK Mark;
+    TRACE_SPAN Span;
+
+    Context->Modules = (PRTL_PROCESS_MODULES)supGetSystemInfo(SystemModuleInformation, NULL);
+
+    for (i = 0; i < RTL_NUMBER_OF(g_HeadlessCollectors); i++) {
+
+        if ((SelectedMask & (1 << i)) == 0)
+            continue;
+
+        Context->CollectorName = g_HeadlessCollectors[i].Name;
+        Context->RecordCount = 0;
+
+        TRACE_BEGIN(Span, "HeadlessCollector");
+
+        arenaMark(Context->Arena, &Mark);
+
+        if (g_HeadlessCollectors[i].RequiresDriver && !kdConnectDriver()) {
+            Status = HeadlessStatusNoDriver;
+        }
+        else {
+            __try {
+                Status = g_HeadlessCollectors[i].Routine(Context);
+            }
+            __except (WOBJ_EXCEPTION_FILTER_LOG) {
+                Status = HeadlessStatusFailed;
+            }
+        }
+
+        arenaResetToMark(Context->Arena, &Mark);
+
+        headlesspWriteSummary(Context, Status);
+
+        //
+        // Push records of finished collector so partial results survive later failures.
+        //
+        if (!exportFlush(Context->Writer))
+            bResult = FALSE;
+
+        if (Status == HeadlessStatusFailed)
+            bResult = FALSE;
+
+        TRACE_END_DETAIL(Span, Context->CollectorName);
+    }
+
+    if (Context->Modules) {
+        supHeapFree(Context->Modules);
+        Context->Modules = NULL;
+    }
+
+    return bResult;
+}
+
+/*
+* headlessReportError
+*
+* Purpose:
+*
+* Write error message to standard error and log.
+*
+*/
+VOID headlessReportError(
+    _In_ LPCWSTR lpMessage
+)
+{
+    DWORD dwWritten;
+    HANDLE hStdError;
+    CHAR szMessage[512];
+    INT cbMessage;
+
+    logAdd(WOBJ_LOG_ENTRY_ERROR, (LPWSTR)lpMessage);
+
+    hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    if ((hStdError == NULL) || (hStdError == INVALID_HANDLE_VALUE))
+        return;
+
+    cbMessage = WideCharToMultiByte(CP_UTF8, 0, lpMessage, -1, szMessage, sizeof(szMessage) - 2, NULL, NULL);
+    if (cbMessage > 0) {
+        szMessage[cbMessage - 1] = '\r';
+        szMessage[cbMessage] = '\n';
+        WriteFile(hStdError, szMessage, (DWORD)cbMessage + 1, &dwWritten, NULL);
+    }
+}
+
+/*
+* headlessIsRequested
+*
+* Purpose:
+*
+* Check if headless switch is present in the program command line.
+*
+*/
+BOOL headlessIsRequested(
+    VOID
+)
+{
+    BOOL bResult = FALSE;
+    INT i, nArgs = 0;
+    LPWSTR* szArglist;
+
+    szArglist = CommandLineToArgvW(GetCommandLine(), &nArgs);
+    if (szArglist) {
+
+        for (i = 1; i < nArgs; i++) {
+            if (_strcmpi(szArglist[i], HEADLESS_SWITCH) == 0) {
+                bResult = TRUE;
+                break;
+            }
+        }
+
+        LocalFree(szArglist);
+    }
+
+    return bResult;
+}
+
+/*
+* headlessMain
+*
+* Purpose:
+*
+* Headless mode entry point, no windows are created.
+*
+* Returns ERROR_SUCCESS, ERROR_PARTIAL_COPY if any collector failed or error code.
+*
+*/
+UINT headlessMain(
+    VOID
+)
+{
+    UINT uResult = ERROR_SUCCESS;
+    BOOL bIsFullAdmin;
+    BOOLEAN IsWine;
+    INT i, nArgs = 0;
+    ULONG SelectedMask = MAXULONG;
+    HANDLE hStdOutput;
+    LPWSTR lpOutputFile = NULL;
+    LPWSTR* szArglist;
+    HEADLESS_CONTEXT Context;
+    TRACE_SPAN Span;
+
+    logCreate();
+    traceCreate();
+
+    TRACE_BEGIN(Span, "Headless");
+
+    RtlSecureZeroMemory(&Context, sizeof(Context));
+
+    szArglist = CommandLineToArgvW(GetCommandLine(), &nArgs);
+    if (szArglist == NULL) {
+        traceFree();
+        logFree();
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    do {
+
+        //
+        // Parse arguments.
+        //
+        for (i = 1; i < nArgs; i++) {
+
+            if (_strcmpi(szArglist[i], HEADLESS_SWITCH) == 0)
+                continue;
+
+            if (_strncmpi(szArglist[i], HEADLESS_SWITCH_COLLECT, _strlen(HEADLESS_SWITCH_COLLECT)) == 0) {
+                if (!headlesspSelectCollectors(&szArglist[i][_strlen(HEADLESS_SWITCH_COLLECT)], &SelectedMask)) {
+                    headlessReportError(TEXT("Headless: unknown collector name"));
+                    uResult = ERROR_INVALID_PARAMETER;
+                }
+            }
+            else if (_strncmpi(szArglist[i], HEADLESS_SWITCH_OUT, _strlen(HEADLESS_SWITCH_OUT)) == 0) {
+                lpOutputFile = &szArglist[i][_strlen(HEADLESS_SWITCH_OUT)];
+            }
+            else {
+                headlessReportError(TEXT("Headless: unknown switch"));
+                uResult = ERROR_INVALID_PARAMETER;
+            }
+        }
+
+        if (uResult != ERROR_SUCCESS)
+            break;
+
+        IsWine = supIsWine();
+
+        if (!supInitMSVCRT()) {
+            headlessReportError(T_WOBJINIT_NOCRT);
+            uResult = ERROR_APP_INIT_FAILURE;
+            break;
+        }
+
+        if (WinObjInitGlobals(IsWine) != wobjInitSuccess) {
+            headlessReportError(TEXT("Headless: could not initialize globals"));
+            uResult = ERROR_APP_INIT_FAILURE;
+            break;
+        }
+
+        //
+        // Support init must not show message boxes from now on.
+        //
+        g_WinObj.IsHeadless = TRUE;
+
+        logFileCreate();
+
+        bIsFullAdmin = (IsWine) ? FALSE : supUserIsFullAdmin();
+
+        supInit(bIsFullAdmin);
+
+        //
+        // Open output, standard output may need to be taken from the parent console.
+        //
+        if (lpOutputFile && *lpOutputFile) {
+            Context.Writer = exportCreate(lpOutputFile, ExportFormatJsonLines);
+        }
+        else {
+            hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+            if ((hStdOutput == NULL) || (hStdOutput == INVALID_HANDLE_VALUE)) {
+                if (AttachConsole(ATTACH_PARENT_PROCESS))
+                    hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+            }
+            Context.Writer = exportAttach(hStdOutput, ExportFormatJsonLines);
+        }
+
+        Context.Arena = arenaGetThreadArena();
+
+        if (Context.Writer == NULL || Context.Arena == NULL) {
+            headlessReportError(TEXT("Headless: could not open output"));
+            uResult = ERROR_OPEN_FAILED;
+        }
+        else {
+
+            if (!headlesspRunCollectors(&Context, SelectedMask))
+                uResult = ERROR_PARTIAL_COPY;
+
+            if (!exportClose(Context.Writer))
+                uResult = ERROR_WRITE_FAULT;
+        }
+
+        supShutdown();
+
+    } while (FALSE);
+
+    LocalFree(szArglist);
+
+    TRACE_END(Span);
+
+    traceFree();
+    logFree();
+
+    return uResult;
+}
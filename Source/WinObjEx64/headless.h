@@ -0,0 +1,74 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       HEADLESS.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the headless collection mode.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Command line switches.
+//
+// winobjex64.exe /headless [/collect:name[,name...]] [/out:file]
+//
+// Without /collect all collectors are run, without /out records are written to stdout.
+//
+#define HEADLESS_SWITCH             L"/headless"
+#define HEADLESS_SWITCH_COLLECT     L"/collect:"
+#define HEADLESS_SWITCH_OUT         L"/out:"
+
+//
+// Directory query buffer size, single batch of entries per call.
+//
+#define HEADLESS_QUERY_BUFFER_SIZE  0x10000
+
+//
+// Maximum object path length in WCHARs.
+//
+#define HEADLESS_MAX_PATH           (UNICODE_STRING_MAX_BYTES / sizeof(WCHAR))
+
+typedef struct _HEADLESS_CONTEXT {
+    PEXPORT_WRITER Writer;
+    PARENA Arena;
+    PRTL_PROCESS_MODULES Modules;
+    ULONG RecordCount;          //records written by current collector
+    LPCWSTR CollectorName;
+    LPWSTR PathBuffer;          //namespace collector only
+} HEADLESS_CONTEXT, *PHEADLESS_CONTEXT;
+
+typedef enum _HEADLESS_STATUS {
+    HeadlessStatusSuccess = 0,
+    HeadlessStatusFailed,
+    HeadlessStatusUnsupported,
+    HeadlessStatusNoDriver
+} HEADLESS_STATUS;
+
+typedef HEADLESS_STATUS(*PHEADLESS_COLLECTOR_ROUTINE)(
+    _In_ PHEADLESS_CONTEXT Context);
+
+typedef struct _HEADLESS_COLLECTOR {
+    LPCWSTR Name;
+    PHEADLESS_COLLECTOR_ROUTINE Routine;
+    BOOL RequiresDriver;
+} HEADLESS_COLLECTOR, *PHEADLESS_COLLECTOR;
+
+BOOL headlessIsRequested(
+    VOID);
+
+UINT headlessMain(
+    VOID);
+
+VOID headlessReportError(
+    _In_ LPCWSTR lpMessage);
@@ -0,0 +1,499 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDCACHE.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Persistent cache of kernel variables resolved by signature scanning.
+*
+*  Results are stored as RVAs together with identity of the image they were
+*  resolved from, so they survive reboots (KASLR) and are dropped as soon
+*  as the image is updated.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include "hde\hde64.h"
+
+//
+// Lock is never deleted, workers may still look up entries during shutdown
+// and see Initialized cleared under the lock.
+//
+typedef struct _KDCACHE_CONTEXT {
+    BOOL Initialized;
+    BOOL Dirty;
+    SRWLOCK Lock;
+    KDCACHE_FILE Data;
+    WCHAR szFileName[MAX_PATH * 2];
+} KDCACHE_CONTEXT, *PKDCACHE_CONTEXT;
+
+static KDCACHE_CONTEXT g_kdcache;
+
+/*
+* kdpCacheModuleFromId
+*
+* Purpose:
+*
+* Return image cache entry belongs to.
+*
+*/
+KDCACHE_MODULE kdpCacheModuleFromId(
+    _In_ KDCACHE_ID Id
+)
+{
+    if (Id == KdCacheWin32kApiSetTable)
+        return KdCacheModuleWin32k;
+
+    return KdCacheModuleNtOs;
+}
+
+/*
+* kdpCacheHash
+*
+* Purpose:
+*
+* Calculate sdbm hash of cache data.
+*
+*/
+ULONG kdpCacheHash(
+    _In_ PKDCACHE_FILE Data
+)
+{
+    ULONG hashValue = 0, cbData;
+    PBYTE ptr;
+
+    ptr = (PBYTE)&Data->Images;
+    cbData = sizeof(KDCACHE_FILE) - FIELD_OFFSET(KDCACHE_FILE, Images);
+
+    while (cbData-- != 0)
+        hashValue = (hashValue * 65599) + *ptr++;
+
+    return hashValue;
+}
+
+/*
+* kdpCacheQueryImageId
+*
+* Purpose:
+*
+* Read identity of mapped image from it headers.
+*
+*/
+BOOL kdpCacheQueryImageId(
+    _In_ PVOID MappedImageBase,
+    _Out_ PKDCACHE_IMAGE_ID ImageId
+)
+{
+    PIMAGE_NT_HEADERS NtHeaders;
+
+    RtlSecureZeroMemory(ImageId, sizeof(KDCACHE_IMAGE_ID));
+
+    NtHeaders = RtlImageNtHeader(MappedImageBase);
+    if (NtHeaders == NULL)
+        return FALSE;
+
+    if (NtHeaders->FileHeader.Machine != IMAGE_FILE_MACHINE_AMD64)
+        return FALSE;
+
+    ImageId->TimeDateStamp = NtHeaders->FileHeader.TimeDateStamp;
+    ImageId->SizeOfImage = NtHeaders->OptionalHeader.SizeOfImage;
+    ImageId->CheckSum = NtHeaders->OptionalHeader.CheckSum;
+
+    return TRUE;
+}
+
+/*
+* kdpCacheVerifySite
+*
+* Purpose:
+*
+* Decode instruction at cached site and check it still references target.
+*
+*/
+BOOL kdpCacheVerifySite(
+    _In_ PVOID MappedImageBase,
+    _In_ ULONG SizeOfImage,
+    _In_ ULONG SiteRva,
+    _In_ ULONG TargetRva
+)
+{
+    LONG Rel;
+    hde64s hs;
+
+    if (SiteRva >= SizeOfImage || SizeOfImage - SiteRva < 15)
+        return FALSE;
+
+    hde64_disasm(RtlOffsetToPointer(MappedImageBase, SiteRva), &hs);
+    if (hs.flags & F_ERROR)
+        return FALSE;
+
+    if ((hs.flags & F_MODRM) &&
+        (hs.modrm_mod == 0) &&
+        (hs.modrm_rm == 5))
+    {
+        Rel = (LONG)hs.disp.disp32;
+    }
+    else if ((hs.flags & F_RELATIVE) && (hs.flags & F_IMM32)) {
+        Rel = (LONG)hs.imm.imm32;
+    }
+    else {
+        return FALSE;
+    }
+
+    return ((ULONG)(SiteRva + hs.len + Rel) == TargetRva);
+}
+
+/*
+* kdpCacheLoad
+*
+* Purpose:
+*
+* Read and validate cache file.
+*
+*/
+BOOL kdpCacheLoad(
+    _In_ LPWSTR lpFileName,
+    _Out_ PKDCACHE_FILE Data
+)
+{
+    BOOL bResult = FALSE;
+    HANDLE hFile;
+    DWORD bytesIO = 0;
+
+    hFile = CreateFile(lpFileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (ReadFile(hFile, Data, sizeof(KDCACHE_FILE), &bytesIO, NULL) &&
+        bytesIO == sizeof(KDCACHE_FILE))
+    {
+        bResult = (Data->Signature == KDCACHE_SIGNATURE &&
+            Data->Version == KDCACHE_VERSION &&
+            Data->Size == sizeof(KDCACHE_FILE) &&
+            Data->Hash == kdpCacheHash(Data));
+    }
+
+    CloseHandle(hFile);
+    return bResult;
+}
+
+/*
+* kdpCacheResetModule
+*
+* Purpose:
+*
+* Drop all entries of given image and remember new image identity.
+*
+* Must be called with cache lock held.
+*
+*/
+VOID kdpCacheResetModule(
+    _In_ KDCACHE_MODULE Module,
+    _In_ PKDCACHE_IMAGE_ID ImageId
+)
+{
+    ULONG i;
+
+    for (i = 0; i < KdCacheMax; i++) {
+        if (kdpCacheModuleFromId((KDCACHE_ID)i) == Module) {
+            g_kdcache.Data.Entries[i].TargetRva = 0;
+            g_kdcache.Data.Entries[i].SiteRva = 0;
+        }
+    }
+
+    g_kdcache.Data.Images[Module] = *ImageId;
+    g_kdcache.Dirty = TRUE;
+}
+
+/*
+* kdCacheInitialize
+*
+* Purpose:
+*
+* Load resolver cache from disk, drop ntoskrnl part if kernel was updated.
+*
+* Must be called after ntoskrnl image has been mapped.
+*
+*/
+VOID kdCacheInitialize(
+    VOID
+)
+{
+    KDCACHE_IMAGE_ID ImageId;
+
+    RtlSecureZeroMemory(&g_kdcache, sizeof(g_kdcache));
+
+    InitializeSRWLock(&g_kdcache.Lock);
+
+    _strcpy(g_kdcache.szFileName, g_WinObj.szTempDirectory);
+    _strcat(g_kdcache.szFileName, KDCACHE_FILE_NAME);
+
+    if (!kdpCacheLoad(g_kdcache.szFileName, &g_kdcache.Data)) {
+        RtlSecureZeroMemory(&g_kdcache.Data, sizeof(KDCACHE_FILE));
+    }
+
+    if (g_kdctx.NtOsImageMap) {
+        if (kdpCacheQueryImageId(g_kdctx.NtOsImageMap, &ImageId)) {
+            if (RtlCompareMemory(&ImageId,
+                &g_kdcache.Data.Images[KdCacheModuleNtOs],
+                sizeof(KDCACHE_IMAGE_ID)) != sizeof(KDCACHE_IMAGE_ID))
+            {
+                kdpCacheResetModule(KdCacheModuleNtOs, &ImageId);
+            }
+        }
+    }
+
+    g_kdcache.Initialized = TRUE;
+}
+
+/*
+* kdCacheShutdown
+*
+* Purpose:
+*
+* Write resolver cache to disk if it was changed.
+*
+*/
+VOID kdCacheShutdown(
+    VOID
+)
+{
+    AcquireSRWLockExclusive(&g_kdcache.Lock);
+
+    if (g_kdcache.Initialized && g_kdcache.Dirty) {
+
+        g_kdcache.Data.Signature = KDCACHE_SIGNATURE;
+        g_kdcache.Data.Version = KDCACHE_VERSION;
+        g_kdcache.Data.Size = sizeof(KDCACHE_FILE);
+        g_kdcache.Data.Hash = kdpCacheHash(&g_kdcache.Data);
+
+        if (sizeof(KDCACHE_FILE) == supWriteBufferToFile(g_kdcache.szFileName,
+            &g_kdcache.Data,
+            sizeof(KDCACHE_FILE),
+            FALSE,
+            FALSE))
+        {
+            g_kdcache.Dirty = FALSE;
+        }
+    }
+
+    g_kdcache.Initialized = FALSE;
+
+    ReleaseSRWLockExclusive(&g_kdcache.Lock);
+}
+
+/*
+* kdCacheLookup
+*
+* Purpose:
+*
+* Return cached rva for given variable if it is still valid for mapped image.
+*
+* Cache file is user writable, so every entry is accepted only after its
+* referencing instruction has been decoded again.
+*
+*/
+BOOL kdCacheLookup(
+    _In_ KDCACHE_ID Id,
+    _In_ PVOID MappedImageBase,
+    _Out_ PULONG TargetRva
+)
+{
+    BOOL bResult = FALSE;
+    KDCACHE_MODULE Module;
+    KDCACHE_IMAGE_ID ImageId;
+    KDCACHE_ENTRY Entry;
+
+    *TargetRva = 0;
+
+    if (Id >= KdCacheMax || MappedImageBase == NULL)
+        return FALSE;
+
+    if (!kdpCacheQueryImageId(MappedImageBase, &ImageId))
+        return FALSE;
+
+    Module = kdpCacheModuleFromId(Id);
+
+    AcquireSRWLockExclusive(&g_kdcache.Lock);
+
+    __try {
+
+        if (g_kdcache.Initialized == FALSE)
+            __leave;
+
+        if (RtlCompareMemory(&ImageId,
+            &g_kdcache.Data.Images[Module],
+            sizeof(KDCACHE_IMAGE_ID)) != sizeof(KDCACHE_IMAGE_ID))
+        {
+            __leave;
+        }
+
+        Entry = g_kdcache.Data.Entries[Id];
+        if (Entry.TargetRva == 0 || Entry.TargetRva >= ImageId.SizeOfImage)
+            __leave;
+
+        if (Entry.SiteRva == 0 ||
+            !kdpCacheVerifySite(MappedImageBase,
+                ImageId.SizeOfImage,
+                Entry.SiteRva,
+                Entry.TargetRva))
+        {
+            kdDebugPrint("kdcache: entry %lu failed verification\r\n", Id);
+            g_kdcache.Data.Entries[Id].TargetRva = 0;
+            g_kdcache.Data.Entries[Id].SiteRva = 0;
+            g_kdcache.Dirty = TRUE;
+            __leave;
+        }
+
+        *TargetRva = Entry.TargetRva;
+        bResult = TRUE;
+
+    }
+    __finally {
+        ReleaseSRWLockExclusive(&g_kdcache.Lock);
+    }
+
+    return bResult;
+}
+
+/*
+* kdCacheStore
+*
+* Purpose:
+*
+* Remember resolved variable rva.
+*
+* SiteRva points to instruction referencing TargetRva, variable is not
+* remembered without it as lookup would have nothing to verify.
+*
+*/
+VOID kdCacheStore(
+    _In_ KDCACHE_ID Id,
+    _In_ PVOID MappedImageBase,
+    _In_ ULONG TargetRva,
+    _In_ ULONG SiteRva
+)
+{
+    KDCACHE_MODULE Module;
+    KDCACHE_IMAGE_ID ImageId;
+
+    if (Id >= KdCacheMax ||
+        MappedImageBase == NULL ||
+        TargetRva == 0 ||
+        SiteRva == 0)
+    {
+        return;
+    }
+
+    if (!kdpCacheQueryImageId(MappedImageBase, &ImageId))
+        return;
+
+    if (TargetRva >= ImageId.SizeOfImage)
+        return;
+
+    if (!kdpCacheVerifySite(MappedImageBase, ImageId.SizeOfImage, SiteRva, TargetRva))
+        return;
+
+    Module = kdpCacheModuleFromId(Id);
+
+    AcquireSRWLockExclusive(&g_kdcache.Lock);
+
+    if (g_kdcache.Initialized == FALSE) {
+        ReleaseSRWLockExclusive(&g_kdcache.Lock);
+        return;
+    }
+
+    if (RtlCompareMemory(&ImageId,
+        &g_kdcache.Data.Images[Module],
+        sizeof(KDCACHE_IMAGE_ID)) != sizeof(KDCACHE_IMAGE_ID))
+    {
+        kdpCacheResetModule(Module, &ImageId);
+    }
+
+    if (g_kdcache.Data.Entries[Id].TargetRva != TargetRva ||
+        g_kdcache.Data.Entries[Id].SiteRva != SiteRva)
+    {
+        g_kdcache.Data.Entries[Id].TargetRva = TargetRva;
+        g_kdcache.Data.Entries[Id].SiteRva = SiteRva;
+        g_kdcache.Dirty = TRUE;
+    }
+
+    ReleaseSRWLockExclusive(&g_kdcache.Lock);
+}
+
+/*
+* kdCacheLookupNtOsAddress
+*
+* Purpose:
+*
+* Return cached ntoskrnl variable as kernel address.
+*
+*/
+BOOL kdCacheLookupNtOsAddress(
+    _In_ KDCACHE_ID Id,
+    _Out_ PULONG_PTR Address
+)
+{
+    ULONG TargetRva;
+
+    *Address = 0;
+
+    if (g_kdctx.NtOsBase == NULL)
+        return FALSE;
+
+    if (!kdCacheLookup(Id, g_kdctx.NtOsImageMap, &TargetRva))
+        return FALSE;
+
+    *Address = (ULONG_PTR)g_kdctx.NtOsBase + TargetRva;
+    return TRUE;
+}
+
+/*
+* kdCacheStoreNtOsAddress
+*
+* Purpose:
+*
+* Remember resolved ntoskrnl variable given by kernel address.
+*
+* Referencing instruction is taken from ntoskrnl reference index, resolver
+* has just queried code around it, so nothing else is decoded here.
+*
+*/
+VOID kdCacheStoreNtOsAddress(
+    _In_ KDCACHE_ID Id,
+    _In_ ULONG_PTR Address
+)
+{
+    ULONG TargetRva, SiteRva = 0, Count = 0;
+    PREFINDEX RefIndex;
+    PREFINDEX_ENTRY Entry;
+
+    if (!kdAddressInNtOsImage((PVOID)Address))
+        return;
+
+    TargetRva = (ULONG)(Address - (ULONG_PTR)g_kdctx.NtOsBase);
+
+    RefIndex = kdQueryNtOsReferenceIndex();
+    if (RefIndex) {
+        Entry = refIndexFindByTarget(RefIndex, TargetRva, &Count);
+        if (Entry)
+            SiteRva = Entry->InstructionRva;
+    }
+
+    kdCacheStore(Id, g_kdctx.NtOsImageMap, TargetRva, SiteRva);
+}
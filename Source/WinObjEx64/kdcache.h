@@ -0,0 +1,103 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDCACHE.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the persistent kernel resolver cache.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+#define KDCACHE_FILE_NAME       L"\\winobjex64.kdc"
+#define KDCACHE_SIGNATURE       'CDKW'
+#define KDCACHE_VERSION         1
+
+//
+// Number of NOTIFICATION_CALLBACKS slots, each slot has it own cache entry.
+//
+#define KDCACHE_CALLBACK_SLOTS  (sizeof(NOTIFICATION_CALLBACKS) / sizeof(ULONG_PTR))
+
+typedef enum _KDCACHE_MODULE {
+    KdCacheModuleNtOs = 0,
+    KdCacheModuleWin32k,
+    KdCacheModuleMax
+} KDCACHE_MODULE;
+
+typedef enum _KDCACHE_ID {
+    KdCacheObHeaderCookie = 0,
+    KdCacheKeServiceDescriptorTableShadow,
+    KdCachePrivateNamespaceLookupTable,
+    KdCacheWin32kApiSetTable,
+    KdCacheSystemCallbacks, //first g_SystemCallbacks slot
+    KdCacheMax = KdCacheSystemCallbacks + KDCACHE_CALLBACK_SLOTS
+} KDCACHE_ID;
+
+//
+// Map g_SystemCallbacks field address to cache id.
+//
+#define KdCacheIdFromCallbackRef(Ref) \
+    (KDCACHE_ID)(KdCacheSystemCallbacks + (ULONG)(((ULONG_PTR)(Ref) - (ULONG_PTR)&g_SystemCallbacks) / sizeof(ULONG_PTR)))
+
+typedef struct _KDCACHE_IMAGE_ID {
+    ULONG TimeDateStamp;
+    ULONG SizeOfImage;
+    ULONG CheckSum;
+    ULONG Reserved;
+} KDCACHE_IMAGE_ID, *PKDCACHE_IMAGE_ID;
+
+//
+// TargetRva 0 means entry is not set.
+// SiteRva points to instruction that references TargetRva, it is verified
+// on every lookup, entries without site are not kept.
+//
+typedef struct _KDCACHE_ENTRY {
+    ULONG TargetRva;
+    ULONG SiteRva;
+} KDCACHE_ENTRY, *PKDCACHE_ENTRY;
+
+//
+// On-disk layout, Hash covers everything after it.
+//
+typedef struct _KDCACHE_FILE {
+    ULONG Signature;
+    ULONG Version;
+    ULONG Size;
+    ULONG Hash;
+    KDCACHE_IMAGE_ID Images[KdCacheModuleMax];
+    KDCACHE_ENTRY Entries[KdCacheMax];
+} KDCACHE_FILE, *PKDCACHE_FILE;
+
+VOID kdCacheInitialize(
+    VOID);
+
+VOID kdCacheShutdown(
+    VOID);
+
+BOOL kdCacheLookup(
+    _In_ KDCACHE_ID Id,
+    _In_ PVOID MappedImageBase,
+    _Out_ PULONG TargetRva);
+
+VOID kdCacheStore(
+    _In_ KDCACHE_ID Id,
+    _In_ PVOID MappedImageBase,
+    _In_ ULONG TargetRva,
+    _In_ ULONG SiteRva);
+
+BOOL kdCacheLookupNtOsAddress(
+    _In_ KDCACHE_ID Id,
+    _Out_ PULONG_PTR Address);
+
+VOID kdCacheStoreNtOsAddress(
+    _In_ KDCACHE_ID Id,
+    _In_ ULONG_PTR Address);
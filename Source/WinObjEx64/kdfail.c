@@ -0,0 +1,496 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDFAIL.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Kernel read failures tracking.
+*
+*  Pages that failed to read are remembered for a short time and reads
+*  touching them fail without driver call. Failures are only counted here,
+*  summary is written to the log once per refresh by kdFlushReadErrors.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+typedef struct _KDFAIL_CACHE_ENTRY {
+    ULONG_PTR Page;
+    ULONGLONG ExpireTime;
+} KDFAIL_CACHE_ENTRY, *PKDFAIL_CACHE_ENTRY;
+
+typedef struct _KDFAIL_COUNTER {
+    ULONG_PTR Key;
+    LPCWSTR FunctionName;
+    ULONG Failed;
+    ULONG FastFailed;
+} KDFAIL_COUNTER, *PKDFAIL_COUNTER;
+
+typedef struct _KDFAIL_STATE {
+    SRWLOCK Lock;
+    ULONG Failed;
+    ULONG FastFailed;
+    NTSTATUS LastStatus;
+    ULONG_PTR LastAddress;
+    ULONG CallerCount;
+    ULONG PageCount;
+    KDFAIL_COUNTER Callers[KDFAIL_MAX_CALLERS];
+    KDFAIL_COUNTER Pages[KDFAIL_MAX_PAGES];
+    KDFAIL_CACHE_ENTRY Cache[KDFAIL_CACHE_SIZE];
+} KDFAIL_STATE, *PKDFAIL_STATE;
+
+static KDFAIL_STATE g_kdfail; //SRWLOCK is zero initialized
+
+#define KDFAIL_CACHE_SLOT(Page) \
+    ((ULONG)(((Page) / PAGE_SIZE) ^ ((Page) / PAGE_SIZE / KDFAIL_CACHE_SIZE)) & (KDFAIL_CACHE_SIZE - 1))
+
+/*
+* kdpFailCounter
+*
+* Purpose:
+*
+* Find or add counter, return NULL if table is full.
+* FunctionName is remembered when first known.
+*
+* Lock must be held exclusive.
+*
+*/
+PKDFAIL_COUNTER kdpFailCounter(
+    _In_ PKDFAIL_COUNTER Table,
+    _Inout_ PULONG Count,
+    _In_ ULONG MaxCount,
+    _In_ ULONG_PTR Key,
+    _In_opt_ LPCWSTR FunctionName
+)
+{
+    ULONG i;
+
+    for (i = 0; i < *Count; i++) {
+        if (Table[i].Key == Key) {
+            if (Table[i].FunctionName == NULL)
+                Table[i].FunctionName = FunctionName;
+            return &Table[i];
+        }
+    }
+
+    if (*Count >= MaxCount)
+        return NULL;
+
+    i = *Count;
+    Table[i].Key = Key;
+    Table[i].FunctionName = FunctionName;
+    Table[i].Failed = 0;
+    Table[i].FastFailed = 0;
+    *Count += 1;
+
+    return &Table[i];
+}
+
+/*
+* kdpIsAddressFailure
+*
+* Purpose:
+*
+* Return FALSE for statuses that say nothing about memory at the address.
+*
+*/
+BOOL kdpIsAddressFailure(
+    _In_ NTSTATUS Status
+)
+{
+    switch (Status) {
+    case STATUS_INVALID_HANDLE:
+    case STATUS_ACCESS_DENIED:
+    case STATUS_PRIVILEGE_NOT_HELD:
+    case STATUS_DEBUGGER_INACTIVE:
+    case STATUS_INSUFFICIENT_RESOURCES:
+    case STATUS_NO_MEMORY:
+    case STATUS_INVALID_DEVICE_REQUEST:
+    case STATUS_DEVICE_DOES_NOT_EXIST:
+        return FALSE;
+    default:
+        break;
+    }
+    return TRUE;
+}
+
+/*
+* kdpReadFailLookup
+*
+* Purpose:
+*
+* Return TRUE and the page if range touches page that recently failed to read.
+*
+*/
+BOOL kdpReadFailLookup(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size,
+    _Out_ PULONG_PTR FailedPage
+)
+{
+    BOOL bKnownBad = FALSE;
+    ULONG_PTR Page, LastPage;
+    ULONGLONG CurrentTime;
+    PKDFAIL_CACHE_ENTRY Entry;
+
+    *FailedPage = 0;
+
+    if (Size == 0 || Address + Size < Address)
+        return FALSE;
+
+    Page = ALIGN_DOWN_BY(Address, PAGE_SIZE);
+    LastPage = ALIGN_DOWN_BY(Address + Size - 1, PAGE_SIZE);
+    CurrentTime = GetTickCount64();
+
+    AcquireSRWLockShared(&g_kdfail.Lock);
+
+    for (;;) {
+        Entry = &g_kdfail.Cache[KDFAIL_CACHE_SLOT(Page)];
+        if (Entry->Page == Page && Entry->ExpireTime > CurrentTime) {
+            *FailedPage = Page;
+            bKnownBad = TRUE;
+            break;
+        }
+        if (Page == LastPage)
+            break;
+        Page += PAGE_SIZE;
+    }
+
+    ReleaseSRWLockShared(&g_kdfail.Lock);
+
+    return bKnownBad;
+}
+
+/*
+* kdpReadFailRemember
+*
+* Purpose:
+*
+* Add single page range to the negative cache.
+*
+* Lock must be held exclusive.
+*
+*/
+VOID kdpReadFailRemember(
+    _In_ ULONG_PTR KernelAddress,
+    _In_ ULONG Size,
+    _In_ NTSTATUS Status
+)
+{
+    ULONG_PTR Page, LastPage;
+    PKDFAIL_CACHE_ENTRY Entry;
+
+    Page = ALIGN_DOWN_BY(KernelAddress, PAGE_SIZE);
+    LastPage = (Size) ? ALIGN_DOWN_BY(KernelAddress + Size - 1, PAGE_SIZE) : Page;
+
+    if ((Page == LastPage) && kdpIsAddressFailure(Status)) {
+        Entry = &g_kdfail.Cache[KDFAIL_CACHE_SLOT(Page)];
+        Entry->Page = Page;
+        Entry->ExpireTime = GetTickCount64() + KDFAIL_CACHE_TIMEOUT;
+    }
+}
+
+/*
+* kdReadFailKnown
+*
+* Purpose:
+*
+* Return TRUE if range touches page that recently failed to read.
+*
+* Unlike kdReadFailFast nothing is accounted, used by reads that cover
+* bytes nobody asked for (batch spans).
+*
+*/
+BOOL kdReadFailKnown(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size
+)
+{
+    ULONG_PTR Page;
+
+    return kdpReadFailLookup(Address, Size, &Page);
+}
+
+/*
+* kdReadFailRemember
+*
+* Purpose:
+*
+* Update negative cache after failed read without accounting it as failure.
+*
+*/
+VOID kdReadFailRemember(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size,
+    _In_ NTSTATUS Status
+)
+{
+    AcquireSRWLockExclusive(&g_kdfail.Lock);
+    kdpReadFailRemember(Address, Size, Status);
+    ReleaseSRWLockExclusive(&g_kdfail.Lock);
+}
+
+/*
+* kdReadFailFast
+*
+* Purpose:
+*
+* Return TRUE if range touches page that recently failed to read.
+*
+*/
+BOOL kdReadFailFast(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size,
+    _In_opt_ PVOID CallerAddress
+)
+{
+    BOOL bKnownBad;
+    ULONG_PTR Page;
+    PKDFAIL_COUNTER Counter;
+
+    bKnownBad = kdpReadFailLookup(Address, Size, &Page);
+
+    if (bKnownBad) {
+
+        AcquireSRWLockExclusive(&g_kdfail.Lock);
+
+        g_kdfail.FastFailed += 1;
+
+        Counter = kdpFailCounter(g_kdfail.Callers, &g_kdfail.CallerCount,
+            KDFAIL_MAX_CALLERS, (ULONG_PTR)CallerAddress, NULL);
+        if (Counter) Counter->FastFailed += 1;
+
+        Counter = kdpFailCounter(g_kdfail.Pages, &g_kdfail.PageCount,
+            KDFAIL_MAX_PAGES, Page, NULL);
+        if (Counter) Counter->FastFailed += 1;
+
+        ReleaseSRWLockExclusive(&g_kdfail.Lock);
+    }
+
+    return bKnownBad;
+}
+
+/*
+* kdReportReadError
+*
+* Purpose:
+*
+* Account failed driver call.
+*
+* Single page ranges are added to the negative cache, multi page ranges
+* are not as it is unknown which page failed.
+*
+*/
+VOID kdReportReadError(
+    _In_ LPWSTR FunctionName,
+    _In_ ULONG_PTR KernelAddress,
+    _In_ ULONG InputBufferLength,
+    _In_ NTSTATUS Status,
+    _In_ PIO_STATUS_BLOCK Iosb,
+    _In_opt_ PVOID CallerAddress
+)
+{
+    ULONG_PTR Page;
+    PKDFAIL_COUNTER Counter;
+
+    UNREFERENCED_PARAMETER(Iosb);
+
+    Page = ALIGN_DOWN_BY(KernelAddress, PAGE_SIZE);
+
+    kdDebugPrint("%ws 0x%lX, read at 0x%llX, size 0x%lX\r\n",
+        FunctionName, Status, KernelAddress, InputBufferLength);
+
+    AcquireSRWLockExclusive(&g_kdfail.Lock);
+
+    g_kdfail.Failed += 1;
+    g_kdfail.LastStatus = Status;
+    g_kdfail.LastAddress = KernelAddress;
+
+    Counter = kdpFailCounter(g_kdfail.Callers, &g_kdfail.CallerCount,
+        KDFAIL_MAX_CALLERS, (ULONG_PTR)CallerAddress, FunctionName);
+    if (Counter) Counter->Failed += 1;
+
+    Counter = kdpFailCounter(g_kdfail.Pages, &g_kdfail.PageCount,
+        KDFAIL_MAX_PAGES, Page, NULL);
+    if (Counter) Counter->Failed += 1;
+
+    kdpReadFailRemember(KernelAddress, InputBufferLength, Status);
+
+    ReleaseSRWLockExclusive(&g_kdfail.Lock);
+}
+
+/*
+* kdpFailTakeTop
+*
+* Purpose:
+*
+* Return index of counter with most failures and clear it, -1 if nothing left.
+*
+*/
+INT kdpFailTakeTop(
+    _In_ PKDFAIL_COUNTER Table,
+    _In_ ULONG Count,
+    _Out_ PKDFAIL_COUNTER Top
+)
+{
+    ULONG i, Best = 0, Total;
+    INT Index = -1;
+
+    for (i = 0; i < Count; i++) {
+        Total = Table[i].Failed + Table[i].FastFailed;
+        if (Total > Best) {
+            Best = Total;
+            Index = (INT)i;
+        }
+    }
+
+    if (Index >= 0) {
+        *Top = Table[Index];
+        Table[Index].Failed = 0;
+        Table[Index].FastFailed = 0;
+    }
+
+    return Index;
+}
+
+/*
+* kdpFailFormatCaller
+*
+* Purpose:
+*
+* Print caller as module+offset.
+*
+*/
+VOID kdpFailFormatCaller(
+    _In_ PKDFAIL_COUNTER Counter,
+    _Out_writes_(cchBuffer) LPWSTR Buffer,
+    _In_ SIZE_T cchBuffer
+)
+{
+    HMODULE hModule = NULL;
+    LPWSTR lpModule = NULL;
+    WCHAR szModule[MAX_PATH + 1];
+
+    szModule[0] = 0;
+
+    if (GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+        GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        (LPCWSTR)Counter->Key,
+        &hModule))
+    {
+        if (GetModuleFileName(hModule, szModule, MAX_PATH))
+            lpModule = PathFindFileName(szModule);
+    }
+
+    if (lpModule) {
+        RtlStringCchPrintfSecure(Buffer, cchBuffer,
+            TEXT("%ws+0x%llX"),
+            lpModule,
+            Counter->Key - (ULONG_PTR)hModule);
+    }
+    else {
+        RtlStringCchPrintfSecure(Buffer, cchBuffer,
+            TEXT("0x%llX"),
+            Counter->Key);
+    }
+}
+
+/*
+* kdFlushReadErrors
+*
+* Purpose:
+*
+* Write single log entry with failures accounted since previous flush and reset counters.
+*
+* Negative cache is dropped too, refresh is expected to see new memory state.
+*
+*/
+VOID kdFlushReadErrors(
+    VOID
+)
+{
+    ULONG i;
+    SIZE_T cchUsed;
+    PKDFAIL_STATE State;
+    KDFAIL_COUNTER Top;
+    WCHAR szCaller[MAX_PATH * 2];
+    WCHAR szBuffer[WOBJ_MAX_MESSAGE];
+
+    //
+    // Take snapshot of counters, format it without lock.
+    //
+    State = (PKDFAIL_STATE)supHeapAlloc(sizeof(KDFAIL_STATE));
+    if (State == NULL)
+        return;
+
+    AcquireSRWLockExclusive(&g_kdfail.Lock);
+
+    if (g_kdfail.Failed || g_kdfail.FastFailed) {
+        RtlCopyMemory(State, &g_kdfail, sizeof(KDFAIL_STATE));
+        RtlSecureZeroMemory(&g_kdfail.Failed,
+            sizeof(KDFAIL_STATE) - FIELD_OFFSET(KDFAIL_STATE, Failed));
+    }
+
+    ReleaseSRWLockExclusive(&g_kdfail.Lock);
+
+    if (State->Failed == 0 && State->FastFailed == 0) {
+        supHeapFree(State);
+        return;
+    }
+
+    RtlStringCchPrintfSecure(szBuffer,
+        RTL_NUMBER_OF(szBuffer),
+        TEXT("Kernel memory read failed %lu times, %lu more failed on known bad pages, last 0x%lX at 0x%llX. Callers:"),
+        State->Failed,
+        State->FastFailed,
+        State->LastStatus,
+        State->LastAddress);
+
+    for (i = 0; i < KDFAIL_SUMMARY_TOP; i++) {
+
+        if (kdpFailTakeTop(State->Callers, State->CallerCount, &Top) < 0)
+            break;
+
+        kdpFailFormatCaller(&Top, szCaller, RTL_NUMBER_OF(szCaller));
+
+        cchUsed = _strlen(szBuffer);
+        RtlStringCchPrintfSecure(&szBuffer[cchUsed],
+            RTL_NUMBER_OF(szBuffer) - cchUsed,
+            TEXT(" %ws (%ws) %lu/%lu;"),
+            szCaller,
+            (Top.FunctionName) ? Top.FunctionName : TEXT("-"),
+            Top.Failed,
+            Top.FastFailed);
+    }
+
+    cchUsed = _strlen(szBuffer);
+    RtlStringCchPrintfSecure(&szBuffer[cchUsed],
+        RTL_NUMBER_OF(szBuffer) - cchUsed,
+        TEXT(" Pages:"));
+
+    for (i = 0; i < KDFAIL_SUMMARY_TOP; i++) {
+
+        if (kdpFailTakeTop(State->Pages, State->PageCount, &Top) < 0)
+            break;
+
+        cchUsed = _strlen(szBuffer);
+        RtlStringCchPrintfSecure(&szBuffer[cchUsed],
+            RTL_NUMBER_OF(szBuffer) - cchUsed,
+            TEXT(" 0x%llX %lu/%lu;"),
+            Top.Key,
+            Top.Failed,
+            Top.FastFailed);
+    }
+
+    logAdd(WOBJ_LOG_ENTRY_ERROR, szBuffer);
+
+    supHeapFree(State);
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDFAIL.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the kernel read failures tracking.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Negative cache of pages that failed to read, power of two.
+//
+#define KDFAIL_CACHE_SIZE       256
+#define KDFAIL_CACHE_TIMEOUT    1000 //ms
+
+//
+// Failure counters, failures above limits are counted only in totals.
+//
+#define KDFAIL_MAX_CALLERS      32
+#define KDFAIL_MAX_PAGES        64
+#define KDFAIL_SUMMARY_TOP      5
+
+BOOL kdReadFailFast(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size,
+    _In_opt_ PVOID CallerAddress);
+
+BOOL kdReadFailKnown(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size);
+
+VOID kdReadFailRemember(
+    _In_ ULONG_PTR Address,
+    _In_ ULONG Size,
+    _In_ NTSTATUS Status);
+
+VOID kdReportReadError(
+    _In_ LPWSTR FunctionName,
+    _In_ ULONG_PTR KernelAddress,
+    _In_ ULONG InputBufferLength,
+    _In_ NTSTATUS Status,
+    _In_ PIO_STATUS_BLOCK Iosb,
+    _In_opt_ PVOID CallerAddress);
+
+VOID kdFlushReadErrors(
+    VOID);
@@ -0,0 +1,518 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDLIST.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Kernel linked list walker.
+*
+*  Lists are read as a snapshot: records are collected first (with read-ahead
+*  of the pages they live in and Brent cycle detection), optional tail data
+*  is fetched with a single batch and only then records are passed to caller.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+#define KDWALK_INITIAL_CAPACITY 16
+
+typedef struct _KDWALK_CONTEXT {
+    ULONG_PTR WindowBase;
+    ULONG WindowSize;
+    ULONG RecordStride;
+    ULONG Count;
+    ULONG Capacity;
+    PBYTE Records;
+    PULONG_PTR Addresses;
+    BYTE Window[KDWALK_WINDOW_SIZE];
+} KDWALK_CONTEXT, *PKDWALK_CONTEXT;
+
+/*
+* kdpWalkRead
+*
+* Purpose:
+*
+* Read kernel memory through the walk window.
+*
+* Pages covered by requested range are read as whole, so next records
+* allocated in the same pages are copied without driver round trip.
+*
+*/
+BOOL kdpWalkRead(
+    _In_ PKDWALK_CONTEXT Walk,
+    _In_ ULONG_PTR Address,
+    _Out_writes_bytes_(Size) PVOID Buffer,
+    _In_ ULONG Size
+)
+{
+    ULONG_PTR Base, End;
+
+    End = Address + Size;
+    if (End < Address)
+        return FALSE;
+
+    if ((Walk->WindowSize) &&
+        (Address >= Walk->WindowBase) &&
+        (End <= Walk->WindowBase + Walk->WindowSize))
+    {
+        RtlCopyMemory(Buffer, &Walk->Window[Address - Walk->WindowBase], Size);
+        return TRUE;
+    }
+
+    Base = ALIGN_DOWN_BY(Address, PAGE_SIZE);
+    End = ALIGN_UP_BY(End, PAGE_SIZE);
+
+    //
+    // Record is too big for window, read it as is.
+    //
+    if ((End == 0) || (End - Base > KDWALK_WINDOW_SIZE))
+        return kdReadSystemMemoryEx(Address, Buffer, Size, NULL);
+
+    Walk->WindowSize = 0;
+
+    if (!kdReadSystemMemoryEx(Base, Walk->Window, (ULONG)(End - Base), NULL))
+        return FALSE;
+
+    Walk->WindowBase = Base;
+    Walk->WindowSize = (ULONG)(End - Base);
+
+    RtlCopyMemory(Buffer, &Walk->Window[Address - Base], Size);
+    return TRUE;
+}
+
+/*
+* kdpWalkNextRecord
+*
+* Purpose:
+*
+* Convert link value to the record address, return 0 if list ends here.
+*
+*/
+ULONG_PTR kdpWalkNextRecord(
+    _In_ PKDWALK_PARAMS Params,
+    _In_ ULONG_PTR Link
+)
+{
+    if (Link == 0)
+        return 0;
+
+    if (Params->Flags & KDWALK_FLAG_NULL_TERMINATED)
+        return Link;
+
+    if (Link == Params->ListHead)
+        return 0;
+
+    return Link - Params->LinkOffset;
+}
+
+/*
+* kdpWalkGrow
+*
+* Purpose:
+*
+* Double records storage.
+*
+*/
+BOOL kdpWalkGrow(
+    _In_ PKDWALK_CONTEXT Walk
+)
+{
+    ULONG Capacity;
+    PBYTE Records;
+    PULONG_PTR Addresses;
+
+    Capacity = (Walk->Capacity) ? Walk->Capacity * 2 : KDWALK_INITIAL_CAPACITY;
+
+    Records = (PBYTE)supHeapAlloc((SIZE_T)Capacity * Walk->RecordStride);
+    if (Records == NULL)
+        return FALSE;
+
+    Addresses = (PULONG_PTR)supHeapAlloc((SIZE_T)Capacity * sizeof(ULONG_PTR));
+    if (Addresses == NULL) {
+        supHeapFree(Records);
+        return FALSE;
+    }
+
+    if (Walk->Count) {
+        RtlCopyMemory(Records, Walk->Records, (SIZE_T)Walk->Count * Walk->RecordStride);
+        RtlCopyMemory(Addresses, Walk->Addresses, (SIZE_T)Walk->Count * sizeof(ULONG_PTR));
+    }
+
+    if (Walk->Records) supHeapFree(Walk->Records);
+    if (Walk->Addresses) supHeapFree(Walk->Addresses);
+
+    Walk->Records = Records;
+    Walk->Addresses = Addresses;
+    Walk->Capacity = Capacity;
+    return TRUE;
+}
+
+/*
+* kdpWalkTrimCycle
+*
+* Purpose:
+*
+* Drop repeated records after cycle detected, CycleLength comes from Brent's algorithm.
+* NextRecord is the record that closed the cycle and it is not stored.
+*
+*/
+VOID kdpWalkTrimCycle(
+    _In_ PKDWALK_CONTEXT Walk,
+    _In_ ULONG CycleLength,
+    _In_ ULONG_PTR NextRecord
+)
+{
+    ULONG i, j;
+    ULONG_PTR Address;
+
+    for (i = 0; i + CycleLength <= Walk->Count; i++) {
+
+        j = i + CycleLength;
+        Address = (j < Walk->Count) ? Walk->Addresses[j] : NextRecord;
+
+        if (Walk->Addresses[i] == Address) {
+            Walk->Count = j;
+            break;
+        }
+    }
+}
+
+/*
+* kdpWalkValidateParams
+*
+* Purpose:
+*
+* Check walk parameters shared by all walk variants.
+*
+*/
+BOOL kdpWalkValidateParams(
+    _In_opt_ PKDWALK_PARAMS Params
+)
+{
+    if ((Params == NULL) ||
+        (Params->ListHead == 0) ||
+        (Params->RecordSize < sizeof(ULONG_PTR)) ||
+        (Params->LinkOffset > Params->RecordSize - sizeof(ULONG_PTR)))
+    {
+        return FALSE;
+    }
+
+    if (Params->TailSize &&
+        (Params->TailPointerOffset > Params->RecordSize - sizeof(ULONG_PTR)))
+    {
+        return FALSE;
+    }
+
+    if ((Params->Flags & KDWALK_FLAG_HEAD_IS_RECORD) &&
+        !(Params->Flags & KDWALK_FLAG_NULL_TERMINATED))
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+* kdpWalkCollect
+*
+* Purpose:
+*
+* Read list records into walk storage.
+*
+* Walk is bounded by cycle detection, MaxCount and Timeout, records read
+* before the stop are kept.
+*
+*/
+KDWALK_STATUS kdpWalkCollect(
+    _In_ PKDWALK_PARAMS Params,
+    _In_ PKDWALK_CONTEXT Walk
+)
+{
+    KDWALK_STATUS WalkStatus = KdWalkComplete;
+    ULONG MaxCount, Timeout;
+    ULONG Power = 1, Lambda = 1;
+    ULONG_PTR Link = 0, Record, Tortoise = 0;
+    ULONGLONG StartTime;
+    PBYTE RecordData;
+
+    MaxCount = (Params->MaxCount) ? Params->MaxCount : KDWALK_DEFAULT_MAX_COUNT;
+    Timeout = (Params->Timeout) ? Params->Timeout : KDWALK_DEFAULT_TIMEOUT;
+
+    //
+    // Locate first record.
+    //
+    if (Params->Flags & KDWALK_FLAG_HEAD_IS_RECORD) {
+        Record = Params->ListHead;
+    }
+    else {
+        if (!kdpWalkRead(Walk, Params->ListHead, &Link, sizeof(Link)))
+            return KdWalkReadError;
+
+        Record = kdpWalkNextRecord(Params, Link);
+    }
+
+    StartTime = GetTickCount64();
+
+    //
+    // Collect records.
+    //
+    while (Record) {
+
+        if (Walk->Count >= MaxCount) {
+            WalkStatus = KdWalkCountLimit;
+            break;
+        }
+
+        if (GetTickCount64() - StartTime > Timeout) {
+            WalkStatus = KdWalkTimeLimit;
+            break;
+        }
+
+        if (Record < g_kdctx.SystemRangeStart) {
+            WalkStatus = KdWalkReadError;
+            break;
+        }
+
+        //
+        // Brent's cycle detection over record addresses.
+        //
+        if (Record == Tortoise) {
+            kdpWalkTrimCycle(Walk, Lambda, Record);
+            WalkStatus = KdWalkCycle;
+            break;
+        }
+
+        if (Power == Lambda) {
+            Tortoise = Record;
+            Power <<= 1;
+            Lambda = 0;
+        }
+        Lambda += 1;
+
+        if (Walk->Count == Walk->Capacity) {
+            if (!kdpWalkGrow(Walk)) {
+                WalkStatus = KdWalkNoMemory;
+                break;
+            }
+        }
+
+        RecordData = &Walk->Records[(SIZE_T)Walk->Count * Walk->RecordStride];
+
+        if (!kdpWalkRead(Walk, Record, RecordData, Params->RecordSize)) {
+            WalkStatus = KdWalkReadError;
+            break;
+        }
+
+        Walk->Addresses[Walk->Count] = Record;
+        Walk->Count += 1;
+
+        Link = *(PULONG_PTR)&RecordData[Params->LinkOffset];
+        Record = kdpWalkNextRecord(Params, Link);
+    }
+
+    if (WalkStatus == KdWalkCycle) {
+        kdDebugPrint("%s cycle detected in list 0x%llX\r\n", __FUNCTION__, Params->ListHead);
+    }
+
+    return WalkStatus;
+}
+
+/*
+* kdWalkList
+*
+* Purpose:
+*
+* Walk kernel linked list and pass every record to the callback.
+*
+* Walk is bounded by cycle detection, MaxCount and Timeout, records read
+* before the stop are still passed to the callback.
+*
+* Return value is the number of records passed to the callback.
+*
+*/
+ULONG kdWalkList(
+    _In_ PKDWALK_PARAMS Params,
+    _Out_opt_ KDWALK_STATUS *Status
+)
+{
+    KDWALK_STATUS WalkStatus = KdWalkInvalidParameter;
+    ULONG i, Result = 0, TailStride = 0;
+    ULONG_PTR TailAddress;
+    PBYTE RecordData, TailData;
+    PKDWALK_CONTEXT Walk = NULL;
+    PKDREAD_REQUEST Requests = NULL;
+
+    if (Status)
+        *Status = KdWalkInvalidParameter;
+
+    if (!kdpWalkValidateParams(Params))
+        return 0;
+
+    Walk = (PKDWALK_CONTEXT)supHeapAlloc(sizeof(KDWALK_CONTEXT));
+    if (Walk == NULL) {
+        if (Status) *Status = KdWalkNoMemory;
+        return 0;
+    }
+
+    Walk->RecordStride = (ULONG)ALIGN_UP_BY(Params->RecordSize, sizeof(ULONG_PTR));
+
+    __try {
+
+        WalkStatus = kdpWalkCollect(Params, Walk);
+
+        if (Walk->Count == 0)
+            __leave;
+
+        //
+        // Read tail data of all records at once.
+        //
+        if (Params->TailSize) {
+
+            TailStride = (ULONG)ALIGN_UP_BY(Params->TailSize, sizeof(ULONG_PTR));
+
+            Requests = (PKDREAD_REQUEST)supHeapAlloc((SIZE_T)Walk->Count *
+                (sizeof(KDREAD_REQUEST) + TailStride));
+
+            if (Requests) {
+
+                TailData = (PBYTE)&Requests[Walk->Count];
+
+                for (i = 0; i < Walk->Count; i++) {
+                    RecordData = &Walk->Records[(SIZE_T)i * Walk->RecordStride];
+                    TailAddress = *(PULONG_PTR)&RecordData[Params->TailPointerOffset];
+                    if (TailAddress)
+                        Requests[i].Address = TailAddress + (LONG_PTR)Params->TailPointerBias;
+                    Requests[i].Buffer = &TailData[(SIZE_T)i * TailStride];
+                    Requests[i].Size = Params->TailSize;
+                }
+
+                kdReadSystemMemoryBatch(Requests, Walk->Count);
+            }
+        }
+
+        //
+        // Pass records to the caller.
+        //
+        for (i = 0; i < Walk->Count; i++) {
+
+            Result += 1;
+
+            if (Params->Callback == NULL)
+                continue;
+
+            TailData = NULL;
+            if (Requests && Requests[i].Result)
+                TailData = (PBYTE)Requests[i].Buffer;
+
+            if (!Params->Callback(Walk->Addresses[i],
+                &Walk->Records[(SIZE_T)i * Walk->RecordStride],
+                TailData,
+                Params->Context))
+            {
+                if (WalkStatus == KdWalkComplete)
+                    WalkStatus = KdWalkStopped;
+                break;
+            }
+        }
+
+    }
+    __finally {
+
+        if (AbnormalTermination())
+            supReportAbnormalTermination(__FUNCTIONW__);
+
+        if (Requests) supHeapFree(Requests);
+        if (Walk->Records) supHeapFree(Walk->Records);
+        if (Walk->Addresses) supHeapFree(Walk->Addresses);
+        supHeapFree(Walk);
+    }
+
+    if (Status)
+        *Status = WalkStatus;
+
+    return Result;
+}
+
+/*
+* kdWalkListRecords
+*
+* Purpose:
+*
+* Walk kernel linked list and return records as array of RecordSize elements.
+*
+* Records are read straight into the returned array, Callback and tail
+* parameters are ignored. Records read before the walk stopped are returned
+* together with the status that stopped it.
+*
+* Returned buffer must be released with supHeapFree.
+*
+*/
+PVOID kdWalkListRecords(
+    _In_ PKDWALK_PARAMS Params,
+    _Out_ PULONG NumberOfRecords,
+    _Out_ KDWALK_STATUS *Status
+)
+{
+    KDWALK_STATUS WalkStatus = KdWalkInvalidParameter;
+    ULONG i;
+    PBYTE Records = NULL;
+    PKDWALK_CONTEXT Walk;
+
+    *NumberOfRecords = 0;
+    *Status = KdWalkInvalidParameter;
+
+    if (!kdpWalkValidateParams(Params))
+        return NULL;
+
+    Walk = (PKDWALK_CONTEXT)supHeapAlloc(sizeof(KDWALK_CONTEXT));
+    if (Walk == NULL) {
+        *Status = KdWalkNoMemory;
+        return NULL;
+    }
+
+    Walk->RecordStride = (ULONG)ALIGN_UP_BY(Params->RecordSize, sizeof(ULONG_PTR));
+
+    __try {
+
+        WalkStatus = kdpWalkCollect(Params, Walk);
+
+        if (Walk->Count == 0)
+            __leave;
+
+        //
+        // Pack records in place if stride was padded.
+        //
+        if (Walk->RecordStride != Params->RecordSize) {
+            for (i = 1; i < Walk->Count; i++) {
+                RtlMoveMemory(&Walk->Records[(SIZE_T)i * Params->RecordSize],
+                    &Walk->Records[(SIZE_T)i * Walk->RecordStride],
+                    Params->RecordSize);
+            }
+        }
+
+        Records = Walk->Records;
+        Walk->Records = NULL;
+        *NumberOfRecords = Walk->Count;
+
+    }
+    __finally {
+
+        if (AbnormalTermination())
+            supReportAbnormalTermination(__FUNCTIONW__);
+
+        if (Walk->Records) supHeapFree(Walk->Records);
+        if (Walk->Addresses) supHeapFree(Walk->Addresses);
+        supHeapFree(Walk);
+    }
+
+    *Status = WalkStatus;
+    return Records;
+}
@@ -0,0 +1,84 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDLIST.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the kernel linked list walker.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// List walker flags.
+//
+// Default: ListHead is address of LIST_ENTRY (or pointer) that links first record,
+// every link points to LinkOffset inside record, walk ends when link is back to ListHead.
+//
+#define KDWALK_FLAG_NULL_TERMINATED     0x00000001 //links point to record start, NULL ends list
+#define KDWALK_FLAG_HEAD_IS_RECORD      0x00000002 //ListHead is address of the first record, NULL_TERMINATED only
+
+#define KDWALK_DEFAULT_MAX_COUNT        0x10000
+#define KDWALK_DEFAULT_TIMEOUT          5000 //ms
+
+//
+// Read-ahead window, records that share pages with previously read record are served from it.
+//
+#define KDWALK_WINDOW_SIZE              (PAGE_SIZE * 2)
+
+typedef enum _KDWALK_STATUS {
+    KdWalkComplete = 0,
+    KdWalkStopped,          //callback returned FALSE
+    KdWalkReadError,
+    KdWalkCycle,
+    KdWalkCountLimit,
+    KdWalkTimeLimit,
+    KdWalkInvalidParameter,
+    KdWalkNoMemory
+} KDWALK_STATUS;
+
+//
+// Record points to copy of RecordSize bytes, TailData is NULL when no tail requested or tail read failed.
+// Return FALSE to stop enumeration.
+//
+typedef BOOL(CALLBACK *PKDWALK_CALLBACK)(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context);
+
+//
+// Optional tail: pointer read from record at TailPointerOffset, adjusted by TailPointerBias,
+// TailSize bytes are read from there for every record in a single batch after walk.
+//
+typedef struct _KDWALK_PARAMS {
+    ULONG_PTR ListHead;
+    ULONG LinkOffset;
+    ULONG RecordSize;
+    ULONG Flags;
+    ULONG MaxCount;         //0 - KDWALK_DEFAULT_MAX_COUNT
+    ULONG Timeout;          //0 - KDWALK_DEFAULT_TIMEOUT
+    ULONG TailPointerOffset;
+    LONG TailPointerBias;
+    ULONG TailSize;         //0 - no tail
+    PKDWALK_CALLBACK Callback;
+    PVOID Context;
+} KDWALK_PARAMS, *PKDWALK_PARAMS;
+
+ULONG kdWalkList(
+    _In_ PKDWALK_PARAMS Params,
+    _Out_opt_ KDWALK_STATUS *Status);
+
+PVOID kdWalkListRecords(
+    _In_ PKDWALK_PARAMS Params,
+    _Out_ PULONG NumberOfRecords,
+    _Out_ KDWALK_STATUS *Status);
@@ -0,0 +1,447 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDSTATS.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Kernel read statistics.
+*
+*  Every thread that reads kernel memory owns a block of per site counters,
+*  only the owner thread writes to it so recording takes no locks. Blocks are
+*  never freed, block of exited thread is reused by the next new thread.
+*  kdStatsQuery merges all blocks on demand.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+typedef struct _KDSTATS_BLOCK {
+    struct _KDSTATS_BLOCK* Next;
+    volatile LONG InUse;
+    KDSTATS_SITE Sites[KDSTATS_MAX_SITES + 1]; //last is "other" site
+} KDSTATS_BLOCK, *PKDSTATS_BLOCK;
+
+typedef struct _KDSTATS_STATE {
+    DWORD FlsIndex;
+    LONGLONG Frequency;
+    PKDSTATS_BLOCK volatile Blocks;
+    SRWLOCK BaselineLock;
+    ULONG BaselineCount;
+    KDSTATS_SITE Baseline[KDSTATS_MAX_MERGED];
+} KDSTATS_STATE, *PKDSTATS_STATE;
+
+static KDSTATS_STATE g_kdstats = { FLS_OUT_OF_INDEXES };
+
+//
+// Single instance, sites are compared by pointer.
+//
+static const CHAR kdpStatsOtherSite[] = KDSTATS_OTHER_SITE;
+
+#define KDSTATS_SITE_SLOT(Site, Module) \
+    ((ULONG)((((ULONG_PTR)(Site) ^ (ULONG_PTR)(Module)) >> 3) * 0x9E3779B1) & (KDSTATS_MAX_SITES - 1))
+
+/*
+* kdpStatsThreadExit
+*
+* Purpose:
+*
+* Fls callback, release block of exiting thread for reuse.
+*
+*/
+VOID NTAPI kdpStatsThreadExit(
+    _In_ PVOID FlsData
+)
+{
+    PKDSTATS_BLOCK Block = (PKDSTATS_BLOCK)FlsData;
+
+    if (Block)
+        InterlockedExchange(&Block->InUse, 0);
+}
+
+/*
+* kdpStatsAcquireBlock
+*
+* Purpose:
+*
+* Return block of current thread, reuse released block or allocate new one.
+*
+*/
+PKDSTATS_BLOCK kdpStatsAcquireBlock(
+    VOID
+)
+{
+    PKDSTATS_BLOCK Block, Head;
+
+    Block = (PKDSTATS_BLOCK)FlsGetValue(g_kdstats.FlsIndex);
+    if (Block)
+        return Block;
+
+    for (Block = g_kdstats.Blocks; Block; Block = Block->Next) {
+        if (InterlockedCompareExchange(&Block->InUse, 1, 0) == 0)
+            break;
+    }
+
+    if (Block == NULL) {
+
+        Block = (PKDSTATS_BLOCK)supHeapAlloc(sizeof(KDSTATS_BLOCK));
+        if (Block == NULL)
+            return NULL;
+
+        Block->InUse = 1;
+        Block->Sites[KDSTATS_MAX_SITES].Site = kdpStatsOtherSite;
+
+        do {
+            Head = g_kdstats.Blocks;
+            Block->Next = Head;
+        } while (InterlockedCompareExchangePointer((PVOID volatile*)&g_kdstats.Blocks,
+            Block, Head) != Head);
+    }
+
+    if (!FlsSetValue(g_kdstats.FlsIndex, Block)) {
+        InterlockedExchange(&Block->InUse, 0);
+        return NULL;
+    }
+
+    return Block;
+}
+
+/*
+* kdpStatsThreadSite
+*
+* Purpose:
+*
+* Find or add site in the thread block.
+* Key is published last so merging thread never sees half filled entry.
+*
+*/
+PKDSTATS_SITE kdpStatsThreadSite(
+    _In_ PKDSTATS_BLOCK Block,
+    _In_ LPCSTR Site,
+    _In_opt_ PVOID Module
+)
+{
+    ULONG i, Slot;
+    PKDSTATS_SITE Entry;
+
+    Slot = KDSTATS_SITE_SLOT(Site, Module);
+
+    for (i = 0; i < KDSTATS_MAX_SITES; i++) {
+
+        Entry = &Block->Sites[(Slot + i) & (KDSTATS_MAX_SITES - 1)];
+
+        if (Entry->Site == NULL) {
+            Entry->Module = Module;
+            InterlockedExchangePointer((PVOID volatile*)&Entry->Site, (PVOID)Site);
+            return Entry;
+        }
+
+        if ((Entry->Site == Site) && (Entry->Module == Module))
+            return Entry;
+    }
+
+    return &Block->Sites[KDSTATS_MAX_SITES];
+}
+
+/*
+* kdpStatsBucket
+*
+* Purpose:
+*
+* Convert latency to histogram bucket index.
+*
+*/
+ULONG kdpStatsBucket(
+    _In_ ULONG64 Latency
+)
+{
+    ULONG Index;
+
+    if (Latency == 0)
+        return 0;
+
+    _BitScanReverse64(&Index, Latency);
+    Index += 1;
+
+    return (Index < KDSTATS_HISTOGRAM_BUCKETS) ? Index : KDSTATS_HISTOGRAM_BUCKETS - 1;
+}
+
+/*
+* kdStatsInitialize
+*
+* Purpose:
+*
+* Allocate per thread storage slot, called once from kdInit.
+*
+*/
+VOID kdStatsInitialize(
+    VOID
+)
+{
+    LARGE_INTEGER Frequency;
+
+    InitializeSRWLock(&g_kdstats.BaselineLock);
+
+    if (QueryPerformanceFrequency(&Frequency))
+        g_kdstats.Frequency = Frequency.QuadPart;
+
+    if (g_kdstats.FlsIndex == FLS_OUT_OF_INDEXES)
+        g_kdstats.FlsIndex = FlsAlloc((PFLS_CALLBACK_FUNCTION)kdpStatsThreadExit);
+}
+
+/*
+* kdStatsRecord
+*
+* Purpose:
+*
+* Account single kernel read, StartTime is performance counter value taken before read.
+*
+*/
+VOID kdStatsRecord(
+    _In_ LPCSTR Site,
+    _In_opt_ PVOID Module,
+    _In_ ULONG Bytes,
+    _In_ BOOL Success,
+    _In_ LONGLONG StartTime
+)
+{
+    ULONG64 Latency = 0;
+    LARGE_INTEGER EndTime;
+    PKDSTATS_BLOCK Block;
+    PKDSTATS_SITE Entry;
+
+    if ((g_kdstats.FlsIndex == FLS_OUT_OF_INDEXES) || (g_kdstats.Frequency == 0))
+        return;
+
+    QueryPerformanceCounter(&EndTime);
+
+    Block = kdpStatsAcquireBlock();
+    if (Block == NULL)
+        return;
+
+    if (EndTime.QuadPart > StartTime)
+        Latency = (ULONG64)(EndTime.QuadPart - StartTime) * 1000000 / g_kdstats.Frequency;
+
+    Entry = kdpStatsThreadSite(Block, Site, Module);
+
+    Entry->Calls += 1;
+    if (Success)
+        Entry->Bytes += Bytes;
+    else
+        Entry->Failures += 1;
+    Entry->TotalTime += Latency;
+    Entry->Histogram[kdpStatsBucket(Latency)] += 1;
+}
+
+/*
+* kdpStatsMergeSite
+*
+* Purpose:
+*
+* Add (Subtract == FALSE) or subtract counters of Source to the matching entry of Table.
+* Real sites take at most MaxCount - 1 entries, the remaining one is reserved
+* for "other" site where sites that do not fit are merged.
+*
+*/
+VOID kdpStatsMergeSite(
+    _Inout_updates_(MaxCount) PKDSTATS_SITE Table,
+    _Inout_ PULONG Count,
+    _In_ ULONG MaxCount,
+    _In_ PKDSTATS_SITE Source,
+    _In_ BOOL Subtract
+)
+{
+    ULONG i;
+    PKDSTATS_SITE Entry = NULL, Other = NULL;
+
+    for (i = 0; i < *Count; i++) {
+        if ((Table[i].Site == Source->Site) && (Table[i].Module == Source->Module)) {
+            Entry = &Table[i];
+            break;
+        }
+        if (Table[i].Site == kdpStatsOtherSite)
+            Other = &Table[i];
+    }
+
+    if (Entry == NULL) {
+
+        if (Subtract)
+            return;
+
+        if ((*Count + 1 < MaxCount) ||
+            (Source->Site == kdpStatsOtherSite && *Count < MaxCount))
+        {
+            Entry = &Table[*Count];
+            *Count += 1;
+            Entry->Site = Source->Site;
+            Entry->Module = Source->Module;
+        }
+        else if (Other) {
+            Entry = Other;
+        }
+        else if (*Count < MaxCount) {
+            Entry = &Table[*Count];
+            *Count += 1;
+            Entry->Site = kdpStatsOtherSite;
+            Entry->Module = NULL;
+        }
+        else {
+            return;
+        }
+    }
+
+    if (Subtract) {
+        Entry->Calls -= min(Entry->Calls, Source->Calls);
+        Entry->Bytes -= min(Entry->Bytes, Source->Bytes);
+        Entry->Failures -= min(Entry->Failures, Source->Failures);
+        Entry->TotalTime -= min(Entry->TotalTime, Source->TotalTime);
+        for (i = 0; i < KDSTATS_HISTOGRAM_BUCKETS; i++)
+            Entry->Histogram[i] -= min(Entry->Histogram[i], Source->Histogram[i]);
+    }
+    else {
+        Entry->Calls += Source->Calls;
+        Entry->Bytes += Source->Bytes;
+        Entry->Failures += Source->Failures;
+        Entry->TotalTime += Source->TotalTime;
+        for (i = 0; i < KDSTATS_HISTOGRAM_BUCKETS; i++)
+            Entry->Histogram[i] += Source->Histogram[i];
+    }
+}
+
+/*
+* kdpStatsMerge
+*
+* Purpose:
+*
+* Sum counters of all thread blocks, return number of sites.
+*
+*/
+ULONG kdpStatsMerge(
+    _Out_writes_to_(MaxCount, return) PKDSTATS_SITE Sites,
+    _In_ ULONG MaxCount
+)
+{
+    ULONG i, Count = 0;
+    LPCSTR Site;
+    PKDSTATS_BLOCK Block;
+    KDSTATS_SITE Snapshot;
+
+    RtlSecureZeroMemory(Sites, MaxCount * sizeof(KDSTATS_SITE));
+
+    for (Block = g_kdstats.Blocks; Block; Block = Block->Next) {
+
+        for (i = 0; i <= KDSTATS_MAX_SITES; i++) {
+
+            Site = *(LPCSTR volatile*)&Block->Sites[i].Site;
+            if (Site == NULL)
+                continue;
+
+            RtlCopyMemory(&Snapshot, &Block->Sites[i], sizeof(KDSTATS_SITE));
+            if (Snapshot.Calls == 0)
+                continue;
+
+            Snapshot.Site = Site;
+            kdpStatsMergeSite(Sites, &Count, MaxCount, &Snapshot, FALSE);
+        }
+    }
+
+    return Count;
+}
+
+/*
+* kdStatsQuery
+*
+* Purpose:
+*
+* Return merged counters since program start or last kdStatsReset.
+*
+*/
+ULONG kdStatsQuery(
+    _Out_writes_to_(MaxCount, return) PKDSTATS_SITE Sites,
+    _In_ ULONG MaxCount
+)
+{
+    ULONG i, j, Count;
+
+    if ((Sites == NULL) || (MaxCount == 0))
+        return 0;
+
+    Count = kdpStatsMerge(Sites, MaxCount);
+
+    AcquireSRWLockShared(&g_kdstats.BaselineLock);
+
+    for (i = 0; i < g_kdstats.BaselineCount; i++)
+        kdpStatsMergeSite(Sites, &Count, MaxCount, &g_kdstats.Baseline[i], TRUE);
+
+    ReleaseSRWLockShared(&g_kdstats.BaselineLock);
+
+    //
+    // Drop sites without calls after reset.
+    //
+    for (i = 0, j = 0; i < Count; i++) {
+        if (Sites[i].Calls) {
+            if (i != j)
+                RtlCopyMemory(&Sites[j], &Sites[i], sizeof(KDSTATS_SITE));
+            j += 1;
+        }
+    }
+
+    return j;
+}
+
+/*
+* kdStatsReset
+*
+* Purpose:
+*
+* Remember current counters as baseline, thread blocks are not touched.
+*
+*/
+VOID kdStatsReset(
+    VOID
+)
+{
+    AcquireSRWLockExclusive(&g_kdstats.BaselineLock);
+    g_kdstats.BaselineCount = kdpStatsMerge(g_kdstats.Baseline, KDSTATS_MAX_MERGED);
+    ReleaseSRWLockExclusive(&g_kdstats.BaselineLock);
+}
+
+/*
+* kdStatsPercentile
+*
+* Purpose:
+*
+* Return upper bound in us of histogram bucket where given percent of calls falls.
+*
+*/
+ULONG64 kdStatsPercentile(
+    _In_ PKDSTATS_SITE Site,
+    _In_ ULONG Percent
+)
+{
+    ULONG i;
+    ULONG64 Total = 0, Target, Sum = 0;
+
+    for (i = 0; i < KDSTATS_HISTOGRAM_BUCKETS; i++)
+        Total += Site->Histogram[i];
+
+    if (Total == 0)
+        return 0;
+
+    Target = (Total * Percent + 99) / 100;
+
+    for (i = 0; i < KDSTATS_HISTOGRAM_BUCKETS - 1; i++) {
+        Sum += Site->Histogram[i];
+        if (Sum >= Target)
+            break;
+    }
+
+    return 1ULL << i;
+}
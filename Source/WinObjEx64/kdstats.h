@@ -0,0 +1,69 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       KDSTATS.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the kernel read statistics.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Sites per thread, power of two. Sites above limit are counted in "other" site.
+//
+#define KDSTATS_MAX_SITES           128
+
+//
+// Merged sites limit for kdStatsQuery.
+//
+#define KDSTATS_MAX_MERGED          (KDSTATS_MAX_SITES * 2)
+
+//
+// Bucket 0 counts reads faster than 1us, bucket N counts [2^(N-1), 2^N) us,
+// last bucket counts everything slower.
+//
+#define KDSTATS_HISTOGRAM_BUCKETS   20
+
+#define KDSTATS_OTHER_SITE          "(other)"
+#define KDSTATS_PLUGIN_SITE         "(plugin)"
+
+typedef struct _KDSTATS_SITE {
+    LPCSTR Site;
+    PVOID Module; //plugin module base, NULL for program sites
+    ULONG64 Calls;
+    ULONG64 Bytes;
+    ULONG64 Failures;
+    ULONG64 TotalTime; //us
+    ULONG64 Histogram[KDSTATS_HISTOGRAM_BUCKETS];
+} KDSTATS_SITE, *PKDSTATS_SITE;
+
+VOID kdStatsInitialize(
+    VOID);
+
+VOID kdStatsRecord(
+    _In_ LPCSTR Site,
+    _In_opt_ PVOID Module,
+    _In_ ULONG Bytes,
+    _In_ BOOL Success,
+    _In_ LONGLONG StartTime);
+
+ULONG kdStatsQuery(
+    _Out_writes_to_(MaxCount, return) PKDSTATS_SITE Sites,
+    _In_ ULONG MaxCount);
+
+VOID kdStatsReset(
+    VOID);
+
+ULONG64 kdStatsPercentile(
+    _In_ PKDSTATS_SITE Site,
+    _In_ ULONG Percent);
@@ -17,8 +17,9 @@
 *
 *******************************************************************************/
 #include "global.h"
+#include <intrin.h>
 #include "ntos\ntldr.h"
-#include "hde\hde64.h"
+#include "hde\hde64len.h"
 #include "kldbg_patterns.h"
 
 //
@@ -62,7 +63,10 @@ VOID kdpShowNtStatus(
         lpFunction,
         ntStatus);
 
-    MessageBox(GetDesktopWindow(), szBuffer, NULL, MB_OK);
+    if (g_WinObj.IsHeadless)
+        headlessReportError(szBuffer);
+    else
+        MessageBox(GetDesktopWindow(), szBuffer, NULL, MB_OK);
 }
 
 /*
@@ -437,16 +441,42 @@ ULONG_PTR ObFindAddress(
 {
     ULONG_PTR   Address;
     PBYTE       ptrCode = PtrCode;
-    ULONG       Index = 0;
+    ULONG       Index = 0, Rva;
     LONG        Rel = 0;
-    hde64s      hs;
+    ULONG       Length = 0, Flags;
+
+    PREFINDEX       RefIndex = NULL;
+    PREFINDEX_ENTRY RefEntry;
+
+    //
+    // Query ntoskrnl reference index, it decodes only code being searched.
+    //
+    if (MappedImageBase == (ULONG_PTR)g_kdctx.NtOsImageMap)
+        RefIndex = kdQueryNtOsReferenceIndex();
+
+    if (RefIndex != NULL) {
+        Rva = (ULONG)((ULONG_PTR)PtrCode - MappedImageBase);
+
+        RefEntry = refIndexFindFirst(RefIndex,
+            Rva,
+            Rva + NumberOfBytes,
+            RefClassAny,
+            ReqInstructionLength,
+            ScanPattern,
+            ScanPatternSize);
+
+        if (RefEntry == NULL)
+            return 0;
+
+        return ImageBase + RefEntry->TargetRva;
+    }
 
     do {
-        hde64_disasm((void*)(ptrCode + Index), &hs);
-        if (hs.flags & F_ERROR)
+        Length = hde64_length((void*)(ptrCode + Index), (uint32_t*)&Flags);
+        if (Flags & F_ERROR)
             break;
 
-        if (hs.len == ReqInstructionLength) {
+        if (Length == ReqInstructionLength) {
 
             if (ScanPatternSize == RtlCompareMemory(&ptrCode[Index],
                 ScanPattern,
@@ -457,19 +487,59 @@ ULONG_PTR ObFindAddress(
             }
 
         }
-        Index += hs.len;
+        Index += Length;
 
     } while (Index < NumberOfBytes);
 
     if (Rel == 0)
         return 0;
 
-    Address = (ULONG_PTR)ptrCode + Index + hs.len + Rel;
+    Address = (ULONG_PTR)ptrCode + Index + Length + Rel;
     Address = ImageBase + Address - MappedImageBase;
 
     return Address;
 }
 
+/*
+* kdQueryNtOsReferenceIndex
+*
+* Purpose:
+*
+* Return ntoskrnl code reference index, create it on first call.
+*
+*/
+PREFINDEX kdQueryNtOsReferenceIndex(
+    VOID
+)
+{
+    PREFINDEX Index, Previous;
+
+    Index = g_kdctx.NtOsRefIndex;
+    if (Index)
+        return Index;
+
+    if (g_kdctx.NtOsImageMap == NULL)
+        return NULL;
+
+    Index = refIndexCreate(g_kdctx.NtOsImageMap);
+    if (Index == NULL)
+        return NULL;
+
+    //
+    // Another thread could build index at the same time, keep first one.
+    //
+    Previous = (PREFINDEX)InterlockedCompareExchangePointer((PVOID*)&g_kdctx.NtOsRefIndex,
+        Index,
+        NULL);
+
+    if (Previous) {
+        refIndexDestroy(Index);
+        return Previous;
+    }
+
+    return Index;
+}
+
 /*
 * ObpInitInfoBlockOffsets
 *
@@ -680,6 +750,105 @@ BOOL ObHeaderToNameInfoAddress(
     return TRUE;
 }
 
+/*
+* ObReadObjectHeaderBlock
+*
+* Purpose:
+*
+* Read OBJECT_HEADER with all optional headers in front of it.
+*
+* Read stays within page of the object header, bytes from previous page
+* are read with second request only if InfoMask says optional headers are there.
+*
+*/
+BOOL ObReadObjectHeaderBlock(
+    _In_ ULONG_PTR HeaderAddress,
+    _Out_ POBJECT_HEADER_BLOCK HeaderBlock
+)
+{
+    ULONG     InfoSpan;
+    ULONG_PTR BlockAddress, InfoAddress;
+
+    HeaderBlock->HeaderAddress = 0;
+    HeaderBlock->BlockAddress = 0;
+
+    if (HeaderAddress < g_kdctx.SystemRangeStart + OBJECT_HEADER_INFO_MAX_SPAN)
+        return FALSE;
+
+    BlockAddress = HeaderAddress - OBJECT_HEADER_INFO_MAX_SPAN;
+    if (BlockAddress < ALIGN_DOWN_BY(HeaderAddress, PAGE_SIZE))
+        BlockAddress = ALIGN_DOWN_BY(HeaderAddress, PAGE_SIZE);
+
+    if (!kdReadSystemMemoryEx(BlockAddress,
+        &HeaderBlock->Data[OBJECT_HEADER_INFO_MAX_SPAN - (HeaderAddress - BlockAddress)],
+        (ULONG)(HeaderAddress - BlockAddress) + sizeof(OBJECT_HEADER),
+        NULL))
+    {
+        return FALSE;
+    }
+
+    //
+    // Optional headers cross page boundary, read the rest.
+    //
+    InfoSpan = ObpInfoMaskToOffset[OBJECT_HEADER_BLOCK_TO_HEADER(HeaderBlock)->InfoMask];
+    InfoAddress = HeaderAddress - InfoSpan;
+
+    if (InfoAddress < BlockAddress) {
+
+        if (kdReadSystemMemoryEx(InfoAddress,
+            &HeaderBlock->Data[OBJECT_HEADER_INFO_MAX_SPAN - InfoSpan],
+            (ULONG)(BlockAddress - InfoAddress),
+            NULL))
+        {
+            BlockAddress = InfoAddress;
+        }
+    }
+
+    HeaderBlock->HeaderAddress = HeaderAddress;
+    HeaderBlock->BlockAddress = BlockAddress;
+    return TRUE;
+}
+
+/*
+* ObGetObjectHeaderInfo
+*
+* Purpose:
+*
+* Return pointer to the optional header inside dumped header block, NULL if object has no such header.
+*
+*/
+PVOID ObGetObjectHeaderInfo(
+    _In_ POBJECT_HEADER_BLOCK HeaderBlock,
+    _In_ OBJ_HEADER_INFO_FLAG InfoFlag,
+    _Out_opt_ PULONG_PTR InfoAddress
+)
+{
+    BYTE InfoMask, HeaderOffset;
+
+    if (InfoAddress)
+        *InfoAddress = 0;
+
+    InfoMask = OBJECT_HEADER_BLOCK_TO_HEADER(HeaderBlock)->InfoMask;
+    if ((InfoMask & InfoFlag) == 0)
+        return NULL;
+
+    if (InfoFlag <= HeaderProcessInfoFlag)
+        HeaderOffset = ObGetObjectHeaderOffset(InfoMask, InfoFlag);
+    else
+        HeaderOffset = ObGetObjectHeaderOffsetEx(InfoMask, (BYTE)InfoFlag);
+
+    if ((HeaderOffset == 0) ||
+        (HeaderBlock->HeaderAddress - HeaderOffset < HeaderBlock->BlockAddress))
+    {
+        return NULL;
+    }
+
+    if (InfoAddress)
+        *InfoAddress = HeaderBlock->HeaderAddress - HeaderOffset;
+
+    return &HeaderBlock->Data[OBJECT_HEADER_INFO_MAX_SPAN - HeaderOffset];
+}
+
 /*
 * ObCopyBoundaryDescriptor
 *
@@ -1251,20 +1420,25 @@ BOOLEAN ObpFindHeaderCookie(
 
         do {
 
-            ptrCode = (PBYTE)GetProcAddress(hNtOs, "ObGetObjectType");
-            if (ptrCode == NULL)
-                break;
+            if (!kdCacheLookupNtOsAddress(KdCacheObHeaderCookie, &Address)) {
+
+                ptrCode = (PBYTE)GetProcAddress(hNtOs, "ObGetObjectType");
+                if (ptrCode == NULL)
+                    break;
 
-            Address = ObFindAddress(NtOsBase,
-                (ULONG_PTR)hNtOs,
-                IL_ObHeaderCookie,
-                ptrCode,
-                DA_ScanBytesObHeaderCookie,
-                ObHeaderCookiePattern,
-                sizeof(ObHeaderCookiePattern));
+                Address = ObFindAddress(NtOsBase,
+                    (ULONG_PTR)hNtOs,
+                    IL_ObHeaderCookie,
+                    ptrCode,
+                    DA_ScanBytesObHeaderCookie,
+                    ObHeaderCookiePattern,
+                    sizeof(ObHeaderCookiePattern));
 
-            if (!kdAddressInNtOsImage((PVOID)Address))
-                break;
+                if (!kdAddressInNtOsImage((PVOID)Address))
+                    break;
+
+                kdCacheStoreNtOsAddress(KdCacheObHeaderCookie, Address);
+            }
 
             if (!kdReadSystemMemoryEx(
                 Address,
@@ -1392,11 +1566,15 @@ PVOID ObFindPrivateNamespaceLookupTable2(
                 sizeof(PspHostSiloGlobals),
                 NULL))
             {
+                //
+                // Cache PspHostSiloGlobals itself, code references it, not the table field.
+                //
+                kdCacheStoreNtOsAddress(KdCachePrivateNamespaceLookupTable, Address);
+
                 //
                 // Return adjusted address of PrivateNamespaceLookupTable.
                 //
                 Address += FIELD_OFFSET(OBP_SILODRIVERSTATE, PrivateNamespaceLookupTable);
-
             }
         }
 
@@ -1428,6 +1606,15 @@ PVOID ObFindPrivateNamespaceLookupTable(
 
     HMODULE hNtOs = (HMODULE)Context->NtOsImageMap;
 
+    //
+    // RS1+ cache holds PspHostSiloGlobals, see ObFindPrivateNamespaceLookupTable2.
+    //
+    if (kdCacheLookupNtOsAddress(KdCachePrivateNamespaceLookupTable, &Address)) {
+        if (g_NtBuildNumber > NT_WIN10_THRESHOLD2)
+            Address += FIELD_OFFSET(OBP_SILODRIVERSTATE, PrivateNamespaceLookupTable);
+        return (PVOID)Address;
+    }
+
     if (g_NtBuildNumber > NT_WIN10_THRESHOLD2)
         return ObFindPrivateNamespaceLookupTable2(Context);
 
@@ -1478,6 +1665,8 @@ PVOID ObFindPrivateNamespaceLookupTable(
             break;
         }
 
+        kdCacheStoreNtOsAddress(KdCachePrivateNamespaceLookupTable, Address);
+
     } while (FALSE);
 
     return (PVOID)Address;
@@ -1511,6 +1700,59 @@ PVOID ObGetCallbackBlockRoutine(
     }
 }
 
+/*
+* ObGetCallbackBlockRoutines
+*
+* Purpose:
+*
+* Batched variant of ObGetCallbackBlockRoutine for EX_CALLBACK arrays.
+* Routine is NULL for empty or unreadable array entries.
+*
+*/
+VOID ObGetCallbackBlockRoutines(
+    _In_reads_(Count) PEX_FAST_REF Callbacks,
+    _In_ ULONG Count,
+    _Out_writes_(Count) PVOID* Routines
+)
+{
+    ULONG i;
+    PKDREAD_REQUEST Requests;
+    PEX_CALLBACK_ROUTINE_BLOCK Blocks;
+
+    for (i = 0; i < Count; i++)
+        Routines[i] = NULL;
+
+    Requests = (PKDREAD_REQUEST)supHeapAlloc(Count *
+        (sizeof(KDREAD_REQUEST) + sizeof(EX_CALLBACK_ROUTINE_BLOCK)));
+
+    if (Requests == NULL) {
+
+        for (i = 0; i < Count; i++) {
+            if (Callbacks[i].Value)
+                Routines[i] = ObGetCallbackBlockRoutine(ObGetObjectFastReference(Callbacks[i]));
+        }
+        return;
+    }
+
+    Blocks = (PEX_CALLBACK_ROUTINE_BLOCK)&Requests[Count];
+
+    for (i = 0; i < Count; i++) {
+        if (Callbacks[i].Value)
+            Requests[i].Address = (ULONG_PTR)ObGetObjectFastReference(Callbacks[i]);
+        Requests[i].Buffer = &Blocks[i];
+        Requests[i].Size = sizeof(EX_CALLBACK_ROUTINE_BLOCK);
+    }
+
+    kdReadSystemMemoryBatch(Requests, Count);
+
+    for (i = 0; i < Count; i++) {
+        if (Requests[i].Result)
+            Routines[i] = Blocks[i].Function;
+    }
+
+    supHeapFree(Requests);
+}
+
 /*
 * kdFindServiceTable
 *
@@ -1547,6 +1789,12 @@ BOOL kdFindKiServiceTable(
             //
             // If KeServiceDescriptorTableShadow is not extracted then extract it.
             //
+            if (g_kdctx.KeServiceDescriptorTableShadowPtr == 0 &&
+                kdCacheLookupNtOsAddress(KdCacheKeServiceDescriptorTableShadow, &Address))
+            {
+                g_kdctx.KeServiceDescriptorTableShadowPtr = Address;
+            }
+
             if (g_kdctx.KeServiceDescriptorTableShadowPtr == 0) {
 
                 //
@@ -1591,6 +1839,8 @@ BOOL kdFindKiServiceTable(
                 if (!kdAddressInNtOsImage((PVOID)Address))
                     break;
 
+                kdCacheStoreNtOsAddress(KdCacheKeServiceDescriptorTableShadow, Address);
+
                 g_kdctx.KeServiceDescriptorTableShadowPtr = Address;
 
             }
@@ -1666,6 +1916,59 @@ BOOL ObGetDirectoryObjectAddress(
     return bFound;
 }
 
+/*
+* ObpCaptureNameString
+*
+* Purpose:
+*
+* Copy object name buffer from kernel memory.
+*
+*/
+LPWSTR ObpCaptureNameString(
+    _In_ PUNICODE_STRING Name,
+    _Out_opt_ PSIZE_T ReturnLength,
+    _In_ HANDLE HeapHandle
+)
+{
+    SIZE_T allocLength;
+    LPWSTR objectName = NULL;
+
+    if (ReturnLength)
+        *ReturnLength = 0;
+
+    if (Name->Length == 0)
+        return NULL;
+
+    allocLength = Name->Length + sizeof(UNICODE_NULL);
+
+    objectName = (LPWSTR)RtlAllocateHeap(HeapHandle,
+        HEAP_ZERO_MEMORY,
+        allocLength);
+
+    if (objectName != NULL) {
+
+        if (kdReadSystemMemoryEx((ULONG_PTR)Name->Buffer,
+            objectName,
+            Name->Length,
+            NULL))
+        {
+            if (ReturnLength)
+                *ReturnLength = allocLength;
+        }
+        else {
+
+            RtlFreeHeap(HeapHandle,
+                0,
+                objectName);
+
+            objectName = NULL;
+        }
+
+    }
+
+    return objectName;
+}
+
 /*
 * ObQueryNameString
 *
@@ -1682,9 +1985,6 @@ LPWSTR ObQueryNameString(
     _In_ HANDLE HeapHandle
 )
 {
-    SIZE_T allocLength;
-    LPWSTR objectName = NULL;
-
     OBJECT_HEADER_NAME_INFO nameInfo;
 
     if (ReturnLength)
@@ -1692,45 +1992,46 @@ LPWSTR ObQueryNameString(
 
     RtlSecureZeroMemory(&nameInfo, sizeof(OBJECT_HEADER_NAME_INFO));
 
-    if (kdReadSystemMemoryEx(NameInfoAddress,
+    if (!kdReadSystemMemoryEx(NameInfoAddress,
         &nameInfo,
         sizeof(OBJECT_HEADER_NAME_INFO),
         NULL))
     {
-        if (nameInfo.Name.Length) {
-
-            allocLength = nameInfo.Name.Length + sizeof(UNICODE_NULL);
-
-            objectName = (LPWSTR)RtlAllocateHeap(HeapHandle,
-                HEAP_ZERO_MEMORY,
-                allocLength);
-
-            if (objectName != NULL) {
+        return NULL;
+    }
 
-                NameInfoAddress = (ULONG_PTR)nameInfo.Name.Buffer;
+    return ObpCaptureNameString(&nameInfo.Name, ReturnLength, HeapHandle);
+}
 
-                if (kdReadSystemMemoryEx(NameInfoAddress,
-                    objectName,
-                    nameInfo.Name.Length,
-                    NULL))
-                {
-                    if (ReturnLength)
-                        *ReturnLength = allocLength;
-                }
-                else {
+/*
+* ObQueryNameStringFromBlock
+*
+* Purpose:
+*
+* Reads object name using name info from dumped header block.
+*
+* If HeapHandle is g_WinObj use supHeapFree to release allocated memory.
+*
+*/
+LPWSTR ObQueryNameStringFromBlock(
+    _In_ POBJECT_HEADER_BLOCK HeaderBlock,
+    _Out_opt_ PSIZE_T ReturnLength,
+    _In_ HANDLE HeapHandle
+)
+{
+    POBJECT_HEADER_NAME_INFO nameInfo;
 
-                    RtlFreeHeap(HeapHandle,
-                        0,
-                        objectName);
+    if (ReturnLength)
+        *ReturnLength = 0;
 
-                    objectName = NULL;
-                }
+    nameInfo = (POBJECT_HEADER_NAME_INFO)ObGetObjectHeaderInfo(HeaderBlock,
+        HeaderNameInfoFlag,
+        NULL);
 
-            }
-        }
-    }
+    if (nameInfo == NULL)
+        return NULL;
 
-    return objectName;
+    return ObpCaptureNameString(&nameInfo->Name, ReturnLength, HeapHandle);
 }
 
 /*
@@ -1746,7 +2047,7 @@ LPWSTR ObQueryNameString(
 *   ObjectAddress - kernel address of object specified type (e.g. DRIVER_OBJECT).
 *   ObjectHeaderAddress - OBJECT_HEADER structure kernel address.
 *   ObjectHeaderAddressValid - if set then ObjectHeaderAddress in already converted form.
-*   DumpedObjectHeader - pointer to OBJECT_HEADER structure previously dumped.
+*   DumpedHeaderBlock - pointer to OBJECT_HEADER_BLOCK previously dumped.
 *
 * Return Value:
 *
@@ -1757,12 +2058,14 @@ POBJINFO ObpCopyObjectBasicInfo(
     _In_ ULONG_PTR ObjectAddress,
     _In_ ULONG_PTR ObjectHeaderAddress,
     _In_ BOOL ObjectHeaderAddressValid,
-    _In_opt_ POBJECT_HEADER DumpedObjectHeader
+    _In_opt_ POBJECT_HEADER_BLOCK DumpedHeaderBlock
 )
 {
-    ULONG_PTR       HeaderAddress = 0, InfoHeaderAddress = 0;
-    POBJINFO        lpData = NULL;
-    OBJECT_HEADER   ObjectHeader, * pObjectHeader;
+    ULONG_PTR           HeaderAddress = 0;
+    POBJINFO            lpData = NULL;
+    POBJECT_HEADER_BLOCK pHeaderBlock;
+    PVOID               QuotaInfo;
+    OBJECT_HEADER_BLOCK HeaderBlock;
 
     //
     // Convert object address to object header address.
@@ -1777,8 +2080,8 @@ POBJINFO ObpCopyObjectBasicInfo(
     //
     // ObjectHeader already dumped, copy it.
     //
-    if (DumpedObjectHeader) {
-        pObjectHeader = DumpedObjectHeader;
+    if (DumpedHeaderBlock) {
+        pHeaderBlock = DumpedHeaderBlock;
     }
     else {
         //
@@ -1788,20 +2091,14 @@ POBJINFO ObpCopyObjectBasicInfo(
             return NULL;
 
         //
-        // Read OBJECT_HEADER.
+        // Read OBJECT_HEADER with optional headers.
         //
-        RtlSecureZeroMemory(&ObjectHeader, sizeof(OBJECT_HEADER));
-
-        if (!kdReadSystemMemoryEx(HeaderAddress,
-            &ObjectHeader,
-            sizeof(OBJECT_HEADER),
-            NULL))
-        {
-            kdDebugPrint("%s kdReadSystemMemoryEx(ObjectHeaderAddress) failed\r\n", __FUNCTION__);
+        if (!ObReadObjectHeaderBlock(HeaderAddress, &HeaderBlock)) {
+            kdDebugPrint("%s ObReadObjectHeaderBlock(ObjectHeaderAddress) failed\r\n", __FUNCTION__);
             return NULL;
         }
 
-        pObjectHeader = &ObjectHeader;
+        pHeaderBlock = &HeaderBlock;
     }
 
     //
@@ -1819,23 +2116,18 @@ POBJINFO ObpCopyObjectBasicInfo(
     //
     supCopyMemory(&lpData->ObjectHeader,
         sizeof(OBJECT_HEADER),
-        pObjectHeader,
+        OBJECT_HEADER_BLOCK_TO_HEADER(pHeaderBlock),
         sizeof(OBJECT_HEADER));
 
     //
-    // Query and copy quota info if exist.
+    // Copy quota info if exist.
     //
-    InfoHeaderAddress = 0;
-
-    if (ObHeaderToNameInfoAddress(pObjectHeader->InfoMask,
-        HeaderAddress,
-        &InfoHeaderAddress,
-        HeaderQuotaInfoFlag))
-    {
-        kdReadSystemMemoryEx(HeaderAddress,
-            &lpData->ObjectQuotaHeader,
+    QuotaInfo = ObGetObjectHeaderInfo(pHeaderBlock, HeaderQuotaInfoFlag, NULL);
+    if (QuotaInfo) {
+        supCopyMemory(&lpData->ObjectQuotaHeader,
             sizeof(OBJECT_HEADER_QUOTA_INFO),
-            NULL);
+            QuotaInfo,
+            sizeof(OBJECT_HEADER_QUOTA_INFO));
     }
 
     return lpData;
@@ -1864,9 +2156,9 @@ POBJINFO ObpWalkDirectory(
     UINT      BucketId;
     SIZE_T    retSize;
     LPWSTR    lpObjectName;
-    ULONG_PTR ObjectHeaderAddress, HeadItem, LookupItem, InfoHeaderAddress;
+    ULONG_PTR ObjectHeaderAddress, HeadItem, LookupItem;
 
-    OBJECT_HEADER          ObjectHeader;
+    OBJECT_HEADER_BLOCK    HeaderBlock;
     OBJECT_DIRECTORY       DirectoryObject;
     OBJECT_DIRECTORY_ENTRY DirectoryEntry;
 
@@ -1927,30 +2219,12 @@ POBJINFO ObpWalkDirectory(
                     }
 
                     //
-                    // Read object header, skip entry on fail.
+                    // Read object header with optional headers, skip entry on fail.
                     //
-                    RtlSecureZeroMemory(&ObjectHeader, sizeof(OBJECT_HEADER));
                     ObjectHeaderAddress = (ULONG_PTR)OBJECT_TO_OBJECT_HEADER(DirectoryEntry.Object);
 
-                    if (!kdReadSystemMemoryEx(ObjectHeaderAddress,
-                        &ObjectHeader,
-                        sizeof(OBJECT_HEADER),
-                        NULL))
-                    {
-                        kdDebugPrint("%s kdReadSystemMemoryEx(ObjectHeaderAddress(Entry.Object)) failed\r\n", __FUNCTION__);
-                        goto NextItem;
-                    }
-
-                    //
-                    // Check if object has name, skip entry on fail.
-                    //
-                    InfoHeaderAddress = 0;
-
-                    if (!ObHeaderToNameInfoAddress(ObjectHeader.InfoMask,
-                        ObjectHeaderAddress,
-                        &InfoHeaderAddress,
-                        HeaderNameInfoFlag))
-                    {
+                    if (!ObReadObjectHeaderBlock(ObjectHeaderAddress, &HeaderBlock)) {
+                        kdDebugPrint("%s ObReadObjectHeaderBlock(ObjectHeaderAddress(Entry.Object)) failed\r\n", __FUNCTION__);
                         goto NextItem;
                     }
 
@@ -1958,7 +2232,7 @@ POBJINFO ObpWalkDirectory(
                     // If object has name, query it.
                     //
                     retSize = 0;
-                    lpObjectName = ObQueryNameString(InfoHeaderAddress, &retSize, g_WinObj.Heap);
+                    lpObjectName = ObQueryNameStringFromBlock(&HeaderBlock, &retSize, g_WinObj.Heap);
                     if ((lpObjectName != NULL) && (retSize != 0)) {
 
                         //
@@ -1975,7 +2249,7 @@ POBJINFO ObpWalkDirectory(
                             return ObpCopyObjectBasicInfo((ULONG_PTR)DirectoryEntry.Object,
                                 ObjectHeaderAddress,
                                 TRUE,
-                                &ObjectHeader);
+                                &HeaderBlock);
 
                         }
                     }
@@ -2008,7 +2282,7 @@ POBJINFO ObQueryObjectByAddress(
 )
 {
     ULONG_PTR ObjectHeaderAddress;
-    OBJECT_HEADER ObjectHeader;
+    OBJECT_HEADER_BLOCK HeaderBlock;
 
     if (ObjectAddress < g_kdctx.SystemRangeStart)
         return NULL;
@@ -2017,24 +2291,19 @@ POBJINFO ObQueryObjectByAddress(
         return NULL;
 
     //
-    // Read object header, fail is critical.
+    // Read object header with optional headers, fail is critical.
     //
-    RtlSecureZeroMemory(&ObjectHeader, sizeof(OBJECT_HEADER));
     ObjectHeaderAddress = (ULONG_PTR)OBJECT_TO_OBJECT_HEADER(ObjectAddress);
 
-    if (!kdReadSystemMemoryEx(ObjectHeaderAddress,
-        &ObjectHeader,
-        sizeof(OBJECT_HEADER),
-        NULL))
-    {
-        kdDebugPrint("%s kdReadSystemMemoryEx(ObjectHeaderAddress(ObjectAddress)) failed\r\n", __FUNCTION__);
+    if (!ObReadObjectHeaderBlock(ObjectHeaderAddress, &HeaderBlock)) {
+        kdDebugPrint("%s ObReadObjectHeaderBlock(ObjectHeaderAddress(ObjectAddress)) failed\r\n", __FUNCTION__);
         return NULL;
     }
 
     return ObpCopyObjectBasicInfo(ObjectAddress,
         ObjectHeaderAddress,
         TRUE,
-        &ObjectHeader);
+        &HeaderBlock);
 }
 
 /*
@@ -2137,63 +2406,326 @@ BOOL ObDumpTypeInfo(
 }
 
 /*
-* ObpWalkDirectoryRecursive
+* ObpCollectionGrow
 *
 * Purpose:
 *
-* Recursively dump Object Manager directories.
-*
-* Note:
-*
-* OBJECT_DIRECTORY definition changed in Windows 10, however this doesn't require
-* this routine change as we rely here only on HashBuckets which is on same offset.
+* Double collection columns storage.
 *
 */
-VOID ObpWalkDirectoryRecursive(
-    _In_ BOOL fIsRoot,
-    _In_ PLIST_ENTRY ListHead,
-    _In_ HANDLE ListHeap,
-    _In_opt_ LPWSTR lpRootDirectory,
-    _In_ ULONG_PTR DirectoryAddress,
-    _In_ USHORT DirectoryTypeIndex
+BOOL ObpCollectionGrow(
+    _In_ POBJECT_COLLECTION Collection
 )
 {
-    UCHAR      ObjectTypeIndex;
-    UINT       BucketId;
-    SIZE_T     dirLen, fLen, rdirLen, retSize;
-    ULONG_PTR  ObjectHeaderAddress, HeadItem, LookupItem, InfoHeaderAddress;
-    POBJREF    ObjectEntry;
-    LPWSTR     lpObjectName, lpDirectoryName;
+    ULONG Capacity;
+    SIZE_T EntrySize;
+    PBYTE Buffer;
 
-    OBJECT_HEADER           ObjectHeader;
-    OBJECT_DIRECTORY        DirectoryObject;
-    OBJECT_DIRECTORY_ENTRY  DirectoryEntry;
+    PULONG_PTR ObjectAddress, HeaderAddress;
+    PULONG ParentIndex, NameOffset;
+    PUSHORT NameLength;
+    PUCHAR TypeIndex;
+    POBJREFPNS PrivateNamespace = NULL;
 
-    RtlZeroMemory(&DirectoryObject, sizeof(OBJECT_DIRECTORY));
+    Capacity = (Collection->Capacity) ? Collection->Capacity * 2 : OBCOLLECTION_INITIAL_CAPACITY;
 
-    if (!kdReadSystemMemoryEx(DirectoryAddress,
-        &DirectoryObject,
-        sizeof(OBJECT_DIRECTORY),
-        NULL))
-    {
-        kdDebugPrint("%s kdReadSystemMemoryEx(DirectoryAddress) failed\r\n", __FUNCTION__);
-        return;
-    }
+    EntrySize = (2 * sizeof(ULONG_PTR)) + (2 * sizeof(ULONG)) + sizeof(USHORT) + sizeof(UCHAR);
+    if (Collection->Namespace)
+        EntrySize += sizeof(OBJREFPNS);
+
+    //
+    // All columns share single allocation, widest first to keep them aligned.
+    //
+    Buffer = (PBYTE)arenaAllocNoZero(Collection->Arena, (SIZE_T)Capacity * EntrySize);
+    if (Buffer == NULL)
+        return FALSE;
 
-    if (lpRootDirectory != NULL) {
-        rdirLen = (1 + _strlen(lpRootDirectory)) * sizeof(WCHAR);
+    ObjectAddress = (PULONG_PTR)Buffer;
+    HeaderAddress = &ObjectAddress[Capacity];
+    if (Collection->Namespace) {
+        PrivateNamespace = (POBJREFPNS)&HeaderAddress[Capacity];
+        ParentIndex = (PULONG)&PrivateNamespace[Capacity];
     }
     else {
-        rdirLen = 0;
+        ParentIndex = (PULONG)&HeaderAddress[Capacity];
+    }
+    NameOffset = &ParentIndex[Capacity];
+    NameLength = (PUSHORT)&NameOffset[Capacity];
+    TypeIndex = (PUCHAR)&NameLength[Capacity];
+
+    if (Collection->Count) {
+        RtlCopyMemory(ObjectAddress, Collection->ObjectAddress, Collection->Count * sizeof(ULONG_PTR));
+        RtlCopyMemory(HeaderAddress, Collection->HeaderAddress, Collection->Count * sizeof(ULONG_PTR));
+        RtlCopyMemory(ParentIndex, Collection->ParentIndex, Collection->Count * sizeof(ULONG));
+        RtlCopyMemory(NameOffset, Collection->NameOffset, Collection->Count * sizeof(ULONG));
+        RtlCopyMemory(NameLength, Collection->NameLength, Collection->Count * sizeof(USHORT));
+        RtlCopyMemory(TypeIndex, Collection->TypeIndex, Collection->Count * sizeof(UCHAR));
+        if (PrivateNamespace)
+            RtlCopyMemory(PrivateNamespace, Collection->PrivateNamespace, Collection->Count * sizeof(OBJREFPNS));
     }
 
-    lpObjectName = NULL;
-    retSize = 0;
-    ObjectTypeIndex = 0;
+    //
+    // Previous columns stay in arena until collection is released.
+    //
+    Collection->ObjectAddress = ObjectAddress;
+    Collection->HeaderAddress = HeaderAddress;
+    Collection->ParentIndex = ParentIndex;
+    Collection->NameOffset = NameOffset;
+    Collection->NameLength = NameLength;
+    Collection->TypeIndex = TypeIndex;
+    Collection->PrivateNamespace = PrivateNamespace;
+    Collection->Capacity = Capacity;
 
-    for (BucketId = 0; BucketId < NUMBER_HASH_BUCKETS; BucketId++) {
+    return TRUE;
+}
 
-        HeadItem = (ULONG_PTR)DirectoryObject.HashBuckets[BucketId];
+/*
+* ObpCollectionAddName
+*
+* Purpose:
+*
+* Append leaf name to the collection string pool, return offset of the name.
+*
+*/
+BOOL ObpCollectionAddName(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ LPCWSTR Name,
+    _In_ ULONG Length,
+    _Out_ PULONG Offset
+)
+{
+    ULONG Capacity;
+    PWCHAR NamePool;
+
+    *Offset = 0;
+
+    if (Collection->NamePoolLength + Length > Collection->NamePoolCapacity) {
+
+        Capacity = (Collection->NamePoolCapacity) ?
+            Collection->NamePoolCapacity * 2 : OBCOLLECTION_INITIAL_POOL_LENGTH;
+
+        while (Capacity < Collection->NamePoolLength + Length)
+            Capacity *= 2;
+
+        NamePool = (PWCHAR)arenaAllocNoZero(Collection->Arena, (SIZE_T)Capacity * sizeof(WCHAR));
+        if (NamePool == NULL)
+            return FALSE;
+
+        if (Collection->NamePool)
+            RtlCopyMemory(NamePool, Collection->NamePool, Collection->NamePoolLength * sizeof(WCHAR));
+
+        Collection->NamePool = NamePool;
+        Collection->NamePoolCapacity = Capacity;
+    }
+
+    RtlCopyMemory(&Collection->NamePool[Collection->NamePoolLength], Name, Length * sizeof(WCHAR));
+    *Offset = Collection->NamePoolLength;
+    Collection->NamePoolLength += Length;
+
+    return TRUE;
+}
+
+/*
+* ObpCollectionAdd
+*
+* Purpose:
+*
+* Append object to the collection, return index of the new entry or OBCOLLECTION_NO_PARENT on failure.
+*
+*/
+ULONG ObpCollectionAdd(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ ULONG_PTR ObjectAddress,
+    _In_ ULONG_PTR HeaderAddress,
+    _In_ UCHAR TypeIndex,
+    _In_ ULONG ParentIndex,
+    _In_opt_ LPCWSTR Name,
+    _In_opt_ POBJREFPNS PrivateNamespace
+)
+{
+    ULONG Index, NameOffset = 0;
+    SIZE_T NameLength = 0;
+
+    if (Collection->Count == OBCOLLECTION_NO_PARENT - 1)
+        return OBCOLLECTION_NO_PARENT;
+
+    if (Collection->Count == Collection->Capacity) {
+        if (!ObpCollectionGrow(Collection))
+            return OBCOLLECTION_NO_PARENT;
+    }
+
+    if (Name) {
+        NameLength = _strlen(Name);
+        if (NameLength > MAXUSHORT)
+            NameLength = MAXUSHORT;
+
+        if (NameLength) {
+            if (!ObpCollectionAddName(Collection, Name, (ULONG)NameLength, &NameOffset))
+                return OBCOLLECTION_NO_PARENT;
+        }
+    }
+
+    Index = Collection->Count;
+
+    Collection->ObjectAddress[Index] = ObjectAddress;
+    Collection->HeaderAddress[Index] = HeaderAddress;
+    Collection->TypeIndex[Index] = TypeIndex;
+    Collection->ParentIndex[Index] = ParentIndex;
+    Collection->NameOffset[Index] = NameOffset;
+    Collection->NameLength[Index] = (USHORT)NameLength;
+
+    if (Collection->PrivateNamespace) {
+        if (PrivateNamespace)
+            Collection->PrivateNamespace[Index] = *PrivateNamespace;
+        else
+            RtlSecureZeroMemory(&Collection->PrivateNamespace[Index], sizeof(OBJREFPNS));
+    }
+
+    Collection->Count += 1;
+
+    return Index;
+}
+
+/*
+* ObpCollectionQueryPath
+*
+* Purpose:
+*
+* Rebuild full object path from parent chain and leaf names.
+*
+* Return value is the required buffer length in WCHARs including terminating null,
+* buffer is filled only if it is big enough.
+*
+* Private namespace objects have no parent and their path is the object name.
+*
+*/
+ULONG ObpCollectionQueryPath(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ ULONG Index,
+    _Out_writes_opt_(BufferLength) PWCHAR Buffer,
+    _In_ ULONG BufferLength
+)
+{
+    ULONG i, Length = 0, NameLength;
+
+    //
+    // Parent is always added before its children, so chain ends.
+    //
+    i = Index;
+    do {
+        Length += Collection->NameLength[i];
+        if (Collection->Namespace == FALSE)
+            Length += 1;
+
+        i = Collection->ParentIndex[i];
+
+    } while (i != OBCOLLECTION_NO_PARENT);
+
+    Length += 1;
+
+    if ((Buffer == NULL) || (BufferLength < Length))
+        return Length;
+
+    Buffer[Length - 1] = UNICODE_NULL;
+
+    i = Index;
+    Length -= 1;
+    do {
+        NameLength = Collection->NameLength[i];
+        Length -= NameLength;
+
+        RtlCopyMemory(&Buffer[Length],
+            &Collection->NamePool[Collection->NameOffset[i]],
+            NameLength * sizeof(WCHAR));
+
+        if (Collection->Namespace == FALSE) {
+            Length -= 1;
+            Buffer[Length] = L'\\';
+        }
+
+        i = Collection->ParentIndex[i];
+
+    } while (i != OBCOLLECTION_NO_PARENT);
+
+    return 0;
+}
+
+/*
+* ObpCollectionGetEntry
+*
+* Purpose:
+*
+* Fill entry view of the collection element, ObjectName is not set.
+*
+*/
+VOID ObpCollectionGetEntry(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ ULONG Index,
+    _Out_ POBJREF Entry
+)
+{
+    RtlSecureZeroMemory(Entry, sizeof(OBJREF));
+
+    Entry->Index = Index;
+    Entry->ObjectAddress = Collection->ObjectAddress[Index];
+    Entry->HeaderAddress = Collection->HeaderAddress[Index];
+    Entry->TypeIndex = Collection->TypeIndex[Index];
+
+    if (Collection->PrivateNamespace)
+        Entry->PrivateNamespace = Collection->PrivateNamespace[Index];
+}
+
+/*
+* ObpWalkDirectoryRecursive
+*
+* Purpose:
+*
+* Recursively dump Object Manager directories.
+*
+* Objects are stored with leaf names only, ParentIndex is the collection index
+* of the directory being walked (OBCOLLECTION_NO_PARENT for root).
+*
+* Note:
+*
+* OBJECT_DIRECTORY definition changed in Windows 10, however this doesn't require
+* this routine change as we rely here only on HashBuckets which is on same offset.
+*
+*/
+VOID ObpWalkDirectoryRecursive(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ ULONG ParentIndex,
+    _In_ ULONG_PTR DirectoryAddress,
+    _In_ USHORT DirectoryTypeIndex
+)
+{
+    UCHAR      ObjectTypeIndex;
+    UINT       BucketId;
+    ULONG      ObjectIndex;
+    ULONG_PTR  ObjectHeaderAddress, HeadItem, LookupItem;
+    LPWSTR     lpObjectName;
+    POBJECT_HEADER          ObjectHeader;
+
+    OBJECT_HEADER_BLOCK     HeaderBlock;
+    OBJECT_DIRECTORY        DirectoryObject;
+    OBJECT_DIRECTORY_ENTRY  DirectoryEntry;
+
+    RtlZeroMemory(&DirectoryObject, sizeof(OBJECT_DIRECTORY));
+
+    if (!kdReadSystemMemoryEx(DirectoryAddress,
+        &DirectoryObject,
+        sizeof(OBJECT_DIRECTORY),
+        NULL))
+    {
+        kdDebugPrint("%s kdReadSystemMemoryEx(DirectoryAddress) failed\r\n", __FUNCTION__);
+        return;
+    }
+
+    lpObjectName = NULL;
+    ObjectTypeIndex = 0;
+
+    for (BucketId = 0; BucketId < NUMBER_HASH_BUCKETS; BucketId++) {
+
+        HeadItem = (ULONG_PTR)DirectoryObject.HashBuckets[BucketId];
         if (HeadItem != 0) {
 
             LookupItem = HeadItem;
@@ -2213,122 +2745,51 @@ VOID ObpWalkDirectoryRecursive(
 
                     //
                     // Read object.
-                    // First read header from directory entry object.
+                    // First read header with optional headers from directory entry object.
                     //
-                    RtlZeroMemory(&ObjectHeader, sizeof(OBJECT_HEADER));
                     ObjectHeaderAddress = (ULONG_PTR)OBJECT_TO_OBJECT_HEADER(DirectoryEntry.Object);
 
-                    if (kdReadSystemMemoryEx(ObjectHeaderAddress,
-                        &ObjectHeader,
-                        sizeof(OBJECT_HEADER),
-                        NULL))
-                    {
+                    if (ObReadObjectHeaderBlock(ObjectHeaderAddress, &HeaderBlock)) {
+
+                        ObjectHeader = OBJECT_HEADER_BLOCK_TO_HEADER(&HeaderBlock);
 
                         //
-                        // Second read object data.
-                        // Query object name.
+                        // Second read object name, name info is already in header block.
                         //
-                        InfoHeaderAddress = 0;
-                        retSize = 0;
-                        if (ObHeaderToNameInfoAddress(ObjectHeader.InfoMask,
-                            ObjectHeaderAddress,
-                            &InfoHeaderAddress,
-                            HeaderNameInfoFlag))
-                        {
-                            lpObjectName = ObQueryNameString(InfoHeaderAddress,
-                                &retSize,
-                                g_WinObj.Heap);
-                        }
+                        lpObjectName = ObQueryNameStringFromBlock(&HeaderBlock,
+                            NULL,
+                            g_WinObj.Heap);
 
                         //
-                        // Allocate object entry.
+                        // Save object with leaf name.
                         //
-                        ObjectEntry = (POBJREF)RtlAllocateHeap(ListHeap,
-                            HEAP_ZERO_MEMORY,
-                            sizeof(OBJREF));
-
-                        if (ObjectEntry) {
-
-                            //
-                            // Save object address.
-                            //
-                            ObjectEntry->ObjectAddress = (ULONG_PTR)DirectoryEntry.Object;
-                            ObjectEntry->HeaderAddress = ObjectHeaderAddress;
-                            ObjectEntry->TypeIndex = ObjectHeader.TypeIndex;
+                        ObjectIndex = ObpCollectionAdd(Collection,
+                            (ULONG_PTR)DirectoryEntry.Object,
+                            ObjectHeaderAddress,
+                            ObjectHeader->TypeIndex,
+                            ParentIndex,
+                            lpObjectName,
+                            NULL);
 
-                            //
-                            // Copy dir + name.
-                            //
-                            if (lpObjectName) {
-
-                                fLen = (_strlen(lpObjectName) * sizeof(WCHAR)) +
-                                    (2 * sizeof(WCHAR)) +
-                                    rdirLen + sizeof(UNICODE_NULL);
-
-                                ObjectEntry->ObjectName = (LPWSTR)RtlAllocateHeap(ListHeap,
-                                    HEAP_ZERO_MEMORY,
-                                    fLen);
-
-                                if (ObjectEntry->ObjectName) {
-                                    _strcpy(ObjectEntry->ObjectName, lpRootDirectory);
-                                    if (fIsRoot == FALSE) {
-                                        _strcat(ObjectEntry->ObjectName, L"\\");
-                                    }
-                                    _strcat(ObjectEntry->ObjectName, lpObjectName);
-                                }
-                            }
-
-                            InsertHeadList(ListHead, &ObjectEntry->ListEntry);
+                        if (lpObjectName) {
+                            supHeapFree(lpObjectName);
+                            lpObjectName = NULL;
                         }
 
                         //
-                        // Check if current object is a directory.
+                        // Check if current object is a directory and walk it.
                         //
-                        ObjectTypeIndex = ObDecodeTypeIndex(DirectoryEntry.Object, ObjectHeader.TypeIndex);
-                        if (ObjectTypeIndex == DirectoryTypeIndex) {
-
-                            //
-                            // Build new directory string (old directory + \ + current).
-                            //
-                            fLen = 0;
-                            if (lpObjectName) {
-                                fLen = retSize;
-                            }
-
-                            dirLen = fLen + rdirLen + (2 * sizeof(WCHAR)) + sizeof(UNICODE_NULL);
-                            lpDirectoryName = (LPWSTR)supHeapAlloc(dirLen);
-                            if (lpDirectoryName) {
-                                _strcpy(lpDirectoryName, lpRootDirectory);
-                                if (fIsRoot == FALSE) {
-                                    _strcat(lpDirectoryName, L"\\");
-                                }
-                                if (lpObjectName) {
-                                    _strcat(lpDirectoryName, lpObjectName);
-                                }
-                            }
-
-                            //
-                            // Walk subdirectory.
-                            //
-                            ObpWalkDirectoryRecursive(FALSE,
-                                ListHead,
-                                ListHeap,
-                                lpDirectoryName,
+                        ObjectTypeIndex = ObDecodeTypeIndex(DirectoryEntry.Object, ObjectHeader->TypeIndex);
+                        if ((ObjectTypeIndex == DirectoryTypeIndex) &&
+                            (ObjectIndex != OBCOLLECTION_NO_PARENT))
+                        {
+                            ObpWalkDirectoryRecursive(Collection,
+                                ObjectIndex,
                                 (ULONG_PTR)DirectoryEntry.Object,
                                 DirectoryTypeIndex);
-
-                            if (lpDirectoryName) {
-                                supHeapFree(lpDirectoryName);
-                                lpDirectoryName = NULL;
-                            }
                         }
 
-                        if (lpObjectName) {
-                            supHeapFree(lpObjectName);
-                            lpObjectName = NULL;
-                        }
-
-                    } //if (kdReadSystemMemoryEx(OBJECT_HEADER)
+                    } //if (ObReadObjectHeaderBlock)
 
                     LookupItem = (ULONG_PTR)DirectoryEntry.ChainLink;
 
@@ -2342,6 +2803,144 @@ VOID ObpWalkDirectoryRecursive(
     }
 }
 
+typedef struct _OBP_NAMESPACE_WALK {
+    POBJECT_COLLECTION Collection;
+    ULONG ObjectsCount;
+    ULONG_PTR LookupEntryAddress;
+    POBJECT_NAMESPACE_ENTRY LookupEntry;
+} OBP_NAMESPACE_WALK, *POBP_NAMESPACE_WALK;
+
+/*
+* ObpNamespaceObjectWalkCallback
+*
+* Purpose:
+*
+* kdWalkList callback for private namespace directory chains.
+*
+* Record is OBJECT_DIRECTORY_ENTRY, TailData is object header block, if it could
+* not be batched (optional headers in unreadable page) block is read here.
+*
+*/
+BOOL CALLBACK ObpNamespaceObjectWalkCallback(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context
+)
+{
+    ULONG_PTR ObjectHeaderAddress;
+    LPWSTR ObjectName;
+    POBJECT_DIRECTORY_ENTRY Entry = (POBJECT_DIRECTORY_ENTRY)Record;
+    POBP_NAMESPACE_WALK Walk = (POBP_NAMESPACE_WALK)Context;
+    OBJREFPNS PrivateNamespace;
+    OBJECT_HEADER_BLOCK HeaderBlock;
+
+    UNREFERENCED_PARAMETER(RecordAddress);
+
+    if (Walk == NULL)
+        return TRUE;
+
+    ObjectHeaderAddress = (ULONG_PTR)OBJECT_TO_OBJECT_HEADER(Entry->Object);
+
+    if (TailData) {
+        RtlCopyMemory(HeaderBlock.Data, TailData, sizeof(HeaderBlock.Data));
+        HeaderBlock.HeaderAddress = ObjectHeaderAddress;
+        HeaderBlock.BlockAddress = ObjectHeaderAddress - OBJECT_HEADER_INFO_MAX_SPAN;
+    }
+    else {
+        if (!ObReadObjectHeaderBlock(ObjectHeaderAddress, &HeaderBlock))
+            return TRUE;
+    }
+
+    //
+    // Save object namespace/lookup entry address.
+    //
+    PrivateNamespace.NamespaceDirectoryAddress =
+        (ULONG_PTR)Walk->LookupEntry->NamespaceRootDirectory;
+
+    PrivateNamespace.NamespaceLookupEntry =
+        Walk->LookupEntryAddress;
+
+    PrivateNamespace.SizeOfBoundaryInformation =
+        Walk->LookupEntry->SizeOfBoundaryInformation;
+
+    //
+    // Query object name, name info is already in the block.
+    //
+    ObjectName = ObQueryNameStringFromBlock(&HeaderBlock, NULL, g_WinObj.Heap);
+
+    //
+    // Save object address, header and type index as is (decoded if needed later).
+    //
+    if (ObpCollectionAdd(Walk->Collection,
+        (ULONG_PTR)Entry->Object,
+        ObjectHeaderAddress,
+        OBJECT_HEADER_BLOCK_TO_HEADER(&HeaderBlock)->TypeIndex,
+        OBCOLLECTION_NO_PARENT,
+        ObjectName,
+        &PrivateNamespace) != OBCOLLECTION_NO_PARENT)
+    {
+        Walk->ObjectsCount += 1;
+    }
+
+    if (ObjectName)
+        supHeapFree(ObjectName);
+
+    return TRUE;
+}
+
+/*
+* ObpNamespaceEntryWalkCallback
+*
+* Purpose:
+*
+* kdWalkList callback for private namespace lookup table buckets.
+*
+* Record is OBJECT_NAMESPACE_ENTRY, TailData is namespace root directory.
+*
+*/
+BOOL CALLBACK ObpNamespaceEntryWalkCallback(
+    _In_ ULONG_PTR RecordAddress,
+    _In_ PVOID Record,
+    _In_opt_ PVOID TailData,
+    _In_opt_ PVOID Context
+)
+{
+    ULONG j;
+    POBJECT_DIRECTORY DirObject = (POBJECT_DIRECTORY)TailData;
+    POBP_NAMESPACE_WALK Walk = (POBP_NAMESPACE_WALK)Context;
+    KDWALK_PARAMS Params;
+
+    if (DirObject == NULL || Walk == NULL)
+        return FALSE;
+
+    Walk->LookupEntry = (POBJECT_NAMESPACE_ENTRY)Record;
+    Walk->LookupEntryAddress = RecordAddress + FIELD_OFFSET(OBJECT_NAMESPACE_ENTRY, ListEntry);
+
+    RtlSecureZeroMemory(&Params, sizeof(Params));
+    Params.LinkOffset = FIELD_OFFSET(OBJECT_DIRECTORY_ENTRY, ChainLink);
+    Params.RecordSize = sizeof(OBJECT_DIRECTORY_ENTRY);
+    Params.Flags = KDWALK_FLAG_NULL_TERMINATED | KDWALK_FLAG_HEAD_IS_RECORD;
+    //
+    // Tail is whole OBJECT_HEADER_BLOCK data, object header with optional headers.
+    //
+    Params.TailPointerOffset = FIELD_OFFSET(OBJECT_DIRECTORY_ENTRY, Object);
+    Params.TailPointerBias = -(LONG)(FIELD_OFFSET(OBJECT_HEADER, Body) + OBJECT_HEADER_INFO_MAX_SPAN);
+    Params.TailSize = RTL_FIELD_SIZE(OBJECT_HEADER_BLOCK, Data);
+    Params.Callback = ObpNamespaceObjectWalkCallback;
+    Params.Context = Walk;
+
+    for (j = 0; j < NUMBER_HASH_BUCKETS; j++) {
+
+        Params.ListHead = (ULONG_PTR)DirObject->HashBuckets[j];
+        if (Params.ListHead)
+            kdWalkList(&Params, NULL);
+
+    }
+
+    return TRUE;
+}
+
 /*
 * ObpWalkPrivateNamespaceTable
 *
@@ -2356,26 +2955,19 @@ VOID ObpWalkDirectoryRecursive(
 *
 */
 BOOL ObpWalkPrivateNamespaceTable(
-    _In_ PLIST_ENTRY ListHead,
-    _In_ HANDLE ListHeap,
+    _In_ POBJECT_COLLECTION Collection,
     _In_ ULONG_PTR TableAddress
 )
 {
-    ULONG         i, j = 0;
-    ULONG         objectsCount = 0;
-    ULONG_PTR     ObjectHeaderAddress, HeadItem, LookupItem, InfoHeaderAddress;
-    PLIST_ENTRY   Next, Head;
-    LIST_ENTRY    ListEntry;
-    POBJREF       ObjectEntry;
+    ULONG         i;
+    ULONG_PTR     Head;
 
-    OBJECT_HEADER                ObjectHeader;
-    OBJECT_DIRECTORY             DirObject;
-    OBJECT_DIRECTORY_ENTRY       Entry;
+    KDWALK_PARAMS                Params;
+    OBP_NAMESPACE_WALK           Walk;
     OBJECT_NAMESPACE_LOOKUPTABLE LookupTable;
-    OBJECT_NAMESPACE_ENTRY       LookupEntry;
 
     if (
-        (ListHead == NULL) ||
+        (Collection == NULL) ||
         (TableAddress == 0)
         )
     {
@@ -2395,207 +2987,187 @@ BOOL ObpWalkPrivateNamespaceTable(
         return FALSE;
     }
 
+    RtlSecureZeroMemory(&Walk, sizeof(Walk));
+    Walk.Collection = Collection;
+
+    RtlSecureZeroMemory(&Params, sizeof(Params));
+    Params.LinkOffset = FIELD_OFFSET(OBJECT_NAMESPACE_ENTRY, ListEntry);
+    Params.RecordSize = sizeof(OBJECT_NAMESPACE_ENTRY);
+    Params.TailPointerOffset = FIELD_OFFSET(OBJECT_NAMESPACE_ENTRY, NamespaceRootDirectory);
+    Params.TailSize = sizeof(OBJECT_DIRECTORY);
+    Params.Callback = ObpNamespaceEntryWalkCallback;
+    Params.Context = &Walk;
+
     for (i = 0; i < NUMBER_HASH_BUCKETS; i++) {
 
-        ListEntry = LookupTable.HashBuckets[i];
+        //
+        // Skip empty buckets, they are already known from table dump.
+        //
+        Head = TableAddress + (i * sizeof(LIST_ENTRY));
+        if ((ULONG_PTR)LookupTable.HashBuckets[i].Flink == Head)
+            continue;
+
+        Params.ListHead = Head;
+        kdWalkList(&Params, NULL);
+    }
 
-        Head = (PLIST_ENTRY)(TableAddress + (i * sizeof(LIST_ENTRY)));
-        Next = ListEntry.Flink;
+    return (Walk.ObjectsCount > 0);
+}
+
+/*
+* ObpCollectionRelease
+*
+* Purpose:
+*
+* Drop collection storage reference, arena is destroyed with the last one.
+*
+*/
+VOID ObpCollectionRelease(
+    _In_opt_ PARENA Arena,
+    _In_opt_ PLONG References
+)
+{
+    if (Arena == NULL)
+        return;
 
-        while (Next != Head) {
+    if ((References == NULL) || (InterlockedDecrement(References) == 0))
+        arenaDestroy(Arena);
+}
 
-            RtlSecureZeroMemory(&LookupEntry, sizeof(OBJECT_NAMESPACE_ENTRY));
+/*
+* ObpCollectionQueryRoot
+*
+* Purpose:
+*
+* Return root directory or private namespace table address, resolve them once.
+*
+* Addresses are resolved with no lock held, exclusive collection lock is taken
+* only to publish them, concurrent builds see either zero or final value.
+* Racing resolvers produce the same value.
+*
+*/
+BOOL ObpCollectionQueryRoot(
+    _In_ BOOL fNamespace,
+    _Out_ PULONG_PTR RootAddress,
+    _Out_ PUSHORT TypeIndex
+)
+{
+    ULONG_PTR Address = 0;
+    USHORT Index = 0;
 
-            if (!kdReadSystemMemoryEx((ULONG_PTR)Next,
-                &LookupEntry,
-                sizeof(OBJECT_NAMESPACE_ENTRY),
-                NULL))
-            {
-                break;
-            }
+    *RootAddress = 0;
+    *TypeIndex = 0;
 
-            ListEntry = LookupEntry.ListEntry;
+    //
+    // Fast path, already resolved.
+    //
+    AcquireSRWLockShared(&g_kdctx.ObCollectionLock);
+    if (fNamespace == FALSE) {
+        Address = g_kdctx.DirectoryRootAddress;
+        Index = g_kdctx.DirectoryTypeIndex;
+    }
+    else {
+        Address = (ULONG_PTR)g_kdctx.PrivateNamespaceLookupTable;
+    }
+    ReleaseSRWLockShared(&g_kdctx.ObCollectionLock);
 
-            RtlSecureZeroMemory(&DirObject, sizeof(OBJECT_DIRECTORY));
+    if (Address == 0 || (fNamespace == FALSE && Index == 0)) {
 
-            if (!kdReadSystemMemoryEx((ULONG_PTR)LookupEntry.NamespaceRootDirectory,
-                &DirObject,
-                sizeof(OBJECT_DIRECTORY),
-                NULL))
-            {
-                break;
-            }
+        //
+        // Resolve without lock, this reads kernel memory and may take a while.
+        //
+        __try {
 
-            for (j = 0; j < NUMBER_HASH_BUCKETS; j++) {
-
-                HeadItem = (ULONG_PTR)DirObject.HashBuckets[j];
-                if (HeadItem != 0) {
-
-                    LookupItem = HeadItem;
-
-                    do {
-
-                        RtlSecureZeroMemory(&Entry, sizeof(OBJECT_DIRECTORY_ENTRY));
-
-                        if (kdReadSystemMemoryEx(LookupItem,
-                            &Entry,
-                            sizeof(OBJECT_DIRECTORY_ENTRY),
-                            NULL)) {
-
-                            RtlSecureZeroMemory(&ObjectHeader, sizeof(OBJECT_HEADER));
-                            ObjectHeaderAddress = (ULONG_PTR)OBJECT_TO_OBJECT_HEADER(Entry.Object);
-
-                            if (kdReadSystemMemoryEx(ObjectHeaderAddress,
-                                &ObjectHeader,
-                                sizeof(OBJECT_HEADER),
-                                NULL))
-                            {
-                                //
-                                // Allocate object entry
-                                //
-                                ObjectEntry = (POBJREF)RtlAllocateHeap(ListHeap,
-                                    HEAP_ZERO_MEMORY,
-                                    sizeof(OBJREF));
-
-                                if (ObjectEntry) {
-
-                                    //
-                                    // Save object address, header and type index.
-                                    //
-                                    ObjectEntry->ObjectAddress = (ULONG_PTR)Entry.Object;
-                                    ObjectEntry->HeaderAddress = ObjectHeaderAddress;
-
-                                    //
-                                    // Save index as is (decoded if needed later).
-                                    //
-                                    ObjectEntry->TypeIndex = ObjectHeader.TypeIndex;
-
-                                    //
-                                    // Save object namespace/lookup entry address.
-                                    //
-                                    ObjectEntry->PrivateNamespace.NamespaceDirectoryAddress =
-                                        (ULONG_PTR)LookupEntry.NamespaceRootDirectory;
-
-                                    ObjectEntry->PrivateNamespace.NamespaceLookupEntry =
-                                        (ULONG_PTR)Next;
-
-                                    ObjectEntry->PrivateNamespace.SizeOfBoundaryInformation =
-                                        LookupEntry.SizeOfBoundaryInformation;
-
-                                    //
-                                    // Query object name.
-                                    //
-                                    InfoHeaderAddress = 0;
-
-                                    if (ObHeaderToNameInfoAddress(ObjectHeader.InfoMask,
-                                        ObjectHeaderAddress,
-                                        &InfoHeaderAddress,
-                                        HeaderNameInfoFlag))
-                                    {
-                                        //
-                                        // Copy object name if exist.
-                                        //
-                                        ObjectEntry->ObjectName = ObQueryNameString(InfoHeaderAddress,
-                                            NULL,
-                                            ListHeap);
-
-                                    }
-
-                                    objectsCount += 1;
-                                    InsertHeadList(ListHead, &ObjectEntry->ListEntry);
-
-                                } //if (ObjectEntry)
-                            }
-                            LookupItem = (ULONG_PTR)Entry.ChainLink;
-                        }
-                        else {
-                            LookupItem = 0;
-                        }
-                    } while (LookupItem != 0);
+            if (fNamespace == FALSE) {
+                if (!ObGetDirectoryObjectAddress(NULL, &Address, &Index)) {
+                    Address = 0;
+                    Index = 0;
                 }
             }
+            else {
+                Address = (ULONG_PTR)ObFindPrivateNamespaceLookupTable(&g_kdctx);
+            }
 
-            Next = ListEntry.Flink;
         }
+        __except (WOBJ_EXCEPTION_FILTER_LOG) {
+            Address = 0;
+            Index = 0;
+        }
+
+        if (Address == 0 || (fNamespace == FALSE && Index == 0))
+            return FALSE;
+
+        AcquireSRWLockExclusive(&g_kdctx.ObCollectionLock);
+        if (fNamespace == FALSE) {
+            g_kdctx.DirectoryRootAddress = Address;
+            g_kdctx.DirectoryTypeIndex = Index;
+        }
+        else {
+            g_kdctx.PrivateNamespaceLookupTable = (PVOID)Address;
+        }
+        ReleaseSRWLockExclusive(&g_kdctx.ObCollectionLock);
     }
-    return (objectsCount > 0);
+
+    *RootAddress = Address;
+    *TypeIndex = Index;
+
+    return TRUE;
 }
 
 /*
-* ObCollectionCreateInternal
+* ObpCollectionBuild
 *
 * Purpose:
 *
-* Create collection of object directory dumped info.
+* Build collection of object directory dumped info.
 *
-* Collection must be destroyed with ObCollectionDestroy after use.
+* Collection is private to the caller until published with ObpCollectionPublish.
 *
 * If specified will dump private namespace objects.
 *
 */
-BOOL ObCollectionCreateInternal(
-    _In_ POBJECT_COLLECTION Collection,
+BOOL ObpCollectionBuild(
+    _Out_ POBJECT_COLLECTION Collection,
     _In_ BOOL fNamespace
 )
 {
     BOOL bResult = FALSE;
+    ULONG_PTR RootAddress = 0;
+    USHORT TypeIndex = 0;
 
-    Collection->Heap = RtlCreateHeap(HEAP_GROWABLE, NULL, 0, 0, NULL, NULL);
+    RtlSecureZeroMemory(Collection, sizeof(OBJECT_COLLECTION));
+
+    Collection->Arena = arenaCreate(0);
+    if (Collection->Arena == NULL)
+        return FALSE;
 
-    if (Collection->Heap == NULL)
+    Collection->References = (PLONG)arenaAlloc(Collection->Arena, sizeof(LONG));
+    if (Collection->References == NULL)
         return FALSE;
 
-    RtlSetHeapInformation(Collection->Heap, HeapEnableTerminationOnCorruption, NULL, 0);
+    *Collection->References = 1;
+    Collection->Namespace = fNamespace;
 
     __try {
 
-        InitializeListHead(&Collection->ListHead);
+        if (!ObpCollectionQueryRoot(fNamespace, &RootAddress, &TypeIndex)) {
+            SetLastError(ERROR_INTERNAL_ERROR);
+            __leave;
+        }
 
         if (fNamespace == FALSE) {
-            if (
-                (g_kdctx.DirectoryRootAddress == 0) ||
-                (g_kdctx.DirectoryTypeIndex == 0)
-                )
-            {
-                if (!ObGetDirectoryObjectAddress(NULL,
-                    &g_kdctx.DirectoryRootAddress,
-                    &g_kdctx.DirectoryTypeIndex))
-                {
-                    SetLastError(ERROR_INTERNAL_ERROR);
-                    goto _FailWeLeave;
-                }
-            }
 
-            if (
-                (g_kdctx.DirectoryRootAddress != 0) &&
-                (g_kdctx.DirectoryTypeIndex != 0)
-                )
-            {
-                ObpWalkDirectoryRecursive(TRUE,
-                    &Collection->ListHead,
-                    Collection->Heap,
-                    KM_OBJECTS_ROOT_DIRECTORY,
-                    g_kdctx.DirectoryRootAddress,
-                    g_kdctx.DirectoryTypeIndex);
-
-                bResult = TRUE;
-            }
+            ObpWalkDirectoryRecursive(Collection,
+                OBCOLLECTION_NO_PARENT,
+                RootAddress,
+                TypeIndex);
+
+            bResult = TRUE;
         }
         else {
 
-            if (g_kdctx.PrivateNamespaceLookupTable == NULL)
-                g_kdctx.PrivateNamespaceLookupTable = ObFindPrivateNamespaceLookupTable(&g_kdctx);
-
-            if (g_kdctx.PrivateNamespaceLookupTable != NULL) {
-
-                bResult = ObpWalkPrivateNamespaceTable(&Collection->ListHead,
-                    Collection->Heap,
-                    (ULONG_PTR)g_kdctx.PrivateNamespaceLookupTable);
+            bResult = ObpWalkPrivateNamespaceTable(Collection, RootAddress);
 
-            }
-            else {
-                SetLastError(ERROR_INTERNAL_ERROR);
-            }
         }
 
     }
@@ -2603,11 +3175,134 @@ BOOL ObCollectionCreateInternal(
         bResult = FALSE;
     }
 
-_FailWeLeave:
-
     return bResult;
 }
 
+/*
+* ObpCollectionPublish
+*
+* Purpose:
+*
+* Swap built collection in, previous contents are released after lock is dropped.
+*
+* Collection is not replaced if it was destroyed since Generation was captured
+* or, when OnlyIfEmpty set, if somebody else already published it.
+*
+*/
+BOOL ObpCollectionPublish(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ POBJECT_COLLECTION NewCollection,
+    _In_ ULONG Generation,
+    _In_ BOOL OnlyIfEmpty
+)
+{
+    BOOL bPublished = FALSE;
+    PARENA ReleaseArena;
+    PLONG ReleaseReferences;
+
+    ReleaseArena = NewCollection->Arena;
+    ReleaseReferences = NewCollection->References;
+
+    AcquireSRWLockExclusive(&g_kdctx.ObCollectionLock);
+
+    if ((Collection->Generation == Generation) &&
+        (OnlyIfEmpty == FALSE || Collection->Count == 0))
+    {
+        ReleaseArena = Collection->Arena;
+        ReleaseReferences = Collection->References;
+        NewCollection->Generation = Generation;
+        *Collection = *NewCollection;
+        bPublished = TRUE;
+    }
+
+    ReleaseSRWLockExclusive(&g_kdctx.ObCollectionLock);
+
+    ObpCollectionRelease(ReleaseArena, ReleaseReferences);
+
+    return bPublished;
+}
+
+/*
+* ObpCollectionCreate
+*
+* Purpose:
+*
+* Build collection without holding lock and publish it.
+*
+* Failed or partial walk is discarded, previous contents are kept.
+*
+*/
+BOOL ObpCollectionCreate(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ BOOL fNamespace,
+    _In_ ULONG Generation,
+    _In_ BOOL OnlyIfEmpty
+)
+{
+    OBJECT_COLLECTION NewCollection;
+
+    if (g_kdctx.ObCollectionShutdown)
+        return FALSE;
+
+    if (!kdConnectDriver())
+        return FALSE;
+
+    if (!ObpCollectionBuild(&NewCollection, fNamespace)) {
+        ObpCollectionRelease(NewCollection.Arena, NewCollection.References);
+        return FALSE;
+    }
+
+    return ObpCollectionPublish(Collection, &NewCollection, Generation, OnlyIfEmpty);
+}
+
+/*
+* ObpCollectionGetGeneration
+*
+* Purpose:
+*
+* Return collection generation and entries count.
+*
+*/
+ULONG ObpCollectionGetGeneration(
+    _In_ POBJECT_COLLECTION Collection,
+    _Out_opt_ PULONG Count
+)
+{
+    ULONG Generation;
+
+    AcquireSRWLockShared(&g_kdctx.ObCollectionLock);
+    Generation = Collection->Generation;
+    if (Count)
+        *Count = Collection->Count;
+    ReleaseSRWLockShared(&g_kdctx.ObCollectionLock);
+
+    return Generation;
+}
+
+/*
+* ObpCollectionReference
+*
+* Purpose:
+*
+* Copy collection view and reference its storage, lock is not held on return.
+*
+* Release view with ObpCollectionRelease.
+*
+*/
+VOID ObpCollectionReference(
+    _In_ POBJECT_COLLECTION Collection,
+    _Out_ POBJECT_COLLECTION View
+)
+{
+    AcquireSRWLockShared(&g_kdctx.ObCollectionLock);
+
+    *View = *Collection;
+    if (View->References)
+        InterlockedIncrement(View->References);
+
+    ReleaseSRWLockShared(&g_kdctx.ObCollectionLock);
+}
+
 /*
 * ObCollectionCreate
 *
@@ -2617,33 +3312,148 @@ _FailWeLeave:
 *
 * Collection must be destroyed with ObCollectionDestroy after use.
 *
-* Calls internal function.
+* Collection is built without holding lock and swapped in when ready,
+* readers keep using previous contents until then.
 *
 */
 BOOL ObCollectionCreate(
     _In_ POBJECT_COLLECTION Collection,
-    _In_ BOOL fNamespace,
-    _In_ BOOL Locked
+    _In_ BOOL fNamespace
 )
 {
-    BOOL bResult = FALSE;
-
     if (Collection == NULL)
-        return bResult;
+        return FALSE;
 
-    if (!kdConnectDriver())
-        return bResult;
+    return ObpCollectionCreate(Collection,
+        fNamespace,
+        ObpCollectionGetGeneration(Collection, NULL),
+        FALSE);
+}
 
-    if (Locked) {
-        bResult = ObCollectionCreateInternal(Collection, fNamespace);
-    }
-    else {
-        EnterCriticalSection(&g_kdctx.ObCollectionLock);
-        bResult = ObCollectionCreateInternal(Collection, fNamespace);
-        LeaveCriticalSection(&g_kdctx.ObCollectionLock);
+#define OBP_REBUILD_IDLE        0
+#define OBP_REBUILD_RUNNING     1
+#define OBP_REBUILD_PENDING     2   //running and another pass requested
+
+/*
+* ObpCollectionRebuildWorker
+*
+* Purpose:
+*
+* Thread pool work routine for ObCollectionRefresh.
+*
+* Refresh requests that arrive during walk are merged into one more pass.
+*
+*/
+VOID CALLBACK ObpCollectionRebuildWorker(
+    _Inout_opt_ PTP_CALLBACK_INSTANCE Instance,
+    _Inout_opt_ PVOID Context,
+    _Inout_opt_ PTP_WORK Work
+)
+{
+    ULONG Generation, Count = 0;
+    POBJECT_COLLECTION Collection = g_kdctx.ObCollectionRebuildTarget;
+
+    UNREFERENCED_PARAMETER(Instance);
+    UNREFERENCED_PARAMETER(Context);
+    UNREFERENCED_PARAMETER(Work);
+
+    for (;;) {
+
+        //
+        // Collection destroyed meanwhile is left empty, it will be created on first lookup.
+        //
+        Generation = ObpCollectionGetGeneration(Collection, &Count);
+        if (Count) {
+            __try {
+                ObpCollectionCreate(Collection,
+                    g_kdctx.ObCollectionRebuildNamespace,
+                    Generation,
+                    FALSE);
+            }
+            __finally {
+                if (AbnormalTermination())
+                    supReportAbnormalTermination(__FUNCTIONW__);
+            }
+        }
+
+        if (g_kdctx.ObCollectionShutdown) {
+            InterlockedExchange(&g_kdctx.ObCollectionRebuildState, OBP_REBUILD_IDLE);
+            break;
+        }
+
+        if (InterlockedCompareExchange(&g_kdctx.ObCollectionRebuildState,
+            OBP_REBUILD_IDLE, OBP_REBUILD_RUNNING) == OBP_REBUILD_RUNNING)
+        {
+            break;
+        }
+
+        //
+        // Refresh was requested during walk, do another pass.
+        //
+        InterlockedExchange(&g_kdctx.ObCollectionRebuildState, OBP_REBUILD_RUNNING);
     }
+}
 
-    return bResult;
+/*
+* ObCollectionRefresh
+*
+* Purpose:
+*
+* Rebuild collection in background.
+*
+* Empty collection is left as is, it will be created on first lookup.
+* Only one rebuild runs at a time, kdShutdown waits for it.
+*
+*/
+BOOL ObCollectionRefresh(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ BOOL fNamespace
+)
+{
+    LONG State;
+    ULONG Count = 0;
+
+    if ((Collection == NULL) || (g_kdctx.ObCollectionRebuildWork == NULL))
+        return FALSE;
+
+    if (g_kdctx.ObCollectionShutdown)
+        return FALSE;
+
+    ObpCollectionGetGeneration(Collection, &Count);
+    if (Count == 0)
+        return TRUE;
+
+    for (;;) {
+
+        State = InterlockedCompareExchange(&g_kdctx.ObCollectionRebuildState,
+            OBP_REBUILD_RUNNING, OBP_REBUILD_IDLE);
+
+        if (State == OBP_REBUILD_IDLE) {
+            g_kdctx.ObCollectionRebuildTarget = Collection;
+            g_kdctx.ObCollectionRebuildNamespace = fNamespace;
+            SubmitThreadpoolWork(g_kdctx.ObCollectionRebuildWork);
+            return TRUE;
+        }
+
+        //
+        // Walk in flight, ask it for one more pass of the same collection.
+        //
+        if (g_kdctx.ObCollectionRebuildTarget != Collection)
+            return FALSE;
+
+        if (State == OBP_REBUILD_PENDING)
+            return TRUE;
+
+        if (InterlockedCompareExchange(&g_kdctx.ObCollectionRebuildState,
+            OBP_REBUILD_PENDING, OBP_REBUILD_RUNNING) != OBP_REBUILD_IDLE)
+        {
+            return TRUE;
+        }
+
+        //
+        // Worker finished meanwhile, start new one.
+        //
+    }
 }
 
 /*
@@ -2651,66 +3461,133 @@ BOOL ObCollectionCreate(
 *
 * Purpose:
 *
-* Destroy collection with object directory dumped info
+* Destroy collection with object directory dumped info.
+*
+* Rebuilds started before this call will not be published.
 *
 */
 VOID ObCollectionDestroy(
     _In_ POBJECT_COLLECTION Collection
 )
 {
+    ULONG Generation;
+    PARENA ReleaseArena;
+    PLONG ReleaseReferences;
+
     if (Collection == NULL)
         return;
 
-    EnterCriticalSection(&g_kdctx.ObCollectionLock);
+    AcquireSRWLockExclusive(&g_kdctx.ObCollectionLock);
+
+    ReleaseArena = Collection->Arena;
+    ReleaseReferences = Collection->References;
+    Generation = Collection->Generation + 1;
+    RtlSecureZeroMemory(Collection, sizeof(OBJECT_COLLECTION));
+    Collection->Generation = Generation;
+
+    ReleaseSRWLockExclusive(&g_kdctx.ObCollectionLock);
+
+    ObpCollectionRelease(ReleaseArena, ReleaseReferences);
+}
+
+/*
+* ObCollectionEnumerate
+*
+* Purpose:
+*
+* Enumerate object collection and callback on each element.
+*
+* Entry passed to callback is valid only during callback call,
+* use Entry->Index with ObCollectionGetEntry to refer element later.
+*
+* Callbacks run without collection lock on referenced view of the contents,
+* collection replaced meanwhile does not affect enumeration.
+*
+*/
+BOOL ObCollectionEnumerate(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ PENUMERATE_COLLECTION_CALLBACK Callback,
+    _In_opt_ PVOID Context
+)
+{
+    BOOL        bCancelled = FALSE;
+    ULONG       i, PathLength, BufferLength = 0;
+    PWCHAR      PathBuffer = NULL, NewBuffer;
+    OBJREF      ObjectEntry;
+    OBJECT_COLLECTION View;
+
+    if ((Collection == NULL) || (Callback == NULL))
+        return FALSE;
+
+    ObpCollectionReference(Collection, &View);
+
+    for (i = 0; i < View.Count; i++) {
+
+        ObpCollectionGetEntry(&View, i, &ObjectEntry);
+
+        //
+        // Rebuild object path in reusable buffer.
+        //
+        if (View.NameLength[i]) {
+
+            PathLength = ObpCollectionQueryPath(&View, i, NULL, 0);
+            if (PathLength > BufferLength) {
+                NewBuffer = (PWCHAR)supHeapAlloc(PathLength * sizeof(WCHAR));
+                if (NewBuffer) {
+                    if (PathBuffer) supHeapFree(PathBuffer);
+                    PathBuffer = NewBuffer;
+                    BufferLength = PathLength;
+                }
+            }
+
+            if (PathBuffer && PathLength <= BufferLength) {
+                ObpCollectionQueryPath(&View, i, PathBuffer, BufferLength);
+                ObjectEntry.ObjectName = PathBuffer;
+            }
+        }
 
-    if (Collection->Heap) {
-        RtlDestroyHeap(Collection->Heap);
-        Collection->Heap = NULL;
+        bCancelled = Callback(&ObjectEntry, Context);
+        if (bCancelled)
+            break;
     }
-    InitializeListHead(&Collection->ListHead);
 
-    LeaveCriticalSection(&g_kdctx.ObCollectionLock);
+    ObpCollectionRelease(View.Arena, View.References);
+
+    if (PathBuffer)
+        supHeapFree(PathBuffer);
+
+    return (bCancelled == FALSE);
 }
 
 /*
-* ObCollectionEnumerate
+* ObCollectionGetEntry
 *
 * Purpose:
 *
-* Enumerate object collection and callback on each element.
+* Copy collection element by index, ObjectName is not set.
 *
 */
-BOOL ObCollectionEnumerate(
+BOOL ObCollectionGetEntry(
     _In_ POBJECT_COLLECTION Collection,
-    _In_ PENUMERATE_COLLECTION_CALLBACK Callback,
-    _In_opt_ PVOID Context
+    _In_ ULONG Index,
+    _Out_ POBJREF Entry
 )
 {
-    BOOL        bCancelled = FALSE;
-    POBJREF     ObjectEntry = NULL;
-    PLIST_ENTRY Head, Next;
+    BOOL bResult = FALSE;
 
-    if ((Collection == NULL) || (Callback == NULL))
+    if ((Collection == NULL) || (Entry == NULL))
         return FALSE;
 
-    EnterCriticalSection(&g_kdctx.ObCollectionLock);
-
-    if (!IsListEmpty(&Collection->ListHead)) {
-        Head = &Collection->ListHead;
-        Next = Head->Flink;
-        while ((Next != NULL) && (Next != Head)) {
-            ObjectEntry = CONTAINING_RECORD(Next, OBJREF, ListEntry);
-            bCancelled = Callback(ObjectEntry, Context);
-            if (bCancelled)
-                break;
+    AcquireSRWLockShared(&g_kdctx.ObCollectionLock);
 
-            Next = Next->Flink;
-        }
+    if (Index < Collection->Count) {
+        ObpCollectionGetEntry(Collection, Index, Entry);
+        bResult = TRUE;
     }
 
-    LeaveCriticalSection(&g_kdctx.ObCollectionLock);
+    ReleaseSRWLockShared(&g_kdctx.ObCollectionLock);
 
-    return (bCancelled == FALSE);
+    return bResult;
 }
 
 /*
@@ -2728,49 +3605,47 @@ POBJREF ObCollectionFindByAddress(
     _In_ BOOLEAN fNamespace
 )
 {
-    BOOL        IsCollectionPresent = FALSE;
-    POBJREF     objectEntry = NULL, returnObject = NULL;
-    PLIST_ENTRY Head, Next;
+    ULONG       i, PathLength, Count = 0, Generation;
+    POBJREF     returnObject = NULL;
 
     if (Collection == NULL)
         return NULL;
 
-    EnterCriticalSection(&g_kdctx.ObCollectionLock);
-
-    if (IsListEmpty(&Collection->ListHead)) {
-        IsCollectionPresent = ObCollectionCreate(Collection, fNamespace, TRUE);
-    }
-    else {
-        IsCollectionPresent = TRUE;
+    //
+    // Create collection on first use, lock is not held while it is built.
+    //
+    Generation = ObpCollectionGetGeneration(Collection, &Count);
+    if (Count == 0) {
+        ObpCollectionCreate(Collection, fNamespace, Generation, TRUE);
     }
 
-    if (IsCollectionPresent) {
-        Head = &Collection->ListHead;
-        Next = Head->Flink;
-        while ((Next != NULL) && (Next != Head)) {
-            objectEntry = CONTAINING_RECORD(Next, OBJREF, ListEntry);
-            if (objectEntry->ObjectAddress == ObjectAddress) {
+    AcquireSRWLockShared(&g_kdctx.ObCollectionLock);
 
-                returnObject = (POBJREF)supHeapAlloc(sizeof(OBJREF));
-                if (returnObject) {
-                    RtlCopyMemory(returnObject, objectEntry, sizeof(OBJREF));
+    for (i = 0; i < Collection->Count; i++) {
 
-                    returnObject->ObjectName = (LPWSTR)supHeapAlloc(
-                        (1 + _strlen(objectEntry->ObjectName)) * sizeof(WCHAR));
+        if (Collection->ObjectAddress[i] == ObjectAddress) {
 
-                    if (returnObject->ObjectName) {
-                        _strcpy(returnObject->ObjectName, objectEntry->ObjectName);
-                    }
+            returnObject = (POBJREF)supHeapAlloc(sizeof(OBJREF));
+            if (returnObject) {
+
+                ObpCollectionGetEntry(Collection, i, returnObject);
+
+                PathLength = (Collection->NameLength[i]) ?
+                    ObpCollectionQueryPath(Collection, i, NULL, 0) : 1;
 
+                returnObject->ObjectName = (LPWSTR)supHeapAlloc(PathLength * sizeof(WCHAR));
+
+                if (returnObject->ObjectName && Collection->NameLength[i]) {
+                    ObpCollectionQueryPath(Collection, i, returnObject->ObjectName, PathLength);
                 }
 
-                break;
             }
-            Next = Next->Flink;
+
+            break;
         }
     }
 
-    LeaveCriticalSection(&g_kdctx.ObCollectionLock);
+    ReleaseSRWLockShared(&g_kdctx.ObCollectionLock);
 
     return returnObject;
 }
@@ -2912,68 +3787,32 @@ BOOL kdIsDebugBoot(
 }
 
 /*
-* kdReportReadError
-*
-* Purpose:
-*
-* Log details about failed driver call.
-*
-*/
-VOID kdReportReadError(
-    _In_ LPWSTR FunctionName,
-    _In_ ULONG_PTR KernelAddress,
-    _In_ ULONG InputBufferLength,
-    _In_ NTSTATUS Status,
-    _In_ PIO_STATUS_BLOCK Iosb
-)
-{
-    WCHAR szBuffer[512];
-
-    RtlStringCchPrintfSecure(szBuffer,
-        512,
-        TEXT("%ws 0x%lX, read at 0x%llX, Iosb(0x%lX, 0x%lX), InputBufferLength 0x%lX"),
-        FunctionName,
-        Status,
-        KernelAddress,
-        Iosb->Status,
-        Iosb->Information,
-        InputBufferLength);
-
-    logAdd(WOBJ_LOG_ENTRY_ERROR,
-        szBuffer);
-}
-
-/*
-* kdpReadSystemMemoryEx
+* kdpReadSystemMemoryQuiet
 *
 * Purpose:
 *
-* Wrapper around SysDbgReadVirtual request to the KLDBGDRV
+* SysDbgReadVirtual request to the KLDBGDRV, failure is only returned to the caller.
 *
 */
-BOOL kdpReadSystemMemoryEx(
+NTSTATUS kdpReadSystemMemoryQuiet(
     _In_ ULONG_PTR Address,
     _Inout_ PVOID Buffer,
     _In_ ULONG BufferSize,
-    _Out_opt_ PULONG NumberOfBytesRead
+    _Out_ PIO_STATUS_BLOCK IoStatusBlock
 )
 {
     NTSTATUS        status;
     KLDBG           kldbg;
-    IO_STATUS_BLOCK iost;
     SYSDBG_VIRTUAL  dbgRequest;
 
-    if (NumberOfBytesRead)
-        *NumberOfBytesRead = 0;
-
-    if ((Buffer == NULL) || (BufferSize == 0))
-        return FALSE;
+    IoStatusBlock->Information = 0;
+    IoStatusBlock->Status = 0;
 
     if (Address < g_kdctx.SystemRangeStart)
-        return FALSE;
+        return STATUS_INVALID_PARAMETER_1;
 
     if (!kdConnectDriver())
-        return FALSE;
+        return STATUS_DEVICE_DOES_NOT_EXIST;
 
     //
     // Fill parameters for KdSystemDebugControl.
@@ -2989,14 +3828,11 @@ BOOL kdpReadSystemMemoryEx(
     kldbg.Buffer = &dbgRequest;
     kldbg.BufferSize = sizeof(SYSDBG_VIRTUAL);
 
-    iost.Information = 0;
-    iost.Status = 0;
-
     status = NtDeviceIoControlFile(g_kdctx.DeviceHandle,
         NULL,
         NULL,
         NULL,
-        &iost,
+        IoStatusBlock,
         IOCTL_KD_PASS_THROUGH,
         &kldbg,
         sizeof(kldbg),
@@ -3010,9 +3846,50 @@ BOOL kdpReadSystemMemoryEx(
             NULL);
 
         if (NT_SUCCESS(status))
-            status = iost.Status;
+            status = IoStatusBlock->Status;
     }
 
+    return status;
+}
+
+/*
+* kdpReadSystemMemoryEx
+*
+* Purpose:
+*
+* Wrapper around SysDbgReadVirtual request to the KLDBGDRV
+*
+* Reads touching pages that recently failed are rejected without driver call.
+*
+*/
+BOOL kdpReadSystemMemoryEx(
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize,
+    _Out_opt_ PULONG NumberOfBytesRead,
+    _In_opt_ PVOID CallerAddress
+)
+{
+    NTSTATUS        status;
+    IO_STATUS_BLOCK iost;
+
+    if (NumberOfBytesRead)
+        *NumberOfBytesRead = 0;
+
+    if ((Buffer == NULL) || (BufferSize == 0))
+        return FALSE;
+
+    if (Address < g_kdctx.SystemRangeStart)
+        return FALSE;
+
+    if (kdReadFailFast(Address, BufferSize, CallerAddress))
+        return FALSE;
+
+    if (!kdConnectDriver())
+        return FALSE;
+
+    status = kdpReadSystemMemoryQuiet(Address, Buffer, BufferSize, &iost);
+
     if (NT_SUCCESS(status)) {
 
         if (NumberOfBytesRead)
@@ -3029,9 +3906,265 @@ BOOL kdpReadSystemMemoryEx(
                 *NumberOfBytesRead = (ULONG)iost.Information;
         }
 
-        kdReportReadError(__FUNCTIONW__, Address, BufferSize, status, &iost);
+        kdReportReadError(__FUNCTIONW__, Address, BufferSize, status, &iost, CallerAddress);
+        return FALSE;
+    }
+}
+
+/*
+* kdReadSystemMemoryTraced
+*
+* Purpose:
+*
+* Read kernel memory and account it to the Site, see kdReadSystemMemoryEx.
+*
+*/
+BOOL kdReadSystemMemoryTraced(
+    _In_ LPCSTR Site,
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize,
+    _Out_opt_ PULONG NumberOfBytesRead
+)
+{
+    BOOL bResult;
+    LARGE_INTEGER StartTime;
+
+    QueryPerformanceCounter(&StartTime);
+
+    bResult = kdpReadSystemMemoryBackend(Address,
+        Buffer,
+        BufferSize,
+        NumberOfBytesRead,
+        _ReturnAddress());
+
+    kdStatsRecord(Site, NULL, BufferSize, bResult, StartTime.QuadPart);
+
+    return bResult;
+}
+
+/*
+* kdPluginReadSystemMemoryEx
+*
+* Purpose:
+*
+* Plugin version of kdReadSystemMemoryEx, reads are accounted to the calling plugin module.
+*
+*/
+BOOL CALLBACK kdPluginReadSystemMemoryEx(
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize,
+    _Out_opt_ PULONG NumberOfBytesRead
+)
+{
+    BOOL bResult;
+    HMODULE hModule = NULL;
+    PVOID CallerAddress = _ReturnAddress();
+    LARGE_INTEGER StartTime;
+
+    GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        (LPCWSTR)CallerAddress,
+        &hModule);
+
+    QueryPerformanceCounter(&StartTime);
+
+    bResult = kdpReadSystemMemoryBackend(Address,
+        Buffer,
+        BufferSize,
+        NumberOfBytesRead,
+        CallerAddress);
+
+    kdStatsRecord(KDSTATS_PLUGIN_SITE, (PVOID)hModule, BufferSize, bResult, StartTime.QuadPart);
+
+    return bResult;
+}
+
+/*
+* kdpCompareReadRequest
+*
+* Purpose:
+*
+* qsort comparer for batched read requests.
+*
+*/
+INT __cdecl kdpCompareReadRequest(
+    _In_ const void* First,
+    _In_ const void* Second
+)
+{
+    PKDREAD_REQUEST Request1 = *(PKDREAD_REQUEST*)First;
+    PKDREAD_REQUEST Request2 = *(PKDREAD_REQUEST*)Second;
+
+    if (Request1->Address == Request2->Address)
+        return 0;
+
+    return (Request1->Address < Request2->Address) ? -1 : 1;
+}
+
+/*
+* kdpReadSystemMemorySpan
+*
+* Purpose:
+*
+* Read merged span of batched requests.
+*
+* Span may cover bytes nobody asked for, so failure is not reported to
+* the read failure tracking, requests are read separately after it.
+* Negative page cache is still consulted and updated.
+*
+*/
+BOOL kdpReadSystemMemorySpan(
+    _In_ LPCSTR Site,
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize
+)
+{
+    NTSTATUS ntStatus;
+    LARGE_INTEGER StartTime;
+#if !defined(_USE_OWN_DRIVER) || !defined(_USE_WINIO)
+    IO_STATUS_BLOCK iost;
+#endif
+
+    if (kdReadFailKnown(Address, BufferSize))
+        return FALSE;
+
+    QueryPerformanceCounter(&StartTime);
+
+#if defined(_USE_OWN_DRIVER) && defined(_USE_WINIO)
+    ntStatus = WinIoReadSystemMemoryQuiet(Address, Buffer, BufferSize);
+#else
+    ntStatus = kdpReadSystemMemoryQuiet(Address, Buffer, BufferSize, &iost);
+#endif
+
+    if (!NT_SUCCESS(ntStatus)) {
+        kdReadFailRemember(Address, BufferSize, ntStatus);
         return FALSE;
     }
+
+    kdStatsRecord(Site, NULL, BufferSize, TRUE, StartTime.QuadPart);
+    return TRUE;
+}
+
+/*
+* kdReadSystemMemoryBatch
+*
+* Purpose:
+*
+* Read several unrelated kernel memory blocks.
+*
+* Requests are sorted by address and neighbours are merged into single driver call,
+* so blocks allocated close to each other (e.g. small pool callback blocks) cost one read.
+* If merged read fails each request of the run is read separately, only these
+* reads are accounted as failures.
+*
+* Return number of successfully read requests, Result field set for each request.
+*
+*/
+ULONG kdReadSystemMemoryBatch(
+    _Inout_updates_(Count) PKDREAD_REQUEST Requests,
+    _In_ ULONG Count
+)
+{
+    ULONG i, j, k, cSorted = 0, cRead = 0;
+    ULONG_PTR SpanStart, SpanEnd, RequestEnd;
+    PKDREAD_REQUEST* Sorted;
+    PKDREAD_REQUEST Request;
+    PBYTE Span;
+
+    if (Requests == NULL || Count == 0)
+        return 0;
+
+    for (i = 0; i < Count; i++)
+        Requests[i].Result = FALSE;
+
+    Sorted = (PKDREAD_REQUEST*)supHeapAlloc(Count * sizeof(PKDREAD_REQUEST));
+    Span = (PBYTE)supHeapAlloc(KDREAD_BATCH_MAX_SPAN);
+
+    if (Sorted == NULL || Span == NULL) {
+
+        for (i = 0; i < Count; i++) {
+            Requests[i].Result = kdReadSystemMemory(Requests[i].Address,
+                Requests[i].Buffer,
+                Requests[i].Size);
+            if (Requests[i].Result) cRead++;
+        }
+
+        if (Sorted) supHeapFree(Sorted);
+        if (Span) supHeapFree(Span);
+        return cRead;
+    }
+
+    //
+    // Drop requests that cannot be read anyway.
+    //
+    for (i = 0; i < Count; i++) {
+        if (Requests[i].Address < g_kdctx.SystemRangeStart ||
+            Requests[i].Buffer == NULL ||
+            Requests[i].Size == 0)
+        {
+            continue;
+        }
+        Sorted[cSorted++] = &Requests[i];
+    }
+
+    if (cSorted > 1)
+        RtlQuickSort(Sorted, cSorted, sizeof(PKDREAD_REQUEST), kdpCompareReadRequest);
+
+    for (i = 0; i < cSorted; i = j) {
+
+        SpanStart = Sorted[i]->Address;
+        SpanEnd = SpanStart + Sorted[i]->Size;
+
+        for (j = i + 1; j < cSorted; j++) {
+
+            Request = Sorted[j];
+
+            if (Request->Address > SpanEnd &&
+                Request->Address - SpanEnd > KDREAD_BATCH_MAX_GAP)
+            {
+                break;
+            }
+
+            RequestEnd = Request->Address + Request->Size;
+            if (RequestEnd < SpanEnd)
+                RequestEnd = SpanEnd;
+
+            if (RequestEnd - SpanStart > KDREAD_BATCH_MAX_SPAN)
+                break;
+
+            SpanEnd = RequestEnd;
+        }
+
+        if ((j - i > 1) &&
+            kdpReadSystemMemorySpan(__FUNCTION__, SpanStart, Span, (ULONG)(SpanEnd - SpanStart)))
+        {
+            for (k = i; k < j; k++) {
+                Request = Sorted[k];
+                RtlCopyMemory(Request->Buffer,
+                    &Span[Request->Address - SpanStart],
+                    Request->Size);
+                Request->Result = TRUE;
+            }
+        }
+        else {
+            for (k = i; k < j; k++) {
+                Request = Sorted[k];
+                Request->Result = kdReadSystemMemory(Request->Address,
+                    Request->Buffer,
+                    Request->Size);
+            }
+        }
+    }
+
+    for (i = 0; i < cSorted; i++)
+        if (Sorted[i]->Result) cRead++;
+
+    supHeapFree(Sorted);
+    supHeapFree(Span);
+
+    return cRead;
 }
 
 /*
@@ -3218,24 +4351,22 @@ BOOL kdQuerySystemInformation(
 *
 * Purpose:
 *
-* Wrapper for hde64_disasm.
+* Wrapper for hde64_length, flags are the same as hde64_disasm returns.
 *
 */
 UCHAR kdGetInstructionLength(
     _In_ PVOID ptrCode,
     _Out_ PULONG ptrFlags)
 {
-    hde64s  hs;
+    UCHAR Length;
 
     __try {
 
-        hde64_disasm((void*)ptrCode, &hs);
-        if (hs.flags & F_ERROR) {
-            *ptrFlags = hs.flags;
+        Length = (UCHAR)hde64_length((void*)ptrCode, (uint32_t*)ptrFlags);
+        if (*ptrFlags & F_ERROR)
             return 0;
-        }
-        *ptrFlags = hs.flags;
-        return hs.len;
+
+        return Length;
     }
     __except (WOBJ_EXCEPTION_FILTER_LOG) {
         return 0;
@@ -3265,7 +4396,10 @@ ULONG_PTR kdQueryWin32kApiSetTable(
 
     ULONG_PTR   tableAddress = 0;
     LONG        relativeValue = 0;
-    hde64s      hs;
+    ULONG       nextLength, Flags;
+
+    if (kdCacheLookup(KdCacheWin32kApiSetTable, (PVOID)hWin32k, &tempOffset))
+        return (ULONG_PTR)hWin32k + tempOffset;
 
     __try {
 
@@ -3285,12 +4419,10 @@ ULONG_PTR kdQueryWin32kApiSetTable(
 
         do {
 
-            hde64_disasm((void*)(ptrCode + Index), &hs);
-            if (hs.flags & F_ERROR)
+            instLength = hde64_length((void*)(ptrCode + Index), (uint32_t*)&Flags);
+            if (Flags & F_ERROR)
                 break;
 
-            instLength = hs.len;
-
             //
             // Check if 3 byte length MOV.
             //
@@ -3301,23 +4433,23 @@ ULONG_PTR kdQueryWin32kApiSetTable(
                 if (ptrCode[tempOffset] == 0x8B) {
 
                     tempOffset = Index + instLength;
-                    hde64_disasm((void*)(ptrCode + tempOffset), &hs);
-                    if (hs.flags & F_ERROR)
+                    nextLength = hde64_length((void*)(ptrCode + tempOffset), (uint32_t*)&Flags);
+                    if (Flags & F_ERROR)
                         break;
 
                     //
                     // Check if next instruction is 7 bytes len LEA.
                     //
-                    if (hs.len == IL_Win32kApiSetTable) {
+                    if (nextLength == IL_Win32kApiSetTable) {
                         if (ptrCode[tempOffset + 1] == 0x8D) {
 
                             //
                             // Update counters.
                             //
                             Index = tempOffset;
-                            instLength = hs.len;
+                            instLength = nextLength;
 
-                            relativeValue = *(PLONG)(ptrCode + tempOffset + (hs.len - 4));
+                            relativeValue = *(PLONG)(ptrCode + tempOffset + (nextLength - 4));
                             break;
                         }
                     }
@@ -3334,6 +4466,11 @@ ULONG_PTR kdQueryWin32kApiSetTable(
 
         tableAddress = (ULONG_PTR)ptrCode + Index + instLength + relativeValue;
 
+        kdCacheStore(KdCacheWin32kApiSetTable,
+            (PVOID)hWin32k,
+            (ULONG)(tableAddress - (ULONG_PTR)hWin32k),
+            (ULONG)((ULONG_PTR)ptrCode + Index - (ULONG_PTR)hWin32k));
+
     }
     __except (WOBJ_EXCEPTION_FILTER_LOG) {
         return 0;
@@ -3401,6 +4538,7 @@ VOID kdInit(
 )
 {
     BOOL bLoadState;
+    TRACE_SPAN Span;
     WCHAR szBuffer[MAX_PATH * 2];
 
     RtlSecureZeroMemory(&g_kdctx, sizeof(g_kdctx));
@@ -3415,8 +4553,10 @@ VOID kdInit(
     //
     g_kdctx.DriverOpenLoadStatus = ERROR_NOT_CAPABLE;
 
-    InitializeListHead(&g_kdctx.ObCollection.ListHead);
-    RtlInitializeCriticalSection(&g_kdctx.ObCollectionLock);
+    InitializeSRWLock(&g_kdctx.ObCollectionLock);
+    g_kdctx.ObCollectionRebuildWork = CreateThreadpoolWork(ObpCollectionRebuildWorker, NULL, NULL);
+
+    kdStatsInitialize();
 
     //
     // Minimum supported client is windows 7
@@ -3433,7 +4573,16 @@ VOID kdInit(
     //
     // Query global variables.
     //
+    TRACE_BEGIN(Span, "kdQuerySystemInformation");
     kdQuerySystemInformation(&g_kdctx);
+    TRACE_END(Span);
+
+    //
+    // Load resolver cache, it is keyed by mapped kernel image.
+    //
+    TRACE_BEGIN(Span, "kdCacheInitialize");
+    kdCacheInitialize();
+    TRACE_END(Span);
 
     //
     // No admin rights, leave.
@@ -3466,6 +4615,8 @@ VOID kdInit(
     //
     if (supEnablePrivilege(SE_DEBUG_PRIVILEGE, TRUE)) {
 
+        TRACE_BEGIN(Span, "kdOpenLoadDriver");
+
 #ifdef _USE_OWN_DRIVER
 
         bLoadState = kdOpenLoadDriverPrivate(szBuffer);
@@ -3476,6 +4627,8 @@ VOID kdInit(
 
 #endif
 
+        TRACE_END(Span);
+
         if (bLoadState == FALSE) {
 
             RtlStringCchPrintfSecure(szBuffer,
@@ -3483,7 +4636,10 @@ VOID kdInit(
                 TEXT("Could not open/load helper driver.\r\nSome features maybe unavailable, error code 0x%lX"),
                 g_kdctx.DriverOpenLoadStatus);
 
-            MessageBox(GetDesktopWindow(), szBuffer, TEXT("WinObjEx64"), MB_ICONINFORMATION);
+            if (g_WinObj.IsHeadless)
+                headlessReportError(szBuffer);
+            else
+                MessageBox(GetDesktopWindow(), szBuffer, TEXT("WinObjEx64"), MB_ICONINFORMATION);
 
         }
 
@@ -3502,8 +4658,10 @@ VOID kdInit(
         // Locate and remember ObHeaderCookie, routine require driver usage, do not move.
         //
         if (g_WinObj.osver.dwMajorVersion >= 10) {
+            TRACE_BEGIN(Span, "ObpFindHeaderCookie");
             if (!ObpFindHeaderCookie(&g_kdctx))
                 g_kdctx.ObHeaderCookie.Valid = FALSE;
+            TRACE_END(Span);
         }
     }
 }
@@ -3565,6 +4723,16 @@ VOID kdShutdown(
     VOID
 )
 {
+    //
+    // Stop background collection rebuild before anything it uses goes away.
+    //
+    InterlockedExchange((PLONG)&g_kdctx.ObCollectionShutdown, TRUE);
+    if (g_kdctx.ObCollectionRebuildWork) {
+        WaitForThreadpoolWorkCallbacks(g_kdctx.ObCollectionRebuildWork, TRUE);
+        CloseThreadpoolWork(g_kdctx.ObCollectionRebuildWork);
+        g_kdctx.ObCollectionRebuildWork = NULL;
+    }
+
     //
     // Close device handle and make it invalid.
     //
@@ -3577,7 +4745,6 @@ VOID kdShutdown(
     // Destroy collection if present.
     //
     ObCollectionDestroy(&g_kdctx.ObCollection);
-    RtlDeleteCriticalSection(&g_kdctx.ObCollectionLock);
 
 #ifdef _USE_OWN_DRIVER
     kdpUnloadHelperDriver();
@@ -3585,6 +4752,13 @@ VOID kdShutdown(
     kdpUnloadWindbgDriver();
 #endif
 
+    kdCacheShutdown();
+
+    if (g_kdctx.NtOsRefIndex) {
+        refIndexDestroy(g_kdctx.NtOsRefIndex);
+        g_kdctx.NtOsRefIndex = NULL;
+    }
+
     if (g_kdctx.NtOsImageMap) {
         FreeLibrary((HMODULE)g_kdctx.NtOsImageMap);
         g_kdctx.NtOsImageMap = NULL;
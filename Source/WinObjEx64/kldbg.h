@@ -57,12 +57,63 @@ typedef enum _OBJ_HEADER_INFO_FLAG {
     HeaderNameInfoFlag = 0x2,
     HeaderHandleInfoFlag = 0x4,
     HeaderQuotaInfoFlag = 0x8,
-    HeaderProcessInfoFlag = 0x10
+    HeaderProcessInfoFlag = 0x10,
+    HeaderAuditInfoFlag = 0x20,
+    HeaderExtendedInfoFlag = 0x40
 } OBJ_HEADER_INFO_FLAG;
 
+//
+// Optional headers span, limited by ObpInfoMaskToOffset element type.
+//
+#define OBJECT_HEADER_INFO_MAX_SPAN 0x100
+
+//
+// OBJECT_HEADER together with optional headers that precede it, dumped with single read.
+// Data[OBJECT_HEADER_INFO_MAX_SPAN] is OBJECT_HEADER, BlockAddress is first valid byte.
+//
+typedef struct _OBJECT_HEADER_BLOCK {
+    ULONG_PTR HeaderAddress;
+    ULONG_PTR BlockAddress;
+    BYTE Data[OBJECT_HEADER_INFO_MAX_SPAN + sizeof(OBJECT_HEADER)];
+} OBJECT_HEADER_BLOCK, *POBJECT_HEADER_BLOCK;
+
+#define OBJECT_HEADER_BLOCK_TO_HEADER(Block) \
+    ((POBJECT_HEADER)&(Block)->Data[OBJECT_HEADER_INFO_MAX_SPAN])
+
+typedef struct _OBJREFPNS {
+    ULONG SizeOfBoundaryInformation;
+    ULONG_PTR NamespaceDirectoryAddress; //point to OBJECT_DIRECTORY
+    ULONG_PTR NamespaceLookupEntry; //point to OBJECT_NAMESPACE_ENTRY
+} OBJREFPNS, *POBJREFPNS;
+
+#define OBCOLLECTION_NO_PARENT              MAXULONG
+#define OBCOLLECTION_INITIAL_CAPACITY       1024
+#define OBCOLLECTION_INITIAL_POOL_LENGTH    (16 * 1024)
+
+//
+// Object collection stored as parallel arrays indexed by entry index.
+// Only leaf names are kept in NamePool, full path is rebuilt by walking ParentIndex chain.
+// All columns are allocated as single block from collection arena,
+// storage is released at once when collection is replaced or destroyed
+// and no enumeration references it anymore.
+//
 typedef struct _OBJECT_COLLECTION {
-    LIST_ENTRY ListHead;
-    HANDLE Heap;
+    PARENA Arena;
+    PLONG References; //allocated from Arena, arena is released when last reference dropped
+    ULONG Generation; //incremented on destroy, stale rebuilds are not published
+    BOOL Namespace; //private namespace objects, names are not paths
+    ULONG Count;
+    ULONG Capacity;
+    PULONG_PTR ObjectAddress;
+    PULONG_PTR HeaderAddress;
+    POBJREFPNS PrivateNamespace; //namespace collection only
+    PULONG ParentIndex; //OBCOLLECTION_NO_PARENT for root directory objects
+    PULONG NameOffset; //in WCHARs from NamePool start
+    PUSHORT NameLength; //in WCHARs, 0 if object has no name
+    PUCHAR TypeIndex;
+    PWCHAR NamePool;
+    ULONG NamePoolLength;
+    ULONG NamePoolCapacity;
 } OBJECT_COLLECTION, *POBJECT_COLLECTION;
 
 typedef struct _OBHEADER_COOKIE {
@@ -104,6 +155,9 @@ typedef struct _KLDBGCONTEXT {
     //ntoskrnl mapped image
     PVOID NtOsImageMap;
 
+    //ntoskrnl code references index, built on demand
+    PREFINDEX NtOsRefIndex;
+
     //driver loading/open status
     ULONG DriverOpenLoadStatus;
     ULONG DriverOpenStatus;
@@ -118,8 +172,15 @@ typedef struct _KLDBGCONTEXT {
     //objects collection
     OBJECT_COLLECTION ObCollection;
 
-    //object list lock
-    CRITICAL_SECTION ObCollectionLock;
+    //object collections lock, shared for readers, exclusive only to swap contents
+    SRWLOCK ObCollectionLock;
+
+    //background collection rebuild, at most one walk in flight
+    PTP_WORK ObCollectionRebuildWork;
+    POBJECT_COLLECTION ObCollectionRebuildTarget;
+    BOOL ObCollectionRebuildNamespace;
+    LONG ObCollectionRebuildState;
+    BOOL ObCollectionShutdown;
 
 } KLDBGCONTEXT, *PKLDBGCONTEXT;
 
@@ -141,14 +202,11 @@ typedef struct _OBJINFO {
     OBJECT_HEADER ObjectHeader;
 } OBJINFO, *POBJINFO;
 
-typedef struct _OBJREFPNS {
-    ULONG SizeOfBoundaryInformation;
-    ULONG_PTR NamespaceDirectoryAddress; //point to OBJECT_DIRECTORY
-    ULONG_PTR NamespaceLookupEntry; //point to OBJECT_NAMESPACE_ENTRY
-} OBJREFPNS, *POBJREFPNS;
-
+//
+// Collection entry view, Index is position in collection.
+//
 typedef struct _OBJREF {
-    LIST_ENTRY ListEntry;
+    ULONG Index;
     LPWSTR ObjectName;
     ULONG_PTR HeaderAddress;
     ULONG_PTR ObjectAddress;
@@ -337,10 +395,27 @@ BOOL ObHeaderToNameInfoAddressEx(
     _Inout_ PULONG_PTR HeaderAddress,
     _In_ BYTE DesiredHeaderBit);
 
+BOOL ObReadObjectHeaderBlock(
+    _In_ ULONG_PTR HeaderAddress,
+    _Out_ POBJECT_HEADER_BLOCK HeaderBlock);
+
+PVOID ObGetObjectHeaderInfo(
+    _In_ POBJECT_HEADER_BLOCK HeaderBlock,
+    _In_ OBJ_HEADER_INFO_FLAG InfoFlag,
+    _Out_opt_ PULONG_PTR InfoAddress);
+
+LPWSTR ObQueryNameStringFromBlock(
+    _In_ POBJECT_HEADER_BLOCK HeaderBlock,
+    _Out_opt_ PSIZE_T ReturnLength,
+    _In_ HANDLE HeapHandle);
+
 BOOL ObCollectionCreate(
     _In_ POBJECT_COLLECTION Collection,
-    _In_ BOOL fNamespace,
-    _In_ BOOL Locked);
+    _In_ BOOL fNamespace);
+
+BOOL ObCollectionRefresh(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ BOOL fNamespace);
 
 VOID ObCollectionDestroy(
     _In_ POBJECT_COLLECTION Collection);
@@ -350,6 +425,11 @@ BOOL ObCollectionEnumerate(
     _In_ PENUMERATE_COLLECTION_CALLBACK Callback,
     _In_opt_ PVOID Context);
 
+BOOL ObCollectionGetEntry(
+    _In_ POBJECT_COLLECTION Collection,
+    _In_ ULONG Index,
+    _Out_ POBJREF Entry);
+
 POBJREF ObCollectionFindByAddress(
     _In_ POBJECT_COLLECTION Collection,
     _In_ ULONG_PTR ObjectAddress,
@@ -358,6 +438,14 @@ POBJREF ObCollectionFindByAddress(
 PVOID ObGetCallbackBlockRoutine(
     _In_ PVOID CallbackBlock);
 
+PVOID ObFindPrivateNamespaceLookupTable(
+    _In_ PKLDBGCONTEXT Context);
+
+VOID ObGetCallbackBlockRoutines(
+    _In_reads_(Count) PEX_FAST_REF Callbacks,
+    _In_ ULONG Count,
+    _Out_writes_(Count) PVOID* Routines);
+
 BOOLEAN kdConnectDriver(
     VOID);
 
@@ -376,21 +464,58 @@ BOOL kdpReadSystemMemoryEx(
     _In_ ULONG_PTR Address,
     _Inout_ PVOID Buffer,
     _In_ ULONG BufferSize,
-    _Out_opt_ PULONG NumberOfBytesRead);
+    _Out_opt_ PULONG NumberOfBytesRead,
+    _In_opt_ PVOID CallerAddress);
 
 #ifdef _USE_OWN_DRIVER
 #ifdef _USE_WINIO
-#define kdReadSystemMemoryEx WinIoReadSystemMemoryEx
+#define kdpReadSystemMemoryBackend WinIoReadSystemMemoryEx
 #else
-#define kdReadSystemMemoryEx kdpReadSystemMemoryEx
+#define kdpReadSystemMemoryBackend kdpReadSystemMemoryEx
 #endif
 #else 
-#define kdReadSystemMemoryEx kdpReadSystemMemoryEx
+#define kdpReadSystemMemoryBackend kdpReadSystemMemoryEx
 #endif
 
+BOOL kdReadSystemMemoryTraced(
+    _In_ LPCSTR Site,
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize,
+    _Out_opt_ PULONG NumberOfBytesRead);
+
+BOOL CALLBACK kdPluginReadSystemMemoryEx(
+    _In_ ULONG_PTR Address,
+    _Inout_ PVOID Buffer,
+    _In_ ULONG BufferSize,
+    _Out_opt_ PULONG NumberOfBytesRead);
+
+//
+// Every read is accounted to the calling function, see kdstats.c.
+//
+#define kdReadSystemMemoryEx(Address, Buffer, BufferSize, NumberOfBytesRead) \
+    kdReadSystemMemoryTraced(__FUNCTION__, Address, Buffer, BufferSize, NumberOfBytesRead)
+
 #define kdReadSystemMemory(Address, Buffer, BufferSize) \
     kdReadSystemMemoryEx(Address, Buffer, BufferSize, NULL)
 
+//
+// Batched read limits, requests closer than gap are merged into single read of at most span bytes.
+//
+#define KDREAD_BATCH_MAX_SPAN   0x2000
+#define KDREAD_BATCH_MAX_GAP    0x400
+
+typedef struct _KDREAD_REQUEST {
+    ULONG_PTR Address;
+    PVOID Buffer;
+    ULONG Size;
+    BOOL Result;
+} KDREAD_REQUEST, *PKDREAD_REQUEST;
+
+ULONG kdReadSystemMemoryBatch(
+    _Inout_updates_(Count) PKDREAD_REQUEST Requests,
+    _In_ ULONG Count);
+
 #ifdef _DEBUG
 #define kdDebugPrint(f, ...) DbgPrint(f, __VA_ARGS__)
 #else
@@ -406,12 +531,8 @@ BOOL kdIsDebugBoot(
 VOID kdShutdown(
     VOID);
 
-VOID kdReportReadError(
-    _In_ LPWSTR FunctionName,
-    _In_ ULONG_PTR KernelAddress,
-    _In_ ULONG InputBufferLength,
-    _In_ NTSTATUS Status,
-    _In_ PIO_STATUS_BLOCK Iosb);
+PREFINDEX kdQueryNtOsReferenceIndex(
+    VOID);
 
 UCHAR kdGetInstructionLength(
     _In_ PVOID ptrCode,
@@ -187,6 +187,7 @@ VOID ListObjectDirectoryTree(
     NTSTATUS            ntStatus;
     ULONG               queryContext = 0, rLength;
     HANDLE              directoryHandle = NULL;
+    TRACE_SPAN          Span;
 
     POBJECT_DIRECTORY_INFORMATION directoryEntry;
 
@@ -196,6 +197,8 @@ VOID ListObjectDirectoryTree(
     if (directoryHandle == NULL)
         return;
 
+    TRACE_BEGIN(Span, "ListDirectoryTree");
+
     do {
 
         //
@@ -255,6 +258,8 @@ VOID ListObjectDirectoryTree(
     } while (TRUE);
 
     NtClose(directoryHandle);
+
+    TRACE_END_DETAIL(Span, SubDirName);
 }
 
 /*
@@ -395,6 +400,7 @@ VOID ListObjectsInDirectory(
     NTSTATUS            ntStatus;
     ULONG               queryContext = 0, rLength;
     HANDLE              directoryHandle = NULL;
+    TRACE_SPAN          Span;
 
     POBJECT_DIRECTORY_INFORMATION objinf;
 
@@ -404,6 +410,8 @@ VOID ListObjectsInDirectory(
     if (directoryHandle == NULL)
         return;
 
+    TRACE_BEGIN(Span, "ListObjectsInDirectory");
+
     do {
 
         //
@@ -437,6 +445,8 @@ VOID ListObjectsInDirectory(
     } while (TRUE);
 
     NtClose(directoryHandle);
+
+    TRACE_END_DETAIL(Span, lpObjectDirectory);
 }
 
 /*
@@ -33,12 +33,20 @@ VOID logCreate()
 {
     RtlSecureZeroMemory(&g_WinObjLog, sizeof(g_WinObjLog));
 
-    g_WinObjLog.Entries = (WOBJ_LOG_ENTRY*)supVirtualAlloc(
-        sizeof(WOBJ_LOG_ENTRY) * WOBJ_MAX_LOG_CAPACITY);
-    if (g_WinObjLog.Entries) {
-        InitializeCriticalSection(&g_WinObjLog.Lock);
-        g_WinObjLog.Initialized = TRUE;
+    g_WinObjLog.Slots = (WOBJ_LOG_SLOT*)supVirtualAlloc(
+        sizeof(WOBJ_LOG_SLOT) * WOBJ_MAX_LOG_CAPACITY);
+    if (g_WinObjLog.Slots == NULL)
+        return;
+
+    g_WinObjLog.Data = (WCHAR*)supVirtualAlloc(
+        sizeof(WCHAR) * WOBJ_LOG_DATA_CAPACITY);
+    if (g_WinObjLog.Data == NULL) {
+        supVirtualFree(g_WinObjLog.Slots);
+        g_WinObjLog.Slots = NULL;
+        return;
     }
+
+    g_WinObjLog.Initialized = TRUE;
 }
 
 /*
@@ -48,15 +56,110 @@ VOID logCreate()
 *
 * Destroy log.
 *
+* N.B. Buffers are left to the process exit as other threads
+* may still be inside logAdd.
+*
 */
 VOID logFree()
 {
-    EnterCriticalSection(&g_WinObjLog.Lock);
     g_WinObjLog.Initialized = FALSE;
-    g_WinObjLog.Count = 0;
-    supVirtualFree(g_WinObjLog.Entries);
-    LeaveCriticalSection(&g_WinObjLog.Lock);
-    DeleteCriticalSection(&g_WinObjLog.Lock);
+}
+
+/*
+* logpRingWrite
+*
+* Purpose:
+*
+* Copy message text to the data ring, wrapping at its end.
+*
+*/
+VOID logpRingWrite(
+    _In_ LONG64 Position,
+    _In_ WCHAR* Source,
+    _In_ ULONG Length
+)
+{
+    ULONG Offset, Head;
+
+    Offset = (ULONG)(Position & (WOBJ_LOG_DATA_CAPACITY - 1));
+    Head = min(Length, WOBJ_LOG_DATA_CAPACITY - Offset);
+
+    RtlCopyMemory(&g_WinObjLog.Data[Offset], Source, Head * sizeof(WCHAR));
+    if (Length > Head)
+        RtlCopyMemory(g_WinObjLog.Data, &Source[Head], (Length - Head) * sizeof(WCHAR));
+}
+
+/*
+* logpRingRead
+*
+* Purpose:
+*
+* Copy message text from the data ring, wrapping at its end.
+*
+*/
+VOID logpRingRead(
+    _In_ LONG64 Position,
+    _In_ WCHAR* Destination,
+    _In_ ULONG Length
+)
+{
+    ULONG Offset, Head;
+
+    Offset = (ULONG)(Position & (WOBJ_LOG_DATA_CAPACITY - 1));
+    Head = min(Length, WOBJ_LOG_DATA_CAPACITY - Offset);
+
+    RtlCopyMemory(Destination, &g_WinObjLog.Data[Offset], Head * sizeof(WCHAR));
+    if (Length > Head)
+        RtlCopyMemory(&Destination[Head], g_WinObjLog.Data, (Length - Head) * sizeof(WCHAR));
+}
+
+/*
+* logpClaimSlot
+*
+* Purpose:
+*
+* Take ownership of slot for entry with given sequence number.
+*
+* Writer one ring behind may still own the slot, wait for it shortly.
+* Return FALSE if slot remains owned or already holds newer entry.
+*
+*/
+BOOL logpClaimSlot(
+    _In_ PWOBJ_LOG_SLOT Slot,
+    _In_ LONG64 Sequence
+)
+{
+    ULONG SpinCount;
+    LONG64 Current, Owner = -(Sequence + 1);
+
+    for (SpinCount = 0; SpinCount < WOBJ_LOG_SLOT_SPIN_COUNT; SpinCount++) {
+
+        Current = Slot->Sequence;
+
+        if (Current >= 0) {
+
+            //
+            // Free or published slot, must not hold newer entry.
+            //
+            if (Current > Sequence)
+                return FALSE;
+
+            if (InterlockedCompareExchange64(&Slot->Sequence, Owner, Current) == Current)
+                return TRUE;
+
+            continue;
+        }
+
+        //
+        // Slot is being written, wait only for older writer.
+        //
+        if (Current <= Owner)
+            return FALSE;
+
+        YieldProcessor();
+    }
+
+    return FALSE;
 }
 
 /*
@@ -66,7 +169,12 @@ VOID logFree()
 *
 * Add entry to log.
 *
-* N.B. If entry count exceeds log capacity log will be overwritten.
+* Entry slot and message text space are reserved with interlocked
+* increments, so concurrent writers do not wait for each other unless
+* they are whole ring of entries apart. Slot is owned by its writer
+* until it is published by storing its sequence number last.
+*
+* N.B. If entry count exceeds log capacity oldest entries will be overwritten.
 *
 */
 VOID logAdd(
@@ -74,26 +182,90 @@ VOID logAdd(
     _In_ WCHAR* Message
 )
 {
-    ULONG Index;
-    EnterCriticalSection(&g_WinObjLog.Lock);
+    ULONG Length;
+    LONG64 Sequence, Position;
+    LARGE_INTEGER LoggedTime;
+    PWOBJ_LOG_SLOT Slot;
+
+    if (g_WinObjLog.Initialized == FALSE)
+        return;
 
-    if (g_WinObjLog.Initialized) {
+    Length = (ULONG)_strlen(Message);
+    if (Length > WOBJ_MAX_MESSAGE)
+        Length = WOBJ_MAX_MESSAGE;
 
-        Index = g_WinObjLog.Count;
+    GetSystemTimeAsFileTime((PFILETIME)&LoggedTime);
 
-        g_WinObjLog.Entries[Index].Type = Type;
-        GetSystemTimeAsFileTime((PFILETIME)&g_WinObjLog.Entries[Index].LoggedTime);
-        _strncpy(g_WinObjLog.Entries[Index].MessageData, WOBJ_MAX_MESSAGE, Message, WOBJ_MAX_MESSAGE);
+    Sequence = InterlockedIncrement64(&g_WinObjLog.NextSequence) - 1;
+    Position = InterlockedExchangeAdd64(&g_WinObjLog.DataHead, Length);
 
-        Index += 1;
-        if (Index >= WOBJ_MAX_LOG_CAPACITY)
-            Index = 0;
+    Slot = &g_WinObjLog.Slots[Sequence & (WOBJ_MAX_LOG_CAPACITY - 1)];
+
+    //
+    // Owned slot is invalid for readers, entry is dropped from memory
+    // log if slot cannot be owned.
+    //
+    if (logpClaimSlot(Slot, Sequence)) {
 
-        g_WinObjLog.Count = Index;
+        logpRingWrite(Position, Message, Length);
 
+        Slot->DataPosition = Position;
+        Slot->LoggedTime.QuadPart = LoggedTime.QuadPart;
+        Slot->Type = Type;
+        Slot->Length = Length;
+
+        InterlockedExchange64(&Slot->Sequence, Sequence + 1);
     }
 
-    LeaveCriticalSection(&g_WinObjLog.Lock);
+    logFileWrite(Type, &LoggedTime, Message, Length);
+}
+
+/*
+* logpReadEntry
+*
+* Purpose:
+*
+* Copy entry with given sequence number.
+*
+* Return FALSE if entry is still being written or was overwritten during copy.
+*
+*/
+BOOL logpReadEntry(
+    _In_ LONG64 Sequence,
+    _Out_ WOBJ_LOG_ENTRY* Entry
+)
+{
+    ULONG Length;
+    LONG64 Position;
+    PWOBJ_LOG_SLOT Slot;
+
+    Slot = &g_WinObjLog.Slots[Sequence & (WOBJ_MAX_LOG_CAPACITY - 1)];
+
+    if (Slot->Sequence != Sequence + 1)
+        return FALSE;
+
+    Entry->Type = Slot->Type;
+    Entry->LoggedTime.QuadPart = Slot->LoggedTime.QuadPart;
+    Position = Slot->DataPosition;
+    Length = Slot->Length;
+
+    MemoryBarrier();
+
+    if (Slot->Sequence != Sequence + 1)
+        return FALSE;
+
+    if (Length > WOBJ_MAX_MESSAGE)
+        return FALSE;
+
+    logpRingRead(Position, Entry->MessageData, Length);
+    Entry->MessageData[Length] = 0;
+
+    MemoryBarrier();
+
+    //
+    // Text is intact until writers reserve space one full ring past it.
+    //
+    return ((g_WinObjLog.DataHead - Position) <= WOBJ_LOG_DATA_CAPACITY);
 }
 
 /*
@@ -101,7 +273,10 @@ VOID logAdd(
 *
 * Purpose:
 *
-* Enumerate log entries.
+* Enumerate log entries from oldest to newest.
+*
+* Entries are copied before callback is invoked, entries being written
+* or overwritten at the time of enumeration are skipped.
 *
 */
 BOOL logEnumEntries(
@@ -109,30 +284,34 @@ BOOL logEnumEntries(
     _In_ PVOID CallbackContext
 )
 {
-    ULONG i;
-    BOOL bResult = FALSE;
+    LONG64 Sequence, First, Last;
+    WOBJ_LOG_ENTRY* Entry;
 
     if (EnumCallback == NULL)
         return FALSE;
 
-    __try {
-        EnterCriticalSection(&g_WinObjLog.Lock);
+    if (g_WinObjLog.Initialized == FALSE)
+        return FALSE;
+
+    Entry = (WOBJ_LOG_ENTRY*)supHeapAlloc(sizeof(WOBJ_LOG_ENTRY));
+    if (Entry == NULL)
+        return FALSE;
 
-        if (g_WinObjLog.Initialized) {
-            for (i = 0; i < g_WinObjLog.Count; i++) {
-                if (!EnumCallback(&g_WinObjLog.Entries[i], CallbackContext))
-                    break;
-            }
-        }
+    Last = g_WinObjLog.NextSequence;
+    First = (Last > WOBJ_MAX_LOG_CAPACITY) ? Last - WOBJ_MAX_LOG_CAPACITY : 0;
 
-        bResult = TRUE;
+    for (Sequence = First; Sequence < Last; Sequence++) {
 
+        if (!logpReadEntry(Sequence, Entry))
+            continue;
+
+        if (!EnumCallback(Entry, CallbackContext))
+            break;
     }
-    __finally {
-        LeaveCriticalSection(&g_WinObjLog.Lock);
-    }
 
-    return bResult;
+    supHeapFree(Entry);
+
+    return TRUE;
 }
 
 /*
@@ -228,11 +407,12 @@ BOOL CALLBACK LogViewerAddEntryCallback(
 *
 * Purpose:
 *
-* Ouput log entries.
+* Ouput log entries, from log file if specified.
 *
 */
 VOID LogViewerListLog(
-    _In_ HWND hwndParent
+    _In_ HWND hwndParent,
+    _In_opt_ LPCWSTR lpFileName
 )
 {
     CHARRANGE CharRange;
@@ -244,7 +424,14 @@ VOID LogViewerListLog(
     SendMessage(hwndList, EM_SETEVENTMASK, (WPARAM)0, (LPARAM)0);
     SendMessage(hwndList, WM_SETREDRAW, (WPARAM)0, (LPARAM)0);
 
-    logEnumEntries(LogViewerAddEntryCallback, (PVOID)hwndList);
+    if (lpFileName) {
+        SetWindowText(hwndList, TEXT(""));
+        if (!logFileEnumEntries(lpFileName, LogViewerAddEntryCallback, (PVOID)hwndList))
+            LogViewerPrintEntry(hwndList, TEXT("-"), TEXT("Error"), TEXT("Could not read log file"));
+    }
+    else {
+        logEnumEntries(LogViewerAddEntryCallback, (PVOID)hwndList);
+    }
 
     //
     // End work with RichEdit.
@@ -308,6 +495,35 @@ VOID LogViewerCopyToClipboard(
     }
 }
 
+/*
+* LogViewerLoadFile
+*
+* Purpose:
+*
+* Select log file and output its entries.
+*
+*/
+VOID LogViewerLoadFile(
+    _In_ HWND hwndDlg
+)
+{
+    WCHAR szFileName[MAX_PATH + 1];
+    WCHAR szCaption[MAX_PATH + 20];
+
+    RtlSecureZeroMemory(szFileName, sizeof(szFileName));
+
+    if (supOpenDialogExecute(hwndDlg,
+        szFileName,
+        TEXT("Log Files (*.bin)\0*.bin\0All Files (*.*)\0*.*\0\0")))
+    {
+        LogViewerListLog(hwndDlg, szFileName);
+
+        _strcpy(szCaption, TEXT("Log Viewer - "));
+        _strcat(szCaption, szFileName);
+        SetWindowText(hwndDlg, szCaption);
+    }
+}
+
 /*
 * LogViewerDialogProc
 *
@@ -331,7 +547,7 @@ INT_PTR CALLBACK LogViewerDialogProc(
 
     case WM_INITDIALOG:
         supCenterWindow(hwndDlg);
-        LogViewerListLog(hwndDlg);
+        LogViewerListLog(hwndDlg, NULL);
         break;
 
     case WM_DESTROY:
@@ -351,6 +567,9 @@ INT_PTR CALLBACK LogViewerDialogProc(
         case ID_OBJECT_COPY:
             LogViewerCopyToClipboard(hwndDlg);
             break;
+        case IDC_LOGLOAD:
+            LogViewerLoadFile(hwndDlg);
+            break;
 
         default:
             break;
@@ -378,6 +597,11 @@ VOID LogViewerShowDialog(
         return;
     }
 
+    //
+    // Put accumulated kernel read failures summary into log before showing it.
+    //
+    kdFlushReadErrors();
+
     if (!supRichEdit32Load()) {
         MessageBox(hwndParent, TEXT("Could not load RichEdit library"), NULL, MB_ICONERROR);
         return;
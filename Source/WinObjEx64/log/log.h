@@ -24,27 +24,53 @@
 #define WOBJ_LOG_ENTRY_WARNING 3
 
 //
-// Maximum messages in log.
+// Maximum messages in log, must be power of 2.
 //
-#define WOBJ_MAX_LOG_CAPACITY 2048
+#define WOBJ_MAX_LOG_CAPACITY 4096
+
+//
+// Size of message text ring in WCHARs, must be power of 2.
+//
+#define WOBJ_LOG_DATA_CAPACITY 0x40000
 
 //
 // Maximum length of message in log.
 //
 #define WOBJ_MAX_MESSAGE 2000
 
+//
+// Attempts to wait for slot still being written by writer one ring behind.
+//
+#define WOBJ_LOG_SLOT_SPIN_COUNT 4000
+
+//
+// Entry as passed to enumeration callback.
+//
 typedef struct _WOBJ_LOG_ENTRY {
     ULONG Type;
     LARGE_INTEGER LoggedTime;
     WCHAR MessageData[WOBJ_MAX_MESSAGE + 1];
-    BYTE Reserved[72];
 } WOBJ_LOG_ENTRY, * PWOBJ_LOG_ENTRY;
 
+//
+// Entry as stored in log, message text is kept in data ring.
+// Sequence is entry sequence number + 1, zero if slot was never used and
+// negated sequence number + 1 while slot is being written.
+//
+typedef struct _WOBJ_LOG_SLOT {
+    volatile LONG64 Sequence;
+    LONG64 DataPosition;
+    LARGE_INTEGER LoggedTime;
+    ULONG Type;
+    ULONG Length;
+} WOBJ_LOG_SLOT, * PWOBJ_LOG_SLOT;
+
 typedef struct _WOBJ_LOG {
     BOOL Initialized;
-    ULONG Count;
-    CRITICAL_SECTION Lock;
-    WOBJ_LOG_ENTRY *Entries;
+    volatile LONG64 NextSequence;
+    volatile LONG64 DataHead;
+    WOBJ_LOG_SLOT *Slots;
+    WCHAR *Data;
 } WOBJ_LOG, * PWOBJ_LOG;
 
 typedef BOOL(CALLBACK* PLOGENUMERATECALLBACK)(
@@ -0,0 +1,540 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       LOGFILE.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Persistent rolling log file.
+*
+*  Log entries are copied as binary records into memory mapped file of fixed
+*  segments, so they survive process crash without any file i/o per message.
+*  Each record carries its stream position and checksum and is committed by
+*  storing its size last, reader stops at first record that does not verify.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+#define LOGFILE_STREAM_SIZE ((ULONG64)LOGFILE_SEGMENT_SIZE * LOGFILE_SEGMENT_COUNT)
+#define LOGFILE_SIZE (LOGFILE_HEADER_SIZE + LOGFILE_SEGMENT_SIZE * LOGFILE_SEGMENT_COUNT)
+
+#define LOGFILE_ALIGN_UP(Value, Alignment) (((Value) + (Alignment) - 1) & ~((Alignment) - 1))
+
+typedef struct _LOGFILE_STATE {
+    PBYTE Base;
+    HANDLE FileHandle;          //kept open, denies write access to other instances
+    volatile LONG64 NextPosition;
+} LOGFILE_STATE, *PLOGFILE_STATE;
+
+typedef struct _LOGFILE_SEGMENT {
+    ULONG Index;
+    ULONG64 Position;
+} LOGFILE_SEGMENT, *PLOGFILE_SEGMENT;
+
+static LOGFILE_STATE g_logfile;
+
+/*
+* logpFileChecksum
+*
+* Purpose:
+*
+* Calculate checksum of record data following checksum field.
+*
+*/
+ULONG logpFileChecksum(
+    _In_ PLOGFILE_RECORD Record
+)
+{
+    ULONG Length;
+
+    Length = sizeof(LOGFILE_RECORD) - FIELD_OFFSET(LOGFILE_RECORD, Position) +
+        Record->Length * sizeof(WCHAR);
+
+    return RtlComputeCrc32(0, &Record->Position, Length);
+}
+
+/*
+* logpFileGetRecord
+*
+* Purpose:
+*
+* Return record at given segment offset if it is complete and belongs
+* to the expected stream position, NULL otherwise.
+*
+*/
+PLOGFILE_RECORD logpFileGetRecord(
+    _In_ PBYTE Segment,
+    _In_ ULONG SegmentSize,
+    _In_ ULONG Offset,
+    _In_ ULONG64 Position
+)
+{
+    ULONG Size;
+    PLOGFILE_RECORD Record;
+
+    if (SegmentSize - Offset < sizeof(LOGFILE_RECORD))
+        return NULL;
+
+    Record = (PLOGFILE_RECORD)&Segment[Offset];
+
+    Size = Record->Size;
+    if ((Size < sizeof(LOGFILE_RECORD)) ||
+        (Size > SegmentSize - Offset) ||
+        (Size & (LOGFILE_RECORD_ALIGN - 1)))
+    {
+        return NULL;
+    }
+
+    if (Record->Position != Position)
+        return NULL;
+
+    if (Record->Length > (Size - sizeof(LOGFILE_RECORD)) / sizeof(WCHAR))
+        return NULL;
+
+    if (Record->Checksum != logpFileChecksum(Record))
+        return NULL;
+
+    return Record;
+}
+
+/*
+* logpFileValidateHeader
+*
+* Purpose:
+*
+* Verify file header and that layout it describes fits into view.
+*
+*/
+BOOL logpFileValidateHeader(
+    _In_ PLOGFILE_HEADER Header,
+    _In_ ULONG64 ViewSize
+)
+{
+    if (ViewSize < sizeof(LOGFILE_HEADER))
+        return FALSE;
+
+    if ((Header->Signature != LOGFILE_SIGNATURE) ||
+        (Header->Version != LOGFILE_VERSION))
+    {
+        return FALSE;
+    }
+
+    if ((Header->HeaderSize < sizeof(LOGFILE_HEADER)) ||
+        (Header->SegmentSize < sizeof(LOGFILE_RECORD)) ||
+        (Header->SegmentSize & (LOGFILE_RECORD_ALIGN - 1)) ||
+        (Header->SegmentCount == 0))
+    {
+        return FALSE;
+    }
+
+    return ((ULONG64)Header->HeaderSize +
+        (ULONG64)Header->SegmentSize * Header->SegmentCount <= ViewSize);
+}
+
+/*
+* logpFileQuerySegments
+*
+* Purpose:
+*
+* Fill segment list with segments that begin with valid record,
+* sorted by stream position. Return number of entries.
+*
+*/
+ULONG logpFileQuerySegments(
+    _In_ PBYTE Base,
+    _Out_writes_(((PLOGFILE_HEADER)Base)->SegmentCount) PLOGFILE_SEGMENT Segments
+)
+{
+    ULONG i, j, Count = 0;
+    ULONG64 Position;
+    PBYTE Segment;
+    PLOGFILE_HEADER Header = (PLOGFILE_HEADER)Base;
+    LOGFILE_SEGMENT Entry;
+
+    for (i = 0; i < Header->SegmentCount; i++) {
+
+        Segment = Base + Header->HeaderSize + (SIZE_T)i * Header->SegmentSize;
+        Position = ((PLOGFILE_RECORD)Segment)->Position;
+
+        //
+        // Segment always starts with a record, its position identifies segment generation.
+        //
+        if ((Position % Header->SegmentSize) ||
+            ((Position / Header->SegmentSize) % Header->SegmentCount != i))
+        {
+            continue;
+        }
+
+        if (logpFileGetRecord(Segment, Header->SegmentSize, 0, Position) == NULL)
+            continue;
+
+        Entry.Index = i;
+        Entry.Position = Position;
+
+        for (j = Count; j > 0 && Segments[j - 1].Position > Position; j--)
+            Segments[j] = Segments[j - 1];
+
+        Segments[j] = Entry;
+        Count++;
+    }
+
+    return Count;
+}
+
+/*
+* logpFileQueryEnd
+*
+* Purpose:
+*
+* Return stream position following the last valid record in file.
+*
+*/
+ULONG64 logpFileQueryEnd(
+    _In_ PBYTE Base
+)
+{
+    ULONG i, Count, Offset;
+    ULONG64 EndPosition = 0;
+    PBYTE Segment;
+    PLOGFILE_HEADER Header = (PLOGFILE_HEADER)Base;
+    PLOGFILE_RECORD Record;
+    PLOGFILE_SEGMENT Segments;
+
+    Segments = (PLOGFILE_SEGMENT)supHeapAlloc(Header->SegmentCount * sizeof(LOGFILE_SEGMENT));
+    if (Segments == NULL)
+        return 0;
+
+    Count = logpFileQuerySegments(Base, Segments);
+
+    for (i = 0; i < Count; i++) {
+
+        Segment = Base + Header->HeaderSize + (SIZE_T)Segments[i].Index * Header->SegmentSize;
+
+        for (Offset = 0; ; Offset += Record->Size) {
+
+            Record = logpFileGetRecord(Segment, Header->SegmentSize, Offset, Segments[i].Position + Offset);
+            if (Record == NULL)
+                break;
+
+            EndPosition = max(EndPosition, Record->Position + Record->Size);
+        }
+    }
+
+    supHeapFree(Segments);
+
+    return EndPosition;
+}
+
+/*
+* logpFileWriteRecord
+*
+* Purpose:
+*
+* Store record at reserved stream position.
+*
+*/
+VOID logpFileWriteRecord(
+    _In_ ULONG64 Position,
+    _In_ ULONG Size,
+    _In_ ULONG Type,
+    _In_opt_ PLARGE_INTEGER LoggedTime,
+    _In_opt_ WCHAR* Message,
+    _In_ ULONG Length
+)
+{
+    PLOGFILE_RECORD Record;
+
+    Record = (PLOGFILE_RECORD)(g_logfile.Base + LOGFILE_HEADER_SIZE +
+        (SIZE_T)(Position % LOGFILE_STREAM_SIZE));
+
+    InterlockedExchange((LONG volatile*)&Record->Size, 0);
+
+    Record->Position = Position;
+    Record->LoggedTime.QuadPart = (LoggedTime) ? LoggedTime->QuadPart : 0;
+    Record->Type = Type;
+    Record->Length = Length;
+
+    if (Message)
+        RtlCopyMemory((PBYTE)Record + sizeof(LOGFILE_RECORD), Message, Length * sizeof(WCHAR));
+
+    Record->Checksum = logpFileChecksum(Record);
+
+    InterlockedExchange((LONG volatile*)&Record->Size, (LONG)Size);
+}
+
+/*
+* logFileWrite
+*
+* Purpose:
+*
+* Append entry to the log file.
+*
+* Space is reserved with compare exchange, reservation that does not fit
+* into current segment moves to the next one and pads the rest.
+*
+*/
+VOID logFileWrite(
+    _In_ ULONG Type,
+    _In_ PLARGE_INTEGER LoggedTime,
+    _In_ WCHAR* Message,
+    _In_ ULONG Length
+)
+{
+    ULONG Size, Offset;
+    LONG64 Current, Position;
+
+    if (g_logfile.Base == NULL)
+        return;
+
+    Size = LOGFILE_ALIGN_UP((ULONG)sizeof(LOGFILE_RECORD) + Length * (ULONG)sizeof(WCHAR),
+        LOGFILE_RECORD_ALIGN);
+
+    if (Size > LOGFILE_SEGMENT_SIZE)
+        return;
+
+    do {
+        Current = g_logfile.NextPosition;
+        Position = Current;
+
+        Offset = (ULONG)(Current % LOGFILE_SEGMENT_SIZE);
+        if (Offset + Size > LOGFILE_SEGMENT_SIZE)
+            Position = Current - Offset + LOGFILE_SEGMENT_SIZE;
+
+    } while (InterlockedCompareExchange64(&g_logfile.NextPosition,
+        Position + Size, Current) != Current);
+
+    //
+    // Tail shorter than record header is recognized by reader as segment end.
+    //
+    if (Position - Current >= sizeof(LOGFILE_RECORD)) {
+        logpFileWriteRecord(Current,
+            (ULONG)(Position - Current),
+            LOGFILE_RECORD_PADDING,
+            NULL,
+            NULL,
+            0);
+    }
+
+    logpFileWriteRecord(Position, Size, Type, LoggedTime, Message, Length);
+}
+
+/*
+* logpFileOpen
+*
+* Purpose:
+*
+* Open log file for writing, other processes are allowed to read only.
+*
+*/
+HANDLE logpFileOpen(
+    _In_ LPCWSTR lpFileName
+)
+{
+    return CreateFile(lpFileName,
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+}
+
+/*
+* logFileCreate
+*
+* Purpose:
+*
+* Map log file if requested by environment variable.
+*
+* Existing file of the same layout is continued from the next segment
+* after its last record. File handle stays open for process lifetime so
+* that second instance cannot map it for write, such instance logs into
+* file name suffixed with its process id instead.
+*
+*/
+VOID logFileCreate(
+    VOID
+)
+{
+    DWORD cch;
+    HANDLE hFile, hMapping;
+    PBYTE Base;
+    PLOGFILE_HEADER Header;
+    WCHAR szFileName[MAX_PATH * 2];
+
+    RtlSecureZeroMemory(szFileName, sizeof(szFileName));
+    cch = GetEnvironmentVariable(LOGFILE_ENVIRONMENT_VARIABLE, szFileName, MAX_PATH);
+    if ((cch == 0) || (cch >= MAX_PATH))
+        return;
+
+    if (_strcmp(szFileName, TEXT("1")) == 0) {
+        _strcpy(szFileName, g_WinObj.szTempDirectory);
+        _strcat(szFileName, LOGFILE_DEFAULT_FILE_NAME);
+    }
+
+    hFile = logpFileOpen(szFileName);
+    if (hFile == INVALID_HANDLE_VALUE && GetLastError() == ERROR_SHARING_VIOLATION) {
+        _strcat(szFileName, TEXT("."));
+        ultostr(GetCurrentProcessId(), _strend(szFileName));
+        hFile = logpFileOpen(szFileName);
+    }
+
+    if (hFile == INVALID_HANDLE_VALUE)
+        return;
+
+    hMapping = CreateFileMapping(hFile, NULL, PAGE_READWRITE, 0, LOGFILE_SIZE, NULL);
+    if (hMapping == NULL) {
+        CloseHandle(hFile);
+        return;
+    }
+
+    Base = (PBYTE)MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, LOGFILE_SIZE);
+    CloseHandle(hMapping);
+    if (Base == NULL) {
+        CloseHandle(hFile);
+        return;
+    }
+
+    Header = (PLOGFILE_HEADER)Base;
+
+    if (logpFileValidateHeader(Header, LOGFILE_SIZE) &&
+        Header->HeaderSize == LOGFILE_HEADER_SIZE &&
+        Header->SegmentSize == LOGFILE_SEGMENT_SIZE &&
+        Header->SegmentCount == LOGFILE_SEGMENT_COUNT)
+    {
+        g_logfile.NextPosition = LOGFILE_ALIGN_UP(logpFileQueryEnd(Base),
+            (ULONG64)LOGFILE_SEGMENT_SIZE);
+    }
+    else {
+        RtlSecureZeroMemory(Base, LOGFILE_SIZE);
+        Header->Signature = LOGFILE_SIGNATURE;
+        Header->Version = LOGFILE_VERSION;
+        Header->HeaderSize = LOGFILE_HEADER_SIZE;
+        Header->SegmentSize = LOGFILE_SEGMENT_SIZE;
+        Header->SegmentCount = LOGFILE_SEGMENT_COUNT;
+        FlushViewOfFile(Base, LOGFILE_HEADER_SIZE);
+        g_logfile.NextPosition = 0;
+    }
+
+    g_logfile.FileHandle = hFile;
+    g_logfile.Base = Base;
+}
+
+/*
+* logFileEnumEntries
+*
+* Purpose:
+*
+* Enumerate entries stored in log file from oldest to newest.
+*
+* File may be in use by another instance, records that are being
+* written at the moment are skipped.
+*
+*/
+BOOL logFileEnumEntries(
+    _In_ LPCWSTR lpFileName,
+    _In_ PLOGENUMERATECALLBACK EnumCallback,
+    _In_ PVOID CallbackContext
+)
+{
+    BOOL bResult = FALSE;
+    ULONG i, Count, Offset, Length;
+    HANDLE hFile, hMapping;
+    PBYTE Base = NULL, Segment;
+    LARGE_INTEGER FileSize;
+    PLOGFILE_HEADER Header;
+    PLOGFILE_RECORD Record;
+    PLOGFILE_SEGMENT Segments = NULL;
+    WOBJ_LOG_ENTRY* Entry = NULL;
+
+    if (EnumCallback == NULL)
+        return FALSE;
+
+    hFile = CreateFile(lpFileName,
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (!GetFileSizeEx(hFile, &FileSize) || FileSize.QuadPart == 0) {
+        CloseHandle(hFile);
+        return FALSE;
+    }
+
+    hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if (hMapping == NULL)
+        return FALSE;
+
+    Base = (PBYTE)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (Base == NULL)
+        return FALSE;
+
+    __try {
+
+        Header = (PLOGFILE_HEADER)Base;
+        if (!logpFileValidateHeader(Header, (ULONG64)FileSize.QuadPart))
+            __leave;
+
+        Segments = (PLOGFILE_SEGMENT)supHeapAlloc(Header->SegmentCount * sizeof(LOGFILE_SEGMENT));
+        if (Segments == NULL)
+            __leave;
+
+        Entry = (WOBJ_LOG_ENTRY*)supHeapAlloc(sizeof(WOBJ_LOG_ENTRY));
+        if (Entry == NULL)
+            __leave;
+
+        bResult = TRUE;
+
+        Count = logpFileQuerySegments(Base, Segments);
+
+        for (i = 0; i < Count; i++) {
+
+            Segment = Base + Header->HeaderSize + (SIZE_T)Segments[i].Index * Header->SegmentSize;
+
+            for (Offset = 0; ; Offset += Record->Size) {
+
+                Record = logpFileGetRecord(Segment, Header->SegmentSize, Offset, Segments[i].Position + Offset);
+                if (Record == NULL)
+                    break;
+
+                if (Record->Type == LOGFILE_RECORD_PADDING)
+                    continue;
+
+                Length = min(Record->Length, WOBJ_MAX_MESSAGE);
+
+                Entry->Type = Record->Type;
+                Entry->LoggedTime.QuadPart = Record->LoggedTime.QuadPart;
+                RtlCopyMemory(Entry->MessageData, (PBYTE)Record + sizeof(LOGFILE_RECORD), Length * sizeof(WCHAR));
+                Entry->MessageData[Length] = 0;
+
+                if (!EnumCallback(Entry, CallbackContext))
+                    __leave;
+            }
+        }
+
+    }
+    __except (EXCEPTION_EXECUTE_HANDLER) {
+        bResult = FALSE;
+    }
+
+    if (Entry) supHeapFree(Entry);
+    if (Segments) supHeapFree(Segments);
+    UnmapViewOfFile(Base);
+
+    return bResult;
+}
@@ -0,0 +1,77 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       LOGFILE.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the persistent rolling log file.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Log file is enabled when variable is set, value is file name
+// or "1" for default file in temp directory.
+//
+#define LOGFILE_ENVIRONMENT_VARIABLE    L"WINOBJEX64_LOGFILE"
+#define LOGFILE_DEFAULT_FILE_NAME       L"\\winobjex64_log.bin"
+
+#define LOGFILE_SIGNATURE               'GLOW'
+#define LOGFILE_VERSION                 1
+
+//
+// File layout: header followed by fixed segments, segments are reused
+// in round robin order. Record never crosses segment boundary.
+//
+#define LOGFILE_HEADER_SIZE             0x1000
+#define LOGFILE_SEGMENT_SIZE            0x40000
+#define LOGFILE_SEGMENT_COUNT           16
+#define LOGFILE_RECORD_ALIGN            8
+
+#define LOGFILE_RECORD_PADDING          0xFFFFFFFF
+
+typedef struct _LOGFILE_HEADER {
+    ULONG Signature;
+    ULONG Version;
+    ULONG HeaderSize;
+    ULONG SegmentSize;
+    ULONG SegmentCount;
+    ULONG Reserved;
+} LOGFILE_HEADER, *PLOGFILE_HEADER;
+
+//
+// Record is valid when Size is non zero, Position matches record location
+// and Checksum matches. Size is stored last.
+//
+typedef struct _LOGFILE_RECORD {
+    ULONG Size;                 //whole record size, aligned
+    ULONG Checksum;             //CRC32 of record data following this field
+    ULONG64 Position;           //logical position in log stream
+    LARGE_INTEGER LoggedTime;
+    ULONG Type;                 //WOBJ_LOG_ENTRY_* or LOGFILE_RECORD_PADDING
+    ULONG Length;               //message length in WCHARs
+    //WCHAR Message[Length]
+} LOGFILE_RECORD, *PLOGFILE_RECORD;
+
+VOID logFileCreate(
+    VOID);
+
+VOID logFileWrite(
+    _In_ ULONG Type,
+    _In_ PLARGE_INTEGER LoggedTime,
+    _In_ WCHAR* Message,
+    _In_ ULONG Length);
+
+BOOL logFileEnumEntries(
+    _In_ LPCWSTR lpFileName,
+    _In_ PLOGENUMERATECALLBACK EnumCallback,
+    _In_ PVOID CallbackContext);
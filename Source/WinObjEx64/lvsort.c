@@ -0,0 +1,358 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       LVSORT.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Key cached listview sort.
+*
+*  Column text is read and converted to typed key once per item, keys are
+*  sorted in memory and listview is reordered by precomputed item rank.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+//
+// Number of folded characters packed into key value.
+//
+#define LVSORT_PREFIX_LENGTH    4
+
+//
+// Runs of this size are sorted by insertion before merging.
+//
+#define LVSORT_RUN_LENGTH       16
+
+/*
+* lvGetItemText
+*
+* Purpose:
+*
+* Read item text into arena buffer, buffer is grown until text fits.
+*
+*/
+LPWSTR lvGetItemText(
+    _In_ HWND ListView,
+    _In_ INT Item,
+    _In_ INT Column,
+    _In_ PARENA Arena,
+    _Inout_ LPWSTR* Buffer,
+    _Inout_ PUINT BufferLength
+)
+{
+    UINT cchText;
+    LPWSTR lpBuffer;
+    LV_ITEM item;
+
+    for (;;) {
+
+        RtlSecureZeroMemory(&item, sizeof(item));
+        item.iItem = Item;
+        item.iSubItem = Column;
+        item.pszText = *Buffer;
+        item.cchTextMax = (INT)*BufferLength;
+        (*Buffer)[0] = 0;
+
+        cchText = (UINT)SendMessage(ListView, LVM_GETITEMTEXT, (WPARAM)Item, (LPARAM)&item);
+        if (cchText + 1 < *BufferLength)
+            break;
+
+        //
+        // Text may be truncated, previous buffer stays in arena until caller resets it.
+        //
+        lpBuffer = (LPWSTR)arenaAllocNoZero(Arena, (SIZE_T)*BufferLength * 2 * sizeof(WCHAR));
+        if (lpBuffer == NULL)
+            break;
+
+        *Buffer = lpBuffer;
+        *BufferLength *= 2;
+    }
+
+    return item.pszText;
+}
+
+/*
+* lvpSetTextKey
+*
+* Purpose:
+*
+* Store folded copy of text and pack its first characters to key value.
+*
+*/
+BOOL lvpSetTextKey(
+    _In_ PARENA Arena,
+    _In_ PLVSORT_KEY Key,
+    _In_ LPCWSTR Text
+)
+{
+    SIZE_T i, Length;
+    LPWSTR lpText;
+
+    Length = _strlen(Text);
+
+    lpText = (LPWSTR)arenaAllocNoZero(Arena, (Length + 1) * sizeof(WCHAR));
+    if (lpText == NULL)
+        return FALSE;
+
+    for (i = 0; i < Length; i++)
+        lpText[i] = locase_w(Text[i]);
+
+    lpText[Length] = 0;
+
+    Key->Value = 0;
+    for (i = 0; i < LVSORT_PREFIX_LENGTH; i++) {
+        Key->Value <<= 16;
+        if (i < Length)
+            Key->Value |= lpText[i];
+    }
+
+    Key->Text = lpText;
+    return TRUE;
+}
+
+/*
+* lvpSetKey
+*
+* Purpose:
+*
+* Convert item text to sort key of given type.
+*
+*/
+BOOL lvpSetKey(
+    _In_ PARENA Arena,
+    _In_ PLVSORT_KEY Key,
+    _In_ LVSORT_KEY_TYPE KeyType,
+    _In_ LPCWSTR Text
+)
+{
+    Key->Text = NULL;
+
+    switch (KeyType) {
+
+    case LvSortKeyULong:
+        Key->Value = strtou64(Text);
+        break;
+
+    case LvSortKeyLong:
+        //
+        // Flip sign bit so signed values compare as unsigned.
+        //
+        Key->Value = (ULONG64)strtoi64(Text) ^ 0x8000000000000000ULL;
+        break;
+
+    case LvSortKeyHex:
+        if ((Text[0] == L'0') && ((Text[1] == L'x') || (Text[1] == L'X')))
+            Text += 2;
+        Key->Value = hextou64(Text);
+        break;
+
+    default:
+        return lvpSetTextKey(Arena, Key, Text);
+    }
+
+    return TRUE;
+}
+
+/*
+* lvpCompareKeys
+*
+* Purpose:
+*
+* Compare two keys, text is compared only when packed prefixes are equal.
+*
+*/
+__forceinline INT lvpCompareKeys(
+    _In_ PLVSORT_KEY Key1,
+    _In_ PLVSORT_KEY Key2
+)
+{
+    if (Key1->Value != Key2->Value)
+        return (Key1->Value < Key2->Value) ? -1 : 1;
+
+    //
+    // Equal prefixes ending with zero mean equal strings.
+    //
+    if ((Key1->Text == NULL) || ((Key1->Value & 0xFFFF) == 0))
+        return 0;
+
+    return _strcmp(Key1->Text + LVSORT_PREFIX_LENGTH, Key2->Text + LVSORT_PREFIX_LENGTH);
+}
+
+/*
+* lvpSortKeys
+*
+* Purpose:
+*
+* Stable sort, insertion sorted runs followed by bottom-up merge passes.
+*
+*/
+VOID lvpSortKeys(
+    _In_ PLVSORT_KEY Keys,
+    _In_ PLVSORT_KEY Temp,
+    _In_ INT Count,
+    _In_ BOOL Inverse
+)
+{
+    INT i, j, Run, Width, Left, Middle, Right, Sign;
+    PLVSORT_KEY Source = Keys, Dest = Temp, Swap;
+    LVSORT_KEY Key;
+
+    Sign = (Inverse) ? -1 : 1;
+
+    for (Run = 0; Run < Count; Run += LVSORT_RUN_LENGTH) {
+
+        Right = min(Run + LVSORT_RUN_LENGTH, Count);
+
+        for (i = Run + 1; i < Right; i++) {
+            Key = Keys[i];
+            for (j = i; (j > Run) && (Sign * lvpCompareKeys(&Keys[j - 1], &Key) > 0); j--)
+                Keys[j] = Keys[j - 1];
+            Keys[j] = Key;
+        }
+    }
+
+    for (Width = LVSORT_RUN_LENGTH; Width < Count; Width *= 2) {
+
+        for (Left = 0; Left < Count; Left += 2 * Width) {
+
+            Middle = min(Left + Width, Count);
+            Right = min(Left + 2 * Width, Count);
+
+            i = Left;
+            j = Middle;
+            Run = Left;
+
+            while ((i < Middle) && (j < Right)) {
+                if (Sign * lvpCompareKeys(&Source[i], &Source[j]) <= 0)
+                    Dest[Run++] = Source[i++];
+                else
+                    Dest[Run++] = Source[j++];
+            }
+
+            while (i < Middle)
+                Dest[Run++] = Source[i++];
+
+            while (j < Right)
+                Dest[Run++] = Source[j++];
+        }
+
+        Swap = Source;
+        Source = Dest;
+        Dest = Swap;
+    }
+
+    if (Source != Keys)
+        RtlCopyMemory(Keys, Source, Count * sizeof(LVSORT_KEY));
+}
+
+/*
+* lvpCompareRanks
+*
+* Purpose:
+*
+* Listview comparer, items are ordered by rank computed from sorted keys.
+*
+* ListView_SortItemsEx passes item indices from before the sort.
+*
+*/
+INT CALLBACK lvpCompareRanks(
+    _In_ LPARAM lParam1,
+    _In_ LPARAM lParam2,
+    _In_ LPARAM lParamSort
+)
+{
+    PULONG Ranks = (PULONG)lParamSort;
+
+    return (INT)Ranks[lParam1] - (INT)Ranks[lParam2];
+}
+
+/*
+* lvSortItems
+*
+* Purpose:
+*
+* Sort listview by column using cached typed keys.
+*
+* Item text is fetched once per item, memory is taken from the thread arena
+* and released before return.
+*
+*/
+BOOL lvSortItems(
+    _In_ HWND ListView,
+    _In_ INT Column,
+    _In_ LVSORT_KEY_TYPE KeyType,
+    _In_ BOOL Inverse
+)
+{
+    BOOL bResult = FALSE;
+    INT i, Count;
+    UINT cchBuffer;
+    PULONG Ranks;
+    LPWSTR lpBuffer, lpText;
+    PLVSORT_KEY Keys, Temp;
+    PARENA Arena;
+    ARENA_MARK Mark;
+    TRACE_SPAN Span;
+
+    if (KeyType >= LvSortKeyMax)
+        return FALSE;
+
+    Count = ListView_GetItemCount(ListView);
+    if (Count < 2)
+        return TRUE;
+
+    Arena = arenaGetThreadArena();
+    if (Arena == NULL)
+        return FALSE;
+
+    TRACE_BEGIN(Span, "ListViewSort");
+
+    arenaMark(Arena, &Mark);
+
+    do {
+
+        Keys = (PLVSORT_KEY)arenaAllocNoZero(Arena, Count * sizeof(LVSORT_KEY));
+        Temp = (PLVSORT_KEY)arenaAllocNoZero(Arena, Count * sizeof(LVSORT_KEY));
+        Ranks = (PULONG)arenaAllocNoZero(Arena, Count * sizeof(ULONG));
+
+        cchBuffer = LVSORT_TEXT_LENGTH;
+        lpBuffer = (LPWSTR)arenaAllocNoZero(Arena, cchBuffer * sizeof(WCHAR));
+
+        if (Keys == NULL || Temp == NULL || Ranks == NULL || lpBuffer == NULL)
+            break;
+
+        for (i = 0; i < Count; i++) {
+
+            lpText = lvGetItemText(ListView, i, Column, Arena, &lpBuffer, &cchBuffer);
+
+            Keys[i].Item = i;
+            if (!lvpSetKey(Arena, &Keys[i], KeyType, lpText))
+                break;
+        }
+
+        if (i < Count)
+            break;
+
+        lvpSortKeys(Keys, Temp, Count, Inverse);
+
+        for (i = 0; i < Count; i++)
+            Ranks[Keys[i].Item] = (ULONG)i;
+
+        bResult = ListView_SortItemsEx(ListView, &lvpCompareRanks, (LPARAM)Ranks);
+
+    } while (FALSE);
+
+    arenaResetToMark(Arena, &Mark);
+
+    TRACE_END(Span);
+
+    return bResult;
+}
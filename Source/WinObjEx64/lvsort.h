@@ -0,0 +1,55 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       LVSORT.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the key cached listview sort.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// How column text is converted to sort key, keep in sync with plugin_def.h.
+//
+typedef enum _LVSORT_KEY_TYPE {
+    LvSortKeyText = 0,  //case insensitive text
+    LvSortKeyULong,     //unsigned decimal
+    LvSortKeyLong,      //signed decimal
+    LvSortKeyHex,       //hex with 0x prefix
+    LvSortKeyMax
+} LVSORT_KEY_TYPE;
+
+//
+// Initial text buffer size in WCHARs, grown for longer items.
+//
+#define LVSORT_TEXT_LENGTH  MAX_PATH
+
+typedef struct _LVSORT_KEY {
+    ULONG64 Value;      //number or first folded characters of text
+    LPWSTR Text;        //folded text, NULL for numeric keys
+    INT Item;           //item index before sort
+} LVSORT_KEY, *PLVSORT_KEY;
+
+LPWSTR lvGetItemText(
+    _In_ HWND ListView,
+    _In_ INT Item,
+    _In_ INT Column,
+    _In_ PARENA Arena,
+    _Inout_ LPWSTR* Buffer,
+    _Inout_ PUINT BufferLength);
+
+BOOL lvSortItems(
+    _In_ HWND ListView,
+    _In_ INT Column,
+    _In_ LVSORT_KEY_TYPE KeyType,
+    _In_ BOOL Inverse);
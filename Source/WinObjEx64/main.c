@@ -103,27 +103,6 @@ VOID MainWindowExtrasDisableAdminFeatures(
     }
 }
 
-/*
-* MainWindowObjectListCompareFunc
-*
-* Purpose:
-*
-* Main window listview comparer function.
-*
-*/
-INT CALLBACK MainWindowObjectListCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort
-)
-{
-    return supListViewBaseComparer(g_hwndObjectList,
-        bMainWndSortInverse,
-        lParam1,
-        lParam2,
-        lParamSort);
-}
-
 /*
 * MainWindowHandleObjectTreeProp
 *
@@ -246,7 +225,9 @@ VOID MainWindowOnRefresh(
 
     supSetWaitCursor(TRUE);
 
-    ObCollectionDestroy(&g_kdctx.ObCollection);
+    ObCollectionRefresh(&g_kdctx.ObCollection, FALSE);
+
+    kdFlushReadErrors();
 
     supFreeSCMSnapshot(NULL);
     sapiFreeSnapshot();
@@ -348,6 +329,10 @@ LRESULT MainWindowHandleWMCommand(
         MainWindowOnRefresh();
         break;
 
+    case ID_VIEW_EXPORT:
+        exportViewToFile(hwnd, g_hwndObjectList, ExportViewListView, TEXT("Objects"));
+        break;
+
     case ID_EXTRAS_PIPES:
     case ID_EXTRAS_MAILSLOTS:
     case ID_EXTRAS_USERSHAREDDATA:
@@ -358,6 +343,7 @@ LRESULT MainWindowHandleWMCommand(
     case ID_EXTRAS_PROCESSLIST:
     case ID_EXTRAS_CALLBACKS:
     case ID_EXTRAS_SOFTWARELICENSECACHE:
+    case ID_EXTRAS_READSTATS:
         //
         // Extras -> Pipes
         //           Mailslots
@@ -369,6 +355,7 @@ LRESULT MainWindowHandleWMCommand(
         //           Process List
         //           Callbacks
         //           Software Licensing Cache
+        //           Kernel Read Statistics
         //
         extrasShowDialogById(hwnd, ControlId);
         break;
@@ -562,6 +549,9 @@ VOID MainWindowHandleObjectPopupMenu(
     }
     EnableMenuItem(GetSubMenu(GetMenu(hwnd), IDMM_OBJECT), ID_OBJECT_GOTOLINKTARGET, uEnable);
 
+    InsertMenu(hMenu, (UINT)-1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
+    InsertMenu(hMenu, (UINT)-1, MF_BYPOSITION, ID_VIEW_EXPORT, T_EXPORTLIST);
+
     TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_LEFTALIGN, point->x, point->y, 0, hwnd, NULL);
     DestroyMenu(hMenu);
 }
@@ -604,7 +594,7 @@ LRESULT MainWindowHandleWMNotify(
 
                 ListObjectsInDirectory(g_WinObj.CurrentObjectPath);
 
-                ListView_SortItemsEx(g_hwndObjectList, &MainWindowObjectListCompareFunc, SortColumn);
+                lvSortItems(g_hwndObjectList, SortColumn, LvSortKeyText, bMainWndSortInverse);
 
                 supSetGotoLinkTargetToolButtonState(hwnd, 0, 0, TRUE, FALSE);
 
@@ -673,7 +663,7 @@ LRESULT MainWindowHandleWMNotify(
             case LVN_COLUMNCLICK:
                 bMainWndSortInverse = !bMainWndSortInverse;
                 SortColumn = ((NMLISTVIEW*)lParam)->iSubItem;
-                ListView_SortItemsEx(g_hwndObjectList, &MainWindowObjectListCompareFunc, SortColumn);
+                lvSortItems(g_hwndObjectList, SortColumn, LvSortKeyText, bMainWndSortInverse);
 
                 nImageIndex = ImageList_GetImageCount(g_ListViewImages);
                 if (bMainWndSortInverse)
@@ -1045,9 +1035,15 @@ UINT WinObjExMain()
     WNDCLASSEX              wndClass;
     HIMAGELIST              TreeViewImages;
 
+    TRACE_SPAN              StartupSpan, Span;
+
     WCHAR                   szWindowTitle[100];
 
     logCreate();
+    traceCreate();
+
+    TRACE_BEGIN(StartupSpan, "Startup");
+
     IsWine = supIsWine();
 
     if (!supInitMSVCRT()) {
@@ -1062,6 +1058,8 @@ UINT WinObjExMain()
         RtlSetHeapInformation(NULL, HeapEnableTerminationOnCorruption, NULL, 0);
     }
 
+    TRACE_BEGIN(Span, "WinObjInitGlobals");
+
     switch (WinObjInitGlobals(IsWine)) {
 
     case wobjInitNoHeap:
@@ -1088,6 +1086,10 @@ UINT WinObjExMain()
         break;
     }
 
+    TRACE_END(Span);
+
+    logFileCreate();
+
     //
     // !Do not move anywhere!
     //
@@ -1100,7 +1102,9 @@ UINT WinObjExMain()
         bIsFullAdmin = FALSE;
     }
 
+    TRACE_BEGIN(Span, "supInit");
     supInit(bIsFullAdmin);
+    TRACE_END(Span);
 
 #ifdef _DEBUG
     TestStart();
@@ -1110,6 +1114,8 @@ UINT WinObjExMain()
         //
         // Create main window and it components.
         //
+        TRACE_BEGIN(Span, "CreateMainWindow");
+
         wndClass.cbSize = sizeof(WNDCLASSEX);
         wndClass.style = 0;
         wndClass.lpfnWndProc = &MainWindowProc;
@@ -1291,6 +1297,8 @@ UINT WinObjExMain()
         //
         g_TreeListAtom = InitializeTreeListControl();
 
+        TRACE_END(Span);
+
         //
         // Initialization of views.
         //
@@ -1378,6 +1386,7 @@ UINT WinObjExMain()
         //
         // Load listview images for object types.
         //
+        TRACE_BEGIN(Span, "ObManagerLoadImageList");
         g_ListViewImages = ObManagerLoadImageList();
         if (g_ListViewImages) {
             //
@@ -1395,6 +1404,7 @@ UINT WinObjExMain()
             }
             ListView_SetImageList(g_hwndObjectList, g_ListViewImages, LVSIL_SMALL);
         }
+        TRACE_END(Span);
 
         //
         // Load toolbar images.
@@ -1481,7 +1491,9 @@ UINT WinObjExMain()
 
         hAccTable = LoadAccelerators(g_WinObj.hInstance, MAKEINTRESOURCE(IDR_ACCELERATOR1));
 
+        TRACE_BEGIN(Span, "PluginManagerCreate");
         PluginManagerCreate(MainWindow);
+        TRACE_END(Span);
 
         //
         // Create ObjectList columns.
@@ -1502,11 +1514,15 @@ UINT WinObjExMain()
             LVCFMT_LEFT | LVCFMT_BITMAP_ON_RIGHT,
             TEXT("Additional Information"), 170);
 
+        TRACE_BEGIN(Span, "ListObjectDirectoryTree");
         ListObjectDirectoryTree(L"\\", NULL, NULL);
+        TRACE_END(Span);
 
         TreeView_SelectItem(g_hwndObjectTree, TreeView_GetRoot(g_hwndObjectTree));
         SetFocus(g_hwndObjectTree);
 
+        TRACE_END(StartupSpan);
+
         do {
             bRet = GetMessage(&msg, NULL, 0, 0);
 
@@ -1539,6 +1555,7 @@ UINT WinObjExMain()
     //do not move anywhere
 
     supShutdown();
+    traceFree();
     logFree();
 
 #ifdef _DEBUG
@@ -1561,6 +1578,10 @@ UINT WinObjExMain()
 void main()
 {
     __security_init_cookie();
+
+    if (headlessIsRequested())
+        ExitProcess(headlessMain());
+
     ExitProcess(WinObjExMain());
 }
 #else
@@ -1577,6 +1598,9 @@ int CALLBACK WinMain(
     UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nCmdShow);
 
+    if (headlessIsRequested())
+        ExitProcess(headlessMain());
+
     ExitProcess(WinObjExMain());
 }
 #endif
@@ -182,6 +182,8 @@ DWORD WINAPI PluginManagerWorkerThread(
     pfnPluginInit PluginInit;
     HMODULE hPlugin;
 
+    TRACE_SPAN Span;
+
     InitializeListHead(&g_PluginsListHead);
 
     //
@@ -226,6 +228,8 @@ DWORD WINAPI PluginManagerWorkerThread(
             //
             // Load library and query plugin export.
             //
+            TRACE_BEGIN(Span, "PluginLoad");
+
             hPlugin = LoadLibraryEx(szPluginPath, NULL, 0);
             if (hPlugin) {
                 PluginInit = (pfnPluginInit)GetProcAddress(hPlugin, WINOBJEX_PLUGIN_EXPORT);
@@ -314,6 +318,9 @@ DWORD WINAPI PluginManagerWorkerThread(
                     FreeLibrary(hPlugin);
                 }
             }
+
+            TRACE_END_DETAIL(Span, fdata.cFileName);
+
         } while (FindNextFile(hFile, &fdata));
         FindClose(hFile);
     }
@@ -425,6 +432,8 @@ VOID PluginManagerProcessEntry(
 
     WINOBJEX_PARAM_BLOCK ParamBlock;
 
+    TRACE_SPAN Span;
+
     WCHAR szMessage[200];
 
     __try {
@@ -482,6 +491,7 @@ VOID PluginManagerProcessEntry(
             }
 
             RtlSecureZeroMemory(&ParamBlock, sizeof(ParamBlock));
+            ParamBlock.cbSize = sizeof(ParamBlock);
             ParamBlock.ParentWindow = ParentWindow;
             ParamBlock.hInstance = g_WinObj.hInstance;
             ParamBlock.SystemRangeStart = g_kdctx.SystemRangeStart;
@@ -492,12 +502,13 @@ VOID PluginManagerProcessEntry(
             // System
             //
             ParamBlock.GetSystemInfoEx = (pfnGetSystemInfoEx)&supGetSystemInfoEx;
-            ParamBlock.ReadSystemMemoryEx = (pfnReadSystemMemoryEx)&kdReadSystemMemoryEx;
+            ParamBlock.ReadSystemMemoryEx = (pfnReadSystemMemoryEx)&kdPluginReadSystemMemoryEx;
             ParamBlock.GetInstructionLength = (pfnGetInstructionLength)&kdGetInstructionLength;
             ParamBlock.FindModuleEntryByName = (pfnFindModuleEntryByName)&supFindModuleEntryByName;
             ParamBlock.FindModuleEntryByAddress = (pfnFindModuleEntryByAddress)&supFindModuleEntryByAddress;
             ParamBlock.FindModuleNameByAddress = (pfnFindModuleNameByAddress)&supFindModuleNameByAddress;
             ParamBlock.GetWin32FileName = (pfnGetWin32FileName)&supGetWin32FileName;
+            ParamBlock.WalkList = (pfnWalkList)&kdWalkList;
 
             //
             // UI related functions.
@@ -508,10 +519,14 @@ VOID PluginManagerProcessEntry(
             ParamBlock.uiCopyListViewSubItemValue = (pfnuiCopyListViewSubItemValue)&supCopyListViewSubItemValue;
             ParamBlock.uiShowFileProperties = (pfnuiShowFileProperties)&supShowProperties;
             ParamBlock.uiGetDPIValue = (pfnuiGetDPIValue)&supGetDPIValue;
+            ParamBlock.uiListViewSort = (pfnuiListViewSort)&lvSortItems;
+            ParamBlock.uiExportView = (pfnuiExportView)&exportViewToFile;
 
             RtlCopyMemory(&ParamBlock.osver, &g_WinObj.osver, sizeof(RTL_OSVERSIONINFOW));
 
+            TRACE_BEGIN(Span, "PluginStart");
             Status = PluginEntry->Plugin.StartPlugin(&ParamBlock);
+            TRACE_END_DETAIL(Span, PluginEntry->Plugin.Description);
 
             if (!NT_SUCCESS(Status)) {
                 _strcpy(szMessage, TEXT("Could not start plugin, error code 0x"));
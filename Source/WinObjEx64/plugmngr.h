@@ -97,6 +97,22 @@ typedef VOID(*pfnuiShowFileProperties)(
 typedef UINT(*pfnuiGetDPIValue)(
     _In_opt_ HWND hWnd);
 
+typedef ULONG(CALLBACK *pfnWalkList)(
+    _In_ PKDWALK_PARAMS Params,
+    _Out_opt_ KDWALK_STATUS *Status);
+
+typedef BOOL(*pfnuiListViewSort)(
+    _In_ HWND ListView,
+    _In_ INT Column,
+    _In_ LVSORT_KEY_TYPE KeyType,
+    _In_ BOOL Inverse);
+
+typedef BOOL(*pfnuiExportView)(
+    _In_ HWND OwnerWindow,
+    _In_ HWND ViewWindow,
+    _In_ EXPORT_VIEW_TYPE ViewType,
+    _In_opt_ LPCWSTR lpDefaultName);
+
 typedef struct _WINOBJEX_PARAM_BLOCK {
     HWND ParentWindow;
     HINSTANCE hInstance;
@@ -120,6 +136,13 @@ typedef struct _WINOBJEX_PARAM_BLOCK {
     pfnuiShowFileProperties uiShowFileProperties;
     pfnuiGetDPIValue uiGetDPIValue;
 
+    //sys, appended to keep layout for older plugins
+    pfnWalkList WalkList;
+
+    //ui, appended to keep layout for older plugins
+    pfnuiListViewSort uiListViewSort;
+    pfnuiExportView uiExportView;
+
 } WINOBJEX_PARAM_BLOCK, *PWINOBJEX_PARAM_BLOCK;
 
 typedef NTSTATUS(CALLBACK *pfnStartPlugin)(
@@ -2679,8 +2679,8 @@ VOID propBasicQueryDesktop(
 {
     BOOL        bExtendedInfoAvailable;
     HANDLE      hDesktop;
-    ULONG_PTR   ObjectAddress = 0, HeaderAddress = 0, InfoHeaderAddress = 0;
-    OBJINFO     InfoObject;
+    ULONG_PTR   ObjectAddress = 0, HeaderAddress = 0;
+    POBJINFO    InfoObject;
 
     VALIDATE_PROP_CONTEXT(Context);
 
@@ -2704,23 +2704,14 @@ VOID propBasicQueryDesktop(
 
         //
         // If we can use driver, query extended information.
+        // Object header and quota info are read at once.
         //
         if (HeaderAddress && kdConnectDriver()) {
-            RtlSecureZeroMemory(&InfoObject, sizeof(InfoObject));
-            InfoObject.HeaderAddress = HeaderAddress;
-            InfoObject.ObjectAddress = ObjectAddress;
-            //dump object header
-            bExtendedInfoAvailable = kdReadSystemMemory(HeaderAddress,
-                &InfoObject.ObjectHeader, sizeof(OBJECT_HEADER));
-            if (bExtendedInfoAvailable) {
-                //dump quota info
-                if (ObHeaderToNameInfoAddress(InfoObject.ObjectHeader.InfoMask,
-                    HeaderAddress, &InfoHeaderAddress, HeaderQuotaInfoFlag))
-                {
-                    kdReadSystemMemory(InfoHeaderAddress,
-                        &InfoObject.ObjectQuotaHeader, sizeof(OBJECT_HEADER_QUOTA_INFO));
-                }
-                propSetBasicInfoEx(hwndDlg, &InfoObject);
+            InfoObject = ObQueryObjectByAddress(ObjectAddress);
+            if (InfoObject) {
+                bExtendedInfoAvailable = TRUE;
+                propSetBasicInfoEx(hwndDlg, InfoObject);
+                supHeapFree(InfoObject);
             }
         }
         //cannot query extended info, output what we have
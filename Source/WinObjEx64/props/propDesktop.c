@@ -262,33 +262,6 @@ VOID DesktopListCreate(
     pDlgContext->lvColumnCount = DESKTOPLIST_COLUMN_COUNT;
 }
 
-/*
-* DesktopListCompareFunc
-*
-* Purpose:
-*
-* Desktop page listview comparer function.
-*
-*/
-INT CALLBACK DesktopListCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lpContextParam
-)
-{
-    EXTRASCONTEXT* pDlgContext;
-
-    pDlgContext = (EXTRASCONTEXT*)lpContextParam;
-    if (pDlgContext == NULL)
-        return 0;
-
-    return supListViewBaseComparer(pDlgContext->ListView,
-        pDlgContext->bInverseSort,
-        lParam1,
-        lParam2,
-        pDlgContext->lvColumnToSort);
-}
-
 /*
 * DesktopListShowProperties
 *
@@ -378,10 +351,11 @@ BOOL DesktopListHandleNotify(
             pDlgContext->bInverseSort = !pDlgContext->bInverseSort;
             pDlgContext->lvColumnToSort = ((NMLISTVIEW*)nhdr)->iSubItem;
 
-            ListView_SortItemsEx(
+            lvSortItems(
                 pDlgContext->ListView,
-                &DesktopListCompareFunc,
-                pDlgContext);
+                pDlgContext->lvColumnToSort,
+                LvSortKeyText,
+                pDlgContext->bInverseSort);
 
             if (pDlgContext->bInverseSort)
                 nImageIndex = 1;
@@ -442,10 +416,11 @@ INT_PTR CALLBACK DesktopListDialogProc(
                 DesktopListSetInfo(hwndDlg, Context, pDlgContext);
                 if (pDlgContext->ListView) {
 
-                    ListView_SortItemsEx(
+                    lvSortItems(
                         pDlgContext->ListView,
-                        &DesktopListCompareFunc,
-                        pDlgContext);
+                        pDlgContext->lvColumnToSort,
+                        LvSortKeyText,
+                        pDlgContext->bInverseSort);
                 }
                 return 1;
             }
@@ -19,102 +19,27 @@
 #include "extras.h"
 
 /*
-* ProcessListCompareFunc
+* ProcessListGetSortKey
 *
 * Purpose:
 *
-* Process page listview comparer function.
+* Process page listview sort key type for column.
 *
 */
-INT CALLBACK ProcessListCompareFunc(
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lpContextParam
+LVSORT_KEY_TYPE ProcessListGetSortKey(
+    _In_ LONG Column
 )
 {
-    INT       nResult = 0;
-    LPWSTR    lpItem1 = NULL, lpItem2 = NULL, FirstToCompare, SecondToCompare;
-    ULONG_PTR Value1, Value2;
-
-    LPARAM lvColumnToSort;
-
-    EXTRASCONTEXT* pDlgContext;
-
-    pDlgContext = (EXTRASCONTEXT*)lpContextParam;
-    if (pDlgContext == NULL)
-        return 0;
-
-    lvColumnToSort = (LPARAM)pDlgContext->lvColumnToSort;
-
-    //
-    // Sort Handle/GrantedAccess value column.
-    //
-    if ((lvColumnToSort == 2) || (lvColumnToSort == 3)) {
-        return supGetMaxOfTwoU64FromHex(
-            pDlgContext->ListView,
-            lParam1,
-            lParam2,
-            lvColumnToSort,
-            pDlgContext->bInverseSort);
-    }
-
-
-    lpItem1 = supGetItemText(
-        pDlgContext->ListView,
-        (INT)lParam1,
-        (INT)lvColumnToSort,
-        NULL);
-
-    if (lpItem1 == NULL) //can't be 0 for this dialog
-        goto Done;
-
-    lpItem2 = supGetItemText(
-        pDlgContext->ListView,
-        (INT)lParam2,
-        (INT)lvColumnToSort,
-        NULL);
-
-    if (lpItem2 == NULL) //can't be 0 for this dialog
-        goto Done;
-
-    switch (lvColumnToSort) {
-    case 0:
-        //
-        // Name column.
-        //
-        if (pDlgContext->bInverseSort) {
-            FirstToCompare = lpItem2;
-            SecondToCompare = lpItem1;
-        }
-        else
-        {
-            FirstToCompare = lpItem1;
-            SecondToCompare = lpItem2;
-        }
-
-        nResult = _strcmpi(FirstToCompare, SecondToCompare);
-        break;
-
-    case 1:
-        //
-        // Id column.
-        //
-        Value1 = strtou64(lpItem1);
-        Value2 = strtou64(lpItem2);
-        if (pDlgContext->bInverseSort)
-            nResult = Value2 > Value1;
-        else
-            nResult = Value1 > Value2;
-        break;
-
+    switch (Column) {
+    case 1: //Id
+        return LvSortKeyULong;
+    case 2: //Handle
+    case 3: //GrantedAccess
+        return LvSortKeyHex;
+    case 0: //Name
     default:
-        break;
+        return LvSortKeyText;
     }
-
-Done:
-    if (lpItem1) supHeapFree(lpItem1);
-    if (lpItem2) supHeapFree(lpItem2);
-    return nResult;
 }
 
 /*
@@ -222,10 +147,11 @@ BOOL ProcessListHandleNotify(
             pDlgContext->bInverseSort = !pDlgContext->bInverseSort;
             pDlgContext->lvColumnToSort = pListView->iSubItem;
 
-            ListView_SortItemsEx(
-                hwndListView,
-                &ProcessListCompareFunc,
-                pDlgContext);
+            lvSortItems(
+                pDlgContext->ListView,
+                pDlgContext->lvColumnToSort,
+                ProcessListGetSortKey(pDlgContext->lvColumnToSort),
+                pDlgContext->bInverseSort);
 
             if (pDlgContext->bInverseSort)
                 nImageIndex = 1;
@@ -841,10 +767,11 @@ INT_PTR CALLBACK ProcessListDialogProc(
 
                     ProcessListSetInfo(hwndDlg, Context, pDlgContext);
 
-                    ListView_SortItemsEx(
+                    lvSortItems(
                         pDlgContext->ListView,
-                        &ProcessListCompareFunc,
-                        pDlgContext);
+                        pDlgContext->lvColumnToSort,
+                        ProcessListGetSortKey(pDlgContext->lvColumnToSort),
+                        pDlgContext->bInverseSort);
                 }
             }
         }
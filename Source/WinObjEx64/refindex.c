@@ -0,0 +1,642 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       REFINDEX.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Image code reference index.
+*
+*  Collects every RIP-relative memory reference and every rel32 branch of
+*  mapped x64 image. Code is split at function starts and exports, a piece
+*  is decoded once on first query that touches it. Signature resolvers query
+*  this table instead of decoding code again.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+#include "hde\hde64.h"
+#include "hde\hde64len.h"
+
+//
+// Shortest instruction that can be stored in index (call rel32).
+//
+#define REFINDEX_MIN_INSTRUCTION_LENGTH 5
+
+//
+// Longest possible x64 instruction, hde64 reads up to this number of bytes.
+//
+#define REFINDEX_MAX_INSTRUCTION_LENGTH 15
+
+//
+// Number of bytes to scan from function start when function has no unwind data (leaf).
+//
+#define REFINDEX_LEAF_SCAN_BYTES 512
+
+/*
+* refpCompareUlong
+*
+* Purpose:
+*
+* qsort comparer for sync points array.
+*
+*/
+INT __cdecl refpCompareUlong(
+    _In_ const void* First,
+    _In_ const void* Second
+)
+{
+    ULONG Value1 = *(PULONG)First;
+    ULONG Value2 = *(PULONG)Second;
+
+    if (Value1 == Value2)
+        return 0;
+
+    return (Value1 < Value2) ? -1 : 1;
+}
+
+/*
+* refpClassifyInstruction
+*
+* Purpose:
+*
+* Return reference class for instruction with RIP-relative operand.
+*
+*/
+UCHAR refpClassifyInstruction(
+    _In_ hde64s* hs
+)
+{
+    if (hs->opcode == 0x0F) {
+
+        switch (hs->opcode2) {
+        case 0xB6: //movzx
+        case 0xB7:
+        case 0xBE: //movsx
+        case 0xBF:
+            return RefClassLoad;
+        default:
+            return RefClassOther;
+        }
+
+    }
+
+    switch (hs->opcode) {
+
+    case 0x8D:
+        return RefClassLea;
+
+    case 0x63: //movsxd
+    case 0x8A:
+    case 0x8B:
+        return RefClassLoad;
+
+    case 0x88:
+    case 0x89:
+    case 0xC6:
+    case 0xC7:
+        return RefClassStore;
+
+    case 0x38:
+    case 0x39:
+    case 0x3A:
+    case 0x3B:
+    case 0x84:
+    case 0x85:
+        return RefClassCompare;
+
+    case 0x80:
+    case 0x81:
+    case 0x83:
+        return (hs->modrm_reg == 7) ? RefClassCompare : RefClassOther;
+
+    case 0xF6:
+    case 0xF7:
+        return (hs->modrm_reg == 0) ? RefClassCompare : RefClassOther;
+
+    case 0xFF:
+        return ((hs->modrm_reg == 2) || (hs->modrm_reg == 4)) ? RefClassIndirect : RefClassOther;
+
+    default:
+        break;
+    }
+
+    return RefClassOther;
+}
+
+/*
+* refpBuildSegments
+*
+* Purpose:
+*
+* Split executable sections into segments at known instruction boundaries.
+*
+* Function starts from exception directory and exports are used so that
+* decoding never runs across data embedded in code sections.
+*
+*/
+BOOL refpBuildSegments(
+    _In_ PREFINDEX Index,
+    _In_ PIMAGE_NT_HEADERS NtHeaders
+)
+{
+    ULONG i, j, k, c = 0, DirSize = 0, ExportCount = 0, Point, EndRva, SectionEnd = 0;
+    PULONG SyncPoints, Functions = NULL;
+    PIMAGE_EXPORT_DIRECTORY ExportDirectory;
+    PIMAGE_SECTION_HEADER Section = IMAGE_FIRST_SECTION(NtHeaders);
+    PREFINDEX_SEGMENT Segment;
+
+    ExportDirectory = (PIMAGE_EXPORT_DIRECTORY)RtlImageDirectoryEntryToData((PVOID)Index->ImageBase,
+        TRUE,
+        IMAGE_DIRECTORY_ENTRY_EXPORT,
+        &DirSize);
+
+    if (ExportDirectory) {
+        ExportCount = ExportDirectory->NumberOfFunctions;
+        Functions = (PULONG)RtlOffsetToPointer(Index->ImageBase, ExportDirectory->AddressOfFunctions);
+    }
+
+    SyncPoints = (PULONG)supHeapAlloc((NtHeaders->FileHeader.NumberOfSections +
+        Index->NumberOfFunctions + ExportCount) * sizeof(ULONG));
+    if (SyncPoints == NULL)
+        return FALSE;
+
+    for (i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++)
+        if (Section[i].Characteristics & IMAGE_SCN_MEM_EXECUTE)
+            SyncPoints[c++] = Section[i].VirtualAddress;
+
+    for (i = 0; i < Index->NumberOfFunctions; i++)
+        SyncPoints[c++] = Index->Functions[i].BeginAddress;
+
+    for (i = 0; i < ExportCount; i++)
+        if (Functions[i] != 0)
+            SyncPoints[c++] = Functions[i];
+
+    RtlQuickSort(SyncPoints, c, sizeof(ULONG), refpCompareUlong);
+
+    Index->Segments = (PREFINDEX_SEGMENT)supHeapAlloc((1 + c) * sizeof(REFINDEX_SEGMENT));
+    if (Index->Segments == NULL) {
+        supHeapFree(SyncPoints);
+        return FALSE;
+    }
+
+    for (i = 0; i < c; i++) {
+
+        Point = SyncPoints[i];
+        if (i > 0 && SyncPoints[i - 1] == Point)
+            continue;
+
+        //
+        // Segment ends at next boundary or at the end of its section.
+        //
+        for (j = 0; j < NtHeaders->FileHeader.NumberOfSections; j++) {
+
+            if ((Section[j].Characteristics & IMAGE_SCN_MEM_EXECUTE) == 0)
+                continue;
+
+            SectionEnd = Section[j].VirtualAddress + Section[j].Misc.VirtualSize;
+            if (Point >= Section[j].VirtualAddress && Point < SectionEnd)
+                break;
+        }
+
+        if (j == NtHeaders->FileHeader.NumberOfSections)
+            continue;
+
+        k = i + 1;
+        while ((k < c) && (SyncPoints[k] == Point))
+            k++;
+
+        EndRva = (k < c) ? min(SyncPoints[k], SectionEnd) : SectionEnd;
+
+        Segment = &Index->Segments[Index->NumberOfSegments++];
+        Segment->StartRva = Point;
+        Segment->EndRva = EndRva;
+        Segment->FirstEntry = REFINDEX_SEGMENT_NOT_INDEXED;
+        Segment->NumberOfEntries = 0;
+    }
+
+    supHeapFree(SyncPoints);
+    return TRUE;
+}
+
+/*
+* refpIndexSegment
+*
+* Purpose:
+*
+* Decode segment code and append its references to the index.
+*
+* Index lock must be held exclusively.
+*
+*/
+VOID refpIndexSegment(
+    _In_ PREFINDEX Index,
+    _In_ PREFINDEX_SEGMENT Segment
+)
+{
+    ULONG Rva = Segment->StartRva;
+    ULONG Count = Index->NumberOfEntries;
+    ULONG Length;
+    uint32_t Flags;
+    LONG_PTR Target;
+    UCHAR Class;
+    PBYTE ImageBase = (PBYTE)Index->ImageBase;
+    PREFINDEX_ENTRY Entry;
+    hde64s hs;
+
+    __try {
+
+        while (Rva < Segment->EndRva) {
+
+            if (Rva + REFINDEX_MAX_INSTRUCTION_LENGTH > Index->SizeOfImage)
+                break;
+
+            Length = hde64_length(ImageBase + Rva, &Flags);
+            if (Flags & F_ERROR) {
+                Rva += 1;
+                continue;
+            }
+
+            //
+            // Full decode only for rel32 branches and disp32 memory operands.
+            //
+            if (((Flags & (F_RELATIVE | F_IMM32)) != (F_RELATIVE | F_IMM32)) &&
+                (((Flags & F_MODRM) == 0) || ((Flags & F_DISP32) == 0)))
+            {
+                Rva += Length;
+                continue;
+            }
+
+            hde64_disasm(ImageBase + Rva, &hs);
+
+            Class = 0;
+            Target = 0;
+
+            if ((hs.flags & F_MODRM) &&
+                (hs.modrm_mod == 0) &&
+                (hs.modrm_rm == 5))
+            {
+                //
+                // [rip+disp32]
+                //
+                Class = refpClassifyInstruction(&hs);
+                Target = (LONG_PTR)Rva + hs.len + (LONG)hs.disp.disp32;
+            }
+            else if ((hs.flags & (F_RELATIVE | F_IMM32)) == (F_RELATIVE | F_IMM32)) {
+                //
+                // call/jmp/jcc rel32
+                //
+                Class = (hs.opcode == 0xE8) ? RefClassCall : RefClassJump;
+                Target = (LONG_PTR)Rva + hs.len + (LONG)hs.imm.imm32;
+            }
+
+            if (Class &&
+                (Target >= 0) &&
+                (Target < (LONG_PTR)Index->SizeOfImage) &&
+                (Count < Index->MaximumEntries))
+            {
+                Entry = &Index->Entries[Count++];
+                Entry->InstructionRva = Rva;
+                Entry->TargetRva = (ULONG)Target;
+                Entry->Length = hs.len;
+                Entry->Class = Class;
+                Entry->Register = (Class < RefClassCall) ? (UCHAR)((hs.rex_r << 3) | hs.modrm_reg) : 0;
+                Entry->Reserved = 0;
+            }
+
+            Rva += hs.len;
+        }
+
+    }
+    __except (WOBJ_EXCEPTION_FILTER_LOG) {
+        Count = Index->NumberOfEntries;
+    }
+
+    Segment->FirstEntry = Index->NumberOfEntries;
+    Segment->NumberOfEntries = Count - Index->NumberOfEntries;
+    Index->NumberOfEntries = Count;
+}
+
+/*
+* refpFindSegment
+*
+* Purpose:
+*
+* Return index of first segment that ends above given rva.
+*
+*/
+ULONG refpFindSegment(
+    _In_ PREFINDEX Index,
+    _In_ ULONG Rva
+)
+{
+    ULONG Lo = 0, Hi = Index->NumberOfSegments, Mid;
+
+    while (Lo < Hi) {
+        Mid = Lo + ((Hi - Lo) >> 1);
+        if (Index->Segments[Mid].EndRva <= Rva)
+            Lo = Mid + 1;
+        else
+            Hi = Mid;
+    }
+
+    return Lo;
+}
+
+/*
+* refIndexDestroy
+*
+* Purpose:
+*
+* Release index memory.
+*
+*/
+VOID refIndexDestroy(
+    _In_ PREFINDEX Index
+)
+{
+    if (Index == NULL)
+        return;
+
+    if (Index->Entries)
+        supVirtualFree(Index->Entries);
+    if (Index->Segments)
+        supHeapFree(Index->Segments);
+
+    supHeapFree(Index);
+}
+
+/*
+* refIndexCreate
+*
+* Purpose:
+*
+* Create reference index for image mapped with LoadLibraryEx.
+*
+* Only segment bounds are computed here, code is decoded when queried,
+* so resolvers pay for routines they search and not for whole image.
+*
+* Index must be destroyed with refIndexDestroy after use, image must stay mapped.
+*
+*/
+PREFINDEX refIndexCreate(
+    _In_ PVOID ImageBase
+)
+{
+    BOOL bSuccess = FALSE;
+    ULONG i, CodeSize = 0, DirSize = 0;
+    PREFINDEX Index;
+    PIMAGE_NT_HEADERS NtHeaders;
+    PIMAGE_SECTION_HEADER Section;
+
+    NtHeaders = RtlImageNtHeader(ImageBase);
+    if (NtHeaders == NULL)
+        return NULL;
+
+    if (NtHeaders->FileHeader.Machine != IMAGE_FILE_MACHINE_AMD64)
+        return NULL;
+
+    Section = IMAGE_FIRST_SECTION(NtHeaders);
+    for (i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++) {
+        if (Section[i].Characteristics & IMAGE_SCN_MEM_EXECUTE)
+            CodeSize += Section[i].Misc.VirtualSize;
+    }
+
+    if (CodeSize == 0)
+        return NULL;
+
+    Index = (PREFINDEX)supHeapAlloc(sizeof(REFINDEX));
+    if (Index == NULL)
+        return NULL;
+
+    Index->ImageBase = (ULONG_PTR)ImageBase;
+    Index->SizeOfImage = NtHeaders->OptionalHeader.SizeOfImage;
+    InitializeSRWLock(&Index->Lock);
+
+    __try {
+
+        //
+        // Upper bound, pages are committed on demand.
+        //
+        Index->MaximumEntries = (CodeSize / REFINDEX_MIN_INSTRUCTION_LENGTH) + 1;
+        Index->Entries = (PREFINDEX_ENTRY)supVirtualAlloc(Index->MaximumEntries * sizeof(REFINDEX_ENTRY));
+        if (Index->Entries == NULL)
+            __leave;
+
+        Index->Functions = (PIMAGE_RUNTIME_FUNCTION_ENTRY)RtlImageDirectoryEntryToData(ImageBase,
+            TRUE,
+            IMAGE_DIRECTORY_ENTRY_EXCEPTION,
+            &DirSize);
+
+        if (Index->Functions)
+            Index->NumberOfFunctions = DirSize / sizeof(IMAGE_RUNTIME_FUNCTION_ENTRY);
+
+        bSuccess = refpBuildSegments(Index, NtHeaders);
+
+    }
+    __except (WOBJ_EXCEPTION_FILTER_LOG) {
+        bSuccess = FALSE;
+    }
+
+    if (!bSuccess) {
+        refIndexDestroy(Index);
+        Index = NULL;
+    }
+
+    return Index;
+}
+
+/*
+* refIndexLookupFunction
+*
+* Purpose:
+*
+* Return bounds of function that contains given rva using image unwind data.
+*
+*/
+BOOL refIndexLookupFunction(
+    _In_ PREFINDEX Index,
+    _In_ ULONG Rva,
+    _Out_ PULONG BeginRva,
+    _Out_ PULONG EndRva
+)
+{
+    ULONG Lo = 0, Hi, Mid;
+    PIMAGE_RUNTIME_FUNCTION_ENTRY Function;
+
+    *BeginRva = 0;
+    *EndRva = 0;
+
+    Hi = Index->NumberOfFunctions;
+    while (Lo < Hi) {
+        Mid = Lo + ((Hi - Lo) >> 1);
+        Function = &Index->Functions[Mid];
+
+        if (Rva < Function->BeginAddress) {
+            Hi = Mid;
+        }
+        else if (Rva >= Function->EndAddress) {
+            Lo = Mid + 1;
+        }
+        else {
+            *BeginRva = Function->BeginAddress;
+            *EndRva = Function->EndAddress;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+* refIndexFindFirst
+*
+* Purpose:
+*
+* Return first reference made by instruction located in [StartRva, EndRva).
+*
+* Class RefClassAny and InstructionLength 0 match any instruction.
+* If Pattern specified instruction must begin with these bytes.
+*
+* Segments in range are decoded if they were not queried before.
+*
+*/
+PREFINDEX_ENTRY refIndexFindFirst(
+    _In_ PREFINDEX Index,
+    _In_ ULONG StartRva,
+    _In_ ULONG EndRva,
+    _In_ REFINDEX_CLASS Class,
+    _In_ ULONG InstructionLength,
+    _In_opt_ PBYTE Pattern,
+    _In_ ULONG PatternSize
+)
+{
+    ULONG i, j;
+    PREFINDEX_SEGMENT Segment;
+    PREFINDEX_ENTRY Entry, Result = NULL;
+
+    AcquireSRWLockExclusive(&Index->Lock);
+
+    __try {
+
+        for (i = refpFindSegment(Index, StartRva); i < Index->NumberOfSegments; i++) {
+
+            Segment = &Index->Segments[i];
+            if (Segment->StartRva >= EndRva)
+                break;
+
+            if (Segment->FirstEntry == REFINDEX_SEGMENT_NOT_INDEXED)
+                refpIndexSegment(Index, Segment);
+
+            for (j = 0; j < Segment->NumberOfEntries; j++) {
+
+                Entry = &Index->Entries[Segment->FirstEntry + j];
+                if (Entry->InstructionRva < StartRva)
+                    continue;
+                if (Entry->InstructionRva >= EndRva)
+                    break;
+
+                if ((Class != RefClassAny) && (Entry->Class != Class))
+                    continue;
+
+                if ((InstructionLength != 0) && (Entry->Length != InstructionLength))
+                    continue;
+
+                if (Pattern && PatternSize) {
+                    if (PatternSize > Entry->Length)
+                        continue;
+                    if (PatternSize != RtlCompareMemory(
+                        (PVOID)(Index->ImageBase + Entry->InstructionRva),
+                        Pattern,
+                        PatternSize))
+                    {
+                        continue;
+                    }
+                }
+
+                Result = Entry;
+                __leave;
+            }
+        }
+
+    }
+    __finally {
+        ReleaseSRWLockExclusive(&Index->Lock);
+    }
+
+    return Result;
+}
+
+/*
+* refIndexFindInFunction
+*
+* Purpose:
+*
+* Return first matching reference inside function at given rva.
+*
+*/
+PREFINDEX_ENTRY refIndexFindInFunction(
+    _In_ PREFINDEX Index,
+    _In_ ULONG FunctionRva,
+    _In_ REFINDEX_CLASS Class,
+    _In_ ULONG InstructionLength,
+    _In_opt_ PBYTE Pattern,
+    _In_ ULONG PatternSize
+)
+{
+    ULONG BeginRva, EndRva;
+
+    if (!refIndexLookupFunction(Index, FunctionRva, &BeginRva, &EndRva))
+        EndRva = FunctionRva + REFINDEX_LEAF_SCAN_BYTES;
+
+    return refIndexFindFirst(Index,
+        FunctionRva,
+        EndRva,
+        Class,
+        InstructionLength,
+        Pattern,
+        PatternSize);
+}
+
+/*
+* refIndexFindByTarget
+*
+* Purpose:
+*
+* Return first reference to given target rva and number of references.
+*
+* Only segments already decoded by previous queries are searched, this is
+* enough to find instruction that resolver has just matched.
+*
+*/
+PREFINDEX_ENTRY refIndexFindByTarget(
+    _In_ PREFINDEX Index,
+    _In_ ULONG TargetRva,
+    _Out_ PULONG NumberOfReferences
+)
+{
+    ULONG i, c = 0;
+    PREFINDEX_ENTRY Result = NULL;
+
+    AcquireSRWLockShared(&Index->Lock);
+
+    for (i = 0; i < Index->NumberOfEntries; i++) {
+        if (Index->Entries[i].TargetRva == TargetRva) {
+            if (Result == NULL)
+                Result = &Index->Entries[i];
+            c++;
+        }
+    }
+
+    ReleaseSRWLockShared(&Index->Lock);
+
+    *NumberOfReferences = c;
+    return Result;
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       REFINDEX.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the image code reference index.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Instruction classes stored in the index.
+//
+typedef enum _REFINDEX_CLASS {
+    RefClassAny = 0,        //query wildcard, never stored
+    RefClassLea = 1,        //lea reg, [rip+disp32]
+    RefClassLoad = 2,       //mov/movzx/movsx reg, [rip+disp32]
+    RefClassStore = 3,      //mov [rip+disp32], reg/imm
+    RefClassCompare = 4,    //cmp/test with [rip+disp32]
+    RefClassIndirect = 5,   //call/jmp [rip+disp32]
+    RefClassCall = 6,       //call rel32
+    RefClassJump = 7,       //jmp/jcc rel32
+    RefClassOther = 8,      //any other instruction with [rip+disp32]
+    RefClassMax
+} REFINDEX_CLASS;
+
+//
+// Single reference, 12 bytes, entries of segment are sorted by InstructionRva.
+//
+typedef struct _REFINDEX_ENTRY {
+    ULONG InstructionRva;
+    ULONG TargetRva;
+    UCHAR Length;
+    UCHAR Class;
+    UCHAR Register; //modrm.reg extended with rex.r, 0 for rel32 branches
+    UCHAR Reserved;
+} REFINDEX_ENTRY, *PREFINDEX_ENTRY;
+
+//
+// FirstEntry value of segment that was not decoded yet.
+//
+#define REFINDEX_SEGMENT_NOT_INDEXED MAXULONG
+
+//
+// Code between two known instruction boundaries (function starts, exports,
+// section starts), decoded on first query that touches it.
+//
+typedef struct _REFINDEX_SEGMENT {
+    ULONG StartRva;
+    ULONG EndRva;
+    ULONG FirstEntry;
+    ULONG NumberOfEntries;
+} REFINDEX_SEGMENT, *PREFINDEX_SEGMENT;
+
+typedef struct _REFINDEX {
+    ULONG_PTR ImageBase; //mapped image
+    ULONG SizeOfImage;
+    ULONG NumberOfEntries;
+    ULONG MaximumEntries;
+    ULONG NumberOfFunctions;
+    ULONG NumberOfSegments;
+    SRWLOCK Lock;
+    PREFINDEX_ENTRY Entries; //append only, entries never move once indexed
+    PREFINDEX_SEGMENT Segments; //sorted by StartRva
+    PIMAGE_RUNTIME_FUNCTION_ENTRY Functions; //points to mapped image exception directory
+} REFINDEX, *PREFINDEX;
+
+PREFINDEX refIndexCreate(
+    _In_ PVOID ImageBase);
+
+VOID refIndexDestroy(
+    _In_ PREFINDEX Index);
+
+PREFINDEX_ENTRY refIndexFindFirst(
+    _In_ PREFINDEX Index,
+    _In_ ULONG StartRva,
+    _In_ ULONG EndRva,
+    _In_ REFINDEX_CLASS Class,
+    _In_ ULONG InstructionLength,
+    _In_opt_ PBYTE Pattern,
+    _In_ ULONG PatternSize);
+
+PREFINDEX_ENTRY refIndexFindInFunction(
+    _In_ PREFINDEX Index,
+    _In_ ULONG FunctionRva,
+    _In_ REFINDEX_CLASS Class,
+    _In_ ULONG InstructionLength,
+    _In_opt_ PBYTE Pattern,
+    _In_ ULONG PatternSize);
+
+PREFINDEX_ENTRY refIndexFindByTarget(
+    _In_ PREFINDEX Index,
+    _In_ ULONG TargetRva,
+    _Out_ PULONG NumberOfReferences);
+
+BOOL refIndexLookupFunction(
+    _In_ PREFINDEX Index,
+    _In_ ULONG Rva,
+    _Out_ PULONG BeginRva,
+    _Out_ PULONG EndRva);
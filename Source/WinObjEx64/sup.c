@@ -1584,6 +1584,7 @@ VOID supInit(
 {
     WCHAR szError[200];
     NTSTATUS status;
+    TRACE_SPAN Span;
 
     supxSetProcessMitigationPolicies();
 
@@ -1592,17 +1593,28 @@ VOID supInit(
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
 #pragma warning(pop)
 
+    arenaInitialize();
+
+    TRACE_BEGIN(Span, "kdInit");
     kdInit(IsFullAdmin);
+    TRACE_END(Span);
 
     if (IsFullAdmin) {
+        TRACE_BEGIN(Span, "supCreateSCMSnapshot");
         supCreateSCMSnapshot(SERVICE_DRIVER, NULL);
+        TRACE_END(Span);
     }
 
+    TRACE_BEGIN(Span, "sapiCreateSetupDBSnapshot");
     sapiCreateSetupDBSnapshot();
+    TRACE_END(Span);
+
     g_pObjectTypesInfo = (POBJECT_TYPES_INFORMATION)supGetObjectTypesInfo();
 
     //Result ignored intentionally and used only in debug.
+    TRACE_BEGIN(Span, "ExApiSetInit");
     status = ExApiSetInit();
+    TRACE_END(Span);
     if (!NT_SUCCESS(status)) {
         _strcpy(szError, TEXT("ExApiSetInit() failed, 0x"));
         ultohex(status, _strend(szError));
@@ -2121,7 +2133,7 @@ VOID supFreeSCMSnapshot(
 *
 */
 BOOL sapiQueryDeviceProperty(
-    _In_ HANDLE SnapshotHeap,
+    _In_ PARENA SnapshotArena,
     _In_ HDEVINFO hDevInfo,
     _In_ SP_DEVINFO_DATA* pDevInfoData,
     _In_ ULONG Property,
@@ -2139,7 +2151,7 @@ BOOL sapiQueryDeviceProperty(
         *PropertyBufferSize = 0;
 
     dataSize = (1 + MAX_PATH) * sizeof(WCHAR);
-    lpProperty = (LPWSTR)RtlAllocateHeap(SnapshotHeap, HEAP_ZERO_MEMORY, dataSize);
+    lpProperty = (LPWSTR)arenaAlloc(SnapshotArena, dataSize);
     if (lpProperty == NULL)
         return FALSE;
 
@@ -2153,9 +2165,11 @@ BOOL sapiQueryDeviceProperty(
 
     if (GetLastError() == ERROR_INSUFFICIENT_BUFFER) {
 
-        RtlFreeHeap(SnapshotHeap, 0, lpProperty);
+        //
+        // Previous buffer stays in arena until snapshot is released.
+        //
         dataSize = returnLength;
-        lpProperty = (LPWSTR)RtlAllocateHeap(SnapshotHeap, HEAP_ZERO_MEMORY, dataSize);
+        lpProperty = (LPWSTR)arenaAlloc(SnapshotArena, dataSize);
         if (lpProperty) {
 
             result = SetupDiGetDeviceRegistryProperty(hDevInfo,
@@ -2171,10 +2185,7 @@ BOOL sapiQueryDeviceProperty(
     }
 
     if (!result) {
-        if (lpProperty) {
-            RtlFreeHeap(SnapshotHeap, 0, lpProperty);
-            lpProperty = NULL;
-        }
+        lpProperty = NULL;
         dataSize = 0;
     }
 
@@ -2200,18 +2211,15 @@ BOOL sapiCreateSetupDBSnapshot(
     DWORD           i, ReturnedDataSize = 0;
     SP_DEVINFO_DATA DeviceInfoData;
     PSAPIDBENTRY    Entry;
-    HANDLE          Heap;
+    PARENA          Arena;
     HDEVINFO        hDevInfo;
 
-    Heap = RtlCreateHeap(HEAP_GROWABLE, NULL, 0, 0, NULL, NULL);
-    if (Heap == NULL) {
+    Arena = arenaCreate(0);
+    if (Arena == NULL) {
         return FALSE;
     }
 
-    if (g_WinObj.IsWine == FALSE) {
-        RtlSetHeapInformation(Heap, HeapEnableTerminationOnCorruption, NULL, 0);
-    }
-    g_sapiDB.sapiHeap = Heap;
+    g_sapiDB.sapiArena = Arena;
 
     hDevInfo = SetupDiGetClassDevs(NULL, NULL, NULL, DIGCF_PRESENT | DIGCF_ALLCLASSES);
     if (hDevInfo != INVALID_HANDLE_VALUE) {
@@ -2223,7 +2231,7 @@ BOOL sapiCreateSetupDBSnapshot(
 
         for (i = 0; SetupDiEnumDeviceInfo(hDevInfo, i, &DeviceInfoData); i++) {
 
-            Entry = (PSAPIDBENTRY)RtlAllocateHeap(Heap, HEAP_ZERO_MEMORY, sizeof(SAPIDBENTRY));
+            Entry = (PSAPIDBENTRY)arenaAlloc(Arena, sizeof(SAPIDBENTRY));
             if (Entry == NULL) {
                 bFailed = TRUE;
                 break;
@@ -2232,7 +2240,7 @@ BOOL sapiCreateSetupDBSnapshot(
             //
             // Query Device Name.
             //
-            sapiQueryDeviceProperty(Heap,
+            sapiQueryDeviceProperty(Arena,
                 hDevInfo,
                 &DeviceInfoData,
                 SPDRP_PHYSICAL_DEVICE_OBJECT_NAME,
@@ -2242,7 +2250,7 @@ BOOL sapiCreateSetupDBSnapshot(
             //
             // Query Device Description.
             //
-            sapiQueryDeviceProperty(Heap,
+            sapiQueryDeviceProperty(Arena,
                 hDevInfo,
                 &DeviceInfoData,
                 SPDRP_DEVICEDESC,
@@ -2260,7 +2268,7 @@ BOOL sapiCreateSetupDBSnapshot(
     }
 
     if (bFailed) {
-        RtlDestroyHeap(Heap);
+        arenaDestroy(Arena);
         RtlSecureZeroMemory(&g_sapiDB, sizeof(g_sapiDB));
     }
     return bResult;
@@ -2271,7 +2279,7 @@ BOOL sapiCreateSetupDBSnapshot(
 *
 * Purpose:
 *
-* Destroys snapshot heap and zero linked list.
+* Destroys snapshot arena and zero linked list.
 *
 */
 VOID sapiFreeSnapshot(
@@ -2279,8 +2287,9 @@ VOID sapiFreeSnapshot(
 )
 {
     EnterCriticalSection(&g_WinObj.Lock);
-    RtlDestroyHeap(g_sapiDB.sapiHeap);
-    g_sapiDB.sapiHeap = NULL;
+    if (g_sapiDB.sapiArena)
+        arenaDestroy(g_sapiDB.sapiArena);
+    g_sapiDB.sapiArena = NULL;
     g_sapiDB.ListHead.Blink = NULL;
     g_sapiDB.ListHead.Flink = NULL;
     LeaveCriticalSection(&g_WinObj.Lock);
@@ -3184,6 +3193,35 @@ BOOL supSaveDialogExecute(
     return GetSaveFileName(&tag1);
 }
 
+/*
+* supOpenDialogExecute
+*
+* Purpose:
+*
+* Display OpenDialog.
+*
+*/
+BOOL supOpenDialogExecute(
+    _In_ HWND OwnerWindow,
+    _Inout_ LPWSTR OpenFileName,
+    _In_ LPWSTR lpDialogFilter
+)
+{
+    OPENFILENAME tag1;
+
+    RtlSecureZeroMemory(&tag1, sizeof(OPENFILENAME));
+
+    tag1.lStructSize = sizeof(OPENFILENAME);
+    tag1.hwndOwner = OwnerWindow;
+    tag1.lpstrFilter = lpDialogFilter;
+    tag1.lpstrFile = OpenFileName;
+    tag1.nMaxFile = MAX_PATH;
+    tag1.lpstrInitialDir = NULL;
+    tag1.Flags = OFN_EXPLORER | OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+
+    return GetOpenFileName(&tag1);
+}
+
 /*
 * supGetStockIcon
 *
@@ -4516,108 +4554,6 @@ INT supGetMaxOfTwoU64FromHex(
     return nResult;
 }
 
-/*
-* supGetMaxOfTwoLongFromString
-*
-* Purpose:
-*
-* Returned value used in listview comparer functions.
-*
-*/
-INT supGetMaxOfTwoLongFromString(
-    _In_ HWND ListView,
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort,
-    _In_ BOOL Inverse
-)
-{
-    INT       nResult;
-    LPWSTR    lpItem1 = NULL, lpItem2 = NULL;
-    LONG_PTR  value1, value2;
-    WCHAR     szText[MAX_TEXT_CONVERSION_ULONG64 + 1];
-
-    RtlSecureZeroMemory(&szText, sizeof(szText));
-
-    lpItem1 = supGetItemText2(
-        ListView,
-        (INT)lParam1,
-        (INT)lParamSort,
-        szText,
-        MAX_TEXT_CONVERSION_ULONG64);
-
-    value1 = strtoi64(lpItem1);
-
-    RtlSecureZeroMemory(&szText, sizeof(szText));
-
-    lpItem2 = supGetItemText2(
-        ListView,
-        (INT)lParam2,
-        (INT)lParamSort,
-        szText,
-        MAX_TEXT_CONVERSION_ULONG64);
-
-    value2 = strtoi64(lpItem2);
-
-    if (Inverse)
-        nResult = value1 < value2;
-    else
-        nResult = value1 > value2;
-
-    return nResult;
-}
-
-/*
-* supGetMaxOfTwoULongFromString
-*
-* Purpose:
-*
-* Returned value used in listview comparer functions.
-*
-*/
-INT supGetMaxOfTwoULongFromString(
-    _In_ HWND ListView,
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort,
-    _In_ BOOL Inverse
-)
-{
-    INT       nResult;
-    LPWSTR    lpItem1 = NULL, lpItem2 = NULL;
-    ULONG_PTR value1, value2;
-    WCHAR     szText[MAX_TEXT_CONVERSION_ULONG64 + 1];
-
-    RtlSecureZeroMemory(&szText, sizeof(szText));
-
-    lpItem1 = supGetItemText2(
-        ListView,
-        (INT)lParam1,
-        (INT)lParamSort,
-        szText,
-        MAX_TEXT_CONVERSION_ULONG64);
-
-    value1 = strtou64(lpItem1);
-
-    RtlSecureZeroMemory(&szText, sizeof(szText));
-
-    lpItem2 = supGetItemText2(
-        ListView,
-        (INT)lParam2,
-        (INT)lParamSort,
-        szText,
-        MAX_TEXT_CONVERSION_ULONG64);
-
-    value2 = strtou64(lpItem2);
-
-    if (Inverse)
-        nResult = value1 < value2;
-    else
-        nResult = value1 > value2;
-
-    return nResult;
-}
-
 /*
 * supGetMaxCompareTwoFixedStrings
 *
@@ -4670,58 +4606,6 @@ INT supGetMaxCompareTwoFixedStrings(
     return nResult;
 }
 
-/*
-* supListViewBaseComparer
-*
-* Purpose:
-*
-* Base comparer for listviews.
-*
-*/
-INT supListViewBaseComparer(
-    _In_ HWND ListViewHandle,
-    _In_ BOOL InverseSort,
-    _In_ LPARAM FirstItem,
-    _In_ LPARAM SecondItem,
-    _In_ LPARAM ColumnToSort
-)
-{
-    INT    nResult = 0;
-    LPWSTR lpItem1 = NULL, lpItem2 = NULL, FirstToCompare, SecondToCompare;
-
-    lpItem1 = supGetItemText(ListViewHandle, (INT)FirstItem, (INT)ColumnToSort, NULL);
-    lpItem2 = supGetItemText(ListViewHandle, (INT)SecondItem, (INT)ColumnToSort, NULL);
-
-    if ((lpItem1 == NULL) && (lpItem2 == NULL)) {
-        nResult = 0;
-        goto Done;
-    }
-    if ((lpItem1 == NULL) && (lpItem2 != NULL)) {
-        nResult = (InverseSort) ? 1 : -1;
-        goto Done;
-    }
-    if ((lpItem2 == NULL) && (lpItem1 != NULL)) {
-        nResult = (InverseSort) ? -1 : 1;
-        goto Done;
-    }
-
-    if (InverseSort) {
-        FirstToCompare = lpItem2;
-        SecondToCompare = lpItem1;
-    }
-    else {
-        FirstToCompare = lpItem1;
-        SecondToCompare = lpItem2;
-    }
-
-    nResult = _strcmpi(FirstToCompare, SecondToCompare);
-
-Done:
-    if (lpItem1) supHeapFree(lpItem1);
-    if (lpItem2) supHeapFree(lpItem2);
-    return nResult;
-}
-
 /*
 * supOpenTokenByParam
 *
@@ -31,7 +31,7 @@
 
 typedef struct _SAPIDB {
     LIST_ENTRY ListHead;
-    HANDLE     sapiHeap;
+    PARENA     sapiArena;
 } SAPIDB, * PSAPIDB;
 
 typedef struct _SCMDB {
@@ -396,6 +396,11 @@ BOOL supSaveDialogExecute(
     _Inout_ LPWSTR SaveFileName,
     _In_ LPWSTR lpDialogFilter);
 
+BOOL supOpenDialogExecute(
+    _In_ HWND OwnerWindow,
+    _Inout_ LPWSTR OpenFileName,
+    _In_ LPWSTR lpDialogFilter);
+
 HICON supGetStockIcon(
     _In_ SHSTOCKICONID siid,
     _In_ UINT uFlags);
@@ -479,20 +484,6 @@ INT supGetMaxOfTwoU64FromHex(
     _In_ LPARAM lParamSort,
     _In_ BOOL Inverse);
 
-INT supGetMaxOfTwoLongFromString(
-    _In_ HWND ListView,
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort,
-    _In_ BOOL Inverse);
-
-INT supGetMaxOfTwoULongFromString(
-    _In_ HWND ListView,
-    _In_ LPARAM lParam1,
-    _In_ LPARAM lParam2,
-    _In_ LPARAM lParamSort,
-    _In_ BOOL Inverse);
-
 INT supGetMaxCompareTwoFixedStrings(
     _In_ HWND ListView,
     _In_ LPARAM lParam1,
@@ -681,13 +672,6 @@ INT supAddListViewColumn(
     _In_ LPWSTR Text,
     _In_ INT Width);
 
-INT supListViewBaseComparer(
-    _In_ HWND ListViewHandle,
-    _In_ BOOL InverseSort,
-    _In_ LPARAM FirstItem,
-    _In_ LPARAM SecondItem,
-    _In_ LPARAM ColumnToSort);
-
 ULONG supHashString(
     _In_ PCWSTR String,
     _In_ ULONG Length);
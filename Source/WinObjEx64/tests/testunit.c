@@ -20,6 +20,7 @@
 
 #include "global.h"
 #include "ntos\ntldr.h"
+#include "hde\hde64len.h"
 #include <intrin.h>
 #include <aclapi.h>
 
@@ -605,13 +606,16 @@ VOID TestApiSetResolve()
 {
     ULONG i, Version;
     PVOID Data;
-    BOOL Resolved;
+    BOOL Resolved, CacheResolved, Flatten;
 
-    NTSTATUS Status;
+    NTSTATUS Status, CacheStatus;
 
     UNICODE_STRING ApiSetLibrary;
     UNICODE_STRING ParentLibrary;
     UNICODE_STRING ResolvedHostLibrary;
+    UNICODE_STRING CachedHostLibrary;
+
+    PNTLDR_APISET_CACHE Cache;
 
     NtLdrApiSetLoadFromPeb(&Version, &Data);
 
@@ -675,6 +679,45 @@ VOID TestApiSetResolve()
     else {
         kdDebugPrint("NtLdrApiSetResolveLibrary failed 0x%lx\r\n", Status);
     }
+
+    //
+    // Cache must give the same results, flattened and on demand.
+    //
+    for (Flatten = FALSE; Flatten <= TRUE; Flatten++) {
+
+        Cache = NtLdrApiSetCacheCreate(NtCurrentPeb()->ProcessHeap, Data, 0, Flatten);
+        if (Cache == NULL) {
+            kdDebugPrint("NtLdrApiSetCacheCreate failed\r\n");
+            break;
+        }
+
+        for (i = 0; i < 12; i++) {
+            RtlInitUnicodeString(&ApiSetLibrary, ToResolve[i]);
+
+            Status = NtLdrApiSetResolveLibrary(Data,
+                &ApiSetLibrary,
+                &ParentLibrary,
+                &Resolved,
+                &ResolvedHostLibrary);
+
+            CacheStatus = NtLdrApiSetCacheResolve(Cache,
+                &ApiSetLibrary,
+                &ParentLibrary,
+                &CacheResolved,
+                &CachedHostLibrary);
+
+            if (Status != CacheStatus || Resolved != CacheResolved ||
+                (NT_SUCCESS(Status) && !RtlEqualUnicodeString(&ResolvedHostLibrary, &CachedHostLibrary, TRUE)))
+            {
+                kdDebugPrint("NtLdrApiSetCacheResolve mismatch %wZ\r\n", ApiSetLibrary);
+            }
+
+            if (NT_SUCCESS(Status))
+                RtlFreeUnicodeString(&ResolvedHostLibrary);
+        }
+
+        NtLdrApiSetCacheDestroy(Cache);
+    }
 }
 
 BOOL CALLBACK EnumerateSLValueDescriptorCallback(
@@ -871,6 +914,126 @@ VOID PreHashTypes()
 }
 
 
+VOID TestDisasmLength()
+{
+    PIMAGE_NT_HEADERS NtHeaders;
+    PIMAGE_SECTION_HEADER Section;
+    PBYTE Code;
+    ULONG i, Offset, Size, Mismatch = 0, Overflow = 0, Count;
+    ULONG FirstMismatchRva = 0;
+    ULONG Flags;
+    hde64s hs;
+    UCHAR Lengths[256];
+    LARGE_INTEGER t0, t1, t2, freq;
+    ULONG64 fullTime = 0, fastTime = 0;
+
+    if (g_kdctx.NtOsImageMap == NULL)
+        return;
+
+    NtHeaders = RtlImageNtHeader(g_kdctx.NtOsImageMap);
+    if (NtHeaders == NULL)
+        return;
+
+    QueryPerformanceFrequency(&freq);
+
+    Section = IMAGE_FIRST_SECTION(NtHeaders);
+    for (i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++, Section++) {
+
+        if ((Section->Characteristics & IMAGE_SCN_MEM_EXECUTE) == 0)
+            continue;
+
+        Code = (PBYTE)g_kdctx.NtOsImageMap + Section->VirtualAddress;
+        Size = min(Section->Misc.VirtualSize, Section->SizeOfRawData);
+        if (Size < 16)
+            continue;
+        Size -= 16;
+
+        //
+        // Decode at every offset, both decoders must agree.
+        //
+        for (Offset = 0; Offset < Size; Offset++) {
+            hde64_disasm(Code + Offset, &hs);
+            if (hde64_length(Code + Offset, (uint32_t*)&Flags) != hs.len || Flags != hs.flags) {
+                if (Mismatch == 0)
+                    FirstMismatchRva = Section->VirtualAddress + Offset;
+                Mismatch++;
+            }
+        }
+
+        //
+        // Linear sweep timings.
+        //
+        QueryPerformanceCounter(&t0);
+        for (Offset = 0; Offset < Size; ) {
+            hde64_disasm(Code + Offset, &hs);
+            Offset += (hs.flags & F_ERROR) ? 1 : hs.len;
+        }
+        QueryPerformanceCounter(&t1);
+        for (Offset = 0; Offset < Size; ) {
+            Count = hde64_length(Code + Offset, (uint32_t*)&Flags);
+            Offset += (Flags & F_ERROR) ? 1 : Count;
+        }
+        QueryPerformanceCounter(&t2);
+
+        fullTime += t1.QuadPart - t0.QuadPart;
+        fastTime += t2.QuadPart - t1.QuadPart;
+
+        //
+        // Batch must stop inside the section and never overflow the array.
+        //
+        Count = hde64_length_batch(Code, Size, Lengths, RTL_NUMBER_OF(Lengths));
+        if (Count > RTL_NUMBER_OF(Lengths))
+            Overflow++;
+    }
+
+    if (Mismatch) {
+        kdDebugPrint("TestDisasmLength: hde64_length/hde64_disasm mismatch at %lu offsets, first at rva 0x%lX\r\n",
+            Mismatch,
+            FirstMismatchRva);
+    }
+
+    if (Overflow) {
+        kdDebugPrint("TestDisasmLength: hde64_length_batch overflow in %lu sections\r\n", Overflow);
+    }
+
+    kdDebugPrint("TestDisasmLength: hde64_disasm %llu us, hde64_length %llu us\r\n",
+        fullTime * 1000000 / freq.QuadPart,
+        fastTime * 1000000 / freq.QuadPart);
+}
+
+VOID TestKdCache()
+{
+    ULONG_PTR Expected, Cached = 0;
+    PVOID LookupTable;
+
+    if (g_kdctx.NtOsBase == NULL)
+        return;
+
+    //
+    // Resolver must remember what it found and give the same result from cache.
+    //
+    LookupTable = ObFindPrivateNamespaceLookupTable(&g_kdctx);
+    if (LookupTable == NULL) {
+        kdDebugPrint("TestKdCache: private namespace table not found\r\n");
+        return;
+    }
+
+    Expected = (ULONG_PTR)LookupTable;
+    if (g_NtBuildNumber > NT_WIN10_THRESHOLD2)
+        Expected -= FIELD_OFFSET(OBP_SILODRIVERSTATE, PrivateNamespaceLookupTable);
+
+    if (!kdCacheLookupNtOsAddress(KdCachePrivateNamespaceLookupTable, &Cached) ||
+        Cached != Expected)
+    {
+        kdDebugPrint("TestKdCache: private namespace table cache mismatch %p %p\r\n",
+            (PVOID)Cached, (PVOID)Expected);
+        return;
+    }
+
+    if (ObFindPrivateNamespaceLookupTable(&g_kdctx) != LookupTable)
+        kdDebugPrint("TestKdCache: cached private namespace table differs\r\n");
+}
+
 VOID TestCall()
 {
 
@@ -881,6 +1044,8 @@ VOID TestStart(
 )
 {
     TestCall();
+    TestDisasmLength();
+    TestKdCache();
     TestSectionImage();
     TestShadowDirectory();
     //TestPsObjectSecurity();
@@ -0,0 +1,362 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       TRACE.C
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Span tracing.
+*
+*  Spans are stored as complete events into preallocated array and written
+*  on program exit as trace event JSON, viewable in chrome://tracing or
+*  Perfetto. Nothing is allocated unless tracing is enabled.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#include "global.h"
+
+#define TRACE_WRITE_BUFFER_SIZE 0x10000
+
+typedef struct _TRACE_EVENT {
+    LPCSTR Name; //set last, NULL if event is not complete
+    LONGLONG StartTime;
+    LONGLONG EndTime;
+    ULONG ThreadId;
+    WCHAR Detail[TRACE_MAX_DETAIL];
+} TRACE_EVENT, *PTRACE_EVENT;
+
+typedef struct _TRACE_STATE {
+    LONGLONG Frequency;
+    LONGLONG BaseTime;
+    volatile LONG EventCount;
+    PTRACE_EVENT Events;
+    WCHAR szFileName[MAX_PATH + 1];
+} TRACE_STATE, *PTRACE_STATE;
+
+typedef struct _TRACE_WRITER {
+    HANDLE FileHandle;
+    ULONG Length;
+    CHAR Buffer[TRACE_WRITE_BUFFER_SIZE];
+} TRACE_WRITER, *PTRACE_WRITER;
+
+BOOL g_TraceEnabled = FALSE;
+
+static TRACE_STATE g_trace;
+
+/*
+* traceTimestamp
+*
+* Purpose:
+*
+* Return current performance counter value.
+*
+*/
+LONGLONG traceTimestamp(
+    VOID
+)
+{
+    LARGE_INTEGER Counter;
+
+    QueryPerformanceCounter(&Counter);
+    return Counter.QuadPart;
+}
+
+/*
+* traceSpanEnd
+*
+* Purpose:
+*
+* Store completed span, spans above TRACE_MAX_EVENTS are dropped.
+*
+*/
+VOID traceSpanEnd(
+    _In_ PTRACE_SPAN Span,
+    _In_opt_ LPCWSTR Detail
+)
+{
+    LONG Index;
+    PTRACE_EVENT Event;
+
+    if (g_trace.Events == NULL)
+        return;
+
+    Index = InterlockedIncrement(&g_trace.EventCount) - 1;
+    if (Index >= TRACE_MAX_EVENTS)
+        return;
+
+    Event = &g_trace.Events[Index];
+    Event->StartTime = Span->StartTime;
+    Event->EndTime = traceTimestamp();
+    Event->ThreadId = GetCurrentThreadId();
+
+    if (Detail)
+        _strncpy(Event->Detail, TRACE_MAX_DETAIL, Detail, TRACE_MAX_DETAIL - 1);
+
+    InterlockedExchangePointer((PVOID volatile*)&Event->Name, (PVOID)Span->Name);
+}
+
+/*
+* traceCreate
+*
+* Purpose:
+*
+* Enable tracing if requested by environment variable.
+*
+*/
+VOID traceCreate(
+    VOID
+)
+{
+    DWORD cch;
+    LARGE_INTEGER Frequency;
+
+    cch = GetEnvironmentVariable(TRACE_ENVIRONMENT_VARIABLE, g_trace.szFileName, MAX_PATH);
+    if ((cch == 0) || (cch >= MAX_PATH))
+        return;
+
+    if (!QueryPerformanceFrequency(&Frequency))
+        return;
+
+    g_trace.Events = (PTRACE_EVENT)supVirtualAlloc(TRACE_MAX_EVENTS * sizeof(TRACE_EVENT));
+    if (g_trace.Events == NULL)
+        return;
+
+    g_trace.Frequency = Frequency.QuadPart;
+    g_trace.BaseTime = traceTimestamp();
+    g_TraceEnabled = TRUE;
+}
+
+/*
+* tracepFlush
+*
+* Purpose:
+*
+* Write buffered output to the file.
+*
+*/
+VOID tracepFlush(
+    _In_ PTRACE_WRITER Writer
+)
+{
+    DWORD dwWritten;
+
+    if (Writer->Length) {
+        WriteFile(Writer->FileHandle, Writer->Buffer, Writer->Length, &dwWritten, NULL);
+        Writer->Length = 0;
+    }
+}
+
+/*
+* tracepWrite
+*
+* Purpose:
+*
+* Append string to the output buffer.
+*
+*/
+VOID tracepWrite(
+    _In_ PTRACE_WRITER Writer,
+    _In_ LPCSTR Text
+)
+{
+    while (*Text) {
+        if (Writer->Length == TRACE_WRITE_BUFFER_SIZE)
+            tracepFlush(Writer);
+        Writer->Buffer[Writer->Length++] = *Text++;
+    }
+}
+
+/*
+* tracepWriteNumber
+*
+* Purpose:
+*
+* Append decimal number to the output buffer.
+*
+*/
+VOID tracepWriteNumber(
+    _In_ PTRACE_WRITER Writer,
+    _In_ ULONG64 Value
+)
+{
+    CHAR szNumber[MAX_TEXT_CONVERSION_ULONG64];
+
+    szNumber[0] = 0;
+    u64tostr_a(Value, szNumber);
+    tracepWrite(Writer, szNumber);
+}
+
+/*
+* tracepWriteEscaped
+*
+* Purpose:
+*
+* Append JSON string contents converted to UTF-8.
+*
+*/
+VOID tracepWriteEscaped(
+    _In_ PTRACE_WRITER Writer,
+    _In_ LPCWSTR Text
+)
+{
+    INT i, cb;
+    CHAR szChar[2];
+    CHAR szText[TRACE_MAX_DETAIL * 4];
+
+    cb = WideCharToMultiByte(CP_UTF8, 0, Text, -1, szText, sizeof(szText), NULL, NULL);
+
+    szChar[1] = 0;
+    for (i = 0; i < cb - 1; i++) {
+
+        switch (szText[i]) {
+        case '\"':
+            tracepWrite(Writer, "\\\"");
+            break;
+        case '\\':
+            tracepWrite(Writer, "\\\\");
+            break;
+        default:
+            szChar[0] = ((UCHAR)szText[i] < 0x20) ? ' ' : szText[i];
+            tracepWrite(Writer, szChar);
+            break;
+        }
+    }
+}
+
+/*
+* tracepToMicroseconds
+*
+* Purpose:
+*
+* Convert performance counter value to microseconds since trace start.
+*
+*/
+ULONG64 tracepToMicroseconds(
+    _In_ LONGLONG Time
+)
+{
+    if (Time <= g_trace.BaseTime)
+        return 0;
+
+    return (ULONG64)(Time - g_trace.BaseTime) * 1000000 / g_trace.Frequency;
+}
+
+/*
+* tracepWriteFile
+*
+* Purpose:
+*
+* Write collected spans as trace event JSON.
+*
+*/
+VOID tracepWriteFile(
+    VOID
+)
+{
+    LONG i, Count;
+    ULONG64 StartTime;
+    ULONG ProcessId = GetCurrentProcessId();
+    PTRACE_EVENT Event;
+    PTRACE_WRITER Writer;
+
+    if (_strcmp(g_trace.szFileName, TEXT("1")) == 0) {
+        _strcpy(g_trace.szFileName, g_WinObj.szTempDirectory);
+        _strcat(g_trace.szFileName, TRACE_DEFAULT_FILE_NAME);
+    }
+
+    Writer = (PTRACE_WRITER)supVirtualAlloc(sizeof(TRACE_WRITER));
+    if (Writer == NULL)
+        return;
+
+    Writer->FileHandle = CreateFile(g_trace.szFileName,
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (Writer->FileHandle != INVALID_HANDLE_VALUE) {
+
+        tracepWrite(Writer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+        tracepWrite(Writer, "\r\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":");
+        tracepWriteNumber(Writer, ProcessId);
+        tracepWrite(Writer, ",\"tid\":0,\"args\":{\"name\":\"WinObjEx64\"}}");
+
+        Count = min(g_trace.EventCount, TRACE_MAX_EVENTS);
+
+        for (i = 0; i < Count; i++) {
+
+            Event = &g_trace.Events[i];
+            if (Event->Name == NULL)
+                continue;
+
+            StartTime = tracepToMicroseconds(Event->StartTime);
+
+            tracepWrite(Writer, ",\r\n{\"name\":\"");
+            tracepWrite(Writer, Event->Name);
+            tracepWrite(Writer, "\",\"cat\":\"winobjex64\",\"ph\":\"X\",\"ts\":");
+            tracepWriteNumber(Writer, StartTime);
+            tracepWrite(Writer, ",\"dur\":");
+            tracepWriteNumber(Writer, tracepToMicroseconds(Event->EndTime) - StartTime);
+            tracepWrite(Writer, ",\"pid\":");
+            tracepWriteNumber(Writer, ProcessId);
+            tracepWrite(Writer, ",\"tid\":");
+            tracepWriteNumber(Writer, Event->ThreadId);
+
+            if (Event->Detail[0]) {
+                tracepWrite(Writer, ",\"args\":{\"detail\":\"");
+                tracepWriteEscaped(Writer, Event->Detail);
+                tracepWrite(Writer, "\"}");
+            }
+
+            tracepWrite(Writer, "}");
+        }
+
+        if (g_trace.EventCount > TRACE_MAX_EVENTS) {
+            tracepWrite(Writer, ",\r\n{\"name\":\"dropped_events\",\"ph\":\"i\",\"s\":\"g\",\"ts\":0,\"pid\":");
+            tracepWriteNumber(Writer, ProcessId);
+            tracepWrite(Writer, ",\"tid\":0,\"args\":{\"count\":");
+            tracepWriteNumber(Writer, (ULONG64)g_trace.EventCount - TRACE_MAX_EVENTS);
+            tracepWrite(Writer, "}}");
+        }
+
+        tracepWrite(Writer, "\r\n]}\r\n");
+        tracepFlush(Writer);
+
+        CloseHandle(Writer->FileHandle);
+    }
+
+    supVirtualFree(Writer);
+}
+
+/*
+* traceFree
+*
+* Purpose:
+*
+* Write trace file and disable tracing, called once on program exit.
+*
+* Events array is not released as spans started before this call
+* on other threads may still complete.
+*
+*/
+VOID traceFree(
+    VOID
+)
+{
+    if (g_TraceEnabled == FALSE)
+        return;
+
+    g_TraceEnabled = FALSE;
+
+    tracepWriteFile();
+}
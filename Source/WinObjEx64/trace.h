@@ -0,0 +1,63 @@
+/*******************************************************************************
+*
+*  (C) COPYRIGHT AUTHORS, 2026
+*
+*  TITLE:       TRACE.H
+*
+*  VERSION:     1.86
+*
+*  DATE:        18 Oct 2026
+*
+*  Header file for the span tracing.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+* ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED
+* TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+*******************************************************************************/
+#pragma once
+
+//
+// Tracing is enabled when variable is set, value is output file name
+// or "1" for default file in temp directory.
+//
+#define TRACE_ENVIRONMENT_VARIABLE  L"WINOBJEX64_TRACE"
+#define TRACE_DEFAULT_FILE_NAME     L"\\winobjex64_trace.json"
+
+#define TRACE_MAX_EVENTS            16384
+#define TRACE_MAX_DETAIL            64
+
+typedef struct _TRACE_SPAN {
+    LPCSTR Name;
+    LONGLONG StartTime;
+} TRACE_SPAN, *PTRACE_SPAN;
+
+extern BOOL g_TraceEnabled;
+
+//
+// Span name must be a string literal, it is referenced until trace is written.
+// When tracing is disabled begin is a single flag test and end is a no-op.
+//
+#define TRACE_BEGIN(Span, SpanName) do { \
+    (Span).Name = SpanName; \
+    (Span).StartTime = (g_TraceEnabled) ? traceTimestamp() : 0; } while (FALSE)
+
+#define TRACE_END(Span) do { \
+    if ((Span).StartTime) traceSpanEnd(&(Span), NULL); } while (FALSE)
+
+#define TRACE_END_DETAIL(Span, Detail) do { \
+    if ((Span).StartTime) traceSpanEnd(&(Span), Detail); } while (FALSE)
+
+LONGLONG traceTimestamp(
+    VOID);
+
+VOID traceSpanEnd(
+    _In_ PTRACE_SPAN Span,
+    _In_opt_ LPCWSTR Detail);
+
+VOID traceCreate(
+    VOID);
+
+VOID traceFree(
+    VOID);
@@ -40,6 +40,7 @@
 #define PSLIST_COLUMN_COUNT 6
 #define SSDTLIST_COLUMN_COUNT 4
 #define SLLIST_COLUMN_COUNT 2
+#define READSTATS_COLUMN_COUNT 7
 
 
 typedef	struct _OE_LIST_ITEM {
@@ -79,9 +80,11 @@ typedef HWND(WINAPI *pfnHtmlHelpW)(
 #define T_COPYADDRESS           L"Copy Address Field Text"
 #define T_COPYADDINFO           L"Copy Additional Info Field Text"
 #define T_SAVETOFILE            L"Save list to File"
+#define T_EXPORTLIST            L"Export List..."
 #define T_DUMPDRIVER            L"Dump Driver"
 #define T_VIEW_REFRESH          L"Refresh\tF5"
 #define T_RESCAN                L"Rescan"
+#define T_RESETSTATS            L"Reset Statistics"
 #define T_EMPTY                 L" "
 
 #define T_DRIVER_REQUIRED       TEXT("Support from helper driver is required for this feature.\r\n\r\n\
@@ -103,6 +106,7 @@ typedef enum _WOBJ_DIALOGS_ID {
     wobjDriversDlgId,
     wobjCallbacksDlgId,
     wobjSLCacheDlgId,
+    wobjReadStatsDlgId,
     wobjMaxDlgId
 } WOBJ_DIALOGS_ID;
 
@@ -293,6 +297,9 @@ static LPCWSTR g_szMonths[12] = {
 #define wobjInitNoSys32Dir      -4
 #define wobjInitNoProgDir       -5
 
+INT WinObjInitGlobals(
+    _In_ BOOLEAN IsWine);
+
 #define T_WOBJINIT_NOCRT TEXT("Could not initialize CRT, abort")
 #define T_WOBJINIT_NOHEAP TEXT("Could not initialize WinObjEx64, could not allocate heap")
 #define T_WOBJINIT_NOTEMP TEXT("Could not initialize WinObjEx64, could not locate %temp%")